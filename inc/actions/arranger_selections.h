@@ -39,6 +39,7 @@
 #include "gui/backend/automation_selections.h"
 #include "gui/backend/chord_selections.h"
 #include "gui/backend/midi_arranger_selections.h"
+#include "gui/backend/midi_note_batch.h"
 #include "gui/backend/timeline_selections.h"
 
 typedef struct ArrangerSelections ArrangerSelections;
@@ -59,6 +60,11 @@ typedef enum ArrangerSelectionsActionType
   AS_ACTION_DELETE,
   AS_ACTION_DUPLICATE,
   AS_ACTION_EDIT,
+
+  /** Bulk edit of MidiNote values from a
+   * MidiNoteBatch. */
+  AS_ACTION_EDIT_NOTES,
+
   AS_ACTION_LINK,
   AS_ACTION_MERGE,
   AS_ACTION_MOVE,
@@ -76,6 +82,7 @@ arranger_selections_action_type_strings[] =
   { "Delete",          AS_ACTION_DELETE },
   { "Duplicate",       AS_ACTION_DUPLICATE },
   { "Edit",            AS_ACTION_EDIT },
+  { "Edit notes",      AS_ACTION_EDIT_NOTES },
   { "Link",            AS_ACTION_LINK },
   { "Merge",           AS_ACTION_MERGE },
   { "Move",            AS_ACTION_MOVE },
@@ -256,6 +263,20 @@ typedef struct ArrangerSelectionsAction
   /** QuantizeOptions clone, if quantizing. */
   QuantizeOptions *    opts;
 
+  /**
+   * Regions of the notes in
+   * @ref ArrangerSelectionsAction.note_changes.
+   *
+   * Used in the EDIT_NOTES action, which does not
+   * keep clones of the selections.
+   */
+  RegionIdentifier *   note_regions;
+  int                  num_note_regions;
+
+  /** Notes changed in the EDIT_NOTES action. */
+  MidiNoteChange *     note_changes;
+  int                  num_note_changes;
+
   /* --- below for serialization only --- */
   ChordSelections *    chord_sel;
   ChordSelections *    chord_sel_after;
@@ -318,6 +339,12 @@ static const cyaml_schema_field_t
   YAML_FIELD_MAPPING_PTR_OPTIONAL (
     ArrangerSelectionsAction, opts,
     quantize_options_fields_schema),
+  YAML_FIELD_DYN_ARRAY_VAR_COUNT (
+    ArrangerSelectionsAction, note_regions,
+    region_identifier_schema_default),
+  YAML_FIELD_DYN_ARRAY_VAR_COUNT (
+    ArrangerSelectionsAction, note_changes,
+    midi_note_change_schema_default),
   CYAML_FIELD_MAPPING_PTR (
     "chord_sel",
     CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
@@ -656,6 +683,9 @@ arranger_selections_action_new_resize (
  * Creates a new action fro quantizing
  * ArrangerObject's.
  *
+ * MidiNote's are quantized with an
+ * AS_ACTION_EDIT_NOTES action.
+ *
  * @param opts Quantize options.
  */
 WARN_UNUSED_RESULT
@@ -665,6 +695,35 @@ arranger_selections_action_new_quantize (
   QuantizeOptions *    opts,
   GError **            error);
 
+/**
+ * Creates a new action for editing MidiNote's in
+ * bulk.
+ *
+ * Only the values of the notes that changed are
+ * stored instead of clones of the selections, so
+ * this should be preferred over
+ * arranger_selections_action_new_edit() and
+ * arranger_selections_action_new_quantize() when
+ * editing many notes.
+ *
+ * @param before The values before the change, or
+ *   NULL to use the current values in the
+ *   project. Must contain the same notes as
+ *   @p after.
+ * @param after The values after the change.
+ * @param already_edited Whether the values in
+ *   @p after were already written to the
+ *   project.
+ */
+NONNULL_ARGS (2)
+WARN_UNUSED_RESULT
+UndoableAction *
+arranger_selections_action_new_edit_notes (
+  MidiNoteBatch * before,
+  MidiNoteBatch * after,
+  bool            already_edited,
+  GError **       error);
+
 NONNULL
 ArrangerSelectionsAction *
 arranger_selections_action_clone (
@@ -815,6 +874,13 @@ arranger_selections_action_perform_edit_audio_function (
   const char *         uri,
   GError **            error);
 
+bool
+arranger_selections_action_perform_edit_notes (
+  MidiNoteBatch * before,
+  MidiNoteBatch * after,
+  bool            already_edited,
+  GError **       error);
+
 bool
 arranger_selections_action_perform_automation_fill (
   ZRegion * region_before,
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * On-disk journal for undoable actions.
+ */
+
+#ifndef __UNDO_UNDO_JOURNAL_H__
+#define __UNDO_UNDO_JOURNAL_H__
+
+#include "actions/undoable_action.h"
+
+#include <gio/gio.h>
+
+/**
+ * @addtogroup actions
+ *
+ * @{
+ */
+
+/**
+ * Append-only temporary file holding compressed
+ * undoable actions that were moved out of memory.
+ *
+ * Actions in the journal are represented in the
+ * undo/redo stacks by stubs (see
+ * UndoableAction.spilled).
+ */
+typedef struct UndoJournal
+{
+  /** Temporary file. */
+  GFile *          file;
+
+  /** Stream for reading/writing @ref file. */
+  GFileIOStream *  stream;
+
+  /** Current size of the file in bytes. */
+  gint64           size;
+} UndoJournal;
+
+/**
+ * Creates a new journal backed by a temporary
+ * file.
+ */
+UndoJournal *
+undo_journal_new (
+  GError ** error);
+
+/**
+ * Serializes and compresses the given action.
+ *
+ * @return Newly allocated data to be free'd with
+ *   free(), or NULL on error.
+ */
+NONNULL_ARGS (1, 2)
+char *
+undo_journal_serialize_action (
+  UndoableAction * action,
+  size_t *         size,
+  GError **        error);
+
+/**
+ * Appends the given compressed action data to the
+ * journal and returns a stub for it.
+ */
+NONNULL_ARGS (1, 4, 5)
+UndoableAction *
+undo_journal_add_action (
+  UndoJournal *      self,
+  UndoableActionType type,
+  int                num_actions,
+  const char *       str,
+  const char *       data,
+  size_t             size,
+  GError **          error);
+
+/**
+ * Writes the given action to the journal and
+ * returns a stub to replace it with.
+ *
+ * The action itself is not free'd.
+ */
+NONNULL_ARGS (1, 2)
+UndoableAction *
+undo_journal_spill_action (
+  UndoJournal *    self,
+  UndoableAction * action,
+  GError **        error);
+
+/**
+ * Reads the compressed data of the given stub.
+ *
+ * @return Newly allocated data to be free'd with
+ *   g_free(), or NULL on error.
+ */
+NONNULL_ARGS (1, 2, 3)
+char *
+undo_journal_read_action (
+  UndoJournal *    self,
+  UndoableAction * stub,
+  size_t *         size,
+  GError **        error);
+
+/**
+ * Loads the action represented by the given stub
+ * from the journal.
+ *
+ * The stub itself is not free'd.
+ */
+NONNULL_ARGS (1, 2)
+UndoableAction *
+undo_journal_restore_action (
+  UndoJournal *    self,
+  UndoableAction * stub,
+  GError **        error);
+
+/**
+ * Discards the contents of the journal.
+ *
+ * To be called when no stubs refer to it anymore.
+ */
+NONNULL
+void
+undo_journal_reset (
+  UndoJournal * self);
+
+NONNULL
+void
+undo_journal_free (
+  UndoJournal * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -26,6 +26,7 @@
 #ifndef __UNDO_UNDO_MANAGER_H__
 #define __UNDO_UNDO_MANAGER_H__
 
+#include "actions/undo_journal.h"
 #include "actions/undo_stack.h"
 
 #include "zix/sem.h"
@@ -54,6 +55,19 @@ typedef struct UndoManager
 
   /** Semaphore for performing actions. */
   ZixSem        action_sem;
+
+  /**
+   * Memory budget for the undo history in bytes,
+   * or 0 for unlimited.
+   *
+   * Once exceeded, the oldest actions are moved
+   * to @ref journal.
+   */
+  size_t        mem_budget;
+
+  /** Journal holding spilled actions, created on
+   * demand. */
+  UndoJournal * journal;
 } UndoManager;
 
 static const cyaml_schema_field_t
@@ -176,6 +190,39 @@ undo_manager_clear_stacks (
   UndoManager * self,
   bool          free);
 
+/**
+ * Saves the undo history to the given file.
+ *
+ * Actions already in the journal are copied as-is,
+ * so this does not restore them in memory. The
+ * compressed data of the other actions is cached
+ * on them, so only actions done or undone since
+ * the last save are serialized again.
+ *
+ * The action semaphore must be held, since this
+ * may be called outside the GTK thread.
+ */
+NONNULL_ARGS (1, 2)
+bool
+undo_manager_save_history (
+  UndoManager * self,
+  const char *  path,
+  GError **     error);
+
+/**
+ * Loads the undo history from the given file, if
+ * it exists.
+ *
+ * The loaded actions are kept in the journal until
+ * needed.
+ */
+NONNULL_ARGS (1, 2)
+bool
+undo_manager_load_history (
+  UndoManager * self,
+  const char *  path,
+  GError **     error);
+
 NONNULL
 UndoManager *
 undo_manager_clone (
@@ -213,6 +213,38 @@ undo_stack_pop_last (
 
 /* --- end wrappers --- */
 
+/**
+ * Replaces the given action in the stack with
+ * another one, keeping its position.
+ *
+ * Used when moving actions to or from the undo
+ * journal.
+ */
+NONNULL
+void
+undo_stack_replace_action (
+  UndoStack *      self,
+  UndoableAction * old_action,
+  UndoableAction * new_action);
+
+/**
+ * Returns the estimated memory used by the
+ * actions in the stack, in bytes.
+ */
+NONNULL
+size_t
+undo_stack_get_memory_size (
+  UndoStack * self);
+
+/**
+ * Returns the number of actions in the stack that
+ * were moved to the undo journal.
+ */
+NONNULL
+int
+undo_stack_get_num_spilled_actions (
+  UndoStack * self);
+
 bool
 undo_stack_contains_clip (
   UndoStack * self,
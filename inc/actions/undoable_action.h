@@ -118,6 +118,51 @@ typedef struct UndoableAction
    * To be set on the last action being performed.
    */
   int                 num_actions;
+
+  /**
+   * Estimated memory used by the action, in
+   * bytes.
+   *
+   * Calculated when the action is pushed to a
+   * stack.
+   */
+  size_t              mem_size;
+
+  /**
+   * Whether the action was moved to the undo
+   * journal.
+   *
+   * Spilled actions are stubs that only contain
+   * this base struct and must be restored with
+   * undo_journal_restore_action() before use.
+   *
+   * @see UndoJournal.
+   */
+  bool                spilled;
+
+  /** Offset of the compressed action in the
+   * journal, if spilled. */
+  gint64              journal_offset;
+
+  /** Size of the compressed action in the
+   * journal, if spilled. */
+  size_t              journal_size;
+
+  /** String representation of the action, if
+   * spilled. */
+  char *              spilled_str;
+
+  /**
+   * Compressed action data cached by the last
+   * undo_manager_save_history(), to be free'd with
+   * free().
+   *
+   * Cleared when the action is done or undone.
+   */
+  char *              history_data;
+
+  /** Size of @ref UndoableAction.history_data. */
+  size_t              history_data_size;
 } UndoableAction;
 
 static const cyaml_schema_field_t
@@ -189,6 +234,15 @@ undoable_action_contains_clip (
   UndoableAction * self,
   AudioClip *      clip);
 
+/**
+ * Returns the estimated memory used by the action,
+ * in bytes.
+ */
+NONNULL
+size_t
+undoable_action_get_memory_size (
+  UndoableAction * self);
+
 /**
  * Sets the number of actions for this action.
  *
@@ -173,6 +173,22 @@ automation_point_get_normalized_value_in_curve (
   AutomationPoint * ap,
   double            x);
 
+/**
+ * Fills @p buf with @p size points on the curve,
+ * starting at normalized x @p x_start and
+ * advancing by @p x_step.
+ *
+ * @param ap The start point (0, 0).
+ */
+NONNULL
+void
+automation_point_get_normalized_values_in_curve (
+  AutomationPoint * ap,
+  double            x_start,
+  double            x_step,
+  float *           buf,
+  size_t            size);
+
 /**
  * Sets the curviness of the AutomationPoint.
  */
@@ -28,6 +28,7 @@
 
 #include <stdbool.h>
 
+#include "audio/clip_block.h"
 #include "utils/audio.h"
 #include "utils/types.h"
 #include "utils/yaml.h"
@@ -40,6 +41,19 @@
 
 #define AUDIO_CLIP_SCHEMA_VERSION 1
 
+/**
+ * Clips at least this long whose file is already
+ * at the engine's sample rate are streamed from
+ * disk instead of being loaded into memory.
+ */
+#define AUDIO_CLIP_STREAM_MIN_SECONDS 120
+
+/**
+ * Number of frames summarized by each peak of a
+ * streamed clip.
+ */
+#define AUDIO_CLIP_PEAK_FRAMES 256
+
 /**
  * Audio clips for the pool.
  *
@@ -96,6 +110,26 @@ typedef struct AudioClip
    * already written to the pool. */
   char *           file_hash;
 
+  /**
+   * Size, modification time (in microseconds) and
+   * inode of the clip's file in the main project
+   * pool when @ref AudioClip.file_hash was last
+   * calculated or verified, or 0 if unknown.
+   *
+   * While the file matches these, its hash is
+   * known without reading it.
+   */
+  gint64           file_size;
+  gint64           file_mtime;
+  guint64          file_inode;
+
+  /**
+   * Whether the frames may differ from the clip's
+   * file in the main project pool (eg, for new or
+   * recorded clips).
+   */
+  bool             frames_dirty;
+
   /**
    * Frames already written to the file, per channel.
    *
@@ -112,6 +146,40 @@ typedef struct AudioClip
    * @see AudioClip.frames_written.
    */
   gint64           last_write;
+
+  /**
+   * Frames stored as shared blocks, used instead
+   * of @ref AudioClip.frames for clips that are
+   * not played back (eg, audio held by the undo
+   * history).
+   *
+   * When this is non-NULL, @ref AudioClip.frames
+   * and @ref AudioClip.ch_frames are NULL.
+   *
+   * @see audio_clip_move_frames_to_blocks().
+   */
+  AudioClipBlock ** blocks;
+  size_t           num_blocks;
+
+  /**
+   * Path of the file the clip is streamed from
+   * during playback, or NULL if the frames are in
+   * memory.
+   *
+   * When this is non-NULL, @ref AudioClip.frames
+   * and @ref AudioClip.ch_frames are NULL.
+   *
+   * @see audio_clip_init_streaming().
+   */
+  char *           stream_path;
+
+  /**
+   * Minimum and maximum sample (across all
+   * channels) of every @ref AUDIO_CLIP_PEAK_FRAMES
+   * frames of a streamed clip, used for drawing.
+   */
+  float *          peaks;
+  size_t           num_peaks;
 } AudioClip;
 
 static const cyaml_schema_field_t
@@ -123,6 +191,14 @@ audio_clip_fields_schema[] =
     AudioClip, name),
   YAML_FIELD_STRING_PTR_OPTIONAL (
     AudioClip, file_hash),
+  YAML_FIELD_INT_OPTIONAL (
+    AudioClip, file_size),
+  YAML_FIELD_INT_OPTIONAL (
+    AudioClip, file_mtime),
+  YAML_FIELD_UINT_OPTIONAL (
+    AudioClip, file_inode),
+  YAML_FIELD_INT_OPTIONAL (
+    AudioClip, frames_dirty),
   YAML_FIELD_FLOAT (
     AudioClip, bpm),
   YAML_FIELD_ENUM (
@@ -152,6 +228,88 @@ void
 audio_clip_init_loaded (
   AudioClip * self);
 
+/**
+ * Loads the frames of a clip from its file in the
+ * pool, resampled to the given sample rate.
+ *
+ * Long clips are streamed instead (see
+ * audio_clip_init_streaming()).
+ *
+ * If @p cache_dir is non-NULL, the frames are
+ * taken from the resampled clip cache when
+ * possible and stored there after decoding
+ * otherwise.
+ *
+ * The project is not accessed so this can be
+ * called from worker threads.
+ *
+ * @param filepath Path of the clip's file in the
+ *   pool.
+ * @param cache_dir Clip cache directory, or NULL.
+ */
+NONNULL_ARGS (1, 2)
+void
+audio_clip_load_frames_from_file (
+  AudioClip *  self,
+  const char * filepath,
+  int          samplerate,
+  const char * cache_dir);
+
+/**
+ * Sets up the clip to be streamed from the given
+ * file during playback instead of keeping its
+ * frames in memory.
+ *
+ * This only succeeds if the file is at the given
+ * sample rate and has at least @p min_frames
+ * frames.
+ *
+ * Any frames in memory are freed, so this must
+ * only be used on clips that are not being played
+ * back.
+ *
+ * @return Whether the clip will be streamed.
+ */
+NONNULL
+bool
+audio_clip_init_streaming (
+  AudioClip *      self,
+  const char *     filepath,
+  int              samplerate,
+  unsigned_frame_t min_frames);
+
+/**
+ * Loads the frames of a streamed clip into memory
+ * so that they can be edited.
+ *
+ * Does nothing if the clip is not streamed.
+ *
+ * @return Whether the frames are in memory.
+ */
+NONNULL
+bool
+audio_clip_make_resident (
+  AudioClip * self);
+
+/**
+ * Gets the minimum and maximum sample (across all
+ * channels) in the given range of frames.
+ *
+ * For streamed clips the range is widened to
+ * whole peaks.
+ *
+ * The values in @p min and @p max are only
+ * replaced if exceeded.
+ */
+NONNULL
+void
+audio_clip_get_min_max (
+  const AudioClip * self,
+  signed_frame_t    start_frame,
+  signed_frame_t    end_frame,
+  float *           min,
+  float *           max);
+
 /**
  * Creates an audio clip from a file.
  *
@@ -208,6 +366,64 @@ audio_clip_update_channel_caches (
   AudioClip * self,
   size_t      start_from);
 
+/**
+ * Moves the frames of the clip into shared blocks
+ * in the given store and frees the contiguous
+ * frame buffers.
+ *
+ * Blocks with identical content are only stored
+ * once, so clips derived from each other only
+ * hold memory for the parts that differ.
+ *
+ * @note This must only be used on clips that are
+ *   not played back.
+ */
+NONNULL
+void
+audio_clip_move_frames_to_blocks (
+  AudioClip *           self,
+  AudioClipBlockStore * store);
+
+/**
+ * Restores the contiguous frame buffers (and
+ * channel caches) from the clip's blocks and
+ * releases the blocks.
+ */
+NONNULL
+void
+audio_clip_load_frames_from_blocks (
+  AudioClip * self);
+
+/**
+ * Copies interleaved frames from the clip into
+ * \ref dest, regardless of whether the clip is
+ * stored contiguously, in blocks or streamed.
+ *
+ * @param start_frame Frame to start from (per
+ *   channel).
+ * @param num_frames Number of frames (per
+ *   channel) to copy.
+ */
+NONNULL
+void
+audio_clip_copy_frames (
+  const AudioClip * self,
+  float *           dest,
+  unsigned_frame_t  start_frame,
+  unsigned_frame_t  num_frames);
+
+/**
+ * Returns the number of bytes used by the clip's
+ * contiguous frame buffers and channel caches.
+ *
+ * Memory in blocks is accounted for by the
+ * AudioClipBlockStore.
+ */
+NONNULL
+size_t
+audio_clip_get_resident_bytes (
+  const AudioClip * self);
+
 /**
  * Shows a dialog with info on how to edit a file,
  * with an option to open an app launcher.
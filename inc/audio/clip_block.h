@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Shared, reference-counted blocks of audio clip
+ * data.
+ */
+
+#ifndef __AUDIO_CLIP_BLOCK_H__
+#define __AUDIO_CLIP_BLOCK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Number of frames (per channel) in each block.
+ *
+ * Blocks are aligned to the start of the clip, so
+ * clips derived from each other (eg, the audio
+ * before and after an audio function is applied)
+ * end up sharing every block that was not touched
+ * by the edit.
+ */
+#define AUDIO_CLIP_BLOCK_FRAMES 16384
+
+typedef struct AudioClipBlockStore
+  AudioClipBlockStore;
+
+/**
+ * A reference-counted, immutable block of
+ * interleaved audio frames.
+ *
+ * Blocks are deduplicated by content, so
+ * identical blocks are only stored once.
+ */
+typedef struct AudioClipBlock
+{
+  /** Content hash (XXH3 64-bit). */
+  uint64_t              hash;
+
+  /** Interleaved samples. */
+  float *               data;
+
+  /** Number of samples in @ref data (frames *
+   * channels). */
+  size_t                num_samples;
+
+  /** Number of clips referencing this block. */
+  int                   refcount;
+
+  /** Next block with the same hash (collision
+   * chain). */
+  struct AudioClipBlock * next;
+
+  /** Owner store. */
+  AudioClipBlockStore * store;
+} AudioClipBlock;
+
+/**
+ * Content-addressed store of audio clip blocks.
+ *
+ * This is owned by the AudioPool and is only
+ * accessed from the main thread.
+ */
+typedef struct AudioClipBlockStore
+{
+  /** Hash table of uint64_t hash -> first
+   * AudioClipBlock in the collision chain. */
+  GHashTable *          blocks;
+
+  /** Number of unique blocks. */
+  size_t                num_blocks;
+
+  /** Bytes actually allocated for block data. */
+  size_t                allocated_bytes;
+
+  /** Bytes referenced by clips (ie, the memory
+   * that would be used without sharing). */
+  size_t                referenced_bytes;
+} AudioClipBlockStore;
+
+AudioClipBlockStore *
+audio_clip_block_store_new (void);
+
+/**
+ * Returns a block containing a copy of the given
+ * samples, sharing an existing block if one with
+ * identical content exists.
+ *
+ * The reference count of the returned block is
+ * incremented.
+ */
+NONNULL
+AudioClipBlock *
+audio_clip_block_store_acquire (
+  AudioClipBlockStore * self,
+  const float *         data,
+  size_t                num_samples);
+
+/**
+ * Decrements the reference count of the block and
+ * frees it if no longer referenced.
+ */
+NONNULL
+void
+audio_clip_block_release (
+  AudioClipBlock * block);
+
+NONNULL
+void
+audio_clip_block_store_free (
+  AudioClipBlockStore * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * On-disk cache of decoded and resampled audio
+ * clip frames.
+ */
+
+#ifndef __AUDIO_CLIP_CACHE_H__
+#define __AUDIO_CLIP_CACHE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct AudioClip AudioClip;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Maximum size of the cache in bytes before the
+ * least recently used entries are removed.
+ */
+#define AUDIO_CLIP_CACHE_MAX_BYTES \
+  ((size_t) 2 * 1024 * 1024 * 1024)
+
+/**
+ * Returns a newly allocated string with the
+ * directory of the clip cache.
+ *
+ * Must be called from the main thread.
+ */
+char *
+audio_clip_cache_get_dir (void);
+
+/**
+ * Loads the frames of the clip from the cache
+ * entry for the given file hash and sample rate.
+ *
+ * The clip's frames, number of frames, channels,
+ * sample rate and bit depth are set on success.
+ *
+ * This only accesses the given clip and the
+ * filesystem so it can be called from any thread.
+ *
+ * @param dir Cache directory.
+ * @param file_hash Hash of the original file.
+ *
+ * @return Whether a valid entry was found.
+ */
+NONNULL
+bool
+audio_clip_cache_load (
+  const char * dir,
+  AudioClip *  clip,
+  const char * file_hash,
+  int          samplerate);
+
+/**
+ * Stores the frames of the clip in the cache,
+ * using the clip's sample rate as part of the
+ * key.
+ *
+ * This only accesses the given clip and the
+ * filesystem so it can be called from any thread.
+ *
+ * @param dir Cache directory.
+ * @param file_hash Hash of the original file.
+ */
+NONNULL
+void
+audio_clip_cache_store (
+  const char *      dir,
+  const AudioClip * clip,
+  const char *      file_hash);
+
+/**
+ * Removes the least recently used entries until
+ * the cache is no larger than @p max_bytes.
+ */
+NONNULL
+void
+audio_clip_cache_prune (
+  const char * dir,
+  size_t       max_bytes);
+
+/**
+ * @}
+ */
+
+#endif
@@ -29,6 +29,8 @@
 #define __AUDIO_CURVE_H__
 
 #include <stdbool.h>
+#include <stddef.h>
+
 #include "utils/yaml.h"
 
 /**
@@ -44,6 +46,19 @@
 #define CURVE_EXPONENT_CURVINESS_BOUND 0.95
 #define CURVE_VITAL_CURVINESS_BOUND 1.00
 
+/**
+ * Number of values between exact evaluations in
+ * curve_get_normalized_y_block().
+ */
+#define CURVE_BLOCK_SEGMENT_SIZE 16
+
+/**
+ * Maximum error at the middle of a segment in
+ * curve_get_normalized_y_block() before the
+ * segment is evaluated exactly.
+ */
+#define CURVE_BLOCK_MAX_ERROR 0.001
+
 /**
  * The algorithm to use for curves.
  *
@@ -201,6 +216,34 @@ curve_get_normalized_y (
   CurveOptions * opts,
   int            start_higher);
 
+/**
+ * Fills @p buf with the Y values of the curve at
+ * @p size consecutive X values, starting at
+ * @p x_start and advancing by @p x_step.
+ *
+ * The curve is evaluated exactly every
+ * CURVE_BLOCK_SEGMENT_SIZE values and linearly
+ * interpolated in between, so that a whole gain
+ * ramp costs only a few evaluations. Segments
+ * where the interpolation is off by more than
+ * CURVE_BLOCK_MAX_ERROR at the middle are
+ * evaluated exactly. X values outside 0-1 are
+ * clamped.
+ *
+ * @param opts Curve options.
+ * @param start_higher Start at higher point.
+ */
+HOT
+NONNULL
+void
+curve_get_normalized_y_block (
+  CurveOptions * opts,
+  int            start_higher,
+  double         x_start,
+  double         x_step,
+  float *        buf,
+  size_t         size);
+
 PURE
 bool
 curve_options_are_equal (
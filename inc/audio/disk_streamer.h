@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Disk streaming of long audio clips.
+ */
+
+#ifndef __AUDIO_DISK_STREAMER_H__
+#define __AUDIO_DISK_STREAMER_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+#include "zix/ring.h"
+#include "zix/sem.h"
+
+#include <glib.h>
+
+#include <sndfile.h>
+
+typedef struct AudioClip AudioClip;
+typedef struct ZRegion ZRegion;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Number of regions that can be streamed at the
+ * same time.
+ */
+#define DISK_STREAMER_NUM_SLOTS 64
+
+/**
+ * Size of each read-ahead buffer in (stereo)
+ * frames.
+ *
+ * Together with @ref DISK_STREAMER_NUM_SLOTS this
+ * is the fixed memory budget of the streamer.
+ */
+#define DISK_STREAMER_BUFFER_FRAMES 65536
+
+/**
+ * Maximum number of frames read from a file at
+ * once.
+ */
+#define DISK_STREAMER_READ_FRAMES 8192
+
+/**
+ * Timing of a streamed region, as seen by the
+ * streamer.
+ *
+ * A change in any of these (eg, when the region is
+ * moved or the loop points change) causes the
+ * read-ahead buffer to be refilled.
+ */
+typedef struct DiskStreamRegionInfo
+{
+  /** Region start/end in global frames. */
+  signed_frame_t pos;
+  signed_frame_t end_pos;
+
+  /** Region-local clip start and loop points. */
+  signed_frame_t clip_start;
+  signed_frame_t loop_start;
+  signed_frame_t loop_end;
+
+  /** Transport loop points, if looping. */
+  bool           transport_loop;
+  signed_frame_t transport_loop_start;
+  signed_frame_t transport_loop_end;
+} DiskStreamRegionInfo;
+
+/**
+ * Read-ahead buffer for a region being played
+ * back.
+ *
+ * Fields marked "request" are written by the
+ * audio threads while @ref
+ * DiskStreamSlot.req_gen is odd and read by the
+ * I/O thread.
+ */
+typedef struct DiskStreamSlot
+{
+  /**
+   * Region using this slot, or NULL if the slot
+   * is free.
+   *
+   * Only used as an identifier.
+   */
+  ZRegion *      region;
+
+  /** Request: clip to read from. */
+  AudioClip *    clip;
+
+  /** Request: region timing. */
+  DiskStreamRegionInfo info;
+
+  /** Request: global frame to start reading
+   * from. */
+  signed_frame_t start_frame;
+
+  /**
+   * Request generation.
+   *
+   * Incremented once before and once after
+   * changing the request, so it is odd while the
+   * request is being written.
+   */
+  volatile gint  req_gen;
+
+  /** Last request generation whose buffer was
+   * reset and started filling. */
+  volatile gint  ready_gen;
+
+  /** Interleaved stereo frames, in playback
+   * order. */
+  ZixRing *      ring;
+
+  /* --- audio thread only --- */
+
+  /** Global frame expected in the next read. */
+  signed_frame_t rt_next_frame;
+
+  /** Frames to drop from the ring before the next
+   * read (frames played as silence while waiting
+   * for the I/O thread). */
+  size_t         rt_skip_frames;
+
+  /** Whether data was read since the last
+   * request. */
+  bool           rt_primed;
+
+  /** Engine cycle this slot was last used in. */
+  gint64         rt_last_cycle;
+
+  /* --- I/O thread only --- */
+
+  gint           io_gen;
+  AudioClip *    io_clip;
+  SNDFILE *      io_file;
+  unsigned int   io_channels;
+
+  /** Frame (per channel) of the file position. */
+  sf_count_t     io_file_pos;
+
+  /** Next global frame to read, or -1 if
+   * finished. */
+  signed_frame_t io_next_frame;
+  DiskStreamRegionInfo io_info;
+
+  /** Number of underruns for this slot. */
+  volatile gint  num_underruns;
+} DiskStreamSlot;
+
+/**
+ * Streams audio clips that are too long to be
+ * kept in memory from their files in the pool.
+ *
+ * Each region being played back gets a slot with
+ * a read-ahead buffer that is filled by a
+ * dedicated I/O thread. Buffers are refilled from
+ * the new position on transport jumps, and
+ * region/transport loop points are followed so
+ * that looping does not need a refill.
+ */
+typedef struct DiskStreamer
+{
+  DiskStreamSlot slots[DISK_STREAMER_NUM_SLOTS];
+
+  GThread *      thread;
+
+  /** Posted when there is work for the I/O
+   * thread. */
+  ZixSem         io_sem;
+
+  volatile gint  run;
+
+  /**
+   * Held by the I/O thread while accessing clips.
+   *
+   * @see disk_streamer_forget_clip().
+   */
+  GMutex         clip_lock;
+
+  /**
+   * Signaled by the I/O thread after each pass
+   * over the slots, with @ref clip_lock held.
+   *
+   * Used to wait for the data when exporting.
+   */
+  GCond          filled_cond;
+
+  /** Current engine cycle. */
+  gint64         cycle;
+
+  /** Total number of underruns. */
+  volatile gint  num_underruns;
+} DiskStreamer;
+
+/**
+ * Creates a new streamer and starts its I/O
+ * thread.
+ */
+DiskStreamer *
+disk_streamer_new (void);
+
+/**
+ * Returns the global frame following @p frame in
+ * playback order for a region, taking region and
+ * transport loops into account, or -1 if the
+ * region will not be played anymore.
+ */
+NONNULL
+PURE
+signed_frame_t
+disk_streamer_get_next_frame (
+  const DiskStreamRegionInfo * info,
+  signed_frame_t               frame);
+
+/**
+ * To be called by the engine at the start of each
+ * cycle, before any audio is read.
+ *
+ * Frees the slots of regions that were not played
+ * in the previous cycle.
+ */
+NONNULL
+HOT
+void
+disk_streamer_begin_cycle (
+  DiskStreamer * self);
+
+/**
+ * Reads @p nframes frames of the streamed clip of
+ * @p region starting at global frame @p
+ * g_start_frame.
+ *
+ * Frames outside the region are set to 0. If the
+ * data is not ready yet (eg, right after a
+ * transport jump), silence is returned, unless
+ * exporting, in which case this blocks until the
+ * data is read.
+ *
+ * @return Whether data was read.
+ */
+NONNULL
+HOT
+bool
+disk_streamer_read (
+  DiskStreamer *  self,
+  ZRegion *       region,
+  AudioClip *     clip,
+  unsigned_frame_t g_start_frame,
+  nframes_t       nframes,
+  float *         lbuf,
+  float *         rbuf);
+
+/**
+ * Stops using the given clip.
+ *
+ * Must be called before the clip's file becomes
+ * invalid.
+ */
+NONNULL
+void
+disk_streamer_forget_clip (
+  DiskStreamer * self,
+  AudioClip *    clip);
+
+/**
+ * Returns the total number of underruns.
+ */
+NONNULL
+int
+disk_streamer_get_num_underruns (
+  DiskStreamer * self);
+
+/**
+ * Stops the I/O thread and frees the streamer.
+ */
+NONNULL
+void
+disk_streamer_free (
+  DiskStreamer * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -78,6 +78,8 @@ typedef struct Project Project;
 typedef struct HardwareProcessor HardwareProcessor;
 typedef struct ObjectPool ObjectPool;
 typedef struct MPMCQueue MPMCQueue;
+typedef struct DiskStreamer DiskStreamer;
+typedef struct TempoMap TempoMap;
 
 /**
  * @addtogroup audio Audio
@@ -159,6 +161,10 @@ typedef enum AudioEngineEventType
 {
   AUDIO_ENGINE_EVENT_BUFFER_SIZE_CHANGE,
   AUDIO_ENGINE_EVENT_SAMPLE_RATE_CHANGE,
+
+  /** The tempo map needs to be rebuilt after a
+   * change in a processing thread. */
+  AUDIO_ENGINE_EVENT_TEMPO_CHANGE,
 } AudioEngineEventType;
 
 /**
@@ -438,6 +444,29 @@ typedef struct AudioEngine
    */
   double            ticks_per_frame;
 
+  /**
+   * Tempo map used for converting positions.
+   *
+   * AudioEngine.frames_per_tick is the value at
+   * the current BPM.
+   */
+  TempoMap *        tempo_map;
+
+  /**
+   * Source that updates the positions of region
+   * children in the GTK thread after a tempo
+   * change, or 0.
+   */
+  guint             refresh_positions_source_id;
+
+  /** Next track to be handled by the source
+   * above. */
+  volatile gint     refresh_positions_track_idx;
+
+  /** Whether an AUDIO_ENGINE_EVENT_TEMPO_CHANGE
+   * is queued. */
+  volatile gint     tempo_change_queued;
+
   /** True iff buffer size callback fired. */
   int               buf_size_set;
 
@@ -697,6 +726,9 @@ typedef struct AudioEngine
 
   SampleProcessor * sample_processor;
 
+  /** Streamer for long audio clips. */
+  DiskStreamer *    disk_streamer;
+
   /** To be set to 1 when the CC from the Midi in
    * port should be captured. */
   int               capture_cc;
@@ -954,6 +986,11 @@ engine_activate (
  * Updates frames per tick based on the time sig,
  * the BPM, and the sample rate
  *
+ * When called from another thread while the
+ * engine is running (eg, the processing kickoff
+ * thread), the tempo map is rebuilt later in the
+ * GTK thread.
+ *
  * @param thread_check Whether to throw a warning
  *   if not called from GTK thread.
  * @param update_from_ticks Whether to update the
@@ -969,6 +1006,15 @@ engine_update_frames_per_tick (
   bool                thread_check,
   bool                update_from_ticks);
 
+/**
+ * Rebuilds the tempo map after the tempo
+ * automation was edited and updates all positions
+ * if it changed.
+ */
+void
+engine_update_tempo_map (
+  AudioEngine * self);
+
 /**
  * GSourceFunc to be added using idle add.
  *
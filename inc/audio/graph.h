@@ -79,6 +79,12 @@ typedef struct ModulatorMacroProcessor
 
 #define MAX_GRAPH_THREADS 128
 
+/**
+ * Max number of distinct route playback latencies
+ * remembered in Graph.route_latencies.
+ */
+#define GRAPH_MAX_ROUTE_LATENCIES 16
+
 /**
  * Graph.
  */
@@ -170,6 +176,37 @@ typedef struct Graph
    */
   GPtrArray *          external_out_ports;
 
+  /**
+   * Audio buffers shared by plugin ports whose
+   * lifetimes in the graph don't overlap,
+   * allocated when the graph is set up.
+   *
+   * @see Port.buf_pooled.
+   */
+  float *              port_buf_pool;
+
+  /** Number of buffers in @ref port_buf_pool. */
+  int                  num_pooled_bufs;
+
+  /** Number of ports using @ref port_buf_pool. */
+  int                  num_pooled_ports;
+
+  /** Whether to assign ports to the buffer pool
+   * (can be disabled for benchmarking). */
+  bool                 use_buf_pool;
+
+  /**
+   * Distinct route playback latencies of the
+   * nodes, set in graph_update_latencies().
+   *
+   * Used to precompute a transport snapshot for
+   * each latency offset at the start of each
+   * cycle.
+   */
+  nframes_t
+    route_latencies[GRAPH_MAX_ROUTE_LATENCIES];
+  int                  num_route_latencies;
+
 } Graph;
 
 void
@@ -28,6 +28,7 @@
 
 #include <stdbool.h>
 
+#include "audio/port_identifier.h"
 #include "utils/types.h"
 
 #include <gtk/gtk.h>
@@ -65,6 +66,14 @@ typedef struct Meter
   /** Port associated with this meter. */
   Port *          port;
 
+  /** Identifier of @ref port, used to check that
+   * the port still exists before unsubscribing
+   * from it. */
+  PortIdentifier  port_id;
+
+  /** Whether subscribed to the port's data. */
+  bool            observing;
+
   /** True peak processor. */
   TruePeakDsp *   true_peak_processor;
   TruePeakDsp *   true_peak_max_processor;
@@ -118,6 +127,18 @@ meter_get_value (
   float *          val,
   float *          max);
 
+/**
+ * Subscribes to or unsubscribes from the data of
+ * the port.
+ *
+ * To be called when the UI element showing the
+ * meter is mapped or unmapped.
+ */
+void
+meter_set_observing (
+  Meter * self,
+  bool    observing);
+
 void
 meter_free (
   Meter * self);
@@ -32,6 +32,7 @@
 #include <string.h>
 
 #include "utils/types.h"
+#include "zix/ring.h"
 #include "zix/sem.h"
 
 #ifdef HAVE_JACK
@@ -48,9 +49,29 @@ typedef struct ChordDescriptor ChordDescriptor;
  * @{
  */
 
-/** Max events to hold in queues. */
+/** Max events to hold in a MidiEvents buffer. */
 #define MAX_MIDI_EVENTS 2560
 
+/**
+ * Max bytes of messages longer than 3 bytes (such
+ * as SysEx) to hold in a MidiEvents buffer.
+ */
+#define MIDI_EVENTS_MAX_LONG_DATA 65536
+
+/** Initial number of events a MidiEvents buffer
+ * can hold. */
+#define MIDI_EVENTS_INITIAL_SIZE 32
+
+/** Initial bytes of long data a MidiEvents buffer
+ * can hold. */
+#define MIDI_EVENTS_INITIAL_LONG_DATA 256
+
+/**
+ * Max number of events in the queue of a
+ * MidiEvents buffer.
+ */
+#define MIDI_EVENTS_QUEUE_SIZE 1024
+
 /**
  * Timed MIDI event.
  */
@@ -60,13 +81,22 @@ typedef struct MidiEvent
    * start of the current cycle. */
   midi_time_t    time;
 
-  /** Time using g_get_monotonic_time (). */
-  gint64         systime;
-
-  /** Raw MIDI data. */
+  /**
+   * Raw MIDI data.
+   *
+   * For messages longer than 3 bytes, this only
+   * holds the first 3 bytes. The full message can
+   * be obtained with midi_events_get_event_data().
+   */
   midi_byte_t    raw_buffer[3];
 
-  size_t         raw_buffer_sz;
+  /** Size of the message. */
+  uint16_t       raw_buffer_sz;
+
+  /** Offset of the full message in
+   * MidiEvents.long_data, if the message is longer
+   * than 3 bytes. */
+  uint16_t       long_data_offset;
 
 } MidiEvent;
 
@@ -82,24 +112,73 @@ typedef struct MidiEvents
   /** Event count. */
   volatile int num_events;
 
-  /** Events to use in this cycle. */
-  MidiEvent  events[MAX_MIDI_EVENTS];
+  /**
+   * Events to use in this cycle.
+   *
+   * This starts at MIDI_EVENTS_INITIAL_SIZE events
+   * and grows up to MAX_MIDI_EVENTS, keeping its
+   * size afterwards.
+   *
+   * In the realtime threads, it grows by swapping
+   * in @ref spare_events, so adding events never
+   * allocates there.
+   */
+  MidiEvent *  events;
+
+  /** Number of events @ref events can hold. */
+  volatile gint events_size;
+
+  /** Data of the events with messages longer than
+   * 3 bytes.
+   *
+   * This grows like @ref events, up to
+   * MIDI_EVENTS_MAX_LONG_DATA bytes. */
+  midi_byte_t * long_data;
+
+  /** Bytes @ref long_data can hold. */
+  volatile gint long_data_size;
+
+  /** Bytes used in @ref long_data. */
+  size_t       long_data_len;
 
   /**
-   * For queueing events from the GUI or from ALSA
-   * at random times, since they run in different
-   * threads.
+   * Larger buffers prepared outside the realtime
+   * threads, or NULL.
    *
-   * Engine will copy them to the
-   * original MIDI events when ready to be processed
+   * These are only set while NULL (see
+   * midi_events_prepare_spares()) and only taken
+   * by the thread adding events.
+   */
+  MidiEvent *  spare_events;
+  gint         spare_events_size;
+  midi_byte_t * spare_long_data;
+  gint         spare_long_data_size;
+
+  /** Buffers replaced in the realtime threads,
+   * to be freed outside them. */
+  MidiEvent *  retired_events;
+  midi_byte_t * retired_long_data;
+
+  /** Whether the spare buffers need to be
+   * prepared again. */
+  volatile gint needs_spares;
+
+  /**
+   * Lock-free queue for events added from the GUI
+   * or from ALSA at random times, since they run in
+   * different threads.
+   *
+   * Engine will append them to the main events
+   * when ready to be processed (see
+   * midi_events_dequeue()).
    *
-   * Also has other uses.
+   * This is created on first use.
    */
-  MidiEvent  queued_events[MAX_MIDI_EVENTS];
-  volatile int num_queued_events;
+  ZixRing *    queue;
 
-  /** Semaphore for exclusive read/write. */
-  ZixSem     access_sem;
+  /** Semaphore for exclusive access among writers
+   * to @ref queue (the reader does not wait). */
+  ZixSem       queue_sem;
 
 } MidiEvents;
 
@@ -137,6 +216,21 @@ midi_event_copy (
   memcpy (dest, src, sizeof (MidiEvent));
 }
 
+/**
+ * Returns the full message of an event in the
+ * given MidiEvents.
+ */
+static inline const midi_byte_t *
+midi_events_get_event_data (
+  const MidiEvents * self,
+  const MidiEvent *  ev)
+{
+  if (ev->raw_buffer_sz > 3)
+    return &self->long_data[ev->long_data_offset];
+  else
+    return ev->raw_buffer;
+}
+
 NONNULL
 void
 midi_event_set_velocity (
@@ -155,6 +249,7 @@ midi_events_are_equal (
 {
   return
     dest->time == src->time
+    && dest->raw_buffer_sz == src->raw_buffer_sz
     && dest->raw_buffer[0] == src->raw_buffer[0]
     && dest->raw_buffer[1] == src->raw_buffer[1]
     && dest->raw_buffer[2] == src->raw_buffer[2];
@@ -208,7 +303,8 @@ midi_events_append_w_filter (
  * Adds a note on event to the given MidiEvents.
  *
  * @param channel MIDI channel starting from 1.
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_note_on (
@@ -260,7 +356,9 @@ midi_events_add_cc_volume (
  * events.
  *
  * @param check_main Check the main events.
- * @param check_queued Check the queued events.
+ * @param check_queued Check the queued events
+ *   (not supported, the queue can not be
+ *   inspected).
  */
 int
 midi_events_has_note_on (
@@ -271,7 +369,7 @@ midi_events_has_note_on (
 /**
  * Parses a MidiEvent from a raw MIDI buffer.
  *
- * This must be a full 3-byte message. If in
+ * This must be a full message. If in
  * 'running status' mode, the caller is responsible
  * for prepending the status byte.
  */
@@ -287,7 +385,8 @@ midi_events_add_event_from_buf (
  * Adds a note off event to the given MidiEvents.
  *
  * @param channel MIDI channel starting from 1.
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_note_off (
@@ -301,7 +400,8 @@ midi_events_add_note_off (
  * Adds a control event to the given MidiEvents.
  *
  * @param channel MIDI channel starting from 1.
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_control_change (
@@ -312,6 +412,12 @@ midi_events_add_control_change (
   midi_time_t  time,
   int          queued);
 
+/**
+ * Adds a raw MIDI message.
+ *
+ * Messages longer than 3 bytes (such as SysEx) are
+ * supported.
+ */
 void
 midi_events_add_raw (
   MidiEvents * self,
@@ -325,7 +431,8 @@ midi_events_add_raw (
  *
  * @param channel MIDI channel starting from 1.
  * @param pitchbend -8192 to 8191
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_pitchbend (
@@ -353,7 +460,9 @@ midi_events_panic (
 /**
  * Clears midi events.
  *
- * @param queued Clear queued events instead.
+ * @param queued Discard the events in the queue
+ *   instead. This must only be called from the
+ *   thread that dequeues the events.
  */
 void
 midi_events_clear (
@@ -372,7 +481,10 @@ midi_events_clear_duplicates (
   const int    queued);
 
 /**
- * Copies the queue contents to the original struct
+ * Appends the events in the queue to the main
+ * events.
+ *
+ * This does not block the writers of the queue.
  */
 void
 midi_events_dequeue (
@@ -442,6 +554,17 @@ void
 midi_events_panic_all (
   const bool queued);
 
+/**
+ * Prepares larger spare buffers for the MidiEvents
+ * that grew in the realtime threads and frees
+ * the buffers they replaced.
+ *
+ * To be called periodically from a non-realtime
+ * thread.
+ */
+void
+midi_events_prepare_spares (void);
+
 /**
  * Frees the MIDI events.
  */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2020-2021 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2020-2022 Alexandros Theodotou <alex at zrythm dot org>
  *
  * This file is part of Zrythm
  *
@@ -29,6 +29,8 @@
 #include "ext/midilib/src/midifile.h"
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @addtogroup audio
@@ -36,6 +38,100 @@
  * @{
  */
 
+/**
+ * A note read from a MIDI file.
+ */
+typedef struct MidiFileNote
+{
+  /** Start position in ticks. */
+  double         start_ticks;
+
+  /** End position in ticks, or -1 if the note
+   * was never ended. */
+  double         end_ticks;
+
+  uint8_t        pitch;
+  uint8_t        vel;
+} MidiFileNote;
+
+/**
+ * The contents of a track in a MIDI file.
+ *
+ * Positions are in ticks relative to the start of
+ * the file.
+ */
+typedef struct MidiFileTrack
+{
+  /** Index of the track in the file. */
+  int            idx;
+
+  /** Whether the track has any data other than
+   * meta events and note offs. */
+  bool           has_data;
+
+  /** Track name, if any. */
+  char *         name;
+
+  /** Notes in the order of their note on
+   * events. */
+  MidiFileNote * notes;
+  int            num_notes;
+  size_t         notes_size;
+
+  /** Position of the end of the track, or -1 if
+   * the track has no end sequence event. */
+  double         end_ticks;
+
+  /** Position of the last event. */
+  double         last_ticks;
+} MidiFileTrack;
+
+/**
+ * The contents of a MIDI file, read once so that
+ * regions can be created for each track without
+ * going through the file again.
+ */
+typedef struct MidiFile
+{
+  MidiFileTrack * tracks;
+  int             num_tracks;
+
+  /** Number of tracks with data. */
+  int             num_nonempty_tracks;
+} MidiFile;
+
+/**
+ * Reads all the tracks of the given MIDI file.
+ *
+ * The tracks are parsed in parallel in worker
+ * threads.
+ *
+ * @return The contents, or NULL if the file could
+ *   not be opened.
+ */
+MidiFile *
+midi_file_new (
+  const char * abs_path);
+
+/**
+ * Returns the track with data at the given index.
+ *
+ * @param idx The index of the track, starting from
+ *   0, counting only tracks with data. If idx 1 is
+ *   requested and the MIDI file only has data in
+ *   tracks 5 and 7, track 7 is returned.
+ */
+NONNULL
+MidiFileTrack *
+midi_file_get_nonempty_track (
+  MidiFile * self,
+  int        idx);
+
+NONNULL
+void
+midi_file_free (
+  MidiFile * self);
+
 /**
  * Returns whether the given track in the midi file
  * has data.
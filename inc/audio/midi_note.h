@@ -242,6 +242,37 @@ midi_note_set_val (
   MidiNote *    midi_note,
   const uint8_t val);
 
+/**
+ * Sends a note off if currently playing and sets
+ * the pitch of a note of the given region.
+ *
+ * Unlike midi_note_set_val(), this does not look
+ * up the region or mark its notes as changed, so
+ * when changing many notes
+ * region_notes_changed() can be called once per
+ * region afterwards.
+ */
+NONNULL
+void
+midi_note_set_val_in_region (
+  MidiNote *    self,
+  ZRegion *     region,
+  const uint8_t val);
+
+/**
+ * Marks the notes of the region the note belongs
+ * to as changed.
+ *
+ * Does nothing if the note is not in a region of
+ * the project (eg, clones in selections).
+ *
+ * @see region_notes_changed().
+ */
+NONNULL
+void
+midi_note_notify_changed (
+  MidiNote * self);
+
 ZRegion *
 midi_note_get_region (
   MidiNote * self);
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Compact copy of the MIDI notes of a region used
+ * for playback.
+ */
+
+#ifndef __AUDIO_MIDI_NOTE_COLUMNS_H__
+#define __AUDIO_MIDI_NOTE_COLUMNS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+typedef struct ZRegion ZRegion;
+typedef struct MidiEvents MidiEvents;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * The MIDI notes of a region as columns sorted
+ * by start position, so that the notes sounding
+ * in a cycle can be found with a binary search
+ * and read from a few contiguous arrays instead
+ * of following the pointers of each MidiNote.
+ *
+ * The columns are built from the notes of the
+ * region in a non-realtime thread and never
+ * modified after they are published to the
+ * region. They are replaced when the notes
+ * change.
+ *
+ * The MidiNote's stay the canonical data, so this
+ * is a derived copy that adds about 26 bytes per
+ * note (plus the array headers) to each MIDI
+ * region.
+ *
+ * Muted notes are left out.
+ *
+ * Positions are region-local frames.
+ *
+ * @see midi_region_update_note_columns().
+ */
+typedef struct MidiNoteColumns
+{
+  signed_frame_t * start_frames;
+  signed_frame_t * end_frames;
+
+  /**
+   * Maximum end frames of the notes up to and
+   * including each index.
+   *
+   * This is non-decreasing, so notes that end
+   * before a position can be skipped with a
+   * binary search.
+   */
+  signed_frame_t * max_end_frames;
+
+  uint8_t *        pitches;
+  uint8_t *        vels;
+
+  int              num_notes;
+
+  /** Region children epoch the frames are
+   * valid for.
+   *
+   * @see ZRegion.children_epoch. */
+  gint             epoch;
+
+  /** Region notes version the columns were
+   * built from.
+   *
+   * @see ZRegion.notes_version. */
+  gint             notes_version;
+} MidiNoteColumns;
+
+/**
+ * Creates columns from the notes of the region.
+ *
+ * The positions of the notes must be up to date.
+ */
+NONNULL
+MidiNoteColumns *
+midi_note_columns_new (
+  ZRegion * region);
+
+/**
+ * Returns whether the columns match the notes of
+ * the region.
+ *
+ * This is realtime-safe.
+ */
+NONNULL
+HOT
+bool
+midi_note_columns_is_up_to_date (
+  const MidiNoteColumns * self,
+  ZRegion *               region);
+
+/**
+ * Adds the note ons and note offs in the given
+ * range of local frames.
+ *
+ * This behaves exactly like going through the
+ * MidiNote's of the region.
+ *
+ * @param r_local_pos Region-local position at the
+ *   start of the range.
+ * @param local_offset Offset of the range in the
+ *   cycle.
+ */
+NONNULL
+HOT
+void
+midi_note_columns_fill_midi_events (
+  const MidiNoteColumns * self,
+  signed_frame_t          r_local_pos,
+  nframes_t               local_offset,
+  nframes_t               nframes,
+  midi_byte_t             channel,
+  MidiEvents *            midi_events);
+
+NONNULL
+void
+midi_note_columns_free (
+  MidiNoteColumns * self);
+
+/**
+ * @}
+ */
+
+#endif
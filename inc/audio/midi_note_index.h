@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Index of the MIDI notes of a region by
+ * position.
+ */
+
+#ifndef __AUDIO_MIDI_NOTE_INDEX_H__
+#define __AUDIO_MIDI_NOTE_INDEX_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <glib.h>
+
+typedef struct MidiNote MidiNote;
+typedef struct ZRegion ZRegion;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * A note in the sorted list.
+ */
+typedef struct MidiNoteIndexEntry
+{
+  /** Start ticks. */
+  double         start;
+
+  /** Index in the region's notes. */
+  int            idx;
+} MidiNoteIndexEntry;
+
+/**
+ * Notes of a MIDI region sorted by start
+ * position, used to find the notes in a range
+ * without going through all the notes of the
+ * region.
+ *
+ * The sorted notes form an implicit balanced
+ * binary search tree (the root of each range of
+ * notes is its middle note) augmented with the
+ * maximum end of each subtree, ie, an interval
+ * tree, so finding the notes overlapping with a
+ * range only visits the subtrees that contain
+ * such notes, instead of all notes that start
+ * before the range.
+ *
+ * The index is only rebuilt when the notes
+ * version of the region changes.
+ *
+ * Positions are region-local ticks.
+ *
+ * @see ZRegion.notes_version.
+ */
+typedef struct MidiNoteIndex
+{
+  /** Notes at the last rebuild, in region
+   * order. */
+  MidiNote **    notes;
+
+  int            num_notes;
+  size_t         notes_size;
+
+  /** Notes sorted by start position. */
+  MidiNoteIndexEntry * sorted;
+
+  /**
+   * Maximum end ticks of the subtree rooted at
+   * each sorted note.
+   *
+   * Subtrees whose notes all end before a range
+   * are skipped when searching.
+   */
+  double *       subtree_max_ends;
+
+  /**
+   * Sorted indices of the notes found by the last
+   * midi_note_index_find(), in order of start
+   * position.
+   */
+  int *          found;
+
+  /** Lowest/highest pitch, or 127/0 if there are
+   * no notes. */
+  uint8_t        min_val;
+  uint8_t        max_val;
+
+  /** Whether the index was built at least
+   * once. */
+  bool           built;
+
+  /** Region notes version the index was built
+   * for. */
+  gint           notes_version;
+} MidiNoteIndex;
+
+MidiNoteIndex *
+midi_note_index_new (void);
+
+/**
+ * Rebuilds the index if the notes of the region
+ * changed since it was last built.
+ *
+ * @return Whether the index was rebuilt.
+ */
+NONNULL
+bool
+midi_note_index_update (
+  MidiNoteIndex * self,
+  ZRegion *       region);
+
+/**
+ * Finds the notes overlapping with the given
+ * range (inclusive).
+ *
+ * The sorted indices of the notes are stored in
+ * @ref MidiNoteIndex.found until the next call.
+ *
+ * @return The number of notes found.
+ */
+NONNULL
+HOT
+int
+midi_note_index_find (
+  MidiNoteIndex * self,
+  double          start_ticks,
+  double          end_ticks);
+
+/**
+ * Returns the note at the given sorted index.
+ */
+NONNULL
+static inline MidiNote *
+midi_note_index_get_note (
+  MidiNoteIndex * self,
+  int             idx)
+{
+  return self->notes[self->sorted[idx].idx];
+}
+
+NONNULL
+void
+midi_note_index_free (
+  MidiNoteIndex * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -32,11 +32,15 @@
 
 #include "utils/types.h"
 
+#include <glib.h>
+
 typedef struct Track Track;
 typedef struct Position Position;
 typedef struct MidiNote MidiNote;
 typedef struct ZRegion ZRegion;
 typedef struct MidiEvents MidiEvents;
+typedef struct MidiNoteIndex MidiNoteIndex;
+typedef struct MidiFileTrack MidiFileTrack;
 typedef struct ChordDescriptor ChordDescriptor;
 typedef struct Velocity Velocity;
 typedef ZRegion MidiRegion;
@@ -59,6 +63,25 @@ midi_region_new (
   int              lane_pos,
   int              idx_inside_lane);
 
+/**
+ * Creates a MIDI region from the given track of a
+ * MIDI file, starting at the given Position.
+ *
+ * All the notes are created at once without
+ * publishing any events.
+ *
+ * @return The region, or NULL if the track is
+ *   empty.
+ */
+NONNULL
+ZRegion *
+midi_region_new_from_midi_file_track (
+  const Position *      start_pos,
+  const MidiFileTrack * track,
+  unsigned int          track_name_hash,
+  int                   lane_pos,
+  int                   idx_inside_lane);
+
 /**
  * Creates a MIDI region from the given MIDI
  * file path, starting at the given Position.
@@ -148,10 +171,7 @@ midi_region_pop_unended_note (
   int       pitch);
 
 /**
- * Fills MIDI event queue from the region.
- *
- * The events are dequeued right after the call to
- * this function.
+ * Fills MIDI events from the region.
  *
  * @note The caller already splits calls to this
  *   function at each sub-loop inside the region,
@@ -324,6 +344,35 @@ midi_region_get_velocities_in_range (
   size_t *         velocities_size,
   int              inside);
 
+/**
+ * Returns the index of the notes of the region,
+ * rebuilt if the notes changed.
+ *
+ * @see midi_note_index_update().
+ */
+NONNULL
+MidiNoteIndex *
+midi_region_get_note_index (
+  ZRegion * self);
+
+/**
+ * Replaces the note columns of the region if
+ * they don't match its notes anymore.
+ *
+ * Regions whose children positions are outdated
+ * after a tempo change are skipped, since the
+ * engine refreshes them a few tracks at a time
+ * and converts their ticks until then.
+ *
+ * Must not be called from the realtime thread.
+ *
+ * @return Whether the columns were replaced.
+ */
+NONNULL
+bool
+midi_region_update_note_columns (
+  ZRegion * self);
+
 /**
  * Frees members only but not the midi region itself.
  *
@@ -74,8 +74,37 @@ typedef struct AudioPool
 
   /** Array sizes. */
   size_t         clips_size;
+
+  /**
+   * Store for clip frames kept in shared blocks
+   * (eg, audio held by the undo history).
+   *
+   * Not serialized.
+   */
+  AudioClipBlockStore * block_store;
 } AudioPool;
 
+/**
+ * Memory used by the clips in the pool.
+ */
+typedef struct AudioPoolMemoryUsage
+{
+  /** Bytes in contiguous frame buffers of clips
+   * used by the project. */
+  size_t         project_bytes;
+
+  /** Bytes in contiguous frame buffers of clips
+   * only used by the undo history. */
+  size_t         undo_bytes;
+
+  /** Bytes allocated for shared blocks. */
+  size_t         block_bytes;
+
+  /** Bytes referenced by clips in blocks (the
+   * memory that would be used without sharing). */
+  size_t         block_referenced_bytes;
+} AudioPoolMemoryUsage;
+
 static const cyaml_schema_field_t
 audio_pool_fields_schema[] =
 {
@@ -191,18 +220,6 @@ audio_pool_gen_name_for_recording_clip (
   Track *     track,
   int         lane);
 
-/**
- * Loads the frame buffers of clips currently in
- * use in the project from their files and frees the
- * buffers of clips not currently in use.
- *
- * This should be called whenever there is a relevant
- * change in the project (eg, object added/removed).
- */
-void
-audio_pool_reload_clip_frame_bufs (
-  AudioPool * self);
-
 /**
  * Writes all the clips to disk.
  *
@@ -215,6 +232,29 @@ audio_pool_write_to_disk (
   AudioPool * self,
   bool        is_backup);
 
+/**
+ * Fills in the memory used by the clips in the
+ * pool.
+ *
+ * @note This walks the undo history and must be
+ *   called from the main thread.
+ */
+NONNULL
+void
+audio_pool_get_memory_usage (
+  AudioPool *            self,
+  AudioPoolMemoryUsage * usage);
+
+/**
+ * Returns a newly allocated human-readable summary
+ * of the memory used by the pool.
+ */
+NONNULL
+MALLOC
+char *
+audio_pool_get_memory_usage_as_string (
+  AudioPool * self);
+
 /**
  * To be used during serialization.
  */
@@ -446,15 +446,15 @@ typedef struct Port
   int                 deleting;
 
   /**
-   * Flag to indicate if the ring buffers below
-   * should be filled or not.
+   * Number of UI elements (meters, scopes, etc.)
+   * subscribed to the port's data.
    *
-   * If a UI element that needs them becomes
-   * mapped (visible), this should be set to
-   * 1, and when unmapped (invisible) it should
-   * be set to 0.
+   * The ring buffers below are only created and
+   * filled while this is non-zero.
+   *
+   * @see port_add_observer().
    */
-  bool                write_ring_buffers;
+  volatile gint       num_observers;
 
   /** Whether the port has midi events not yet
    * processed by the UI. */
@@ -587,6 +587,21 @@ typedef struct Port
   /** Last allocated buffer size (used for audio
    * ports). */
   size_t              last_buf_sz;
+
+  /**
+   * Whether @ref Port.buf points to a buffer in
+   * the graph's buffer pool (shared with other
+   * ports whose lifetimes don't overlap) instead
+   * of being owned by the port.
+   *
+   * Pooled buffers are not cleared at the start
+   * of the cycle, so their contents are only
+   * valid after the port is written in the
+   * current cycle.
+   *
+   * @see graph_setup().
+   */
+  bool                buf_pooled;
 } Port;
 
 static const cyaml_schema_field_t
@@ -738,6 +753,64 @@ void
 port_free_bufs (
   Port * self);
 
+/**
+ * Subscribes a UI element (meter, scope, etc.) to
+ * the port's data.
+ *
+ * While the port has observers, the engine
+ * publishes its data to @ref Port.audio_ring or
+ * @ref Port.midi_ring each cycle.
+ *
+ * Must be called from the GUI thread.
+ */
+NONNULL
+void
+port_add_observer (
+  Port * self);
+
+/**
+ * Removes a subscription added with
+ * port_add_observer().
+ *
+ * Must be called from the GUI thread.
+ */
+NONNULL
+void
+port_remove_observer (
+  Port * self);
+
+/**
+ * Returns whether @p port is still the port with
+ * the given identifier in the project.
+ *
+ * The port may have been free'd along with its
+ * track, plugin or project before a UI element
+ * holding it unsubscribes, so @p port is not
+ * dereferenced.
+ *
+ * Must be called from the GUI thread.
+ */
+NONNULL_ARGS (1)
+bool
+port_is_alive (
+  const PortIdentifier * id,
+  const Port *           port);
+
+/**
+ * Returns whether any UI element is subscribed to
+ * the port's data.
+ *
+ * This is lock-free and can be called from the
+ * engine.
+ */
+static inline bool
+port_is_observed (
+  Port * self)
+{
+  return
+    g_atomic_int_get (&self->num_observers) > 0;
+}
+
 /**
  * Creates blank stereo ports.
  */
@@ -1198,6 +1271,10 @@ port_disconnect_all (Port * port);
 
 /**
  * Applies the pan to the given L/R ports.
+ *
+ * @param start_frame The start frame offset from
+ *   0 in this cycle.
+ * @param nframes The number of frames to process.
  */
 NONNULL
 void
@@ -1205,7 +1282,9 @@ port_apply_pan_stereo (Port *       l,
                        Port *       r,
                        float        pan,
                        PanLaw       pan_law,
-                       PanAlgorithm pan_algo);
+                       PanAlgorithm pan_algo,
+                       nframes_t    start_frame,
+                       const nframes_t nframes);
 
 /**
  * Applies the pan to the given port.
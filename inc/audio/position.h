@@ -384,6 +384,27 @@ position_update (
     position_update_ticks_from_frames (self);
 }
 
+/**
+ * Updates a region-local position from ticks or
+ * frames, relative to the start of its region.
+ *
+ * With a constant tempo this is the same as
+ * position_update().
+ *
+ * @param from_ticks Whether to update the
+ *   position based on ticks (true) or frames
+ *   (false).
+ * @param region_start Start position of the
+ *   region.
+ */
+HOT
+NONNULL
+void
+position_update_local (
+  Position *       self,
+  bool             from_ticks,
+  const Position * region_start);
+
 /**
  * Calculates the midway point between the two
  * Positions and sets it on pos.
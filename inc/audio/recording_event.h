@@ -81,6 +81,15 @@ typedef enum RecordingEventType
 
   RECORDING_EVENT_TYPE_STOP_TRACK_RECORDING,
   RECORDING_EVENT_TYPE_STOP_AUTOMATION_RECORDING,
+
+  /**
+   * Requests the creation of the MIDI CC port for
+   * the CC in the MIDI event.
+   *
+   * The value in the MIDI event is applied to the
+   * port after creating it.
+   */
+  RECORDING_EVENT_TYPE_CREATE_MIDI_CC_PORT,
 } RecordingEventType;
 
 /**
@@ -28,6 +28,8 @@
 #include "audio/automation_point.h"
 #include "audio/chord_object.h"
 #include "audio/midi_note.h"
+#include "audio/midi_note_columns.h"
+#include "audio/midi_note_index.h"
 #include "audio/midi_region.h"
 #include "audio/position.h"
 #include "audio/region_identifier.h"
@@ -92,6 +94,29 @@ region_musical_mode_strings[] =
     REGION_MUSICAL_MODE_ON },
 };
 
+/**
+ * Low-detail raster of the notes of a MIDI
+ * region, used when there are more notes than
+ * pixels.
+ */
+typedef struct RegionNotesRaster
+{
+  GdkTexture *   texture;
+
+  /** Region notes version, size and color the
+   * raster was drawn with.
+   *
+   * @see ZRegion.notes_version. */
+  gint           notes_version;
+  int            width;
+  int            height;
+  GdkRGBA        color;
+
+  /** Length, loop start, loop end and clip start
+   * ticks the raster was drawn with. */
+  double         ticks[4];
+} RegionNotesRaster;
+
 /**
  * A region (clip) is an object on the timeline that
  * contains either MidiNote's or AudioClip's.
@@ -240,6 +265,44 @@ typedef struct ZRegion
 
   /* ==== CHORD REGION END ==== */
 
+  /**
+   * Tempo map epoch the positions of the children
+   * were last updated for, or -1 if they need to
+   * be updated.
+   *
+   * Children positions are updated lazily after
+   * tempo changes, only in the GTK thread. This
+   * is set after all of them are updated.
+   *
+   * @see region_refresh_children_positions().
+   */
+  volatile gint      children_epoch;
+
+  /**
+   * Incremented every time a MIDI note of the
+   * region is added, removed, moved, muted or its
+   * pitch or velocity changes.
+   *
+   * Caches derived from the notes are only
+   * validated against this.
+   *
+   * @see region_notes_changed().
+   */
+  volatile gint      notes_version;
+
+  /**
+   * Compact copy of the MIDI notes used for
+   * playback, or NULL.
+   *
+   * Replaced atomically from non-realtime threads
+   * and only used while it is valid for
+   * @ref ZRegion.children_epoch and
+   * @ref ZRegion.notes_version.
+   *
+   * @see midi_region_update_note_columns().
+   */
+  MidiNoteColumns *  note_columns;
+
   /**
    * Set to ON during bouncing if this
    * region should be included.
@@ -296,6 +359,14 @@ typedef struct ZRegion
    * are used). */
   ArrangerObject     last_positions_obj;
 
+  /** Index of the MIDI notes, created on
+   * demand. */
+  MidiNoteIndex *    note_index;
+
+  /** Note rasters for the main and lane
+   * rectangles. */
+  RegionNotesRaster  notes_rasters[2];
+
   /* --- drawing caches end --- */
 
   int                magic;
@@ -508,6 +579,71 @@ region_stretch (
   ZRegion * self,
   double    ratio);
 
+/**
+ * Updates the positions of the children (notes,
+ * automation points, etc.) from their ticks,
+ * relative to the region start, if the tempo map
+ * changed since they were last updated.
+ *
+ * To be called before accessing the positions of
+ * the children. The children are only updated in
+ * the GTK thread, so this never writes to them
+ * in the audio threads, which should use
+ * region_get_child_frames() instead.
+ */
+NONNULL
+HOT
+void
+region_refresh_children_positions (
+  ZRegion * self);
+
+/**
+ * Returns the frames of @p pos, a region-local
+ * position of a child of the region (eg, a MIDI
+ * note).
+ *
+ * If the children were not refreshed after a
+ * tempo change yet (eg, when called from the
+ * audio threads), the frames are converted from
+ * the ticks with the current tempo map instead of
+ * using the outdated frames.
+ *
+ * This is realtime-safe.
+ */
+NONNULL
+HOT
+signed_frame_t
+region_get_child_frames (
+  ZRegion *        self,
+  const Position * pos);
+
+/**
+ * Marks the positions of the children as needing
+ * an update.
+ */
+NONNULL
+static inline void
+region_invalidate_children_positions (
+  ZRegion * self)
+{
+  g_atomic_int_set (&self->children_epoch, -1);
+}
+
+/**
+ * Marks the MIDI notes of the region as changed.
+ *
+ * To be called after any change to the notes.
+ *
+ * @see ZRegion.notes_version.
+ */
+NONNULL
+static inline void
+region_notes_changed (
+  ZRegion * self)
+{
+  g_atomic_int_inc (&self->notes_version);
+}
+
 /**
  * To be called every time the identifier changes
  * to update the region's children.
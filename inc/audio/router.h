@@ -49,6 +49,7 @@
 #include <pthread.h>
 
 #include "audio/engine.h"
+#include "audio/transport.h"
 #include "utils/types.h"
 
 #include "zix/ring.h"
@@ -82,6 +83,12 @@ typedef struct EngineProcessTimeInfo
 
 #define ROUTER (AUDIO_ENGINE->router)
 
+/**
+ * Max number of transport snapshots computed per
+ * processing split.
+ */
+#define ROUTER_MAX_TRANSPORT_SNAPSHOTS 32
+
 typedef struct Router
 {
   Graph *               graph;
@@ -109,6 +116,20 @@ typedef struct Router
    * for BPM/time signature changes. */
   ZixRing *             ctrl_port_change_queue;
 
+  /**
+   * Transport snapshots for the current split,
+   * one for each start frame the graph nodes will
+   * be processed at (after latency compensation
+   * and splitting at the loop points).
+   *
+   * These are computed before the graph is
+   * processed and are read-only while it is.
+   */
+  TransportSnapshot
+    transport_snapshots[
+      ROUTER_MAX_TRANSPORT_SNAPSHOTS];
+  int                   num_transport_snapshots;
+
 } Router;
 
 Router *
@@ -132,6 +153,22 @@ router_start_cycle (
   Router *              self,
   EngineProcessTimeInfo time_nfo);
 
+/**
+ * Returns the transport snapshot for the given
+ * start frame in the current split.
+ *
+ * If there is no precomputed snapshot for it (eg,
+ * outside the processing cycle), @p tmp is filled
+ * in and returned instead.
+ */
+HOT
+NONNULL
+const TransportSnapshot *
+router_get_transport_snapshot (
+  Router *            self,
+  unsigned_frame_t    g_start_frame,
+  TransportSnapshot * tmp);
+
 /**
  * Returns the max playback latency of the trigger
  * nodes.
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Precomputed tempo map.
+ */
+
+#ifndef __AUDIO_TEMPO_MAP_H__
+#define __AUDIO_TEMPO_MAP_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+typedef struct Track Track;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Maximum number of constant-tempo segments a
+ * curved tempo automation section is split into.
+ */
+#define TEMPO_MAP_MAX_CURVE_STEPS 256
+
+/**
+ * A section of the timeline with a constant tempo.
+ */
+typedef struct TempoMapSegment
+{
+  /** Start position in ticks. */
+  double ticks;
+
+  /** Start position in frames (not rounded). */
+  double frames;
+
+  double frames_per_tick;
+
+  /** Reciprocal of frames_per_tick. */
+  double ticks_per_frame;
+
+  bpm_t  bpm;
+} TempoMapSegment;
+
+/**
+ * Immutable segment table, swapped atomically on
+ * rebuild.
+ */
+typedef struct TempoMapTable
+{
+  /** Whether the table was built from tempo
+   * automation. */
+  bool            automated;
+
+  /** Engine cycle the table was replaced in. */
+  uint_fast64_t   retire_cycle;
+
+  /** Next replaced table waiting to be free'd. */
+  struct TempoMapTable * next_retired;
+
+  int             num_segments;
+
+  /** Segments sorted by position. The first one
+   * starts at 0 and is also used for negative
+   * positions. */
+  TempoMapSegment segments[];
+} TempoMapTable;
+
+/**
+ * Tempo map used for converting between ticks and
+ * frames.
+ *
+ * The map is built from the BPM automation of the
+ * tempo track (or the current BPM if there is no
+ * automation) and only needs to be rebuilt when
+ * the tempo, time signature or sample rate
+ * change, so that positions can be converted in
+ * O(log n) without relying on a single global
+ * frames per tick value.
+ *
+ * Region-local positions (eg, of MIDI notes) are
+ * converted relative to the start of their region
+ * (see tempo_map_local_ticks_to_frames()).
+ *
+ * The map is only rebuilt in non-realtime threads.
+ * Realtime threads only read the current table.
+ */
+typedef struct TempoMap
+{
+  /** Current table, or NULL if the map was not
+   * built yet. */
+  TempoMapTable * table;
+
+  /**
+   * Replaced tables, newest first.
+   *
+   * The processing threads may still be reading
+   * them, so they are only free'd once the engine
+   * has finished the cycle they were replaced in.
+   */
+  TempoMapTable * retired;
+
+  /**
+   * Incremented every time the map changes.
+   *
+   * Used to find positions that need to be
+   * recalculated.
+   */
+  volatile gint   epoch;
+
+  /** Parameters of the last rebuild. */
+  bpm_t           bpm;
+  int             beats_per_bar;
+  int             ticks_per_bar;
+  sample_rate_t   sample_rate;
+
+  /** Serializes rebuilds. */
+  GMutex          rebuild_lock;
+} TempoMap;
+
+TempoMap *
+tempo_map_new (void);
+
+/**
+ * Rebuilds the map.
+ *
+ * To be called when the tempo, time signature or
+ * sample rate change.
+ *
+ * Must not be called from realtime threads, since
+ * this allocates and locks.
+ *
+ * @param tempo_track Tempo track to read BPM
+ *   automation from, or NULL to only use @p bpm.
+ * @param bpm BPM to use if there is no tempo
+ *   automation.
+ *
+ * @return Whether the map changed.
+ */
+bool
+tempo_map_rebuild (
+  TempoMap *    self,
+  Track *       tempo_track,
+  bpm_t         bpm,
+  int           beats_per_bar,
+  int           ticks_per_bar,
+  sample_rate_t sample_rate);
+
+/**
+ * Returns whether rebuilding the map with the
+ * given parameters would change it.
+ *
+ * Changes to @p bpm only matter if the map is not
+ * built from tempo automation.
+ *
+ * This is realtime-safe.
+ */
+NONNULL
+HOT
+bool
+tempo_map_needs_rebuild (
+  TempoMap *    self,
+  bpm_t         bpm,
+  int           beats_per_bar,
+  int           ticks_per_bar,
+  sample_rate_t sample_rate);
+
+/**
+ * Rebuilds the map using the parameters of the
+ * last rebuild.
+ *
+ * To be called after the tempo automation is
+ * edited.
+ *
+ * @return Whether the map changed.
+ */
+NONNULL
+bool
+tempo_map_refresh (
+  TempoMap * self,
+  Track *    tempo_track);
+
+/**
+ * Returns whether the map was built.
+ */
+NONNULL
+static inline bool
+tempo_map_is_ready (
+  TempoMap * self)
+{
+  return
+    g_atomic_pointer_get (&self->table) != NULL;
+}
+
+/**
+ * Returns the current epoch of the map.
+ */
+NONNULL
+static inline gint
+tempo_map_get_epoch (
+  TempoMap * self)
+{
+  return g_atomic_int_get (&self->epoch);
+}
+
+/**
+ * Returns whether the map was built from tempo
+ * automation.
+ */
+NONNULL
+bool
+tempo_map_is_automated (
+  TempoMap * self);
+
+/**
+ * Converts ticks to (non-rounded) frames.
+ *
+ * The map must be ready.
+ */
+NONNULL
+HOT
+double
+tempo_map_ticks_to_frames (
+  TempoMap * self,
+  double     ticks);
+
+/**
+ * Converts frames to ticks.
+ *
+ * The map must be ready.
+ */
+NONNULL
+HOT
+double
+tempo_map_frames_to_ticks (
+  TempoMap * self,
+  double     frames);
+
+/**
+ * Converts region-local ticks to (non-rounded)
+ * region-local frames.
+ *
+ * The map must be ready.
+ *
+ * @param start_ticks Start of the region in
+ *   (global) ticks.
+ */
+NONNULL
+HOT
+double
+tempo_map_local_ticks_to_frames (
+  TempoMap * self,
+  double     start_ticks,
+  double     ticks);
+
+/**
+ * Converts region-local frames to region-local
+ * ticks.
+ *
+ * The map must be ready.
+ *
+ * @param start_ticks Start of the region in
+ *   (global) ticks.
+ */
+NONNULL
+HOT
+double
+tempo_map_local_frames_to_ticks (
+  TempoMap * self,
+  double     start_ticks,
+  double     frames);
+
+/**
+ * Returns the BPM at the given position in ticks.
+ *
+ * The map must be ready.
+ */
+NONNULL
+HOT
+bpm_t
+tempo_map_get_bpm_at_ticks (
+  TempoMap * self,
+  double     ticks);
+
+/**
+ * Returns the BPM at the given frame.
+ *
+ * The map must be ready.
+ */
+NONNULL
+HOT
+bpm_t
+tempo_map_get_bpm_at_frames (
+  TempoMap *     self,
+  signed_frame_t frames);
+
+NONNULL
+void
+tempo_map_free (
+  TempoMap * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -1342,6 +1342,17 @@ track_type_is_compatible_for_moving (
      type2 == TRACK_TYPE_MIDI);
 }
 
+/**
+ * Updates the positions of the children of all
+ * regions in the track that need an update.
+ *
+ * @see region_refresh_children_positions().
+ */
+NONNULL
+void
+track_refresh_children_positions (
+  Track * self);
+
 /**
  * Updates the frames/ticks of each position in
  * each child of the track recursively.
@@ -1502,6 +1513,18 @@ track_append_ports (
   GPtrArray * ports,
   bool        include_plugins);
 
+/**
+ * Returns the estimated memory used by the track,
+ * its ports and its arranger objects, in bytes.
+ *
+ * Used for accounting memory held by the undo
+ * history.
+ */
+NONNULL
+size_t
+track_get_memory_size (
+  Track * self);
+
 /**
  * Freezes or unfreezes the track.
  *
@@ -34,7 +34,6 @@
 typedef struct StereoPorts StereoPorts;
 typedef struct Port Port;
 typedef struct Track Track;
-typedef struct MidiMappings MidiMappings;
 typedef struct EngineProcessTimeInfo
   EngineProcessTimeInfo;
 
@@ -54,6 +53,20 @@ typedef struct EngineProcessTimeInfo
   (self->track \
    && track_is_in_active_project (self->track))
 
+/**
+ * Number of MIDI automatable ports whose changes
+ * are sent as MIDI events: the CCs of each
+ * channel followed by the pitch bend of each
+ * channel.
+ */
+#define TRACK_PROCESSOR_NUM_MIDI_SENDABLE \
+  (128 * 16 + 16)
+
+/** Number of words in
+ * TrackProcessor.midi_dirty. */
+#define TRACK_PROCESSOR_MIDI_DIRTY_WORDS \
+  ((TRACK_PROCESSOR_NUM_MIDI_SENDABLE + 31) / 32)
+
 /**
  * A TrackProcessor is a processor that is used as
  * the first entry point when processing a track.
@@ -129,8 +142,12 @@ typedef struct TrackProcessor
 
   /* --- MIDI controls --- */
 
-  /** Mappings to each CC port. */
-  MidiMappings *   cc_mappings;
+  /*
+   * The MIDI automatable ports below are only
+   * created on first use (see
+   * track_processor_get_or_create_midi_automatable())
+   * so any of them may be NULL.
+   */
 
   /** MIDI CC control ports, 16 channels. */
   Port *           midi_cc[128 * 16];
@@ -156,6 +173,27 @@ typedef struct TrackProcessor
    */
   Port *           channel_pressure[16];
 
+  /**
+   * Bitset of MIDI CC and pitch bend ports whose
+   * value changed since their last MIDI event was
+   * sent, indexed like
+   * @ref TRACK_PROCESSOR_NUM_MIDI_SENDABLE.
+   *
+   * Bits are set atomically when the port values
+   * change and cleared when processing.
+   */
+  guint            midi_dirty[
+    TRACK_PROCESSOR_MIDI_DIRTY_WORDS];
+
+  /**
+   * Bitset of MIDI CC ports that received input
+   * while recording but were not created yet.
+   *
+   * Set when processing and cleared on the main
+   * thread after the port is created.
+   */
+  guint            midi_cc_requested[(128 * 16) / 32];
+
   /* --- end MIDI controls --- */
 
   /**
@@ -256,12 +294,70 @@ track_processor_new (
 
 /**
  * Copy port values from \ref src to \ref dest.
+ *
+ * MIDI automatable ports that exist in \ref src
+ * are also created in \ref dest (without
+ * automation tracks, which are expected to be
+ * cloned separately).
  */
 void
 track_processor_copy_values (
   TrackProcessor * dest,
   TrackProcessor * src);
 
+/**
+ * Returns the MIDI automatable port with the
+ * given identity, creating it along with its
+ * automation track if it does not exist yet.
+ *
+ * If the track is in the project, the graph is
+ * recalculated after creating the port.
+ *
+ * Must be called from the main thread.
+ *
+ * @param flags2 PORT_FLAG2_MIDI_PITCH_BEND,
+ *   PORT_FLAG2_MIDI_POLY_KEY_PRESSURE,
+ *   PORT_FLAG2_MIDI_CHANNEL_PRESSURE, or 0 for a
+ *   CC.
+ * @param port_index Same as
+ *   PortIdentifier.port_index (channel * 128 +
+ *   controller for CCs, the channel otherwise).
+ */
+NONNULL
+Port *
+track_processor_get_or_create_midi_automatable (
+  TrackProcessor * self,
+  PortFlags2       flags2,
+  int              port_index);
+
+/**
+ * Creates all the MIDI automatable ports of the
+ * given channel (0-15) that do not exist yet.
+ *
+ * Used when the user browses the MIDI
+ * automatables of a channel.
+ *
+ * @return Whether any port was created.
+ */
+NONNULL
+bool
+track_processor_create_midi_channel_automatables (
+  TrackProcessor * self,
+  int              channel);
+
+/**
+ * Marks the given MIDI automatable port as
+ * changed so that its value is sent as a MIDI
+ * event in the next cycle.
+ *
+ * This can be called from any thread.
+ */
+NONNULL
+void
+track_processor_mark_midi_automatable_dirty (
+  TrackProcessor * self,
+  const Port *     port);
+
 /**
  * Clears all buffers.
  */
@@ -146,6 +146,12 @@ typedef struct Tracklist
 
   /** Pointer to owner project, if any. */
   Project *           project;
+
+  /** Position of the track last found by
+   * tracklist_find_track_by_name_hash() outside
+   * the processing threads, checked first in the
+   * next search. */
+  volatile gint       last_found_pos;
 } Tracklist;
 
 static const cyaml_schema_field_t
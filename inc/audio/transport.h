@@ -403,6 +403,51 @@ transport_schema =
     Transport, transport_fields_schema),
 };
 
+/**
+ * Musical time information at a given position,
+ * computed once per processing split and shared
+ * by everything that needs it (plugin hosts, the
+ * metronome).
+ *
+ * @see router_get_transport_snapshot().
+ */
+typedef struct TransportSnapshot
+{
+  /** Global frame of @ref TransportSnapshot.pos. */
+  unsigned_frame_t frame;
+
+  /** Number of frames the snapshot covers. */
+  nframes_t        nframes;
+
+  /** Position at the start. */
+  Position         pos;
+
+  /** Position after @ref TransportSnapshot.nframes,
+   * adjusted for the loop. */
+  Position         end_pos;
+
+  /** Whether the loop end point is crossed. */
+  bool             loop_crossed;
+
+  bool             rolling;
+
+  /** Bar, beat and sixteenth (1-indexed). */
+  int              bar;
+  int              beat;
+  int              sixteenth;
+
+  /** Ticks after the sixteenth. */
+  double           ticks;
+
+  /** Ticks after the start of the bar. */
+  double           bar_ticks;
+
+  int              beats_per_bar;
+  int              beat_unit;
+  int              ticks_per_beat;
+  bpm_t            bpm;
+} TransportSnapshot;
+
 /**
  * Initialize transport
  */
@@ -618,6 +663,22 @@ transport_position_add_frames (
   Position *        pos,
   const long        frames);
 
+/**
+ * Fills in a transport snapshot for the given
+ * position.
+ *
+ * @param nframes Number of frames the snapshot
+ *   covers.
+ */
+HOT
+NONNULL
+void
+transport_snapshot_init (
+  TransportSnapshot * snapshot,
+  const Transport *   self,
+  const Position *    pos,
+  nframes_t           nframes);
+
 /**
  * Returns the PPQN (Parts/Ticks Per Quarter Note).
  */
@@ -822,9 +822,30 @@ arranger_object_get_loop_length_in_frames (
     self->loop_start_pos.frames;
 }
 
+/**
+ * Updates the positions of a child of @p region
+ * (eg, a MIDI note) relative to the start of the
+ * region.
+ *
+ * @param from_ticks Whether to update the
+ *   positions based on ticks (true) or frames
+ *   (false).
+ */
+NONNULL
+HOT
+void
+arranger_object_update_child_positions (
+  ArrangerObject * self,
+  ZRegion *        region,
+  bool             from_ticks);
+
 /**
  * Updates the positions in each child recursively.
  *
+ * When updating from ticks, the children of
+ * regions are only marked as needing an update
+ * (see region_refresh_children_positions()).
+ *
  * @param from_ticks Whether to update the
  *   positions based on ticks (true) or frames
  *   (false).
@@ -834,6 +855,16 @@ arranger_object_update_positions (
   ArrangerObject * self,
   bool             from_ticks);
 
+/**
+ * Returns the estimated memory used by the object
+ * and its children (eg, MIDI notes in a region),
+ * in bytes.
+ */
+NONNULL
+size_t
+arranger_object_get_memory_size (
+  ArrangerObject * self);
+
 /**
  * Frees only this object.
  */
@@ -295,6 +295,15 @@ arranger_selections_get_all_objects (
   ArrangerSelections * self,
   int *                size);
 
+/**
+ * Returns the estimated memory used by the
+ * selections and their objects, in bytes.
+ */
+NONNULL
+size_t
+arranger_selections_get_memory_size (
+  ArrangerSelections * self);
+
 #if 0
 /**
  * Redraws each object in the arranger selections.
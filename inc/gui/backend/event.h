@@ -25,6 +25,8 @@
 #ifndef __GUI_BACKEND_EVENT_H__
 #define __GUI_BACKEND_EVENT_H__
 
+#include <glib.h>
+
 /**
  * @addtogroup events
  *
@@ -364,6 +366,8 @@ typedef enum EventType
    * Arg: ArrangerWidget pointer
    */
   ET_ARRANGER_SCROLLED,
+
+  NUM_EVENT_TYPES,
 } EventType;
 
 /**
@@ -388,6 +392,12 @@ typedef struct ZEvent
 
   /** Backtrace. */
   char *       backtrace;
+
+  /**
+   * Slot marking this event as pending in
+   * EventManager.pending, or NULL.
+   */
+  gpointer *   pending_slot;
 } ZEvent;
 
 ZEvent *
@@ -29,6 +29,9 @@
 #ifndef __GUI_BACKEND_EVENT_MANAGER_H__
 #define __GUI_BACKEND_EVENT_MANAGER_H__
 
+#include <stdbool.h>
+
+#include "gui/backend/event.h"
 #include "utils/backtrace.h"
 #include "utils/mpmc_queue.h"
 #include "utils/object_pool.h"
@@ -42,6 +45,14 @@ typedef struct ZEvent ZEvent;
  * @{
  */
 
+/**
+ * Number of slots per event type used for
+ * coalescing events.
+ *
+ * Must be a power of 2.
+ */
+#define EVENT_MANAGER_PENDING_SLOTS 64
+
 /**
  * Event manager.
  */
@@ -67,6 +78,25 @@ typedef struct EventManager
 
   /** Events array to use during processing. */
   GPtrArray *        events_arr;
+
+  /** Set used to remove duplicate events during
+   * processing. */
+  GHashTable *       events_set;
+
+  /**
+   * Arguments of the events currently in the
+   * queue, per event type.
+   *
+   * Used to drop events that are identical to an
+   * event that was not processed yet, so that
+   * events pushed continuously (eg, from the
+   * audio threads) do not pile up.
+   *
+   * @see event_manager_mark_pending().
+   */
+  gpointer
+    pending[NUM_EVENT_TYPES]
+      [EVENT_MANAGER_PENDING_SLOTS];
 } EventManager;
 
 #define EVENT_MANAGER (ZRYTHM->event_manager)
@@ -84,6 +114,9 @@ typedef struct EventManager
 
 /**
  * Push events.
+ *
+ * Events identical to an event that was not
+ * processed yet are dropped.
  */
 #define EVENTS_PUSH(et,_arg) \
   if (ZRYTHM_HAVE_UI && EVENT_MANAGER && \
@@ -91,34 +124,48 @@ typedef struct EventManager
       (!PROJECT || !AUDIO_ENGINE || \
        !AUDIO_ENGINE->exporting)) \
     { \
-      ZEvent * _ev = \
-        (ZEvent *) \
-        object_pool_get (EVENT_MANAGER->obj_pool); \
-      _ev->file = __FILE__; \
-      _ev->func = __func__; \
-      _ev->lineno = __LINE__; \
-      _ev->type = (et); \
-      _ev->arg = (void *) (_arg); \
-      if (zrythm_app->gtk_thread == \
-            g_thread_self ()  \
-          /* skip backtrace for now */ \
-          && false) \
-        { \
-          _ev->backtrace = \
-            backtrace_get ("", 40, false); \
-        } \
-      /* don't print events that are called \
-       * continuously */ \
-      if ((et) != ET_PLAYHEAD_POS_CHANGED && \
-            g_thread_self () == \
-              zrythm_app->gtk_thread) \
+      gpointer * _pending_slot = NULL; \
+      if (event_manager_mark_pending ( \
+            EVENT_MANAGER, (et), (void *) (_arg), \
+            &_pending_slot)) \
         { \
-          g_debug ( \
-            "pushing UI event " #et \
-            " (%s:%d)", __func__, __LINE__); \
+          ZEvent * _ev = \
+            (ZEvent *) \
+            object_pool_get ( \
+              EVENT_MANAGER->obj_pool); \
+          _ev->file = __FILE__; \
+          _ev->func = __func__; \
+          _ev->lineno = __LINE__; \
+          _ev->type = (et); \
+          _ev->arg = (void *) (_arg); \
+          _ev->pending_slot = _pending_slot; \
+          if (zrythm_app->gtk_thread == \
+                g_thread_self ()  \
+              /* skip backtrace for now */ \
+              && false) \
+            { \
+              _ev->backtrace = \
+                backtrace_get ("", 40, false); \
+            } \
+          /* don't print events that are called \
+           * continuously */ \
+          if ((et) != ET_PLAYHEAD_POS_CHANGED && \
+                g_thread_self () == \
+                  zrythm_app->gtk_thread) \
+            { \
+              g_debug ( \
+                "pushing UI event " #et \
+                " (%s:%d)", __func__, __LINE__); \
+            } \
+          if (!event_queue_push_back_event ( \
+                 EVENT_QUEUE, _ev)) \
+            { \
+              event_manager_unmark_pending ( \
+                EVENT_MANAGER, _ev); \
+              object_pool_return ( \
+                EVENT_MANAGER->obj_pool, _ev); \
+            } \
         } \
-      event_queue_push_back_event ( \
-        EVENT_QUEUE, _ev); \
     }
 
 /* runs the event logic now */
@@ -138,6 +185,7 @@ typedef struct EventManager
       _ev->lineno = __LINE__; \
       _ev->type = et; \
       _ev->arg = (void *) _arg; \
+      _ev->pending_slot = NULL; \
       if (/* skip backtrace for now */ \
           false) \
         { \
@@ -158,6 +206,43 @@ typedef struct EventManager
         EVENT_MANAGER->obj_pool, _ev); \
     }
 
+/**
+ * Marks an event as pending until it is
+ * processed.
+ *
+ * Real-time safe.
+ *
+ * @param[out] slot Slot to store in
+ *   ZEvent.pending_slot, or NULL if the event
+ *   could not be tracked (it will be pushed
+ *   anyway).
+ *
+ * @return Whether the event should be pushed
+ *   (false if an identical event is already
+ *   pending).
+ */
+HOT
+NONNULL_ARGS (1, 4)
+bool
+event_manager_mark_pending (
+  EventManager * self,
+  EventType      type,
+  void *         arg,
+  gpointer **    slot);
+
+/**
+ * Clears the pending mark of the given event.
+ *
+ * Must be called before the event is processed or
+ * dropped.
+ */
+HOT
+NONNULL
+void
+event_manager_unmark_pending (
+  EventManager * self,
+  ZEvent *       ev);
+
 /**
  * Creates the event queue and starts the event loop.
  *
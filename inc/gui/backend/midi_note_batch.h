@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Bulk editing of MIDI notes.
+ */
+
+#ifndef __GUI_BACKEND_MIDI_NOTE_BATCH_H__
+#define __GUI_BACKEND_MIDI_NOTE_BATCH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "audio/region_identifier.h"
+#include "utils/yaml.h"
+
+typedef struct MidiArrangerSelections
+  MidiArrangerSelections;
+typedef struct QuantizeOptions QuantizeOptions;
+typedef struct ZRegion ZRegion;
+
+/**
+ * @addtogroup gui_backend
+ *
+ * @{
+ */
+
+/**
+ * Values of a MidiNote before and after a bulk
+ * edit.
+ *
+ * Positions are region-local ticks.
+ */
+typedef struct MidiNoteChange
+{
+  /** Index of the region in the list of regions
+   * the change belongs to. */
+  int            region_idx;
+
+  /** Index of the note in the region. */
+  int            note_idx;
+
+  double         start_before;
+  double         end_before;
+  int            pitch_before;
+  int            vel_before;
+
+  double         start_after;
+  double         end_after;
+  int            pitch_after;
+  int            vel_after;
+} MidiNoteChange;
+
+static const cyaml_schema_field_t
+midi_note_change_fields_schema[] =
+{
+  YAML_FIELD_INT (
+    MidiNoteChange, region_idx),
+  YAML_FIELD_INT (
+    MidiNoteChange, note_idx),
+  YAML_FIELD_FLOAT (
+    MidiNoteChange, start_before),
+  YAML_FIELD_FLOAT (
+    MidiNoteChange, end_before),
+  YAML_FIELD_INT (
+    MidiNoteChange, pitch_before),
+  YAML_FIELD_INT (
+    MidiNoteChange, vel_before),
+  YAML_FIELD_FLOAT (
+    MidiNoteChange, start_after),
+  YAML_FIELD_FLOAT (
+    MidiNoteChange, end_after),
+  YAML_FIELD_INT (
+    MidiNoteChange, pitch_after),
+  YAML_FIELD_INT (
+    MidiNoteChange, vel_after),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+midi_note_change_schema_default = {
+  YAML_VALUE_DEFAULT (
+    MidiNoteChange,
+    midi_note_change_fields_schema),
+};
+
+/**
+ * The MidiNote's of a selection as columns, so
+ * that edits can be applied to all of them in
+ * one pass without touching the notes in the
+ * project.
+ *
+ * The edited values are only written to the
+ * project by an ArrangerSelectionsAction of
+ * type AS_ACTION_EDIT_NOTES, which stores the
+ * changed values instead of clones of the
+ * selections.
+ *
+ * Positions are region-local ticks.
+ */
+typedef struct MidiNoteBatch
+{
+  /** Regions of the notes. */
+  ZRegion **       regions;
+  int              num_regions;
+  size_t           regions_size;
+
+  /** Index in @ref MidiNoteBatch.regions of each
+   * note. */
+  int *            region_idxs;
+
+  /** Index of each note in its region. */
+  int *            note_idxs;
+
+  double *         start_ticks;
+  double *         end_ticks;
+  uint8_t *        pitches;
+  uint8_t *        vels;
+
+  int              num_notes;
+} MidiNoteBatch;
+
+/**
+ * Creates a batch with the values of the notes
+ * in the given selections.
+ *
+ * The selections may contain clones of the
+ * project notes (eg, the selections at the start
+ * of a drag), but the notes must exist in the
+ * project. Each region is only looked up once.
+ *
+ * @return The batch, or NULL if a note could not
+ *   be found in the project.
+ */
+NONNULL
+MidiNoteBatch *
+midi_note_batch_new_from_selections (
+  MidiArrangerSelections * sel);
+
+/**
+ * Adds @p delta semitones to the pitch of all
+ * notes, clamped to 0-127.
+ */
+NONNULL
+void
+midi_note_batch_transpose (
+  MidiNoteBatch * self,
+  int             delta);
+
+/**
+ * Multiplies the velocity of all notes by
+ * @p factor, clamped to 0-127.
+ */
+NONNULL
+void
+midi_note_batch_scale_velocities (
+  MidiNoteBatch * self,
+  double          factor);
+
+/**
+ * Sets the velocity of all notes, clamped to
+ * 0-127.
+ */
+NONNULL
+void
+midi_note_batch_set_velocities (
+  MidiNoteBatch * self,
+  int             vel);
+
+/**
+ * Quantizes the positions of all notes.
+ *
+ * This behaves like the quantize action, ie,
+ * the start is quantized and the note is moved
+ * with it if QuantizeOptions.adj_start is set,
+ * and the end is quantized if
+ * QuantizeOptions.adj_end is set.
+ */
+NONNULL
+void
+midi_note_batch_quantize (
+  MidiNoteBatch *   self,
+  QuantizeOptions * opts);
+
+/**
+ * Writes the values of the change to the note
+ * at the change's index in @p region.
+ *
+ * This does not publish any events or mark the
+ * notes of the region as changed, so
+ * region_notes_changed() must be called once
+ * per region after applying all changes.
+ *
+ * @param after Whether to write the values after
+ *   the change (true) or before (false).
+ *
+ * @return Whether the note was found.
+ */
+NONNULL
+bool
+midi_note_change_apply (
+  const MidiNoteChange * self,
+  ZRegion *              region,
+  bool                   after);
+
+NONNULL
+void
+midi_note_batch_free (
+  MidiNoteBatch * self);
+
+/**
+ * @}
+ */
+
+#endif
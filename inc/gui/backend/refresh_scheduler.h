@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Periodic refresh of widgets that display
+ * engine state.
+ */
+
+#ifndef __GUI_BACKEND_REFRESH_SCHEDULER_H__
+#define __GUI_BACKEND_REFRESH_SCHEDULER_H__
+
+#include <stdbool.h>
+
+#include <gtk/gtk.h>
+
+typedef struct Meter Meter;
+typedef struct Port Port;
+
+/**
+ * @addtogroup widgets
+ *
+ * @{
+ */
+
+#define REFRESH_SCHEDULER (ZRYTHM->refresh_scheduler)
+
+/**
+ * Interval in ms between refreshes while widgets
+ * are changing or the transport is rolling.
+ */
+#define REFRESH_SCHEDULER_ACTIVE_INTERVAL 16
+
+/**
+ * Interval in ms between refreshes when nothing
+ * changed recently.
+ */
+#define REFRESH_SCHEDULER_IDLE_INTERVAL 100
+
+/**
+ * Time in µs without changes after which the
+ * scheduler switches to the idle interval.
+ */
+#define REFRESH_SCHEDULER_IDLE_DELAY 500000
+
+/**
+ * Meter value read by the scheduler.
+ */
+typedef struct RefreshMeterValue
+{
+  float          val;
+  float          max;
+} RefreshMeterValue;
+
+/**
+ * Engine state shared by all widgets refreshed
+ * in the same cycle.
+ *
+ * Engine values are read once per cycle, so
+ * widgets showing the same value do not read it
+ * again.
+ */
+typedef struct RefreshSnapshot
+{
+  /** Monotonic time of the refresh. */
+  gint64         time;
+
+  /** Whether the engine is activated and running,
+   * ie, whether DSP values (eg, meters) can be
+   * read. */
+  bool           engine_running;
+
+  /** Whether the transport is rolling. */
+  bool           rolling;
+
+  /** Meter values of the mapped clients, read
+   * before any client is refreshed
+   * (Meter pointer to RefreshMeterValue
+   * pointer). */
+  GHashTable *   meter_values;
+
+  /** Control port values read in this cycle
+   * (Port pointer to index + 1 in
+   * RefreshScheduler.port_buf). */
+  GHashTable *   port_values;
+
+  /** Buffer for port values, owned by the
+   * scheduler. */
+  GArray *       port_buf;
+} RefreshSnapshot;
+
+/**
+ * Refreshes a widget.
+ *
+ * The widget should only queue a draw (or update
+ * its children) if the values it displays
+ * changed.
+ *
+ * @return Whether the widget changed.
+ */
+typedef bool (*RefreshFunc) (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot);
+
+typedef struct RefreshClient
+{
+  /** Widget, or NULL if it was finalized. */
+  GtkWidget *    widget;
+  RefreshFunc    func;
+
+  /** Meter to read before refreshing, if
+   * any. */
+  Meter *        meter;
+} RefreshClient;
+
+/**
+ * Calls the refresh function of each mapped
+ * widget from a single timeout, instead of each
+ * widget having its own tick callback.
+ *
+ * The refresh rate is lowered when nothing
+ * changed for a while.
+ */
+typedef struct RefreshScheduler
+{
+  /** Registered widgets. */
+  GArray *       clients;
+
+  /** Client indices + 1 in \ref clients, keyed
+   * by widget. */
+  GHashTable *   client_idxs;
+
+  /** Meter values read in the current cycle. */
+  GArray *       meter_buf;
+
+  /** Snapshot reused across cycles. */
+  RefreshSnapshot snapshot;
+
+  /** Number of finalized clients not removed
+   * yet. */
+  int            num_dead;
+
+  /** Whether the clients are being refreshed. */
+  bool           refreshing;
+
+  /** Last time a widget changed or the transport
+   * was rolling. */
+  gint64         last_active_time;
+
+  /** Current interval in ms. */
+  guint          interval;
+
+  guint          source_id;
+} RefreshScheduler;
+
+RefreshScheduler *
+refresh_scheduler_new (void);
+
+/**
+ * Registers a widget to be refreshed while it is
+ * mapped.
+ *
+ * Replaces the refresh function if the widget is
+ * already registered. Widgets are unregistered
+ * automatically when finalized.
+ */
+NONNULL
+void
+refresh_scheduler_add (
+  RefreshScheduler * self,
+  GtkWidget *        widget,
+  RefreshFunc        func);
+
+/**
+ * Sets the meter to read for the given
+ * registered widget in each cycle, or NULL to
+ * stop reading it.
+ *
+ * The value can then be retrieved with
+ * refresh_snapshot_get_meter_value().
+ */
+NONNULL_ARGS (1, 2)
+void
+refresh_scheduler_set_meter (
+  RefreshScheduler * self,
+  GtkWidget *        widget,
+  Meter *            meter);
+
+/**
+ * Unregisters a widget.
+ */
+NONNULL
+void
+refresh_scheduler_remove (
+  RefreshScheduler * self,
+  GtkWidget *        widget);
+
+/**
+ * Gets the value of the meter read in this
+ * cycle.
+ *
+ * @return Whether the meter was read.
+ */
+NONNULL
+bool
+refresh_snapshot_get_meter_value (
+  const RefreshSnapshot * snapshot,
+  Meter *                 meter,
+  float *                 val,
+  float *                 max);
+
+/**
+ * Returns the value of the control port,
+ * reading it only once per cycle.
+ */
+NONNULL
+float
+refresh_snapshot_get_control_value (
+  const RefreshSnapshot * snapshot,
+  Port *                  port);
+
+/**
+ * Refreshes all mapped widgets now.
+ */
+NONNULL
+void
+refresh_scheduler_refresh (
+  RefreshScheduler * self);
+
+NONNULL
+void
+refresh_scheduler_free (
+  RefreshScheduler * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -322,6 +322,15 @@ tracklist_selections_mark_for_bounce (
   bool                  with_parents,
   bool                  mark_master);
 
+/**
+ * Returns the estimated memory used by the
+ * selections and their tracks, in bytes.
+ */
+NONNULL
+size_t
+tracklist_selections_get_memory_size (
+  TracklistSelections * self);
+
 void
 tracklist_selections_free (
   TracklistSelections * self);
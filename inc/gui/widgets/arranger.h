@@ -444,6 +444,34 @@ typedef struct _ArrangerWidget
    */
   int            queued_playhead_px;
 
+  /**
+   * Cached render node of everything except the
+   * overlays (playhead, automation values and
+   * selection rectangle).
+   *
+   * This is re-used while the playhead moves so
+   * that backgrounds and objects are only drawn
+   * when something changes.
+   *
+   * @see arranger_widget_invalidate_content().
+   */
+  GskRenderNode * content_node;
+
+  /** Content epoch @ref
+   * ArrangerWidget.content_node was rendered at. */
+  guint          content_epoch;
+
+  /** Whether the content of this arranger
+   * changed since it was rendered. */
+  bool           content_dirty;
+
+  /** Parameters @ref ArrangerWidget.content_node
+   * was rendered with. */
+  GdkRectangle   content_rect;
+  int            content_width;
+  int            content_height;
+  double         content_px_per_tick;
+
   /** Popover to be reused for context menus. */
   GtkPopoverMenu * popover_menu;
 } ArrangerWidget;
@@ -728,6 +756,65 @@ arranger_widget_get_ruler (
 bool
 arranger_widget_any_doing_action (void);
 
+/**
+ * Marks the cached content of the arranger as
+ * stale so that it is re-rendered in the next
+ * frame.
+ */
+NONNULL
+void
+arranger_widget_invalidate_content (
+  ArrangerWidget * self);
+
+/**
+ * Marks the cached content of the arrangers that
+ * draw objects of the given type as stale.
+ *
+ * The timeline draws the children of regions and
+ * the editors draw the clip editor region, so
+ * changes to regions or their children invalidate
+ * both.
+ */
+void
+arranger_widget_invalidate_content_for_object_type (
+  ArrangerObjectType type);
+
+/**
+ * Marks the cached content of the arrangers that
+ * draw the objects of the given selections as
+ * stale.
+ */
+NONNULL
+void
+arranger_widget_invalidate_content_for_selections (
+  ArrangerSelections * sel);
+
+/**
+ * Marks the cached content of all arrangers as
+ * stale so that it is re-rendered in the next
+ * frame.
+ *
+ * To be called when something drawn in all
+ * arrangers changes (eg, tracks or the theme).
+ */
+void
+arranger_widget_invalidate_all_content (void);
+
+/**
+ * Returns the current content epoch.
+ */
+guint
+arranger_widget_get_content_epoch (void);
+
+/**
+ * Returns whether the cached content must be
+ * re-rendered.
+ */
+NONNULL
+bool
+arranger_widget_is_content_stale (
+  ArrangerWidget * self);
+
 /**
  * Returns the playhead's x coordinate in absolute
  * coordinates.
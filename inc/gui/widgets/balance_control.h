@@ -65,6 +65,10 @@ typedef struct _BalanceControlWidget
   /** Balance at start of drag. */
   float              balance_at_start;
 
+  /** Balance last drawn, used to only redraw
+   * when the balance changes. */
+  float              last_val;
+
   Port *             port;
 
   /** Popover to be reused for context menus. */
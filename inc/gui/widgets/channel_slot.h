@@ -77,10 +77,6 @@ typedef struct _ChannelSlotWidget
   /** Layout cache for plugin name. */
   PangoLayout *     pl_name_layout;
 
-  /** Cache to check if the selection state was
-   * changed. */
-  bool              was_selected;
-
   /** Whether to open the plugin inspector on click
    * or not. */
   bool              open_plugin_inspector_on_click;
@@ -61,6 +61,10 @@ typedef struct _FaderWidget
   /** Value at start. */
   float              amp_at_start;
 
+  /** Fader value last drawn, used to only redraw
+   * when the fader changes. */
+  float              last_fader_val;
+
   /** Popover to be reused for context menus. */
   GtkPopoverMenu * popover_menu;
 } FaderWidget;
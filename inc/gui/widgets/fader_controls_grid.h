@@ -72,9 +72,6 @@ typedef struct _FaderControlsGridWidget
   /** Last MIDI event trigger time, for MIDI
    * output. */
   gint64         last_midi_trigger_time;
-
-  guint          tick_cb;
-
 } FaderControlsGridWidget;
 
 void
@@ -26,6 +26,8 @@
  * Live waveform display like LMMS.
  */
 
+#include "audio/port_identifier.h"
+
 #include <gtk/gtk.h>
 
 #define LIVE_WAVEFORM_WIDGET_TYPE \
@@ -71,6 +73,15 @@ typedef struct _LiveWaveformWidget
   /** Port, if port. */
   Port *         port;
 
+  /** Identifier of @ref port, used to check
+   * that the port still exists before
+   * unsubscribing from it. */
+  PortIdentifier port_id;
+
+  /** Master output ports being observed, if
+   * engine. */
+  Port *         engine_ports[2];
+
 } LiveWaveformWidget;
 
 /**
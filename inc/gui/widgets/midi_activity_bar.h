@@ -26,6 +26,8 @@
  * MIDI activity bar for tracks.
  */
 
+#include <stdbool.h>
+
 #include <gtk/gtk.h>
 
 #define MIDI_ACTIVITY_BAR_WIDGET_TYPE \
@@ -74,6 +76,10 @@ typedef struct _MidiActivityBarWidget
   /** Draw border or not. */
   int            draw_border;
 
+  /** Whether the last draw showed activity, so
+   * that the bar is redrawn until it fades
+   * out. */
+  bool           drawn_active;
 } MidiActivityBarWidget;
 
 /**
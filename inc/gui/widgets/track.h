@@ -281,6 +281,11 @@ typedef struct _TrackWidget
 
   /** Popover for changing the track name. */
   GtkPopover *     track_name_popover;
+
+  /** State drawn on the canvas in the last
+   * refresh, used to only redraw it when
+   * something changed. */
+  GArray *         canvas_state;
 } TrackWidget;
 
 const char *
@@ -128,6 +128,28 @@ typedef struct CarlaNativePlugin
   float **         inbufs;
   float **         outbufs;
 
+  /**
+   * Ports whose buffers are passed to Carla, in
+   * the same order as @ref
+   * CarlaNativePlugin.inbufs and @ref
+   * CarlaNativePlugin.outbufs (NULL where the
+   * plugin has no port).
+   *
+   * Used so that the ports don't have to be
+   * searched in every cycle.
+   */
+  Port **          in_buf_ports;
+  Port **          out_buf_ports;
+
+  /** Port arrays of the plugin that @ref
+   * CarlaNativePlugin.in_buf_ports and @ref
+   * CarlaNativePlugin.out_buf_ports were set up
+   * from, used to detect port changes. */
+  Port **          classified_in_ports;
+  int              classified_num_in_ports;
+  Port **          classified_out_ports;
+  int              classified_num_out_ports;
+
   unsigned int     max_variant_audio_ins;
   unsigned int     max_variant_audio_outs;
   unsigned int     max_variant_cv_ins;
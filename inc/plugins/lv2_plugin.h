@@ -320,6 +320,38 @@ typedef struct Lv2Plugin
   /** Last BPM known by the plugin. */
   float              bpm;
 
+  /**
+   * Indices in Plugin.lilv_ports of the ports of
+   * each class, so that lv2_plugin_process() only
+   * visits the ports it needs to.
+   *
+   * Set when the plugin is instantiated.
+   */
+  int *              audio_cv_ports;
+  int                num_audio_cv_ports;
+  int *              event_in_ports;
+  int                num_event_in_ports;
+  int *              event_out_ports;
+  int                num_event_out_ports;
+  int *              control_out_ports;
+  int                num_control_out_ports;
+  int *              freewheel_ports;
+  int                num_freewheel_ports;
+
+  /** Lilv index of the port reporting the
+   * latency, or -1 if none. */
+  int                latency_port;
+
+  /**
+   * Buffers the ports in @ref
+   * Lv2Plugin.audio_cv_ports are connected to.
+   *
+   * Ports are only reconnected when their buffer
+   * moves (eg, after a buffer size change, a graph
+   * rebuild or in a split cycle).
+   */
+  float **           audio_cv_bufs;
+
   /** Base Plugin instance (parent). */
   Plugin *           plugin;
 
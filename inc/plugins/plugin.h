@@ -179,6 +179,22 @@ typedef struct Plugin
    * plugin will be treated as disabled. */
   bool              instantiation_failed;
 
+  /**
+   * Whether the plugin is waiting to be
+   * instantiated by the PluginLoader.
+   *
+   * The engine passes the input of the plugin
+   * through while this is set.
+   */
+  gint              instantiation_pending;
+
+  /**
+   * Warning produced while instantiating outside
+   * the main thread, to be shown on the main
+   * thread by the PluginLoader.
+   */
+  char *            instantiation_warning;
+
   /** Whether the plugin is currently activated
    * or not. */
   bool              activated;
@@ -289,6 +305,46 @@ typedef struct Plugin
   /** Pointer to owner selections, if any. */
   MixerSelections * ms;
 
+  /**
+   * Bitset of input ports (by index in
+   * @ref Plugin.in_ports) whose control value
+   * changed since the last cycle.
+   *
+   * Bits are set atomically from any thread with
+   * plugin_mark_control_dirty() and taken at the
+   * start of plugin_process().
+   */
+  guint *           ctrl_dirty;
+
+  /** Set after a bit in @ref Plugin.ctrl_dirty is
+   * set, so that cycles without changes don't
+   * need to look at the bitset. */
+  volatile gint     ctrl_dirty_any;
+
+  /**
+   * Control changes taken from @ref
+   * Plugin.ctrl_dirty for the current cycle.
+   *
+   * Only accessed during processing.
+   */
+  guint *           ctrl_changed;
+  bool              ctrl_changed_any;
+
+  /**
+   * Control changes not yet forwarded to the
+   * plugin UI.
+   *
+   * UI updates are rate-limited, so changes are
+   * accumulated here until the next UI update.
+   * Only accessed during processing.
+   */
+  guint *           ctrl_ui_pending;
+  bool              ctrl_ui_pending_any;
+
+  /** Number of words allocated for each of the
+   * bitsets above. */
+  int               ctrl_bitset_size;
+
   /** Used in Gtk. */
   WrappedObjectWithChangeSignal * gobj;
 } Plugin;
@@ -348,6 +404,20 @@ plugin_add_automation_track (
   Plugin * self,
   AutomationTrack * at);
 
+/**
+ * Marks the control value of the given input
+ * port as changed so that it is delivered to the
+ * plugin and its UI in the next cycle.
+ *
+ * This can be called from any thread.
+ */
+NONNULL
+HOT
+void
+plugin_mark_control_dirty (
+  Plugin *     self,
+  const Port * port);
+
 /**
  * Adds an in port to the plugin's list.
  */
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Background instantiation of plugins when loading
+ * a project.
+ */
+
+#ifndef __PLUGINS_PLUGIN_LOADER_H__
+#define __PLUGINS_PLUGIN_LOADER_H__
+
+#include <stdbool.h>
+
+#include <glib.h>
+
+typedef struct Plugin Plugin;
+typedef struct PluginLoadJob PluginLoadJob;
+
+/**
+ * @addtogroup plugins
+ *
+ * @{
+ */
+
+#define PLUGIN_LOADER (PROJECT->plugin_loader)
+
+/**
+ * Instantiates the plugins of a loaded project in
+ * the background so that the project becomes
+ * usable before all plugins are ready.
+ *
+ * Plugins are instantiated concurrently in worker
+ * threads, except for in-process VST, AU and LV2
+ * plugins hosted by Carla, which are instantiated
+ * one by one on the main thread. Calls into the
+ * LV2 world are serialized with
+ * PluginManager.lilv_lock.
+ *
+ * Plugins are added while the project is being
+ * loaded and instantiated after
+ * plugin_loader_start() in order of priority
+ * (record-armed, selected and visible tracks
+ * first). Until a plugin is ready,
+ * Plugin.instantiation_pending is set and the
+ * engine passes its input through.
+ *
+ * Activation and error reporting are done on the
+ * main thread.
+ */
+typedef struct PluginLoader
+{
+  /** Worker threads. */
+  GThreadPool *   pool;
+
+  /** All jobs (including finished ones). */
+  GPtrArray *     jobs;
+
+  /** Jobs finished by the workers, to be
+   * completed on the main thread. */
+  GQueue *        finished;
+
+  /** Queued jobs for plugins that must be
+   * instantiated on the main thread, in order of
+   * priority. */
+  GQueue *        main_thread_jobs;
+
+  /** Number of jobs not completed yet. */
+  int             num_pending;
+
+  /** Total number of plugins added. */
+  int             num_total;
+
+  /** Lock for the job states and @ref
+   * finished. */
+  GMutex          lock;
+
+  /** Signaled when a job finishes. */
+  GCond           cond;
+
+  /** Source ID of the main thread callback. */
+  guint           source_id;
+
+  /** Whether plugin_loader_start() was called. */
+  bool            started;
+} PluginLoader;
+
+PluginLoader *
+plugin_loader_new (void);
+
+/**
+ * Adds a plugin to be instantiated.
+ *
+ * Must be called before plugin_loader_start().
+ */
+NONNULL
+void
+plugin_loader_add_plugin (
+  PluginLoader * self,
+  Plugin *       pl);
+
+/**
+ * Starts instantiating the added plugins in
+ * priority order.
+ */
+NONNULL
+void
+plugin_loader_start (
+  PluginLoader * self);
+
+/**
+ * Moves the given pending plugin to the front of
+ * the queue.
+ */
+NONNULL
+void
+plugin_loader_prioritize_plugin (
+  PluginLoader * self,
+  Plugin *       pl);
+
+/**
+ * Removes the given plugin from the loader,
+ * waiting for it if it is currently being
+ * instantiated.
+ *
+ * To be called before the plugin is free'd.
+ */
+NONNULL
+void
+plugin_loader_cancel_plugin (
+  PluginLoader * self,
+  Plugin *       pl);
+
+/**
+ * Blocks until all plugins are instantiated and
+ * activated.
+ *
+ * Must be called from the main thread.
+ */
+NONNULL
+void
+plugin_loader_wait (
+  PluginLoader * self);
+
+/**
+ * Returns whether all added plugins are ready.
+ */
+NONNULL
+bool
+plugin_loader_is_finished (
+  PluginLoader * self);
+
+NONNULL
+void
+plugin_loader_free (
+  PluginLoader * self);
+
+/**
+ * @}
+ */
+
+#endif
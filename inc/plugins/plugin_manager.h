@@ -32,6 +32,8 @@
 
 #include "zix/sem.h"
 
+#include <glib.h>
+
 #include <lilv/lilv.h>
 
 typedef struct CachedPluginDescriptors
@@ -81,6 +83,11 @@ typedef struct PluginManager
   LilvWorld *         lilv_world;
   const LilvPlugins * lilv_plugins;
 
+  /** Lock for accessing the (non-thread-safe)
+   * LV2 world from multiple threads, eg, when
+   * instantiating plugins in the background. */
+  GMutex              lilv_lock;
+
   LilvNode **         nodes;
   int                 num_nodes;
   size_t              nodes_size;
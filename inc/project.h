@@ -49,6 +49,7 @@
 #include "gui/backend/timeline_selections.h"
 #include "gui/backend/tool.h"
 #include "plugins/plugin.h"
+#include "plugins/plugin_loader.h"
 #include "zrythm.h"
 
 #include "ext/zix/zix/sem.h"
@@ -80,6 +81,7 @@ typedef struct TracklistSelections
 #define PROJECT_EXPORTS_DIR     "exports"
 #define PROJECT_STEMS_DIR       "stems"
 #define PROJECT_POOL_DIR        "pool"
+#define PROJECT_UNDO_HISTORY_FILE "undo_history.zpu"
 
 typedef enum ProjectPath
 {
@@ -106,6 +108,10 @@ typedef enum ProjectPath
   PROJECT_PATH_EXPORTS_STEMS,
 
   PROJECT_PATH_POOL,
+
+  /** Undo history, saved separately from the
+   * project file. */
+  PROJECT_PATH_UNDO_HISTORY_FILE,
 } ProjectPath;
 
 /**
@@ -159,6 +165,30 @@ typedef enum ProjectCompressionFlag
   PROJECT_COMPRESS_DATA,
 } ProjectCompressionFlag;
 
+/**
+ * Format of the (uncompressed) project file.
+ *
+ * The format of existing files is detected on load,
+ * so this only affects saving.
+ */
+typedef enum ProjectFileFormat
+{
+  /** Binary encoding of the project schema (see
+   * schema_binary.h). */
+  PROJECT_FILE_FORMAT_BINARY,
+
+  /** YAML, mostly useful for debugging and
+   * exporting. */
+  PROJECT_FILE_FORMAT_YAML,
+} ProjectFileFormat;
+
+static const cyaml_strval_t
+project_file_format_strings[] =
+{
+  { __("Binary"), PROJECT_FILE_FORMAT_BINARY },
+  { "YAML",       PROJECT_FILE_FORMAT_YAML },
+};
+
 #define PROJECT_DECOMPRESS_FILE \
   PROJECT_COMPRESS_FILE
 #define PROJECT_DECOMPRESS_DATA \
@@ -304,6 +334,10 @@ typedef struct Project
   /** Semaphore used to block saving. */
   ZixSem            save_sem;
 
+  /** Instantiates plugins in the background after
+   * loading, or NULL. */
+  PluginLoader *    plugin_loader;
+
   gint64            last_autosave_time;
 } Project;
 
@@ -398,8 +432,14 @@ typedef struct ProjectSaveData
   /** Full path to save to. */
   char *    project_file_path;
 
+  /** Full path to save the undo history to. */
+  char *    undo_history_path;
+
   bool      is_backup;
 
+  /** Format to save the project file in. */
+  ProjectFileFormat format;
+
   /** To be set to true when the thread finishes. */
   bool      finished;
 
@@ -551,18 +591,79 @@ _project_compress (
   _project_compress (false, a, b, c, d, e, f, error)
 
 /**
- * Returns the YAML representation of the saved
+ * Returns the decompressed contents of the saved
  * project file.
  *
  * To be free'd with free().
  *
  * @param backup Whether to use the project file
  *   from the most recent backup.
+ * @param[out] size Size of the returned data.
  */
 char *
-project_get_existing_yaml (
+project_get_existing_data (
   Project * self,
-  bool      backup);
+  bool      backup,
+  size_t *  size);
+
+/**
+ * Returns the format of the given (decompressed)
+ * project data.
+ */
+NONNULL
+ProjectFileFormat
+project_get_data_format (
+  const char * data,
+  size_t       size);
+
+/**
+ * Returns the format new project files are saved
+ * in.
+ */
+ProjectFileFormat
+project_get_save_format (void);
+
+/**
+ * Returns the file extension (without the dot)
+ * for data in the given format.
+ */
+const char *
+project_file_format_get_extension (
+  ProjectFileFormat format);
+
+/**
+ * Serializes the given project (without
+ * compression).
+ *
+ * The undo history is not included, since it is
+ * saved separately.
+ *
+ * To be free'd with g_free().
+ *
+ * @param[out] size Size of the returned data.
+ *
+ * @return The serialized project, or NULL if
+ *   failed.
+ */
+NONNULL
+char *
+project_serialize (
+  Project *         self,
+  ProjectFileFormat format,
+  size_t *          size);
+
+/**
+ * Deserializes a project from the given
+ * (decompressed) data, detecting its format.
+ *
+ * @return The project, or NULL if failed.
+ */
+NONNULL_ARGS (1)
+Project *
+project_deserialize (
+  const char * data,
+  size_t       size,
+  GError **    error);
 
 /**
  * Deep-clones the given project.
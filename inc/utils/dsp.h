@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2020-2021 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2020-2022 Alexandros Theodotou <alex at zrythm dot org>
  *
  * This file is part of Zrythm
  *
@@ -22,6 +22,10 @@
  *
  * Optimized DSP functions.
  *
+ * The functions dispatch to the kernels of the
+ * instruction set selected with dsp_set_isa()
+ * (see utils/dsp_kernels.h).
+ *
  * @note More at https://github.com/DISTRHO/DPF-Max-Gen/blob/master/plugins/common/gen_dsp/genlib_ops.h#L313
  */
 
@@ -33,14 +37,34 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "utils/dsp_kernels.h"
 #include "utils/math.h"
 #include "zrythm.h"
 
 #include <glib.h>
 
-#ifdef HAVE_LSP_DSP
-#include <lsp-plug.in/dsp/dsp.h>
-#endif
+/**
+ * Selects the kernels to use.
+ *
+ * Falls back to the scalar kernels if the
+ * instruction set is not supported.
+ *
+ * Must not be called while the engine is
+ * processing.
+ *
+ * @return Whether the instruction set is
+ *   supported.
+ */
+bool
+dsp_set_isa (
+  DspIsa isa);
+
+/**
+ * Returns the instruction set of the kernels in
+ * use.
+ */
+DspIsa
+dsp_get_isa (void);
 
 /**
  * Fill the buffer with the given value.
@@ -58,29 +82,12 @@ dsp_fill (
  */
 NONNULL
 HOT
-static inline void
+void
 dsp_limit1 (
   float * buf,
   float   minf,
   float   maxf,
-  size_t  size)
-{
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      lsp_dsp_limit1 (buf, minf, maxf, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          buf[i] = CLAMP (buf[i], minf, maxf);
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
-}
+  size_t  size);
 
 NONNULL
 HOT
@@ -101,38 +108,44 @@ dsp_mul_k2 (
   float   k,
   size_t  size);
 
+/**
+ * Calculate dest[i] = dest[i] * src[i].
+ */
+NONNULL
+HOT
+void
+dsp_mul2 (
+  float *       dest,
+  const float * src,
+  size_t        size);
+
+/**
+ * Scale the two channels:
+ * l[i] = l[i] * kl, r[i] = r[i] * kr.
+ *
+ * Used to apply pan/balance and gain to stereo
+ * signals in one pass.
+ */
+NONNULL
+HOT
+void
+dsp_mul_k2_stereo (
+  float * l,
+  float * r,
+  float   kl,
+  float   kr,
+  size_t  size);
+
 /**
  * Gets the maximum absolute value of the buffer (as
  * amplitude).
  */
 NONNULL
 WARN_UNUSED_RESULT
-static inline float
+float
 dsp_abs_max (
   float * buf,
-  size_t  size)
-{
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      return lsp_dsp_abs_max (buf, size);
-    }
-  else
-    {
-#endif
-      float ret = 1e-20f;
-      for (size_t i = 0; i < size; i++)
-        {
-          if (fabsf (buf[i]) > ret)
-            {
-              ret = fabsf (buf[i]);
-            }
-        }
-      return ret;
-#ifdef HAVE_LSP_DSP
-    }
-#endif
-}
+  size_t  size);
 
 /**
  * Gets the absolute max of the buffer.
@@ -141,41 +154,11 @@ dsp_abs_max (
  */
 HOT
 NONNULL
-static inline bool
+bool
 dsp_abs_max_with_existing_peak (
   float * buf,
   float * cur_peak,
-  size_t  size)
-{
-  float new_peak = *cur_peak;
-
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      new_peak =
-        lsp_dsp_abs_max (buf, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          float val = fabsf (buf[i]);
-          if (val > new_peak)
-            {
-              new_peak = val;
-            }
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
-
-  bool changed =
-    !math_floats_equal (new_peak, *cur_peak);
-  *cur_peak = new_peak;
-
-  return changed;
-}
+  size_t  size);
 
 /**
  * Gets the minimum of the buffer.
@@ -211,30 +194,13 @@ dsp_add2 (
  */
 NONNULL
 HOT
-static inline void
+void
 dsp_mix2 (
   float *       dest,
   const float * src,
   float         k1,
   float         k2,
-  size_t        size)
-{
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      lsp_dsp_mix2 (dest, src, k1, k2, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = dest[i] * k1 + src[i] * k2;
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
-}
+  size_t        size);
 
 /**
  * Calculate
@@ -250,6 +216,23 @@ dsp_mix_add2 (
   float         k2,
   size_t        size);
 
+/**
+ * Multiplies the buffer by a gain ramping
+ * linearly from @p start_gain towards
+ * @p end_gain.
+ *
+ * @p end_gain is the gain of the sample after the
+ * last one, so consecutive ramps join smoothly.
+ */
+NONNULL
+HOT
+void
+dsp_gain_ramp (
+  float * dest,
+  float   start_gain,
+  float   end_gain,
+  size_t  size);
+
 /**
  * Calculate linear fade in by multiplying from
  * 0 to 1.
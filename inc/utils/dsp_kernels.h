@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * Per-instruction set implementations of the DSP
+ * functions, selected at runtime.
+ *
+ * Use the dsp_*() functions in utils/dsp.h
+ * instead of calling these directly.
+ */
+
+#ifndef __UTILS_DSP_KERNELS_H__
+#define __UTILS_DSP_KERNELS_H__
+
+#include <stddef.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/**
+ * Instruction set of a kernel table.
+ */
+typedef enum DspIsa
+{
+  DSP_ISA_SCALAR,
+  DSP_ISA_SSE2,
+  DSP_ISA_AVX2,
+  DSP_ISA_AVX512,
+  DSP_ISA_NEON,
+  NUM_DSP_ISAS,
+} DspIsa;
+
+/**
+ * Table of DSP kernels for an instruction set.
+ *
+ * Buffers do not need to be aligned.
+ */
+typedef struct DspKernels
+{
+  void (*fill) (
+    float * buf, float val, size_t size);
+  void (*limit1) (
+    float * buf, float minf, float maxf,
+    size_t size);
+  void (*copy) (
+    float * dest, const float * src,
+    size_t size);
+  void (*mul_k2) (
+    float * dest, float k, size_t size);
+
+  /** dest[i] = dest[i] * src[i]. */
+  void (*mul2) (
+    float * dest, const float * src,
+    size_t size);
+
+  /** Returns the maximum absolute value, or 0 if
+   * the buffer is empty. */
+  float (*abs_max) (
+    const float * buf, size_t size);
+
+  /** Returns the minimum, or FLT_MAX if the
+   * buffer is empty. */
+  float (*min) (
+    const float * buf, size_t size);
+
+  /** Returns the maximum, or -FLT_MAX if the
+   * buffer is empty. */
+  float (*max) (
+    const float * buf, size_t size);
+
+  void (*add2) (
+    float * dest, const float * src,
+    size_t size);
+  void (*mix2) (
+    float * dest, const float * src, float k1,
+    float k2, size_t size);
+  void (*mix_add2) (
+    float * dest, const float * src1,
+    const float * src2, float k1, float k2,
+    size_t size);
+
+  /** dest[i] = dest[i] * (start + i * step). */
+  void (*ramp_mul) (
+    float * dest, float start, float step,
+    size_t size);
+
+  /** l[i] = l[i] * kl, r[i] = r[i] * kr. */
+  void (*mul_k2_stereo) (
+    float * l, float * r, float kl, float kr,
+    size_t size);
+} DspKernels;
+
+/**
+ * Portable kernels, always available.
+ */
+extern const DspKernels dsp_kernels_scalar;
+
+/**
+ * Returns the kernels for the given instruction
+ * set, or NULL if it is not supported by the
+ * build or by the CPU.
+ */
+const DspKernels *
+dsp_kernels_get (
+  DspIsa isa);
+
+/**
+ * Returns the fastest instruction set supported
+ * by the CPU.
+ */
+DspIsa
+dsp_kernels_get_best_isa (void);
+
+const char *
+dsp_isa_to_string (
+  DspIsa isa);
+
+/**
+ * @}
+ */
+
+#endif
@@ -37,4 +37,27 @@ realloc_zero (
   size_t oldSize,
   size_t newSize);
 
+/**
+ * Allocates zeroed memory aligned to the given
+ * alignment.
+ *
+ * @param alignment Alignment in bytes (a power of
+ *   2 and a multiple of sizeof (void *)).
+ *
+ * @return The memory, to be free'd with
+ *   aligned_free(), or NULL on failure.
+ */
+void *
+aligned_malloc_zero (
+  size_t alignment,
+  size_t size);
+
+/**
+ * Frees memory allocated with
+ * aligned_malloc_zero().
+ */
+void
+aligned_free (
+  void * buf);
+
 #endif
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Compact binary serialization driven by cyaml
+ * schemas.
+ *
+ * The same schemas used for YAML (see yaml.h) are
+ * walked to produce a tagged binary encoding:
+ *
+ * - a header with a magic string and format
+ *   version,
+ * - a table of the mapping keys and enum strings
+ *   used in the document,
+ * - the document, where every value is prefixed by
+ *   a 1-byte tag and integers are stored as
+ *   varints.
+ *
+ * Mapping fields are identified by their key (as
+ * an index into the key table) and enums by their
+ * string, so data survives fields being added,
+ * removed or reordered in the schemas, the same
+ * way YAML does. Unknown fields are skipped and
+ * missing fields are left zeroed.
+ */
+
+#ifndef __UTILS_SCHEMA_BINARY_H__
+#define __UTILS_SCHEMA_BINARY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <glib.h>
+
+#include <cyaml/cyaml.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/** Magic bytes at the start of binary data. */
+#define SCHEMA_BINARY_MAGIC "ZBIN"
+
+#define SCHEMA_BINARY_FORMAT_VERSION 1
+
+/**
+ * Returns whether the given data starts with the
+ * binary serialization header.
+ */
+NONNULL
+bool
+schema_binary_is_binary (
+  const char * data,
+  size_t       size);
+
+/**
+ * Serializes the given object to the binary
+ * format.
+ *
+ * @param data Pointer to the object, as passed to
+ *   yaml_serialize().
+ * @param[out] size Size of the returned data.
+ *
+ * @return Newly allocated data to be free'd with
+ *   g_free(), or NULL if error.
+ */
+NONNULL
+char *
+schema_binary_serialize (
+  void *                       data,
+  const cyaml_schema_value_t * schema,
+  size_t *                     size);
+
+/**
+ * Deserializes an object from binary data.
+ *
+ * Memory is allocated the same way as
+ * yaml_deserialize(), so the result can be free'd
+ * with the same functions.
+ *
+ * @return The newly allocated object, or NULL if
+ *   error.
+ */
+NONNULL_ARGS (1, 3)
+void *
+schema_binary_deserialize (
+  const char *                 data,
+  size_t                       size,
+  const cyaml_schema_value_t * schema,
+  GError **                    error);
+
+/**
+ * @}
+ */
+
+#endif
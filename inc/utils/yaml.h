@@ -181,11 +181,21 @@
     #member, CYAML_FLAG_DEFAULT, \
     owner, member)
 
+#define YAML_FIELD_INT_OPTIONAL(owner,member) \
+  CYAML_FIELD_INT ( \
+    #member, CYAML_FLAG_OPTIONAL, \
+    owner, member)
+
 #define YAML_FIELD_UINT(owner,member) \
   CYAML_FIELD_UINT ( \
     #member, CYAML_FLAG_DEFAULT, \
     owner, member)
 
+#define YAML_FIELD_UINT_OPTIONAL(owner,member) \
+  CYAML_FIELD_UINT ( \
+    #member, CYAML_FLAG_OPTIONAL, \
+    owner, member)
+
 #define YAML_FIELD_FLOAT(owner,member) \
   CYAML_FIELD_FLOAT ( \
     #member, CYAML_FLAG_DEFAULT, \
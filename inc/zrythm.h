@@ -36,6 +36,7 @@ typedef struct Project Project;
 typedef struct Symap Symap;
 typedef struct RecordingManager RecordingManager;
 typedef struct EventManager EventManager;
+typedef struct RefreshScheduler RefreshScheduler;
 typedef struct ObjectUtils ObjectUtils;
 typedef struct PluginManager PluginManager;
 typedef struct FileManager FileManager;
@@ -176,6 +177,9 @@ typedef enum ZrythmDirType
   /** Backtraces. */
   ZRYTHM_DIR_USER_BACKTRACE,
 
+  /** Cached data that can be regenerated. */
+  ZRYTHM_DIR_USER_CACHE,
+
 } ZrythmDirType;
 
 /**
@@ -243,6 +247,10 @@ typedef struct Zrythm
 
   EventManager *      event_manager;
 
+  /** Refresh scheduler for widgets displaying
+   * engine state. */
+  RefreshScheduler *  refresh_scheduler;
+
   /** Recording manager. */
   RecordingManager *  recording_manager;
 
@@ -42,6 +42,7 @@
 #include "utils/string.h"
 #include "zrythm_app.h"
 
+#include <string.h>
 #include <glib/gi18n.h>
 
 typedef enum
@@ -477,9 +478,6 @@ arranger_selections_action_new_edit (
 
   self->edit_type = type;
 
-  set_selections (
-    self, sel_before, F_CLONE, F_NOT_IS_AFTER);
-
   if (sel_after)
     {
       set_selections (
@@ -835,6 +833,9 @@ arranger_selections_action_new_resize (
  * Creates a new action fro quantizing
  * ArrangerObject's.
  *
+ * MidiNote's are quantized with an
+ * AS_ACTION_EDIT_NOTES action.
+ *
  * @param opts Quantize options.
  */
 UndoableAction *
@@ -843,6 +844,29 @@ arranger_selections_action_new_quantize (
   QuantizeOptions *    opts,
   GError **            error)
 {
+  /* MIDI notes are quantized in bulk */
+  if (sel->type == ARRANGER_SELECTIONS_TYPE_MIDI)
+    {
+      MidiNoteBatch * batch =
+        midi_note_batch_new_from_selections (
+          (MidiArrangerSelections *) sel);
+      if (!batch)
+        {
+          g_set_error (
+            error,
+            Z_ACTIONS_ARRANGER_SELECTIONS_ERROR,
+            Z_ACTIONS_ARRANGER_SELECTIONS_ERROR_FAILED,
+            "%s", _("Failed to find MIDI notes"));
+          return NULL;
+        }
+      midi_note_batch_quantize (batch, opts);
+      UndoableAction * ua =
+        arranger_selections_action_new_edit_notes (
+          NULL, batch, F_NOT_ALREADY_EDITED, error);
+      midi_note_batch_free (batch);
+      return ua;
+    }
+
   ArrangerSelectionsAction * self =
     _create_action (sel);
   self->type = AS_ACTION_QUANTIZE;
@@ -854,6 +878,128 @@ arranger_selections_action_new_quantize (
   return ua;
 }
 
+/**
+ * Creates a new action for editing MidiNote's in
+ * bulk.
+ *
+ * Only the values of the notes that changed are
+ * stored instead of clones of the selections, so
+ * this should be preferred over
+ * arranger_selections_action_new_edit() and
+ * arranger_selections_action_new_quantize() when
+ * editing many notes.
+ *
+ * @param before The values before the change, or
+ *   NULL to use the current values in the
+ *   project. Must contain the same notes as
+ *   @p after.
+ * @param after The values after the change.
+ * @param already_edited Whether the values in
+ *   @p after were already written to the
+ *   project.
+ */
+UndoableAction *
+arranger_selections_action_new_edit_notes (
+  MidiNoteBatch * before,
+  MidiNoteBatch * after,
+  bool            already_edited,
+  GError **       error)
+{
+  if (before
+      && (before->num_notes != after->num_notes
+          ||
+          before->num_regions
+            != after->num_regions))
+    {
+      g_set_error (
+        error, Z_ACTIONS_ARRANGER_SELECTIONS_ERROR,
+        Z_ACTIONS_ARRANGER_SELECTIONS_ERROR_FAILED,
+        "%s",
+        _("The notes before and after the edit do "
+        "not match"));
+      return NULL;
+    }
+  if (already_edited && !before)
+    {
+      g_critical (
+        "before must be passed or already "
+        "edited must be false");
+      return NULL;
+    }
+
+  ArrangerSelectionsAction * self =
+    object_new (ArrangerSelectionsAction);
+  self->type = AS_ACTION_EDIT_NOTES;
+  self->first_run = already_edited;
+
+  self->num_note_regions = after->num_regions;
+  self->note_regions =
+    object_new_n (
+      (size_t) MAX (after->num_regions, 1),
+      RegionIdentifier);
+  for (int i = 0; i < after->num_regions; i++)
+    {
+      self->note_regions[i] = after->regions[i]->id;
+    }
+
+  /* only keep the notes that changed */
+  self->note_changes =
+    object_new_n (
+      (size_t) MAX (after->num_notes, 1),
+      MidiNoteChange);
+  for (int i = 0; i < after->num_notes; i++)
+    {
+      MidiNoteChange change = {
+        .region_idx = after->region_idxs[i],
+        .note_idx = after->note_idxs[i],
+        .start_after = after->start_ticks[i],
+        .end_after = after->end_ticks[i],
+        .pitch_after = after->pitches[i],
+        .vel_after = after->vels[i],
+      };
+      if (before)
+        {
+          change.start_before =
+            before->start_ticks[i];
+          change.end_before = before->end_ticks[i];
+          change.pitch_before = before->pitches[i];
+          change.vel_before = before->vels[i];
+        }
+      else
+        {
+          ZRegion * r =
+            after->regions[change.region_idx];
+          MidiNote * mn =
+            r->midi_notes[change.note_idx];
+          ArrangerObject * mn_obj =
+            (ArrangerObject *) mn;
+          change.start_before = mn_obj->pos.ticks;
+          change.end_before = mn_obj->end_pos.ticks;
+          change.pitch_before = mn->val;
+          change.vel_before = mn->vel->vel;
+        }
+
+      if (math_doubles_equal (
+            change.start_before, change.start_after)
+          &&
+          math_doubles_equal (
+            change.end_before, change.end_after)
+          && change.pitch_before == change.pitch_after
+          && change.vel_before == change.vel_after)
+        continue;
+
+      self->note_changes[self->num_note_changes++] =
+        change;
+    }
+
+  undoable_action_init (
+    (UndoableAction *) self,
+    UA_ARRANGER_SELECTIONS);
+
+  UndoableAction * ua = (UndoableAction *) self;
+  return ua;
+}
+
 ArrangerSelectionsAction *
 arranger_selections_action_clone (
   const ArrangerSelectionsAction * src)
@@ -862,6 +1008,8 @@ arranger_selections_action_clone (
     object_new (ArrangerSelectionsAction);
 
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
   self->type = src->type;
 
   if (src->sel)
@@ -964,6 +1112,33 @@ arranger_selections_action_clone (
     self->opts =
       quantize_options_clone (src->opts);
 
+  if (src->note_regions)
+    {
+      self->num_note_regions =
+        src->num_note_regions;
+      self->note_regions =
+        object_new_n (
+          (size_t) MAX (src->num_note_regions, 1),
+          RegionIdentifier);
+      memcpy (
+        self->note_regions, src->note_regions,
+        (size_t) src->num_note_regions
+          * sizeof (RegionIdentifier));
+    }
+  if (src->note_changes)
+    {
+      self->num_note_changes =
+        src->num_note_changes;
+      self->note_changes =
+        object_new_n (
+          (size_t) MAX (src->num_note_changes, 1),
+          MidiNoteChange);
+      memcpy (
+        self->note_changes, src->note_changes,
+        (size_t) src->num_note_changes
+          * sizeof (MidiNoteChange));
+    }
+
   return self;
 }
 
@@ -1137,6 +1312,18 @@ arranger_selections_action_perform_quantize (
     error, sel, opts, error);
 }
 
+bool
+arranger_selections_action_perform_edit_notes (
+  MidiNoteBatch * before,
+  MidiNoteBatch * after,
+  bool            already_edited,
+  GError **       error)
+{
+  UNDO_MANAGER_PERFORM_AND_PROPAGATE_ERR (
+    arranger_selections_action_new_edit_notes,
+    error, before, after, already_edited, error);
+}
+
 static void
 update_region_link_groups (
   ArrangerObject ** objs,
@@ -2394,11 +2581,22 @@ do_or_undo_edit (
             r->name, src_clip_path);
           g_free (src_clip_path);
 
+          /* the clip may be stored in shared
+           * blocks, so get a contiguous copy */
+          float * src_frames =
+            object_new_n (
+              (size_t) num_frames
+              * src_clip->channels,
+              float);
+          audio_clip_copy_frames (
+            src_clip, src_frames, 0, num_frames);
+
           /* replace the frames in the region */
           audio_region_replace_frames (
-            r, src_clip->frames,
+            r, src_frames,
             (size_t) start.frames,
             num_frames, F_NO_DUPLICATE_CLIP);
+          free (src_frames);
         }
       else /* not audio function */
         {
@@ -3012,6 +3210,93 @@ do_or_undo_quantize (
   return 0;
 }
 
+/**
+ * Does or undoes the action.
+ *
+ * Each region is looked up once and a single
+ * event is published for all the notes.
+ *
+ * @param _do 1 to do, 0 to undo.
+ */
+static int
+do_or_undo_edit_notes (
+  ArrangerSelectionsAction * self,
+  const bool                 _do,
+  GError **                  error)
+{
+  /* the values were already written on the first
+   * run */
+  if (self->first_run)
+    {
+      EVENTS_PUSH (
+        ET_ARRANGER_SELECTIONS_CHANGED_REDRAW_EVERYTHING,
+        MA_SELECTIONS);
+      self->first_run = 0;
+      return 0;
+    }
+
+  ZRegion ** regions =
+    object_new_n (
+      (size_t) MAX (self->num_note_regions, 1),
+      ZRegion *);
+  for (int i = 0; i < self->num_note_regions; i++)
+    {
+      regions[i] =
+        region_find (&self->note_regions[i]);
+      if (!regions[i])
+        {
+          g_set_error (
+            error,
+            Z_ACTIONS_ARRANGER_SELECTIONS_ERROR,
+            Z_ACTIONS_ARRANGER_SELECTIONS_ERROR_FAILED,
+            "%s", _("Failed to find region"));
+          free (regions);
+          return -1;
+        }
+    }
+
+  for (int i = 0; i < self->num_note_changes; i++)
+    {
+      MidiNoteChange * change =
+        &self->note_changes[i];
+      if (change->region_idx < 0
+          ||
+          change->region_idx
+            >= self->num_note_regions
+          ||
+          !midi_note_change_apply (
+            change, regions[change->region_idx],
+            _do))
+        {
+          g_set_error (
+            error,
+            Z_ACTIONS_ARRANGER_SELECTIONS_ERROR,
+            Z_ACTIONS_ARRANGER_SELECTIONS_ERROR_FAILED,
+            "%s", _("Failed to find MIDI note"));
+          free (regions);
+          return -1;
+        }
+    }
+
+  /* mark the notes as changed and update linked
+   * regions once per region instead of once per
+   * note */
+  for (int i = 0; i < self->num_note_regions; i++)
+    {
+      region_notes_changed (regions[i]);
+      region_update_link_group (regions[i]);
+    }
+  free (regions);
+
+  EVENTS_PUSH (
+    ET_ARRANGER_SELECTIONS_CHANGED_REDRAW_EVERYTHING,
+    MA_SELECTIONS);
+
+  self->first_run = 0;
+
+  return 0;
+}
+
 static int
 do_or_undo (
   ArrangerSelectionsAction * self,
@@ -3046,6 +3331,9 @@ do_or_undo (
     case AS_ACTION_EDIT:
       return do_or_undo_edit (self, _do, error);
       break;
+    case AS_ACTION_EDIT_NOTES:
+      return
+        do_or_undo_edit_notes (self, _do, error);
     case AS_ACTION_AUTOMATION_FILL:
       return do_or_undo_automation_fill (
         self, _do, error);
@@ -3072,7 +3360,14 @@ arranger_selections_action_do (
   ArrangerSelectionsAction * self,
   GError **                  error)
 {
-  return do_or_undo (self, true, error);
+  int ret = do_or_undo (self, true, error);
+
+  /* the action may have changed the tempo
+   * automation */
+  if (ret == 0)
+    engine_update_tempo_map (AUDIO_ENGINE);
+
+  return ret;
 }
 
 int
@@ -3080,7 +3375,12 @@ arranger_selections_action_undo (
   ArrangerSelectionsAction * self,
   GError **                  error)
 {
-  return do_or_undo (self, false, error);
+  int ret = do_or_undo (self, false, error);
+
+  if (ret == 0)
+    engine_update_tempo_map (AUDIO_ENGINE);
+
+  return ret;
 }
 
 bool
@@ -3175,6 +3475,8 @@ arranger_selections_action_stringize (
     case AS_ACTION_EDIT:
       return
         g_strdup (_("Edit arranger selections"));
+    case AS_ACTION_EDIT_NOTES:
+      return g_strdup (_("Edit MIDI notes"));
     case AS_ACTION_AUTOMATION_FILL:
       return
         g_strdup (_("Automation fill"));
@@ -3204,6 +3506,10 @@ arranger_selections_action_free (
 {
   object_free_w_func_and_null (
     arranger_selections_free_full, self->sel);
+  object_free_w_func_and_null (
+    free, self->note_regions);
+  object_free_w_func_and_null (
+    free, self->note_changes);
 
   object_zero_and_free (self);
 }
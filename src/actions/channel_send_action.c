@@ -95,6 +95,8 @@ channel_send_action_clone (
   ChannelSendAction * self =
     object_new (ChannelSendAction);
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
 
   self->send_before =
     channel_send_clone (src->send_before);
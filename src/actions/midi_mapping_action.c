@@ -112,6 +112,8 @@ midi_mapping_action_clone (
   MidiMappingAction * self =
     object_new (MidiMappingAction);
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
 
   self->idx = src->idx;
   port_identifier_copy (
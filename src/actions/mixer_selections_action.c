@@ -216,6 +216,8 @@ mixer_selections_action_clone (
     object_new (MixerSelectionsAction);
 
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
   self->type = src->type;
   self->slot_type = src->slot_type;
   self->to_slot = src->to_slot;
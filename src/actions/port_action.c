@@ -94,6 +94,8 @@ port_action_clone (
 {
   PortAction * self = object_new (PortAction);
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
 
   self->type = src->type;
   port_identifier_copy (
@@ -76,6 +76,8 @@ port_connection_action_clone (
   PortConnectionAction * self =
     object_new (PortConnectionAction);
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
 
   self->type = src->type;
   self->connection =
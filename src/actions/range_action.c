@@ -100,6 +100,8 @@ range_action_clone (
 {
   RangeAction * self = object_new (RangeAction);
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
 
   self->start_pos = src->start_pos;
   self->end_pos = src->end_pos;
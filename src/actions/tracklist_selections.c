@@ -51,6 +51,7 @@
 typedef enum
 {
   Z_ACTIONS_TRACKLIST_SELECTIONS_ERROR_NO_TRACKS,
+  Z_ACTIONS_TRACKLIST_SELECTIONS_ERROR_FAILED,
 } ZActionsTracklistSelectionsError;
 
 #define Z_ACTIONS_TRACKLIST_SELECTIONS_ERROR \
@@ -554,6 +555,8 @@ tracklist_selections_action_clone (
     object_new (TracklistSelectionsAction);
 
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
 
   self->type = src->type;
   self->track_type = src->track_type;
@@ -741,9 +744,73 @@ tracklist_selections_action_perform_set_direct_out (
 }
 
 /**
- * @param add_to_project Used when the track to
- *   create is meant to be used in the project (ie
- *   not one of the tracks in the action).
+ * Reads the MIDI file saved in the action.
+ *
+ * @return The contents of the file, or NULL if
+ *   failed.
+ */
+static MidiFile *
+read_midi_file (
+  TracklistSelectionsAction * self,
+  GError **                   error)
+{
+  /* create a temporary midi file */
+  GError * err = NULL;
+  char * dir =
+    g_dir_make_tmp (
+      "zrythm_tmp_midi_XXXXXX", &err);
+  if (!dir)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed creating temporary directory"));
+      return NULL;
+    }
+  char * full_path =
+    g_build_filename (dir, "data.MID", NULL);
+  size_t len;
+  uint8_t * data =
+    g_base64_decode (self->base64_midi, &len);
+  MidiFile * midi_file = NULL;
+  err = NULL;
+  if (g_file_set_contents (
+         full_path, (const gchar *) data,
+         (gssize) len, &err))
+    {
+      /* read all the tracks at once */
+      midi_file = midi_file_new (full_path);
+      if (!midi_file)
+        {
+          g_set_error (
+            error,
+            Z_ACTIONS_TRACKLIST_SELECTIONS_ERROR,
+            Z_ACTIONS_TRACKLIST_SELECTIONS_ERROR_FAILED,
+            _("Failed reading MIDI file %s"),
+            self->file_basename);
+        }
+    }
+  else
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err,
+        _("Failed saving file %s"),
+        full_path);
+    }
+
+  /* remove temporary data */
+  io_remove (full_path);
+  io_rmdir (dir, F_NO_FORCE);
+  g_free (dir);
+  g_free (full_path);
+  g_free (data);
+
+  return midi_file;
+}
+
+/**
+ * @param midi_file The contents of the MIDI file to
+ *   create regions from, if creating MIDI tracks
+ *   from a file.
  *
  * @return Non-zero if error.
  */
@@ -751,6 +818,7 @@ static int
 create_track (
   TracklistSelectionsAction * self,
   int                         idx,
+  MidiFile *                  midi_file,
   GError **                   error)
 {
   Track * track;
@@ -889,45 +957,18 @@ create_track (
                self->base64_midi &&
                self->file_basename)
         {
-          /* create a temporary midi file */
-          GError * err = NULL;
-          char * dir =
-            g_dir_make_tmp (
-              "zrythm_tmp_midi_XXXXXX", &err);
-          if (!dir)
-            {
-              g_critical (
-                "failed creating tmpdir: %s",
-                err->message);
-              return -1;
-            }
-          char * full_path =
-            g_build_filename (
-              dir, "data.MID", NULL);
-          size_t len;
-          uint8_t * data =
-            g_base64_decode (
-              self->base64_midi, &len);
-          err = NULL;
-          if (!g_file_set_contents (
-                 full_path,
-                 (const gchar *) data,
-                 (gssize) len, &err))
-            {
-              PROPAGATE_PREFIXED_ERROR (
-                error, err,
-                _("Failed saving file %s"),
-                full_path);
-              return -1;
-            }
-
           /* create a MIDI region from the MIDI
            * file & add to track */
+          MidiFileTrack * mf_track =
+            midi_file ?
+              midi_file_get_nonempty_track (
+                midi_file, idx) : NULL;
           ZRegion * mr =
-            midi_region_new_from_midi_file (
-              &start_pos, full_path,
-              track_get_name_hash (track),
-              0, 0, idx);
+            mf_track ?
+              midi_region_new_from_midi_file_track (
+                &start_pos, mf_track,
+                track_get_name_hash (track),
+                0, 0) : NULL;
           if (mr)
             {
               track_add_region (
@@ -945,15 +986,8 @@ create_track (
               g_message (
                 "Failed to create MIDI region from "
                 "file %s",
-                full_path);
+                self->file_basename);
             }
-
-          /* remove temporary data */
-          io_remove (full_path);
-          io_rmdir (dir, F_NO_FORCE);
-          g_free (dir);
-          g_free (full_path);
-          g_free (data);
         }
 
       if (pl)
@@ -1004,13 +1038,33 @@ do_or_undo_create_or_delete (
     {
       if (create)
         {
+          MidiFile * midi_file = NULL;
+          if (!self->is_empty
+              && self->track_type == TRACK_TYPE_MIDI
+              && self->base64_midi
+              && self->file_basename)
+            {
+              GError * err = NULL;
+              midi_file = read_midi_file (self, &err);
+              if (!midi_file)
+                {
+                  PROPAGATE_PREFIXED_ERROR (
+                    error, err, "%s",
+                    _("Failed to create tracks"));
+                  return -1;
+                }
+            }
+
           for (int i = 0; i < self->num_tracks; i++)
             {
               GError * err = NULL;
               int ret =
-                create_track (self, i, &err);
+                create_track (
+                  self, i, midi_file, &err);
               if (ret != 0)
                 {
+                  object_free_w_func_and_null (
+                    midi_file_free, midi_file);
                   PROPAGATE_PREFIXED_ERROR (
                     error, err,
                     _("Failed to create track "
@@ -1021,6 +1075,8 @@ do_or_undo_create_or_delete (
               /* TODO select each plugin that was
                * selected */
             }
+          object_free_w_func_and_null (
+            midi_file_free, midi_file);
 
           /* disable given track, if any (eg when
            * bouncing) */
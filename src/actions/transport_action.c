@@ -100,6 +100,8 @@ transport_action_clone (
   TransportAction * self =
     object_new (TransportAction);
   self->parent_instance = src->parent_instance;
+  self->parent_instance.history_data = NULL;
+  self->parent_instance.history_data_size = 0;
 
   self->type = src->type;
   self->bpm_before = src->bpm_before;
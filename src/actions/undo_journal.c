@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "actions/undo_journal.h"
+#include "actions/undo_stack.h"
+#include "project.h"
+#include "utils/error.h"
+#include "utils/objects.h"
+#include "utils/yaml.h"
+
+#include <glib/gi18n.h>
+
+typedef enum
+{
+  Z_ACTIONS_UNDO_JOURNAL_ERROR_FAILED,
+} ZActionsUndoJournalError;
+
+#define Z_ACTIONS_UNDO_JOURNAL_ERROR \
+  z_actions_undo_journal_error_quark ()
+GQuark z_actions_undo_journal_error_quark (void);
+G_DEFINE_QUARK (
+  z-actions-undo-journal-error-quark, z_actions_undo_journal_error)
+
+static const cyaml_schema_value_t *
+get_schema (
+  UndoableActionType type)
+{
+  switch (type)
+    {
+    case UA_TRACKLIST_SELECTIONS:
+      return &tracklist_selections_action_schema;
+    case UA_CHANNEL_SEND:
+      return &channel_send_action_schema;
+    case UA_MIXER_SELECTIONS:
+      return &mixer_selections_action_schema;
+    case UA_ARRANGER_SELECTIONS:
+      return &arranger_selections_action_schema;
+    case UA_MIDI_MAPPING:
+      return &midi_mapping_action_schema;
+    case UA_PORT_CONNECTION:
+      return &port_connection_action_schema;
+    case UA_PORT:
+      return &port_action_schema;
+    case UA_TRANSPORT:
+      return &transport_action_schema;
+    case UA_RANGE:
+      return &range_action_schema;
+    default:
+      break;
+    }
+
+  g_return_val_if_reached (NULL);
+}
+
+/**
+ * Creates a new journal backed by a temporary
+ * file.
+ */
+UndoJournal *
+undo_journal_new (
+  GError ** error)
+{
+  UndoJournal * self = object_new (UndoJournal);
+
+  GError * err = NULL;
+  self->file =
+    g_file_new_tmp (
+      "zrythm-undo-journal-XXXXXX", &self->stream,
+      &err);
+  if (!self->file)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed to create undo journal"));
+      object_zero_and_free (self);
+      return NULL;
+    }
+
+  g_message (
+    "created undo journal at %s",
+    g_file_peek_path (self->file));
+
+  return self;
+}
+
+/**
+ * Serializes and compresses the given action.
+ *
+ * @return Newly allocated data to be free'd with
+ *   free(), or NULL on error.
+ */
+char *
+undo_journal_serialize_action (
+  UndoableAction * action,
+  size_t *         size,
+  GError **        error)
+{
+  g_return_val_if_fail (!action->spilled, NULL);
+
+  const cyaml_schema_value_t * schema =
+    get_schema (action->type);
+  g_return_val_if_fail (schema, NULL);
+
+  char * yaml = yaml_serialize (action, schema);
+  if (!yaml)
+    {
+      g_set_error_literal (
+        error, Z_ACTIONS_UNDO_JOURNAL_ERROR,
+        Z_ACTIONS_UNDO_JOURNAL_ERROR_FAILED,
+        _("Failed to serialize action"));
+      return NULL;
+    }
+
+  char * compressed = NULL;
+  GError * err = NULL;
+  bool ret =
+    project_compress (
+      &compressed, size,
+      PROJECT_COMPRESS_DATA,
+      yaml, strlen (yaml) * sizeof (char),
+      PROJECT_COMPRESS_DATA, &err);
+  g_free (yaml);
+  if (!ret)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed to compress action"));
+      return NULL;
+    }
+
+  return compressed;
+}
+
+/**
+ * Appends the given compressed action data to the
+ * journal and returns a stub for it.
+ */
+UndoableAction *
+undo_journal_add_action (
+  UndoJournal *      self,
+  UndoableActionType type,
+  int                num_actions,
+  const char *       str,
+  const char *       data,
+  size_t             size,
+  GError **          error)
+{
+  GError * err = NULL;
+  bool ret =
+    g_seekable_seek (
+      G_SEEKABLE (self->stream), self->size,
+      G_SEEK_SET, NULL, &err);
+  if (ret)
+    {
+      ret =
+        g_output_stream_write_all (
+          g_io_stream_get_output_stream (
+            G_IO_STREAM (self->stream)),
+          data, size, NULL, NULL, &err);
+    }
+  if (!ret)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed to write to undo journal"));
+      return NULL;
+    }
+
+  UndoableAction * stub =
+    object_new (UndoableAction);
+  stub->schema_version =
+    UNDOABLE_ACTION_SCHEMA_VERSION;
+  stub->type = type;
+  stub->num_actions = num_actions;
+  stub->spilled = true;
+  stub->journal_offset = self->size;
+  stub->journal_size = size;
+  stub->spilled_str = g_strdup (str);
+  stub->mem_size = sizeof (UndoableAction);
+
+  self->size += (gint64) size;
+
+  return stub;
+}
+
+/**
+ * Writes the given action to the journal and
+ * returns a stub to replace it with.
+ *
+ * The action itself is not free'd.
+ */
+UndoableAction *
+undo_journal_spill_action (
+  UndoJournal *    self,
+  UndoableAction * action,
+  GError **        error)
+{
+  size_t size;
+  char * data;
+  GError * err = NULL;
+  if (action->history_data)
+    {
+      /* reuse the data cached by the last save */
+      data = action->history_data;
+      size = action->history_data_size;
+    }
+  else
+    {
+      data =
+        undo_journal_serialize_action (
+          action, &size, &err);
+    }
+  if (!data)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed to spill action"));
+      return NULL;
+    }
+
+  char * str = undoable_action_to_string (action);
+  UndoableAction * stub =
+    undo_journal_add_action (
+      self, action->type, action->num_actions,
+      str, data, size, error);
+  g_free (str);
+  if (data != action->history_data)
+    free (data);
+  if (!stub)
+    {
+      return NULL;
+    }
+  stub->stack_idx = action->stack_idx;
+
+  g_debug (
+    "spilled action '%s' (%zu bytes -> %zu "
+    "bytes)",
+    stub->spilled_str, action->mem_size, size);
+
+  return stub;
+}
+
+/**
+ * Reads the compressed data of the given stub.
+ *
+ * @return Newly allocated data to be free'd with
+ *   g_free(), or NULL on error.
+ */
+char *
+undo_journal_read_action (
+  UndoJournal *    self,
+  UndoableAction * stub,
+  size_t *         size,
+  GError **        error)
+{
+  g_return_val_if_fail (stub->spilled, NULL);
+
+  char * data = g_malloc (stub->journal_size);
+  GError * err = NULL;
+  bool ret =
+    g_seekable_seek (
+      G_SEEKABLE (self->stream),
+      stub->journal_offset, G_SEEK_SET, NULL,
+      &err);
+  if (ret)
+    {
+      ret =
+        g_input_stream_read_all (
+          g_io_stream_get_input_stream (
+            G_IO_STREAM (self->stream)),
+          data, stub->journal_size, size, NULL,
+          &err);
+    }
+  if (ret && *size != stub->journal_size)
+    {
+      g_set_error (
+        &err, Z_ACTIONS_UNDO_JOURNAL_ERROR,
+        Z_ACTIONS_UNDO_JOURNAL_ERROR_FAILED,
+        "Short read (%zu of %zu bytes)",
+        *size, stub->journal_size);
+      ret = false;
+    }
+  if (!ret)
+    {
+      g_free (data);
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed to read from undo journal"));
+      return NULL;
+    }
+
+  return data;
+}
+
+/**
+ * Loads the action represented by the given stub
+ * from the journal.
+ *
+ * The stub itself is not free'd.
+ */
+UndoableAction *
+undo_journal_restore_action (
+  UndoJournal *    self,
+  UndoableAction * stub,
+  GError **        error)
+{
+  const cyaml_schema_value_t * schema =
+    get_schema (stub->type);
+  g_return_val_if_fail (schema, NULL);
+
+  size_t compressed_size;
+  GError * err = NULL;
+  char * compressed =
+    undo_journal_read_action (
+      self, stub, &compressed_size, &err);
+  if (!compressed)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed to restore action"));
+      return NULL;
+    }
+
+  char * yaml = NULL;
+  size_t yaml_size;
+  bool ret =
+    project_decompress (
+      &yaml, &yaml_size,
+      PROJECT_DECOMPRESS_DATA,
+      compressed, compressed_size,
+      PROJECT_DECOMPRESS_DATA, &err);
+  g_free (compressed);
+  if (!ret)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, "%s",
+        _("Failed to restore action"));
+      return NULL;
+    }
+
+  /* make string null-terminated */
+  yaml =
+    g_realloc (
+      yaml, yaml_size + sizeof (char));
+  yaml[yaml_size] = '\0';
+
+  UndoableAction * action =
+    (UndoableAction *)
+    yaml_deserialize (yaml, schema);
+  free (yaml);
+  if (!action)
+    {
+      g_set_error (
+        error, Z_ACTIONS_UNDO_JOURNAL_ERROR,
+        Z_ACTIONS_UNDO_JOURNAL_ERROR_FAILED,
+        _("Failed to deserialize action '%s'"),
+        stub->spilled_str);
+      return NULL;
+    }
+
+  undoable_action_init_loaded (action);
+  action->stack_idx = stub->stack_idx;
+  action->num_actions = stub->num_actions;
+  action->mem_size =
+    undoable_action_get_memory_size (action);
+
+  g_debug (
+    "restored action '%s'", stub->spilled_str);
+
+  return action;
+}
+
+/**
+ * Discards the contents of the journal.
+ *
+ * To be called when no stubs refer to it anymore.
+ */
+void
+undo_journal_reset (
+  UndoJournal * self)
+{
+  if (self->size == 0)
+    return;
+
+  GError * err = NULL;
+  bool ret =
+    g_seekable_truncate (
+      G_SEEKABLE (self->stream), 0, NULL, &err);
+  if (!ret)
+    {
+      g_warning (
+        "failed to truncate undo journal: %s",
+        err->message);
+      g_error_free (err);
+      return;
+    }
+  self->size = 0;
+}
+
+void
+undo_journal_free (
+  UndoJournal * self)
+{
+  if (self->stream)
+    {
+      g_io_stream_close (
+        G_IO_STREAM (self->stream), NULL, NULL);
+      g_object_unref (self->stream);
+    }
+  if (self->file)
+    {
+      g_file_delete (self->file, NULL, NULL);
+      g_object_unref (self->file);
+    }
+
+  object_zero_and_free (self);
+}
@@ -17,15 +17,20 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "actions/undoable_action.h"
 #include "actions/undo_stack.h"
 #include "actions/undo_manager.h"
+#include "audio/engine.h"
+#include "audio/pool.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/header.h"
 #include "gui/widgets/home_toolbar.h"
 #include "gui/widgets/main_window.h"
 #include "project.h"
+#include "settings/settings.h"
 #include "utils/error.h"
 #include "utils/objects.h"
 #include "utils/stack.h"
@@ -46,6 +51,26 @@ GQuark z_actions_undo_manager_error_quark (void);
 G_DEFINE_QUARK (
   z-actions-undo-manager-error-quark, z_actions_undo_manager_error)
 
+#define UNDO_HISTORY_MAGIC "ZUNDOHST"
+#define UNDO_HISTORY_VERSION 1
+
+/**
+ * Returns the memory budget from the settings, in
+ * bytes.
+ */
+static size_t
+get_memory_budget (void)
+{
+  if (ZRYTHM_TESTING)
+    return 0;
+
+  return
+    (size_t)
+    g_settings_get_int (
+      S_P_EDITING_UNDO, "undo-memory-budget")
+    * 1024 * 1024;
+}
+
 /**
  * Inits the undo manager by populating the
  * undo/redo stacks.
@@ -58,6 +83,7 @@ undo_manager_init_loaded (
   undo_stack_init_loaded (self->undo_stack);
   undo_stack_init_loaded (self->redo_stack);
   zix_sem_init (&self->action_sem, 1);
+  self->mem_budget = get_memory_budget ();
   g_message ("%s: done", __func__);
 }
 
@@ -76,12 +102,129 @@ undo_manager_new (void)
   self->redo_stack = undo_stack_new ();
 
   zix_sem_init (&self->action_sem, 1);
+  self->mem_budget = get_memory_budget ();
 
   g_message ("%s: done", __func__);
 
   return self;
 }
 
+/**
+ * Loads the given spilled action from the journal
+ * and replaces the stub in the stack with it.
+ *
+ * @return The restored action, or NULL on error.
+ */
+static UndoableAction *
+restore_action (
+  UndoManager *    self,
+  UndoStack *      stack,
+  UndoableAction * stub,
+  GError **        error)
+{
+  g_return_val_if_fail (self->journal, NULL);
+
+  UndoableAction * action =
+    undo_journal_restore_action (
+      self->journal, stub, error);
+  if (!action)
+    return NULL;
+
+  undo_stack_replace_action (stack, stub, action);
+  undoable_action_free (stub);
+
+  return action;
+}
+
+/**
+ * Moves the oldest actions to the journal until
+ * the undo history fits in the memory budget.
+ *
+ * The top action of each stack is always kept in
+ * memory so that a single undo/redo never needs to
+ * read from the disk.
+ */
+static void
+enforce_memory_budget (
+  UndoManager * self)
+{
+  if (self->mem_budget == 0)
+    return;
+
+  size_t total =
+    undo_stack_get_memory_size (self->undo_stack)
+    +
+    undo_stack_get_memory_size (self->redo_stack);
+
+  UndoStack * stacks[] = {
+    self->undo_stack, self->redo_stack };
+  for (int i = 0;
+       i < 2 && total > self->mem_budget; i++)
+    {
+      UndoStack * stack = stacks[i];
+      for (int j = 0;
+           j < stack->stack->top
+           && total > self->mem_budget;
+           j++)
+        {
+          UndoableAction * action =
+            (UndoableAction *)
+            stack->stack->elements[j];
+          if (action->spilled)
+            continue;
+
+          GError * err = NULL;
+          if (!self->journal)
+            {
+              self->journal = undo_journal_new (&err);
+              if (!self->journal)
+                {
+                  HANDLE_ERROR (
+                    err, "%s",
+                    _("Failed to create undo "
+                    "journal"));
+                  return;
+                }
+            }
+
+          size_t mem_size = action->mem_size;
+          UndoableAction * stub =
+            undo_journal_spill_action (
+              self->journal, action, &err);
+          if (!stub)
+            {
+              g_warning (
+                "failed to spill undo action: %s",
+                err->message);
+              g_error_free (err);
+              return;
+            }
+          undo_stack_replace_action (
+            stack, action, stub);
+          undoable_action_free (action);
+
+          total -= mem_size - stub->mem_size;
+        }
+    }
+
+  /* discard the journal contents if nothing
+   * refers to them anymore */
+  if (self->journal
+      &&
+      undo_stack_get_num_spilled_actions (
+        self->undo_stack) == 0
+      &&
+      undo_stack_get_num_spilled_actions (
+        self->redo_stack) == 0)
+    {
+      undo_journal_reset (self->journal);
+    }
+
+  g_debug (
+    "undo history memory: %zu bytes (budget %zu)",
+    total, self->mem_budget);
+}
+
 /**
  * Does or undoes the given action.
  *
@@ -107,6 +250,17 @@ do_or_undo_action (
         (UndoableAction *)
         undo_stack_peek (main_stack);
       need_pop = true;
+
+      if (action->spilled)
+        {
+          action =
+            restore_action (
+              self, main_stack, action, error);
+          if (!action)
+            {
+              return -1;
+            }
+        }
     }
 
   if (ZRYTHM_HAVE_UI)
@@ -218,6 +372,8 @@ undo_manager_undo (
         }
     }
 
+  enforce_memory_budget (self);
+
   if (ZRYTHM_HAVE_UI)
     {
       EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
@@ -278,6 +434,8 @@ undo_manager_redo (
         }
     }
 
+  enforce_memory_budget (self);
+
   if (ZRYTHM_HAVE_UI)
     {
       EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
@@ -332,6 +490,20 @@ undo_manager_perform (
 
   undo_stack_clear (self->redo_stack, true);
 
+  enforce_memory_budget (self);
+
+  /* this goes through all clips and regions, so
+   * only when debugging */
+  if (DEBUGGING
+      && AUDIO_POOL->block_store->num_blocks > 0)
+    {
+      char * mem_str =
+        audio_pool_get_memory_usage_as_string (
+          AUDIO_POOL);
+      g_debug ("audio pool memory: %s", mem_str);
+      g_free (mem_str);
+    }
+
   if (ZRYTHM_HAVE_UI)
     {
       EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
@@ -376,6 +548,20 @@ undo_manager_get_last_action (
   UndoableAction * action =
     (UndoableAction *)
     undo_stack_peek (self->undo_stack);
+  if (action && action->spilled)
+    {
+      GError * err = NULL;
+      action =
+        restore_action (
+          self, self->undo_stack, action, &err);
+      if (!action)
+        {
+          HANDLE_ERROR (
+            err, "%s",
+            _("Failed to restore action"));
+          return NULL;
+        }
+    }
   return action;
 }
 
@@ -393,6 +579,269 @@ undo_manager_clear_stacks (
   undo_stack_clear (self->redo_stack, free);
 }
 
+static void
+append_uint (
+  GByteArray * arr,
+  guint64      val)
+{
+  guint64 le_val = GUINT64_TO_LE (val);
+  g_byte_array_append (
+    arr, (const guint8 *) &le_val, sizeof (le_val));
+}
+
+static bool
+read_uint (
+  const char ** p,
+  const char *  end,
+  guint64 *     val)
+{
+  if ((size_t) (end - *p) < sizeof (guint64))
+    return false;
+
+  guint64 le_val;
+  memcpy (&le_val, *p, sizeof (le_val));
+  *val = GUINT64_FROM_LE (le_val);
+  *p += sizeof (le_val);
+  return true;
+}
+
+/**
+ * Saves the undo history to the given file.
+ *
+ * Actions already in the journal are copied as-is,
+ * so this does not restore them in memory. The
+ * compressed data of the other actions is cached
+ * on them, so only actions done or undone since
+ * the last save are serialized again.
+ *
+ * The action semaphore must be held, since this
+ * may be called outside the GTK thread.
+ */
+bool
+undo_manager_save_history (
+  UndoManager * self,
+  const char *  path,
+  GError **     error)
+{
+  g_message (
+    "%s: saving undo history to %s...",
+    __func__, path);
+
+  GByteArray * arr = g_byte_array_new ();
+  g_byte_array_append (
+    arr, (const guint8 *) UNDO_HISTORY_MAGIC,
+    strlen (UNDO_HISTORY_MAGIC));
+  append_uint (arr, UNDO_HISTORY_VERSION);
+
+  /* for each action, from the bottom of each
+   * stack: type, number of actions, string,
+   * compressed yaml */
+  UndoStack * stacks[] = {
+    self->undo_stack, self->redo_stack };
+  for (int i = 0; i < 2; i++)
+    {
+      Stack * stack = stacks[i]->stack;
+      append_uint (arr, (guint64) (stack->top + 1));
+      for (int j = 0; j <= stack->top; j++)
+        {
+          UndoableAction * ua =
+            (UndoableAction *) stack->elements[j];
+
+          size_t size;
+          char * data;
+          GError * err = NULL;
+          if (ua->spilled)
+            {
+              data =
+                undo_journal_read_action (
+                  self->journal, ua, &size, &err);
+            }
+          else if (ua->history_data)
+            {
+              /* unchanged since the last save */
+              data = ua->history_data;
+              size = ua->history_data_size;
+            }
+          else
+            {
+              data =
+                undo_journal_serialize_action (
+                  ua, &size, &err);
+              ua->history_data = data;
+              ua->history_data_size = size;
+            }
+          if (!data)
+            {
+              PROPAGATE_PREFIXED_ERROR (
+                error, err, "%s",
+                _("Failed to save undo history"));
+              g_byte_array_unref (arr);
+              return false;
+            }
+
+          char * str = undoable_action_to_string (ua);
+          append_uint (arr, (guint64) ua->type);
+          append_uint (
+            arr, (guint64) ua->num_actions);
+          append_uint (arr, strlen (str));
+          g_byte_array_append (
+            arr, (const guint8 *) str, strlen (str));
+          append_uint (arr, size);
+          g_byte_array_append (
+            arr, (const guint8 *) data, size);
+          g_free (str);
+
+          if (ua->spilled)
+            g_free (data);
+        }
+    }
+
+  bool ret =
+    g_file_set_contents (
+      path, (const char *) arr->data,
+      (gssize) arr->len, error);
+  g_byte_array_unref (arr);
+
+  g_message ("%s: done", __func__);
+
+  return ret;
+}
+
+/**
+ * Loads the undo history from the given file, if
+ * it exists.
+ *
+ * The loaded actions are kept in the journal until
+ * needed.
+ */
+bool
+undo_manager_load_history (
+  UndoManager * self,
+  const char *  path,
+  GError **     error)
+{
+  if (!g_file_test (path, G_FILE_TEST_EXISTS))
+    {
+      g_message (
+        "%s: no undo history at %s", __func__,
+        path);
+      return true;
+    }
+
+  g_message (
+    "%s: loading undo history from %s...",
+    __func__, path);
+
+  char * contents;
+  gsize len;
+  if (!g_file_get_contents (
+         path, &contents, &len, error))
+    {
+      return false;
+    }
+
+  bool ret = false;
+  GError * err = NULL;
+  const char * p = contents;
+  const char * end = contents + len;
+  const size_t magic_len =
+    strlen (UNDO_HISTORY_MAGIC);
+  guint64 version;
+  if (len < magic_len
+      || memcmp (p, UNDO_HISTORY_MAGIC, magic_len)
+           != 0)
+    {
+      goto parse_error;
+    }
+  p += magic_len;
+  if (!read_uint (&p, end, &version)
+      || version != UNDO_HISTORY_VERSION)
+    {
+      goto parse_error;
+    }
+
+  if (!self->journal)
+    {
+      self->journal = undo_journal_new (&err);
+      if (!self->journal)
+        {
+          PROPAGATE_PREFIXED_ERROR (
+            error, err, "%s",
+            _("Failed to load undo history"));
+          goto load_end;
+        }
+    }
+
+  UndoStack * stacks[] = {
+    self->undo_stack, self->redo_stack };
+  for (int i = 0; i < 2; i++)
+    {
+      guint64 num_actions;
+      if (!read_uint (&p, end, &num_actions))
+        goto parse_error;
+
+      for (guint64 j = 0; j < num_actions; j++)
+        {
+          guint64 type, num_grouped, str_len, size;
+          if (!read_uint (&p, end, &type)
+              || type > UA_TRANSPORT
+              || !read_uint (&p, end, &num_grouped)
+              || !read_uint (&p, end, &str_len)
+              || str_len > (guint64) (end - p))
+            {
+              goto parse_error;
+            }
+          char * str = g_strndup (p, str_len);
+          p += str_len;
+          if (!read_uint (&p, end, &size)
+              || size > (guint64) (end - p))
+            {
+              g_free (str);
+              goto parse_error;
+            }
+
+          UndoableAction * stub =
+            undo_journal_add_action (
+              self->journal,
+              (UndoableActionType) type,
+              (int) num_grouped, str, p, size,
+              &err);
+          g_free (str);
+          p += size;
+          if (!stub)
+            {
+              PROPAGATE_PREFIXED_ERROR (
+                error, err, "%s",
+                _("Failed to load undo history"));
+              goto load_end;
+            }
+
+          if (undo_stack_is_full (stacks[i]))
+            {
+              UndoableAction * ua =
+                undo_stack_pop_last (stacks[i]);
+              undoable_action_free (ua);
+            }
+          undo_stack_push (stacks[i], stub);
+        }
+    }
+
+  ret = true;
+  g_message ("%s: done", __func__);
+  goto load_end;
+
+parse_error:
+  g_set_error (
+    error, Z_ACTIONS_UNDO_MANAGER_ERROR,
+    Z_ACTIONS_UNDO_MANAGER_ERROR_FAILED,
+    _("Invalid undo history file %s"), path);
+
+load_end:
+  g_free (contents);
+
+  return ret;
+}
+
 UndoManager *
 undo_manager_clone (
   const UndoManager * src)
@@ -423,6 +872,9 @@ undo_manager_free (
 
   zix_sem_destroy (&self->action_sem);
 
+  object_free_w_func_and_null (
+    undo_journal_free, self->journal);
+
   object_zero_and_free (self);
 
   g_message ("%s: done", __func__);
@@ -240,6 +240,8 @@ undo_stack_push (
   STACK_PUSH (self->stack, action);
 
   action->stack_idx = self->stack->top;
+  action->mem_size =
+    undoable_action_get_memory_size (action);
 
   /* CAPS, CamelCase, snake_case */
 #define APPEND_ELEMENT(caps,cc,sc) \
@@ -397,6 +399,115 @@ undo_stack_pop_last (
   return action;
 }
 
+/**
+ * Replaces the given action in the stack with
+ * another one, keeping its position.
+ *
+ * Used when moving actions to or from the undo
+ * journal.
+ */
+void
+undo_stack_replace_action (
+  UndoStack *      self,
+  UndoableAction * old_action,
+  UndoableAction * new_action)
+{
+  g_return_if_fail (
+    old_action->type == new_action->type);
+
+  int idx = old_action->stack_idx;
+  g_return_if_fail (
+    idx >= 0 && idx <= self->stack->top
+    && self->stack->elements[idx] == old_action);
+
+  self->stack->elements[idx] = new_action;
+  new_action->stack_idx = idx;
+
+  /* CAPS, CamelCase, snake_case */
+#define REPLACE_ELEMENT(caps,cc,sc) \
+  case UA_##caps: \
+    for (size_t i = 0; \
+         i < self->num_##sc##_actions; i++) \
+      { \
+        if ((UndoableAction *) \
+              self->sc##_actions[i] == old_action) \
+          { \
+            self->sc##_actions[i] = \
+              (cc##Action *) new_action; \
+            break; \
+          } \
+      } \
+    break
+
+  switch (old_action->type)
+    {
+    REPLACE_ELEMENT (
+      TRACKLIST_SELECTIONS, TracklistSelections,
+      tracklist_selections);
+    REPLACE_ELEMENT (
+      CHANNEL_SEND, ChannelSend, channel_send);
+    REPLACE_ELEMENT (
+      MIXER_SELECTIONS, MixerSelections,
+      mixer_selections);
+    REPLACE_ELEMENT (
+      PORT_CONNECTION, PortConnection,
+      port_connection);
+    REPLACE_ELEMENT (PORT, Port, port);
+    REPLACE_ELEMENT (
+      MIDI_MAPPING, MidiMapping,
+      midi_mapping);
+    REPLACE_ELEMENT (
+      RANGE, Range, range);
+    REPLACE_ELEMENT (
+      TRANSPORT, Transport, transport);
+    REPLACE_ELEMENT (
+      ARRANGER_SELECTIONS, ArrangerSelections, as);
+    }
+
+#undef REPLACE_ELEMENT
+}
+
+/**
+ * Returns the estimated memory used by the
+ * actions in the stack, in bytes.
+ */
+size_t
+undo_stack_get_memory_size (
+  UndoStack * self)
+{
+  size_t size = 0;
+  for (int i = 0; i <= self->stack->top; i++)
+    {
+      UndoableAction * ua =
+        (UndoableAction *)
+        self->stack->elements[i];
+      size += ua->mem_size;
+    }
+
+  return size;
+}
+
+/**
+ * Returns the number of actions in the stack that
+ * were moved to the undo journal.
+ */
+int
+undo_stack_get_num_spilled_actions (
+  UndoStack * self)
+{
+  int num_spilled = 0;
+  for (int i = 0; i <= self->stack->top; i++)
+    {
+      UndoableAction * ua =
+        (UndoableAction *)
+        self->stack->elements[i];
+      if (ua->spilled)
+        num_spilled++;
+    }
+
+  return num_spilled;
+}
+
 bool
 undo_stack_contains_clip (
   UndoStack * self,
@@ -19,17 +19,23 @@
 
 #include "audio/engine.h"
 #include "actions/arranger_selections.h"
+#include "actions/channel_send_action.h"
+#include "actions/midi_mapping_action.h"
 #include "actions/mixer_selections_action.h"
+#include "actions/port_action.h"
+#include "actions/port_connection_action.h"
 #include "actions/range_action.h"
 #include "actions/tracklist_selections.h"
 #include "actions/transport_action.h"
 #include "actions/undoable_action.h"
 #include "project.h"
 #include "utils/flags.h"
+#include "utils/objects.h"
 #include "zrythm_app.h"
 
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <stdlib.h>
 
 void
 undoable_action_init_loaded (
@@ -217,6 +223,9 @@ undoable_action_can_contain_clip (
     {
     case UA_TRACKLIST_SELECTIONS:
       {
+        if (self->spilled)
+          return true;
+
         TracklistSelectionsAction * action =
           (TracklistSelectionsAction *) self;
         return action->pool_id >= 0;
@@ -233,6 +242,22 @@ undoable_action_can_contain_clip (
   return false;
 }
 
+/**
+ * Frees the cached history data, to be called
+ * when the action changes.
+ */
+static void
+clear_history_data (
+  UndoableAction * self)
+{
+  if (self->history_data)
+    {
+      free (self->history_data);
+      self->history_data = NULL;
+      self->history_data_size = 0;
+    }
+}
+
 /**
  * Performs the action.
  *
@@ -245,6 +270,10 @@ undoable_action_do (
   UndoableAction * self,
   GError **        error)
 {
+  g_return_val_if_fail (!self->spilled, -1);
+
+  clear_history_data (self);
+
 #if 0
   g_debug ("waiting for port operation lock...");
   zix_sem_wait (&AUDIO_ENGINE->port_operation_lock);
@@ -348,6 +377,10 @@ undoable_action_undo (
   UndoableAction * self,
   GError **        error)
 {
+  g_return_val_if_fail (!self->spilled, -1);
+
+  clear_history_data (self);
+
   /*zix_sem_wait (&AUDIO_ENGINE->port_operation_lock);*/
 
   EngineState state;
@@ -440,6 +473,17 @@ undoable_action_contains_clip (
   UndoableAction * self,
   AudioClip *      clip)
 {
+  /* the contents of spilled actions are not
+   * available, so assume they refer to the clip
+   * if they can contain any */
+  if (self->spilled)
+    {
+      return
+        self->type == UA_TRACKLIST_SELECTIONS
+        || self->type == UA_ARRANGER_SELECTIONS
+        || self->type == UA_RANGE;
+    }
+
   bool ret = false;
 
   switch (self->type)
@@ -490,6 +534,127 @@ undoable_action_contains_clip (
   return ret;
 }
 
+/**
+ * Returns the estimated memory used by the action,
+ * in bytes.
+ */
+size_t
+undoable_action_get_memory_size (
+  UndoableAction * self)
+{
+  if (self->spilled)
+    {
+      return sizeof (UndoableAction);
+    }
+
+  size_t size = 0;
+  switch (self->type)
+    {
+    case UA_TRACKLIST_SELECTIONS:
+      {
+        TracklistSelectionsAction * action =
+          (TracklistSelectionsAction *) self;
+        size = sizeof (TracklistSelectionsAction);
+        if (action->tls_before)
+          size +=
+            tracklist_selections_get_memory_size (
+              action->tls_before);
+        if (action->tls_after)
+          size +=
+            tracklist_selections_get_memory_size (
+              action->tls_after);
+        if (action->foldable_tls_before)
+          size +=
+            tracklist_selections_get_memory_size (
+              action->foldable_tls_before);
+      }
+      break;
+    case UA_ARRANGER_SELECTIONS:
+      {
+        ArrangerSelectionsAction * action =
+          (ArrangerSelectionsAction *) self;
+        size = sizeof (ArrangerSelectionsAction);
+        if (action->sel)
+          size +=
+            arranger_selections_get_memory_size (
+              action->sel);
+        if (action->sel_after)
+          size +=
+            arranger_selections_get_memory_size (
+              action->sel_after);
+        for (int i = 0; i < action->num_split_objs;
+             i++)
+          {
+            if (action->r1[i])
+              size +=
+                arranger_object_get_memory_size (
+                  action->r1[i]);
+            if (action->r2[i])
+              size +=
+                arranger_object_get_memory_size (
+                  action->r2[i]);
+          }
+        if (action->region_before)
+          size +=
+            arranger_object_get_memory_size (
+              (ArrangerObject *)
+              action->region_before);
+        if (action->region_after)
+          size +=
+            arranger_object_get_memory_size (
+              (ArrangerObject *)
+              action->region_after);
+        size +=
+          (size_t) action->num_note_regions
+            * sizeof (RegionIdentifier)
+          +
+          (size_t) action->num_note_changes
+            * sizeof (MidiNoteChange);
+      }
+      break;
+    case UA_RANGE:
+      {
+        RangeAction * action = (RangeAction *) self;
+        size =
+          sizeof (RangeAction) + sizeof (Transport);
+        if (action->sel_before)
+          size +=
+            arranger_selections_get_memory_size (
+              (ArrangerSelections *)
+              action->sel_before);
+        if (action->sel_after)
+          size +=
+            arranger_selections_get_memory_size (
+              (ArrangerSelections *)
+              action->sel_after);
+      }
+      break;
+    case UA_CHANNEL_SEND:
+      size = sizeof (ChannelSendAction);
+      break;
+    case UA_MIXER_SELECTIONS:
+      size = sizeof (MixerSelectionsAction);
+      break;
+    case UA_MIDI_MAPPING:
+      size = sizeof (MidiMappingAction);
+      break;
+    case UA_PORT_CONNECTION:
+      size = sizeof (PortConnectionAction);
+      break;
+    case UA_PORT:
+      size = sizeof (PortAction);
+      break;
+    case UA_TRANSPORT:
+      size = sizeof (TransportAction);
+      break;
+    default:
+      size = sizeof (UndoableAction);
+      break;
+    }
+
+  return size;
+}
+
 /**
  * Sets the number of actions for this action.
  *
@@ -571,6 +736,11 @@ char *
 undoable_action_to_string (
   UndoableAction * ua)
 {
+  if (ua->spilled)
+    {
+      return g_strdup (ua->spilled_str);
+    }
+
 #define STRINGIZE_UA(caps,cc,sc) \
   case UA_##caps: \
     return sc##_action_stringize ( \
@@ -610,6 +780,15 @@ undoable_action_to_string (
 void
 undoable_action_free (UndoableAction * self)
 {
+  clear_history_data (self);
+
+  if (self->spilled)
+    {
+      g_free_and_null (self->spilled_str);
+      object_zero_and_free (self);
+      return;
+    }
+
 /* uppercase, camel case, snake case */
 #define FREE_ACTION(uc,sc,cc) \
   case UA_##uc: \
@@ -43,6 +43,7 @@
 typedef enum
 {
   Z_AUDIO_AUDIO_FUNCTION_ERROR_INVALID_POSITIONS,
+  Z_AUDIO_AUDIO_FUNCTION_ERROR_FAILED,
 } ZAudioAudioFunctionError;
 
 #define Z_AUDIO_AUDIO_FUNCTION_ERROR \
@@ -391,6 +392,18 @@ audio_function_apply (
   AudioClip * orig_clip =  audio_region_get_clip (r);
   g_return_val_if_fail (orig_clip, -1);
 
+  /* streamed clips are loaded for editing */
+  if (!audio_clip_make_resident (orig_clip))
+    {
+      g_set_error (
+        error,
+        Z_AUDIO_AUDIO_FUNCTION_ERROR,
+        Z_AUDIO_AUDIO_FUNCTION_ERROR_FAILED,
+        _("Failed to load clip %s"),
+        orig_clip->name);
+      return -1;
+    }
+
   Position init_pos;
   position_init (&init_pos);
   if (position_is_before (
@@ -595,6 +608,13 @@ audio_function_apply (
   audio_clip_write_to_pool (
     clip, false, F_NOT_BACKUP);
 
+  /* this clip is only used by the undo history,
+   * so keep it in shared blocks (the unchanged
+   * parts are shared with the clips of previous
+   * edits on the same selection) */
+  audio_clip_move_frames_to_blocks (
+    clip, AUDIO_POOL->block_store);
+
   audio_sel->pool_id = clip->pool_id;
 
   if (type != AUDIO_FUNCTION_INVALID)
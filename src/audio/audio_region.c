@@ -20,6 +20,7 @@
 #include "audio/channel.h"
 #include "audio/audio_region.h"
 #include "audio/clip.h"
+#include "audio/disk_streamer.h"
 #include "audio/fade.h"
 #include "audio/pool.h"
 #include "audio/stretcher.h"
@@ -124,7 +125,8 @@ audio_region_new (
     {
       self->pool_id = pool_id;
       clip = AUDIO_POOL->clips[pool_id];
-      g_warn_if_fail (clip && clip->frames);
+      g_warn_if_fail (
+        clip && (clip->frames || clip->stream_path));
     }
 
   /* set end pos to sample end */
@@ -192,7 +194,8 @@ audio_region_get_clip (
     }
 
   g_return_val_if_fail (
-    clip && clip->frames && clip->num_frames > 0,
+    clip && (clip->frames || clip->stream_path)
+    && clip->num_frames > 0,
     NULL);
 
   return clip;
@@ -248,9 +251,18 @@ audio_region_replace_frames (
       self->pool_id = clip->pool_id;
     }
 
+  /* streamed clips are loaded for editing */
+  if (!audio_clip_make_resident (clip))
+    {
+      g_warning (
+        "failed to load clip %s", clip->name);
+      return;
+    }
+
   dsp_copy (
     &clip->frames[start_frame * clip->channels],
     frames, num_frames * clip->channels);
+  clip->frames_dirty = true;
 
   audio_clip_write_to_pool (
     clip, false, F_NOT_BACKUP);
@@ -390,36 +402,47 @@ audio_region_fill_stereo_ports (
     &r_local_pos_at_start, &r_local_pos_at_end);
 #endif
 
-  size_t buff_index_start =
-    (size_t) clip->num_frames + 16;
-  size_t buff_size = 0;
-  nframes_t prev_offset = time_nfo->local_offset;
-  for (unsigned_frame_t j =
-         (unsigned_frame_t)
-         ((r_local_frames_at_start < 0) ?
-           - r_local_frames_at_start : 0);
-       j < time_nfo->nframes; j++)
+  if (clip->stream_path)
+    {
+      /* streamed clips are played back without
+       * realtime timestretching */
+      disk_streamer_read (
+        AUDIO_ENGINE->disk_streamer, self, clip,
+        time_nfo->g_start_frame, time_nfo->nframes,
+        lbuf_after_ts, rbuf_after_ts);
+    }
+  else
     {
-      unsigned_frame_t current_local_frame =
-        time_nfo->local_offset + j;
-      signed_frame_t r_local_pos =
-        region_timeline_frames_to_local (
-          self,
-          (signed_frame_t)
-          (time_nfo->g_start_frame + j),
-          F_NORMALIZE);
-      if (r_local_pos < 0 ||
-          j > AUDIO_ENGINE->block_length)
+      size_t buff_index_start =
+        (size_t) clip->num_frames + 16;
+      size_t buff_size = 0;
+      nframes_t prev_offset = time_nfo->local_offset;
+      for (unsigned_frame_t j =
+             (unsigned_frame_t)
+             ((r_local_frames_at_start < 0) ?
+               - r_local_frames_at_start : 0);
+           j < time_nfo->nframes; j++)
         {
-          g_critical (
-            "invalid r_local_pos %ld, j %lu, "
-            "g_start_frames %lu, nframes %u",
-            r_local_pos, j, time_nfo->g_start_frame,
-            time_nfo->nframes);
-          return;
-        }
+          unsigned_frame_t current_local_frame =
+            time_nfo->local_offset + j;
+          signed_frame_t r_local_pos =
+            region_timeline_frames_to_local (
+              self,
+              (signed_frame_t)
+              (time_nfo->g_start_frame + j),
+              F_NORMALIZE);
+          if (r_local_pos < 0 ||
+              j > AUDIO_ENGINE->block_length)
+            {
+              g_critical (
+                "invalid r_local_pos %ld, j %lu, "
+                "g_start_frames %lu, nframes %u",
+                r_local_pos, j, time_nfo->g_start_frame,
+                time_nfo->nframes);
+              return;
+            }
 
-      ssize_t buff_index = r_local_pos;
+          ssize_t buff_index = r_local_pos;
 
 #define STRETCH \
 timestretch_buf ( \
@@ -429,71 +452,72 @@ timestretch_buf ( \
   prev_offset, \
   (unsigned_frame_t) ((current_local_frame - prev_offset) + 1))
 
-      /* if we are starting at a new
-       * point in the audio clip */
-      if (needs_rt_timestretch)
-        {
-          buff_index =
-            (ssize_t)
-            (buff_index * timestretch_ratio);
-          if (buff_index <
-                (ssize_t) buff_index_start)
+          /* if we are starting at a new
+           * point in the audio clip */
+          if (needs_rt_timestretch)
             {
-              g_message (
-                "buff index (%zd) < "
-                "buff index start (%zd)",
-                buff_index,
-                buff_index_start);
-              /* set the start point (
-               * used when
-               * timestretching) */
-              buff_index_start =
-                (size_t) buff_index;
-
-              /* timestretch the material
-               * up to this point */
-              if (buff_size > 0)
+              buff_index =
+                (ssize_t)
+                (buff_index * timestretch_ratio);
+              if (buff_index <
+                    (ssize_t) buff_index_start)
                 {
                   g_message (
-                    "buff size (%zd) > 0",
-                    buff_size);
+                    "buff index (%zd) < "
+                    "buff index start (%zd)",
+                    buff_index,
+                    buff_index_start);
+                  /* set the start point (
+                   * used when
+                   * timestretching) */
+                  buff_index_start =
+                    (size_t) buff_index;
+
+                  /* timestretch the material
+                   * up to this point */
+                  if (buff_size > 0)
+                    {
+                      g_message (
+                        "buff size (%zd) > 0",
+                        buff_size);
+                      STRETCH;
+                      prev_offset = current_local_frame;
+                    }
+                  buff_size = 0;
+                }
+              /* else if last sample */
+              else if (j == (time_nfo->nframes - 1))
+                {
                   STRETCH;
                   prev_offset = current_local_frame;
                 }
-              buff_size = 0;
-            }
-          /* else if last sample */
-          else if (j == (time_nfo->nframes - 1))
-            {
-              STRETCH;
-              prev_offset = current_local_frame;
+              else
+                {
+                  buff_size++;
+                }
             }
+          /* else if no need for timestretch */
           else
             {
-              buff_size++;
-            }
-        }
-      /* else if no need for timestretch */
-      else
-        {
-          z_return_if_fail_cmp (buff_index, >=, 0);
-          if (G_UNLIKELY (
-                buff_index >=
-                  (ssize_t) clip->num_frames))
-            {
-              g_critical (
-                "Buffer index %zd exceeds %zu "
-                "frames in clip '%s'",
-                buff_index, clip->num_frames,
-                clip->name);
-              return;
+              z_return_if_fail_cmp (buff_index, >=, 0);
+              if (G_UNLIKELY (
+                    buff_index >=
+                      (ssize_t) clip->num_frames))
+                {
+                  g_critical (
+                    "Buffer index %zd exceeds %zu "
+                    "frames in clip '%s'",
+                    buff_index, clip->num_frames,
+                    clip->name);
+                  return;
+                }
+              lbuf_after_ts[j] =
+                clip->ch_frames[0][buff_index];
+              rbuf_after_ts[j] =
+                clip->channels == 1 ?
+                clip->ch_frames[0][buff_index] :
+                clip->ch_frames[1][buff_index];
             }
-          lbuf_after_ts[j] =
-            clip->ch_frames[0][buff_index];
-          rbuf_after_ts[j] =
-            clip->channels == 1 ?
-            clip->ch_frames[0][buff_index] :
-            clip->ch_frames[1][buff_index];
         }
     }
 
@@ -523,80 +547,78 @@ timestretch_buf ( \
     r_obj->end_pos.frames -
       (r_obj->fade_out_pos.frames +
        r_obj->pos.frames);
-  for (nframes_t j = 0; j < time_nfo->nframes; j++)
+  signed_frame_t cycle_start_local_frame =
+    (signed_frame_t)
+    (time_nfo->g_start_frame +
+       time_nfo->local_offset) -
+    r_obj->pos.frames;
+  signed_frame_t cycle_end_local_frame =
+    cycle_start_local_frame +
+    (signed_frame_t) time_nfo->nframes;
+  float fade_gains[time_nfo->nframes];
+
+  /* if inside fade in */
+  signed_frame_t fade_start =
+    MAX (cycle_start_local_frame, 0);
+  signed_frame_t fade_end =
+    MIN (
+      cycle_end_local_frame,
+      r_obj->fade_in_pos.frames);
+  if (fade_start < fade_end)
     {
-      unsigned_frame_t current_cycle_frame =
-        time_nfo->local_offset + j;
-      signed_frame_t current_local_frame =
-        (signed_frame_t)
-        (time_nfo->g_start_frame +
-          current_cycle_frame) -
-        r_obj->pos.frames;
-
-      /* skip to fade out if not in any fade area */
-      if (G_LIKELY (
-            current_local_frame >=
-              r_obj->fade_in_pos.frames
-            &&
-            current_local_frame <
-              r_obj->fade_out_pos.frames))
-        {
-          j +=
-            r_obj->fade_out_pos.frames -
-            current_local_frame;
-          j--;
-          continue;
-        }
+      nframes_t offset =
+        time_nfo->local_offset +
+        (nframes_t)
+        (fade_start - cycle_start_local_frame);
+      size_t fade_nframes =
+        (size_t) (fade_end - fade_start);
+      fade_get_y_normalized_block (
+        &r_obj->fade_in_opts, 1,
+        (double) fade_start /
+          (double) num_frames_in_fade_in_area,
+        1.0 / (double) num_frames_in_fade_in_area,
+        fade_gains, fade_nframes);
+      dsp_mul2 (
+        &stereo_ports->l->buf[offset], fade_gains,
+        fade_nframes);
+      dsp_mul2 (
+        &stereo_ports->r->buf[offset], fade_gains,
+        fade_nframes);
+    }
 
-      /* if inside fade in */
-      if (current_local_frame >= 0 &&
-          current_local_frame <
-            r_obj->fade_in_pos.frames)
-        {
-          z_return_if_fail_cmp (
-            num_frames_in_fade_in_area, >, 0);
-          z_return_if_fail_cmp (
-            current_local_frame, <=,
-            num_frames_in_fade_in_area);
-          float fade_in =
-            (float)
-            fade_get_y_normalized (
-              (double) current_local_frame /
-              (double)
-              num_frames_in_fade_in_area,
-              &r_obj->fade_in_opts, 1);
-
-          stereo_ports->l->buf[current_cycle_frame] *=
-            fade_in;
-          stereo_ports->r->buf[current_cycle_frame] *=
-            fade_in;
-        }
-      /* if inside fade out */
-      if (current_local_frame >=
-            r_obj->fade_out_pos.frames)
-        {
-          z_return_if_fail_cmp (
-            num_frames_in_fade_out_area, >, 0);
-          signed_frame_t num_frames_from_fade_out_start =
-            current_local_frame -
-              r_obj->fade_out_pos.frames;
-          z_return_if_fail_cmp (
-            num_frames_from_fade_out_start, <=,
-            num_frames_in_fade_out_area);
-          float fade_out =
-            (float)
-            fade_get_y_normalized (
-              (double)
-              num_frames_from_fade_out_start /
-              (double)
-              num_frames_in_fade_out_area,
-              &r_obj->fade_out_opts, 0);
-
-          stereo_ports->l->buf[current_cycle_frame] *=
-            fade_out;
-          stereo_ports->r->buf[current_cycle_frame] *=
-            fade_out;
-        }
+  /* if inside fade out */
+  fade_start =
+    MAX (
+      cycle_start_local_frame,
+      r_obj->fade_out_pos.frames);
+  fade_end =
+    MIN (
+      cycle_end_local_frame,
+      r_obj->fade_out_pos.frames +
+        num_frames_in_fade_out_area + 1);
+  if (fade_start < fade_end)
+    {
+      z_return_if_fail_cmp (
+        num_frames_in_fade_out_area, >, 0);
+      nframes_t offset =
+        time_nfo->local_offset +
+        (nframes_t)
+        (fade_start - cycle_start_local_frame);
+      size_t fade_nframes =
+        (size_t) (fade_end - fade_start);
+      fade_get_y_normalized_block (
+        &r_obj->fade_out_opts, 0,
+        (double)
+        (fade_start - r_obj->fade_out_pos.frames) /
+          (double) num_frames_in_fade_out_area,
+        1.0 / (double) num_frames_in_fade_out_area,
+        fade_gains, fade_nframes);
+      dsp_mul2 (
+        &stereo_ports->l->buf[offset], fade_gains,
+        fade_nframes);
+      dsp_mul2 (
+        &stereo_ports->r->buf[offset], fade_gains,
+        fade_nframes);
     }
 }
 
@@ -608,6 +630,13 @@ audio_region_detect_bpm (
   AudioClip * clip = audio_region_get_clip (self);
   g_return_val_if_fail (clip, 0.f);
 
+  if (!audio_clip_make_resident (clip))
+    {
+      g_warning (
+        "failed to load clip %s", clip->name);
+      return 0.f;
+    }
+
   return
     audio_detect_bpm (
       clip->ch_frames[0], (size_t) clip->num_frames,
@@ -41,6 +41,7 @@
 #include "plugins/plugin.h"
 #include "project.h"
 #include "settings/settings.h"
+#include "utils/dsp.h"
 #include "utils/flags.h"
 #include "utils/math.h"
 #include "utils/objects.h"
@@ -286,6 +287,40 @@ automation_point_get_normalized_value_in_curve (
   return dy;
 }
 
+/**
+ * Fills @p buf with @p size points on the curve,
+ * starting at normalized x @p x_start and
+ * advancing by @p x_step.
+ *
+ * @param ap The start point (0, 0).
+ */
+void
+automation_point_get_normalized_values_in_curve (
+  AutomationPoint * self,
+  double            x_start,
+  double            x_step,
+  float *           buf,
+  size_t            size)
+{
+  ZRegion * region =
+    arranger_object_get_region (
+      (ArrangerObject *) self);
+  AutomationPoint * next_ap =
+    automation_region_get_next_ap (
+      region, self, true, true);
+  if (!next_ap)
+    {
+      dsp_fill (buf, self->fvalue, size);
+      return;
+    }
+
+  int start_higher =
+    next_ap->normalized_val < self->normalized_val;
+  curve_get_normalized_y_block (
+    &self->curve_opts, start_higher, x_start,
+    x_step, buf, size);
+}
+
 /**
  * Sets the curviness of the AutomationPoint.
  */
@@ -139,12 +139,16 @@ automation_region_add_ap (
   g_return_if_fail (
     IS_REGION (self) && IS_ARRANGER_OBJECT (ap));
 
+  region_refresh_children_positions (self);
+
   /* add point */
   array_double_size_if_full (
     self->aps, self->num_aps, self->aps_size,
     AutomationPoint *);
   array_append (
     self->aps, self->num_aps, ap);
+  arranger_object_update_child_positions (
+    (ArrangerObject *) ap, self, true);
 
   /* re-sort */
   automation_region_force_sort (self);
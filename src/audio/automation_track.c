@@ -373,6 +373,8 @@ automation_track_get_ap_before_pos (
       return NULL;
     }
 
+  region_refresh_children_positions (r);
+
   /* if region ends before pos, assume pos is the
    * region's end pos */
   signed_frame_t local_pos =
@@ -392,7 +394,8 @@ automation_track_get_ap_before_pos (
     {
       ap = r->aps[i];
       obj = (ArrangerObject *) ap;
-      if (obj->pos.frames <= local_pos)
+      if (region_get_child_frames (r, &obj->pos)
+            <= local_pos)
         return ap;
     }
 
@@ -800,9 +803,11 @@ automation_track_get_val_at_pos (
 
   /* ratio of how far in we are in the curve */
   signed_frame_t ap_frames =
-    position_to_frames (&ap_obj->pos);
+    region_get_child_frames (
+      region, &ap_obj->pos);
   signed_frame_t next_ap_frames =
-    position_to_frames (&next_ap_obj->pos);
+    region_get_child_frames (
+      region, &next_ap_obj->pos);
   double ratio =
     (double) (localp - ap_frames) /
     (double) (next_ap_frames - ap_frames);
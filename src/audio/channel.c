@@ -822,7 +822,8 @@ channel_connect_plugins (
             continue;
 
           if (!plugin->instantiated
-              && !plugin->instantiation_failed)
+              && !plugin->instantiation_failed
+              && !plugin->instantiation_pending)
             {
               /* TODO handle error */
               plugin_instantiate (
@@ -913,14 +914,16 @@ channel_connect_plugins (
 
           if (prev_pl
               && !prev_pl->instantiated
-              && !prev_pl->instantiation_failed)
+              && !prev_pl->instantiation_failed
+              && !prev_pl->instantiation_pending)
             {
               plugin_instantiate (
                 prev_pl, NULL, NULL);
             }
           if (next_pl
               && !next_pl->instantiated
-              && !next_pl->instantiation_failed)
+              && !next_pl->instantiation_failed
+              && !next_pl->instantiation_pending)
             {
               plugin_instantiate (
                 next_pl, NULL, NULL);
@@ -74,6 +74,8 @@ chord_region_insert_chord_object (
 {
   g_return_if_fail (IS_REGION (self));
 
+  region_refresh_children_positions (self);
+
   char str[500];
   ChordDescriptor * cd =
     chord_object_get_chord_descriptor (chord);
@@ -89,6 +91,8 @@ chord_region_insert_chord_object (
   array_insert (
     self->chord_objects, self->num_chord_objects,
     pos, chord);
+  arranger_object_update_child_positions (
+    (ArrangerObject *) chord, self, true);
 
   for (int i = pos; i < self->num_chord_objects; i++)
     {
@@ -171,6 +171,8 @@ chord_track_get_chord_at_pos (
       return NULL;
     }
 
+  region_refresh_children_positions (region);
+
   signed_frame_t local_frames =
     (signed_frame_t)
     region_timeline_frames_to_local (
@@ -184,7 +186,9 @@ chord_track_get_chord_at_pos (
     {
       chord = region->chord_objects[i];
       c_obj = (ArrangerObject *) chord;
-      if (c_obj->pos.frames <= local_frames)
+      if (region_get_child_frames (
+            region, &c_obj->pos)
+          <= local_frames)
         return chord;
     }
   return NULL;
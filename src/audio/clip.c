@@ -18,8 +18,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "audio/clip.h"
+#include "audio/clip_cache.h"
+#include "audio/disk_streamer.h"
 #include "audio/encoder.h"
 #include "audio/engine.h"
 #include "audio/tempo_track.h"
@@ -41,6 +44,8 @@
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 
+#include <sndfile.h>
+
 static AudioClip *
 _create (void)
 {
@@ -86,19 +91,24 @@ audio_clip_update_channel_caches (
     }
 }
 
+/**
+ * Decodes the given file into the clip's frames,
+ * resampling to the given sample rate.
+ *
+ * Only the clip is accessed so this can be called
+ * from worker threads.
+ */
 static void
-audio_clip_init_from_file (
-  AudioClip * self,
-  const char * full_path)
+decode_file (
+  AudioClip *  self,
+  const char * full_path,
+  int          samplerate)
 {
-  g_return_if_fail (self);
-
-  self->samplerate =
-    (int) AUDIO_ENGINE->sample_rate;
-  g_return_if_fail (self->samplerate > 0);
+  self->samplerate = samplerate;
 
   AudioEncoder * enc =
     audio_encoder_new_from_file (full_path);
+  g_return_if_fail (enc);
   audio_encoder_decode (
     enc, self->samplerate, F_SHOW_PROGRESS);
 
@@ -111,13 +121,7 @@ audio_clip_init_from_file (
   self->num_frames = enc->num_out_frames;
   dsp_copy (
     self->frames, enc->out_frames, arr_size);
-  g_free_and_null (self->name);
-  char * basename = g_path_get_basename (full_path);
-  self->name = io_file_strip_ext (basename);
-  g_free (basename);
   self->channels = enc->nfo.channels;
-  self->bpm =
-    tempo_track_get_current_bpm (P_TEMPO_TRACK);
   switch (enc->nfo.bit_depth)
     {
     case 16:
@@ -145,6 +149,373 @@ audio_clip_init_from_file (
   audio_encoder_free (enc);
 }
 
+static void
+audio_clip_init_from_file (
+  AudioClip * self,
+  const char * full_path)
+{
+  g_return_if_fail (self);
+
+  int samplerate =
+    (int) AUDIO_ENGINE->sample_rate;
+  g_return_if_fail (samplerate > 0);
+
+  decode_file (self, full_path, samplerate);
+
+  g_free_and_null (self->name);
+  char * basename = g_path_get_basename (full_path);
+  self->name = io_file_strip_ext (basename);
+  g_free (basename);
+  self->bpm =
+    tempo_track_get_current_bpm (P_TEMPO_TRACK);
+}
+
+/**
+ * Sets up the clip to be streamed from the given
+ * file during playback instead of keeping its
+ * frames in memory.
+ *
+ * This only succeeds if the file is at the given
+ * sample rate and has at least @p min_frames
+ * frames.
+ *
+ * Any frames in memory are freed, so this must
+ * only be used on clips that are not being played
+ * back.
+ *
+ * @return Whether the clip will be streamed.
+ */
+bool
+audio_clip_init_streaming (
+  AudioClip *      self,
+  const char *     filepath,
+  int              samplerate,
+  unsigned_frame_t min_frames)
+{
+  g_return_val_if_fail (!self->blocks, false);
+
+  SF_INFO sfinfo;
+  memset (&sfinfo, 0, sizeof (sfinfo));
+  SNDFILE * sndfile =
+    sf_open (filepath, SFM_READ, &sfinfo);
+  if (!sndfile)
+    return false;
+
+  if (sfinfo.samplerate != samplerate
+      || sfinfo.frames <= 0
+      || (unsigned_frame_t) sfinfo.frames < min_frames
+      || sfinfo.channels <= 0
+      || sfinfo.channels
+           > (int) G_N_ELEMENTS (self->ch_frames))
+    {
+      sf_close (sndfile);
+      return false;
+    }
+
+  /* summarize the file for drawing */
+  size_t num_peaks =
+    ((size_t) sfinfo.frames
+     + AUDIO_CLIP_PEAK_FRAMES - 1)
+    / AUDIO_CLIP_PEAK_FRAMES;
+  float * peaks =
+    object_new_n (num_peaks * 2, float);
+  float * buf =
+    object_new_n (
+      AUDIO_CLIP_PEAK_FRAMES
+        * (size_t) sfinfo.channels,
+      float);
+  for (size_t i = 0; i < num_peaks; i++)
+    {
+      sf_count_t nread =
+        sf_readf_float (
+          sndfile, buf, AUDIO_CLIP_PEAK_FRAMES);
+      size_t num_samples =
+        (size_t) MAX (nread, 0)
+        * (size_t) sfinfo.channels;
+      peaks[i * 2] =
+        MIN (dsp_min (buf, num_samples), 0.f);
+      peaks[i * 2 + 1] =
+        MAX (dsp_max (buf, num_samples), 0.f);
+    }
+  free (buf);
+  sf_close (sndfile);
+
+  object_zero_and_free (self->frames);
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      object_zero_and_free_if_nonnull (
+        self->ch_frames[i]);
+    }
+  object_zero_and_free (self->peaks);
+  self->peaks = peaks;
+  self->num_peaks = num_peaks;
+  self->num_frames =
+    (unsigned_frame_t) sfinfo.frames;
+  self->channels = (channels_t) sfinfo.channels;
+  self->samplerate = samplerate;
+  g_free (self->stream_path);
+  self->stream_path = g_strdup (filepath);
+
+  g_message (
+    "streaming %s (%zu frames)", filepath,
+    (size_t) self->num_frames);
+
+  return true;
+}
+
+/**
+ * Loads the frames of a streamed clip into memory
+ * so that they can be edited.
+ *
+ * Does nothing if the clip is not streamed.
+ *
+ * @return Whether the frames are in memory.
+ */
+bool
+audio_clip_make_resident (
+  AudioClip * self)
+{
+  if (!self->stream_path)
+    return self->frames != NULL;
+
+  decode_file (
+    self, self->stream_path, self->samplerate);
+  if (!self->frames)
+    return false;
+
+  /* switch playback to the frames before letting
+   * go of the file */
+  char * stream_path = self->stream_path;
+  g_atomic_pointer_set (&self->stream_path, NULL);
+  if (PROJECT && AUDIO_ENGINE
+      && AUDIO_ENGINE->disk_streamer)
+    {
+      disk_streamer_forget_clip (
+        AUDIO_ENGINE->disk_streamer, self);
+    }
+  g_free (stream_path);
+  object_zero_and_free (self->peaks);
+  self->num_peaks = 0;
+
+  return true;
+}
+
+/**
+ * Gets the minimum and maximum sample (across all
+ * channels) in the given range of frames.
+ *
+ * For streamed clips the range is widened to
+ * whole peaks.
+ *
+ * The values in @p min and @p max are only
+ * replaced if exceeded.
+ */
+void
+audio_clip_get_min_max (
+  const AudioClip * self,
+  signed_frame_t    start_frame,
+  signed_frame_t    end_frame,
+  float *           min,
+  float *           max)
+{
+  start_frame = MAX (start_frame, 0);
+  end_frame =
+    MIN (
+      end_frame, (signed_frame_t) self->num_frames);
+  if (start_frame >= end_frame)
+    return;
+
+  if (self->frames)
+    {
+      size_t offset =
+        (size_t) start_frame * self->channels;
+      size_t num_samples =
+        (size_t) (end_frame - start_frame)
+        * self->channels;
+      *min =
+        MIN (
+          *min,
+          dsp_min (&self->frames[offset], num_samples));
+      *max =
+        MAX (
+          *max,
+          dsp_max (&self->frames[offset], num_samples));
+    }
+  else if (self->peaks)
+    {
+      size_t start_peak =
+        (size_t) start_frame / AUDIO_CLIP_PEAK_FRAMES;
+      size_t end_peak =
+        ((size_t) end_frame - 1)
+        / AUDIO_CLIP_PEAK_FRAMES;
+      for (size_t i = start_peak; i <= end_peak; i++)
+        {
+          *min = MIN (*min, self->peaks[i * 2]);
+          *max = MAX (*max, self->peaks[i * 2 + 1]);
+        }
+    }
+}
+
+/**
+ * Gets the size, modification time (in
+ * microseconds) and inode of the given file.
+ *
+ * @return Whether the file exists.
+ */
+static bool
+get_file_info (
+  const char * path,
+  gint64 *     size,
+  gint64 *     mtime,
+  guint64 *    inode)
+{
+  GFile * file = g_file_new_for_path (path);
+  GFileInfo * info =
+    g_file_query_info (
+      file,
+      G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+      G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+      G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+      G_FILE_ATTRIBUTE_UNIX_INODE,
+      G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  g_object_unref (file);
+  if (!info)
+    return false;
+
+  *size = (gint64) g_file_info_get_size (info);
+  *mtime =
+    (gint64)
+      g_file_info_get_attribute_uint64 (
+        info, G_FILE_ATTRIBUTE_TIME_MODIFIED)
+      * G_USEC_PER_SEC
+    + (gint64)
+      g_file_info_get_attribute_uint32 (
+        info,
+        G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  *inode =
+    g_file_info_get_attribute_uint64 (
+      info, G_FILE_ATTRIBUTE_UNIX_INODE);
+  g_object_unref (info);
+
+  return true;
+}
+
+/**
+ * Remembers the current size, modification time
+ * and inode of the given file as the file that
+ * @ref AudioClip.file_hash belongs to.
+ */
+static void
+store_file_info (
+  AudioClip *  self,
+  const char * path)
+{
+  if (!get_file_info (
+         path, &self->file_size,
+         &self->file_mtime, &self->file_inode))
+    {
+      self->file_size = 0;
+      self->file_mtime = 0;
+      self->file_inode = 0;
+    }
+}
+
+/**
+ * Returns the hash of the given file.
+ *
+ * If the file was not touched since
+ * store_file_info() was called for it, @ref
+ * AudioClip.file_hash is returned without reading
+ * the file.
+ *
+ * @return A newly allocated string, or NULL if the
+ *   file does not exist.
+ */
+static char *
+get_file_hash (
+  AudioClip *  self,
+  const char * path)
+{
+  gint64 size, mtime;
+  guint64 inode;
+  if (!get_file_info (path, &size, &mtime, &inode))
+    return NULL;
+
+  if (self->file_hash && self->file_size > 0
+      && size == self->file_size
+      && mtime == self->file_mtime
+      && inode == self->file_inode)
+    {
+      return g_strdup (self->file_hash);
+    }
+
+  return
+    hash_get_from_file (
+      path, HASH_ALGORITHM_XXH3_64);
+}
+
+/**
+ * Loads the frames of a clip from its file in the
+ * pool, resampled to the given sample rate.
+ *
+ * Long clips are streamed instead (see
+ * audio_clip_init_streaming()).
+ *
+ * If @p cache_dir is non-NULL, the frames are
+ * taken from the resampled clip cache when
+ * possible and stored there after decoding
+ * otherwise.
+ *
+ * The project is not accessed so this can be
+ * called from worker threads.
+ *
+ * @param filepath Path of the clip's file in the
+ *   pool.
+ * @param cache_dir Clip cache directory, or NULL.
+ */
+void
+audio_clip_load_frames_from_file (
+  AudioClip *  self,
+  const char * filepath,
+  int          samplerate,
+  const char * cache_dir)
+{
+  g_return_if_fail (samplerate > 0);
+
+  if (audio_clip_init_streaming (
+        self, filepath, samplerate,
+        (unsigned_frame_t) samplerate
+          * AUDIO_CLIP_STREAM_MIN_SECONDS))
+    return;
+
+  char * file_hash = NULL;
+  if (cache_dir)
+    {
+      file_hash = get_file_hash (self, filepath);
+    }
+
+  if (file_hash
+      &&
+      audio_clip_cache_load (
+        cache_dir, self, file_hash, samplerate))
+    {
+      g_debug (
+        "loaded %s from the clip cache", filepath);
+      audio_clip_update_channel_caches (self, 0);
+    }
+  else
+    {
+      decode_file (self, filepath, samplerate);
+      if (file_hash && self->num_frames > 0)
+        {
+          audio_clip_cache_store (
+            cache_dir, self, file_hash);
+        }
+    }
+
+  g_free (file_hash);
+}
+
 /**
  * Inits after loading a Project.
  */
@@ -159,9 +530,11 @@ audio_clip_init_loaded (
     audio_clip_get_path_in_pool_from_name (
       self->name, self->use_flac, F_NOT_BACKUP);
 
-  bpm_t bpm = self->bpm;
-  audio_clip_init_from_file (self, filepath);
-  self->bpm = bpm;
+  char * cache_dir = audio_clip_cache_get_dir ();
+  audio_clip_load_frames_from_file (
+    self, filepath,
+    (int) AUDIO_ENGINE->sample_rate, cache_dir);
+  g_free (cache_dir);
 
   g_free (filepath);
 }
@@ -180,6 +553,7 @@ audio_clip_new_from_file (
   audio_clip_init_from_file (self, full_path);
 
   self->pool_id = -1;
+  self->frames_dirty = true;
   self->bpm =
     tempo_track_get_current_bpm (P_TEMPO_TRACK);
 
@@ -214,6 +588,7 @@ audio_clip_new_from_float_array (
   self->bit_depth = bit_depth;
   self->use_flac = bit_depth < BIT_DEPTH_32;
   self->pool_id = -1;
+  self->frames_dirty = true;
   dsp_copy (
     self->frames, arr,
     (size_t) nframes * (size_t) channels);
@@ -250,6 +625,7 @@ audio_clip_new_recording (
   self->num_frames = nframes;
   self->name = g_strdup (name);
   self->pool_id = -1;
+  self->frames_dirty = true;
   self->bpm =
     tempo_track_get_current_bpm (P_TEMPO_TRACK);
   self->samplerate = (int) AUDIO_ENGINE->sample_rate;
@@ -264,6 +640,189 @@ audio_clip_new_recording (
   return self;
 }
 
+/**
+ * Moves the frames of the clip into shared blocks
+ * in the given store and frees the contiguous
+ * frame buffers.
+ *
+ * @note This must only be used on clips that are
+ *   not played back.
+ */
+void
+audio_clip_move_frames_to_blocks (
+  AudioClip *           self,
+  AudioClipBlockStore * store)
+{
+  g_return_if_fail (!self->blocks);
+  if (!self->frames || self->num_frames == 0)
+    return;
+
+  self->num_blocks =
+    (size_t)
+    ((self->num_frames + AUDIO_CLIP_BLOCK_FRAMES - 1)
+     / AUDIO_CLIP_BLOCK_FRAMES);
+  self->blocks =
+    object_new_n (
+      self->num_blocks, AudioClipBlock *);
+  for (size_t i = 0; i < self->num_blocks; i++)
+    {
+      size_t start_frame =
+        i * AUDIO_CLIP_BLOCK_FRAMES;
+      size_t nframes =
+        MIN (
+          AUDIO_CLIP_BLOCK_FRAMES,
+          (size_t) self->num_frames - start_frame);
+      self->blocks[i] =
+        audio_clip_block_store_acquire (
+          store,
+          &self->frames[start_frame * self->channels],
+          nframes * self->channels);
+    }
+
+  g_debug (
+    "moved clip %s (%zu frames) to %zu blocks",
+    self->name, (size_t) self->num_frames,
+    self->num_blocks);
+
+  object_zero_and_free (self->frames);
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      object_zero_and_free_if_nonnull (
+        self->ch_frames[i]);
+    }
+}
+
+/**
+ * Restores the contiguous frame buffers (and
+ * channel caches) from the clip's blocks and
+ * releases the blocks.
+ */
+void
+audio_clip_load_frames_from_blocks (
+  AudioClip * self)
+{
+  g_return_if_fail (self->blocks && !self->frames);
+
+  self->frames =
+    object_new_n (
+      (size_t) self->num_frames * self->channels,
+      sample_t);
+  audio_clip_copy_frames (
+    self, self->frames, 0, self->num_frames);
+
+  for (size_t i = 0; i < self->num_blocks; i++)
+    {
+      audio_clip_block_release (self->blocks[i]);
+    }
+  object_zero_and_free (self->blocks);
+  self->num_blocks = 0;
+
+  audio_clip_update_channel_caches (self, 0);
+}
+
+/**
+ * Copies interleaved frames from the clip into
+ * \ref dest, regardless of whether the clip is
+ * stored contiguously, in blocks or streamed.
+ */
+void
+audio_clip_copy_frames (
+  const AudioClip * self,
+  float *           dest,
+  unsigned_frame_t  start_frame,
+  unsigned_frame_t  num_frames)
+{
+  g_return_if_fail (
+    start_frame + num_frames <= self->num_frames);
+
+  if (self->stream_path)
+    {
+      SF_INFO sfinfo;
+      memset (&sfinfo, 0, sizeof (sfinfo));
+      SNDFILE * sndfile =
+        sf_open (self->stream_path, SFM_READ, &sfinfo);
+      sf_count_t nread = 0;
+      if (sndfile
+          && sf_seek (
+               sndfile, (sf_count_t) start_frame,
+               SEEK_SET) == (sf_count_t) start_frame)
+        {
+          nread =
+            sf_readf_float (
+              sndfile, dest,
+              (sf_count_t) num_frames);
+        }
+      if (sndfile)
+        sf_close (sndfile);
+      if (nread < (sf_count_t) num_frames)
+        {
+          g_warning (
+            "failed to read %s", self->stream_path);
+          nread = MAX (nread, 0);
+          dsp_fill (
+            &dest[(size_t) nread * self->channels], 0.f,
+            ((size_t) num_frames - (size_t) nread)
+              * self->channels);
+        }
+      return;
+    }
+
+  if (!self->blocks)
+    {
+      dsp_copy (
+        dest, &self->frames[
+          start_frame * self->channels],
+        (size_t) num_frames * self->channels);
+      return;
+    }
+
+  size_t cur_frame = (size_t) start_frame;
+  size_t end_frame =
+    (size_t) (start_frame + num_frames);
+  while (cur_frame < end_frame)
+    {
+      size_t block_idx =
+        cur_frame / AUDIO_CLIP_BLOCK_FRAMES;
+      size_t offset_in_block =
+        cur_frame % AUDIO_CLIP_BLOCK_FRAMES;
+      AudioClipBlock * block =
+        self->blocks[block_idx];
+      size_t frames_in_block =
+        block->num_samples / self->channels;
+      size_t nframes =
+        MIN (
+          frames_in_block - offset_in_block,
+          end_frame - cur_frame);
+      dsp_copy (
+        &dest[(cur_frame - start_frame)
+              * self->channels],
+        &block->data[
+          offset_in_block * self->channels],
+        nframes * self->channels);
+      cur_frame += nframes;
+    }
+}
+
+/**
+ * Returns the number of bytes used by the clip's
+ * contiguous frame buffers and channel caches.
+ */
+size_t
+audio_clip_get_resident_bytes (
+  const AudioClip * self)
+{
+  if (self->peaks)
+    return self->num_peaks * 2 * sizeof (float);
+
+  if (!self->frames)
+    return 0;
+
+  /* interleaved frames + per-channel caches */
+  return
+    2 * (size_t) self->num_frames
+    * self->channels * sizeof (float);
+}
+
 /**
  * Gets the path of a clip matching \ref name from
  * the pool.
@@ -357,12 +916,14 @@ audio_clip_write_to_pool (
   /* whether a new write is needed */
   bool need_new_write = true;
 
-  /* skip if file with same hash already exists */
-  if (file_exists (new_path) && !parts)
+  /* skip if file with same hash already exists
+   * (the file is only read if it changed since
+   * its hash was last checked) */
+  if (!self->frames_dirty && !parts
+      && file_exists (new_path))
     {
       char * existing_file_hash =
-        hash_get_from_file (
-          new_path, HASH_ALGORITHM_XXH3_64);
+        get_file_hash (self, new_path);
       bool same_hash =
         self->file_hash &&
         string_is_equal (
@@ -376,6 +937,10 @@ audio_clip_write_to_pool (
             "in pool",
             new_path);
           need_new_write = false;
+          if (!is_backup)
+            {
+              store_file_info (self, new_path);
+            }
         }
 #if 0
       else
@@ -391,15 +956,15 @@ audio_clip_write_to_pool (
 
   /* if writing to backup and same file exists in
    * main project dir, copy (first try reflink) */
-  if (need_new_write && self->file_hash && is_backup)
+  if (need_new_write && self->file_hash && is_backup
+      && !self->frames_dirty)
     {
       bool exists_in_main_project = false;
       if (file_exists (path_in_main_project))
         {
           char * existing_file_hash =
-            hash_get_from_file (
-              path_in_main_project,
-              HASH_ALGORITHM_XXH3_64);
+            get_file_hash (
+              self, path_in_main_project);
           exists_in_main_project =
             string_is_equal (
               self->file_hash, existing_file_hash);
@@ -458,13 +1023,22 @@ audio_clip_write_to_pool (
       audio_clip_write_to_file (
         self, new_path, parts);
 
-      if (!parts)
+      if (parts)
+        {
+          self->frames_dirty = true;
+        }
+      else
         {
           /* store file hash */
           g_free_and_null (self->file_hash);
           self->file_hash =
             hash_get_from_file (
               new_path, HASH_ALGORITHM_XXH3_64);
+          if (!is_backup)
+            {
+              store_file_info (self, new_path);
+              self->frames_dirty = false;
+            }
         }
     }
 
@@ -489,6 +1063,60 @@ audio_clip_write_to_file (
   bool         parts)
 {
   g_return_val_if_fail (self->samplerate > 0, -1);
+
+  /* streamed clips are already in a file in the
+   * right format */
+  if (self->stream_path)
+    {
+      g_return_val_if_fail (!parts, -1);
+      if (string_is_equal (
+            self->stream_path, filepath))
+        return 0;
+
+      GFile * src_file =
+        g_file_new_for_path (self->stream_path);
+      GFile * dest_file =
+        g_file_new_for_path (filepath);
+      GError * err = NULL;
+      bool copied =
+        g_file_copy (
+          src_file, dest_file,
+          G_FILE_COPY_OVERWRITE, NULL, NULL, NULL,
+          &err);
+      if (!copied)
+        {
+          g_warning (
+            "Failed to copy '%s' to '%s': %s",
+            self->stream_path, filepath,
+            err->message);
+          g_error_free (err);
+        }
+      g_object_unref (src_file);
+      g_object_unref (dest_file);
+      return copied ? 0 : -1;
+    }
+
+  /* clips stored in blocks are written in one go
+   * from a temporary contiguous copy */
+  if (self->blocks)
+    {
+      g_return_val_if_fail (!parts, -1);
+      size_t num_samples =
+        (size_t) self->num_frames * self->channels;
+      float * frames =
+        object_new_n (num_samples, float);
+      audio_clip_copy_frames (
+        self, frames, 0, self->num_frames);
+      int ret =
+        audio_write_raw_file (
+          frames, 0, self->num_frames,
+          (uint32_t) self->samplerate,
+          self->use_flac, self->bit_depth,
+          self->channels, filepath);
+      free (frames);
+      return ret;
+    }
+
   size_t before_frames =
     (size_t) self->frames_written;
   unsigned_frame_t ch_offset =
@@ -770,6 +1398,10 @@ audio_clip_clone (
 
   self->name = g_strdup (src->name);
   self->file_hash = g_strdup (src->file_hash);
+  self->file_size = src->file_size;
+  self->file_mtime = src->file_mtime;
+  self->file_inode = src->file_inode;
+  self->frames_dirty = src->frames_dirty;
   self->bpm = src->bpm;
   self->bit_depth = src->bit_depth;
   self->use_flac = src->use_flac;
@@ -792,6 +1424,19 @@ audio_clip_free (
       object_zero_and_free_if_nonnull (
         self->ch_frames[i]);
     }
+  for (size_t i = 0; i < self->num_blocks; i++)
+    {
+      audio_clip_block_release (self->blocks[i]);
+    }
+  object_zero_and_free (self->blocks);
+  if (self->stream_path && PROJECT && AUDIO_ENGINE
+      && AUDIO_ENGINE->disk_streamer)
+    {
+      disk_streamer_forget_clip (
+        AUDIO_ENGINE->disk_streamer, self);
+    }
+  g_free_and_null (self->stream_path);
+  object_zero_and_free (self->peaks);
   g_free_and_null (self->name);
   g_free_and_null (self->file_hash);
 
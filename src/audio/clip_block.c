@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "audio/clip_block.h"
+#include "utils/dsp.h"
+#include "utils/objects.h"
+
+#include <xxhash.h>
+
+static void
+free_block (
+  AudioClipBlock * block)
+{
+  free (block->data);
+  object_zero_and_free (block);
+}
+
+AudioClipBlockStore *
+audio_clip_block_store_new (void)
+{
+  AudioClipBlockStore * self =
+    object_new (AudioClipBlockStore);
+
+  self->blocks =
+    g_hash_table_new (g_int64_hash, g_int64_equal);
+
+  return self;
+}
+
+/**
+ * Returns a block containing a copy of the given
+ * samples, sharing an existing block if one with
+ * identical content exists.
+ *
+ * The reference count of the returned block is
+ * incremented.
+ */
+AudioClipBlock *
+audio_clip_block_store_acquire (
+  AudioClipBlockStore * self,
+  const float *         data,
+  size_t                num_samples)
+{
+  size_t bytes = num_samples * sizeof (float);
+  uint64_t hash = XXH3_64bits (data, bytes);
+
+  AudioClipBlock * first =
+    g_hash_table_lookup (self->blocks, &hash);
+  for (AudioClipBlock * block = first; block;
+       block = block->next)
+    {
+      if (block->num_samples == num_samples
+          && memcmp (block->data, data, bytes) == 0)
+        {
+          block->refcount++;
+          self->referenced_bytes += bytes;
+          return block;
+        }
+    }
+
+  AudioClipBlock * block =
+    object_new (AudioClipBlock);
+  block->hash = hash;
+  block->num_samples = num_samples;
+  block->data = object_new_n (num_samples, float);
+  dsp_copy (block->data, data, num_samples);
+  block->refcount = 1;
+  block->store = self;
+
+  /* prepend to the collision chain (the key points
+   * to the hash stored in the block, so re-insert
+   * with the new head) */
+  block->next = first;
+  if (first)
+    {
+      g_hash_table_steal (self->blocks, &hash);
+    }
+  g_hash_table_insert (
+    self->blocks, &block->hash, block);
+
+  self->num_blocks++;
+  self->allocated_bytes += bytes;
+  self->referenced_bytes += bytes;
+
+  return block;
+}
+
+/**
+ * Decrements the reference count of the block and
+ * frees it if no longer referenced.
+ */
+void
+audio_clip_block_release (
+  AudioClipBlock * block)
+{
+  AudioClipBlockStore * self = block->store;
+  size_t bytes = block->num_samples * sizeof (float);
+
+  g_return_if_fail (block->refcount > 0);
+  block->refcount--;
+  self->referenced_bytes -= bytes;
+  if (block->refcount > 0)
+    return;
+
+  /* unlink from the collision chain */
+  AudioClipBlock * first =
+    g_hash_table_lookup (self->blocks, &block->hash);
+  g_return_if_fail (first);
+  if (first == block)
+    {
+      g_hash_table_steal (
+        self->blocks, &block->hash);
+      if (block->next)
+        {
+          g_hash_table_insert (
+            self->blocks, &block->next->hash,
+            block->next);
+        }
+    }
+  else
+    {
+      AudioClipBlock * prev = first;
+      while (prev->next && prev->next != block)
+        prev = prev->next;
+      g_return_if_fail (prev->next == block);
+      prev->next = block->next;
+    }
+
+  self->num_blocks--;
+  self->allocated_bytes -= bytes;
+
+  free_block (block);
+}
+
+void
+audio_clip_block_store_free (
+  AudioClipBlockStore * self)
+{
+  if (self->num_blocks > 0)
+    {
+      g_warning (
+        "freeing block store with %zu blocks "
+        "still referenced",
+        self->num_blocks);
+    }
+
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init (&iter, self->blocks);
+  while (g_hash_table_iter_next (
+           &iter, &key, &value))
+    {
+      AudioClipBlock * block =
+        (AudioClipBlock *) value;
+      while (block)
+        {
+          AudioClipBlock * next = block->next;
+          free_block (block);
+          block = next;
+        }
+    }
+  g_hash_table_destroy (self->blocks);
+
+  object_zero_and_free (self);
+}
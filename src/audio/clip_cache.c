@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "audio/clip.h"
+#include "audio/clip_cache.h"
+#include "utils/io.h"
+#include "zrythm.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#define CACHE_MAGIC "ZCC1"
+#define CACHE_EXT ".zclip"
+
+/**
+ * Header of a cache entry, followed by the
+ * interleaved frames.
+ *
+ * Entries are only read on the machine that wrote
+ * them so native byte order is used.
+ */
+typedef struct CacheHeader
+{
+  char     magic[4];
+  uint32_t channels;
+  uint32_t samplerate;
+  uint32_t bit_depth;
+  uint64_t num_frames;
+} CacheHeader;
+
+typedef struct CacheEntry
+{
+  char *  path;
+  gint64  mtime;
+  size_t  size;
+} CacheEntry;
+
+static char *
+get_entry_path (
+  const char * dir,
+  const char * file_hash,
+  int          samplerate)
+{
+  char * filename =
+    g_strdup_printf (
+      "%s-%d" CACHE_EXT, file_hash, samplerate);
+  char * path =
+    g_build_filename (dir, filename, NULL);
+  g_free (filename);
+
+  return path;
+}
+
+/**
+ * Returns a newly allocated string with the
+ * directory of the clip cache.
+ *
+ * Must be called from the main thread.
+ */
+char *
+audio_clip_cache_get_dir (void)
+{
+  char * cache_dir =
+    zrythm_get_dir (ZRYTHM_DIR_USER_CACHE);
+  char * dir =
+    g_build_filename (cache_dir, "clips", NULL);
+  g_free (cache_dir);
+
+  return dir;
+}
+
+/**
+ * Loads the frames of the clip from the cache
+ * entry for the given file hash and sample rate.
+ *
+ * The clip's frames, number of frames, channels,
+ * sample rate and bit depth are set on success.
+ *
+ * This only accesses the given clip and the
+ * filesystem so it can be called from any thread.
+ *
+ * @param dir Cache directory.
+ * @param file_hash Hash of the original file.
+ *
+ * @return Whether a valid entry was found.
+ */
+bool
+audio_clip_cache_load (
+  const char * dir,
+  AudioClip *  clip,
+  const char * file_hash,
+  int          samplerate)
+{
+  char * path =
+    get_entry_path (dir, file_hash, samplerate);
+
+  GStatBuf st;
+  if (g_stat (path, &st) != 0)
+    {
+      g_free (path);
+      return false;
+    }
+
+  FILE * f = g_fopen (path, "rb");
+  if (!f)
+    {
+      g_free (path);
+      return false;
+    }
+
+  CacheHeader header;
+  bool valid =
+    fread (&header, sizeof (header), 1, f) == 1
+    && memcmp (
+         header.magic, CACHE_MAGIC,
+         sizeof (header.magic)) == 0
+    && header.samplerate == (uint32_t) samplerate
+    && header.channels > 0
+    && header.channels
+         <= G_N_ELEMENTS (clip->ch_frames)
+    && header.bit_depth <= BIT_DEPTH_32
+    && header.num_frames > 0
+    && (uint64_t) st.st_size
+         == sizeof (header)
+              + header.num_frames
+                  * header.channels
+                  * sizeof (float);
+  if (!valid)
+    {
+      g_message (
+        "ignoring invalid clip cache entry %s",
+        path);
+      fclose (f);
+      g_free (path);
+      return false;
+    }
+
+  size_t num_samples =
+    (size_t) header.num_frames
+    * (size_t) header.channels;
+  float * frames =
+    g_try_malloc (num_samples * sizeof (float));
+  if (!frames
+      ||
+      fread (frames, sizeof (float), num_samples, f)
+        != num_samples)
+    {
+      g_warning (
+        "failed to read clip cache entry %s",
+        path);
+      g_free (frames);
+      fclose (f);
+      g_free (path);
+      return false;
+    }
+  fclose (f);
+
+  g_free (clip->frames);
+  clip->frames = frames;
+  clip->num_frames =
+    (unsigned_frame_t) header.num_frames;
+  clip->channels = (channels_t) header.channels;
+  clip->samplerate = samplerate;
+  clip->bit_depth = (BitDepth) header.bit_depth;
+  clip->use_flac = clip->bit_depth < BIT_DEPTH_32;
+
+  /* mark as recently used */
+  g_utime (path, NULL);
+  g_free (path);
+
+  return true;
+}
+
+/**
+ * Stores the frames of the clip in the cache,
+ * using the clip's sample rate as part of the
+ * key.
+ *
+ * This only accesses the given clip and the
+ * filesystem so it can be called from any thread.
+ *
+ * @param dir Cache directory.
+ * @param file_hash Hash of the original file.
+ */
+void
+audio_clip_cache_store (
+  const char *      dir,
+  const AudioClip * clip,
+  const char *      file_hash)
+{
+  g_return_if_fail (
+    clip->frames && clip->num_frames > 0
+    && clip->channels > 0);
+
+  if (io_mkdir (dir) != 0)
+    {
+      g_warning (
+        "failed to create clip cache directory %s",
+        dir);
+      return;
+    }
+
+  char * path =
+    get_entry_path (
+      dir, file_hash, clip->samplerate);
+
+  /* write to a temporary file first so that
+   * readers never see partial entries */
+  char * tmp_path =
+    g_strdup_printf ("%s.XXXXXX", path);
+  int fd = g_mkstemp (tmp_path);
+  if (fd < 0)
+    {
+      g_warning (
+        "failed to create %s: %s", tmp_path,
+        g_strerror (errno));
+      g_free (tmp_path);
+      g_free (path);
+      return;
+    }
+  FILE * f = fdopen (fd, "wb");
+  if (!f)
+    {
+      g_close (fd, NULL);
+      g_unlink (tmp_path);
+      g_free (tmp_path);
+      g_free (path);
+      return;
+    }
+
+  CacheHeader header;
+  memset (&header, 0, sizeof (header));
+  memcpy (
+    header.magic, CACHE_MAGIC,
+    sizeof (header.magic));
+  header.channels = (uint32_t) clip->channels;
+  header.samplerate = (uint32_t) clip->samplerate;
+  header.bit_depth = (uint32_t) clip->bit_depth;
+  header.num_frames = (uint64_t) clip->num_frames;
+
+  size_t num_samples =
+    (size_t) clip->num_frames
+    * (size_t) clip->channels;
+  bool written =
+    fwrite (&header, sizeof (header), 1, f) == 1
+    &&
+    fwrite (
+      clip->frames, sizeof (float), num_samples, f)
+      == num_samples;
+  written = fclose (f) == 0 && written;
+
+  if (!written
+      || g_rename (tmp_path, path) != 0)
+    {
+      g_warning (
+        "failed to write clip cache entry %s",
+        path);
+      g_unlink (tmp_path);
+    }
+
+  g_free (tmp_path);
+  g_free (path);
+}
+
+static int
+cmp_entry_mtime (
+  const void * a,
+  const void * b)
+{
+  const CacheEntry * entry_a = a;
+  const CacheEntry * entry_b = b;
+  return
+    (entry_a->mtime > entry_b->mtime)
+    - (entry_a->mtime < entry_b->mtime);
+}
+
+/**
+ * Removes the least recently used entries until
+ * the cache is no larger than @p max_bytes.
+ */
+void
+audio_clip_cache_prune (
+  const char * dir,
+  size_t       max_bytes)
+{
+  GDir * gdir = g_dir_open (dir, 0, NULL);
+  if (!gdir)
+    return;
+
+  GArray * entries =
+    g_array_new (false, false, sizeof (CacheEntry));
+  size_t total = 0;
+  const char * filename;
+  while ((filename = g_dir_read_name (gdir)))
+    {
+      if (!g_str_has_suffix (filename, CACHE_EXT))
+        continue;
+
+      CacheEntry entry;
+      entry.path =
+        g_build_filename (dir, filename, NULL);
+      GStatBuf st;
+      if (g_stat (entry.path, &st) != 0)
+        {
+          g_free (entry.path);
+          continue;
+        }
+      entry.mtime = (gint64) st.st_mtime;
+      entry.size = (size_t) st.st_size;
+      total += entry.size;
+      g_array_append_val (entries, entry);
+    }
+  g_dir_close (gdir);
+
+  g_array_sort (entries, cmp_entry_mtime);
+
+  for (guint i = 0; i < entries->len; i++)
+    {
+      CacheEntry * entry =
+        &g_array_index (entries, CacheEntry, i);
+      if (total > max_bytes)
+        {
+          g_message (
+            "removing clip cache entry %s",
+            entry->path);
+          if (g_unlink (entry->path) == 0)
+            total -= entry->size;
+        }
+      g_free (entry->path);
+    }
+  g_array_free (entries, true);
+}
@@ -376,6 +376,108 @@ curve_get_fade_presets (void)
   return arr;
 }
 
+/**
+ * Fills @p buf with the Y values of the curve at
+ * @p size consecutive X values, starting at
+ * @p x_start and advancing by @p x_step.
+ *
+ * The curve is evaluated exactly every
+ * CURVE_BLOCK_SEGMENT_SIZE values and linearly
+ * interpolated in between, so that a whole gain
+ * ramp costs only a few evaluations. Segments
+ * where the interpolation is off by more than
+ * CURVE_BLOCK_MAX_ERROR at the middle are
+ * evaluated exactly. X values outside 0-1 are
+ * clamped.
+ *
+ * @param opts Curve options.
+ * @param start_higher Start at higher point.
+ */
+void
+curve_get_normalized_y_block (
+  CurveOptions * opts,
+  int            start_higher,
+  double         x_start,
+  double         x_step,
+  float *        buf,
+  size_t         size)
+{
+  if (size == 0)
+    return;
+
+  /* pulse is discontinuous so it can't be
+   * interpolated, but it is cheap anyway */
+  if (opts->algo == CURVE_ALGORITHM_PULSE)
+    {
+      for (size_t i = 0; i < size; i++)
+        {
+          double x =
+            x_start + x_step * (double) i;
+          buf[i] =
+            (float)
+            curve_get_normalized_y (
+              CLAMP (x, 0.0, 1.0), opts,
+              start_higher);
+        }
+      return;
+    }
+
+  double y0 =
+    curve_get_normalized_y (
+      CLAMP (x_start, 0.0, 1.0), opts,
+      start_higher);
+  for (size_t i = 0; i < size;
+       i += CURVE_BLOCK_SEGMENT_SIZE)
+    {
+      size_t seg_size =
+        MIN (CURVE_BLOCK_SEGMENT_SIZE, size - i);
+      double x1 =
+        x_start + x_step * (double) (i + seg_size);
+      double y1 =
+        curve_get_normalized_y (
+          CLAMP (x1, 0.0, 1.0), opts,
+          start_higher);
+      float y_start = (float) y0;
+      float y_step =
+        (float) ((y1 - y0) / (double) seg_size);
+
+      /* evaluate steep parts (usually near the
+       * ends) exactly */
+      size_t mid = seg_size / 2;
+      double y_mid =
+        curve_get_normalized_y (
+          CLAMP (
+            x_start + x_step * (double) (i + mid),
+            0.0, 1.0),
+          opts, start_higher);
+      if (fabs (
+            y_mid -
+            (double) (y_start + y_step * (float) mid))
+          > CURVE_BLOCK_MAX_ERROR)
+        {
+          for (size_t j = 0; j < seg_size; j++)
+            {
+              double x =
+                x_start + x_step * (double) (i + j);
+              buf[i + j] =
+                (float)
+                curve_get_normalized_y (
+                  CLAMP (x, 0.0, 1.0), opts,
+                  start_higher);
+            }
+        }
+      else
+        {
+          for (size_t j = 0; j < seg_size; j++)
+            {
+              buf[i + j] =
+                y_start + y_step * (float) j;
+            }
+        }
+      y0 = y1;
+    }
+}
+
 bool
 curve_options_are_equal (
   const CurveOptions * a,
@@ -0,0 +1,780 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "audio/clip.h"
+#include "audio/disk_streamer.h"
+#include "audio/engine.h"
+#include "audio/region.h"
+#include "audio/transport.h"
+#include "gui/backend/arranger_object.h"
+#include "project.h"
+#include "utils/dsp.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+/** Size of a stereo frame in the ring. */
+#define FRAME_SIZE (2 * sizeof (float))
+
+/** Maximum number of channels in a file (see
+ * AudioClip.ch_frames). */
+#define MAX_CHANNELS 16
+
+/** Maximum time to wait for the I/O thread when
+ * exporting. */
+#define EXPORT_WAIT_TIMEOUT_USEC \
+  (10 * G_USEC_PER_SEC)
+
+/**
+ * Fills in the timing of the region (and the
+ * transport loop).
+ */
+static void
+get_region_info (
+  ZRegion *              region,
+  DiskStreamRegionInfo * info)
+{
+  ArrangerObject * r_obj =
+    (ArrangerObject *) region;
+  info->pos = r_obj->pos.frames;
+  info->end_pos = r_obj->end_pos.frames;
+  info->clip_start = r_obj->clip_start_pos.frames;
+  info->loop_start = r_obj->loop_start_pos.frames;
+  info->loop_end = r_obj->loop_end_pos.frames;
+  info->transport_loop = TRANSPORT->loop;
+  info->transport_loop_start =
+    info->transport_loop ?
+      TRANSPORT->loop_start_pos.frames : 0;
+  info->transport_loop_end =
+    info->transport_loop ?
+      TRANSPORT->loop_end_pos.frames : 0;
+}
+
+static bool
+region_info_equal (
+  const DiskStreamRegionInfo * a,
+  const DiskStreamRegionInfo * b)
+{
+  return
+    a->pos == b->pos
+    && a->end_pos == b->end_pos
+    && a->clip_start == b->clip_start
+    && a->loop_start == b->loop_start
+    && a->loop_end == b->loop_end
+    && a->transport_loop == b->transport_loop
+    && a->transport_loop_start
+         == b->transport_loop_start
+    && a->transport_loop_end
+         == b->transport_loop_end;
+}
+
+/**
+ * Returns the global frame following @p frame in
+ * playback order for a region, taking region and
+ * transport loops into account, or -1 if the
+ * region will not be played anymore.
+ */
+signed_frame_t
+disk_streamer_get_next_frame (
+  const DiskStreamRegionInfo * info,
+  signed_frame_t               frame)
+{
+  signed_frame_t g = frame + 1;
+
+  /* at most one wrap around the transport loop
+   * is needed */
+  for (int i = 0; i < 2; i++)
+    {
+      if (info->transport_loop
+          && g == info->transport_loop_end)
+        {
+          g = info->transport_loop_start;
+        }
+
+      if (g < info->pos)
+        {
+          /* region not reachable inside the
+           * transport loop */
+          if (info->transport_loop
+              && g < info->transport_loop_end
+              && info->pos
+                   >= info->transport_loop_end)
+            return -1;
+
+          g = info->pos;
+        }
+
+      if (g < info->end_pos)
+        return g;
+
+      /* past the region end - continue from the
+       * transport loop start if the loop will be
+       * hit */
+      if (!info->transport_loop
+          || g >= info->transport_loop_end)
+        return -1;
+
+      g = info->transport_loop_end;
+    }
+
+  return -1;
+}
+
+/**
+ * Returns the region-local frame in the clip for
+ * global frame @p g.
+ */
+static signed_frame_t
+get_clip_frame (
+  const DiskStreamRegionInfo * info,
+  signed_frame_t               g)
+{
+  signed_frame_t local =
+    (g - info->pos) + info->clip_start;
+  signed_frame_t loop_len =
+    info->loop_end - info->loop_start;
+  if (loop_len > 0 && local >= info->loop_end)
+    {
+      local =
+        info->loop_start
+        + (local - info->loop_start) % loop_len;
+    }
+  return local;
+}
+
+static void
+close_file (
+  DiskStreamSlot * slot)
+{
+  if (slot->io_file)
+    {
+      sf_close (slot->io_file);
+      slot->io_file = NULL;
+    }
+  slot->io_clip = NULL;
+  slot->io_next_frame = -1;
+}
+
+/**
+ * Opens the clip's file for the slot.
+ *
+ * Must be called with the clip lock held.
+ */
+static bool
+open_file (
+  DiskStreamSlot * slot,
+  AudioClip *      clip)
+{
+  close_file (slot);
+
+  const char * path =
+    g_atomic_pointer_get (&clip->stream_path);
+  if (!path)
+    return false;
+
+  SF_INFO sfinfo;
+  memset (&sfinfo, 0, sizeof (sfinfo));
+  slot->io_file = sf_open (path, SFM_READ, &sfinfo);
+  if (!slot->io_file)
+    {
+      g_warning (
+        "failed to open %s for streaming: %s",
+        path, sf_strerror (NULL));
+      return false;
+    }
+  if (sfinfo.channels > MAX_CHANNELS)
+    {
+      g_warning (
+        "too many channels in %s", path);
+      close_file (slot);
+      return false;
+    }
+  slot->io_clip = clip;
+  slot->io_channels = (unsigned int) sfinfo.channels;
+  slot->io_file_pos = 0;
+
+  return true;
+}
+
+/**
+ * Writes frames to the ring until it is full or
+ * the region will not be played anymore.
+ *
+ * @param frames Scratch buffer for @ref
+ *   DISK_STREAMER_READ_FRAMES frames of the file.
+ * @param stereo Scratch buffer for @ref
+ *   DISK_STREAMER_READ_FRAMES stereo frames.
+ */
+static void
+fill_slot (
+  DiskStreamSlot * slot,
+  float *          frames,
+  float *          stereo)
+{
+  const DiskStreamRegionInfo * info =
+    &slot->io_info;
+  AudioClip * clip = slot->io_clip;
+  while (slot->io_next_frame >= 0 && clip)
+    {
+      /* stop if a new request came in */
+      if (g_atomic_int_get (&slot->req_gen)
+            != slot->io_gen)
+        return;
+
+      size_t write_space =
+        zix_ring_write_space (slot->ring)
+        / FRAME_SIZE;
+      if (write_space == 0)
+        return;
+
+      /* find the number of contiguous frames in
+       * the file */
+      signed_frame_t g = slot->io_next_frame;
+      signed_frame_t clip_frame =
+        get_clip_frame (info, g);
+      signed_frame_t nframes =
+        MIN (
+          (signed_frame_t) write_space,
+          DISK_STREAMER_READ_FRAMES);
+      nframes = MIN (nframes, info->end_pos - g);
+      if (info->loop_end > clip_frame)
+        {
+          nframes =
+            MIN (nframes, info->loop_end - clip_frame);
+        }
+      if (info->transport_loop
+          && info->transport_loop_end > g)
+        {
+          nframes =
+            MIN (
+              nframes,
+              info->transport_loop_end - g);
+        }
+      g_return_if_fail (nframes > 0);
+
+      /* read from the file, padding with silence
+       * past its end */
+      sf_count_t nread = 0;
+      if (clip_frame >= 0
+          && (unsigned_frame_t) clip_frame
+               < clip->num_frames)
+        {
+          if (slot->io_file_pos != clip_frame)
+            {
+              slot->io_file_pos =
+                sf_seek (
+                  slot->io_file, clip_frame,
+                  SEEK_SET);
+            }
+          if (slot->io_file_pos == clip_frame)
+            {
+              nread =
+                sf_readf_float (
+                  slot->io_file, frames, nframes);
+              slot->io_file_pos += nread;
+            }
+        }
+
+      unsigned int channels = slot->io_channels;
+      for (sf_count_t i = 0; i < nread; i++)
+        {
+          stereo[i * 2] = frames[i * channels];
+          stereo[i * 2 + 1] =
+            frames[
+              i * channels
+              + (channels > 1 ? 1 : 0)];
+        }
+      if (nread < nframes)
+        {
+          dsp_fill (
+            &stereo[nread * 2], 0.f,
+            (size_t) (nframes - nread) * 2);
+        }
+
+      zix_ring_write (
+        slot->ring, stereo,
+        (uint32_t) ((size_t) nframes * FRAME_SIZE));
+      slot->io_next_frame =
+        disk_streamer_get_next_frame (
+          info, g + nframes - 1);
+    }
+}
+
+/**
+ * Takes the request of the slot if there is a new
+ * one.
+ *
+ * Must be called with the clip lock held.
+ */
+static void
+handle_request (
+  DiskStreamSlot * slot)
+{
+  gint gen = g_atomic_int_get (&slot->req_gen);
+  if (gen == slot->io_gen || gen % 2 != 0)
+    return;
+
+  /* copy the request */
+  ZRegion * region =
+    g_atomic_pointer_get (&slot->region);
+  AudioClip * clip = slot->clip;
+  DiskStreamRegionInfo info = slot->info;
+  signed_frame_t start_frame = slot->start_frame;
+  if (g_atomic_int_get (&slot->req_gen) != gen)
+    return;
+
+  slot->io_gen = gen;
+  if (!region)
+    {
+      close_file (slot);
+    }
+  else
+    {
+      zix_ring_reset (slot->ring);
+      if (clip != slot->io_clip)
+        {
+          open_file (slot, clip);
+        }
+      slot->io_info = info;
+      slot->io_next_frame =
+        slot->io_clip ? start_frame : -1;
+    }
+
+  g_atomic_int_set (&slot->ready_gen, gen);
+}
+
+static gpointer
+io_thread_func (
+  gpointer data)
+{
+  DiskStreamer * self = (DiskStreamer *) data;
+
+  float * frames =
+    object_new_n (
+      DISK_STREAMER_READ_FRAMES * MAX_CHANNELS,
+      float);
+  float * stereo =
+    object_new_n (
+      DISK_STREAMER_READ_FRAMES * 2, float);
+
+  while (g_atomic_int_get (&self->run))
+    {
+      zix_sem_wait (&self->io_sem);
+
+      g_mutex_lock (&self->clip_lock);
+      for (int i = 0; i < DISK_STREAMER_NUM_SLOTS;
+           i++)
+        {
+          DiskStreamSlot * slot = &self->slots[i];
+          handle_request (slot);
+          if (slot->io_clip)
+            {
+              fill_slot (slot, frames, stereo);
+            }
+        }
+      g_cond_broadcast (&self->filled_cond);
+      g_mutex_unlock (&self->clip_lock);
+    }
+
+  for (int i = 0; i < DISK_STREAMER_NUM_SLOTS; i++)
+    {
+      close_file (&self->slots[i]);
+    }
+  free (frames);
+  free (stereo);
+
+  return NULL;
+}
+
+/**
+ * Creates a new streamer and starts its I/O
+ * thread.
+ */
+DiskStreamer *
+disk_streamer_new (void)
+{
+  DiskStreamer * self = object_new (DiskStreamer);
+
+  for (int i = 0; i < DISK_STREAMER_NUM_SLOTS; i++)
+    {
+      DiskStreamSlot * slot = &self->slots[i];
+      slot->ring =
+        zix_ring_new (
+          (uint32_t)
+          (DISK_STREAMER_BUFFER_FRAMES * FRAME_SIZE));
+      zix_ring_mlock (slot->ring);
+      slot->io_next_frame = -1;
+    }
+
+  zix_sem_init (&self->io_sem, 0);
+  g_mutex_init (&self->clip_lock);
+  g_cond_init (&self->filled_cond);
+  self->run = 1;
+  self->thread =
+    g_thread_new (
+      "disk_streamer", io_thread_func, self);
+
+  return self;
+}
+
+/**
+ * Publishes a new request for the slot.
+ */
+static void
+request (
+  DiskStreamer *               self,
+  DiskStreamSlot *             slot,
+  AudioClip *                  clip,
+  const DiskStreamRegionInfo * info,
+  signed_frame_t               start_frame)
+{
+  g_atomic_int_inc (&slot->req_gen);
+  slot->clip = clip;
+  slot->info = *info;
+  slot->start_frame = start_frame;
+  g_atomic_int_inc (&slot->req_gen);
+
+  slot->rt_next_frame = start_frame;
+  slot->rt_skip_frames = 0;
+  slot->rt_primed = false;
+
+  zix_sem_post (&self->io_sem);
+}
+
+/**
+ * To be called by the engine at the start of each
+ * cycle, before any audio is read.
+ *
+ * Frees the slots of regions that were not played
+ * in the previous cycle.
+ */
+void
+disk_streamer_begin_cycle (
+  DiskStreamer * self)
+{
+  self->cycle++;
+
+  bool post = false;
+  for (int i = 0; i < DISK_STREAMER_NUM_SLOTS; i++)
+    {
+      DiskStreamSlot * slot = &self->slots[i];
+      if (!slot->region)
+        continue;
+
+      if (slot->rt_last_cycle < self->cycle - 1)
+        {
+          g_atomic_int_inc (&slot->req_gen);
+          g_atomic_pointer_set (
+            &slot->region, NULL);
+          g_atomic_int_inc (&slot->req_gen);
+          post = true;
+        }
+      else if (slot->rt_primed)
+        {
+          /* keep the I/O thread filling */
+          post = true;
+        }
+    }
+
+  if (post)
+    zix_sem_post (&self->io_sem);
+}
+
+static DiskStreamSlot *
+get_slot (
+  DiskStreamer * self,
+  ZRegion *      region)
+{
+  for (int i = 0; i < DISK_STREAMER_NUM_SLOTS; i++)
+    {
+      if (g_atomic_pointer_get (
+            &self->slots[i].region) == region)
+        return &self->slots[i];
+    }
+
+  /* claim a free slot (tracks may be processed
+   * in parallel) */
+  for (int i = 0; i < DISK_STREAMER_NUM_SLOTS; i++)
+    {
+      DiskStreamSlot * slot = &self->slots[i];
+      if (g_atomic_int_get (&slot->ready_gen)
+            != g_atomic_int_get (&slot->req_gen))
+        continue;
+
+      if (g_atomic_pointer_compare_and_exchange (
+            &slot->region, NULL, region))
+        {
+          slot->clip = NULL;
+          slot->rt_next_frame = -1;
+          return slot;
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * Blocks until the ring of the slot has @p len
+ * frames after the frames to skip.
+ *
+ * Only used when exporting, where the engine is
+ * run faster than realtime from a non-realtime
+ * thread.
+ *
+ * @return Whether the frames are available.
+ */
+static bool
+wait_for_frames (
+  DiskStreamer *   self,
+  DiskStreamSlot * slot,
+  size_t           len)
+{
+  gint64 end_time =
+    g_get_monotonic_time ()
+    + EXPORT_WAIT_TIMEOUT_USEC;
+  bool available = false;
+
+  g_mutex_lock (&self->clip_lock);
+  while (true)
+    {
+      bool ready =
+        g_atomic_int_get (&slot->ready_gen)
+        == g_atomic_int_get (&slot->req_gen);
+      if (ready
+          && zix_ring_read_space (slot->ring)
+                 / FRAME_SIZE
+               >= slot->rt_skip_frames + len)
+        {
+          available = true;
+          break;
+        }
+
+      /* nothing more will be read (eg, the file
+       * could not be opened) */
+      if (ready
+          && (!slot->io_clip
+              || slot->io_next_frame < 0))
+        break;
+
+      zix_sem_post (&self->io_sem);
+      if (!g_cond_wait_until (
+             &self->filled_cond, &self->clip_lock,
+             end_time))
+        break;
+    }
+  g_mutex_unlock (&self->clip_lock);
+
+  return available;
+}
+
+/**
+ * Reads @p nframes frames of the streamed clip of
+ * @p region starting at global frame @p
+ * g_start_frame.
+ *
+ * Frames outside the region are set to 0. If the
+ * data is not ready yet (eg, right after a
+ * transport jump), silence is returned, unless
+ * exporting, in which case this blocks until the
+ * data is read.
+ *
+ * @return Whether data was read.
+ */
+bool
+disk_streamer_read (
+  DiskStreamer *  self,
+  ZRegion *       region,
+  AudioClip *     clip,
+  unsigned_frame_t g_start_frame,
+  nframes_t       nframes,
+  float *         lbuf,
+  float *         rbuf)
+{
+  dsp_fill (lbuf, 0.f, nframes);
+  dsp_fill (rbuf, 0.f, nframes);
+
+  DiskStreamRegionInfo info;
+  get_region_info (region, &info);
+
+  /* only read the part inside the region */
+  signed_frame_t g_start =
+    MAX ((signed_frame_t) g_start_frame, info.pos);
+  signed_frame_t g_end =
+    MIN (
+      (signed_frame_t) g_start_frame
+        + (signed_frame_t) nframes,
+      info.end_pos);
+  if (g_start >= g_end)
+    return false;
+  size_t offset =
+    (size_t) (g_start - (signed_frame_t) g_start_frame);
+  size_t len = (size_t) (g_end - g_start);
+
+  DiskStreamSlot * slot = get_slot (self, region);
+  if (!slot)
+    {
+      g_atomic_int_inc (&self->num_underruns);
+      return false;
+    }
+  slot->rt_last_cycle = self->cycle;
+
+  signed_frame_t next_frame =
+    disk_streamer_get_next_frame (
+      &info, g_end - 1);
+
+  /* exports and bounces run faster than realtime,
+   * so wait for the I/O thread instead of playing
+   * silence */
+  bool blocking = AUDIO_ENGINE->exporting;
+
+  /* refill on jumps and on edits */
+  if (slot->clip != clip
+      || slot->rt_next_frame != g_start
+      || !region_info_equal (&slot->info, &info))
+    {
+      if (!blocking)
+        {
+          request (
+            self, slot, clip, &info, next_frame);
+          return false;
+        }
+
+      /* read from the current frame */
+      request (self, slot, clip, &info, g_start);
+    }
+
+  if (blocking
+      && !wait_for_frames (self, slot, len))
+    {
+      g_atomic_int_inc (&slot->num_underruns);
+      g_atomic_int_inc (&self->num_underruns);
+      request (self, slot, clip, &info, next_frame);
+      return false;
+    }
+
+  bool ready =
+    g_atomic_int_get (&slot->ready_gen)
+    == g_atomic_int_get (&slot->req_gen);
+  size_t avail =
+    ready ?
+      zix_ring_read_space (slot->ring) / FRAME_SIZE
+      : 0;
+  if (avail < slot->rt_skip_frames + len)
+    {
+      if (slot->rt_primed
+          ||
+          slot->rt_skip_frames + len
+            > DISK_STREAMER_BUFFER_FRAMES / 2)
+        {
+          /* the I/O thread could not keep up */
+          g_atomic_int_inc (&slot->num_underruns);
+          g_atomic_int_inc (&self->num_underruns);
+          request (
+            self, slot, clip, &info, next_frame);
+        }
+      else
+        {
+          /* still filling after a request - play
+           * silence and catch up later */
+          slot->rt_skip_frames += len;
+          slot->rt_next_frame = next_frame;
+        }
+      return false;
+    }
+
+  if (slot->rt_skip_frames > 0)
+    {
+      zix_ring_skip (
+        slot->ring,
+        (uint32_t)
+        (slot->rt_skip_frames * FRAME_SIZE));
+      slot->rt_skip_frames = 0;
+    }
+
+  float stereo[len * 2];
+  zix_ring_read (
+    slot->ring, stereo,
+    (uint32_t) (len * FRAME_SIZE));
+  for (size_t i = 0; i < len; i++)
+    {
+      lbuf[offset + i] = stereo[i * 2];
+      rbuf[offset + i] = stereo[i * 2 + 1];
+    }
+  slot->rt_next_frame = next_frame;
+  slot->rt_primed = true;
+
+  return true;
+}
+
+/**
+ * Stops using the given clip.
+ *
+ * Must be called before the clip's file becomes
+ * invalid.
+ */
+void
+disk_streamer_forget_clip (
+  DiskStreamer * self,
+  AudioClip *    clip)
+{
+  g_mutex_lock (&self->clip_lock);
+  for (int i = 0; i < DISK_STREAMER_NUM_SLOTS; i++)
+    {
+      DiskStreamSlot * slot = &self->slots[i];
+      if (slot->io_clip == clip)
+        {
+          close_file (slot);
+        }
+    }
+  g_mutex_unlock (&self->clip_lock);
+}
+
+/**
+ * Returns the total number of underruns.
+ */
+int
+disk_streamer_get_num_underruns (
+  DiskStreamer * self)
+{
+  return g_atomic_int_get (&self->num_underruns);
+}
+
+/**
+ * Stops the I/O thread and frees the streamer.
+ */
+void
+disk_streamer_free (
+  DiskStreamer * self)
+{
+  g_atomic_int_set (&self->run, 0);
+  zix_sem_post (&self->io_sem);
+  g_thread_join (self->thread);
+
+  for (int i = 0; i < DISK_STREAMER_NUM_SLOTS; i++)
+    {
+      zix_ring_free (self->slots[i].ring);
+    }
+  zix_sem_destroy (&self->io_sem);
+  g_mutex_clear (&self->clip_lock);
+  g_cond_clear (&self->filled_cond);
+
+  object_zero_and_free (self);
+}
@@ -49,6 +49,7 @@
 #include "audio/automation_tracklist.h"
 #include "audio/channel.h"
 #include "audio/control_port.h"
+#include "audio/disk_streamer.h"
 #include "audio/engine.h"
 #include "audio/engine_alsa.h"
 #include "audio/engine_dummy.h"
@@ -70,6 +71,7 @@
 #include "audio/router.h"
 #include "audio/sample_playback.h"
 #include "audio/sample_processor.h"
+#include "audio/tempo_map.h"
 #include "audio/tempo_track.h"
 #include "audio/transport.h"
 #include "gui/backend/event.h"
@@ -139,10 +141,80 @@ engine_set_buffer_size (
 #endif
 }
 
+/**
+ * Updates the positions of region children that
+ * were not accessed since the last tempo change,
+ * a few tracks at a time.
+ */
+static int
+refresh_positions_source_func (
+  gpointer data)
+{
+  AudioEngine * self = (AudioEngine *) data;
+
+  gint64 start_time = g_get_monotonic_time ();
+  for (int i =
+         g_atomic_int_get (
+           &self->refresh_positions_track_idx);
+       i < TRACKLIST->num_tracks; i++)
+    {
+      track_refresh_children_positions (
+        TRACKLIST->tracks[i]);
+      g_atomic_int_set (
+        &self->refresh_positions_track_idx, i + 1);
+
+      /* continue in the next iteration so that the
+       * UI stays responsive */
+      if (g_get_monotonic_time () - start_time
+            > 4000)
+        return G_SOURCE_CONTINUE;
+    }
+
+  self->refresh_positions_source_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * Updates the positions of everything after a
+ * tempo change.
+ *
+ * Region children are updated when they are
+ * first accessed, or eventually in the GTK thread.
+ */
+static void
+update_positions (
+  AudioEngine * self,
+  bool          update_from_ticks)
+{
+  transport_update_positions (
+    self->transport, update_from_ticks);
+
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      track_update_positions (
+        TRACKLIST->tracks[i], update_from_ticks);
+    }
+
+  g_atomic_int_set (
+    &self->refresh_positions_track_idx, 0);
+  if (update_from_ticks
+      && self->refresh_positions_source_id == 0)
+    {
+      self->refresh_positions_source_id =
+        g_idle_add (
+          refresh_positions_source_func, self);
+    }
+}
+
 /**
  * Updates frames per tick based on the time sig,
  * the BPM, and the sample rate
  *
+ * When called from another thread while the
+ * engine is running (eg, the processing kickoff
+ * thread), the tempo map is rebuilt later in the
+ * GTK thread.
+ *
  * @param thread_check Whether to throw a warning
  *   if not called from GTK thread.
  * @param update_from_ticks Whether to update the
@@ -174,6 +246,42 @@ engine_update_frames_per_tick (
       return;
     }
 
+  /* this is called from the processing kickoff
+   * thread when the BPM port changes, so only
+   * update the current values and leave
+   * rebuilding the tempo map (and updating the
+   * positions) to the GTK thread */
+  if (g_thread_self () != zrythm_app->gtk_thread
+      && engine_get_run (self))
+    {
+      g_return_if_fail (
+        beats_per_bar > 0 && bpm > 0 &&
+        sample_rate > 0 &&
+        self->transport->ticks_per_bar > 0);
+
+      self->frames_per_tick =
+        (((double) sample_rate * 60.0 *
+           (double) beats_per_bar) /
+        ((double) bpm *
+           (double) self->transport->ticks_per_bar));
+      self->ticks_per_frame =
+        1.0 / self->frames_per_tick;
+
+      if (tempo_map_needs_rebuild (
+            self->tempo_map, bpm, beats_per_bar,
+            self->transport->ticks_per_bar,
+            sample_rate)
+          &&
+          g_atomic_int_compare_and_exchange (
+            &self->tempo_change_queued, 0, 1))
+        {
+          ENGINE_EVENTS_PUSH (
+            AUDIO_ENGINE_EVENT_TEMPO_CHANGE, NULL,
+            (uint32_t) update_from_ticks, 0.f);
+        }
+      return;
+    }
+
   /* process all recording events */
   recording_manager_process_events (
     RECORDING_MANAGER);
@@ -203,15 +311,40 @@ engine_update_frames_per_tick (
     self->frames_per_tick,
     self->ticks_per_frame);
 
-  /* update positions */
-  transport_update_positions (
-    self->transport, update_from_ticks);
+  bool map_changed =
+    tempo_map_rebuild (
+      self->tempo_map, P_TEMPO_TRACK, bpm,
+      beats_per_bar,
+      self->transport->ticks_per_bar,
+      sample_rate);
+
+  /* positions only depend on the tempo
+   * automation, so changes to the current BPM
+   * caused by it do not affect them */
+  if (!map_changed
+      && tempo_map_is_automated (self->tempo_map))
+    return;
+
+  update_positions (self, update_from_ticks);
+}
 
-  for (int i = 0; i < TRACKLIST->num_tracks; i++)
-    {
-      track_update_positions (
-        TRACKLIST->tracks[i], update_from_ticks);
-    }
+/**
+ * Rebuilds the tempo map after the tempo
+ * automation was edited and updates all positions
+ * if it changed.
+ */
+void
+engine_update_tempo_map (
+  AudioEngine * self)
+{
+  if (!P_TEMPO_TRACK
+      || !tempo_map_refresh (
+            self->tempo_map, P_TEMPO_TRACK))
+    return;
+
+  g_message ("tempo map changed");
+
+  update_positions (self, true);
 }
 
 /**
@@ -271,6 +404,9 @@ engine_process_events (
     g_thread_self () == zrythm_app->gtk_thread,
     G_SOURCE_REMOVE);
 
+  /* MIDI buffers may also grow while exporting */
+  midi_events_prepare_spares ();
+
   if (self->exporting)
     {
       return G_SOURCE_CONTINUE;
@@ -338,6 +474,18 @@ engine_process_events (
            EVENTS_PUSH (
              ET_ENGINE_SAMPLE_RATE_CHANGED, NULL);
           break;
+        case AUDIO_ENGINE_EVENT_TEMPO_CHANGE:
+          g_atomic_int_set (
+            &self->tempo_change_queued, 0);
+          engine_update_frames_per_tick (
+            self,
+            tempo_track_get_beats_per_bar (
+              P_TEMPO_TRACK),
+            tempo_track_get_current_bpm (
+              P_TEMPO_TRACK),
+            self->sample_rate, true,
+            ev->uint_arg);
+          break;
         default:
           g_warning (
             "event %d not implemented yet",
@@ -736,6 +884,8 @@ init_common (
     AUDIO_ENGINE_SCHEMA_VERSION;
   self->metronome = metronome_new ();
   self->router = router_new ();
+  self->disk_streamer = disk_streamer_new ();
+  self->tempo_map = tempo_map_new ();
 
   /* get audio backend */
   AudioBackend ab_code = AUDIO_BACKEND_DUMMY;
@@ -941,8 +1091,6 @@ engine_init_loaded (
 
   self->project = project;
 
-  audio_pool_init_loaded (self->pool);
-
   Track * tempo_track = NULL;
   if (project)
     {
@@ -1379,7 +1527,11 @@ engine_realloc_port_buffers (
           else
             pl = ch->inserts[j - (STRIP_SIZE + 1)];
 
-          if (pl && !pl->instantiation_failed)
+          /* plugins still being instantiated in
+           * the background are handled by the
+           * plugin loader */
+          if (pl && !pl->instantiation_failed
+              && !pl->instantiation_pending)
             {
               if (pl->setting->open_with_carla)
                 {
@@ -1565,6 +1717,12 @@ engine_process_prepare (
   sample_processor_prepare_process (
     self->sample_processor, nframes);
 
+  if (self->disk_streamer)
+    {
+      disk_streamer_begin_cycle (
+        self->disk_streamer);
+    }
+
   /* prepare channels for this cycle */
   Channel * ch;
   for (int i = 0; i < TRACKLIST->num_tracks; i++)
@@ -2260,6 +2418,16 @@ engine_free (
     sample_processor_free, self->sample_processor);
   object_free_w_func_and_null (
     metronome_free, self->metronome);
+  object_free_w_func_and_null (
+    disk_streamer_free, self->disk_streamer);
+  if (self->refresh_positions_source_id != 0)
+    {
+      g_source_remove (
+        self->refresh_positions_source_id);
+      self->refresh_positions_source_id = 0;
+    }
+  object_free_w_func_and_null (
+    tempo_map_free, self->tempo_map);
   object_free_w_func_and_null (
     audio_pool_free, self->pool);
   object_free_w_func_and_null (
@@ -258,9 +258,6 @@ on_midi_event (
 
       g_return_val_if_fail (port, -1);
 
-      zix_sem_wait (
-        &port->midi_events->access_sem);
-
       switch (ev->type)
         {
         /* see https://www.alsa-project.org/alsa-doc/alsa-lib/group___seq_events.html for more */
@@ -310,9 +307,6 @@ on_midi_event (
           break;
       }
 
-      zix_sem_post (
-        &port->midi_events->access_sem);
-
       snd_seq_free_event(ev);
     } while (
         snd_seq_event_input_pending (
@@ -36,3 +36,23 @@ fade_get_y_normalized (
     curve_get_normalized_y (
       x, opts, !fade_in);
 }
+
+/**
+ * Fills @p buf with the normalized Y values for
+ * @p size consecutive normalized X values
+ * starting at @p x_start.
+ *
+ * @param fade_in 1 for in, 0 for out.
+ */
+void
+fade_get_y_normalized_block (
+  CurveOptions * opts,
+  int            fade_in,
+  double         x_start,
+  double         x_step,
+  float *        buf,
+  size_t         size)
+{
+  curve_get_normalized_y_block (
+    opts, !fade_in, x_start, x_step, buf, size);
+}
@@ -1203,14 +1203,13 @@ fader_process (
             pan, &calc_l, &calc_r);
 
           /* apply fader and pan */
-          dsp_mul_k2 (
+          dsp_mul_k2_stereo (
             &self->stereo_out->l->buf[
               time_nfo->local_offset],
-            amp * calc_l, time_nfo->nframes);
-          dsp_mul_k2 (
             &self->stereo_out->r->buf[
               time_nfo->local_offset],
-            amp * calc_r, time_nfo->nframes);
+            amp * calc_l, amp * calc_r,
+            time_nfo->nframes);
 
           /* make mono if mono compat
            * enabled. equal amplitude is
@@ -641,6 +641,34 @@ graph_update_latencies (
         }
     }
 
+  /* remember the distinct route latencies */
+  self->num_route_latencies = 0;
+  g_hash_table_iter_init (&iter, ht);
+  while (g_hash_table_iter_next (
+           &iter, &key, &value))
+    {
+      GraphNode * n = (GraphNode *) value;
+      bool found = false;
+      for (int i = 0;
+           i < self->num_route_latencies; i++)
+        {
+          if (self->route_latencies[i] ==
+                n->route_playback_latency)
+            {
+              found = true;
+              break;
+            }
+        }
+      if (!found
+          && self->num_route_latencies <
+               GRAPH_MAX_ROUTE_LATENCIES)
+        {
+          self->route_latencies[
+            self->num_route_latencies++] =
+              n->route_playback_latency;
+        }
+    }
+
   g_message (
     "Total latencies:\n"
     "Playback: %d\n"
@@ -650,6 +678,353 @@ graph_update_latencies (
     0);
 }
 
+/**
+ * Alignment of the pooled port buffers in bytes.
+ */
+#define POOL_BUF_ALIGNMENT 64
+
+/**
+ * Max memory used for the ancestor bitsets when
+ * assigning pooled buffers. Ports in larger graphs
+ * keep their own buffers.
+ */
+#define MAX_ANCESTOR_BITSETS_SIZE \
+  ((size_t) 64 * 1024 * 1024)
+
+/**
+ * A port candidate for a pooled buffer.
+ */
+typedef struct PooledPort
+{
+  Port *      port;
+
+  /** Node that writes the buffer (the port node
+   * for inputs and the plugin for outputs). */
+  GraphNode * writer;
+
+  /** Position of @ref writer in the topological
+   * order. */
+  int         writer_pos;
+
+  /** Index of the assigned buffer. */
+  int         buf_idx;
+} PooledPort;
+
+static int
+cmp_pooled_ports (
+  const void * a,
+  const void * b)
+{
+  const PooledPort * pa = a;
+  const PooledPort * pb = b;
+  return pa->writer_pos - pb->writer_pos;
+}
+
+static inline int
+get_node_idx (
+  GHashTable * indices,
+  GraphNode *  node)
+{
+  return
+    GPOINTER_TO_INT (
+      g_hash_table_lookup (indices, node)) - 1;
+}
+
+/**
+ * Returns whether @p node is a (strict) ancestor
+ * of @p descendant.
+ */
+static inline bool
+is_ancestor (
+  GHashTable *     indices,
+  const uint64_t * ancestors,
+  size_t           num_words,
+  GraphNode *      node,
+  GraphNode *      descendant)
+{
+  int idx = get_node_idx (indices, node);
+  int descendant_idx =
+    get_node_idx (indices, descendant);
+  g_return_val_if_fail (
+    idx >= 0 && descendant_idx >= 0, false);
+  const uint64_t * bits =
+    &ancestors[(size_t) descendant_idx * num_words];
+  return (bits[idx / 64] >> (idx % 64)) & 1;
+}
+
+/**
+ * Returns whether all the nodes that access the
+ * buffer of @p pp (its port node, its plugin and
+ * the nodes of its destinations) are ancestors of
+ * the writer of @p next, meaning that the buffer
+ * can be reused by @p next.
+ */
+static bool
+buf_is_dead_before (
+  Graph *            self,
+  GHashTable *       indices,
+  const uint64_t *   ancestors,
+  size_t             num_words,
+  const PooledPort * pp,
+  const PooledPort * next)
+{
+  GraphNode * nodes[] = {
+    graph_find_node_from_port (self, pp->port),
+    graph_find_node_from_plugin (
+      self, pp->port->plugin),
+  };
+  for (size_t i = 0; i < G_N_ELEMENTS (nodes); i++)
+    {
+      if (!is_ancestor (
+             indices, ancestors, num_words,
+             nodes[i], next->writer))
+        return false;
+    }
+
+  for (int i = 0; i < pp->port->num_dests; i++)
+    {
+      GraphNode * dest_node =
+        graph_find_node_from_port (
+          self, pp->port->dests[i]);
+      if (dest_node
+          &&
+          !is_ancestor (
+             indices, ancestors, num_words,
+             dest_node, next->writer))
+        return false;
+    }
+
+  return true;
+}
+
+/**
+ * Assigns the audio ports of plugins in the setup
+ * graph to a pool of shared buffers based on their
+ * lifetimes.
+ *
+ * Since nodes run in parallel, a buffer is only
+ * reused if all the nodes accessing it for the
+ * previous port are ancestors of the node writing
+ * the next port. Ports read outside the graph
+ * (engine, hardware, track and channel ports) and
+ * CV ports (read by the UI) keep their own
+ * buffers.
+ *
+ * Must be called after the ports are added (which
+ * gives each port its own buffer) and while the
+ * graph is not being processed.
+ */
+static void
+assign_pooled_bufs (
+  Graph * self)
+{
+  /* ports still using the previous pool were
+   * given their own buffers in add_port() */
+  object_free_w_func_and_null (
+    aligned_free, self->port_buf_pool);
+  self->num_pooled_bufs = 0;
+  self->num_pooled_ports = 0;
+
+  int num_nodes =
+    (int)
+    g_hash_table_size (self->setup_graph_nodes);
+  size_t num_words =
+    ((size_t) num_nodes + 63) / 64;
+  if (!self->use_buf_pool || num_nodes == 0
+      ||
+      (size_t) num_nodes * num_words
+        * sizeof (uint64_t)
+      > MAX_ANCESTOR_BITSETS_SIZE)
+    {
+      return;
+    }
+
+  /* index the nodes */
+  GraphNode ** nodes =
+    object_new_n ((size_t) num_nodes, GraphNode *);
+  GHashTable * indices =
+    g_hash_table_new (
+      g_direct_hash, g_direct_equal);
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init (
+    &iter, self->setup_graph_nodes);
+  int num_indexed = 0;
+  while (g_hash_table_iter_next (
+           &iter, &key, &value))
+    {
+      nodes[num_indexed] = (GraphNode *) value;
+      g_hash_table_insert (
+        indices, value,
+        GINT_TO_POINTER (++num_indexed));
+    }
+
+  /* sort them topologically and collect the
+   * ancestors of each node */
+  int * refcounts =
+    object_new_n ((size_t) num_nodes, int);
+  int * topo_pos =
+    object_new_n ((size_t) num_nodes, int);
+  GraphNode ** order =
+    object_new_n ((size_t) num_nodes, GraphNode *);
+  uint64_t * ancestors =
+    object_new_n (
+      (size_t) num_nodes * num_words, uint64_t);
+  int num_ordered = 0;
+  for (int i = 0; i < num_nodes; i++)
+    {
+      refcounts[i] = nodes[i]->init_refcount;
+      if (refcounts[i] == 0)
+        order[num_ordered++] = nodes[i];
+    }
+  for (int i = 0; i < num_ordered; i++)
+    {
+      GraphNode * node = order[i];
+      int idx = get_node_idx (indices, node);
+      topo_pos[idx] = i;
+      const uint64_t * bits =
+        &ancestors[(size_t) idx * num_words];
+      for (int j = 0; j < node->n_childnodes; j++)
+        {
+          GraphNode * child = node->childnodes[j];
+          int child_idx =
+            get_node_idx (indices, child);
+          uint64_t * child_bits =
+            &ancestors[
+              (size_t) child_idx * num_words];
+          for (size_t k = 0; k < num_words; k++)
+            {
+              child_bits[k] |= bits[k];
+            }
+          child_bits[idx / 64] |=
+            (uint64_t) 1 << (idx % 64);
+
+          if (--refcounts[child_idx] == 0)
+            order[num_ordered++] = child;
+        }
+    }
+  g_warn_if_fail (num_ordered == num_nodes);
+
+  /* collect the candidate ports in order of their
+   * writers */
+  GArray * pooled_ports =
+    g_array_new (false, false, sizeof (PooledPort));
+  size_t buf_size =
+    MAX (AUDIO_ENGINE->block_length, 1);
+  for (int i = 0; i < num_nodes; i++)
+    {
+      GraphNode * node = nodes[i];
+      if (node->type != ROUTE_NODE_TYPE_PORT)
+        continue;
+
+      Port * port = node->port;
+      if (port->id.type != TYPE_AUDIO
+          ||
+          port->id.owner_type
+            != PORT_OWNER_TYPE_PLUGIN
+          || !port->plugin)
+        continue;
+
+      GraphNode * pl_node =
+        graph_find_node_from_plugin (
+          self, port->plugin);
+      if (!pl_node)
+        continue;
+
+      PooledPort pp = {
+        .port = port,
+        .writer =
+          port->id.flow == FLOW_INPUT
+          ? node : pl_node,
+        .buf_idx = -1,
+      };
+      pp.writer_pos =
+        topo_pos[get_node_idx (indices, pp.writer)];
+      g_array_append_val (pooled_ports, pp);
+      buf_size = MAX (buf_size, port->min_buf_size);
+    }
+  g_array_sort (pooled_ports, cmp_pooled_ports);
+
+  /* assign each port to the first buffer whose
+   * last port is dead before the port is
+   * written */
+  PooledPort ** last_ports =
+    object_new_n (
+      MAX (pooled_ports->len, 1), PooledPort *);
+  int num_bufs = 0;
+  for (guint i = 0; i < pooled_ports->len; i++)
+    {
+      PooledPort * pp =
+        &g_array_index (
+          pooled_ports, PooledPort, i);
+      for (int j = 0; j < num_bufs; j++)
+        {
+          if (buf_is_dead_before (
+                self, indices, ancestors,
+                num_words, last_ports[j], pp))
+            {
+              pp->buf_idx = j;
+              break;
+            }
+        }
+      if (pp->buf_idx < 0)
+        pp->buf_idx = num_bufs++;
+      last_ports[pp->buf_idx] = pp;
+    }
+
+  /* round up to the alignment */
+  size_t floats_per_alignment =
+    POOL_BUF_ALIGNMENT / sizeof (float);
+  buf_size =
+    ((buf_size + floats_per_alignment - 1)
+     / floats_per_alignment)
+    * floats_per_alignment;
+
+  if (num_bufs > 0)
+    {
+      self->port_buf_pool =
+        aligned_malloc_zero (
+          POOL_BUF_ALIGNMENT,
+          (size_t) num_bufs * buf_size
+            * sizeof (float));
+    }
+  if (self->port_buf_pool)
+    {
+      for (guint i = 0; i < pooled_ports->len; i++)
+        {
+          PooledPort * pp =
+            &g_array_index (
+              pooled_ports, PooledPort, i);
+          Port * port = pp->port;
+          g_warn_if_fail (!port->buf_pooled);
+          object_zero_and_free (port->buf);
+          port->buf =
+            &self->port_buf_pool[
+              (size_t) pp->buf_idx * buf_size];
+          port->buf_pooled = true;
+          port->last_buf_sz = buf_size;
+        }
+      self->num_pooled_bufs = num_bufs;
+      self->num_pooled_ports =
+        (int) pooled_ports->len;
+
+      g_message (
+        "assigned %d plugin audio ports to %d "
+        "pooled buffers",
+        self->num_pooled_ports,
+        self->num_pooled_bufs);
+    }
+
+  g_free (last_ports);
+  g_array_free (pooled_ports, true);
+  g_free (ancestors);
+  g_free (order);
+  g_free (topo_pos);
+  g_free (refcounts);
+  g_hash_table_unref (indices);
+  g_free (nodes);
+}
+
 /*
  * Adds the graph nodes and connections, then
  * rechains.
@@ -1024,6 +1399,8 @@ graph_setup (
                 {
                   port =
                     tr->processor->midi_cc[j * 128 + k];
+                  if (!port)
+                    continue;
                   node2 =
                     graph_find_node_from_port (
                       self, port);
@@ -1036,32 +1413,44 @@ graph_setup (
 
               port =
                 tr->processor->pitch_bend[j];
-              node2 =
-                graph_find_node_from_port (
-                  self, port);
-              if (node2 || !drop_unnecessary_ports)
+              if (port)
                 {
-                  graph_node_connect (node2, node);
+                  node2 =
+                    graph_find_node_from_port (
+                      self, port);
+                  if (node2 || !drop_unnecessary_ports)
+                    {
+                      graph_node_connect (
+                        node2, node);
+                    }
                 }
 
               port =
                 tr->processor->poly_key_pressure[j];
-              node2 =
-                graph_find_node_from_port (
-                  self, port);
-              if (node2 || !drop_unnecessary_ports)
+              if (port)
                 {
-                  graph_node_connect (node2, node);
+                  node2 =
+                    graph_find_node_from_port (
+                      self, port);
+                  if (node2 || !drop_unnecessary_ports)
+                    {
+                      graph_node_connect (
+                        node2, node);
+                    }
                 }
 
               port =
                 tr->processor->channel_pressure[j];
-              node2 =
-                graph_find_node_from_port (
-                  self, port);
-              if (node2 || !drop_unnecessary_ports)
+              if (port)
                 {
-                  graph_node_connect (node2, node);
+                  node2 =
+                    graph_find_node_from_port (
+                      self, port);
+                  if (node2 || !drop_unnecessary_ports)
+                    {
+                      graph_node_connect (
+                        node2, node);
+                    }
                 }
             }
         }
@@ -1438,7 +1827,10 @@ graph_setup (
   g_ptr_array_unref (ports);
 
   if (rechain)
-    graph_rechain (self);
+    {
+      assign_pooled_bufs (self);
+      graph_rechain (self);
+    }
 }
 
 /**
@@ -1596,6 +1988,8 @@ graph_new (
   g_atomic_int_set (&self->idle_thread_cnt, 0);
   g_atomic_int_set (&self->trigger_queue_size, 0);
 
+  self->use_buf_pool = true;
+
   return self;
 }
 
@@ -1884,6 +2278,8 @@ graph_free (
 
   object_free_w_func_and_null (
     g_ptr_array_unref, self->external_out_ports);
+  object_free_w_func_and_null (
+    aligned_free, self->port_buf_pool);
 
   zix_sem_destroy (&self->callback_start);
   zix_sem_destroy (&self->callback_done);
@@ -72,7 +72,7 @@ meter_get_value (
           return;
         }
 
-      float buf[read_space_avail];
+      float buf[read_space_avail / sizeof (float)];
       size_t blocks_read =
         zix_ring_peek (
           port->audio_ring, &buf[0],
@@ -93,6 +93,14 @@ meter_get_value (
           return;
         }
 
+      /* the port buffer may be in use by the
+       * engine (or by another port if pooled), so
+       * use the latest block published */
+      float * last_block =
+        &buf[
+          (blocks_read - 1)
+          * AUDIO_ENGINE->block_length];
+
       switch (self->algorithm)
         {
         case METER_ALGORITHM_RMS:
@@ -107,7 +115,7 @@ meter_get_value (
         case METER_ALGORITHM_TRUE_PEAK:
           true_peak_dsp_process (
             self->true_peak_processor,
-            &port->buf[0],
+            last_block,
             (int) AUDIO_ENGINE->block_length);
           amp =
             true_peak_dsp_read_f (
@@ -116,7 +124,7 @@ meter_get_value (
         case METER_ALGORITHM_K:
           kmeter_dsp_process (
             self->kmeter_processor,
-            &port->buf[0],
+            last_block,
             (int) AUDIO_ENGINE->block_length);
           kmeter_dsp_read (
             self->kmeter_processor, &amp, &max_amp);
@@ -124,7 +132,7 @@ meter_get_value (
         case METER_ALGORITHM_DIGITAL_PEAK:
           peak_dsp_process (
             self->peak_processor,
-            &port->buf[0],
+            last_block,
             (int) AUDIO_ENGINE->block_length);
           peak_dsp_read (
             self->peak_processor, &amp, &max_amp);
@@ -136,21 +144,20 @@ meter_get_value (
   else if (port->id.type == TYPE_EVENT)
     {
       bool on = false;
-      if (port->write_ring_buffers)
+      if (port->midi_ring)
         {
-          MidiEvent event;
+          gint64 systime;
           while (
-            zix_ring_peek (
-              port->midi_ring, &event,
-              sizeof (MidiEvent)) > 0)
+            zix_ring_read (
+              port->midi_ring, &systime,
+              sizeof (gint64)) > 0)
             {
-              if (event.systime >
+              if (systime >
                     self->last_midi_trigger_time)
                 {
                   on = true;
                   self->last_midi_trigger_time =
-                    event.systime;
-                  break;
+                    systime;
                 }
             }
         }
@@ -229,6 +236,7 @@ meter_new_for_port (
   Meter * self = object_new (Meter);
 
   self->port = port;
+  port_identifier_copy (&self->port_id, &port->id);
 
   /* master */
   if (port->id.type == TYPE_AUDIO ||
@@ -269,6 +277,33 @@ meter_new_for_port (
   return self;
 }
 
+/**
+ * Subscribes to or unsubscribes from the data of
+ * the port.
+ *
+ * To be called when the UI element showing the
+ * meter is mapped or unmapped.
+ */
+void
+meter_set_observing (
+  Meter * self,
+  bool    observing)
+{
+  if (self->observing == observing)
+    return;
+
+  if (observing)
+    {
+      port_add_observer (self->port);
+    }
+  else if (port_is_alive (
+             &self->port_id, self->port))
+    {
+      port_remove_observer (self->port);
+    }
+  self->observing = observing;
+}
+
 void
 meter_free (
   Meter * self)
@@ -286,5 +321,8 @@ meter_free (
 
 #undef FREE_DSP
 
+  meter_set_observing (self, false);
+  port_identifier_free_members (&self->port_id);
+
   free (self);
 }
@@ -296,44 +296,34 @@ metronome_queue_events (
  const nframes_t loffset,
  const nframes_t nframes)
 {
-  Position playhead_pos, bar_pos, beat_pos,
-           unlooped_playhead;
-  position_init (&bar_pos);
-  position_init (&beat_pos);
-  position_set_to_pos (&playhead_pos, PLAYHEAD);
-  position_set_to_pos (
-    &unlooped_playhead, PLAYHEAD);
-  transport_position_add_frames (
-    self->transport, &playhead_pos, nframes);
-  position_add_frames (
-    &unlooped_playhead, (long) nframes);
-  int loop_crossed =
-    unlooped_playhead.frames !=
-    playhead_pos.frames;
-  if (loop_crossed)
+  TransportSnapshot snapshot;
+  transport_snapshot_init (
+    &snapshot, self->transport, PLAYHEAD,
+    nframes);
+  if (snapshot.loop_crossed)
     {
       /* find each bar / beat change until loop
        * end */
       find_and_queue_metronome (
-        PLAYHEAD, &self->transport->loop_end_pos,
-        loffset);
+        &snapshot.pos,
+        &self->transport->loop_end_pos, loffset);
 
       /* find each bar / beat change after loop
        * start */
       find_and_queue_metronome (
         &self->transport->loop_start_pos,
-        &playhead_pos,
+        &snapshot.end_pos,
         loffset +
           (nframes_t)
           (self->transport->loop_end_pos.frames -
-           PLAYHEAD->frames));
+           snapshot.pos.frames));
     }
   else /* loop not crossed */
     {
       /* find each bar / beat change from start
        * to finish */
       find_and_queue_metronome (
-        PLAYHEAD, &playhead_pos, loffset);
+        &snapshot.pos, &snapshot.end_pos, loffset);
     }
 }
 
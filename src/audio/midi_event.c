@@ -48,6 +48,7 @@
 #include "audio/transport.h"
 #include "project.h"
 #include "utils/objects.h"
+#include "zrythm.h"
 
 /**
  * Type of MIDI event.
@@ -75,6 +76,336 @@ static const char * midi_event_type_strings[] =
   "all notes off",
 };
 
+/**
+ * MidiEvents that may need spare buffers, guarded
+ * by @ref registry_mutex.
+ */
+static GHashTable * registry = NULL;
+static GMutex       registry_mutex;
+
+/** Number of MidiEvents with needs_spares set. */
+static volatile gint num_needing_spares = 0;
+
+/**
+ * Returns whether the current thread is one of the
+ * engine's processing threads, where allocating is
+ * not allowed.
+ */
+static bool
+is_processing_thread (void)
+{
+  return
+    ZRYTHM && PROJECT && AUDIO_ENGINE && ROUTER
+    && (router_is_processing_kickoff_thread (ROUTER)
+        || router_is_processing_thread (ROUTER));
+}
+
+static void
+request_spares (
+  MidiEvents * self)
+{
+  if (g_atomic_int_compare_and_exchange (
+        &self->needs_spares, 0, 1))
+    {
+      g_atomic_int_inc (&num_needing_spares);
+    }
+}
+
+/**
+ * Grows the events so that at least one more event
+ * fits.
+ *
+ * In the realtime threads this only swaps in the
+ * spare buffer, if any.
+ *
+ * @return Whether the events grew.
+ */
+static bool
+grow_events (
+  MidiEvents * self)
+{
+  gint size = g_atomic_int_get (&self->events_size);
+  if (size >= MAX_MIDI_EVENTS)
+    return false;
+
+  MidiEvent * spare =
+    (MidiEvent *)
+    g_atomic_pointer_get (&self->spare_events);
+  if (spare && self->spare_events_size > size
+      && !g_atomic_pointer_get (
+            &self->retired_events))
+    {
+      memcpy (
+        spare, self->events,
+        (size_t) self->num_events
+          * sizeof (MidiEvent));
+      g_atomic_pointer_set (
+        &self->retired_events, self->events);
+      self->events = spare;
+      g_atomic_int_set (
+        &self->events_size, self->spare_events_size);
+      g_atomic_pointer_set (
+        &self->spare_events, NULL);
+      request_spares (self);
+      return true;
+    }
+
+  if (is_processing_thread ())
+    {
+      request_spares (self);
+      return false;
+    }
+
+  gint new_size = MIN (size * 2, MAX_MIDI_EVENTS);
+  self->events =
+    g_realloc_n (
+      self->events, (size_t) new_size,
+      sizeof (MidiEvent));
+  g_atomic_int_set (&self->events_size, new_size);
+
+  /* the spare is no longer larger */
+  if (spare && self->spare_events_size <= new_size)
+    {
+      g_atomic_pointer_set (
+        &self->spare_events, NULL);
+      g_free (spare);
+      request_spares (self);
+    }
+
+  return true;
+}
+
+/**
+ * Grows the long data so that at least @p size
+ * more bytes fit.
+ *
+ * In the realtime threads this only swaps in the
+ * spare buffer, if any.
+ *
+ * @return Whether the long data grew.
+ */
+static bool
+grow_long_data (
+  MidiEvents * self,
+  size_t       size)
+{
+  gint cur_size =
+    g_atomic_int_get (&self->long_data_size);
+  size_t needed = self->long_data_len + size;
+  if (needed > MIDI_EVENTS_MAX_LONG_DATA)
+    return false;
+
+  midi_byte_t * spare =
+    (midi_byte_t *)
+    g_atomic_pointer_get (&self->spare_long_data);
+  if (spare
+      && (size_t) self->spare_long_data_size
+           >= needed
+      && !g_atomic_pointer_get (
+            &self->retired_long_data))
+    {
+      memcpy (
+        spare, self->long_data,
+        self->long_data_len);
+      g_atomic_pointer_set (
+        &self->retired_long_data, self->long_data);
+      self->long_data = spare;
+      g_atomic_int_set (
+        &self->long_data_size,
+        self->spare_long_data_size);
+      g_atomic_pointer_set (
+        &self->spare_long_data, NULL);
+      request_spares (self);
+      return true;
+    }
+
+  if (is_processing_thread ())
+    {
+      request_spares (self);
+      return false;
+    }
+
+  size_t new_size = (size_t) cur_size;
+  while (new_size < needed)
+    new_size *= 2;
+  new_size =
+    MIN (new_size, MIDI_EVENTS_MAX_LONG_DATA);
+  self->long_data =
+    g_realloc (self->long_data, new_size);
+  g_atomic_int_set (
+    &self->long_data_size, (gint) new_size);
+
+  /* the spare is no longer larger */
+  if (spare
+      && (size_t) self->spare_long_data_size
+           <= new_size)
+    {
+      g_atomic_pointer_set (
+        &self->spare_long_data, NULL);
+      g_free (spare);
+      request_spares (self);
+    }
+
+  return true;
+}
+
+/**
+ * Returns a pointer to @p size free bytes at the
+ * end of the long data.
+ *
+ * @return The pointer, or NULL if the long data is
+ *   full.
+ */
+static midi_byte_t *
+reserve_long_data (
+  MidiEvents * self,
+  size_t       size)
+{
+  if (self->long_data_len + size
+        > (size_t) self->long_data_size
+      && !grow_long_data (self, size))
+    {
+      g_critical (
+        "MIDI events long data full (%d)",
+        self->long_data_size);
+      return NULL;
+    }
+
+  return &self->long_data[self->long_data_len];
+}
+
+/**
+ * Appends a message to the main events.
+ *
+ * This does not allocate in the realtime threads.
+ *
+ * @param buf The message. For long messages, this
+ *   may be the pointer returned by
+ *   reserve_long_data().
+ *
+ * @return The added event, or NULL if the buffers
+ *   are full.
+ */
+static MidiEvent *
+append_event (
+  MidiEvents *        self,
+  const midi_byte_t * buf,
+  size_t              buf_sz,
+  midi_time_t         time)
+{
+  if (self->num_events >= self->events_size
+      && !grow_events (self))
+    {
+      g_critical (
+        "MIDI events full (%d)", self->events_size);
+      return NULL;
+    }
+
+  MidiEvent * ev = &self->events[self->num_events];
+  ev->time = time;
+  ev->raw_buffer_sz = (uint16_t) buf_sz;
+  ev->long_data_offset = 0;
+  memset (ev->raw_buffer, 0, sizeof (ev->raw_buffer));
+  memcpy (ev->raw_buffer, buf, MIN (buf_sz, 3));
+
+  if (buf_sz > 3)
+    {
+      midi_byte_t * data =
+        reserve_long_data (self, buf_sz);
+      if (!data)
+        return NULL;
+
+      if (data != buf)
+        memcpy (data, buf, buf_sz);
+      ev->long_data_offset =
+        (uint16_t) self->long_data_len;
+      self->long_data_len += buf_sz;
+    }
+
+  self->num_events++;
+
+  return ev;
+}
+
+/**
+ * Pushes a message to the queue.
+ *
+ * This is safe to call from multiple non-realtime
+ * threads.
+ */
+static void
+push_to_queue (
+  MidiEvents *        self,
+  const midi_byte_t * buf,
+  size_t              buf_sz,
+  midi_time_t         time)
+{
+  zix_sem_wait (&self->queue_sem);
+
+  ZixRing * queue =
+    (ZixRing *) g_atomic_pointer_get (&self->queue);
+  if (!queue)
+    {
+      queue =
+        zix_ring_new (
+          MIDI_EVENTS_QUEUE_SIZE * sizeof (MidiEvent));
+      g_atomic_pointer_set (&self->queue, queue);
+    }
+
+  MidiEvent ev;
+  memset (&ev, 0, sizeof (ev));
+  ev.time = time;
+  ev.raw_buffer_sz = (uint16_t) buf_sz;
+  memcpy (ev.raw_buffer, buf, MIN (buf_sz, 3));
+
+  /* write the header and the data at once so
+   * that the reader never sees one without the
+   * other */
+  size_t total_sz = sizeof (ev);
+  if (buf_sz > 3)
+    total_sz += buf_sz;
+  midi_byte_t short_msg[sizeof (MidiEvent)];
+  midi_byte_t * msg =
+    buf_sz > 3 ? g_malloc (total_sz) : short_msg;
+  memcpy (msg, &ev, sizeof (ev));
+  if (buf_sz > 3)
+    memcpy (&msg[sizeof (ev)], buf, buf_sz);
+
+  if (zix_ring_write (
+        queue, msg, (uint32_t) total_sz)
+      != total_sz)
+    {
+      g_warning (
+        "MIDI event queue full, dropping event");
+    }
+
+  if (msg != short_msg)
+    g_free (msg);
+
+  zix_sem_post (&self->queue_sem);
+}
+
+/**
+ * Adds a message to the main events or to the
+ * queue.
+ */
+static void
+add_event (
+  MidiEvents *        self,
+  const midi_byte_t * buf,
+  size_t              buf_sz,
+  midi_time_t         time,
+  bool                queued)
+{
+  g_return_if_fail (
+    buf_sz > 0 && buf_sz <= UINT16_MAX);
+
+  if (queued)
+    push_to_queue (self, buf, buf_sz, time);
+  else
+    append_event (self, buf, buf_sz, time);
+}
+
 /**
  * Appends the events from src to dest
  *
@@ -122,7 +453,7 @@ midi_events_append_w_filter (
   /* queued not implemented yet */
   g_return_if_fail (!queued);
 
-  MidiEvent * src_ev, * dest_ev;
+  MidiEvent * src_ev;
   for (int i = 0; i < src->num_events; i++)
     {
       src_ev = &src->events[i];
@@ -153,12 +484,14 @@ midi_events_append_w_filter (
             }
         }
 
-      g_return_if_fail (
-        dest->num_events < MAX_MIDI_EVENTS);
-
-      dest_ev =
-        &dest->events[dest->num_events++];
-      midi_event_copy (dest_ev, src_ev);
+      if (!append_event (
+             dest,
+             midi_events_get_event_data (
+               src, src_ev),
+             src_ev->raw_buffer_sz, src_ev->time))
+        {
+          break;
+        }
     }
 
   /* clear duplicates */
@@ -217,6 +550,10 @@ midi_events_set_channel (
 
 /**
  * Clears midi events.
+ *
+ * @param queued Discard the events in the queue
+ *   instead. This must only be called from the
+ *   thread that dequeues the events.
  */
 REALTIME
 void
@@ -226,11 +563,19 @@ midi_events_clear (
 {
   if (queued)
     {
-      self->num_queued_events = 0;
+      ZixRing * queue =
+        (ZixRing *)
+        g_atomic_pointer_get (&self->queue);
+      if (queue)
+        {
+          zix_ring_skip (
+            queue, zix_ring_read_space (queue));
+        }
     }
   else
     {
       self->num_events = 0;
+      self->long_data_len = 0;
     }
 }
 
@@ -244,31 +589,18 @@ midi_events_check_for_note_on (
   int          note,
   int          queued)
 {
-  /*g_message ("waiting check note on");*/
-  zix_sem_wait (&self->access_sem);
+  /* the queue can not be inspected */
+  g_return_val_if_fail (!queued, 0);
 
-  MidiEvent * ev;
-  for (int i = 0;
-       i < queued ?
-         self->num_queued_events :
-         self->num_events;
-       i++)
+  for (int i = 0; i < self->num_events; i++)
     {
-      if (queued)
-        ev = &self->queued_events[i];
-      else
-        ev = &self->events[i];
-
-      midi_byte_t * buf = ev->raw_buffer;
+      midi_byte_t * buf = self->events[i].raw_buffer;
 
       if (midi_is_note_on (buf)
           && midi_get_note_number (buf) == note)
         return 1;
     }
 
-  zix_sem_post (&self->access_sem);
-  /*g_message ("posted check note on");*/
-
   return 0;
 }
 
@@ -279,58 +611,26 @@ midi_events_check_for_note_on (
 int
 midi_events_delete_note_on (
   MidiEvents * self,
-  int note,
-  int queued)
+  int          note,
+  int          queued)
 {
-  /*g_message ("waiting delete note on");*/
-  zix_sem_wait (&self->access_sem);
+  /* the queue can not be inspected */
+  g_return_val_if_fail (!queued, 0);
 
-  MidiEvent * ev, * ev2, * next_ev;
   int match = 0;
-  for (int i = queued ?
-         self->num_queued_events - 1 :
-         self->num_events - 1;
-       i >= 0; i--)
+  for (int i = self->num_events - 1; i >= 0; i--)
     {
-      ev = queued ?
-        &self->queued_events[i] :
-        &self->events[i];
+      MidiEvent * ev = &self->events[i];
       midi_byte_t * buf = ev->raw_buffer;
       if (midi_is_note_on (buf)
           && midi_get_note_number (buf) == note)
         {
           match = 1;
-
-          if (queued)
-            --self->num_queued_events;
-          else
-            --self->num_events;
-
-          for (int ii = i;
-               ii < queued ?
-                 self->num_queued_events :
-                 self->num_events;
-               ii++)
-            {
-              if (queued)
-                {
-                  ev2 = &self->queued_events[ii];
-                  next_ev =
-                    &self->queued_events[ii + 1];
-                }
-              else
-                {
-                  ev2 = &self->events[ii];
-                  next_ev =
-                    &self->events[ii + 1];
-                }
-              midi_event_copy (ev2, next_ev);
-            }
+          midi_events_delete_event (
+            self, ev, F_NOT_QUEUED);
         }
     }
 
-  zix_sem_post (&self->access_sem);
-
   return match;
 }
 
@@ -342,9 +642,121 @@ midi_events_init (
   MidiEvents * self)
 {
   self->num_events = 0;
-  self->num_queued_events = 0;
 
-  zix_sem_init (&self->access_sem, 1);
+  /* start small and prepare the next size right
+   * away, so the first growth in the realtime
+   * threads does not have to wait */
+  self->events_size = MIDI_EVENTS_INITIAL_SIZE;
+  self->events =
+    object_new_n (
+      MIDI_EVENTS_INITIAL_SIZE, MidiEvent);
+  self->long_data_size =
+    MIDI_EVENTS_INITIAL_LONG_DATA;
+  self->long_data =
+    object_new_n (
+      MIDI_EVENTS_INITIAL_LONG_DATA, midi_byte_t);
+  self->spare_events_size =
+    MIDI_EVENTS_INITIAL_SIZE * 2;
+  self->spare_events =
+    object_new_n (
+      (size_t) self->spare_events_size, MidiEvent);
+  self->spare_long_data_size =
+    MIDI_EVENTS_INITIAL_LONG_DATA * 2;
+  self->spare_long_data =
+    object_new_n (
+      (size_t) self->spare_long_data_size,
+      midi_byte_t);
+
+  zix_sem_init (&self->queue_sem, 1);
+
+  g_mutex_lock (&registry_mutex);
+  if (!registry)
+    registry = g_hash_table_new (NULL, NULL);
+  g_hash_table_add (registry, self);
+  g_mutex_unlock (&registry_mutex);
+}
+
+/**
+ * Frees the replaced buffers and prepares the
+ * next larger ones.
+ */
+static void
+prepare_spares (
+  MidiEvents * self)
+{
+  g_free (
+    g_atomic_pointer_get (&self->retired_events));
+  g_atomic_pointer_set (
+    &self->retired_events, NULL);
+  g_free (
+    g_atomic_pointer_get (
+      &self->retired_long_data));
+  g_atomic_pointer_set (
+    &self->retired_long_data, NULL);
+
+  /* the spares are only set while NULL, so the
+   * thread adding events always sees a spare
+   * together with its size */
+  gint size = g_atomic_int_get (&self->events_size);
+  if (!g_atomic_pointer_get (&self->spare_events)
+      && size < MAX_MIDI_EVENTS)
+    {
+      self->spare_events_size =
+        MIN (size * 2, MAX_MIDI_EVENTS);
+      g_atomic_pointer_set (
+        &self->spare_events,
+        object_new_n (
+          (size_t) self->spare_events_size,
+          MidiEvent));
+    }
+  size = g_atomic_int_get (&self->long_data_size);
+  if (!g_atomic_pointer_get (
+         &self->spare_long_data)
+      && size < MIDI_EVENTS_MAX_LONG_DATA)
+    {
+      self->spare_long_data_size =
+        MIN (size * 2, MIDI_EVENTS_MAX_LONG_DATA);
+      g_atomic_pointer_set (
+        &self->spare_long_data,
+        object_new_n (
+          (size_t) self->spare_long_data_size,
+          midi_byte_t));
+    }
+}
+
+/**
+ * Prepares larger spare buffers for the MidiEvents
+ * that grew in the realtime threads and frees
+ * the buffers they replaced.
+ *
+ * To be called periodically from a non-realtime
+ * thread.
+ */
+void
+midi_events_prepare_spares (void)
+{
+  if (g_atomic_int_get (&num_needing_spares) == 0)
+    return;
+
+  g_mutex_lock (&registry_mutex);
+  GHashTableIter iter;
+  gpointer key;
+  g_hash_table_iter_init (&iter, registry);
+  while (g_hash_table_iter_next (
+           &iter, &key, NULL))
+    {
+      /* requests made after this are counted
+       * again */
+      MidiEvents * self = (MidiEvents *) key;
+      if (g_atomic_int_compare_and_exchange (
+            &self->needs_spares, 1, 0))
+        {
+          g_atomic_int_add (
+            &num_needing_spares, -1);
+          prepare_spares (self);
+        }
+    }
+  g_mutex_unlock (&registry_mutex);
 }
 
 /**
@@ -365,7 +777,9 @@ midi_events_new (void)
  * events.
  *
  * @param check_main Check the main events.
- * @param check_queued Check the queued events.
+ * @param check_queued Check the queued events
+ *   (not supported, the queue can not be
+ *   inspected).
  */
 int
 midi_events_has_note_on (
@@ -373,6 +787,8 @@ midi_events_has_note_on (
   int          check_main,
   int          check_queued)
 {
+  g_return_val_if_fail (!check_queued, 0);
+
   if (check_main)
     {
       for (int i = 0; i < self->num_events; i++)
@@ -384,24 +800,15 @@ midi_events_has_note_on (
             }
         }
     }
-  if (check_queued)
-    {
-      for (int i = 0;
-           i < self->num_queued_events; i++)
-        {
-          if (midi_is_note_on (
-                self->queued_events[i].raw_buffer))
-            {
-              return 1;
-            }
-        }
-    }
 
   return 0;
 }
 
 /**
- * Copies the queue contents to the original struct
+ * Appends the events in the queue to the main
+ * events.
+ *
+ * This does not block the writers of the queue.
  */
 REALTIME
 NONNULL
@@ -409,24 +816,45 @@ void
 midi_events_dequeue (
   MidiEvents * self)
 {
-  /*g_message ("waiting dequeue");*/
-  zix_sem_wait (&self->access_sem);
-
-  MidiEvent * ev, * q_ev;
-  for (int i = 0;
-       i < self->num_queued_events; i++)
+  ZixRing * queue =
+    (ZixRing *) g_atomic_pointer_get (&self->queue);
+  if (!queue)
+    return;
+
+  bool added = false;
+  MidiEvent ev;
+  while (zix_ring_read (
+           queue, &ev, sizeof (ev)) == sizeof (ev))
     {
-      q_ev = &self->queued_events[i];
-      ev = &self->events[i];
-
-      midi_event_copy (ev, q_ev);
+      if (ev.raw_buffer_sz > 3)
+        {
+          /* read the data directly into the long
+           * data */
+          midi_byte_t * data =
+            reserve_long_data (
+              self, ev.raw_buffer_sz);
+          if (!data)
+            {
+              zix_ring_skip (
+                queue, ev.raw_buffer_sz);
+              continue;
+            }
+          zix_ring_read (
+            queue, data, ev.raw_buffer_sz);
+          append_event (
+            self, data, ev.raw_buffer_sz, ev.time);
+        }
+      else
+        {
+          append_event (
+            self, ev.raw_buffer, ev.raw_buffer_sz,
+            ev.time);
+        }
+      added = true;
     }
 
-  self->num_events = self->num_queued_events;
-  self->num_queued_events = 0;
-
-  zix_sem_post (&self->access_sem);
-  /*g_message ("posted dequeue");*/
+  if (added)
+    midi_events_sort (self, F_NOT_QUEUED);
 }
 
 /**
@@ -440,28 +868,12 @@ midi_events_add_all_notes_off (
   bool         queued)
 {
   g_return_if_fail (channel > 0);
-  MidiEvent * ev;
-  if (queued)
-    ev =
-      &self->queued_events[self->num_queued_events];
-  else
-    ev =
-      &self->events[self->num_events];
 
-  ev->time = time;
-  ev->raw_buffer[0] =
+  midi_byte_t buf[3] = {
     (midi_byte_t)
-    (MIDI_CH1_CTRL_CHANGE | (channel - 1));
-  ev->raw_buffer[1] = MIDI_ALL_NOTES_OFF;
-  ev->raw_buffer[2] = 0x00;
-  ev->raw_buffer_sz = 3;
-  g_return_if_fail (
-    midi_is_all_notes_off (ev->raw_buffer));
-
-  if (queued)
-    self->num_queued_events++;
-  else
-    self->num_events++;
+    (MIDI_CH1_CTRL_CHANGE | (channel - 1)),
+    MIDI_ALL_NOTES_OFF, 0x00 };
+  add_event (self, buf, 3, time, queued);
 }
 
 void
@@ -469,14 +881,12 @@ midi_events_panic (
   MidiEvents * self,
   bool         queued)
 {
-  zix_sem_wait (&self->access_sem);
   /*g_message ("sending PANIC");*/
   for (midi_byte_t i = 1; i < 17; i++)
     {
       midi_events_add_all_notes_off (
         self, i, 0, queued);
     }
-  zix_sem_post (&self->access_sem);
 }
 
 #ifdef HAVE_JACK
@@ -491,18 +901,13 @@ midi_events_copy_to_jack (
   jack_midi_clear_buffer (buff);
 
   MidiEvent * ev;
-  jack_midi_data_t midi_data[3];
   for (int i = 0; i < self->num_events; i++)
     {
       ev = &self->events[i];
 
-      for (size_t j = 0; j < ev->raw_buffer_sz;
-           j++)
-        {
-          midi_data[j] = ev->raw_buffer[j];
-        }
       jack_midi_event_write (
-        buff, ev->time, midi_data,
+        buff, ev->time,
+        midi_events_get_event_data (self, ev),
         ev->raw_buffer_sz);
 #if 0
       g_message (
@@ -515,10 +920,10 @@ midi_events_copy_to_jack (
 
 /**
  * Adds a note off event to the given MidiEvents.
- * FIXME should be wrapped in access sem?
  *
  * @param channel MIDI channel starting from 1.
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_note_off (
@@ -529,30 +934,20 @@ midi_events_add_note_off (
   int          queued)
 {
   g_return_if_fail (channel > 0);
-  MidiEvent * ev;
-  if (queued)
-    ev =
-      &self->queued_events[self->num_queued_events];
-  else
-    ev =
-      &self->events[self->num_events];
 
-  ev->time = time;
-  ev->raw_buffer[0] =
+  midi_byte_t buf[3] = {
     (midi_byte_t)
-    (MIDI_CH1_NOTE_OFF | (channel - 1));
-  ev->raw_buffer[1] = note_pitch;
-  ev->raw_buffer[2] = 90;
-  ev->raw_buffer_sz = 3;
-  g_return_if_fail (
-    midi_is_note_off (ev->raw_buffer));
-
-  if (queued)
-    self->num_queued_events++;
-  else
-    self->num_events++;
+    (MIDI_CH1_NOTE_OFF | (channel - 1)),
+    note_pitch, 90 };
+  add_event (self, buf, 3, time, queued);
 }
 
+/**
+ * Adds a raw MIDI message.
+ *
+ * Messages longer than 3 bytes (such as SysEx) are
+ * supported.
+ */
 void
 midi_events_add_raw (
   MidiEvents * self,
@@ -561,37 +956,15 @@ midi_events_add_raw (
   midi_time_t  time,
   bool         queued)
 {
-  if (buf_sz > 3)
-    {
-      midi_print (buf, buf_sz);
-      g_return_if_reached ();
-    }
-
-  MidiEvent * ev;
-  if (queued)
-    ev =
-      &self->queued_events[self->num_queued_events];
-  else
-    ev =
-      &self->events[self->num_events];
-
-  ev->time = time;
-  for (size_t i = 0; i < buf_sz; i++)
-    {
-      ev->raw_buffer[i] = buf[i];
-    }
-
-  if (queued)
-    self->num_queued_events++;
-  else
-    self->num_events++;
+  add_event (self, buf, buf_sz, time, queued);
 }
 
 /**
  * Adds a control event to the given MidiEvents.
  *
  * @param channel MIDI channel starting from 1.
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_control_change (
@@ -602,26 +975,11 @@ midi_events_add_control_change (
   midi_time_t  time,
   int          queued)
 {
-  MidiEvent * ev;
-  if (queued)
-    ev =
-      &self->queued_events[self->num_queued_events];
-  else
-    ev =
-      &self->events[self->num_events];
-
-  ev->time = time;
-  ev->raw_buffer[0] =
+  midi_byte_t buf[3] = {
     (midi_byte_t)
-    (MIDI_CH1_CTRL_CHANGE | (channel - 1));
-  ev->raw_buffer[1] = controller;
-  ev->raw_buffer[2] = control;
-  ev->raw_buffer_sz = 3;
-
-  if (queued)
-    self->num_queued_events++;
-  else
-    self->num_events++;
+    (MIDI_CH1_CTRL_CHANGE | (channel - 1)),
+    controller, control };
+  add_event (self, buf, 3, time, queued);
 }
 
 /**
@@ -629,7 +987,8 @@ midi_events_add_control_change (
  *
  * @param channel MIDI channel starting from 1.
  * @param pitchbend -8192 to 8191
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_pitchbend (
@@ -639,27 +998,13 @@ midi_events_add_pitchbend (
   midi_time_t  time,
   int          queued)
 {
-  MidiEvent * ev;
-  if (queued)
-    ev =
-      &self->queued_events[self->num_queued_events];
-  else
-    ev =
-      &self->events[self->num_events];
-
-  ev->time = time;
-  ev->raw_buffer[0] =
+  midi_byte_t buf[3];
+  buf[0] =
     (midi_byte_t)
     (MIDI_CH1_PITCH_WHEEL_RANGE | (channel - 1));
   midi_get_bytes_from_combined (
-    pitchbend + 8192, &ev->raw_buffer[1],
-    &ev->raw_buffer[2]);
-  ev->raw_buffer_sz = 3;
-
-  if (queued)
-    self->num_queued_events++;
-  else
-    self->num_events++;
+    pitchbend + 8192, &buf[1], &buf[2]);
+  add_event (self, buf, 3, time, queued);
 }
 
 static inline MidiEventType
@@ -717,28 +1062,20 @@ midi_events_sort (
   MidiEvents * self,
   const bool   queued)
 {
-  MidiEvent * events;
-  size_t num_events;
-  if (queued)
-    {
-      events = self->queued_events;
-      num_events = (size_t) self->num_queued_events;
-    }
-  else
-    {
-      events = self->events;
-      num_events = (size_t) self->num_events;
-    }
+  /* the queue is sorted when dequeued */
+  g_return_if_fail (!queued);
+
   qsort (
-    events, num_events, sizeof (MidiEvent),
-    midi_event_cmpfunc);
+    self->events, (size_t) self->num_events,
+    sizeof (MidiEvent), midi_event_cmpfunc);
 }
 
 /**
  * Adds a note on event to the given MidiEvents.
  *
  * @param channel MIDI channel starting from 1.
- * @param queued Add to queued events instead.
+ * @param queued Add to the queue instead (from a
+ *   non-realtime thread).
  */
 void
 midi_events_add_note_on (
@@ -757,28 +1094,12 @@ midi_events_add_note_on (
     __func__, channel, note_pitch, velocity, time);
 #endif
 
-  MidiEvent * ev;
-  if (queued)
-    ev =
-      &self->queued_events[self->num_queued_events];
-  else
-    ev =
-      &self->events[self->num_events];
-
-  ev->time = time;
-  ev->raw_buffer[0] =
+  midi_byte_t buf[3] = {
     (midi_byte_t)
-    (MIDI_CH1_NOTE_ON | (channel - 1));
-  ev->raw_buffer[1] = note_pitch;
-  ev->raw_buffer[2] = velocity;
-  ev->raw_buffer_sz = 3;
-  g_return_if_fail (
-    midi_is_note_on (ev->raw_buffer));
-
-  if (queued)
-    self->num_queued_events++;
-  else
-    self->num_events++;
+    (MIDI_CH1_NOTE_ON | (channel - 1)),
+    note_pitch, velocity };
+  g_return_if_fail (midi_is_note_on (buf));
+  add_event (self, buf, 3, time, queued);
 }
 
 /**
@@ -836,7 +1157,7 @@ midi_events_add_note_offs_from_chord_descr (
 /**
  * Parses a MidiEvent from a raw MIDI buffer.
  *
- * This must be a full 3-byte message. If in
+ * This must be a full message. If in
  * 'running status' mode, the caller is responsible
  * for prepending the status byte.
  */
@@ -887,8 +1208,15 @@ note_off:
         time, queued);
       break;
     case MIDI_SYSTEM_MESSAGE:
+      /* pass SysEx through */
+      if (buf[0] == 0xF0)
+        {
+          midi_events_add_raw (
+            self, buf, (size_t) buf_size, time,
+            queued);
+        }
       /* ignore active sensing */
-      if (buf[0] != 0xFE)
+      else if (buf[0] != 0xFE)
         {
 #if 0
           print_unknown_event_message (
@@ -913,29 +1241,22 @@ midi_events_delete_event (
   const MidiEvent * ev,
   const bool        queued)
 {
-  MidiEvent * arr =
-    queued ?
-      self->queued_events :
-      self->events;
-#define NUM_EVENTS \
-  (queued ? self->num_queued_events : \
-   self->num_events)
-
-  for (int i = 0; i < NUM_EVENTS; i++)
+  /* the queue can not be inspected */
+  g_return_if_fail (!queued);
+
+  for (int i = 0; i < self->num_events; i++)
     {
-      MidiEvent * cur_ev = &arr[i];
+      MidiEvent * cur_ev = &self->events[i];
       if (cur_ev == ev)
         {
-          for (int k = i; k < NUM_EVENTS - 1; k++)
-            {
-              midi_event_copy (
-                &arr[k + 1], &arr[k]);
-            }
-          if (queued)
-            self->num_queued_events--;
-          else
-            self->num_events--;
-          i--;
+          /* the long data (if any) is released
+           * when the events are cleared */
+          memmove (
+            cur_ev, cur_ev + 1,
+            (size_t) (self->num_events - i - 1)
+              * sizeof (MidiEvent));
+          self->num_events--;
+          break;
         }
     }
 }
@@ -954,8 +1275,17 @@ midi_event_print (
 {
   char msg[400];
   midi_print_to_str (
-    ev->raw_buffer, ev->raw_buffer_sz, msg);
-  g_message ("%s | time: %u", msg, ev->time);
+    ev->raw_buffer, MIN (ev->raw_buffer_sz, 3), msg);
+  if (ev->raw_buffer_sz > 3)
+    {
+      g_message (
+        "%s... (%u bytes) | time: %u", msg,
+        ev->raw_buffer_sz, ev->time);
+    }
+  else
+    {
+      g_message ("%s | time: %u", msg, ev->time);
+    }
 }
 
 void
@@ -963,20 +1293,12 @@ midi_events_print (
   MidiEvents * self,
   const int    queued)
 {
-  MidiEvent * arr =
-    queued ?
-      self->queued_events :
-      self->events;
-  MidiEvent * ev1;
-#define NUM_EVENTS \
-  (queued ? self->num_queued_events : \
-   self->num_events)
-
-  int i;
-  for (i = 0; i < NUM_EVENTS; i++)
+  /* the queue can not be inspected */
+  g_return_if_fail (!queued);
+
+  for (int i = 0; i < self->num_events; i++)
     {
-      ev1 = &arr[i];
-      midi_event_print (ev1);
+      midi_event_print (&self->events[i]);
     }
 }
 
@@ -1026,43 +1348,42 @@ midi_events_clear_duplicates (
 {
   g_return_if_fail (self);
 
-  MidiEvent * arr =
-    queued ?
-      self->queued_events :
-      self->events;
-  MidiEvent * ev1, * ev2;
-#define NUM_EVENTS \
-  (queued ? self->num_queued_events : \
-   self->num_events)
-
-  int i, j, k;
-  for (i = 0; i < NUM_EVENTS; i++)
-    {
-      ev1 = &arr[i];
+  /* the queue can not be inspected */
+  g_return_if_fail (!queued);
 
-      for (j = i + 1; j < NUM_EVENTS; j++)
+  /* keep the first occurrence of each event,
+   * compacting the array in place */
+  int num_kept = 0;
+  for (int i = 0; i < self->num_events; i++)
+    {
+      MidiEvent * ev = &self->events[i];
+      bool is_dup = false;
+      for (int j = 0; j < num_kept; j++)
         {
-          ev2 = &arr[j];
-
-          if (midi_events_are_equal (ev1, ev2))
+          if (midi_events_are_equal (
+                &self->events[j], ev))
             {
+              is_dup = true;
+              break;
+            }
+        }
+      if (is_dup)
+        {
 #if 0
-              g_message (
-                "removing duplicate MIDI event");
+          g_message (
+            "removing duplicate MIDI event");
 #endif
-              for (k = j; k < NUM_EVENTS; k++)
-                {
-                  midi_event_copy (
-                    &arr[k], &arr[k + 1]);
-                }
-              if (queued)
-                self->num_queued_events--;
-              else
-                self->num_events--;
-              j--;
-            }
+          continue;
+        }
+
+      if (num_kept != i)
+        {
+          midi_event_copy (
+            &self->events[num_kept], ev);
         }
+      num_kept++;
     }
+  self->num_events = num_kept;
 }
 
 /**
@@ -1072,7 +1393,21 @@ void
 midi_events_free (
   MidiEvents * self)
 {
-  zix_sem_destroy (&self->access_sem);
+  g_mutex_lock (&registry_mutex);
+  g_hash_table_remove (registry, self);
+  if (g_atomic_int_get (&self->needs_spares))
+    g_atomic_int_add (&num_needing_spares, -1);
+  g_mutex_unlock (&registry_mutex);
+
+  g_free (self->events);
+  g_free (self->long_data);
+  g_free (self->spare_events);
+  g_free (self->spare_long_data);
+  g_free (self->retired_events);
+  g_free (self->retired_long_data);
+  object_free_w_func_and_null (
+    zix_ring_free, self->queue);
+  zix_sem_destroy (&self->queue_sem);
 
   object_zero_and_free (self);
 }
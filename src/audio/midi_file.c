@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2020-2021 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2020-2022 Alexandros Theodotou <alex at zrythm dot org>
  *
  * This file is part of Zrythm
  *
@@ -17,66 +17,95 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "audio/midi_file.h"
+#include "audio/transport.h"
+#include "project.h"
+#include "utils/arrays.h"
+#include "utils/objects.h"
 
 #include <ext/midilib/src/midifile.h>
 
 #include <gtk/gtk.h>
 
 /**
- * Returns whether the given track in the midi file
- * has data.
+ * Returns the event type of the message.
  */
-bool
-midi_file_track_has_data (
-  const char * abs_path,
-  int          track_idx)
+static inline int
+get_msg_type (
+  MIDI_MSG * msg)
 {
-  MIDI_FILE * mf = midiFileOpen (abs_path);
-  g_return_val_if_fail (mf, false);
+  return
+    msg->bImpliedMsg ?
+      (int) msg->iImpliedMsg : (int) msg->iType;
+}
 
+/**
+ * Returns whether the event is considered data
+ * (ie, anything other than note offs and meta
+ * events).
+ */
+static inline bool
+is_data_msg_type (
+  int ev)
+{
+  switch (ev)
+    {
+    case msgNoteOn:
+    case msgNoteKeyPressure:
+    case msgSetParameter:
+    case msgSetProgram:
+    case msgChangePressure:
+    case msgSetPitchWheel:
+    case msgSysEx1:
+    case msgSysEx2:
+      return true;
+    default:
+      return false;
+    }
+}
+
+static bool
+track_has_data (
+  MIDI_FILE * mf,
+  int         track_idx)
+{
   MIDI_MSG msg;
   midiReadInitMessage (&msg);
 
-  int ev;
   g_debug ("reading MIDI Track %d", track_idx);
   bool have_data = false;
   while (midiReadGetNextMessage (
            mf, track_idx, &msg))
     {
-      if (msg.bImpliedMsg)
-        {
-          ev = msg.iImpliedMsg;
-        }
-      else
-        {
-          ev = msg.iType;
-        }
-
-      switch(ev)
+      if (is_data_msg_type (get_msg_type (&msg)))
         {
-        case msgNoteOff:
-        case msgMetaEvent:
-          break;
-        case msgNoteOn:
-        case msgNoteKeyPressure:
-        case msgSetParameter:
-        case msgSetProgram:
-        case msgChangePressure:
-        case msgSetPitchWheel:
-        case msgSysEx1:
-        case msgSysEx2:
           have_data = true;
           break;
         }
-
-      if (have_data)
-        {
-          break;
-        }
     }
 
   midiReadFreeMessage (&msg);
+
+  return have_data;
+}
+
+/**
+ * Returns whether the given track in the midi file
+ * has data.
+ */
+bool
+midi_file_track_has_data (
+  const char * abs_path,
+  int          track_idx)
+{
+  MIDI_FILE * mf = midiFileOpen (abs_path);
+  g_return_val_if_fail (mf, false);
+
+  bool have_data = track_has_data (mf, track_idx);
+
   midiFileClose (mf);
 
   return have_data;
@@ -105,9 +134,11 @@ midi_file_get_num_tracks (
     return num;
   }
 
+  /* each track is only read once so the same
+   * file instance can be used */
   for (int i = 0; i < num; i++)
     {
-      if (midi_file_track_has_data (abs_path, i))
+      if (track_has_data (mf, i))
         {
           actual_num++;
         }
@@ -117,3 +148,299 @@ midi_file_get_num_tracks (
 
   return actual_num;
 }
+
+/**
+ * Data shared by the track reading jobs.
+ */
+typedef struct TrackReadData
+{
+  /** File instance (each job only reads its own
+   * track). */
+  MIDI_FILE *    mf;
+
+  /** Zrythm ticks per MIDI file tick. */
+  double         ticks_per_file_tick;
+} TrackReadData;
+
+static void
+add_note (
+  MidiFileTrack * track,
+  double          ticks,
+  int             pitch,
+  int             vel)
+{
+  array_double_size_if_full (
+    track->notes, track->num_notes,
+    track->notes_size, MidiFileNote);
+  MidiFileNote * note =
+    &track->notes[track->num_notes++];
+  note->start_ticks = ticks;
+  note->end_ticks = -1.0;
+  note->pitch = (uint8_t) pitch;
+  note->vel = (uint8_t) vel;
+}
+
+/**
+ * Ends the oldest unended note with the given
+ * pitch.
+ */
+static void
+end_note (
+  MidiFileTrack * track,
+  int *           unended,
+  int *           num_unended,
+  double          ticks,
+  int             pitch)
+{
+  for (int i = 0; i < *num_unended; i++)
+    {
+      MidiFileNote * note =
+        &track->notes[unended[i]];
+      if (note->pitch != pitch)
+        continue;
+
+      note->end_ticks = ticks;
+      memmove (
+        &unended[i], &unended[i + 1],
+        (size_t) (*num_unended - i - 1)
+          * sizeof (int));
+      (*num_unended)--;
+      return;
+    }
+
+  g_message (
+    "Found a Note off event without a "
+    "corresponding Note on. Skipping...");
+}
+
+/**
+ * Reads a track in a worker thread.
+ */
+static void
+read_track_job_func (
+  gpointer data,
+  gpointer user_data)
+{
+  MidiFileTrack * track = (MidiFileTrack *) data;
+  TrackReadData * read_data =
+    (TrackReadData *) user_data;
+
+  MIDI_MSG msg;
+  midiReadInitMessage (&msg);
+
+  /* indices of the notes that were not ended
+   * yet, oldest first */
+  int * unended = NULL;
+  int num_unended = 0;
+  size_t unended_size = 0;
+
+  while (midiReadGetNextMessage (
+           read_data->mf, track->idx, &msg))
+    {
+      double ticks =
+        (double) msg.dwAbsPos *
+        read_data->ticks_per_file_tick;
+      track->last_ticks = ticks;
+
+      int ev = get_msg_type (&msg);
+      if (is_data_msg_type (ev))
+        track->has_data = true;
+
+      switch (ev)
+        {
+        case msgNoteOff:
+          end_note (
+            track, unended, &num_unended, ticks,
+            msg.MsgData.NoteOff.iNote);
+          break;
+        case msgNoteOn:
+          /* 0 velocity is a note off */
+          if (msg.MsgData.NoteOn.iVolume == 0)
+            {
+              end_note (
+                track, unended, &num_unended, ticks,
+                msg.MsgData.NoteOn.iNote);
+              break;
+            }
+
+          add_note (
+            track, ticks, msg.MsgData.NoteOn.iNote,
+            msg.MsgData.NoteOn.iVolume);
+          array_double_size_if_full (
+            unended, num_unended, unended_size,
+            int);
+          unended[num_unended++] =
+            track->num_notes - 1;
+          break;
+        case msgMetaEvent:
+          switch (msg.MsgData.MetaEvent.iType)
+            {
+            case metaTrackName:
+              if (msg.iMsgSize < 3)
+                break;
+              g_free (track->name);
+              track->name =
+                g_strndup (
+                  (char *)
+                  msg.MsgData.MetaEvent.Data.Text.
+                    pData,
+                  msg.iMsgSize - 3);
+              break;
+            case metaEndSequence:
+              track->end_ticks = ticks;
+              break;
+            default:
+              break;
+            }
+          break;
+        default:
+          break;
+        }
+    }
+
+  if (num_unended > 0)
+    {
+      g_message (
+        "track %d: unended notes found: %d",
+        track->idx, num_unended);
+    }
+
+  free (unended);
+  midiReadFreeMessage (&msg);
+}
+
+/**
+ * Reads all the tracks of the given MIDI file.
+ *
+ * The tracks are parsed in parallel in worker
+ * threads.
+ *
+ * @return The contents, or NULL if the file could
+ *   not be opened.
+ */
+MidiFile *
+midi_file_new (
+  const char * abs_path)
+{
+  MIDI_FILE * mf = midiFileOpen (abs_path);
+  g_return_val_if_fail (mf, NULL);
+
+  MidiFile * self = object_new (MidiFile);
+
+  TrackReadData read_data = {
+    .mf = mf,
+    .ticks_per_file_tick =
+      transport_get_ppqn (TRANSPORT) /
+        (double) midiFileGetPPQN (mf),
+  };
+
+  self->num_tracks = midiReadGetNumTracks (mf);
+  self->tracks =
+    object_new_n (
+      (size_t) self->num_tracks, MidiFileTrack);
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      MidiFileTrack * track = &self->tracks[i];
+      track->idx = i;
+      track->end_ticks = -1.0;
+    }
+
+  GThreadPool * pool = NULL;
+  if (self->num_tracks > 1)
+    {
+      GError * err = NULL;
+      pool =
+        g_thread_pool_new (
+          read_track_job_func, &read_data,
+          MIN (
+            (int) g_get_num_processors (),
+            self->num_tracks),
+          false, &err);
+      if (!pool)
+        {
+          g_warning (
+            "failed to create thread pool, "
+            "reading tracks sequentially: %s",
+            err->message);
+          g_error_free (err);
+        }
+    }
+
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      MidiFileTrack * track = &self->tracks[i];
+      if (pool)
+        {
+          g_thread_pool_push (pool, track, NULL);
+        }
+      else
+        {
+          read_track_job_func (track, &read_data);
+        }
+    }
+
+  if (pool)
+    {
+      /* wait for all the tracks */
+      g_thread_pool_free (pool, false, true);
+    }
+
+  midiFileClose (mf);
+
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      if (self->tracks[i].has_data)
+        self->num_nonempty_tracks++;
+    }
+
+  g_message (
+    "%s: read %d tracks (%d with data)",
+    abs_path, self->num_tracks,
+    self->num_nonempty_tracks);
+
+  return self;
+}
+
+/**
+ * Returns the track with data at the given index.
+ *
+ * @param idx The index of the track, starting from
+ *   0, counting only tracks with data. If idx 1 is
+ *   requested and the MIDI file only has data in
+ *   tracks 5 and 7, track 7 is returned.
+ */
+MidiFileTrack *
+midi_file_get_nonempty_track (
+  MidiFile * self,
+  int        idx)
+{
+  int cur_idx = 0;
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      MidiFileTrack * track = &self->tracks[i];
+      if (!track->has_data)
+        continue;
+
+      if (cur_idx == idx)
+        return track;
+
+      cur_idx++;
+    }
+
+  g_return_val_if_reached (NULL);
+}
+
+void
+midi_file_free (
+  MidiFile * self)
+{
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      MidiFileTrack * track = &self->tracks[i];
+      g_free (track->name);
+      free (track->notes);
+    }
+  g_free (self->tracks);
+
+  object_zero_and_free (self);
+}
@@ -298,45 +298,6 @@ apply_mapping (
     }
 }
 
-/**
- * Applies the events to the appropriate mapping.
- *
- * This is used only for TrackProcessor.cc_mappings.
- *
- * @note Must only be called while transport is
- *   recording.
- */
-void
-midi_mappings_apply_from_cc_events (
-  MidiMappings * self,
-  MidiEvents *   events,
-  bool           queued)
-{
-  /* queued not implemented yet */
-  g_return_if_fail (!queued);
-
-  for (int i = 0; i < events->num_events; i++)
-    {
-      MidiEvent * ev = &events->events[i];
-      if (ev->raw_buffer[0] >=
-            (midi_byte_t) MIDI_CH1_CTRL_CHANGE &&
-          ev->raw_buffer[0] <=
-            (midi_byte_t)
-            (MIDI_CH1_CTRL_CHANGE | 15))
-        {
-          midi_byte_t channel =
-            (midi_byte_t)
-            ((ev->raw_buffer[0] & 0xf) + 1);
-          midi_byte_t controller = ev->raw_buffer[1];
-          MidiMapping * mapping =
-            self->mappings[
-              (channel - 1) * 128 + controller];
-          apply_mapping (
-            mapping, ev->raw_buffer);
-        }
-    }
-}
-
 /**
  * Applies the given buffer to the matching ports.
  */
@@ -22,7 +22,9 @@
 #include "audio/midi_event.h"
 #include "audio/midi_note.h"
 #include "audio/position.h"
+#include "audio/region.h"
 #include "audio/track.h"
+#include "audio/tracklist.h"
 #include "audio/velocity.h"
 #include "gui/backend/midi_arranger_selections.h"
 #include "gui/widgets/arranger.h"
@@ -280,6 +282,44 @@ midi_note_set_cache_val (
   self->cache_val = val;
 }
 
+/**
+ * Sends a note off for the note if it is
+ * currently playing.
+ *
+ * @param region The region of the note, or NULL
+ *   to look it up.
+ */
+static void
+send_note_off_if_playing (
+  MidiNote * self,
+  ZRegion *  region)
+{
+  if (!midi_note_hit (self, PLAYHEAD->frames)
+      || !TRANSPORT_IS_ROLLING)
+    return;
+
+  if (!region)
+    {
+      region =
+        arranger_object_get_region (
+          (ArrangerObject *) self);
+    }
+  ArrangerObject * r_obj =
+    (ArrangerObject *) region;
+  g_return_if_fail (r_obj);
+  Track * track =
+    arranger_object_get_track (r_obj);
+  g_return_if_fail (track);
+
+  MidiEvents * midi_events =
+    track->processor->piano_roll->midi_events;
+
+  TrackLane * lane =
+    region_get_lane (region);
+  midi_events_add_note_off (
+    midi_events, lane->midi_ch, self->val, 0, 1);
+}
+
 /**
  * Sends a note off if currently playing and sets
  * the pitch of the MidiNote.
@@ -291,34 +331,74 @@ midi_note_set_val (
 {
   g_return_if_fail (val < 128);
 
-  /* if currently playing set a note off event. */
-  if (midi_note_hit (
-        midi_note, PLAYHEAD->frames) &&
-      TRANSPORT_IS_ROLLING)
-    {
-      ZRegion * region =
-        arranger_object_get_region (
-          (ArrangerObject *) midi_note);
-      ArrangerObject * r_obj =
-        (ArrangerObject *) region;
-      g_return_if_fail (r_obj);
-      Track * track =
-        arranger_object_get_track (r_obj);
-      g_return_if_fail (track);
-
-      MidiEvents * midi_events =
-        track->processor->piano_roll->midi_events;
-
-      zix_sem_wait (&midi_events->access_sem);
-      TrackLane * lane =
-        region_get_lane (region);
-      midi_events_add_note_off (
-        midi_events, lane->midi_ch,
-        midi_note->val, 0, 1);
-      zix_sem_post (&midi_events->access_sem);
-    }
+  send_note_off_if_playing (midi_note, NULL);
 
   midi_note->val = val;
+  midi_note_notify_changed (midi_note);
+}
+
+/**
+ * Sends a note off if currently playing and sets
+ * the pitch of a note of the given region.
+ *
+ * Unlike midi_note_set_val(), this does not look
+ * up the region or mark its notes as changed, so
+ * when changing many notes
+ * region_notes_changed() can be called once per
+ * region afterwards.
+ */
+void
+midi_note_set_val_in_region (
+  MidiNote *    self,
+  ZRegion *     region,
+  const uint8_t val)
+{
+  g_return_if_fail (val < 128);
+
+  send_note_off_if_playing (self, region);
+
+  self->val = val;
+}
+
+/**
+ * Marks the notes of the region the note belongs
+ * to as changed.
+ *
+ * Does nothing if the note is not in a region of
+ * the project (eg, clones in selections).
+ *
+ * @see region_notes_changed().
+ */
+void
+midi_note_notify_changed (
+  MidiNote * self)
+{
+  ArrangerObject * obj = (ArrangerObject *) self;
+  const RegionIdentifier * id = &obj->region_id;
+  if (!TRACKLIST || id->type != REGION_TYPE_MIDI)
+    return;
+
+  /* look up the region quietly instead of with
+   * region_find(), the note may not be in the
+   * project */
+  Track * track =
+    tracklist_find_track_by_name_hash (
+      TRACKLIST, id->track_name_hash);
+  if (!track || id->lane_pos < 0
+      || id->lane_pos >= track->num_lanes)
+    return;
+
+  TrackLane * lane = track->lanes[id->lane_pos];
+  if (id->idx < 0 || id->idx >= lane->num_regions)
+    return;
+
+  ZRegion * region = lane->regions[id->idx];
+  if (self->pos >= 0
+      && self->pos < region->num_midi_notes
+      && region->midi_notes[self->pos] == self)
+    {
+      region_notes_changed (region);
+    }
 }
 
 /**
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "audio/midi_event.h"
+#include "audio/midi_note.h"
+#include "audio/midi_note_columns.h"
+#include "audio/region.h"
+#include "audio/velocity.h"
+#include "gui/backend/arranger_object.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+
+typedef struct SortEntry
+{
+  signed_frame_t start_frames;
+  int            idx;
+} SortEntry;
+
+static int
+cmp_entries (
+  const void * a,
+  const void * b)
+{
+  const SortEntry * entry_a = (const SortEntry *) a;
+  const SortEntry * entry_b = (const SortEntry *) b;
+
+  /* keep the region order for notes starting at
+   * the same position */
+  if (entry_a->start_frames < entry_b->start_frames)
+    return -1;
+  else if (
+    entry_a->start_frames > entry_b->start_frames)
+    return 1;
+  else
+    return entry_a->idx - entry_b->idx;
+}
+
+/**
+ * Creates columns from the notes of the region.
+ *
+ * The positions of the notes must be up to date.
+ */
+MidiNoteColumns *
+midi_note_columns_new (
+  ZRegion * region)
+{
+  MidiNoteColumns * self =
+    object_new (MidiNoteColumns);
+
+  /* get the versions first so that changes made
+   * while building are noticed */
+  self->epoch =
+    g_atomic_int_get (&region->children_epoch);
+  self->notes_version =
+    g_atomic_int_get (&region->notes_version);
+
+  /* muted notes are not played */
+  int num_notes = 0;
+  for (int i = 0; i < region->num_midi_notes; i++)
+    {
+      if (!arranger_object_get_muted (
+             (ArrangerObject *)
+             region->midi_notes[i]))
+        num_notes++;
+    }
+
+  size_t size = (size_t) MAX (num_notes, 1);
+  self->start_frames =
+    object_new_n (size, signed_frame_t);
+  self->end_frames =
+    object_new_n (size, signed_frame_t);
+  self->max_end_frames =
+    object_new_n (size, signed_frame_t);
+  self->pitches = object_new_n (size, uint8_t);
+  self->vels = object_new_n (size, uint8_t);
+  self->num_notes = num_notes;
+
+  SortEntry * sorted =
+    object_new_n (size, SortEntry);
+  int j = 0;
+  for (int i = 0; i < region->num_midi_notes; i++)
+    {
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) region->midi_notes[i];
+      if (arranger_object_get_muted (mn_obj))
+        continue;
+
+      sorted[j].start_frames = mn_obj->pos.frames;
+      sorted[j].idx = i;
+      j++;
+    }
+  qsort (
+    sorted, (size_t) num_notes, sizeof (SortEntry),
+    cmp_entries);
+
+  signed_frame_t max_end = INT64_MIN;
+  for (int i = 0; i < num_notes; i++)
+    {
+      MidiNote * mn =
+        region->midi_notes[sorted[i].idx];
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) mn;
+      self->start_frames[i] = mn_obj->pos.frames;
+      self->end_frames[i] = mn_obj->end_pos.frames;
+      self->pitches[i] = mn->val;
+      self->vels[i] = mn->vel->vel;
+
+      max_end = MAX (max_end, self->end_frames[i]);
+      self->max_end_frames[i] = max_end;
+    }
+  free (sorted);
+
+  return self;
+}
+
+/**
+ * Returns whether the columns match the notes of
+ * the region.
+ *
+ * This is realtime-safe.
+ */
+bool
+midi_note_columns_is_up_to_date (
+  const MidiNoteColumns * self,
+  ZRegion *               region)
+{
+  return
+    self->epoch
+      == g_atomic_int_get (&region->children_epoch)
+    && self->notes_version
+         == g_atomic_int_get (
+              &region->notes_version);
+}
+
+/**
+ * Adds the note ons and note offs in the given
+ * range of local frames.
+ *
+ * This behaves exactly like going through the
+ * MidiNote's of the region.
+ *
+ * @param r_local_pos Region-local position at the
+ *   start of the range.
+ * @param local_offset Offset of the range in the
+ *   cycle.
+ */
+void
+midi_note_columns_fill_midi_events (
+  const MidiNoteColumns * self,
+  signed_frame_t          r_local_pos,
+  nframes_t               local_offset,
+  nframes_t               nframes,
+  midi_byte_t             channel,
+  MidiEvents *            midi_events)
+{
+  signed_frame_t range_end =
+    r_local_pos + (signed_frame_t) nframes;
+
+  /* first note that may end inside the range */
+  int lo = 0, hi = self->num_notes;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (self->max_end_frames[mid] < r_local_pos)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  /* notes that start after the range neither
+   * start nor end inside it */
+  for (int i = lo; i < self->num_notes; i++)
+    {
+      signed_frame_t start = self->start_frames[i];
+      if (start > range_end)
+        break;
+
+      /* if note starts inside the current range */
+      if (start >= 0 && start >= r_local_pos
+          && start < range_end)
+        {
+          midi_events_add_note_on (
+            midi_events, channel, self->pitches[i],
+            self->vels[i],
+            (midi_time_t)
+            (local_offset + (start - r_local_pos)),
+            F_NOT_QUEUED);
+        }
+
+      /* if note ends within the cycle */
+      signed_frame_t end = self->end_frames[i];
+      if (end >= r_local_pos && end <= range_end)
+        {
+          midi_time_t _time =
+            (midi_time_t)
+            (local_offset + (end - r_local_pos));
+
+          /* note actually ends 1 frame before
+           * the end point, not at the end
+           * point */
+          if (_time > 0)
+            {
+              _time--;
+            }
+
+          midi_events_add_note_off (
+            midi_events, channel, self->pitches[i],
+            _time, F_NOT_QUEUED);
+        }
+    }
+}
+
+void
+midi_note_columns_free (
+  MidiNoteColumns * self)
+{
+  free (self->start_frames);
+  free (self->end_frames);
+  free (self->max_end_frames);
+  free (self->pitches);
+  free (self->vels);
+
+  object_zero_and_free (self);
+}
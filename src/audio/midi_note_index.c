@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "audio/midi_note.h"
+#include "audio/midi_note_index.h"
+#include "audio/region.h"
+#include "utils/objects.h"
+
+MidiNoteIndex *
+midi_note_index_new (void)
+{
+  MidiNoteIndex * self =
+    object_new (MidiNoteIndex);
+
+  self->min_val = 127;
+  self->max_val = 0;
+
+  return self;
+}
+
+static void
+ensure_size (
+  MidiNoteIndex * self,
+  size_t          size)
+{
+  if (size <= self->notes_size)
+    return;
+
+  size_t new_size =
+    MAX (size, self->notes_size * 2);
+  self->notes =
+    object_realloc_n (
+      self->notes, self->notes_size, new_size,
+      MidiNote *);
+  self->sorted =
+    object_realloc_n (
+      self->sorted, self->notes_size, new_size,
+      MidiNoteIndexEntry);
+  self->subtree_max_ends =
+    object_realloc_n (
+      self->subtree_max_ends, self->notes_size,
+      new_size, double);
+  self->found =
+    object_realloc_n (
+      self->found, self->notes_size, new_size,
+      int);
+  self->notes_size = new_size;
+}
+
+static int
+cmp_entries (
+  const void * a,
+  const void * b)
+{
+  const MidiNoteIndexEntry * entry_a =
+    (const MidiNoteIndexEntry *) a;
+  const MidiNoteIndexEntry * entry_b =
+    (const MidiNoteIndexEntry *) b;
+
+  /* keep the region order for notes starting at
+   * the same position */
+  if (entry_a->start < entry_b->start)
+    return -1;
+  else if (entry_a->start > entry_b->start)
+    return 1;
+  else
+    return entry_a->idx - entry_b->idx;
+}
+
+static inline double
+get_end (
+  MidiNoteIndex * self,
+  int             sorted_idx)
+{
+  ArrangerObject * mn_obj =
+    (ArrangerObject *)
+    midi_note_index_get_note (self, sorted_idx);
+  return mn_obj->end_pos.ticks;
+}
+
+/**
+ * Calculates the maximum ends of the subtree of
+ * the sorted notes in [@p lo, @p hi).
+ *
+ * @return The maximum end of the subtree.
+ */
+static double
+build_subtree (
+  MidiNoteIndex * self,
+  int             lo,
+  int             hi)
+{
+  if (lo >= hi)
+    return - G_MAXDOUBLE;
+
+  int mid = lo + (hi - lo) / 2;
+  double max_end = get_end (self, mid);
+  max_end =
+    MAX (max_end, build_subtree (self, lo, mid));
+  max_end =
+    MAX (
+      max_end, build_subtree (self, mid + 1, hi));
+  self->subtree_max_ends[mid] = max_end;
+
+  return max_end;
+}
+
+static void
+rebuild (
+  MidiNoteIndex * self,
+  ZRegion *       region)
+{
+  int num_notes = region->num_midi_notes;
+  ensure_size (self, (size_t) num_notes);
+  self->num_notes = num_notes;
+  self->min_val = 127;
+  self->max_val = 0;
+  for (int i = 0; i < num_notes; i++)
+    {
+      MidiNote * mn = region->midi_notes[i];
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) mn;
+      self->notes[i] = mn;
+      self->sorted[i].start = mn_obj->pos.ticks;
+      self->sorted[i].idx = i;
+
+      if (mn->val < self->min_val)
+        self->min_val = mn->val;
+      if (mn->val > self->max_val)
+        self->max_val = mn->val;
+    }
+
+  qsort (
+    self->sorted, (size_t) num_notes,
+    sizeof (MidiNoteIndexEntry), cmp_entries);
+
+  build_subtree (self, 0, num_notes);
+}
+
+/**
+ * Rebuilds the index if the notes of the region
+ * changed since it was last built.
+ *
+ * @return Whether the index was rebuilt.
+ */
+bool
+midi_note_index_update (
+  MidiNoteIndex * self,
+  ZRegion *       region)
+{
+  gint notes_version =
+    g_atomic_int_get (&region->notes_version);
+  if (self->built
+      && self->notes_version == notes_version)
+    return false;
+
+  rebuild (self, region);
+  self->notes_version = notes_version;
+  self->built = true;
+
+  return true;
+}
+
+/**
+ * Adds the notes of the subtree of the sorted
+ * notes in [@p lo, @p hi) that overlap with the
+ * range to the found notes, in order.
+ */
+static void
+find_in_subtree (
+  MidiNoteIndex * self,
+  int             lo,
+  int             hi,
+  double          start_ticks,
+  double          end_ticks,
+  int *           num_found)
+{
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      /* all notes in the subtree end before the
+       * range */
+      if (self->subtree_max_ends[mid] < start_ticks)
+        return;
+
+      find_in_subtree (
+        self, lo, mid, start_ticks, end_ticks,
+        num_found);
+
+      /* this and the notes in the right subtree
+       * start after the range */
+      if (self->sorted[mid].start > end_ticks)
+        return;
+
+      if (get_end (self, mid) >= start_ticks)
+        {
+          self->found[(*num_found)++] = mid;
+        }
+
+      /* continue with the right subtree */
+      lo = mid + 1;
+    }
+}
+
+/**
+ * Finds the notes overlapping with the given
+ * range (inclusive).
+ *
+ * The sorted indices of the notes are stored in
+ * @ref MidiNoteIndex.found until the next call.
+ *
+ * @return The number of notes found.
+ */
+int
+midi_note_index_find (
+  MidiNoteIndex * self,
+  double          start_ticks,
+  double          end_ticks)
+{
+  int num_found = 0;
+  find_in_subtree (
+    self, 0, self->num_notes, start_ticks,
+    end_ticks, &num_found);
+
+  return num_found;
+}
+
+void
+midi_note_index_free (
+  MidiNoteIndex * self)
+{
+  free (self->notes);
+  free (self->sorted);
+  free (self->subtree_max_ends);
+  free (self->found);
+
+  object_zero_and_free (self);
+}
@@ -38,12 +38,16 @@
  */
 
 #include "audio/channel.h"
+#include "audio/engine.h"
 #include "audio/exporter.h"
 #include "audio/midi_event.h"
 #include "audio/midi_file.h"
 #include "audio/midi_note.h"
+#include "audio/midi_note_columns.h"
+#include "audio/midi_note_index.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
+#include "audio/tempo_map.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/backend/event.h"
@@ -179,12 +183,16 @@ midi_region_insert_midi_note (
   int        idx,
   int        pub_events)
 {
+  region_refresh_children_positions (self);
+
   array_double_size_if_full (
     self->midi_notes, self->num_midi_notes,
     self->midi_notes_size, MidiNote *);
   array_insert (
     self->midi_notes, self->num_midi_notes,
     idx, midi_note);
+  arranger_object_update_child_positions (
+    (ArrangerObject *) midi_note, self, true);
 
   for (int i = idx; i < self->num_midi_notes; i++)
     {
@@ -192,6 +200,7 @@ midi_region_insert_midi_note (
       midi_note_set_region_and_index (
         mn, self, i);
     }
+  region_notes_changed (self);
 
   if (pub_events)
     {
@@ -369,6 +378,7 @@ midi_region_remove_midi_note (
       midi_note_set_region_and_index (
         region->midi_notes[i], region, i);
     }
+  region_notes_changed (region);
 
   if (free)
     free_later (midi_note, arranger_object_free);
@@ -382,25 +392,35 @@ midi_region_remove_midi_note (
 }
 
 /**
- * Creates a MIDI region from the given MIDI
- * file path, starting at the given Position.
+ * Creates a MIDI region from the given track of a
+ * MIDI file, starting at the given Position.
  *
- * @param idx The index of this track, starting from
- *   0. This will be sequential, ie, if idx 1 is
- *   requested and the MIDI file only has tracks
- *   5 and 7, it will use track 7.
+ * All the notes are created at once without
+ * publishing any events.
+ *
+ * @return The region, or NULL if the track is
+ *   empty.
  */
 ZRegion *
-midi_region_new_from_midi_file (
-  const Position * start_pos,
-  const char *     abs_path,
-  unsigned int     track_name_hash,
-  int              lane_pos,
-  int              idx_inside_lane,
-  int              idx)
+midi_region_new_from_midi_file_track (
+  const Position *      start_pos,
+  const MidiFileTrack * track,
+  unsigned int          track_name_hash,
+  int                   lane_pos,
+  int                   idx_inside_lane)
 {
   g_message (
-    "%s: reading from %s...", __func__, abs_path);
+    "%s: creating region from MIDI track %d...",
+    __func__, track->idx);
+
+  /* this is an empty track */
+  if (track->end_ticks >= 0.0
+      &&
+      math_doubles_equal (
+        track->end_ticks, start_pos->ticks))
+    {
+      return NULL;
+    }
 
   ZRegion * self = object_new (ZRegion);
   ArrangerObject * r_obj =
@@ -408,373 +428,92 @@ midi_region_new_from_midi_file (
 
   self->id.type = REGION_TYPE_MIDI;
 
-  MIDI_FILE * mf =
-    midiFileOpen (abs_path);
-  g_return_val_if_fail (mf, NULL);
-
-  char str[128];
-  char txt[60000];
-  int ev;
-  MIDI_MSG msg;
-  unsigned int j;
-  Position pos, global_pos;
-  MidiNote * mn;
-  double ticks;
-
-  Position end_pos;
+  Position pos, end_pos;
   position_from_ticks (
     &end_pos, start_pos->ticks + 1);
   region_init (
     self, start_pos, &end_pos, track_name_hash,
     lane_pos, idx_inside_lane);
 
-  midiReadInitMessage (&msg);
-  int num_tracks = midiReadGetNumTracks (mf);
-  double ppqn = (double) midiFileGetPPQN (mf);
-  double transport_ppqn =
-    transport_get_ppqn (TRANSPORT);
-
-  int actual_iter = 0;
-
-  for (int i = 0; i < num_tracks; i++)
+  if (track->name)
     {
-      if (!midi_file_track_has_data (abs_path, i))
-        {
-          continue;
-        }
-
-      if (actual_iter != idx)
-        {
-          actual_iter++;
-          continue;
-        }
-
-      g_message (
-        "%s: reading MIDI Track %d", __func__, i);
-      g_return_val_if_fail (i < 1000, NULL);
-      while (midiReadGetNextMessage (mf, i, &msg))
-        {
-          /* convert time to zrythm time */
-          ticks =
-            ((double) msg.dwAbsPos * transport_ppqn) /
-            ppqn;
-          position_from_ticks (&pos, ticks);
-          position_from_ticks (
-            &global_pos,
-            r_obj->pos.ticks + ticks);
-          g_debug (
-            "dwAbsPos: %d ", msg.dwAbsPos);
-
-          int bars = position_get_bars (&pos, true);
-          if (ZRYTHM_HAVE_UI &&
-              bars > TRANSPORT->total_bars -8)
-            {
-              transport_update_total_bars (
-                TRANSPORT, bars + 8,
-                F_PUBLISH_EVENTS);
-            }
-
-          if (msg.bImpliedMsg)
-            {
-              ev = msg.iImpliedMsg;
-            }
-          else
-            {
-              ev = msg.iType;
-            }
-
-          if (muGetMIDIMsgName (str, ev))
-            {
-              g_debug ("MIDI msg name: %s", str);
-            }
-          switch(ev)
-            {
-            case msgNoteOff:
-handle_note_off:
-              g_debug (
-                "Note off at %d "
-                "[ch %d pitch %d]",
-                msg.dwAbsPos,
-                msg.MsgData.NoteOff.iChannel,
-                msg.MsgData.NoteOff.iNote);
-              mn =
-                midi_region_pop_unended_note (
-                  self, msg.MsgData.NoteOff.iNote);
-              if (mn)
-                {
-                  arranger_object_end_pos_setter (
-                    (ArrangerObject *) mn,  &pos);
-                }
-              else
-                {
-                  g_message (
-                    "Found a Note off event without "
-                    "a corresponding Note on. "
-                    "Skipping...");
-                }
-              break;
-            case msgNoteOn:
-              /* 0 velocity is a note off */
-              if (msg.MsgData.NoteOn.iVolume == 0)
-                {
-                  msg.MsgData.NoteOff.iChannel =
-                    msg.MsgData.NoteOn.iChannel;
-                  msg.MsgData.NoteOff.iNote =
-                    msg.MsgData.NoteOn.iNote;
-                  goto handle_note_off;
-                }
-
-              g_debug (
-                "Note on at %d "
-                "[ch %d pitch %d vel %d]",
-                msg.dwAbsPos,
-                msg.MsgData.NoteOn.iChannel,
-                msg.MsgData.NoteOn.iNote,
-                msg.MsgData.NoteOn.iVolume);
-              midi_region_start_unended_note (
-                self, &pos, NULL,
-                msg.MsgData.NoteOn.iNote,
-                msg.MsgData.NoteOn.iVolume, 0);
-              break;
-            case  msgNoteKeyPressure:
-              muGetNameFromNote (
-                str,
-                msg.MsgData.NoteKeyPressure.iNote);
-              g_debug (
-                "(%.2d) %s %d",
-                msg.MsgData.NoteKeyPressure.
-                  iChannel,
-                str,
-                msg.MsgData.NoteKeyPressure.
-                  iPressure);
-              break;
-            case  msgSetParameter:
-              muGetControlName (
-                str,
-                msg.MsgData.NoteParameter.iControl);
-              g_debug (
-                "(%.2d) %s -> %d",
-                msg.MsgData.NoteParameter.iChannel,
-                str,
-                msg.MsgData.NoteParameter.iParam);
-              break;
-            case  msgSetProgram:
-              muGetInstrumentName (
-                str,
-                msg.MsgData.ChangeProgram.iProgram);
-              g_debug (
-                "(%.2d) %s",
-                msg.MsgData.ChangeProgram.iChannel,
-                str);
-              break;
-            case msgChangePressure:
-              muGetControlName (
-                str,
-                msg.MsgData.ChangePressure.
-                  iPressure);
-              g_debug (
-                "(%.2d) %s",
-                msg.MsgData.ChangePressure.iChannel,
-                str);
-              break;
-            case msgSetPitchWheel:
-              g_debug (
-                "(%.2d) %d",
-                msg.MsgData.PitchWheel.iChannel,
-                msg.MsgData.PitchWheel.iPitch);
-              break;
-            case msgMetaEvent:
-              g_debug ("---- meta events");
-              switch(msg.MsgData.MetaEvent.iType)
-                {
-                case metaMIDIPort:
-                  g_debug (
-                    "MIDI Port = %d",
-                    msg.MsgData.MetaEvent.Data.
-                      iMIDIPort);
-                  break;
-                case metaSequenceNumber:
-                  g_debug (
-                    "Sequence Number = %d",
-                    msg.MsgData.MetaEvent.Data.
-                      iSequenceNumber);
-                  break;
-                case  metaTextEvent:
-                  g_debug (
-                    "Text = '%s'",
-                    msg.MsgData.MetaEvent.Data.Text.
-                      pData);
-                  break;
-                case  metaCopyright:
-                  g_debug (
-                    "Copyright = '%s'",
-                    msg.MsgData.MetaEvent.Data.Text.
-                      pData);
-                  break;
-                case  metaTrackName:
-                  {
-                    char tmp[6000];
-                    strncpy (
-                      tmp,
-                      (char *) msg.MsgData.MetaEvent.Data.
-                        Text.pData,
-                      msg.iMsgSize - 3);
-                    tmp[msg.iMsgSize - 3] = '\0';
-                    arranger_object_set_name (
-                      (ArrangerObject *) self,
-                      tmp, F_NO_PUBLISH_EVENTS);
-                    g_warn_if_fail (self->name);
-                    g_message (
-                      "[data sz %d] Track name = '%s'",
-                      msg.iMsgSize - 3, self->name);
-                  }
-                  break;
-                case  metaInstrument:
-                  g_message (
-                    "Instrument = '%s'",
-                    msg.MsgData.MetaEvent.Data.Text.
-                      pData);
-                  break;
-                case  metaLyric:
-                  g_message (
-                    "Lyric = '%s'",
-                    msg.MsgData.MetaEvent.
-                      Data.Text.pData);
-                  break;
-                case  metaMarker:
-                  g_message (
-                    "Marker = '%s'",
-                    msg.MsgData.MetaEvent.
-                      Data.Text.pData);
-                  break;
-                case  metaCuePoint:
-                  g_message (
-                    "Cue point = '%s'",
-                    msg.MsgData.MetaEvent.
-                      Data.Text.pData);
-                  break;
-                case  metaEndSequence:
-                  g_message ("End Sequence");
-                  if (position_is_equal (
-                        &pos, start_pos))
-                    {
-                       /* this is an empty track,
-                        * so return NULL
-                       * instead */
-                      return NULL;
-                    }
-                  arranger_object_end_pos_setter (
-                    r_obj, &global_pos);
-                  arranger_object_loop_end_pos_setter (
-                    r_obj, &global_pos);
-                  break;
-                case  metaSetTempo:
-                  g_message (
-                    "tempo %d",
-                    msg.MsgData.MetaEvent.Data.
-                      Tempo.iBPM);
-                  break;
-                case  metaSMPTEOffset:
-                  g_message (
-                    "SMPTE offset = %d:%d:%d.%d %d",
-                    msg.MsgData.MetaEvent.Data.
-                      SMPTE.iHours,
-                    msg.MsgData.MetaEvent.Data.
-                      SMPTE.iMins,
-                    msg.MsgData.MetaEvent.Data.
-                      SMPTE.iSecs,
-                    msg.MsgData.MetaEvent.Data.
-                      SMPTE.iFrames,
-                    msg.MsgData.MetaEvent.Data.
-                      SMPTE.iFF);
-                  break;
-                case metaTimeSig:
-                  g_message (
-                    "Time sig = %d/%d",
-                    msg.MsgData.MetaEvent.Data.
-                      TimeSig.iNom,
-                    msg.MsgData.MetaEvent.Data.
-                      TimeSig.iDenom /
-                      MIDI_NOTE_CROCHET);
-                  break;
-                case metaKeySig:
-                  if (muGetKeySigName (
-                        str,
-                        msg.MsgData.MetaEvent.
-                          Data.KeySig.iKey))
-                    g_message("Key sig = %s", str);
-                  break;
-                case  metaSequencerSpecific:
-                  g_message("Sequencer specific = ");
-                  /*HexList(msg.MsgData.MetaEvent.Data.Sequencer.pData, msg.MsgData.MetaEvent.Data.Sequencer.iSize);*/
-                  break;
-                }
-              break;
-
-            case msgSysEx1:
-            case msgSysEx2:
-              g_message("Sysex = ");
-              /*HexList(msg.MsgData.SysEx.pData, msg.MsgData.SysEx.iSize);*/
-              break;
-            }
+      arranger_object_set_name (
+        r_obj, track->name, F_NO_PUBLISH_EVENTS);
+      g_warn_if_fail (self->name);
+    }
 
-          /* print the hex */
-          if (ev == msgSysEx1 ||
-              (ev==msgMetaEvent &&
-               msg.MsgData.MetaEvent.iType ==
-                 metaSequencerSpecific))
-            {
-            /* Already done a hex dump */
-            }
-          else
-            {
-              char tmp[100];
-              strcpy (txt, "[");
-              if (msg.bImpliedMsg)
-                {
-                  sprintf (
-                    tmp, "%.2x!", msg.iImpliedMsg);
-                  strcat (txt, tmp);
-                }
-              for (j = 0; j < msg.iMsgSize; j++)
-                {
-                  sprintf(
-                    tmp, " %.2x ", msg.data[j]);
-                  strcat (txt, tmp);
-                }
-              strcat (txt, "]");
-              g_debug ("%s", txt);
-            }
-        }
+  if (track->end_ticks >= 0.0)
+    {
+      position_from_ticks (
+        &end_pos,
+        r_obj->pos.ticks + track->end_ticks);
+      arranger_object_end_pos_setter (
+        r_obj, &end_pos);
+      arranger_object_loop_end_pos_setter (
+        r_obj, &end_pos);
+    }
 
-      if (actual_iter == idx)
+  if (ZRYTHM_HAVE_UI)
+    {
+      position_from_ticks (
+        &pos, track->last_ticks);
+      int bars = position_get_bars (&pos, true);
+      if (bars > TRANSPORT->total_bars - 8)
         {
-          break;
+          transport_update_total_bars (
+            TRANSPORT, bars + 8,
+            F_PUBLISH_EVENTS);
         }
     }
 
-  midiReadFreeMessage (&msg);
-  midiFileClose (mf);
-
-  if (self->num_unended_notes != 0)
+  /* notes that were never ended last until the
+   * end of the region */
+  double length_ticks =
+    arranger_object_get_length_in_ticks (r_obj);
+
+  /* get the tempo map epoch before converting the
+   * positions so that tempo changes made in the
+   * meantime are noticed */
+  gint epoch =
+    AUDIO_ENGINE && AUDIO_ENGINE->tempo_map
+    ? tempo_map_get_epoch (AUDIO_ENGINE->tempo_map)
+    : -1;
+
+  /* add all the notes at once (they are already
+   * sorted by start position) */
+  self->midi_notes =
+    object_new_n (
+      (size_t) MAX (track->num_notes, 1),
+      MidiNote *);
+  self->midi_notes_size =
+    (size_t) MAX (track->num_notes, 1);
+  for (int i = 0; i < track->num_notes; i++)
     {
-      g_warning (
-        "unended notes found: %d",
-        self->num_unended_notes);
-
-      double length =
-        arranger_object_get_length_in_ticks (
-          (ArrangerObject *) self);
-      position_from_ticks (&end_pos, length);
+      const MidiFileNote * note =
+        &track->notes[i];
+      position_from_ticks (
+        &pos, note->start_ticks);
+      position_from_ticks (
+        &end_pos,
+        note->end_ticks >= 0.0 ?
+          note->end_ticks : length_ticks);
+      MidiNote * mn =
+        midi_note_new (
+          &self->id, &pos, &end_pos, note->pitch,
+          note->vel);
+      midi_note_set_region_and_index (
+        mn, self, i);
 
-      while (self->num_unended_notes > 0)
-        {
-          mn =
-            midi_region_pop_unended_note (self, -1);
-          arranger_object_end_pos_setter (
-            (ArrangerObject *) mn,  &end_pos);
-        }
+      /* the note positions are relative to the
+       * region start, which matters when the tempo
+       * is automated */
+      arranger_object_update_child_positions (
+        (ArrangerObject *) mn, self, true);
+      self->midi_notes[i] = mn;
     }
+  self->num_midi_notes = track->num_notes;
+  g_atomic_int_set (&self->children_epoch, epoch);
+  region_notes_changed (self);
 
   g_return_val_if_fail (
     position_is_before (
@@ -787,6 +526,46 @@ handle_note_off:
   return self;
 }
 
+/**
+ * Creates a MIDI region from the given MIDI
+ * file path, starting at the given Position.
+ *
+ * @param idx The index of this track, starting from
+ *   0. This will be sequential, ie, if idx 1 is
+ *   requested and the MIDI file only has tracks
+ *   5 and 7, it will use track 7.
+ */
+ZRegion *
+midi_region_new_from_midi_file (
+  const Position * start_pos,
+  const char *     abs_path,
+  unsigned int     track_name_hash,
+  int              lane_pos,
+  int              idx_inside_lane,
+  int              idx)
+{
+  g_message (
+    "%s: reading from %s...", __func__, abs_path);
+
+  MidiFile * mf = midi_file_new (abs_path);
+  g_return_val_if_fail (mf, NULL);
+
+  ZRegion * self = NULL;
+  MidiFileTrack * track =
+    midi_file_get_nonempty_track (mf, idx);
+  if (track)
+    {
+      self =
+        midi_region_new_from_midi_file_track (
+          start_pos, track, track_name_hash,
+          lane_pos, idx_inside_lane);
+    }
+
+  midi_file_free (mf);
+
+  return self;
+}
+
 /**
  * Starts an unended note with the given pitch and
  * velocity and adds it to \ref ZRegion.midi_notes.
@@ -1041,14 +820,11 @@ send_notes_off_at (
     }
 
   midi_events_add_all_notes_off (
-    midi_events, channel, time, F_QUEUED);
+    midi_events, channel, time, F_NOT_QUEUED);
 }
 
 /**
- * Fills MIDI event queue from the region.
- *
- * The events are dequeued right after the call to
- * this function.
+ * Fills MIDI events from the region.
  *
  * @note The caller already splits calls to this
  *   function at each sub-loop inside the region,
@@ -1073,6 +849,8 @@ midi_region_fill_midi_events (
   Track * track = arranger_object_get_track (r_obj);
   g_return_if_fail (IS_TRACK_AND_NONNULL (track));
 
+  region_refresh_children_positions (self);
+
   /* send all MIDI notes off if needed */
   if (note_off_at_end)
     {
@@ -1104,6 +882,28 @@ midi_region_fill_midi_events (
     }
 #endif
 
+  /* use the note columns if they match the
+   * current notes and positions */
+  if (track->type != TRACK_TYPE_CHORD)
+    {
+      const MidiNoteColumns * columns =
+        (const MidiNoteColumns *)
+        g_atomic_pointer_get (&self->note_columns);
+      if (columns
+          &&
+          midi_note_columns_is_up_to_date (
+            columns, self))
+        {
+          midi_note_columns_fill_midi_events (
+            columns, r_local_pos,
+            time_nfo->local_offset,
+            time_nfo->nframes,
+            midi_region_get_midi_ch (self),
+            midi_events);
+          return;
+        }
+    }
+
   /* go through each note */
   int num_objs =
     track->type == TRACK_TYPE_CHORD ?
@@ -1132,17 +932,23 @@ midi_region_fill_midi_events (
           continue;
         }
 
+      /* the frames may not be refreshed yet after
+       * a tempo change */
+      signed_frame_t mn_obj_start_frames =
+        region_get_child_frames (
+          self, &mn_obj->pos);
+
       /* if object starts inside the current
        * range */
-      if (mn_obj->pos.frames >= 0 &&
-          mn_obj->pos.frames >= r_local_pos &&
-          mn_obj->pos.frames <
+      if (mn_obj_start_frames >= 0 &&
+          mn_obj_start_frames >= r_local_pos &&
+          mn_obj_start_frames <
             r_local_pos + (signed_frame_t) time_nfo->nframes)
         {
           midi_time_t _time =
             (midi_time_t)
             (time_nfo->local_offset +
-              (mn_obj->pos.frames - r_local_pos));
+              (mn_obj_start_frames - r_local_pos));
           /*g_message ("normal note on at %u", time);*/
 
           if (mn)
@@ -1151,14 +957,14 @@ midi_region_fill_midi_events (
                 midi_events,
                 midi_region_get_midi_ch (self),
                 mn->val, mn->vel->vel,
-                _time, F_QUEUED);
+                _time, F_NOT_QUEUED);
             }
           else if (co)
             {
               midi_events_add_note_ons_from_chord_descr (
                 midi_events, descr, 1,
                 VELOCITY_DEFAULT, _time,
-                F_QUEUED);
+                F_NOT_QUEUED);
             }
         }
 
@@ -1166,10 +972,12 @@ midi_region_fill_midi_events (
         (track->type == TRACK_TYPE_CHORD
          ?
          math_round_double_to_signed_frame_t (
-           mn_obj->pos.frames +
+           mn_obj_start_frames +
              TRANSPORT->ticks_per_beat *
              AUDIO_ENGINE->frames_per_tick)
-         : mn_obj->end_pos.frames);
+         :
+         region_get_child_frames (
+           self, &mn_obj->end_pos));
 
       /* if note ends within the cycle */
       if (mn_obj_end_frames >= r_local_pos &&
@@ -1204,7 +1012,7 @@ midi_region_fill_midi_events (
               midi_events_add_note_off (
                 midi_events,
                 midi_region_get_midi_ch (self),
-                mn->val, _time, F_QUEUED);
+                mn->val, _time, F_NOT_QUEUED);
             }
           else if (co)
             {
@@ -1216,7 +1024,7 @@ midi_region_fill_midi_events (
                     {
                       midi_events_add_note_off (
                         midi_events, 1, l + 36,
-                        _time, F_QUEUED);
+                        _time, F_NOT_QUEUED);
                     }
                 }
             }
@@ -1276,6 +1084,71 @@ midi_region_get_velocities_in_range (
     }
 }
 
+/**
+ * Returns the index of the notes of the region,
+ * rebuilt if the notes changed.
+ *
+ * @see midi_note_index_update().
+ */
+MidiNoteIndex *
+midi_region_get_note_index (
+  ZRegion * self)
+{
+  if (!self->note_index)
+    {
+      self->note_index = midi_note_index_new ();
+    }
+  midi_note_index_update (
+    self->note_index, self);
+
+  return self->note_index;
+}
+
+/**
+ * Replaces the note columns of the region if
+ * they don't match its notes anymore.
+ *
+ * Regions whose children positions are outdated
+ * after a tempo change are skipped, since the
+ * engine refreshes them a few tracks at a time
+ * and converts their ticks until then.
+ *
+ * Must not be called from the realtime thread.
+ *
+ * @return Whether the columns were replaced.
+ */
+bool
+midi_region_update_note_columns (
+  ZRegion * self)
+{
+  if (AUDIO_ENGINE
+      && AUDIO_ENGINE->tempo_map
+      &&
+      g_atomic_int_get (&self->children_epoch)
+        != tempo_map_get_epoch (
+             AUDIO_ENGINE->tempo_map))
+    return false;
+
+  MidiNoteColumns * prev =
+    (MidiNoteColumns *)
+    g_atomic_pointer_get (&self->note_columns);
+  if (prev
+      && midi_note_columns_is_up_to_date (prev, self))
+    return false;
+
+  g_atomic_pointer_set (
+    &self->note_columns,
+    midi_note_columns_new (self));
+
+  /* the engine may still be reading them */
+  if (prev)
+    {
+      free_later (prev, midi_note_columns_free);
+    }
+
+  return true;
+}
+
 /**
  * Frees members only but not the MidiRegion
  * itself.
@@ -1292,4 +1165,17 @@ midi_region_free_members (ZRegion * self)
       arranger_object_free (
         (ArrangerObject *) self->midi_notes[i]);
     }
+
+  object_free_w_func_and_null (
+    midi_note_columns_free, self->note_columns);
+  object_free_w_func_and_null (
+    midi_note_index_free, self->note_index);
+  for (int i = 0;
+       i < (int) G_N_ELEMENTS (self->notes_rasters);
+       i++)
+    {
+      object_free_w_func_and_null (
+        g_object_unref,
+        self->notes_rasters[i].texture);
+    }
 }
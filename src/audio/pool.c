@@ -18,9 +18,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "actions/undo_manager.h"
 #include "audio/clip.h"
+#include "audio/clip_cache.h"
 #include "audio/pool.h"
 #include "audio/track.h"
 #include "audio/tracklist.h"
@@ -32,24 +34,199 @@
 #include "utils/mem.h"
 #include "utils/objects.h"
 #include "utils/string.h"
+#include "zrythm.h"
+#include "zrythm_app.h"
 
 #include <gtk/gtk.h>
+#include <glib/gi18n.h>
+
+/**
+ * State shared by the clip loading jobs.
+ */
+typedef struct ClipLoadData
+{
+  char *  cache_dir;
+  int     samplerate;
+
+  /** Number of clips loaded so far. */
+  int     num_done;
+
+  GMutex  lock;
+  GCond   cond;
+} ClipLoadData;
+
+typedef struct ClipLoadJob
+{
+  AudioClip * clip;
+
+  /** Path of the clip's file in the pool. */
+  char *      filepath;
+} ClipLoadJob;
+
+/**
+ * Decodes (or fetches from the cache) a clip in a
+ * worker thread.
+ */
+static void
+load_clip_job_func (
+  gpointer data,
+  gpointer user_data)
+{
+  ClipLoadJob *  job = (ClipLoadJob *) data;
+  ClipLoadData * load_data =
+    (ClipLoadData *) user_data;
+
+  audio_clip_load_frames_from_file (
+    job->clip, job->filepath,
+    load_data->samplerate, load_data->cache_dir);
+
+  g_mutex_lock (&load_data->lock);
+  load_data->num_done++;
+  g_cond_signal (&load_data->cond);
+  g_mutex_unlock (&load_data->lock);
+}
+
+static void
+report_load_progress (
+  int num_done,
+  int num_total)
+{
+  char str[600];
+  sprintf (
+    str, _("Loading audio clips (%d/%d)"),
+    num_done, num_total);
+  if (ZRYTHM_HAVE_UI && zrythm_app)
+    {
+      zrythm_app_set_progress_status (
+        zrythm_app, str, ZRYTHM->progress);
+    }
+  else
+    {
+      g_message ("%s", str);
+    }
+}
 
 /**
  * Inits after loading a project.
+ *
+ * The clips are decoded and resampled in parallel
+ * in worker threads, or taken from the resampled
+ * clip cache if they were already loaded at the
+ * current sample rate.
  */
 void
 audio_pool_init_loaded (
   AudioPool * self)
 {
   self->clips_size = (size_t) self->num_clips;
-
+  self->block_store = audio_clip_block_store_new ();
+
+  ClipLoadData load_data;
+  memset (&load_data, 0, sizeof (load_data));
+  load_data.cache_dir = audio_clip_cache_get_dir ();
+  load_data.samplerate =
+    (int) AUDIO_ENGINE->sample_rate;
+  g_mutex_init (&load_data.lock);
+  g_cond_init (&load_data.cond);
+
+  /* prepare the jobs (this accesses the project
+   * so it must be done here) */
+  GPtrArray * jobs =
+    g_ptr_array_new_with_free_func (g_free);
   for (int i = 0; i < self->num_clips; i++)
     {
       AudioClip * clip = self->clips[i];
-      if (clip)
-        audio_clip_init_loaded (clip);
+      if (!clip)
+        continue;
+
+      ClipLoadJob * job = object_new (ClipLoadJob);
+      job->clip = clip;
+      job->filepath =
+        audio_clip_get_path_in_pool_from_name (
+          clip->name, clip->use_flac,
+          F_NOT_BACKUP);
+      g_ptr_array_add (jobs, job);
     }
+  int num_jobs = (int) jobs->len;
+
+  GThreadPool * pool = NULL;
+  if (num_jobs > 1)
+    {
+      GError * err = NULL;
+      pool =
+        g_thread_pool_new (
+          load_clip_job_func, &load_data,
+          MIN (
+            (int) g_get_num_processors (),
+            num_jobs),
+          false, &err);
+      if (!pool)
+        {
+          g_warning (
+            "failed to create thread pool, "
+            "loading clips sequentially: %s",
+            err->message);
+          g_error_free (err);
+        }
+    }
+
+  for (int i = 0; i < num_jobs; i++)
+    {
+      ClipLoadJob * job =
+        g_ptr_array_index (jobs, i);
+      if (pool)
+        {
+          g_thread_pool_push (pool, job, NULL);
+        }
+      else
+        {
+          load_clip_job_func (job, &load_data);
+          report_load_progress (i + 1, num_jobs);
+        }
+    }
+
+  if (pool)
+    {
+      /* wait for the workers, reporting progress
+       * as clips get loaded */
+      g_mutex_lock (&load_data.lock);
+      int num_reported = 0;
+      while (num_reported < num_jobs)
+        {
+          while (load_data.num_done == num_reported)
+            {
+              g_cond_wait (
+                &load_data.cond, &load_data.lock);
+            }
+          num_reported = load_data.num_done;
+          g_mutex_unlock (&load_data.lock);
+          report_load_progress (
+            num_reported, num_jobs);
+          g_mutex_lock (&load_data.lock);
+        }
+      g_mutex_unlock (&load_data.lock);
+
+      g_thread_pool_free (pool, false, true);
+    }
+
+  for (int i = 0; i < num_jobs; i++)
+    {
+      ClipLoadJob * job =
+        g_ptr_array_index (jobs, i);
+      g_free (job->filepath);
+    }
+  g_ptr_array_unref (jobs);
+
+  if (num_jobs > 0)
+    {
+      audio_clip_cache_prune (
+        load_data.cache_dir,
+        AUDIO_CLIP_CACHE_MAX_BYTES);
+    }
+
+  g_free (load_data.cache_dir);
+  g_mutex_clear (&load_data.lock);
+  g_cond_clear (&load_data.cond);
 }
 
 /**
@@ -66,6 +243,8 @@ audio_pool_new ()
   self->clips =
     object_new_n (self->clips_size, AudioClip *);
 
+  self->block_store = audio_clip_block_store_new ();
+
   return self;
 }
 
@@ -264,10 +443,29 @@ audio_pool_duplicate_clip (
     audio_pool_get_clip (self, clip_id);
   g_return_val_if_fail (clip, -1);
 
-  AudioClip * new_clip =
-    audio_clip_new_from_float_array (
-      clip->frames, clip->num_frames, clip->channels,
-      clip->bit_depth, clip->name);
+  AudioClip * new_clip;
+  if (clip->blocks || clip->stream_path)
+    {
+      float * frames =
+        object_new_n (
+          (size_t) clip->num_frames * clip->channels,
+          float);
+      audio_clip_copy_frames (
+        clip, frames, 0, clip->num_frames);
+      new_clip =
+        audio_clip_new_from_float_array (
+          frames, clip->num_frames, clip->channels,
+          clip->bit_depth, clip->name);
+      free (frames);
+    }
+  else
+    {
+      new_clip =
+        audio_clip_new_from_float_array (
+          clip->frames, clip->num_frames,
+          clip->channels, clip->bit_depth,
+          clip->name);
+    }
   audio_pool_add_clip (self, new_clip);
 
   g_message (
@@ -419,42 +617,6 @@ audio_pool_remove_unused (
     removed_clips);
 }
 
-/**
- * Loads the frame buffers of clips currently in
- * use in the project from their files and frees the
- * buffers of clips not currently in use.
- *
- * This should be called whenever there is a relevant
- * change in the project (eg, object added/removed).
- */
-void
-audio_pool_reload_clip_frame_bufs (
-  AudioPool * self)
-{
-  for (int i = 0; i < self->num_clips; i++)
-    {
-      AudioClip * clip = self->clips[i];
-      if (!clip)
-        continue;
-
-      bool in_use =
-        audio_clip_is_in_use (clip, false);
-
-      if (in_use && clip->num_frames == 0)
-        {
-          /* load from the file */
-          audio_clip_init_loaded (clip);
-        }
-      else if (!in_use && clip->num_frames > 0)
-        {
-          /* unload frames */
-          clip->num_frames = 0;
-          free (clip->frames);
-          clip->frames = NULL;
-        }
-    }
-}
-
 /**
  * Writes all the clips to disk.
  *
@@ -518,6 +680,80 @@ audio_pool_print (
   g_free (str);
 }
 
+/**
+ * Fills in the memory used by the clips in the
+ * pool.
+ *
+ * @note This walks the undo history and must be
+ *   called from the main thread.
+ */
+void
+audio_pool_get_memory_usage (
+  AudioPool *            self,
+  AudioPoolMemoryUsage * usage)
+{
+  object_set_to_zero (usage);
+
+  for (int i = 0; i < self->num_clips; i++)
+    {
+      AudioClip * clip = self->clips[i];
+      if (!clip)
+        continue;
+
+      size_t bytes =
+        audio_clip_get_resident_bytes (clip);
+      if (bytes == 0)
+        continue;
+
+      if (audio_clip_is_in_use (clip, false))
+        usage->project_bytes += bytes;
+      else
+        usage->undo_bytes += bytes;
+    }
+
+  if (self->block_store)
+    {
+      usage->block_bytes =
+        self->block_store->allocated_bytes;
+      usage->block_referenced_bytes =
+        self->block_store->referenced_bytes;
+    }
+}
+
+/**
+ * Returns a newly allocated human-readable summary
+ * of the memory used by the pool.
+ */
+char *
+audio_pool_get_memory_usage_as_string (
+  AudioPool * self)
+{
+  AudioPoolMemoryUsage usage;
+  audio_pool_get_memory_usage (self, &usage);
+
+  char * project_str =
+    g_format_size (usage.project_bytes);
+  char * undo_str =
+    g_format_size (
+      usage.undo_bytes + usage.block_bytes);
+  char * block_str =
+    g_format_size (usage.block_bytes);
+  char * block_ref_str =
+    g_format_size (usage.block_referenced_bytes);
+  char * ret =
+    g_strdup_printf (
+      "project clips: %s, undo history clips: %s "
+      "(shared blocks: %s for %s of audio)",
+      project_str, undo_str, block_str,
+      block_ref_str);
+  g_free (project_str);
+  g_free (undo_str);
+  g_free (block_str);
+  g_free (block_ref_str);
+
+  return ret;
+}
+
 /**
  * To be used during serialization.
  */
@@ -553,5 +789,9 @@ audio_pool_free (
     }
   object_zero_and_free (self->clips);
 
+  /* must be freed after the clips */
+  object_free_w_func_and_null (
+    audio_clip_block_store_free, self->block_store);
+
   object_zero_and_free (self);
 }
@@ -39,6 +39,7 @@
 #include "audio/rtaudio_device.h"
 #include "audio/rtmidi_device.h"
 #include "audio/tempo_track.h"
+#include "audio/track_processor.h"
 #include "audio/windows_mme_device.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
@@ -65,6 +66,38 @@
 
 #define AUDIO_RING_SIZE 65536
 
+/**
+ * Creates the ring buffers used by the UI, if not
+ * already created.
+ */
+static void
+create_rings (
+  Port * self)
+{
+  switch (self->id.type)
+    {
+    case TYPE_EVENT:
+      if (!self->midi_ring)
+        {
+          self->midi_ring =
+            zix_ring_new (
+              sizeof (gint64) * (size_t) 11);
+        }
+      break;
+    case TYPE_AUDIO:
+    case TYPE_CV:
+      if (!self->audio_ring)
+        {
+          self->audio_ring =
+            zix_ring_new (
+              sizeof (float) * AUDIO_RING_SIZE);
+        }
+      break;
+    default:
+      break;
+    }
+}
+
 /**
  * Allocates buffers used during DSP.
  *
@@ -90,20 +123,15 @@ port_allocate_bufs (
       object_free_w_func_and_null (
         midi_events_free, self->midi_events);
       self->midi_events = midi_events_new ();
-      object_free_w_func_and_null (
-        zix_ring_free, self->midi_ring);
-      self->midi_ring =
-        zix_ring_new (
-          sizeof (MidiEvent) * (size_t) 11);
       break;
     case TYPE_AUDIO:
     case TYPE_CV:
       {
-        object_free_w_func_and_null (
-          zix_ring_free, self->audio_ring);
-        self->audio_ring =
-          zix_ring_new (
-            sizeof (float) * AUDIO_RING_SIZE);
+        if (self->buf_pooled)
+          {
+            self->buf = NULL;
+            self->buf_pooled = false;
+          }
         object_zero_and_free (self->buf);
         size_t max =
           MAX (
@@ -116,6 +144,10 @@ port_allocate_bufs (
     default:
       break;
     }
+
+  /* the rings are only needed while observed */
+  if (port_is_observed (self))
+    create_rings (self);
 }
 
 /**
@@ -134,9 +166,98 @@ port_free_bufs (
     zix_ring_free, self->midi_ring);
   object_free_w_func_and_null (
     zix_ring_free, self->audio_ring);
+  if (self->buf_pooled)
+    {
+      /* owned by the graph */
+      self->buf = NULL;
+      self->buf_pooled = false;
+    }
   object_zero_and_free (self->buf);
 }
 
+/**
+ * Subscribes a UI element (meter, scope, etc.) to
+ * the port's data.
+ *
+ * While the port has observers, the engine
+ * publishes its data to @ref Port.audio_ring or
+ * @ref Port.midi_ring each cycle.
+ *
+ * Must be called from the GUI thread.
+ */
+void
+port_add_observer (
+  Port * self)
+{
+  /* create the rings before the engine can see
+   * the observer */
+  create_rings (self);
+  g_atomic_int_inc (&self->num_observers);
+}
+
+/**
+ * Removes a subscription added with
+ * port_add_observer().
+ *
+ * Must be called from the GUI thread.
+ */
+void
+port_remove_observer (
+  Port * self)
+{
+  g_return_if_fail (
+    g_atomic_int_get (&self->num_observers) > 0);
+  g_atomic_int_add (&self->num_observers, -1);
+}
+
+/**
+ * Returns whether @p port is still the port with
+ * the given identifier in the project.
+ *
+ * The port may have been free'd along with its
+ * track, plugin or project before a UI element
+ * holding it unsubscribes, so @p port is not
+ * dereferenced.
+ *
+ * Must be called from the GUI thread.
+ */
+bool
+port_is_alive (
+  const PortIdentifier * id,
+  const Port *           port)
+{
+  if (!port || !PROJECT || !TRACKLIST)
+    return false;
+
+  if (id->owner_type != PORT_OWNER_TYPE_PLUGIN)
+    {
+      return
+        port_find_from_identifier (id) == port;
+    }
+
+  /* look up the plugin without warning, since it
+   * may have been removed */
+  Track * tr =
+    tracklist_find_track_by_name_hash (
+      TRACKLIST, id->track_name_hash);
+  if (!tr)
+    return false;
+  Plugin * pl =
+    track_get_plugin_at_slot (
+      tr, id->plugin_id.slot_type,
+      id->plugin_id.slot);
+  if (!pl)
+    return false;
+  if (id->flow == FLOW_INPUT)
+    return
+      id->port_index < pl->num_in_ports
+      && pl->in_ports[id->port_index] == port;
+  else
+    return
+      id->port_index < pl->num_out_ports
+      && pl->out_ports[id->port_index] == port;
+}
+
 /**
  * This function finds the Ports corresponding to
  * the PortIdentifiers for srcs and dests.
@@ -881,7 +1002,10 @@ port_receive_midi_events_from_jack (
             {
               /* different channel */
             }
-          else if (jack_ev.size == 3)
+          else if (jack_ev.size == 3
+                   ||
+                   (jack_ev.size > 3
+                    && jack_ev.buffer[0] == 0xF0))
             {
               midi_events_add_event_from_buf (
                 self->midi_events,
@@ -1316,6 +1440,7 @@ set_owner_track_processor (
     track_get_name_hash (track);
   port->id.owner_type =
     PORT_OWNER_TYPE_TRACK_PROCESSOR;
+  port->track = track;
 }
 
 /**
@@ -1385,6 +1510,7 @@ set_owner_track (
     track_get_name_hash (track);
   port->id.owner_type =
     PORT_OWNER_TYPE_TRACK;
+  port->track = track;
 }
 
 /**
@@ -2458,6 +2584,41 @@ port_forward_control_change_event (
     }
 }
 
+/**
+ * Lets the track processor know that the value
+ * of a MIDI automatable port changed so that it
+ * sends it in the next cycle.
+ */
+static inline void
+mark_midi_automatable_dirty (
+  Port * self)
+{
+  if (self->id.flags & PORT_FLAG_MIDI_AUTOMATABLE
+      && self->track && self->track->processor)
+    {
+      track_processor_mark_midi_automatable_dirty (
+        self->track->processor, self);
+    }
+}
+
+/**
+ * Lets the owner plugin know that the value of an
+ * input control port changed so that it is
+ * delivered in the next cycle.
+ */
+static inline void
+mark_plugin_control_dirty (
+  Port * self)
+{
+  if (self->id.owner_type == PORT_OWNER_TYPE_PLUGIN
+      && self->id.flow == FLOW_INPUT
+      && self->plugin)
+    {
+      plugin_mark_control_dirty (
+        self->plugin, self);
+    }
+}
+
 /**
  * Sets the given control value to the
  * corresponding underlying structure in the Port.
@@ -2506,6 +2667,8 @@ port_set_control_value (
         self->control, self->base_value))
     {
       self->control = self->base_value;
+      mark_midi_automatable_dirty (self);
+      mark_plugin_control_dirty (self);
 
       /* remember time */
       self->last_change = g_get_monotonic_time ();
@@ -3088,27 +3251,28 @@ port_process (
             AUDIO_ENGINE->block_length)
         {
           MidiEvents * events = port->midi_events;
-          if (port->write_ring_buffers)
+          if (port_is_observed (port)
+              && port->midi_ring)
             {
-              for (int i = events->num_events - 1;
-                   i >= 0; i--)
+              if (events->num_events > 0)
                 {
+                  /* the meters only need the time
+                   * of the last cycle with
+                   * events */
                   if (zix_ring_write_space (
                         port->midi_ring) <
-                        sizeof (MidiEvent))
+                        sizeof (gint64))
                     {
                       zix_ring_skip (
                         port->midi_ring,
-                        sizeof (MidiEvent));
+                        sizeof (gint64));
                     }
 
-                  MidiEvent * ev =
-                    &events->events[i];
-                  ev->systime =
+                  gint64 systime =
                     g_get_monotonic_time ();
                   zix_ring_write (
-                    port->midi_ring, ev,
-                    sizeof (MidiEvent));
+                    port->midi_ring, &systime,
+                    sizeof (gint64));
                 }
             }
           else
@@ -3138,6 +3302,15 @@ port_process (
           PORT_OWNER_TYPE_TRACK_PROCESSOR
         || IS_TRACK_AND_NONNULL (track));
 
+      /* pooled buffers contain data from other
+       * ports, so clear before summing */
+      if (port->buf_pooled && id->flow == FLOW_INPUT)
+        {
+          dsp_fill (
+            &port->buf[local_offset],
+            DENORMAL_PREVENTION_VAL, nframes);
+        }
+
       /* only consider incoming external data if
        * armed for recording (if the port is owner
        * by a track), otherwise always consider
@@ -3254,26 +3427,44 @@ port_process (
             }
         }
 
-      if (local_offset + nframes ==
-            AUDIO_ENGINE->block_length)
+      /* publish the data for the UI, only if
+       * anything is observing the port.
+       *
+       * the parts of pooled buffers from earlier
+       * splits may have been overwritten by other
+       * ports by the end of the cycle, so write
+       * them on each split */
+      if (port_is_observed (port)
+          && port->audio_ring
+          &&
+          (port->buf_pooled
+           ||
+           local_offset + nframes ==
+             AUDIO_ENGINE->block_length))
         {
-          size_t size =
+          size_t block_size =
             sizeof (float) *
             (size_t) AUDIO_ENGINE->block_length;
+          nframes_t start =
+            port->buf_pooled ? local_offset : 0;
+          size_t size =
+            port->buf_pooled
+            ? sizeof (float) * (size_t) nframes
+            : block_size;
           size_t write_space_avail =
             zix_ring_write_space (
               port->audio_ring);
 
           /* move the read head 8 blocks to make
            * space if no space avail to write */
-          if (write_space_avail / size < 1)
+          if (write_space_avail < size)
             {
               zix_ring_skip (
-                port->audio_ring, size * 8);
+                port->audio_ring, block_size * 8);
             }
 
           zix_ring_write (
-            port->audio_ring, &port->buf[0],
+            port->audio_ring, &port->buf[start],
             size);
         }
 
@@ -3564,8 +3755,21 @@ port_process (
                       *  conn->multiplier,
                     minf, maxf);
                 port->control = result;
-                port_forward_control_change_event (
-                  port);
+                mark_midi_automatable_dirty (port);
+
+                /* plugins pick up the change in
+                 * their next cycle and forward it
+                 * to their UI at the UI rate */
+                if (port->id.owner_type
+                      == PORT_OWNER_TYPE_PLUGIN)
+                  {
+                    mark_plugin_control_dirty (port);
+                  }
+                else
+                  {
+                    port_forward_control_change_event (
+                      port);
+                  }
               }
           }
       }
@@ -3855,6 +4059,12 @@ port_clear_buffer (Port * port)
   if ((pi->type == TYPE_AUDIO ||
        pi->type == TYPE_CV) && port->buf)
     {
+      /* pooled buffers are shared with other ports
+       * and are written when the port is
+       * processed */
+      if (port->buf_pooled)
+        return;
+
       dsp_fill (
         port->buf, DENORMAL_PREVENTION_VAL,
         AUDIO_ENGINE->block_length);
@@ -3865,7 +4075,8 @@ port_clear_buffer (Port * port)
     port->id.type == TYPE_EVENT
     && port->midi_events)
     {
-      port->midi_events->num_events = 0;
+      midi_events_clear (
+        port->midi_events, F_NOT_QUEUED);
     }
 }
 
@@ -3994,6 +4205,10 @@ port_get_plugin (
 
 /**
  * Applies the pan to the given L/R ports.
+ *
+ * @param start_frame The start frame offset from
+ *   0 in this cycle.
+ * @param nframes The number of frames to process.
  */
 void
 port_apply_pan_stereo (
@@ -4001,35 +4216,17 @@ port_apply_pan_stereo (
   Port *       r,
   float        pan,
   PanLaw       pan_law,
-  PanAlgorithm pan_algo)
+  PanAlgorithm pan_algo,
+  nframes_t    start_frame,
+  const nframes_t    nframes)
 {
-  /* FIXME not used */
-  g_warn_if_reached ();
-  /*int nframes = AUDIO_ENGINE->block_length;*/
-  /*int i;*/
-  /*switch (pan_algo)*/
-    /*{*/
-    /*case PAN_ALGORITHM_SINE_LAW:*/
-      /*for (i = 0; i < nframes; i++)*/
-        /*{*/
-          /*if (r->buf[i] != 0.f)*/
-            /*r->buf[i] *= sinf (pan * (M_PIF / 2.f));*/
-          /*if (l->buf[i] != 0.f)*/
-            /*l->buf[i] *= sinf ((1.f - pan) * (M_PIF / 2.f));*/
-        /*}*/
-      /*break;*/
-    /*case PAN_ALGORITHM_SQUARE_ROOT:*/
-      /*break;*/
-    /*case PAN_ALGORITHM_LINEAR:*/
-      /*for (i = 0; i < nframes; i++)*/
-        /*{*/
-          /*if (r->buf[i] != 0.f)*/
-            /*r->buf[i] *= pan;*/
-          /*if (l->buf[i] != 0.f)*/
-            /*l->buf[i] *= (1.f - pan);*/
-        /*}*/
-      /*break;*/
-    /*}*/
+  float calc_r, calc_l;
+  pan_get_calc_lr (
+    pan_law, pan_algo, pan, &calc_l, &calc_r);
+
+  dsp_mul_k2_stereo (
+    &l->buf[start_frame], &r->buf[start_frame],
+    calc_l, calc_r, nframes);
 }
 
 /**
@@ -22,6 +22,7 @@
 #include "audio/engine.h"
 #include "audio/position.h"
 #include "audio/snap_grid.h"
+#include "audio/tempo_map.h"
 #include "audio/tempo_track.h"
 #include "audio/transport.h"
 #include "gui/widgets/arranger.h"
@@ -74,6 +75,15 @@ void
 position_update_ticks_from_frames (
   Position * self)
 {
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  if (map && tempo_map_is_ready (map))
+    {
+      self->ticks =
+        tempo_map_frames_to_ticks (
+          map, (double) self->frames);
+      return;
+    }
+
   g_return_if_fail (
     AUDIO_ENGINE->ticks_per_frame > 0);
   self->ticks =
@@ -88,6 +98,14 @@ signed_frame_t
 position_get_frames_from_ticks (
   double ticks)
 {
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  if (map && tempo_map_is_ready (map))
+    {
+      return
+        math_round_double_to_signed_frame_t (
+          tempo_map_ticks_to_frames (map, ticks));
+    }
+
   g_return_val_if_fail (
     AUDIO_ENGINE->frames_per_tick > 0, -1);
   return
@@ -106,6 +124,49 @@ position_update_frames_from_ticks (
     position_get_frames_from_ticks (self->ticks);
 }
 
+/**
+ * Updates a region-local position from ticks or
+ * frames, relative to the start of its region.
+ *
+ * With a constant tempo this is the same as
+ * position_update().
+ *
+ * @param from_ticks Whether to update the
+ *   position based on ticks (true) or frames
+ *   (false).
+ * @param region_start Start position of the
+ *   region.
+ */
+void
+position_update_local (
+  Position *       self,
+  bool             from_ticks,
+  const Position * region_start)
+{
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  if (!map || !tempo_map_is_automated (map))
+    {
+      position_update (self, from_ticks);
+      return;
+    }
+
+  if (from_ticks)
+    {
+      self->frames =
+        math_round_double_to_signed_frame_t (
+          tempo_map_local_ticks_to_frames (
+            map, region_start->ticks,
+            self->ticks));
+    }
+  else
+    {
+      self->ticks =
+        tempo_map_local_frames_to_ticks (
+          map, region_start->ticks,
+          (double) self->frames);
+    }
+}
+
 /**
  * Sets position to given bar.
  */
@@ -616,6 +677,17 @@ position_from_seconds (
   Position * position,
   double secs)
 {
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  if (map && tempo_map_is_automated (map))
+    {
+      position_from_ticks (
+        position,
+        tempo_map_frames_to_ticks (
+          map,
+          secs * (double) AUDIO_ENGINE->sample_rate));
+      return;
+    }
+
   position_from_ticks (
     position,
     (secs * (double) AUDIO_ENGINE->sample_rate) /
@@ -26,8 +26,11 @@
 #include "audio/recording_event.h"
 #include "audio/recording_manager.h"
 #include "audio/track.h"
+#include "audio/track_processor.h"
 #include "audio/transport.h"
 #include "gui/backend/arranger_object.h"
+#include "gui/backend/event.h"
+#include "gui/backend/event_manager.h"
 #include "project.h"
 #include "utils/arrays.h"
 #include "utils/debug.h"
@@ -1103,6 +1106,7 @@ handle_audio_event (
 
       cur_local_offset++;
     }
+  clip->frames_dirty = true;
 
   audio_clip_update_channel_caches (
     clip, (size_t) clip->frames_written);
@@ -1574,6 +1578,67 @@ handle_start_recording (
   self->num_active_recordings++;
 }
 
+/**
+ * Creates the MIDI CC port requested by the
+ * track processor and applies the received value.
+ */
+static void
+handle_create_midi_cc_port (
+  RecordingManager * self,
+  RecordingEvent *   ev)
+{
+  Track * tr =
+    tracklist_find_track_by_name_hash (
+      TRACKLIST, ev->track_name_hash);
+  g_return_if_fail (IS_TRACK_AND_NONNULL (tr));
+  g_return_if_fail (
+    tr->processor && ev->has_midi_event);
+
+  midi_byte_t * buf = ev->midi_event.raw_buffer;
+  int idx = (buf[0] & 0xf) * 128 + (buf[1] & 0x7f);
+  Port * port =
+    track_processor_get_or_create_midi_automatable (
+      tr->processor, 0, idx);
+  g_return_if_fail (IS_PORT_AND_NONNULL (port));
+
+  port_set_control_value (
+    port, (float) buf[2] / 127.f, F_NORMALIZED,
+    F_PUBLISH_EVENTS);
+}
+
+/**
+ * Publishes a change of the region being recorded
+ * into by the given event so that it gets redrawn.
+ */
+static void
+publish_recording_region_changed (
+  RecordingEvent * ev)
+{
+  ZRegion * region = NULL;
+  if (ev->type == RECORDING_EVENT_TYPE_AUTOMATION)
+    {
+      AutomationTrack * at =
+        automation_track_find_from_port_id (
+          &ev->port_id, false);
+      if (at)
+        region = at->recording_region;
+    }
+  else
+    {
+      Track * tr =
+        tracklist_find_track_by_name_hash (
+          TRACKLIST, ev->track_name_hash);
+      if (tr)
+        region = tr->recording_region;
+    }
+
+  if (region)
+    {
+      EVENTS_PUSH (
+        ET_ARRANGER_OBJECT_CHANGED, region);
+    }
+}
+
 /**
  * GSourceFunc to be added using idle add.
  *
@@ -1611,14 +1676,17 @@ recording_manager_process_events (
         case RECORDING_EVENT_TYPE_MIDI:
           /*g_message ("-------- RECORD MIDI");*/
           handle_midi_event (self, ev);
+          publish_recording_region_changed (ev);
           break;
         case RECORDING_EVENT_TYPE_AUDIO:
           /*g_message ("-------- RECORD AUDIO");*/
           handle_audio_event (self, ev);
+          publish_recording_region_changed (ev);
           break;
         case RECORDING_EVENT_TYPE_AUTOMATION:
           /*g_message ("-------- RECORD AUTOMATION");*/
           handle_automation_event (self, ev);
+          publish_recording_region_changed (ev);
           break;
         case RECORDING_EVENT_TYPE_PAUSE_TRACK_RECORDING:
           g_message ("-------- PAUSE TRACK RECORDING");
@@ -1708,6 +1776,9 @@ recording_manager_process_events (
             "num active recordings: %d",
             self->num_active_recordings);
           break;
+        case RECORDING_EVENT_TYPE_CREATE_MIDI_CC_PORT:
+          handle_create_midi_cc_port (self, ev);
+          break;
         default:
           g_warning (
             "recording event %d not implemented yet",
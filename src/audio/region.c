@@ -32,6 +32,7 @@
 #include "audio/region_link_group_manager.h"
 #include "audio/router.h"
 #include "audio/stretcher.h"
+#include "audio/tempo_map.h"
 #include "audio/track.h"
 #include "gui/widgets/automation_region.h"
 #include "gui/widgets/bot_dock_edge.h"
@@ -50,8 +51,10 @@
 #include "utils/debug.h"
 #include "utils/flags.h"
 #include "utils/audio.h"
+#include "utils/math.h"
 #include "utils/objects.h"
 #include "utils/yaml.h"
+#include "zrythm_app.h"
 
 #include <glib/gi18n.h>
 
@@ -110,6 +113,15 @@ region_init (
   position_from_frames (
     &obj->fade_out_pos, length);
 
+  /* children will be created with the current
+   * tempo */
+  if (AUDIO_ENGINE && AUDIO_ENGINE->tempo_map)
+    {
+      self->children_epoch =
+        tempo_map_get_epoch (
+          AUDIO_ENGINE->tempo_map);
+    }
+
   self->magic = REGION_MAGIC;
 
   region_validate (self, false);
@@ -347,6 +359,7 @@ region_stretch (
           returned_frames, >, 0);
         new_clip->num_frames =
           (unsigned_frame_t) returned_frames;
+        new_clip->frames_dirty = true;
         audio_clip_write_to_pool (
           new_clip, F_NO_PARTS, F_NOT_BACKUP);
         (void) obj;
@@ -762,6 +775,8 @@ region_find (
       g_return_val_if_fail (
         IS_REGION (region), NULL);
 
+      region_refresh_children_positions (region);
+
       return region;
     }
   else if (id->type == REGION_TYPE_AUTOMATION)
@@ -790,6 +805,8 @@ region_find (
       g_return_val_if_fail (
         IS_REGION (region), NULL);
 
+      region_refresh_children_positions (region);
+
       return region;
     }
   else if (id->type == REGION_TYPE_CHORD)
@@ -804,12 +821,113 @@ region_find (
       g_return_val_if_fail (
         IS_REGION (region), NULL);
 
+      region_refresh_children_positions (region);
+
       return region;
     }
 
   g_return_val_if_reached (NULL);
 }
 
+/**
+ * Updates the positions of the children (notes,
+ * automation points, etc.) from their ticks,
+ * relative to the region start, if the tempo map
+ * changed since they were last updated.
+ *
+ * To be called before accessing the positions of
+ * the children. The children are only updated in
+ * the GTK thread, so this never writes to them
+ * in the audio threads, which should use
+ * region_get_child_frames() instead.
+ */
+void
+region_refresh_children_positions (
+  ZRegion * self)
+{
+  if (!AUDIO_ENGINE || !AUDIO_ENGINE->tempo_map)
+    return;
+
+  gint epoch =
+    tempo_map_get_epoch (AUDIO_ENGINE->tempo_map);
+  if (G_LIKELY (
+        g_atomic_int_get (&self->children_epoch)
+        == epoch))
+    return;
+
+  /* the children are only updated in the GTK
+   * thread - other threads (eg, the audio
+   * threads) convert the ticks themselves until
+   * then (see region_get_child_frames()) */
+  if (!ZRYTHM_APP_IS_GTK_THREAD)
+    return;
+
+  for (int i = 0; i < self->num_midi_notes; i++)
+    {
+      arranger_object_update_child_positions (
+        (ArrangerObject *) self->midi_notes[i], self,
+        true);
+    }
+  for (int i = 0; i < self->num_unended_notes; i++)
+    {
+      arranger_object_update_child_positions (
+        (ArrangerObject *) self->unended_notes[i], self,
+        true);
+    }
+  for (int i = 0; i < self->num_aps; i++)
+    {
+      arranger_object_update_child_positions (
+        (ArrangerObject *) self->aps[i], self,
+        true);
+    }
+  for (int i = 0; i < self->num_chord_objects; i++)
+    {
+      arranger_object_update_child_positions (
+        (ArrangerObject *) self->chord_objects[i], self,
+        true);
+    }
+
+  /* publish only after all the children were
+   * updated */
+  g_atomic_int_set (&self->children_epoch, epoch);
+}
+
+/**
+ * Returns the frames of @p pos, a region-local
+ * position of a child of the region (eg, a MIDI
+ * note).
+ *
+ * If the children were not refreshed after a
+ * tempo change yet (eg, when called from the
+ * audio threads), the frames are converted from
+ * the ticks with the current tempo map instead of
+ * using the outdated frames.
+ *
+ * This is realtime-safe.
+ */
+signed_frame_t
+region_get_child_frames (
+  ZRegion *        self,
+  const Position * pos)
+{
+  if (!AUDIO_ENGINE || !AUDIO_ENGINE->tempo_map)
+    return pos->frames;
+
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  if (G_LIKELY (
+        g_atomic_int_get (&self->children_epoch)
+        == tempo_map_get_epoch (map)))
+    return pos->frames;
+
+  if (!tempo_map_is_automated (map))
+    return position_get_frames_from_ticks (pos->ticks);
+
+  return
+    math_round_double_to_signed_frame_t (
+      tempo_map_local_ticks_to_frames (
+        map, self->base.pos.ticks, pos->ticks));
+}
+
 /**
  * To be called every time the identifier changes
  * to update the region's children.
@@ -90,6 +90,156 @@ router_get_max_route_playback_latency (
   return router->max_route_playback_latency;
 }
 
+/**
+ * Adds a transport snapshot unless there is one
+ * for the same frame already.
+ */
+static void
+add_transport_snapshot (
+  Router *         self,
+  const Position * pos,
+  nframes_t        nframes)
+{
+  for (int i = 0;
+       i < self->num_transport_snapshots; i++)
+    {
+      if (self->transport_snapshots[i].frame ==
+            (unsigned_frame_t) pos->frames)
+        return;
+    }
+
+  if (self->num_transport_snapshots ==
+        ROUTER_MAX_TRANSPORT_SNAPSHOTS)
+    return;
+
+  transport_snapshot_init (
+    &self->transport_snapshots[
+      self->num_transport_snapshots++],
+    TRANSPORT, pos, nframes);
+}
+
+/**
+ * Adds the transport snapshots for a node
+ * starting at @p start_pos, splitting at the loop
+ * points like graph_node_process() does.
+ */
+static void
+add_transport_snapshots_for_node (
+  Router *         self,
+  const Position * start_pos,
+  nframes_t        nframes)
+{
+  Position pos = *start_pos;
+  for (nframes_t num_processable_frames = 0;
+       (num_processable_frames =
+          MIN (
+            transport_is_loop_point_met (
+              TRANSPORT, pos.frames, nframes),
+            nframes)) != 0;)
+    {
+      add_transport_snapshot (
+        self, &pos, num_processable_frames);
+      nframes -= num_processable_frames;
+      position_from_frames (
+        &pos,
+        (pos.frames + num_processable_frames
+         + TRANSPORT->loop_start_pos.frames)
+        - TRANSPORT->loop_end_pos.frames);
+    }
+
+  if (nframes > 0)
+    {
+      add_transport_snapshot (self, &pos, nframes);
+    }
+}
+
+/**
+ * Computes the transport snapshots that the graph
+ * nodes will use in this split.
+ */
+static void
+update_transport_snapshots (
+  Router *                      self,
+  const EngineProcessTimeInfo * time_nfo)
+{
+  self->num_transport_snapshots = 0;
+
+  /* latency is only compensated when rolling
+   * (see graph_node_process()) */
+  if (TRANSPORT->play_state != PLAYSTATE_ROLLING)
+    {
+      Position pos;
+      if ((signed_frame_t) time_nfo->g_start_frame
+            == PLAYHEAD->frames)
+        {
+          pos = *PLAYHEAD;
+        }
+      else
+        {
+          position_from_frames (
+            &pos,
+            (signed_frame_t)
+              time_nfo->g_start_frame);
+        }
+      add_transport_snapshots_for_node (
+        self, &pos, time_nfo->nframes);
+      return;
+    }
+
+  Graph * graph = self->graph;
+  for (int i = 0;
+       i < graph->num_route_latencies; i++)
+    {
+      nframes_t latency =
+        graph->route_latencies[i];
+      if (latency <
+            AUDIO_ENGINE->remaining_latency_preroll)
+        continue;
+
+      Position pos = *PLAYHEAD;
+      transport_position_add_frames (
+        TRANSPORT, &pos,
+        latency -
+          AUDIO_ENGINE->remaining_latency_preroll);
+      add_transport_snapshots_for_node (
+        self, &pos, time_nfo->nframes);
+    }
+}
+
+/**
+ * Returns the transport snapshot for the given
+ * start frame in the current split.
+ *
+ * If there is no precomputed snapshot for it (eg,
+ * outside the processing cycle), @p tmp is filled
+ * in and returned instead.
+ */
+const TransportSnapshot *
+router_get_transport_snapshot (
+  Router *            self,
+  unsigned_frame_t    g_start_frame,
+  TransportSnapshot * tmp)
+{
+  if (self->callback_in_progress)
+    {
+      for (int i = 0;
+           i < self->num_transport_snapshots; i++)
+        {
+          const TransportSnapshot * snapshot =
+            &self->transport_snapshots[i];
+          if (snapshot->frame == g_start_frame)
+            return snapshot;
+        }
+    }
+
+  Position pos;
+  position_from_frames (
+    &pos, (signed_frame_t) g_start_frame);
+  transport_snapshot_init (
+    tmp, TRANSPORT, &pos, 0);
+  return tmp;
+}
+
 /**
  * Starts a new cycle.
  */
@@ -169,6 +319,11 @@ router_start_cycle (
         self->graph->beat_unit_node, time_nfo);
     }
 
+  /* compute the transport info shared by all
+   * nodes (after the tempo track ports, since
+   * they may change the BPM/time signature) */
+  update_transport_snapshots (self, &time_nfo);
+
   self->callback_in_progress = true;
   zix_sem_post (&self->graph->callback_start);
   zix_sem_wait (&self->graph->callback_done);
@@ -662,9 +662,11 @@ sample_processor_queue_file (
         F_NOT_MOVING_PLUGIN, F_GEN_AUTOMATABLES,
         F_NO_RECALC_GRAPH, F_NO_PUBLISH_EVENTS);
 
+      MidiFile * midi_file =
+        midi_file_new (file->abs_path);
       int num_tracks =
-        midi_file_get_num_tracks (
-          file->abs_path, true);
+        midi_file ?
+          midi_file->num_nonempty_tracks : 0;
       g_debug (
         "creating %d MIDI tracks...", num_tracks);
       for (int i = 0; i < num_tracks; i++)
@@ -691,9 +693,11 @@ sample_processor_queue_file (
           /* create a MIDI region from the MIDI
            * file & add to track */
           ZRegion * mr =
-            midi_region_new_from_midi_file (
-              &start_pos, file->abs_path,
-              track_get_name_hash (track), 0, 0, i);
+            midi_region_new_from_midi_file_track (
+              &start_pos,
+              midi_file_get_nonempty_track (
+                midi_file, i),
+              track_get_name_hash (track), 0, 0);
           if (mr)
             {
               track_add_region (
@@ -725,6 +729,8 @@ sample_processor_queue_file (
                 file->abs_path);
             }
         }
+      object_free_w_func_and_null (
+        midi_file_free, midi_file);
     }
 
   self->roll = true;
@@ -0,0 +1,676 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/automation_point.h"
+#include "audio/automation_region.h"
+#include "audio/automation_track.h"
+#include "audio/control_port.h"
+#include "audio/engine.h"
+#include "audio/position.h"
+#include "audio/region.h"
+#include "audio/tempo_map.h"
+#include "audio/track.h"
+#include "gui/backend/arranger_object.h"
+#include "project.h"
+#include "utils/math.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+TempoMap *
+tempo_map_new (void)
+{
+  TempoMap * self = object_new (TempoMap);
+
+  g_mutex_init (&self->rebuild_lock);
+
+  return self;
+}
+
+/**
+ * Appends a segment starting at @p ticks, merging
+ * it with the last one if possible.
+ */
+static void
+append_segment (
+  GArray * arr,
+  double   ticks,
+  bpm_t    bpm)
+{
+  if (arr->len == 0)
+    {
+      /* the first segment always starts at 0 */
+      TempoMapSegment seg = {
+        .ticks = 0.0, .bpm = bpm };
+      g_array_append_val (arr, seg);
+      return;
+    }
+
+  TempoMapSegment * last =
+    &g_array_index (
+      arr, TempoMapSegment, arr->len - 1);
+  if (math_floats_equal (last->bpm, bpm))
+    return;
+
+  if (ticks <= last->ticks)
+    {
+      last->bpm = bpm;
+      return;
+    }
+
+  TempoMapSegment seg = {
+    .ticks = ticks, .bpm = bpm };
+  g_array_append_val (arr, seg);
+}
+
+static int
+region_cmpfunc (
+  const void * a,
+  const void * b)
+{
+  const ArrangerObject * r1 =
+    *(ArrangerObject * const *) a;
+  const ArrangerObject * r2 =
+    *(ArrangerObject * const *) b;
+  return
+    position_compare (&r1->pos, &r2->pos);
+}
+
+/**
+ * Appends the segments of the section between
+ * @p ap and @p next_ap.
+ */
+static void
+append_curve_segments (
+  GArray *          arr,
+  Port *            port,
+  AutomationPoint * ap,
+  AutomationPoint * next_ap,
+  double            start_ticks,
+  double            end_ticks)
+{
+  if (math_floats_equal (
+        ap->fvalue, next_ap->fvalue)
+      || end_ticks <= start_ticks)
+    {
+      append_segment (
+        arr, start_ticks, (bpm_t) ap->fvalue);
+      return;
+    }
+
+  /* approximate the curve with constant tempo
+   * steps of (at most) a 16th note */
+  double len = end_ticks - start_ticks;
+  int num_steps =
+    (int)
+    ceil (len / TICKS_PER_SIXTEENTH_NOTE_DBL);
+  num_steps =
+    CLAMP (
+      num_steps, 1, TEMPO_MAP_MAX_CURVE_STEPS);
+
+  bool prev_ap_lower =
+    ap->normalized_val <= next_ap->normalized_val;
+  float diff =
+    fabsf (
+      ap->normalized_val - next_ap->normalized_val);
+  for (int i = 0; i < num_steps; i++)
+    {
+      /* use the value in the middle of the step */
+      double ratio =
+        ((double) i + 0.5) / (double) num_steps;
+      float normalized =
+        (float)
+        automation_point_get_normalized_value_in_curve (
+          ap, ratio);
+      normalized *= diff;
+      normalized +=
+        prev_ap_lower ?
+          ap->normalized_val :
+          next_ap->normalized_val;
+      bpm_t bpm =
+        control_port_normalized_val_to_real (
+          port, normalized);
+      append_segment (
+        arr,
+        start_ticks +
+          (len * (double) i) / (double) num_steps,
+        bpm);
+    }
+}
+
+/**
+ * Appends the segments for the BPM automation of
+ * the tempo track.
+ */
+static void
+append_automation_segments (
+  GArray * arr,
+  Track *  tempo_track)
+{
+  if (!tempo_track->bpm_port)
+    return;
+
+  AutomationTrack * at =
+    automation_track_find_from_port (
+      tempo_track->bpm_port, tempo_track, false);
+  if (!at || at->num_regions == 0)
+    return;
+
+  ZRegion * regions[at->num_regions];
+  memcpy (
+    regions, at->regions,
+    (size_t) at->num_regions * sizeof (ZRegion *));
+  qsort (
+    regions, (size_t) at->num_regions,
+    sizeof (ZRegion *), region_cmpfunc);
+
+  for (int i = 0; i < at->num_regions; i++)
+    {
+      ZRegion * r = regions[i];
+      ArrangerObject * r_obj = (ArrangerObject *) r;
+      double r_start = r_obj->pos.ticks;
+      double r_end = r_obj->end_pos.ticks;
+      double offset =
+        r_start - r_obj->clip_start_pos.ticks;
+
+      for (int j = 0; j < r->num_aps; j++)
+        {
+          AutomationPoint * ap = r->aps[j];
+          ArrangerObject * ap_obj =
+            (ArrangerObject *) ap;
+          double ticks =
+            MAX (ap_obj->pos.ticks + offset, 0.0);
+          if (ticks < r_start)
+            continue;
+          if (ticks >= r_end)
+            break;
+
+          AutomationPoint * next_ap =
+            j < r->num_aps - 1 ? r->aps[j + 1] : NULL;
+          if (next_ap)
+            {
+              ArrangerObject * next_ap_obj =
+                (ArrangerObject *) next_ap;
+              double next_ticks =
+                MIN (
+                  next_ap_obj->pos.ticks + offset,
+                  r_end);
+              append_curve_segments (
+                arr, tempo_track->bpm_port, ap,
+                next_ap, ticks, next_ticks);
+            }
+          else
+            {
+              append_segment (
+                arr, ticks, (bpm_t) ap->fvalue);
+            }
+        }
+    }
+}
+
+static bool
+tables_equal (
+  const TempoMapTable * a,
+  const TempoMapTable * b)
+{
+  if (a->automated != b->automated
+      || a->num_segments != b->num_segments)
+    return false;
+
+  for (int i = 0; i < a->num_segments; i++)
+    {
+      const TempoMapSegment * s1 = &a->segments[i];
+      const TempoMapSegment * s2 = &b->segments[i];
+      if (!math_doubles_equal (s1->ticks, s2->ticks)
+          || !math_doubles_equal (
+               s1->frames, s2->frames)
+          || !math_doubles_equal (
+               s1->frames_per_tick,
+               s2->frames_per_tick)
+          || !math_floats_equal (s1->bpm, s2->bpm))
+        return false;
+    }
+
+  return true;
+}
+
+/**
+ * Frees the replaced tables that can no longer be
+ * read by the processing threads.
+ *
+ * @param all Whether to free all of them.
+ */
+static void
+free_retired_tables (
+  TempoMap * self,
+  bool       all)
+{
+  /* tables can only be read during a cycle, and
+   * a cycle that started after a table was
+   * replaced reads the new one */
+  bool engine_processing =
+    PROJECT && AUDIO_ENGINE
+    && AUDIO_ENGINE->activated;
+  uint_fast64_t cycle =
+    engine_processing ? AUDIO_ENGINE->cycle : 0;
+
+  TempoMapTable ** prev_next = &self->retired;
+  while (*prev_next)
+    {
+      TempoMapTable * table = *prev_next;
+      if (all || !engine_processing
+          || table->retire_cycle < cycle)
+        {
+          *prev_next = table->next_retired;
+          g_free (table);
+        }
+      else
+        {
+          prev_next = &table->next_retired;
+        }
+    }
+}
+
+/**
+ * Rebuilds the map.
+ *
+ * To be called when the tempo, time signature or
+ * sample rate change.
+ *
+ * Must not be called from realtime threads, since
+ * this allocates and locks.
+ *
+ * @param tempo_track Tempo track to read BPM
+ *   automation from, or NULL to only use @p bpm.
+ * @param bpm BPM to use if there is no tempo
+ *   automation.
+ *
+ * @return Whether the map changed.
+ */
+bool
+tempo_map_rebuild (
+  TempoMap *    self,
+  Track *       tempo_track,
+  bpm_t         bpm,
+  int           beats_per_bar,
+  int           ticks_per_bar,
+  sample_rate_t sample_rate)
+{
+  g_return_val_if_fail (
+    self && bpm > 0 && beats_per_bar > 0
+    && ticks_per_bar > 0 && sample_rate > 0,
+    false);
+
+  g_mutex_lock (&self->rebuild_lock);
+
+  self->bpm = bpm;
+  self->beats_per_bar = beats_per_bar;
+  self->ticks_per_bar = ticks_per_bar;
+  self->sample_rate = sample_rate;
+
+  GArray * arr =
+    g_array_new (
+      false, true, sizeof (TempoMapSegment));
+  if (tempo_track)
+    {
+      append_automation_segments (
+        arr, tempo_track);
+    }
+  bool automated = arr->len > 0;
+  if (!automated)
+    {
+      append_segment (arr, 0.0, bpm);
+    }
+
+  TempoMapTable * table =
+    g_malloc0 (
+      sizeof (TempoMapTable)
+      + arr->len * sizeof (TempoMapSegment));
+  table->automated = automated;
+  table->num_segments = (int) arr->len;
+  for (int i = 0; i < table->num_segments; i++)
+    {
+      TempoMapSegment * seg = &table->segments[i];
+      *seg =
+        g_array_index (arr, TempoMapSegment, i);
+
+      /* same formula as
+       * engine_update_frames_per_tick() so that a
+       * constant tempo gives the same results */
+      seg->frames_per_tick =
+        (((double) sample_rate * 60.0 *
+           (double) beats_per_bar) /
+        ((double) seg->bpm *
+           (double) ticks_per_bar));
+      seg->ticks_per_frame =
+        1.0 / seg->frames_per_tick;
+
+      if (i == 0)
+        {
+          seg->frames = 0.0;
+        }
+      else
+        {
+          TempoMapSegment * prev =
+            &table->segments[i - 1];
+          seg->frames =
+            prev->frames +
+            (seg->ticks - prev->ticks) *
+              prev->frames_per_tick;
+        }
+    }
+  g_array_free (arr, true);
+
+  TempoMapTable * old_table = self->table;
+  bool changed =
+    !old_table || !tables_equal (old_table, table);
+  if (changed)
+    {
+      g_atomic_pointer_set (&self->table, table);
+      g_atomic_int_inc (&self->epoch);
+      if (old_table)
+        {
+          old_table->retire_cycle =
+            PROJECT && AUDIO_ENGINE ?
+              AUDIO_ENGINE->cycle : 0;
+          old_table->next_retired = self->retired;
+          self->retired = old_table;
+        }
+    }
+  else
+    {
+      g_free (table);
+    }
+  free_retired_tables (self, false);
+
+  g_mutex_unlock (&self->rebuild_lock);
+
+  return changed;
+}
+
+/**
+ * Returns whether rebuilding the map with the
+ * given parameters would change it.
+ *
+ * Changes to @p bpm only matter if the map is not
+ * built from tempo automation.
+ *
+ * This is realtime-safe.
+ */
+bool
+tempo_map_needs_rebuild (
+  TempoMap *    self,
+  bpm_t         bpm,
+  int           beats_per_bar,
+  int           ticks_per_bar,
+  sample_rate_t sample_rate)
+{
+  const TempoMapTable * table =
+    (const TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  if (!table)
+    return true;
+
+  return
+    self->beats_per_bar != beats_per_bar
+    || self->ticks_per_bar != ticks_per_bar
+    || self->sample_rate != sample_rate
+    ||
+    (!table->automated
+     && !math_floats_equal (self->bpm, bpm));
+}
+
+/**
+ * Rebuilds the map using the parameters of the
+ * last rebuild.
+ *
+ * To be called after the tempo automation is
+ * edited.
+ *
+ * @return Whether the map changed.
+ */
+bool
+tempo_map_refresh (
+  TempoMap * self,
+  Track *    tempo_track)
+{
+  if (!tempo_map_is_ready (self))
+    return false;
+
+  return
+    tempo_map_rebuild (
+      self, tempo_track, self->bpm,
+      self->beats_per_bar, self->ticks_per_bar,
+      self->sample_rate);
+}
+
+/**
+ * Returns whether the map was built from tempo
+ * automation.
+ */
+bool
+tempo_map_is_automated (
+  TempoMap * self)
+{
+  TempoMapTable * table =
+    (TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  return table && table->automated;
+}
+
+/**
+ * Returns the last segment starting at or before
+ * @p ticks.
+ */
+static inline const TempoMapSegment *
+find_segment_by_ticks (
+  const TempoMapTable * table,
+  double                ticks)
+{
+  int lo = 0;
+  int hi = table->num_segments - 1;
+  while (lo < hi)
+    {
+      int mid = (lo + hi + 1) / 2;
+      if (table->segments[mid].ticks <= ticks)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+  return &table->segments[lo];
+}
+
+/**
+ * Returns the last segment starting at or before
+ * @p frames.
+ */
+static inline const TempoMapSegment *
+find_segment_by_frames (
+  const TempoMapTable * table,
+  double                frames)
+{
+  int lo = 0;
+  int hi = table->num_segments - 1;
+  while (lo < hi)
+    {
+      int mid = (lo + hi + 1) / 2;
+      if (table->segments[mid].frames <= frames)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+  return &table->segments[lo];
+}
+
+static inline double
+table_ticks_to_frames (
+  const TempoMapTable * table,
+  double                ticks)
+{
+  const TempoMapSegment * seg =
+    find_segment_by_ticks (table, ticks);
+  return
+    seg->frames +
+    (ticks - seg->ticks) * seg->frames_per_tick;
+}
+
+static inline double
+table_frames_to_ticks (
+  const TempoMapTable * table,
+  double                frames)
+{
+  const TempoMapSegment * seg =
+    find_segment_by_frames (table, frames);
+  return
+    seg->ticks +
+    (frames - seg->frames) * seg->ticks_per_frame;
+}
+
+/**
+ * Converts ticks to (non-rounded) frames.
+ *
+ * The map must be ready.
+ */
+double
+tempo_map_ticks_to_frames (
+  TempoMap * self,
+  double     ticks)
+{
+  const TempoMapTable * table =
+    (const TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  return table_ticks_to_frames (table, ticks);
+}
+
+/**
+ * Converts frames to ticks.
+ *
+ * The map must be ready.
+ */
+double
+tempo_map_frames_to_ticks (
+  TempoMap * self,
+  double     frames)
+{
+  const TempoMapTable * table =
+    (const TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  return table_frames_to_ticks (table, frames);
+}
+
+/**
+ * Converts region-local ticks to (non-rounded)
+ * region-local frames.
+ *
+ * The map must be ready.
+ *
+ * @param start_ticks Start of the region in
+ *   (global) ticks.
+ */
+double
+tempo_map_local_ticks_to_frames (
+  TempoMap * self,
+  double     start_ticks,
+  double     ticks)
+{
+  /* use the same table for both conversions */
+  const TempoMapTable * table =
+    (const TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  return
+    table_ticks_to_frames (
+      table, start_ticks + ticks)
+    - table_ticks_to_frames (table, start_ticks);
+}
+
+/**
+ * Converts region-local frames to region-local
+ * ticks.
+ *
+ * The map must be ready.
+ *
+ * @param start_ticks Start of the region in
+ *   (global) ticks.
+ */
+double
+tempo_map_local_frames_to_ticks (
+  TempoMap * self,
+  double     start_ticks,
+  double     frames)
+{
+  const TempoMapTable * table =
+    (const TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  double start_frames =
+    table_ticks_to_frames (table, start_ticks);
+  return
+    table_frames_to_ticks (
+      table, start_frames + frames)
+    - start_ticks;
+}
+
+/**
+ * Returns the BPM at the given position in ticks.
+ *
+ * The map must be ready.
+ */
+bpm_t
+tempo_map_get_bpm_at_ticks (
+  TempoMap * self,
+  double     ticks)
+{
+  const TempoMapTable * table =
+    (const TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  return
+    find_segment_by_ticks (table, ticks)->bpm;
+}
+
+/**
+ * Returns the BPM at the given frame.
+ *
+ * The map must be ready.
+ */
+bpm_t
+tempo_map_get_bpm_at_frames (
+  TempoMap *     self,
+  signed_frame_t frames)
+{
+  const TempoMapTable * table =
+    (const TempoMapTable *)
+    g_atomic_pointer_get (&self->table);
+  return
+    find_segment_by_frames (
+      table, (double) frames)->bpm;
+}
+
+void
+tempo_map_free (
+  TempoMap * self)
+{
+  g_free_and_null (self->table);
+  free_retired_tables (self, true);
+  g_mutex_clear (&self->rebuild_lock);
+
+  object_zero_and_free (self);
+}
@@ -22,6 +22,7 @@
 #include "audio/automation_track.h"
 #include "audio/port.h"
 #include "audio/router.h"
+#include "audio/tempo_map.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/backend/event.h"
@@ -140,6 +141,22 @@ tempo_track_get_bpm_at_pos (
   Track *    self,
   Position * pos)
 {
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  if (map && tempo_map_is_ready (map))
+    {
+      if (tempo_map_is_automated (map))
+        {
+          return
+            tempo_map_get_bpm_at_ticks (
+              map, pos->ticks);
+        }
+      else
+        {
+          return
+            tempo_track_get_current_bpm (self);
+        }
+    }
+
   AutomationTrack * at =
     automation_track_find_from_port_id (
       &self->bpm_port->id, false);
@@ -1785,37 +1785,10 @@ track_generate_automation_tracks (
         }
     }
 
-  if (track_type_has_piano_roll (track->type))
-    {
-      /* midi automatables */
-      for (int i = 0; i < 16; i++)
-        {
-          Port * cc = NULL;
-          for (int j = 0; j < 128; j++)
-            {
-              cc =
-                track->processor->midi_cc[
-                  i * 128 + j];
-              at = automation_track_new (cc);
-              automation_tracklist_add_at (atl, at);
-            }
-
-          cc =
-            track->processor->pitch_bend[i];
-          at = automation_track_new (cc);
-          automation_tracklist_add_at (atl, at);
-
-          cc =
-            track->processor->poly_key_pressure[i];
-          at = automation_track_new (cc);
-          automation_tracklist_add_at (atl, at);
-
-          cc =
-            track->processor->channel_pressure[i];
-          at = automation_track_new (cc);
-          automation_tracklist_add_at (atl, at);
-        }
-    }
+  /* automation tracks for MIDI automatables are
+   * added when the ports are created on first
+   * use (see
+   * track_processor_get_or_create_midi_automatable()) */
 
   switch (track->type)
     {
@@ -2824,6 +2797,44 @@ track_update_positions (
     &self->automation_tracklist, from_ticks);
 }
 
+/**
+ * Updates the positions of the children of all
+ * regions in the track that need an update.
+ *
+ * @see region_refresh_children_positions().
+ */
+void
+track_refresh_children_positions (
+  Track * self)
+{
+  for (int i = 0; i < self->num_lanes; i++)
+    {
+      TrackLane * lane = self->lanes[i];
+      for (int j = 0; j < lane->num_regions; j++)
+        {
+          region_refresh_children_positions (
+            lane->regions[j]);
+        }
+    }
+  for (int i = 0; i < self->num_chord_regions; i++)
+    {
+      region_refresh_children_positions (
+        self->chord_regions[i]);
+    }
+
+  AutomationTracklist * atl =
+    &self->automation_tracklist;
+  for (int i = 0; i < atl->num_ats; i++)
+    {
+      AutomationTrack * at = atl->ats[i];
+      for (int j = 0; j < at->num_regions; j++)
+        {
+          region_refresh_children_positions (
+            at->regions[j]);
+        }
+    }
+}
+
 /**
  * Wrapper for audio and MIDI/instrument tracks
  * to fill in MidiEvents or StereoPorts from the
@@ -2850,11 +2861,6 @@ track_fill_events (
   const unsigned_frame_t g_end_frames =
     time_nfo->g_start_frame + time_nfo->nframes;
 
-  if (midi_events)
-    {
-      zix_sem_wait (&midi_events->access_sem);
-    }
-
 #if 0
   g_message (
     "%s: TRACK %s STARTING from %ld, "
@@ -3019,12 +3025,10 @@ track_fill_events (
   if (midi_events)
     {
       midi_events_clear_duplicates (
-        midi_events, F_QUEUED);
+        midi_events, F_NOT_QUEUED);
 
       /* sort events */
-      midi_events_sort (midi_events, F_QUEUED);
-
-      zix_sem_post (&midi_events->access_sem);
+      midi_events_sort (midi_events, F_NOT_QUEUED);
     }
 }
 
@@ -3712,6 +3716,65 @@ track_append_ports (
 #undef _ADD
 }
 
+/**
+ * Returns the estimated memory used by the track,
+ * its ports and its arranger objects, in bytes.
+ */
+size_t
+track_get_memory_size (
+  Track * self)
+{
+  size_t size = sizeof (Track);
+
+  for (int i = 0; i < self->num_lanes; i++)
+    {
+      TrackLane * lane = self->lanes[i];
+      size += sizeof (TrackLane);
+      for (int j = 0; j < lane->num_regions; j++)
+        {
+          size +=
+            arranger_object_get_memory_size (
+              (ArrangerObject *) lane->regions[j]);
+        }
+    }
+
+  AutomationTracklist * atl =
+    &self->automation_tracklist;
+  for (int i = 0; i < atl->num_ats; i++)
+    {
+      AutomationTrack * at = atl->ats[i];
+      size += sizeof (AutomationTrack);
+      for (int j = 0; j < at->num_regions; j++)
+        {
+          size +=
+            arranger_object_get_memory_size (
+              (ArrangerObject *) at->regions[j]);
+        }
+    }
+
+  for (int i = 0; i < self->num_chord_regions; i++)
+    {
+      size +=
+        arranger_object_get_memory_size (
+          (ArrangerObject *) self->chord_regions[i]);
+    }
+  size +=
+    (size_t) self->num_scales * sizeof (ScaleObject)
+    + (size_t) self->num_markers * sizeof (Marker);
+
+  if (self->channel)
+    {
+      size += sizeof (Channel);
+    }
+
+  GPtrArray * ports = g_ptr_array_new ();
+  track_append_ports (self, ports, true);
+  size += ports->len * sizeof (Port);
+  g_ptr_array_unref (ports);
+
+  return size;
+}
+
 bool
 track_is_enabled (
   Track * self)
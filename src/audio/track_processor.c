@@ -21,6 +21,8 @@
 
 #include "audio/audio_region.h"
 #include "audio/audio_track.h"
+#include "audio/automation_track.h"
+#include "audio/automation_tracklist.h"
 #include "audio/channel.h"
 #include "audio/clip.h"
 #include "audio/control_port.h"
@@ -28,9 +30,10 @@
 #include "audio/engine.h"
 #include "audio/fader.h"
 #include "audio/midi_event.h"
-#include "audio/midi_mapping.h"
 #include "audio/midi_track.h"
+#include "audio/recording_event.h"
 #include "audio/recording_manager.h"
+#include "audio/router.h"
 #include "audio/track.h"
 #include "project.h"
 #include "settings/settings.h"
@@ -48,35 +51,24 @@ static void
 init_common (
   TrackProcessor * self)
 {
-  if (self->midi_cc[0])
+  /* send the current values of any existing MIDI
+   * CC and pitch bend ports on the first cycle */
+  for (int i = 0; i < 16; i++)
     {
-      self->cc_mappings = midi_mappings_new ();
-
-      for (size_t i = 0; i < 16; i++)
+      for (int j = 0; j < 128; j++)
         {
-          for (size_t j = 0; j < 128; j++)
+          Port * cc = self->midi_cc[i * 128 + j];
+          if (cc)
             {
-              Port * cc_port =
-                self->midi_cc[i * 128 + j];
-              g_return_if_fail (cc_port);
-
-              /* set model bytes for CC:
-               * [0] = ctrl change + channel
-               * [1] = controller
-               * [2] (unused) = control */
-              midi_byte_t buf[3];
-              buf[0] =
-                (midi_byte_t)
-                (MIDI_CH1_CTRL_CHANGE | (midi_byte_t) i);
-              buf[1] = (midi_byte_t) j;
-              buf[2] = 0;
-
-              /* bind */
-              midi_mappings_bind_track (
-                self->cc_mappings, buf,
-                cc_port, F_NO_PUBLISH_EVENTS);
+              track_processor_mark_midi_automatable_dirty (
+                self, cc);
             }
         }
+      if (self->pitch_bend[i])
+        {
+          track_processor_mark_midi_automatable_dirty (
+            self, self->pitch_bend[i]);
+        }
     }
 }
 
@@ -145,86 +137,315 @@ init_midi_port (
     }
 }
 
-static void
-init_midi_cc_ports (
+/**
+ * Returns the slot for the MIDI automatable port
+ * with the given identity, or NULL if invalid.
+ */
+static Port **
+get_midi_automatable_slot (
   TrackProcessor * self,
-  int              loading)
+  PortFlags2       flags2,
+  int              port_index)
 {
-#define INIT_MIDI_PORT(x,idx) \
-  x->id.flags |= PORT_FLAG_MIDI_AUTOMATABLE; \
-  x->id.flags |= PORT_FLAG_AUTOMATABLE; \
-  x->id.port_index = idx; \
-
-  char name[400];
-  for (int i = 0; i < 16; i++)
+  if (flags2 & PORT_FLAG2_MIDI_PITCH_BEND)
     {
-      /* starting from 1 */
-      int channel = i + 1;
+      g_return_val_if_fail (
+        port_index >= 0 && port_index < 16, NULL);
+      return &self->pitch_bend[port_index];
+    }
+  else if (flags2 & PORT_FLAG2_MIDI_POLY_KEY_PRESSURE)
+    {
+      g_return_val_if_fail (
+        port_index >= 0 && port_index < 16, NULL);
+      return &self->poly_key_pressure[port_index];
+    }
+  else if (flags2 & PORT_FLAG2_MIDI_CHANNEL_PRESSURE)
+    {
+      g_return_val_if_fail (
+        port_index >= 0 && port_index < 16, NULL);
+      return &self->channel_pressure[port_index];
+    }
 
-      for (int j = 0; j < 128; j++)
-        {
-          sprintf (
-            name, "Ch%d %s", channel,
-            midi_get_controller_name (j));
-          Port * cc =
-            port_new_with_type_and_owner (
-              TYPE_CONTROL, FLOW_INPUT, name,
-              PORT_OWNER_TYPE_TRACK_PROCESSOR,
-              self);
-          INIT_MIDI_PORT (cc, i * 128 + j);
-          cc->id.sym =
-            g_strdup_printf (
-              "midi_controller_ch%d_%d",
-              channel, j + 1);
-          self->midi_cc[i * 128 + j] = cc;
-        }
+  g_return_val_if_fail (
+    port_index >= 0 && port_index < 128 * 16,
+    NULL);
+  return &self->midi_cc[port_index];
+}
 
+/**
+ * Creates a MIDI automatable port.
+ *
+ * @see track_processor_get_or_create_midi_automatable().
+ */
+static Port *
+create_midi_automatable (
+  TrackProcessor * self,
+  PortFlags2       flags2,
+  int              port_index)
+{
+  char name[400];
+  char * sym;
+  if (flags2 & PORT_FLAG2_MIDI_PITCH_BEND)
+    {
       sprintf (
-        name, "Ch%d Pitch bend", i + 1);
-      Port * cc =
-        port_new_with_type_and_owner (
-          TYPE_CONTROL, FLOW_INPUT, name,
-          PORT_OWNER_TYPE_TRACK_PROCESSOR, self);
-      cc->id.sym =
-        g_strdup_printf ("ch%d_pitch_bend", i + 1);
-      INIT_MIDI_PORT (cc, i);
-      cc->maxf = 8191.f;
-      cc->minf = -8192.f;
-      cc->deff = 0.f;
-      cc->zerof = 0.f;
-      cc->id.flags2 |= PORT_FLAG2_MIDI_PITCH_BEND;
-      self->pitch_bend[i] = cc;
-
+        name, "Ch%d Pitch bend", port_index + 1);
+      sym =
+        g_strdup_printf (
+          "ch%d_pitch_bend", port_index + 1);
+    }
+  else if (flags2 & PORT_FLAG2_MIDI_POLY_KEY_PRESSURE)
+    {
       sprintf (
-        name, "Ch%d Poly key pressure", i + 1);
-      cc =
-        port_new_with_type_and_owner (
-          TYPE_CONTROL, FLOW_INPUT, name,
-          PORT_OWNER_TYPE_TRACK_PROCESSOR, self);
-      cc->id.sym =
+        name, "Ch%d Poly key pressure",
+        port_index + 1);
+      sym =
         g_strdup_printf (
-          "ch%d_poly_key_pressure", i + 1);
-      INIT_MIDI_PORT (cc, i);
-      cc->id.flags2 |=
-        PORT_FLAG2_MIDI_POLY_KEY_PRESSURE;
-      self->poly_key_pressure[i] = cc;
-
+          "ch%d_poly_key_pressure",
+          port_index + 1);
+    }
+  else if (flags2 & PORT_FLAG2_MIDI_CHANNEL_PRESSURE)
+    {
       sprintf (
-        name, "Ch%d Channel pressure", i + 1);
-      cc =
-        port_new_with_type_and_owner (
-          TYPE_CONTROL, FLOW_INPUT, name,
-          PORT_OWNER_TYPE_TRACK_PROCESSOR, self);
-      cc->id.sym =
+        name, "Ch%d Channel pressure",
+        port_index + 1);
+      sym =
+        g_strdup_printf (
+          "ch%d_channel_pressure", port_index + 1);
+    }
+  else
+    {
+      /* starting from 1 */
+      int channel = port_index / 128 + 1;
+      int controller = port_index % 128;
+      sprintf (
+        name, "Ch%d %s", channel,
+        midi_get_controller_name (controller));
+      sym =
         g_strdup_printf (
-          "ch%d_channel_pressure", i + 1);
-      INIT_MIDI_PORT (cc, i);
-      cc->id.flags2 |=
-        PORT_FLAG2_MIDI_CHANNEL_PRESSURE;
-      self->channel_pressure[i] = cc;
+          "midi_controller_ch%d_%d",
+          channel, controller + 1);
+    }
+
+  Port * port =
+    port_new_with_type_and_owner (
+      TYPE_CONTROL, FLOW_INPUT, name,
+      PORT_OWNER_TYPE_TRACK_PROCESSOR, self);
+  port->id.sym = sym;
+  port->id.flags |= PORT_FLAG_MIDI_AUTOMATABLE;
+  port->id.flags |= PORT_FLAG_AUTOMATABLE;
+  port->id.flags2 |= flags2;
+  port->id.port_index = port_index;
+  port->track = self->track;
+  if (flags2 & PORT_FLAG2_MIDI_PITCH_BEND)
+    {
+      port->maxf = 8191.f;
+      port->minf = -8192.f;
+      port->deff = 0.f;
+      port->zerof = 0.f;
+    }
+
+  return port;
+}
+
+/**
+ * Creates the given MIDI automatable port and its
+ * automation track.
+ *
+ * The caller is responsible for making sure the
+ * port is not accessed while processing.
+ */
+static Port *
+add_midi_automatable (
+  TrackProcessor * self,
+  Port **          slot,
+  PortFlags2       flags2,
+  int              port_index)
+{
+  Port * port =
+    create_midi_automatable (
+      self, flags2, port_index);
+  *slot = port;
+
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (self->track);
+  AutomationTrack * at = automation_track_new (port);
+  automation_tracklist_add_at (atl, at);
+
+  if (flags2 == 0)
+    {
+      g_atomic_int_and (
+        &self->midi_cc_requested[port_index / 32],
+        ~(1u << (port_index % 32)));
     }
 
-#undef INIT_MIDI_PORT
+  return port;
+}
+
+/**
+ * Returns whether the processing thread may
+ * access the ports of this track processor.
+ */
+static bool
+is_processed (
+  TrackProcessor * self)
+{
+  return
+    (track_processor_is_in_active_project (self)
+     || track_is_auditioner (self->track))
+    && ROUTER && ROUTER->graph;
+}
+
+/**
+ * Returns the MIDI automatable port with the
+ * given identity, creating it along with its
+ * automation track if it does not exist yet.
+ *
+ * If the track is in the project, the graph is
+ * recalculated after creating the port.
+ *
+ * Must be called from the main thread.
+ *
+ * @param flags2 PORT_FLAG2_MIDI_PITCH_BEND,
+ *   PORT_FLAG2_MIDI_POLY_KEY_PRESSURE,
+ *   PORT_FLAG2_MIDI_CHANNEL_PRESSURE, or 0 for a
+ *   CC.
+ * @param port_index Same as
+ *   PortIdentifier.port_index (channel * 128 +
+ *   controller for CCs, the channel otherwise).
+ */
+Port *
+track_processor_get_or_create_midi_automatable (
+  TrackProcessor * self,
+  PortFlags2       flags2,
+  int              port_index)
+{
+  Port ** slot =
+    get_midi_automatable_slot (
+      self, flags2, port_index);
+  g_return_val_if_fail (slot, NULL);
+  if (*slot)
+    return *slot;
+
+  g_return_val_if_fail (
+    track_type_has_piano_roll (self->track->type),
+    NULL);
+
+  /* the ports and the automation tracklist are
+   * accessed while processing */
+  bool processed = is_processed (self);
+  if (processed)
+    zix_sem_wait (&ROUTER->graph_access);
+
+  Port * port =
+    add_midi_automatable (
+      self, slot, flags2, port_index);
+
+  if (processed)
+    {
+      zix_sem_post (&ROUTER->graph_access);
+      router_recalc_graph (ROUTER, F_NOT_SOFT);
+    }
+
+  return port;
+}
+
+/**
+ * Creates all the MIDI automatable ports of the
+ * given channel (0-15) that do not exist yet.
+ *
+ * Used when the user browses the MIDI
+ * automatables of a channel.
+ *
+ * @return Whether any port was created.
+ */
+bool
+track_processor_create_midi_channel_automatables (
+  TrackProcessor * self,
+  int              channel)
+{
+  g_return_val_if_fail (
+    channel >= 0 && channel < 16
+    && track_type_has_piano_roll (
+         self->track->type),
+    false);
+
+  bool processed = is_processed (self);
+  if (processed)
+    zix_sem_wait (&ROUTER->graph_access);
+
+  bool created = false;
+
+#define ADD_IF_MISSING(flags2,idx) \
+  { \
+    Port ** slot = \
+      get_midi_automatable_slot ( \
+        self, flags2, idx); \
+    if (!*slot) \
+      { \
+        add_midi_automatable ( \
+          self, slot, flags2, idx); \
+        created = true; \
+      } \
+  }
+
+  for (int j = 0; j < 128; j++)
+    {
+      ADD_IF_MISSING (0, channel * 128 + j);
+    }
+  ADD_IF_MISSING (
+    PORT_FLAG2_MIDI_PITCH_BEND, channel);
+  ADD_IF_MISSING (
+    PORT_FLAG2_MIDI_POLY_KEY_PRESSURE, channel);
+  ADD_IF_MISSING (
+    PORT_FLAG2_MIDI_CHANNEL_PRESSURE, channel);
+
+#undef ADD_IF_MISSING
+
+  if (processed)
+    {
+      zix_sem_post (&ROUTER->graph_access);
+      if (created)
+        router_recalc_graph (ROUTER, F_NOT_SOFT);
+    }
+
+  return created;
+}
+
+/**
+ * Marks the given MIDI automatable port as
+ * changed so that its value is sent as a MIDI
+ * event in the next cycle.
+ *
+ * This can be called from any thread.
+ */
+void
+track_processor_mark_midi_automatable_dirty (
+  TrackProcessor * self,
+  const Port *     port)
+{
+  int idx;
+  if (port->id.flags2 & PORT_FLAG2_MIDI_PITCH_BEND)
+    {
+      idx = 128 * 16 + port->id.port_index;
+    }
+  else if (port->id.flags2 &
+             (PORT_FLAG2_MIDI_POLY_KEY_PRESSURE
+              | PORT_FLAG2_MIDI_CHANNEL_PRESSURE))
+    {
+      /* not sent yet */
+      return;
+    }
+  else
+    {
+      idx = port->id.port_index;
+    }
+  g_return_if_fail (
+    idx >= 0
+    && idx < TRACK_PROCESSOR_NUM_MIDI_SENDABLE);
+
+  g_atomic_int_or (
+    &self->midi_dirty[idx / 32],
+    1u << (idx % 32));
 }
 
 /**
@@ -312,10 +533,8 @@ track_processor_new (
             g_strdup ("track_processor_piano_roll");
           self->piano_roll->id.flags =
             PORT_FLAG_PIANO_ROLL;
-          if (tr->type != TRACK_TYPE_CHORD)
-            {
-              init_midi_cc_ports (self, false);
-            }
+          /* MIDI automatables are created on
+           * first use */
         }
       break;
     case TYPE_AUDIO:
@@ -827,69 +1046,135 @@ handle_recording (
 /**
  * Adds events to midi out based on any changes in
  * MIDI CC control ports.
+ *
+ * Only the ports marked in
+ * TrackProcessor.midi_dirty are checked.
  */
 static inline void
 add_events_from_midi_cc_control_ports (
-  const TrackProcessor * self,
-  const nframes_t        local_offset)
+  TrackProcessor * self,
+  const nframes_t  local_offset)
 {
-  /* FIXME optimize (use caches) */
-  for (int i = 0; i < 16; i++)
+  for (int i = 0;
+       i < TRACK_PROCESSOR_MIDI_DIRTY_WORDS; i++)
     {
-      /* starting from 1 */
-      int channel = i + 1;
-      Port * cc = NULL;
-      int offset = i * 128;
-      for (int j = 0; j < 128; j++)
+      if (G_LIKELY (
+            g_atomic_int_get (
+              &self->midi_dirty[i]) == 0))
+        continue;
+
+      guint bits =
+        g_atomic_int_and (&self->midi_dirty[i], 0);
+      gint bit = -1;
+      while ((bit = g_bit_nth_lsf (bits, bit)) >= 0)
         {
-          cc = self->midi_cc[offset + j];
-          if (G_LIKELY (
-                math_floats_equal (
-                  cc->last_sent_control,
-                  cc->control)))
-            continue;
+          int idx = i * 32 + bit;
+          if (idx < 128 * 16)
+            {
+              Port * cc = self->midi_cc[idx];
+              if (!cc
+                  ||
+                  math_floats_equal (
+                    cc->last_sent_control,
+                    cc->control))
+                continue;
+
+              /* starting from 1 */
+              midi_events_add_control_change (
+                self->midi_out->midi_events,
+                (midi_byte_t) (idx / 128 + 1),
+                (midi_byte_t) (idx % 128),
+                (midi_byte_t)
+                math_round_float_to_signed_32 (
+                  cc->control * 127.f),
+                local_offset, false);
+              cc->last_sent_control = cc->control;
+            }
+          else
+            {
+              int channel = idx - 128 * 16;
+              Port * cc = self->pitch_bend[channel];
+              if (!cc
+                  ||
+                  math_floats_equal (
+                    cc->last_sent_control,
+                    cc->control))
+                continue;
+
+              midi_events_add_pitchbend (
+                self->midi_out->midi_events,
+                (midi_byte_t) (channel + 1),
+                math_round_float_to_signed_32 (
+                  cc->control),
+                local_offset, false);
+              cc->last_sent_control = cc->control;
+            }
+        }
+    }
+}
 
-          midi_events_add_control_change (
-            self->midi_out->midi_events,
-            channel, (midi_byte_t) j,
+/**
+ * Applies MIDI CC events in the MIDI input to the
+ * corresponding MIDI CC ports.
+ *
+ * Ports that were not created yet are requested
+ * from the main thread through the recording
+ * manager, which applies the received value after
+ * creating them.
+ *
+ * @note Must only be called while transport is
+ *   recording.
+ */
+static void
+apply_midi_cc_input (
+  TrackProcessor * self,
+  MidiEvents *     events)
+{
+  Track * tr = track_processor_get_track (self);
+  for (int i = 0; i < events->num_events; i++)
+    {
+      MidiEvent * ev = &events->events[i];
+      if (ev->raw_buffer[0] <
+            (midi_byte_t) MIDI_CH1_CTRL_CHANGE ||
+          ev->raw_buffer[0] >
             (midi_byte_t)
-            math_round_float_to_signed_32 (
-              cc->control * 127.f),
-            local_offset, false);
-          cc->last_sent_control = cc->control;
-        }
+            (MIDI_CH1_CTRL_CHANGE | 15))
+        continue;
 
-      cc = self->pitch_bend[i];
-      if (!math_floats_equal (
-            cc->last_sent_control, cc->control))
+      int idx =
+        (ev->raw_buffer[0] & 0xf) * 128
+        + (ev->raw_buffer[1] & 0x7f);
+      Port * cc = self->midi_cc[idx];
+      if (cc)
         {
-          midi_events_add_pitchbend (
-            self->midi_out->midi_events,
-            channel,
-            math_round_float_to_signed_32 (
-              cc->control),
-            local_offset, false);
-          cc->last_sent_control = cc->control;
+          float normalized_val =
+            (float) ev->raw_buffer[2] / 127.f;
+          port_set_control_value (
+            cc, normalized_val, F_NORMALIZED,
+            F_PUBLISH_EVENTS);
+          continue;
         }
 
-      /* TODO */
-#if 0
-      cc = self->poly_key_pressure[i];
-      midi_events_add_pitchbend (
-        self->midi_out->midi_events,
-        channel,
-        math_round_float_to_int (cc->control),
-        local_offset, false);
-      cc->last_sent_control = cc->control;
+      /* request the port only once */
+      guint bit = 1u << (idx % 32);
+      guint prev_bits =
+        g_atomic_int_or (
+          &self->midi_cc_requested[idx / 32], bit);
+      if (prev_bits & bit)
+        continue;
 
-      cc = self->channel_pressure[i];
-      midi_events_add_pitchbend (
-        self->midi_out->midi_events,
-        channel,
-        math_round_float_to_int (cc->control),
-        local_offset, false);
-      cc->last_sent_control = cc->control;
-#endif
+      RecordingEvent * re =
+        (RecordingEvent *)
+        object_pool_get (
+          RECORDING_MANAGER->event_obj_pool);
+      recording_event_init (re);
+      re->type =
+        RECORDING_EVENT_TYPE_CREATE_MIDI_CC_PORT;
+      re->track_name_hash = tr->name_hash;
+      re->has_midi_event = 1;
+      midi_event_copy (&re->midi_event, ev);
+      recording_event_queue_push_back_event (
+        RECORDING_MANAGER->event_queue, re);
     }
 }
 
@@ -944,12 +1229,17 @@ track_processor_process (
     {
       Port * pr = self->piano_roll;
 
+      /* the piano roll events only contain the
+       * events of the current split */
+      midi_events_clear (
+        pr->midi_events, F_NOT_QUEUED);
+
       /* panic MIDI if necessary */
       if (g_atomic_int_get (
             &AUDIO_ENGINE->panic))
         {
           midi_events_panic (
-            pr->midi_events, 1);
+            pr->midi_events, F_NOT_QUEUED);
         }
       /* get events from track if playing */
       else if (TRANSPORT->play_state ==
@@ -982,7 +1272,7 @@ track_processor_process (
       if (tr->type != TRACK_TYPE_CHORD)
         {
           add_events_from_midi_cc_control_ports (
-            self, local_offset);
+            (TrackProcessor *) self, local_offset);
         }
       if (self->midi_out->midi_events->num_events > 0)
         {
@@ -1106,13 +1396,13 @@ track_processor_process (
             tr->midi_ch);
         }
 
-      /* process midi bindings */
-      if (self->cc_mappings && TRANSPORT->recording)
+      /* apply MIDI CCs to the CC ports */
+      if (track_type_has_piano_roll (tr->type)
+          && TRANSPORT->recording)
         {
-          midi_mappings_apply_from_cc_events (
-            self->cc_mappings,
-            self->midi_in->midi_events,
-            F_NOT_QUEUED);
+          apply_midi_cc_input (
+            (TrackProcessor *) self,
+            self->midi_in->midi_events);
         }
 
       midi_events_append (
@@ -1135,7 +1425,7 @@ track_processor_process (
        * input content to the output ports.
        * this will also create automation for MIDI
        * CC, if any (see
-       * midi_mappings_apply_cc_events above) */
+       * apply_midi_cc_input above) */
       handle_recording (self, time_nfo);
     }
 
@@ -1182,6 +1472,40 @@ track_processor_copy_values (
     {
       dest->mono->control = src->mono->control;
     }
+
+#define COPY_MIDI_AUTOMATABLE(arr,flags2,idx) \
+  if (src->arr[idx]) \
+    { \
+      if (!dest->arr[idx]) \
+        { \
+          dest->arr[idx] = \
+            create_midi_automatable ( \
+              dest, flags2, idx); \
+        } \
+      port_copy_values ( \
+        dest->arr[idx], src->arr[idx]); \
+      track_processor_mark_midi_automatable_dirty ( \
+        dest, dest->arr[idx]); \
+    }
+
+  for (int i = 0; i < 16; i++)
+    {
+      for (int j = 0; j < 128; j++)
+        {
+          COPY_MIDI_AUTOMATABLE (
+            midi_cc, 0, i * 128 + j);
+        }
+      COPY_MIDI_AUTOMATABLE (
+        pitch_bend, PORT_FLAG2_MIDI_PITCH_BEND, i);
+      COPY_MIDI_AUTOMATABLE (
+        poly_key_pressure,
+        PORT_FLAG2_MIDI_POLY_KEY_PRESSURE, i);
+      COPY_MIDI_AUTOMATABLE (
+        channel_pressure,
+        PORT_FLAG2_MIDI_CHANNEL_PRESSURE, i);
+    }
+
+#undef COPY_MIDI_AUTOMATABLE
 }
 
 /**
@@ -1391,9 +1715,6 @@ void
 track_processor_free (
   TrackProcessor * self)
 {
-  object_free_w_func_and_null (
-    midi_mappings_free, self->cc_mappings);
-
   if (IS_PORT_AND_NONNULL (self->mono))
     {
       port_disconnect_all (self->mono);
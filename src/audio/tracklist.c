@@ -506,13 +506,30 @@ tracklist_find_track_by_name_hash (
     }
   else
     {
+      /* consecutive searches (eg, when editing the
+       * notes of a region) are usually for the same
+       * track */
+      int last_pos =
+        g_atomic_int_get (&self->last_found_pos);
+      if (last_pos < self->num_tracks)
+        {
+          Track * track = self->tracks[last_pos];
+          if (IS_TRACK_AND_NONNULL (track)
+              && track_get_name_hash (track) == hash)
+            return track;
+        }
+
       for (int i = 0; i < self->num_tracks; i++)
         {
           Track * track = self->tracks[i];
           g_return_val_if_fail (
             IS_TRACK_AND_NONNULL (track), NULL);
           if (track_get_name_hash (track) == hash)
-            return track;
+            {
+              g_atomic_int_set (
+                &self->last_found_pos, i);
+              return track;
+            }
         }
     }
   return NULL;
@@ -699,14 +699,10 @@ transport_move_playhead (
                           piano_roll->
                             midi_events;
 
-                      zix_sem_wait (
-                        &midi_events->access_sem);
                       midi_events_add_note_off (
                         midi_events, 1,
                         midi_note->val,
                         0, 1);
-                      zix_sem_post (
-                        &midi_events->access_sem);
                     }
                 }
             }
@@ -972,6 +968,51 @@ transport_position_add_frames (
   /*pos->frames = new_global_frames;*/
 }
 
+/**
+ * Fills in a transport snapshot for the given
+ * position.
+ *
+ * @param nframes Number of frames the snapshot
+ *   covers.
+ */
+void
+transport_snapshot_init (
+  TransportSnapshot * snapshot,
+  const Transport *   self,
+  const Position *    pos,
+  nframes_t           nframes)
+{
+  snapshot->frame = (unsigned_frame_t) pos->frames;
+  snapshot->nframes = nframes;
+  snapshot->pos = *pos;
+  snapshot->end_pos = *pos;
+  transport_position_add_frames (
+    self, &snapshot->end_pos, (long) nframes);
+  snapshot->loop_crossed =
+    snapshot->end_pos.frames
+    != pos->frames + (signed_frame_t) nframes;
+  snapshot->rolling =
+    self->play_state == PLAYSTATE_ROLLING;
+
+  snapshot->bar = position_get_bars (pos, true);
+  snapshot->beat = position_get_beats (pos, true);
+  snapshot->sixteenth =
+    position_get_sixteenths (pos, true);
+  snapshot->ticks = position_get_ticks (pos);
+  Position bar_start;
+  position_set_to_bar (&bar_start, snapshot->bar);
+  snapshot->bar_ticks =
+    pos->ticks - bar_start.ticks;
+
+  snapshot->beats_per_bar =
+    tempo_track_get_beats_per_bar (P_TEMPO_TRACK);
+  snapshot->beat_unit =
+    tempo_track_get_beat_unit (P_TEMPO_TRACK);
+  snapshot->ticks_per_beat = self->ticks_per_beat;
+  snapshot->bpm =
+    tempo_track_get_current_bpm (P_TEMPO_TRACK);
+}
+
 /**
  * Sets if the project has range and updates UI.
  */
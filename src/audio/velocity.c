@@ -117,6 +117,10 @@ velocity_shift (
   self->vel =
     (midi_byte_t)
     ((int) self->vel + delta);
+
+  MidiNote * note = velocity_get_midi_note (self);
+  g_return_if_fail (IS_MIDI_NOTE (note));
+  midi_note_notify_changed (note);
 }
 
 /**
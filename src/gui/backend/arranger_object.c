@@ -23,9 +23,11 @@
 #include "audio/chord_region.h"
 #include "audio/chord_track.h"
 #include "audio/marker_track.h"
+#include "audio/midi_note.h"
 #include "audio/midi_region.h"
 #include "audio/router.h"
 #include "audio/stretcher.h"
+#include "audio/tempo_map.h"
 #include "gui/backend/arranger_object.h"
 #include "gui/backend/automation_selections.h"
 #include "gui/backend/chord_selections.h"
@@ -256,6 +258,7 @@ set_to_midi_note_object (
     dest && dest->vel && src && src->vel);
   dest->vel->vel = src->vel->vel;
   dest->val = src->val;
+  midi_note_notify_changed (dest);
 }
 
 /**
@@ -268,6 +271,10 @@ arranger_object_set_muted (
   bool             fire_events)
 {
   self->muted = muted;
+  if (self->type == TYPE (MIDI_NOTE))
+    {
+      midi_note_notify_changed ((MidiNote *) self);
+    }
 
   if (fire_events)
     {
@@ -715,6 +722,39 @@ arranger_object_set_position (
   pos_ptr = get_position_ptr (self, pos_type);
   g_return_if_fail (pos_ptr);
   position_set_to_pos (pos_ptr, pos);
+  if (self->type == TYPE (MIDI_NOTE))
+    {
+      midi_note_notify_changed ((MidiNote *) self);
+    }
+
+  /* with tempo automation, the frames of region
+   * children depend on the region start */
+  if (!AUDIO_ENGINE->tempo_map
+      || !tempo_map_is_automated (
+            AUDIO_ENGINE->tempo_map))
+    return;
+
+  if (self->type == TYPE (REGION))
+    {
+      if (pos_type
+            == ARRANGER_OBJECT_POSITION_TYPE_START)
+        {
+          region_invalidate_children_positions (
+            (ZRegion *) self);
+        }
+    }
+  else if (!arranger_object_type_has_global_pos (
+              self->type)
+           && self->type != TYPE (VELOCITY))
+    {
+      ZRegion * r = arranger_object_get_region (self);
+      if (r)
+        {
+          position_update_local (
+            pos_ptr, true,
+            &((ArrangerObject *) r)->pos);
+        }
+    }
 }
 
 /**
@@ -1139,9 +1179,39 @@ arranger_object_init_loaded (
     }
 }
 
+/**
+ * Updates the positions of a child of @p region
+ * (eg, a MIDI note) relative to the start of the
+ * region.
+ *
+ * @param from_ticks Whether to update the
+ *   positions based on ticks (true) or frames
+ *   (false).
+ */
+void
+arranger_object_update_child_positions (
+  ArrangerObject * self,
+  ZRegion *        region,
+  bool             from_ticks)
+{
+  const Position * start =
+    &((ArrangerObject *) region)->pos;
+  position_update_local (
+    &self->pos, from_ticks, start);
+  if (arranger_object_type_has_length (self->type))
+    {
+      position_update_local (
+        &self->end_pos, from_ticks, start);
+    }
+}
+
 /**
  * Updates the positions in each child recursively.
  *
+ * When updating from ticks, the children of
+ * regions are only marked as needing an update
+ * (see region_refresh_children_positions()).
+ *
  * @param from_ticks Whether to update the
  *   positions based on ticks (true) or frames
  *   (false).
@@ -1231,32 +1301,47 @@ arranger_object_update_positions (
             (signed_frame_t) clip->num_frames);
         }
 
+      /* children are updated lazily when
+       * accessed, since regions may have a lot of
+       * them */
+      if (from_ticks)
+        {
+          region_invalidate_children_positions (r);
+          break;
+        }
+
       for (int i = 0; i < r->num_midi_notes; i++)
         {
-          arranger_object_update_positions (
-            (ArrangerObject *) r->midi_notes[i],
+          arranger_object_update_child_positions (
+            (ArrangerObject *) r->midi_notes[i], r,
             from_ticks);
         }
       for (int i = 0; i < r->num_unended_notes; i++)
         {
-          arranger_object_update_positions (
-            (ArrangerObject *) r->unended_notes[i],
+          arranger_object_update_child_positions (
+            (ArrangerObject *) r->unended_notes[i], r,
             from_ticks);
         }
 
       for (int i = 0; i < r->num_aps; i++)
         {
-          arranger_object_update_positions (
-            (ArrangerObject *) r->aps[i],
+          arranger_object_update_child_positions (
+            (ArrangerObject *) r->aps[i], r,
             from_ticks);
         }
 
       for (int i = 0; i < r->num_chord_objects; i++)
         {
-          arranger_object_update_positions (
-            (ArrangerObject *) r->chord_objects[i],
+          arranger_object_update_child_positions (
+            (ArrangerObject *) r->chord_objects[i], r,
             from_ticks);
         }
+
+      /* publish after the children are updated */
+      g_atomic_int_set (
+        &r->children_epoch,
+        tempo_map_get_epoch (
+          AUDIO_ENGINE->tempo_map));
       break;
     default:
       break;
@@ -2297,6 +2382,10 @@ clone_region (
 {
   g_return_val_if_fail (region->name, NULL);
 
+  /* the clone's children are assumed to be up to
+   * date */
+  region_refresh_children_positions (region);
+
   ArrangerObject * r_obj =
     (ArrangerObject *) region;
   ZRegion * new_region = NULL;
@@ -2861,10 +2950,9 @@ arranger_object_split (
           g_return_if_fail (prev_r1_clip);
           float frames[
             localp.frames * prev_r1_clip->channels];
-          dsp_copy (
-            &frames[0], &prev_r1_clip->frames[0],
-            (size_t) localp.frames *
-              prev_r1_clip->channels);
+          audio_clip_copy_frames (
+            prev_r1_clip, &frames[0], 0,
+            (unsigned_frame_t) localp.frames);
           g_return_if_fail (prev_r1->name);
           z_return_if_fail_cmp (
             localp.frames, >=, 0);
@@ -2950,12 +3038,10 @@ arranger_object_split (
             (size_t) r2_local_end.frames *
               prev_r2_clip->channels;
           float frames[num_frames];
-          dsp_copy (
-            &frames[0],
-            &prev_r2_clip->frames[
-              (size_t) localp.frames *
-                prev_r2_clip->channels],
-            num_frames);
+          audio_clip_copy_frames (
+            prev_r2_clip, &frames[0],
+            (unsigned_frame_t) localp.frames,
+            (unsigned_frame_t) r2_local_end.frames);
           g_return_if_fail (prev_r2->name);
           z_return_if_fail_cmp (
             r2_local_end.frames, >=, 0);
@@ -3841,6 +3927,55 @@ free_midi_note (
   object_zero_and_free (self);
 }
 
+/**
+ * Returns the estimated memory used by the object
+ * and its children (eg, MIDI notes in a region),
+ * in bytes.
+ */
+size_t
+arranger_object_get_memory_size (
+  ArrangerObject * self)
+{
+  switch (self->type)
+    {
+    case TYPE (REGION):
+      {
+        ZRegion * r = (ZRegion *) self;
+        size_t size = sizeof (ZRegion);
+        size +=
+          (size_t) r->num_midi_notes
+          * (sizeof (MidiNote *)
+             + sizeof (MidiNote)
+             + sizeof (Velocity));
+        size +=
+          (size_t) r->num_aps
+          * (sizeof (AutomationPoint *)
+             + sizeof (AutomationPoint));
+        size +=
+          (size_t) r->num_chord_objects
+          * (sizeof (ChordObject *)
+             + sizeof (ChordObject));
+        return size;
+      }
+    case TYPE (MIDI_NOTE):
+      return sizeof (MidiNote) + sizeof (Velocity);
+    case TYPE (MARKER):
+      return sizeof (Marker);
+    case TYPE (CHORD_OBJECT):
+      return sizeof (ChordObject);
+    case TYPE (SCALE_OBJECT):
+      return sizeof (ScaleObject);
+    case TYPE (AUTOMATION_POINT):
+      return sizeof (AutomationPoint);
+    case TYPE (VELOCITY):
+      return sizeof (Velocity);
+    default:
+      break;
+    }
+
+  g_return_val_if_reached (0);
+}
+
 /**
  * Frees only this object.
  */
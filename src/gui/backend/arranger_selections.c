@@ -2365,6 +2365,13 @@ arranger_selections_merge (
             /* add all audio data */
             AudioClip * clip =
               audio_region_get_clip (r);
+            if (!audio_clip_make_resident (clip))
+              {
+                g_warning (
+                  "failed to load clip %s",
+                  clip->name);
+                continue;
+              }
             dsp_add2 (
               &lframes[frames_diff],
               clip->ch_frames[0],
@@ -2680,19 +2687,22 @@ arranger_selections_get_all_objects (
   MidiArrangerSelections * mas;
   AutomationSelections * as;
 
-  ArrangerObject ** objs =
-    object_new_n (1, ArrangerObject *);
   *size = 0;
+  if (self->type == TYPE (AUDIO))
+    return NULL;
+
+  /* allocate once instead of growing the array
+   * for each object */
+  int num_objs =
+    arranger_selections_get_num_objects (self);
+  g_return_val_if_fail (num_objs >= 0, NULL);
+  ArrangerObject ** objs =
+    object_new_n (
+      (size_t) MAX (num_objs, 1), ArrangerObject *);
 
 #define ADD_OBJ(sel,sc) \
   for (int i = 0; i < sel->num_##sc##s; i++) \
     { \
-      ArrangerObject ** new_objs = \
-        g_realloc ( \
-          objs, \
-          (size_t) (*size + 1) * \
-            sizeof (ArrangerObject *)); \
-      objs = new_objs; \
       objs[*size] = \
         (ArrangerObject *) sel->sc##s[i]; \
       (*size)++; \
@@ -2724,9 +2734,8 @@ arranger_selections_get_all_objects (
       ADD_OBJ (
         cs, chord_object);
       break;
-    case TYPE (AUDIO):
-      return NULL;
     default:
+      free (objs);
       g_return_val_if_reached (NULL);
     }
 #undef ADD_OBJ
@@ -2734,6 +2743,30 @@ arranger_selections_get_all_objects (
   return objs;
 }
 
+/**
+ * Returns the estimated memory used by the
+ * selections and their objects, in bytes.
+ */
+size_t
+arranger_selections_get_memory_size (
+  ArrangerSelections * self)
+{
+  int num_objs = 0;
+  ArrangerObject ** objs =
+    arranger_selections_get_all_objects (
+      self, &num_objs);
+
+  size_t size = sizeof (*self);
+  for (int i = 0; i < num_objs; i++)
+    {
+      size +=
+        arranger_object_get_memory_size (objs[i]);
+    }
+  free (objs);
+
+  return size;
+}
+
 ArrangerSelections *
 arranger_selections_get_for_type (
   ArrangerSelectionsType type)
@@ -27,15 +27,19 @@
 #include "audio/automation_tracklist.h"
 #include "audio/channel.h"
 #include "audio/clip.h"
+#include "audio/midi_region.h"
 #include "audio/modulator_track.h"
 #include "audio/pool.h"
 #include "audio/router.h"
 #include "audio/stretcher.h"
 #include "audio/track.h"
+#include "audio/track_lane.h"
+#include "audio/tracklist.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/backend/clip_editor.h"
 #include "gui/backend/piano_roll.h"
+#include "gui/widgets/arranger.h"
 #include "gui/widgets/arranger_object.h"
 #include "gui/widgets/audio_arranger.h"
 #include "gui/widgets/audio_editor_space.h"
@@ -502,9 +506,27 @@ on_mixer_selections_changed (void)
     MW_LEFT_DOCK_EDGE);
 }
 
+/**
+ * Queues a draw of the track's canvas without
+ * waiting for the refresh scheduler to compare
+ * its state.
+ */
+static void
+redraw_track_canvas (
+  Track * track)
+{
+  if (track->widget && track->widget->canvas)
+    {
+      gtk_widget_queue_draw (
+        GTK_WIDGET (track->widget->canvas));
+    }
+}
+
 static void
 on_track_color_changed (Track * track)
 {
+  redraw_track_canvas (track);
+
   if (track_type_has_channel (track->type))
     {
       if (track->channel->widget)
@@ -520,6 +542,8 @@ on_track_color_changed (Track * track)
 static void
 on_track_name_changed (Track * track)
 {
+  redraw_track_canvas (track);
+
   /* refresh all because tracks routed to/from are
    * also affected */
   mixer_widget_soft_refresh (MW_MIXER);
@@ -662,6 +686,107 @@ on_plugin_visibility_changed (Plugin * pl)
   /*return FALSE;*/
 /*}*/
 
+/**
+ * Key used for events without an argument, since
+ * NULL means the slot is free.
+ */
+static char null_arg_key;
+
+static inline guint
+get_pending_slot_idx (
+  void * arg)
+{
+  guintptr hash =
+    ((guintptr) arg >> 4) * (guintptr) 2654435761u;
+  return
+    (guint) (hash >> 8)
+    & (EVENT_MANAGER_PENDING_SLOTS - 1);
+}
+
+/**
+ * Marks an event as pending until it is
+ * processed.
+ *
+ * Real-time safe.
+ *
+ * @param[out] slot Slot to store in
+ *   ZEvent.pending_slot, or NULL if the event
+ *   could not be tracked (it will be pushed
+ *   anyway).
+ *
+ * @return Whether the event should be pushed
+ *   (false if an identical event is already
+ *   pending).
+ */
+bool
+event_manager_mark_pending (
+  EventManager * self,
+  EventType      type,
+  void *         arg,
+  gpointer **    slot)
+{
+  *slot = NULL;
+  g_return_val_if_fail (
+    type < NUM_EVENT_TYPES, true);
+
+  gpointer key = arg ? arg : &null_arg_key;
+  gpointer * cur_slot =
+    &self->pending[type][get_pending_slot_idx (
+      arg)];
+  if (g_atomic_pointer_compare_and_exchange (
+        cur_slot, NULL, key))
+    {
+      *slot = cur_slot;
+      return true;
+    }
+
+  /* if the same event is pending, drop this one,
+   * otherwise the slot is used by another object
+   * so push it without coalescing */
+  return g_atomic_pointer_get (cur_slot) != key;
+}
+
+/**
+ * Clears the pending mark of the given event.
+ *
+ * Must be called before the event is processed or
+ * dropped.
+ */
+void
+event_manager_unmark_pending (
+  EventManager * self,
+  ZEvent *       ev)
+{
+  if (ev->pending_slot)
+    {
+      g_atomic_pointer_set (
+        ev->pending_slot, NULL);
+      ev->pending_slot = NULL;
+    }
+}
+
+static guint
+event_hash (
+  gconstpointer data)
+{
+  const ZEvent * ev = (const ZEvent *) data;
+  return
+    g_direct_hash (ev->arg) * 31u
+    + (guint) ev->type;
+}
+
+static gboolean
+event_equal (
+  gconstpointer a,
+  gconstpointer b)
+{
+  const ZEvent * ev1 = (const ZEvent *) a;
+  const ZEvent * ev2 = (const ZEvent *) b;
+  return
+    ev1->type == ev2->type
+    && ev1->arg == ev2->arg;
+}
+
 static inline void
 clean_duplicates_and_copy (
   EventManager * self,
@@ -672,25 +797,20 @@ clean_duplicates_and_copy (
 
   g_ptr_array_remove_range (
     events_arr, 0, events_arr->len);
+  g_hash_table_remove_all (self->events_set);
 
   /* only add events once to new array while
    * popping */
   while (event_queue_dequeue_event (
            q, &event))
     {
-      bool already_exists = false;
+      /* events pushed from now on must not be
+       * dropped, since this one may be processed
+       * before the changes they announce */
+      event_manager_unmark_pending (self, event);
 
-      for (guint i = 0; i < events_arr->len; i++)
-        {
-          ZEvent * cur_event =
-            (ZEvent *)
-            g_ptr_array_index (events_arr, i);
-          if (event->type == cur_event->type &&
-              event->arg == cur_event->arg)
-            already_exists = true;
-        }
-
-      if (already_exists)
+      if (!g_hash_table_add (
+             self->events_set, event))
         {
           object_pool_return (
             self->obj_pool, event);
@@ -716,6 +836,118 @@ soft_recalc_graph_when_paused (
   return G_SOURCE_CONTINUE;
 }
 
+/**
+ * Marks the cached content of the arrangers
+ * affected by the given event as stale.
+ *
+ * Events that don't change anything drawn in the
+ * cached content (eg, the playhead, which is an
+ * overlay) are ignored.
+ */
+static void
+invalidate_arranger_content (
+  ZEvent * ev)
+{
+  if (!MAIN_WINDOW)
+    return;
+
+  switch (ev->type)
+    {
+    case ET_ARRANGER_OBJECT_CREATED:
+    case ET_ARRANGER_OBJECT_CHANGED:
+      {
+        ArrangerObject * obj =
+          (ArrangerObject *) ev->arg;
+        if (obj && IS_ARRANGER_OBJECT (obj))
+          {
+            arranger_widget_invalidate_content_for_object_type (
+              obj->type);
+          }
+        else
+          {
+            arranger_widget_invalidate_all_content ();
+          }
+      }
+      break;
+    case ET_ARRANGER_OBJECT_REMOVED:
+      arranger_widget_invalidate_content_for_object_type (
+        (ArrangerObjectType)
+        GPOINTER_TO_INT (ev->arg));
+      break;
+    case ET_ARRANGER_SELECTIONS_CREATED:
+    case ET_ARRANGER_SELECTIONS_CHANGED:
+    case ET_ARRANGER_SELECTIONS_CHANGED_REDRAW_EVERYTHING:
+    case ET_ARRANGER_SELECTIONS_REMOVED:
+    case ET_ARRANGER_SELECTIONS_MOVED:
+    case ET_ARRANGER_SELECTIONS_QUANTIZED:
+    case ET_ARRANGER_SELECTIONS_IN_TRANSIT:
+    case ET_ARRANGER_SELECTIONS_ACTION_FINISHED:
+      {
+        ArrangerSelections * sel =
+          (ArrangerSelections *) ev->arg;
+        if (IS_ARRANGER_SELECTIONS_AND_NONNULL (sel))
+          {
+            arranger_widget_invalidate_content_for_selections (
+              sel);
+          }
+        else
+          {
+            arranger_widget_invalidate_all_content ();
+          }
+      }
+      break;
+    case ET_AUTOMATION_VALUE_CHANGED:
+      /* the automation values are overlays, so
+       * only a redraw with the cached content is
+       * needed */
+      if (MW_TIMELINE)
+        gtk_widget_queue_draw (
+          GTK_WIDGET (MW_TIMELINE));
+      if (MW_PINNED_TIMELINE)
+        gtk_widget_queue_draw (
+          GTK_WIDGET (MW_PINNED_TIMELINE));
+      break;
+    /* not drawn in the arranger content */
+    case ET_PLAYHEAD_POS_CHANGED:
+    case ET_PIANO_ROLL_KEY_ON_OFF:
+    case ET_CHANNEL_FADER_VAL_CHANGED:
+    case ET_CHANNEL_OUTPUT_CHANGED:
+    case ET_CHANNEL_SLOTS_CHANGED:
+    case ET_CHANNEL_SEND_CHANGED:
+    case ET_MIXER_SELECTIONS_CHANGED:
+    case ET_MIXER_CHANNEL_MIDI_FX_EXPANDED_CHANGED:
+    case ET_MIXER_CHANNEL_INSERTS_EXPANDED_CHANGED:
+    case ET_MIXER_CHANNEL_SENDS_EXPANDED_CHANGED:
+    case ET_PLUGIN_VISIBILITY_CHANGED:
+    case ET_PLUGIN_WINDOW_VISIBILITY_CHANGED:
+    case ET_PLUGIN_STATE_CHANGED:
+    case ET_PLUGIN_LATENCY_CHANGED:
+    case ET_PLUGIN_PRESET_SAVED:
+    case ET_PLUGIN_PRESET_LOADED:
+    case ET_PLUGIN_COLLETIONS_CHANGED:
+    case ET_MODULATOR_ADDED:
+    case ET_PORT_CONNECTION_CHANGED:
+    case ET_MIDI_BINDINGS_CHANGED:
+    case ET_ENGINE_ACTIVATE_CHANGED:
+    case ET_ENGINE_BUFFER_SIZE_CHANGED:
+    case ET_ENGINE_SAMPLE_RATE_CHANGED:
+    case ET_JACK_TRANSPORT_TYPE_CHANGED:
+    case ET_TRANSPORT_RECORDING_ON_OFF_CHANGED:
+    case ET_PLAYHEAD_SCROLL_MODE_CHANGED:
+    case ET_TOOL_CHANGED:
+    case ET_PROJECT_SAVED:
+    case ET_LOG_WARNING_STATE_CHANGED:
+    case ET_FILE_BROWSER_BOOKMARK_ADDED:
+    case ET_FILE_BROWSER_BOOKMARK_DELETED:
+    case ET_SPLASH_CLOSED:
+    case ET_TRIAL_LIMIT_REACHED:
+      break;
+    default:
+      arranger_widget_invalidate_all_content ();
+      break;
+    }
+}
+
 /**
  * Processes the given event.
  *
@@ -1383,6 +1615,39 @@ event_manager_process_event (
         ev->type);
       break;
     }
+
+  invalidate_arranger_content (ev);
+}
+
+/**
+ * Updates the note columns used for playback of
+ * all MIDI regions.
+ *
+ * Only regions whose notes version or children
+ * epoch changed are rebuilt, so this is cheap
+ * when nothing changed. Regions waiting for
+ * their children positions to be refreshed after
+ * a tempo change are rebuilt on a later pass.
+ */
+static void
+update_midi_note_columns (void)
+{
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+      for (int j = 0; j < track->num_lanes; j++)
+        {
+          TrackLane * lane = track->lanes[j];
+          for (int k = 0; k < lane->num_regions; k++)
+            {
+              ZRegion * r = lane->regions[k];
+              if (r->id.type != REGION_TYPE_MIDI)
+                continue;
+
+              midi_region_update_note_columns (r);
+            }
+        }
+    }
 }
 
 /**
@@ -1431,6 +1696,14 @@ return_to_pool:
     }
   /*g_message ("processed %d events", i);*/
 
+  /* notes may also change without publishing
+   * events (eg, while recording), so always check
+   * what the engine plays */
+  if (PROJECT && TRACKLIST)
+    {
+      update_midi_note_columns ();
+    }
+
   if (self->events_arr->len > 6)
     g_message ("More than 6 events processed. "
                "Optimization needed.");
@@ -1489,6 +1762,8 @@ event_manager_new (void)
 
   self->events_arr =
     g_ptr_array_sized_new (200);
+  self->events_set =
+    g_hash_table_new (event_hash, event_equal);
 
   return self;
 }
@@ -1548,6 +1823,8 @@ event_manager_remove_events_for_obj (
     {
       if (event->arg == obj)
         {
+          event_manager_unmark_pending (
+            self, event);
           object_pool_return (
             self->obj_pool, event);
         }
@@ -1572,6 +1849,8 @@ event_manager_free (
     mpmc_queue_free, self->mqueue);
   object_free_w_func_and_null (
     g_ptr_array_unref, self->events_arr);
+  object_free_w_func_and_null (
+    g_hash_table_destroy, self->events_set);
 
   object_zero_and_free (self);
 
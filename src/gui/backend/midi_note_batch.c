@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "audio/midi_note.h"
+#include "audio/position.h"
+#include "audio/quantize_options.h"
+#include "audio/region.h"
+#include "audio/velocity.h"
+#include "gui/backend/arranger_object.h"
+#include "gui/backend/midi_arranger_selections.h"
+#include "gui/backend/midi_note_batch.h"
+#include "utils/arrays.h"
+#include "utils/flags.h"
+#include "utils/math.h"
+#include "utils/objects.h"
+
+/**
+ * Returns the index of the region the note
+ * belongs to in the batch, adding the region if
+ * needed.
+ *
+ * @param last_idx The index returned in the
+ *   previous call, used to skip the search since
+ *   consecutive notes are usually in the same
+ *   region.
+ */
+static int
+get_region_idx (
+  MidiNoteBatch *          self,
+  const RegionIdentifier * id,
+  int                      last_idx)
+{
+  if (last_idx >= 0
+      &&
+      region_identifier_is_equal (
+        &self->regions[last_idx]->id, id))
+    return last_idx;
+
+  for (int i = 0; i < self->num_regions; i++)
+    {
+      if (region_identifier_is_equal (
+            &self->regions[i]->id, id))
+        return i;
+    }
+
+  ZRegion * r = region_find (id);
+  if (!r)
+    return -1;
+
+  array_double_size_if_full (
+    self->regions, self->num_regions,
+    self->regions_size, ZRegion *);
+  self->regions[self->num_regions++] = r;
+
+  return self->num_regions - 1;
+}
+
+/**
+ * Creates a batch with the values of the notes
+ * in the given selections.
+ *
+ * The selections may contain clones of the
+ * project notes (eg, the selections at the start
+ * of a drag), but the notes must exist in the
+ * project. Each region is only looked up once.
+ *
+ * @return The batch, or NULL if a note could not
+ *   be found in the project.
+ */
+MidiNoteBatch *
+midi_note_batch_new_from_selections (
+  MidiArrangerSelections * sel)
+{
+  MidiNoteBatch * self =
+    object_new (MidiNoteBatch);
+
+  size_t num_notes =
+    (size_t) MAX (sel->num_midi_notes, 1);
+  self->region_idxs =
+    object_new_n (num_notes, int);
+  self->note_idxs = object_new_n (num_notes, int);
+  self->start_ticks =
+    object_new_n (num_notes, double);
+  self->end_ticks =
+    object_new_n (num_notes, double);
+  self->pitches = object_new_n (num_notes, uint8_t);
+  self->vels = object_new_n (num_notes, uint8_t);
+  self->regions_size = 1;
+  self->regions =
+    object_new_n (self->regions_size, ZRegion *);
+
+  int region_idx = -1;
+  for (int i = 0; i < sel->num_midi_notes; i++)
+    {
+      MidiNote * sel_mn = sel->midi_notes[i];
+      ArrangerObject * sel_mn_obj =
+        (ArrangerObject *) sel_mn;
+      region_idx =
+        get_region_idx (
+          self, &sel_mn_obj->region_id,
+          region_idx);
+      if (region_idx < 0)
+        {
+          g_warning (
+            "region for note %d not found", i);
+          midi_note_batch_free (self);
+          return NULL;
+        }
+
+      ZRegion * r = self->regions[region_idx];
+      if (sel_mn->pos < 0
+          || sel_mn->pos >= r->num_midi_notes)
+        {
+          g_warning (
+            "note %d not found in region %s", i,
+            r->name);
+          midi_note_batch_free (self);
+          return NULL;
+        }
+
+      self->region_idxs[i] = region_idx;
+      self->note_idxs[i] = sel_mn->pos;
+      self->start_ticks[i] = sel_mn_obj->pos.ticks;
+      self->end_ticks[i] =
+        sel_mn_obj->end_pos.ticks;
+      self->pitches[i] = sel_mn->val;
+      self->vels[i] = sel_mn->vel->vel;
+    }
+  self->num_notes = sel->num_midi_notes;
+
+  return self;
+}
+
+/**
+ * Adds @p delta semitones to the pitch of all
+ * notes, clamped to 0-127.
+ */
+void
+midi_note_batch_transpose (
+  MidiNoteBatch * self,
+  int             delta)
+{
+  for (int i = 0; i < self->num_notes; i++)
+    {
+      self->pitches[i] =
+        (uint8_t)
+        CLAMP ((int) self->pitches[i] + delta, 0, 127);
+    }
+}
+
+/**
+ * Multiplies the velocity of all notes by
+ * @p factor, clamped to 0-127.
+ */
+void
+midi_note_batch_scale_velocities (
+  MidiNoteBatch * self,
+  double          factor)
+{
+  for (int i = 0; i < self->num_notes; i++)
+    {
+      int vel =
+        (int) round ((double) self->vels[i] * factor);
+      self->vels[i] = (uint8_t) CLAMP (vel, 0, 127);
+    }
+}
+
+/**
+ * Sets the velocity of all notes, clamped to
+ * 0-127.
+ */
+void
+midi_note_batch_set_velocities (
+  MidiNoteBatch * self,
+  int             vel)
+{
+  uint8_t val = (uint8_t) CLAMP (vel, 0, 127);
+  for (int i = 0; i < self->num_notes; i++)
+    {
+      self->vels[i] = val;
+    }
+}
+
+/**
+ * Quantizes the positions of all notes.
+ *
+ * This behaves like the quantize action, ie,
+ * the start is quantized and the note is moved
+ * with it if QuantizeOptions.adj_start is set,
+ * and the end is quantized if
+ * QuantizeOptions.adj_end is set.
+ */
+void
+midi_note_batch_quantize (
+  MidiNoteBatch *   self,
+  QuantizeOptions * opts)
+{
+  for (int i = 0; i < self->num_notes; i++)
+    {
+      Position pos;
+      if (opts->adj_start
+          && self->start_ticks[i] >= 0.0)
+        {
+          position_from_ticks (
+            &pos, self->start_ticks[i]);
+          double ticks =
+            quantize_options_quantize_position (
+              opts, &pos);
+          self->start_ticks[i] = pos.ticks;
+          self->end_ticks[i] += ticks;
+        }
+      if (opts->adj_end
+          && self->end_ticks[i] >= 0.0)
+        {
+          position_from_ticks (
+            &pos, self->end_ticks[i]);
+          quantize_options_quantize_position (
+            opts, &pos);
+          self->end_ticks[i] = pos.ticks;
+        }
+    }
+}
+
+/**
+ * Writes the values of the change to the note
+ * at the change's index in @p region.
+ *
+ * This does not publish any events or mark the
+ * notes of the region as changed, so
+ * region_notes_changed() must be called once
+ * per region after applying all changes.
+ *
+ * @param after Whether to write the values after
+ *   the change (true) or before (false).
+ *
+ * @return Whether the note was found.
+ */
+bool
+midi_note_change_apply (
+  const MidiNoteChange * self,
+  ZRegion *              region,
+  bool                   after)
+{
+  if (self->note_idx < 0
+      || self->note_idx >= region->num_midi_notes)
+    return false;
+
+  MidiNote * mn = region->midi_notes[self->note_idx];
+  ArrangerObject * mn_obj = (ArrangerObject *) mn;
+
+  double start =
+    after ? self->start_after : self->start_before;
+  double end =
+    after ? self->end_after : self->end_before;
+  int pitch =
+    after ? self->pitch_after : self->pitch_before;
+  int vel =
+    after ? self->vel_after : self->vel_before;
+
+  /* the start and end are set together so don't
+   * validate them one by one, and the region is
+   * known so don't go through
+   * arranger_object_set_position() */
+  bool pos_changed = false;
+  if (!math_doubles_equal (
+         mn_obj->pos.ticks, start))
+    {
+      position_from_ticks (&mn_obj->pos, start);
+      pos_changed = true;
+    }
+  if (!math_doubles_equal (
+         mn_obj->end_pos.ticks, end))
+    {
+      position_from_ticks (&mn_obj->end_pos, end);
+      pos_changed = true;
+    }
+  if (pos_changed)
+    {
+      /* the frames are relative to the region
+       * start with tempo automation */
+      arranger_object_update_child_positions (
+        mn_obj, region, true);
+    }
+
+  if (mn->val != pitch || mn->vel->vel != vel)
+    {
+      mn->vel->vel = (uint8_t) vel;
+
+      /* sends a note off if the note is playing */
+      midi_note_set_val_in_region (
+        mn, region, (uint8_t) pitch);
+    }
+
+  return true;
+}
+
+void
+midi_note_batch_free (
+  MidiNoteBatch * self)
+{
+  free (self->regions);
+  free (self->region_idxs);
+  free (self->note_idxs);
+  free (self->start_ticks);
+  free (self->end_ticks);
+  free (self->pitches);
+  free (self->vels);
+
+  object_zero_and_free (self);
+}
@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "audio/control_port.h"
+#include "audio/engine.h"
+#include "audio/meter.h"
+#include "audio/transport.h"
+#include "gui/backend/refresh_scheduler.h"
+#include "project.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+static gboolean
+refresh_source_func (
+  gpointer user_data);
+
+static void
+start_source (
+  RefreshScheduler * self,
+  guint              interval)
+{
+  self->interval = interval;
+  self->source_id =
+    g_timeout_add (
+      interval, refresh_source_func, self);
+}
+
+static int
+find_client (
+  RefreshScheduler * self,
+  GtkWidget *        widget)
+{
+  return
+    (int)
+    GPOINTER_TO_UINT (
+      g_hash_table_lookup (
+        self->client_idxs, widget)) - 1;
+}
+
+static void
+remove_dead_clients (
+  RefreshScheduler * self)
+{
+  guint j = 0;
+  for (guint i = 0; i < self->clients->len; i++)
+    {
+      RefreshClient * client =
+        &g_array_index (
+          self->clients, RefreshClient, i);
+      if (!client->widget)
+        continue;
+
+      if (i != j)
+        {
+          g_array_index (
+            self->clients, RefreshClient, j) =
+              *client;
+          g_hash_table_insert (
+            self->client_idxs, client->widget,
+            GUINT_TO_POINTER (j + 1));
+        }
+      j++;
+    }
+  g_array_set_size (self->clients, j);
+  self->num_dead = 0;
+}
+
+/**
+ * Clears the client without moving the others,
+ * since this may be called while refreshing.
+ */
+static void
+clear_client (
+  RefreshScheduler * self,
+  int                idx)
+{
+  RefreshClient * client =
+    &g_array_index (
+      self->clients, RefreshClient, idx);
+  g_hash_table_remove (
+    self->client_idxs, client->widget);
+  client->widget = NULL;
+  client->func = NULL;
+  client->meter = NULL;
+  self->num_dead++;
+
+  if (!self->refreshing)
+    remove_dead_clients (self);
+}
+
+static void
+on_widget_finalized (
+  gpointer  data,
+  GObject * where_the_object_was)
+{
+  RefreshScheduler * self =
+    (RefreshScheduler *) data;
+  int idx =
+    find_client (
+      self, (GtkWidget *) where_the_object_was);
+  if (idx >= 0)
+    clear_client (self, idx);
+}
+
+static void
+fill_snapshot (
+  RefreshScheduler * self,
+  RefreshSnapshot *  snapshot)
+{
+  snapshot->time = g_get_monotonic_time ();
+  snapshot->engine_running =
+    PROJECT && AUDIO_ENGINE
+    && AUDIO_ENGINE->activated
+    && engine_get_run (AUDIO_ENGINE);
+  snapshot->rolling =
+    snapshot->engine_running
+    && TRANSPORT_IS_ROLLING;
+
+  g_hash_table_remove_all (snapshot->meter_values);
+  g_hash_table_remove_all (snapshot->port_values);
+  g_array_set_size (snapshot->port_buf, 0);
+
+  if (!snapshot->engine_running)
+    return;
+
+  /* read all meters in one go before any widget
+   * is refreshed. the buffer is not resized
+   * afterwards so the values can be pointed
+   * to */
+  g_array_set_size (
+    self->meter_buf, self->clients->len);
+  for (guint i = 0; i < self->clients->len; i++)
+    {
+      RefreshClient * client =
+        &g_array_index (
+          self->clients, RefreshClient, i);
+      if (!client->widget || !client->meter
+          ||
+          !gtk_widget_get_mapped (client->widget)
+          ||
+          g_hash_table_contains (
+            snapshot->meter_values, client->meter))
+        continue;
+
+      RefreshMeterValue * meter_val =
+        &g_array_index (
+          self->meter_buf, RefreshMeterValue, i);
+      meter_get_value (
+        client->meter, AUDIO_VALUE_FADER,
+        &meter_val->val, &meter_val->max);
+      g_hash_table_insert (
+        snapshot->meter_values, client->meter,
+        meter_val);
+    }
+}
+
+/**
+ * Gets the value of the meter read in this
+ * cycle.
+ *
+ * @return Whether the meter was read.
+ */
+bool
+refresh_snapshot_get_meter_value (
+  const RefreshSnapshot * snapshot,
+  Meter *                 meter,
+  float *                 val,
+  float *                 max)
+{
+  RefreshMeterValue * meter_val =
+    (RefreshMeterValue *)
+    g_hash_table_lookup (
+      snapshot->meter_values, meter);
+  if (!meter_val)
+    return false;
+
+  *val = meter_val->val;
+  *max = meter_val->max;
+
+  return true;
+}
+
+/**
+ * Returns the value of the control port,
+ * reading it only once per cycle.
+ */
+float
+refresh_snapshot_get_control_value (
+  const RefreshSnapshot * snapshot,
+  Port *                  port)
+{
+  guint idx =
+    GPOINTER_TO_UINT (
+      g_hash_table_lookup (
+        snapshot->port_values, port));
+  if (idx > 0)
+    {
+      return
+        g_array_index (
+          snapshot->port_buf, float, idx - 1);
+    }
+
+  float val = control_port_get_val (port);
+  g_array_append_val (snapshot->port_buf, val);
+  g_hash_table_insert (
+    snapshot->port_values, port,
+    GUINT_TO_POINTER (snapshot->port_buf->len));
+
+  return val;
+}
+
+/**
+ * Refreshes all mapped widgets now.
+ */
+void
+refresh_scheduler_refresh (
+  RefreshScheduler * self)
+{
+  RefreshSnapshot * snapshot = &self->snapshot;
+  fill_snapshot (self, snapshot);
+
+  bool changed = snapshot->rolling;
+  self->refreshing = true;
+  /* clients added during the refresh are only
+   * refreshed in the next cycle */
+  guint num_clients = self->clients->len;
+  for (guint i = 0; i < num_clients; i++)
+    {
+      RefreshClient * client =
+        &g_array_index (
+          self->clients, RefreshClient, i);
+      if (!client->widget
+          ||
+          !gtk_widget_get_mapped (client->widget))
+        continue;
+
+      /* the array may be reallocated during the
+       * call */
+      RefreshFunc func = client->func;
+      GtkWidget * widget = client->widget;
+      if (func (widget, snapshot))
+        changed = true;
+    }
+  self->refreshing = false;
+
+  if (self->num_dead > 0)
+    remove_dead_clients (self);
+
+  if (changed)
+    self->last_active_time = snapshot->time;
+}
+
+static gboolean
+refresh_source_func (
+  gpointer user_data)
+{
+  RefreshScheduler * self =
+    (RefreshScheduler *) user_data;
+
+  refresh_scheduler_refresh (self);
+
+  guint interval =
+    (g_get_monotonic_time () -
+       self->last_active_time
+     > REFRESH_SCHEDULER_IDLE_DELAY)
+    ? REFRESH_SCHEDULER_IDLE_INTERVAL
+    : REFRESH_SCHEDULER_ACTIVE_INTERVAL;
+  if (interval != self->interval)
+    {
+      start_source (self, interval);
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+/**
+ * Registers a widget to be refreshed while it is
+ * mapped.
+ *
+ * Replaces the refresh function if the widget is
+ * already registered. Widgets are unregistered
+ * automatically when finalized.
+ */
+void
+refresh_scheduler_add (
+  RefreshScheduler * self,
+  GtkWidget *        widget,
+  RefreshFunc        func)
+{
+  int idx = find_client (self, widget);
+  if (idx >= 0)
+    {
+      g_array_index (
+        self->clients, RefreshClient, idx).func =
+          func;
+      return;
+    }
+
+  RefreshClient client = {
+    .widget = widget, .func = func };
+  g_array_append_val (self->clients, client);
+  g_hash_table_insert (
+    self->client_idxs, widget,
+    GUINT_TO_POINTER (self->clients->len));
+  g_object_weak_ref (
+    G_OBJECT (widget), on_widget_finalized, self);
+
+  /* refresh at full rate until things settle */
+  self->last_active_time = g_get_monotonic_time ();
+  if (self->interval
+        != REFRESH_SCHEDULER_ACTIVE_INTERVAL)
+    {
+      g_source_remove (self->source_id);
+      start_source (
+        self, REFRESH_SCHEDULER_ACTIVE_INTERVAL);
+    }
+}
+
+/**
+ * Sets the meter to read for the given
+ * registered widget in each cycle, or NULL to
+ * stop reading it.
+ *
+ * The value can then be retrieved with
+ * refresh_snapshot_get_meter_value().
+ */
+void
+refresh_scheduler_set_meter (
+  RefreshScheduler * self,
+  GtkWidget *        widget,
+  Meter *            meter)
+{
+  int idx = find_client (self, widget);
+  g_return_if_fail (idx >= 0);
+
+  g_array_index (
+    self->clients, RefreshClient, idx).meter =
+      meter;
+}
+
+/**
+ * Unregisters a widget.
+ */
+void
+refresh_scheduler_remove (
+  RefreshScheduler * self,
+  GtkWidget *        widget)
+{
+  int idx = find_client (self, widget);
+  if (idx < 0)
+    return;
+
+  g_object_weak_unref (
+    G_OBJECT (widget), on_widget_finalized, self);
+  clear_client (self, idx);
+}
+
+RefreshScheduler *
+refresh_scheduler_new (void)
+{
+  RefreshScheduler * self =
+    object_new (RefreshScheduler);
+
+  self->clients =
+    g_array_sized_new (
+      false, true, sizeof (RefreshClient), 400);
+  self->client_idxs =
+    g_hash_table_new (NULL, NULL);
+  self->meter_buf =
+    g_array_sized_new (
+      false, true, sizeof (RefreshMeterValue),
+      400);
+  self->snapshot.meter_values =
+    g_hash_table_new (NULL, NULL);
+  self->snapshot.port_values =
+    g_hash_table_new (NULL, NULL);
+  self->snapshot.port_buf =
+    g_array_sized_new (
+      false, true, sizeof (float), 100);
+  self->last_active_time = g_get_monotonic_time ();
+  start_source (
+    self, REFRESH_SCHEDULER_ACTIVE_INTERVAL);
+
+  return self;
+}
+
+void
+refresh_scheduler_free (
+  RefreshScheduler * self)
+{
+  g_message ("%s: Freeing...", __func__);
+
+  if (self->source_id)
+    {
+      g_source_remove (self->source_id);
+      self->source_id = 0;
+    }
+
+  for (guint i = 0; i < self->clients->len; i++)
+    {
+      RefreshClient * client =
+        &g_array_index (
+          self->clients, RefreshClient, i);
+      if (client->widget)
+        {
+          g_object_weak_unref (
+            G_OBJECT (client->widget),
+            on_widget_finalized, self);
+        }
+    }
+  object_free_w_func_and_null (
+    g_array_unref, self->clients);
+  object_free_w_func_and_null (
+    g_hash_table_unref, self->client_idxs);
+  object_free_w_func_and_null (
+    g_array_unref, self->meter_buf);
+  object_free_w_func_and_null (
+    g_hash_table_unref,
+    self->snapshot.meter_values);
+  object_free_w_func_and_null (
+    g_hash_table_unref,
+    self->snapshot.port_values);
+  object_free_w_func_and_null (
+    g_array_unref, self->snapshot.port_buf);
+
+  object_zero_and_free (self);
+
+  g_message ("%s: done", __func__);
+}
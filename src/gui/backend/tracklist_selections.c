@@ -753,6 +753,24 @@ tracklist_selections_mark_for_bounce (
     }
 }
 
+/**
+ * Returns the estimated memory used by the
+ * selections and their tracks, in bytes.
+ */
+size_t
+tracklist_selections_get_memory_size (
+  TracklistSelections * self)
+{
+  size_t size = sizeof (TracklistSelections);
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      size +=
+        track_get_memory_size (self->tracks[i]);
+    }
+
+  return size;
+}
+
 void
 tracklist_selections_free (
   TracklistSelections * self)
@@ -28,11 +28,13 @@
 #include "audio/control_port.h"
 #include "audio/instrument_track.h"
 #include "audio/marker_track.h"
+#include "audio/midi_note_index.h"
 #include "audio/midi_region.h"
 #include "audio/track.h"
 #include "audio/transport.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
+#include "gui/backend/midi_note_batch.h"
 #include "gui/widgets/arranger.h"
 #include "gui/widgets/arranger_draw.h"
 #include "gui/widgets/audio_arranger.h"
@@ -594,6 +596,57 @@ add_object_if_overlap (
   return add;
 }
 
+static int
+cmp_ints (
+  const void * a,
+  const void * b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
+/**
+ * Adds the notes of the region that overlap with
+ * the info's range, using the region's note
+ * index.
+ *
+ * The notes are added in the same order as the
+ * region's notes.
+ */
+static void
+add_midi_notes_in_range (
+  ArrangerWidget *    self,
+  ZRegion *           r,
+  ObjectOverlapInfo * nfo)
+{
+  MidiNoteIndex * index =
+    midi_region_get_note_index (r);
+  double region_start_ticks = r->base.pos.ticks;
+  int num_idxs =
+    midi_note_index_find (
+      index,
+      nfo->start_pos.ticks - region_start_ticks,
+      nfo->end_pos.ticks - region_start_ticks);
+  if (num_idxs == 0)
+    return;
+
+  int * idxs = g_malloc (
+    (size_t) num_idxs * sizeof (int));
+  for (int i = 0; i < num_idxs; i++)
+    {
+      idxs[i] = index->sorted[index->found[i]].idx;
+    }
+  qsort (
+    idxs, (size_t) num_idxs, sizeof (int),
+    cmp_ints);
+  for (int i = 0; i < num_idxs; i++)
+    {
+      nfo->obj =
+        (ArrangerObject *) index->notes[idxs[i]];
+      add_object_if_overlap (self, nfo);
+    }
+  g_free (idxs);
+}
+
 /**
  * Fills in the given array with the
  * ArrangerObject's of the given type that appear
@@ -871,6 +924,16 @@ get_hit_objects (
           if (!r)
             break;
 
+          /* only check the notes in the range
+           * unless notes are being changed by an
+           * action */
+          if (self->action == UI_OVERLAY_ACTION_NONE)
+            {
+              add_midi_notes_in_range (
+                self, r, &nfo);
+              break;
+            }
+
           for (int i = 0; i < r->num_midi_notes;
                i++)
             {
@@ -1621,6 +1684,7 @@ arranger_widget_on_key_release (
   ArrangerWidget *        self)
 {
   self->key_is_pressed = 0;
+  arranger_widget_invalidate_content (self);
 
   if (z_gtk_keyval_is_ctrl (keyval))
     {
@@ -1689,6 +1753,32 @@ arranger_widget_on_key_release (
     self);
 }
 
+/**
+ * Transposes the selected MIDI notes in bulk.
+ */
+static void
+transpose_selected_notes (
+  int pitch_delta)
+{
+  MidiNoteBatch * batch =
+    midi_note_batch_new_from_selections (
+      MA_SELECTIONS);
+  g_return_if_fail (batch);
+  midi_note_batch_transpose (batch, pitch_delta);
+
+  GError * err = NULL;
+  bool ret =
+    arranger_selections_action_perform_edit_notes (
+      NULL, batch, F_NOT_ALREADY_EDITED, &err);
+  midi_note_batch_free (batch);
+  if (!ret)
+    {
+      HANDLE_ERROR (
+        err, "%s",
+        _("Failed to move selection"));
+    }
+}
+
 /**
  * Called from MainWindowWidget because some
  * events don't reach here.
@@ -1702,6 +1792,7 @@ arranger_widget_on_key_press (
   ArrangerWidget *        self)
 {
   g_debug ("arranger widget key action");
+  arranger_widget_invalidate_content (self);
 
   if (z_gtk_keyval_is_ctrl (keyval))
     {
@@ -1862,19 +1953,8 @@ arranger_widget_on_key_press (
 
                   if (pitch_delta)
                     {
-                      GError * err = NULL;
-                      bool ret =
-                        arranger_selections_action_perform_move_midi (
-                          sel, 0, pitch_delta,
-                          F_NOT_ALREADY_MOVED,
-                          &err);
-                      if (!ret)
-                        {
-                          HANDLE_ERROR (
-                            err, "%s",
-                            _("Failed to move "
-                            "selection"));
-                        }
+                      transpose_selected_notes (
+                        pitch_delta);
 
                       /* scroll down if needed */
                       arranger_widget_scroll_until_obj (
@@ -1931,19 +2011,8 @@ arranger_widget_on_key_press (
 
                   if (pitch_delta)
                     {
-                      GError * err = NULL;
-                      bool ret =
-                        arranger_selections_action_perform_move_midi (
-                          sel, 0, pitch_delta,
-                          F_NOT_ALREADY_MOVED,
-                          &err);
-                      if (!ret)
-                        {
-                          HANDLE_ERROR (
-                            err, "%s",
-                            _("Failed to move "
-                            "selection"));
-                        }
+                      transpose_selected_notes (
+                        pitch_delta);
 
                       /* scroll up if needed */
                       arranger_widget_scroll_until_obj (
@@ -3985,13 +4054,23 @@ on_drag_end_midi_modifier (
       {
         g_return_if_fail (self->sel_at_start);
 
+        MidiNoteBatch * before =
+          midi_note_batch_new_from_selections (
+            (MidiArrangerSelections *)
+            self->sel_at_start);
+        MidiNoteBatch * after =
+          midi_note_batch_new_from_selections (
+            MA_SELECTIONS);
         GError * err = NULL;
         bool ret =
-          arranger_selections_action_perform_edit (
-            self->sel_at_start,
-            (ArrangerSelections *) MA_SELECTIONS,
-            ARRANGER_SELECTIONS_ACTION_EDIT_PRIMITIVE,
-            true, &err);
+          before && after
+          &&
+          arranger_selections_action_perform_edit_notes (
+            before, after, F_ALREADY_EDITED, &err);
+        object_free_w_func_and_null (
+          midi_note_batch_free, before);
+        object_free_w_func_and_null (
+          midi_note_batch_free, after);
         if (!ret)
           {
             HANDLE_ERROR (
@@ -4017,34 +4096,37 @@ on_drag_end_midi_modifier (
             &selection_start_pos,
           F_PADDING);
 
-        /* prepare the velocities in cloned
-         * arranger selections from the
-         * vels at start */
+        /* prepare the velocities before the
+         * change from the vels at start */
         midi_modifier_arranger_widget_select_vels_in_range (
           self, self->last_offset_x);
-        self->sel_at_start =
-          arranger_selections_clone (
-            (ArrangerSelections *)
+        MidiNoteBatch * after =
+          midi_note_batch_new_from_selections (
             MA_SELECTIONS);
-        MidiArrangerSelections * sel_at_start =
-          (MidiArrangerSelections *)
-          self->sel_at_start;
-        for (int i = 0;
-             i < sel_at_start->num_midi_notes; i++)
+        MidiNoteBatch * before =
+          midi_note_batch_new_from_selections (
+            MA_SELECTIONS);
+        if (before)
           {
-            MidiNote * mn =
-              sel_at_start->midi_notes[i];
-            Velocity * vel = mn->vel;
-            vel->vel = vel->vel_at_start;
+            for (int i = 0; i < before->num_notes;
+                 i++)
+              {
+                before->vels[i] =
+                  MA_SELECTIONS->midi_notes[i]->vel->
+                    vel_at_start;
+              }
           }
 
         GError * err = NULL;
         bool ret =
-          arranger_selections_action_perform_edit (
-            self->sel_at_start,
-            (ArrangerSelections *) MA_SELECTIONS,
-            ARRANGER_SELECTIONS_ACTION_EDIT_PRIMITIVE,
-            true, &err);
+          before && after
+          &&
+          arranger_selections_action_perform_edit_notes (
+            before, after, F_ALREADY_EDITED, &err);
+        object_free_w_func_and_null (
+          midi_note_batch_free, before);
+        object_free_w_func_and_null (
+          midi_note_batch_free, after);
         if (!ret)
           {
             HANDLE_ERROR (
@@ -6663,6 +6745,208 @@ arranger_widget_any_doing_action (void)
   return false;
 }
 
+/**
+ * Incremented when the content of the arrangers
+ * changes.
+ */
+static volatile gint content_epoch = 1;
+
+/**
+ * Marks the cached content of the arranger as
+ * stale so that it is re-rendered in the next
+ * frame.
+ */
+void
+arranger_widget_invalidate_content (
+  ArrangerWidget * self)
+{
+  self->content_dirty = true;
+}
+
+static void
+invalidate_timelines (void)
+{
+  if (MW_TIMELINE)
+    arranger_widget_invalidate_content (
+      MW_TIMELINE);
+  if (MW_PINNED_TIMELINE)
+    arranger_widget_invalidate_content (
+      MW_PINNED_TIMELINE);
+}
+
+static void
+invalidate_midi_editor (void)
+{
+  if (MW_MIDI_ARRANGER)
+    arranger_widget_invalidate_content (
+      MW_MIDI_ARRANGER);
+  if (MW_MIDI_MODIFIER_ARRANGER)
+    arranger_widget_invalidate_content (
+      MW_MIDI_MODIFIER_ARRANGER);
+}
+
+static void
+invalidate_editors (void)
+{
+  invalidate_midi_editor ();
+  if (MW_CHORD_ARRANGER)
+    arranger_widget_invalidate_content (
+      MW_CHORD_ARRANGER);
+  if (MW_AUTOMATION_ARRANGER)
+    arranger_widget_invalidate_content (
+      MW_AUTOMATION_ARRANGER);
+  if (MW_AUDIO_ARRANGER)
+    arranger_widget_invalidate_content (
+      MW_AUDIO_ARRANGER);
+}
+
+/**
+ * Marks the cached content of the arrangers that
+ * draw objects of the given type as stale.
+ *
+ * The timeline draws the children of regions and
+ * the editors draw the clip editor region, so
+ * changes to regions or their children invalidate
+ * both.
+ */
+void
+arranger_widget_invalidate_content_for_object_type (
+  ArrangerObjectType type)
+{
+  if (!MAIN_WINDOW)
+    return;
+
+  switch (type)
+    {
+    case ARRANGER_OBJECT_TYPE_REGION:
+      invalidate_timelines ();
+      invalidate_editors ();
+      break;
+    case ARRANGER_OBJECT_TYPE_MIDI_NOTE:
+    case ARRANGER_OBJECT_TYPE_VELOCITY:
+      invalidate_timelines ();
+      invalidate_midi_editor ();
+      break;
+    case ARRANGER_OBJECT_TYPE_CHORD_OBJECT:
+      invalidate_timelines ();
+      if (MW_CHORD_ARRANGER)
+        arranger_widget_invalidate_content (
+          MW_CHORD_ARRANGER);
+      break;
+    case ARRANGER_OBJECT_TYPE_AUTOMATION_POINT:
+      invalidate_timelines ();
+      if (MW_AUTOMATION_ARRANGER)
+        arranger_widget_invalidate_content (
+          MW_AUTOMATION_ARRANGER);
+      break;
+    case ARRANGER_OBJECT_TYPE_SCALE_OBJECT:
+    case ARRANGER_OBJECT_TYPE_MARKER:
+      invalidate_timelines ();
+      break;
+    default:
+      arranger_widget_invalidate_all_content ();
+      break;
+    }
+}
+
+/**
+ * Marks the cached content of the arrangers that
+ * draw the objects of the given selections as
+ * stale.
+ */
+void
+arranger_widget_invalidate_content_for_selections (
+  ArrangerSelections * sel)
+{
+  if (!MAIN_WINDOW)
+    return;
+
+  switch (sel->type)
+    {
+    case ARRANGER_SELECTIONS_TYPE_TIMELINE:
+      arranger_widget_invalidate_content_for_object_type (
+        ARRANGER_OBJECT_TYPE_REGION);
+      break;
+    case ARRANGER_SELECTIONS_TYPE_MIDI:
+      arranger_widget_invalidate_content_for_object_type (
+        ARRANGER_OBJECT_TYPE_MIDI_NOTE);
+      break;
+    case ARRANGER_SELECTIONS_TYPE_CHORD:
+      arranger_widget_invalidate_content_for_object_type (
+        ARRANGER_OBJECT_TYPE_CHORD_OBJECT);
+      break;
+    case ARRANGER_SELECTIONS_TYPE_AUTOMATION:
+      arranger_widget_invalidate_content_for_object_type (
+        ARRANGER_OBJECT_TYPE_AUTOMATION_POINT);
+      break;
+    case ARRANGER_SELECTIONS_TYPE_AUDIO:
+      if (MW_AUDIO_ARRANGER)
+        arranger_widget_invalidate_content (
+          MW_AUDIO_ARRANGER);
+      break;
+    default:
+      arranger_widget_invalidate_all_content ();
+      break;
+    }
+}
+
+/**
+ * Marks the cached content of all arrangers as
+ * stale so that it is re-rendered in the next
+ * frame.
+ *
+ * To be called when something drawn in all
+ * arrangers changes (eg, tracks or the theme).
+ */
+void
+arranger_widget_invalidate_all_content (void)
+{
+  g_atomic_int_inc (&content_epoch);
+}
+
+/**
+ * Returns the current content epoch.
+ */
+guint
+arranger_widget_get_content_epoch (void)
+{
+  return (guint) g_atomic_int_get (&content_epoch);
+}
+
+/**
+ * Returns whether the cached content must be
+ * re-rendered.
+ */
+bool
+arranger_widget_is_content_stale (
+  ArrangerWidget * self)
+{
+  if (!self->content_node
+      || self->content_dirty
+      || self->content_epoch
+           != arranger_widget_get_content_epoch ())
+    return true;
+
+  GdkRectangle rect;
+  arranger_widget_get_visible_rect (self, &rect);
+  if (!gdk_rectangle_equal (
+         &rect, &self->content_rect))
+    return true;
+
+  RulerWidget * ruler =
+    arranger_widget_get_ruler (self);
+  if (!math_doubles_equal (
+         ruler->px_per_tick,
+         self->content_px_per_tick)
+      || gtk_widget_get_allocated_width (
+           GTK_WIDGET (self)) != self->content_width
+      || gtk_widget_get_allocated_height (
+           GTK_WIDGET (self)) != self->content_height)
+    return true;
+
+  return false;
+}
+
 /**
  * Returns the earliest possible position allowed
  * in this arranger (eg, 1.1.0.0 for timeline).
@@ -6762,6 +7046,32 @@ handle_playhead_auto_scroll (
     }
 }
 
+static gboolean
+on_any_event (
+  GtkEventControllerLegacy * controller,
+  GdkEvent *                 event,
+  gpointer                   user_data)
+{
+  ArrangerWidget * self =
+    Z_ARRANGER_WIDGET (user_data);
+
+  /* hovering and dragging only change what is
+   * drawn in this arranger, changes to objects
+   * are signaled with events */
+  arranger_widget_invalidate_content (self);
+
+  return false;
+}
+
+static void
+on_theme_changed (
+  GObject *    gobject,
+  GParamSpec * pspec,
+  gpointer     user_data)
+{
+  arranger_widget_invalidate_all_content ();
+}
+
 static gboolean
 arranger_tick_cb (
   GtkWidget *     widget,
@@ -6770,10 +7080,19 @@ arranger_tick_cb (
 {
   ArrangerWidget * self =
     Z_ARRANGER_WIDGET (widget);
-  self->queued_playhead_px =
+  int playhead_px =
     arranger_widget_get_playhead_px (self);
+  bool playhead_moved =
+    playhead_px != self->queued_playhead_px;
+  self->queued_playhead_px = playhead_px;
 
-  gtk_widget_queue_draw (widget);
+  /* only the overlays need to be redrawn unless
+   * the content changed */
+  if (playhead_moved
+      || arranger_widget_is_content_stale (self))
+    {
+      gtk_widget_queue_draw (widget);
+    }
 
   /* auto scroll */
   handle_playhead_auto_scroll (self);
@@ -6919,6 +7238,29 @@ arranger_widget_setup (
     GTK_WIDGET (self),
     GTK_EVENT_CONTROLLER (focus));
 
+  /* any input may change what is drawn in this
+   * arranger */
+  GtkEventController * legacy =
+    gtk_event_controller_legacy_new ();
+  gtk_event_controller_set_propagation_phase (
+    legacy, GTK_PHASE_CAPTURE);
+  g_signal_connect (
+    G_OBJECT (legacy), "event",
+    G_CALLBACK (on_any_event), self);
+  gtk_widget_add_controller (
+    GTK_WIDGET (self), legacy);
+
+  /* re-render the content when the theme
+   * changes */
+  GtkSettings * settings = gtk_settings_get_default ();
+  g_signal_connect_object (
+    G_OBJECT (settings), "notify::gtk-theme-name",
+    G_CALLBACK (on_theme_changed), self, 0);
+  g_signal_connect_object (
+    G_OBJECT (settings),
+    "notify::gtk-application-prefer-dark-theme",
+    G_CALLBACK (on_theme_changed), self, 0);
+
   gtk_widget_add_tick_callback (
     GTK_WIDGET (self),
     arranger_tick_cb, self, NULL);
@@ -6967,6 +7309,8 @@ finalize (
 
   object_free_w_func_and_null (
     gsk_render_node_unref, self->loop_line_node);
+  object_free_w_func_and_null (
+    gsk_render_node_unref, self->content_node);
   object_free_w_func_and_null (
     gsk_render_node_unref,
     self->clip_start_line_node);
@@ -432,45 +432,115 @@ draw_timeline_bg (
                       width, 1));
                 }
 
-              float normalized_val =
-                automation_track_get_val_at_pos (
-                  at, PLAYHEAD, true, true);
-              Port * port =
-                port_find_from_identifier (
-                  &at->port_id);
-              AutomationPoint * ap =
-                automation_track_get_ap_before_pos (
-                  at, PLAYHEAD, true);
-              if (!ap)
-                {
-                  normalized_val =
-                    control_port_real_val_to_normalized (
-                      port,
-                      control_port_get_val (port));
-                }
+              total_height += (double) at->height;
+            }
+        }
+    }
+}
+
+/**
+ * Draws a line at the current value of each
+ * visible automation track.
+ *
+ * The values change with the playhead and the
+ * ports, so this is drawn as an overlay.
+ */
+static void
+draw_automation_values (
+  ArrangerWidget * self,
+  GtkSnapshot *    snapshot,
+  const int        width)
+{
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * const track =
+        TRACKLIST->tracks[i];
 
-              int y_px =
-                automation_track_get_y_px_from_normalized_val (
-                  at,
-                  normalized_val);
+      /* skip tracks in the other timeline (pinned/
+       * non-pinned) and tracks without visible
+       * automation */
+      if (!track->visible
+          || !track->automation_visible
+          || (!self->is_pinned &&
+              track_is_pinned (track))
+          || (self->is_pinned &&
+              !track_is_pinned (track)))
+        continue;
 
-              /* line at current val */
-              gtk_snapshot_append_color (
-                snapshot,
-                &Z_GDK_RGBA_INIT (
-                  track->color.red,
-                  track->color.green,
-                  track->color.blue,
-                  0.3f),
-                &GRAPHENE_RECT_INIT (
-                  0,
-                  (float)
-                  (OFFSET_PLUS_TOTAL_HEIGHT + y_px),
-                  width, 1));
+      TrackWidget * tw = track->widget;
+      if (!GTK_IS_WIDGET (tw))
+        continue;
 
-              total_height += (double) at->height;
+      AutomationTracklist * atl =
+        track_get_automation_tracklist (track);
+      if (!atl)
+        continue;
+
+      double track_start_offset;
+      gtk_widget_translate_coordinates (
+        GTK_WIDGET (tw),
+        GTK_WIDGET (
+          self->is_pinned ?
+            MW_TRACKLIST->pinned_box :
+            MW_TRACKLIST->unpinned_box),
+        0, 0, NULL, &track_start_offset);
+
+      double total_height = track->main_height;
+      if (track->lanes_visible)
+        {
+          for (int j = 0; j < track->num_lanes; j++)
+            {
+              total_height +=
+                (double) track->lanes[j]->height;
             }
         }
+
+      for (int j = 0; j < atl->num_ats; j++)
+        {
+          AutomationTrack * at = atl->ats[j];
+
+          if (!at->created || !at->visible)
+            continue;
+
+          float normalized_val =
+            automation_track_get_val_at_pos (
+              at, PLAYHEAD, true, true);
+          Port * port =
+            port_find_from_identifier (
+              &at->port_id);
+          AutomationPoint * ap =
+            automation_track_get_ap_before_pos (
+              at, PLAYHEAD, true);
+          if (!ap)
+            {
+              normalized_val =
+                control_port_real_val_to_normalized (
+                  port,
+                  control_port_get_val (port));
+            }
+
+          int y_px =
+            automation_track_get_y_px_from_normalized_val (
+              at,
+              normalized_val);
+
+          /* line at current val */
+          gtk_snapshot_append_color (
+            snapshot,
+            &Z_GDK_RGBA_INIT (
+              track->color.red,
+              track->color.green,
+              track->color.blue,
+              0.3f),
+            &GRAPHENE_RECT_INIT (
+              0,
+              (float)
+              (track_start_offset + total_height
+               + y_px),
+              width, 1));
+
+          total_height += (double) at->height;
+        }
     }
 }
 
@@ -715,33 +785,8 @@ draw_audio_bg (
         continue;
 
       float min = 0.f, max = 0.f;
-      for (signed_frame_t j = prev_frames;
-           j < curr_frames; j++)
-        {
-          if (j >= (signed_frame_t) clip->num_frames)
-            break;
-          for (unsigned int k = 0;
-               k < clip->channels; k++)
-            {
-              signed_frame_t index =
-                j * (signed_frame_t) clip->channels + (signed_frame_t) k;
-              g_return_if_fail (
-                index >= 0 &&
-                index <
-                  (signed_frame_t)
-                  (clip->num_frames *
-                     clip->channels));
-              float val = clip->frames[index];
-              if (val > max)
-                {
-                  max = val;
-                }
-              if (val < min)
-                {
-                  min = val;
-                }
-            }
-        }
+      audio_clip_get_min_max (
+        clip, prev_frames, curr_frames, &min, &max);
 #define DRAW_VLINE(x,from_y,_height) \
   gtk_snapshot_append_color ( \
     snapshot, &audio_lines_color, \
@@ -1016,87 +1061,26 @@ draw_range (
       height));
 }
 
-void
-arranger_snapshot (
-  GtkWidget *   widget,
-  GtkSnapshot * snapshot)
+/**
+ * Draws everything except the overlays.
+ *
+ * The result is cached in @ref
+ * ArrangerWidget.content_node.
+ *
+ * @param rect Arranger draw rectangle.
+ */
+static void
+draw_content (
+  ArrangerWidget * self,
+  GtkSnapshot *    snapshot,
+  RulerWidget *    ruler,
+  int              width,
+  int              height,
+  GdkRectangle *   rect)
 {
-  ArrangerWidget * self =
-    Z_ARRANGER_WIDGET (widget);
-  GtkScrolledWindow * scroll =
-    arranger_widget_get_scrolled_window (self);
-  graphene_rect_t visible_rect;
-  z_gtk_scrolled_window_get_visible_rect (
-    scroll, &visible_rect);
-  GdkRectangle visible_rect_gdk;
-  z_gtk_graphene_rect_t_to_gdk_rectangle (
-    &visible_rect_gdk, &visible_rect);
-
-  gint64 start_time = g_get_monotonic_time ();
-
-  int width =
-    gtk_widget_get_allocated_width (
-      GTK_WIDGET (self));
-  int height =
-    gtk_widget_get_allocated_height (
-      GTK_WIDGET (self));
-
-  RulerWidget * ruler =
-    arranger_widget_get_ruler (self);
-  if (ruler->px_per_bar < 2.0)
-    return;
-
-  if (self->first_draw)
-    {
-      self->first_draw = false;
-
-      GtkAdjustment * hadj =
-        gtk_scrolled_window_get_hadjustment (
-          scroll);
-      GtkAdjustment * vadj =
-        gtk_scrolled_window_get_vadjustment (
-          scroll);
-
-      EditorSettings * settings =
-        arranger_widget_get_editor_settings (self);
-
-      int new_x = settings->scroll_start_x;
-      int new_y = settings->scroll_start_y;
-      if (self->type == TYPE (TIMELINE) &&
-          self->is_pinned)
-        {
-          new_y = 0;
-        }
-      else if (self->type == TYPE (MIDI_MODIFIER))
-        {
-          new_y = 0;
-        }
-
-      g_debug (
-        "setting arranger adjustment to %d, %d",
-        new_x, new_y);
-
-      gtk_adjustment_set_value (hadj, new_x);
-      gtk_adjustment_set_value (vadj, new_y);
-    }
-
-  /* skip drawing if rectangle too large */
-  if (visible_rect.size.width > 10000 ||
-      visible_rect.size.height > 10000)
-    {
-      g_warning (
-        "skipping draw - rectangle too large");
-      return;
-    }
-
-  /*g_message (*/
-    /*"redrawing arranger in rect: "*/
-    /*"(%d, %d) width: %d height %d)",*/
-    /*rect.x, rect.y, rect.width, rect.height);*/
-  self->last_rect = visible_rect;
-
   GtkStyleContext *context =
-    gtk_widget_get_style_context (widget);
+    gtk_widget_get_style_context (
+      GTK_WIDGET (self));
 
 #if 0
   cairo_antialias_t antialias =
@@ -1164,7 +1148,7 @@ arranger_snapshot (
   /* --- handle vertical drawing --- */
 
   draw_vertical_lines (
-    self, ruler, snapshot, &visible_rect_gdk);
+    self, ruler, snapshot, rect);
 
   /* draw range */
   int range_first_px, range_second_px;
@@ -1234,38 +1218,38 @@ arranger_snapshot (
       draw_range (
         self, snapshot,
         range_first_px, range_second_px,
-        &visible_rect_gdk);
+        rect);
     }
 
   if (self->type == TYPE (TIMELINE))
     {
       draw_timeline_bg (
         self, snapshot, width,
-        &visible_rect_gdk);
+        rect);
     }
   else if (self->type == TYPE (MIDI))
     {
       draw_midi_bg (
-        self, snapshot, width, &visible_rect_gdk);
+        self, snapshot, width, rect);
     }
   else if (self->type == TYPE (MIDI_MODIFIER))
     {
       draw_velocity_bg (
         self, snapshot, height, width,
-        &visible_rect_gdk);
+        rect);
     }
   else if (self->type == TYPE (AUDIO))
     {
       draw_audio_bg (
         self, snapshot, height,
-        &visible_rect_gdk);
+        rect);
     }
 
   /* draw each arranger object */
   ArrangerObject * objs[2000];
   int num_objs;
   arranger_widget_get_hit_objects_in_rect (
-    self, ARRANGER_OBJECT_TYPE_ALL, &visible_rect_gdk,
+    self, ARRANGER_OBJECT_TYPE_ALL, rect,
     objs, &num_objs);
 
   /*g_message (*/
@@ -1275,12 +1259,129 @@ arranger_snapshot (
   for (int j = 0; j < num_objs; j++)
     {
       draw_arranger_object (
-        self, objs[j], snapshot, &visible_rect_gdk);
+        self, objs[j], snapshot, rect);
     }
 
   /* draw dnd highlight */
   draw_highlight (
-    self, snapshot, &visible_rect_gdk);
+    self, snapshot, rect);
+
+}
+
+void
+arranger_snapshot (
+  GtkWidget *   widget,
+  GtkSnapshot * snapshot)
+{
+  ArrangerWidget * self =
+    Z_ARRANGER_WIDGET (widget);
+  GtkScrolledWindow * scroll =
+    arranger_widget_get_scrolled_window (self);
+  graphene_rect_t visible_rect;
+  z_gtk_scrolled_window_get_visible_rect (
+    scroll, &visible_rect);
+  GdkRectangle visible_rect_gdk;
+  z_gtk_graphene_rect_t_to_gdk_rectangle (
+    &visible_rect_gdk, &visible_rect);
+
+  gint64 start_time = g_get_monotonic_time ();
+
+  int width =
+    gtk_widget_get_allocated_width (
+      GTK_WIDGET (self));
+  int height =
+    gtk_widget_get_allocated_height (
+      GTK_WIDGET (self));
+
+  RulerWidget * ruler =
+    arranger_widget_get_ruler (self);
+  if (ruler->px_per_bar < 2.0)
+    return;
+
+  if (self->first_draw)
+    {
+      self->first_draw = false;
+
+      GtkAdjustment * hadj =
+        gtk_scrolled_window_get_hadjustment (
+          scroll);
+      GtkAdjustment * vadj =
+        gtk_scrolled_window_get_vadjustment (
+          scroll);
+
+      EditorSettings * settings =
+        arranger_widget_get_editor_settings (self);
+
+      int new_x = settings->scroll_start_x;
+      int new_y = settings->scroll_start_y;
+      if (self->type == TYPE (TIMELINE) &&
+          self->is_pinned)
+        {
+          new_y = 0;
+        }
+      else if (self->type == TYPE (MIDI_MODIFIER))
+        {
+          new_y = 0;
+        }
+
+      g_debug (
+        "setting arranger adjustment to %d, %d",
+        new_x, new_y);
+
+      gtk_adjustment_set_value (hadj, new_x);
+      gtk_adjustment_set_value (vadj, new_y);
+    }
+
+  /* skip drawing if rectangle too large */
+  if (visible_rect.size.width > 10000 ||
+      visible_rect.size.height > 10000)
+    {
+      g_warning (
+        "skipping draw - rectangle too large");
+      return;
+    }
+
+  /*g_message (*/
+    /*"redrawing arranger in rect: "*/
+    /*"(%d, %d) width: %d height %d)",*/
+    /*rect.x, rect.y, rect.width, rect.height);*/
+  self->last_rect = visible_rect;
+
+  /* re-render the content if needed */
+  if (arranger_widget_is_content_stale (self))
+    {
+      GtkSnapshot * content_snapshot =
+        gtk_snapshot_new ();
+      draw_content (
+        self, content_snapshot, ruler, width,
+        height, &visible_rect_gdk);
+      object_free_w_func_and_null (
+        gsk_render_node_unref, self->content_node);
+      self->content_node =
+        gtk_snapshot_free_to_node (content_snapshot);
+
+      self->content_epoch =
+        arranger_widget_get_content_epoch ();
+      self->content_dirty = false;
+      arranger_widget_get_visible_rect (
+        self, &self->content_rect);
+      self->content_width = width;
+      self->content_height = height;
+      self->content_px_per_tick = ruler->px_per_tick;
+    }
+  if (self->content_node)
+    {
+      gtk_snapshot_append_node (
+        snapshot, self->content_node);
+    }
+
+  /* --- draw overlays --- */
+
+  if (self->type == TYPE (TIMELINE))
+    {
+      draw_automation_values (
+        self, snapshot, width);
+    }
 
   /* draw selections */
   draw_selections (
@@ -20,6 +20,7 @@
 #include "audio/automation_track.h"
 #include "audio/channel_track.h"
 #include "audio/engine.h"
+#include "audio/track_processor.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/automatable_selector_popover.h"
@@ -208,6 +209,20 @@ create_model_for_ports (
 
   Track * track =
     automation_track_get_track (self->owner);
+
+  /* MIDI automatables are created on first use,
+   * so create the ones of the selected channel to
+   * be able to list them */
+  if (self->selected_type >= AS_TYPE_MIDI_CH1
+      && self->selected_type <= AS_TYPE_MIDI_CH16
+      && track->processor)
+    {
+      track_processor_create_midi_channel_automatables (
+        track->processor,
+        (int) self->selected_type
+          - AS_TYPE_MIDI_CH1);
+    }
+
   AutomationTracklist * atl =
     track_get_automation_tracklist (track);
   for (int i = 0; i < atl->num_ats; i++)
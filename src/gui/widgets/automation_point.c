@@ -185,16 +185,34 @@ automation_point_draw (
         * it and doesn't exceed the surface size */
        width_for_curve - step / 2.0;
       bool has_drawing = false;
-      for (double l = draw_offset; l <= draw_until;
-           l += step)
+      size_t num_steps =
+        draw_until >= draw_offset
+        ? (size_t) ((draw_until - draw_offset) / step)
+            + 1
+        : 0;
+
+      /* evaluate the curve in chunks */
+      float next_vals[512];
+      for (size_t i = 0; i < num_steps; i++)
         {
+          size_t chunk_idx =
+            i % G_N_ELEMENTS (next_vals);
+          if (chunk_idx == 0)
+            {
+              automation_point_get_normalized_values_in_curve (
+                ap,
+                (draw_offset + step * (double) (i + 1))
+                  / width_for_curve,
+                step / width_for_curve, next_vals,
+                MIN (
+                  G_N_ELEMENTS (next_vals),
+                  num_steps - i));
+            }
+
+          double l = draw_offset + step * (double) i;
           double next_y =
             /* in pixels, higher values are lower */
-            1.0 -
-            automation_point_get_normalized_value_in_curve (
-              ap,
-              CLAMP (
-                (l + step) / width_for_curve, 0.0, 1.0));
+            1.0 - (double) next_vals[chunk_idx];
           next_y *= height_for_curve;
 
           if (G_UNLIKELY (
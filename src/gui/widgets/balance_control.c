@@ -23,6 +23,7 @@
 #include "actions/tracklist_selections.h"
 #include "actions/undo_manager.h"
 #include "audio/midi_mapping.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/widgets/balance_control.h"
 #include "gui/widgets/dialogs/bind_cc_dialog.h"
 #include "gui/widgets/bot_bar.h"
@@ -75,6 +76,7 @@ balance_control_snapshot (
     return;
 
   float pan_val = GET_VAL;
+  self->last_val = pan_val;
   float value_px =
     pan_val * (float) width;
   float half_width = (float) width / 2.f;
@@ -186,6 +188,7 @@ on_motion_enter (
   BalanceControlWidget * self =
     Z_BALANCE_CONTROL_WIDGET (user_data);
   self->hovered = true;
+  gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
 static void
@@ -196,6 +199,7 @@ on_motion_leave (
   BalanceControlWidget * self =
     Z_BALANCE_CONTROL_WIDGET (user_data);
   self->hovered = false;
+  gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
 static void
@@ -266,6 +270,7 @@ on_drag_end (
   self->last_x = 0;
   self->last_y = 0;
   self->dragged = 0;
+  gtk_widget_queue_draw (GTK_WIDGET (self));
   /*gtk_widget_hide (GTK_WIDGET (self->tooltip_win));*/
 
   if (IS_CHANNEL ((Channel *) self->object) &&
@@ -332,20 +337,24 @@ on_right_click (
     }
 }
 
-static gboolean
-balance_control_tick_cb (
-  GtkWidget *     widget,
-  GdkFrameClock * frame_clock,
-  gpointer        user_data)
+static bool
+balance_control_refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
 {
-  if (!gtk_widget_get_mapped (widget))
+  BalanceControlWidget * self =
+    Z_BALANCE_CONTROL_WIDGET (widget);
+
+  if (!self->getter
+      ||
+      math_floats_equal (GET_VAL, self->last_val))
     {
-      return G_SOURCE_CONTINUE;
+      return false;
     }
 
   gtk_widget_queue_draw (widget);
 
-  return G_SOURCE_CONTINUE;
+  return true;
 }
 
 /**
@@ -502,9 +511,12 @@ balance_control_widget_init (
     self->layout, desc);
   pango_font_description_free (desc);
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self), balance_control_tick_cb,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        balance_control_refresh_cb);
+    }
 }
 
 static void
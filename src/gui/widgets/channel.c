@@ -26,6 +26,7 @@
 #include "audio/master_track.h"
 #include "audio/meter.h"
 #include "audio/track.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/backend/wrapped_object_with_change_signal.h"
 #include "gui/widgets/balance_control.h"
 #include "gui/widgets/bot_dock_edge.h"
@@ -173,6 +174,22 @@ channel_widget_update_meter_reading (
   return G_SOURCE_CONTINUE;
 }
 
+static bool
+refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
+{
+  ChannelWidget * self = Z_CHANNEL_WIDGET (widget);
+  double prev = self->meter_reading_val;
+
+  channel_widget_update_meter_reading (
+    self, NULL, NULL);
+
+  return
+    !math_doubles_equal (
+      prev, self->meter_reading_val);
+}
+
 static gboolean
 on_dnd_drop (
   GtkDropTarget * drop_target,
@@ -1049,11 +1066,12 @@ channel_widget_new (Channel * channel)
 
   channel_widget_refresh (self);
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self),
-    (GtkTickCallback)
-      channel_widget_update_meter_reading,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        refresh_cb);
+    }
 
   g_signal_connect (
     self, "destroy",
@@ -25,6 +25,7 @@
 #include "plugins/lv2_plugin.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/backend/wrapped_object_with_change_signal.h"
 #include "gui/widgets/bot_bar.h"
 #include "gui/widgets/bot_dock_edge.h"
@@ -678,25 +679,25 @@ on_press (
 }
 
 static bool
-tick_cb (
-  GtkWidget *         widget,
-  GdkFrameClock *     frame_clock,
-  ChannelSlotWidget * self)
+refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
 {
-  if (!gtk_widget_is_visible (widget))
-    {
-      return G_SOURCE_CONTINUE;
-    }
+  ChannelSlotWidget * self =
+    Z_CHANNEL_SLOT_WIDGET (widget);
 
   Plugin * pl = get_plugin (self);
   bool is_selected = pl && plugin_is_selected (pl);
-  if (is_selected != self->was_selected)
-    {
-      channel_slot_widget_set_state_flags (
-        self, GTK_STATE_FLAG_SELECTED, is_selected);
-    }
+  bool was_selected =
+    gtk_widget_get_state_flags (widget)
+    & GTK_STATE_FLAG_SELECTED;
+  if (is_selected == was_selected)
+    return false;
+
+  channel_slot_widget_set_state_flags (
+    self, GTK_STATE_FLAG_SELECTED, is_selected);
 
-  return G_SOURCE_CONTINUE;
+  return true;
 }
 
 static void
@@ -1107,9 +1108,12 @@ channel_slot_widget_init (
   gtk_widget_add_controller (
     GTK_WIDGET (self), motion_controller);
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self), (GtkTickCallback) tick_cb,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        refresh_cb);
+    }
 }
 
 static void
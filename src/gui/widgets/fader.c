@@ -26,6 +26,7 @@
 #include "audio/midi_mapping.h"
 #include "gui/backend/event_manager.h"
 #include "gui/backend/event.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/widgets/dialogs/bind_cc_dialog.h"
 #include "gui/widgets/bot_bar.h"
 #include "gui/widgets/fader.h"
@@ -160,6 +161,8 @@ fader_snapshot (
       border_width,
       (height - value_px) - inner_line_width / 2.f,
       width - border_width * 2, inner_line_width));
+
+  self->last_fader_val = fader_val;
 }
 
 static void
@@ -288,6 +291,7 @@ drag_end (
     self->fader, self->amp_at_start, cur_amp, true);
 
   self->dragging = false;
+  gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
 static void
@@ -378,20 +382,25 @@ on_scroll (
   return true;
 }
 
-static gboolean
-fader_tick_cb (
-  GtkWidget *     widget,
-  GdkFrameClock * frame_clock,
-  gpointer        user_data)
+static bool
+fader_refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
 {
-  if (!gtk_widget_get_mapped (widget))
+  FaderWidget * self = Z_FADER_WIDGET (widget);
+
+  if (!self->fader
+      ||
+      math_floats_equal (
+        self->fader->fader_val,
+        self->last_fader_val))
     {
-      return G_SOURCE_CONTINUE;
+      return false;
     }
 
   gtk_widget_queue_draw (widget);
 
-  return G_SOURCE_CONTINUE;
+  return true;
 }
 
 /**
@@ -513,9 +522,12 @@ fader_widget_init (FaderWidget * self)
     GTK_WIDGET (self),
     GTK_EVENT_CONTROLLER (scroll_controller));
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self), fader_tick_cb,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        fader_refresh_cb);
+    }
 }
 
 static void
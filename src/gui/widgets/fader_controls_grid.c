@@ -19,6 +19,7 @@
 
 #include "audio/meter.h"
 #include "audio/track.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/widgets/balance_control.h"
 #include "gui/widgets/center_dock.h"
 #include "gui/widgets/fader.h"
@@ -46,24 +47,22 @@ G_DEFINE_TYPE (
 
 static bool
 update_meter_reading (
-  FaderControlsGridWidget * widget,
-  GdkFrameClock * frame_clock,
-  gpointer        user_data)
+  GtkWidget *             _widget,
+  const RefreshSnapshot * snapshot)
 {
-  g_return_val_if_fail (
-    GTK_IS_WIDGET (widget), G_SOURCE_REMOVE);
+  FaderControlsGridWidget * widget =
+    Z_FADER_CONTROLS_GRID_WIDGET (_widget);
 
-  if (!MAIN_WINDOW ||
-      !gtk_widget_get_mapped (
-        GTK_WIDGET (widget)) ||
-      !widget->track)
+  if (!MAIN_WINDOW || !widget->track)
     {
-      return G_SOURCE_CONTINUE;
+      return false;
     }
 
   if (widget != MW_TRACK_INSPECTOR->fader->grid)
     {
-      return G_SOURCE_REMOVE;
+      refresh_scheduler_remove (
+        REFRESH_SCHEDULER, _widget);
+      return false;
     }
 
   double prev = widget->meter_reading_val;
@@ -77,7 +76,7 @@ update_meter_reading (
     {
       gtk_label_set_text (
         widget->meter_readings, "-∞");
-      return G_SOURCE_CONTINUE;
+      return false;
     }
 
   float amp =
@@ -88,7 +87,7 @@ update_meter_reading (
   double peak_val = (double) math_amp_to_dbfs (amp);
 
   if (math_doubles_equal (peak_val, prev))
-    return G_SOURCE_CONTINUE;
+    return false;
   if (peak_val < -98.)
     gtk_label_set_text (
       widget->meter_readings, "-∞");
@@ -123,7 +122,7 @@ update_meter_reading (
 
   widget->meter_reading_val = peak_val;
 
-  return G_SOURCE_CONTINUE;
+  return true;
 }
 
 static void
@@ -238,12 +237,10 @@ fader_controls_grid_widget_tear_down (
 {
   g_debug ("tearing down %p...", self);
 
-  if (self->tick_cb)
+  if (ZRYTHM && REFRESH_SCHEDULER)
     {
-      g_debug ("removing tick callback...");
-      gtk_widget_remove_tick_callback (
-        GTK_WIDGET (self), self->tick_cb);
-      self->tick_cb = 0;
+      refresh_scheduler_remove (
+        REFRESH_SCHEDULER, GTK_WIDGET (self));
     }
 
   g_debug ("done");
@@ -256,11 +253,12 @@ fader_controls_grid_widget_new (void)
     g_object_new (
       FADER_CONTROLS_GRID_WIDGET_TYPE, NULL);
 
-  self->tick_cb =
-    gtk_widget_add_tick_callback (
-      GTK_WIDGET (self),
-      (GtkTickCallback) update_meter_reading,
-      self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        update_meter_reading);
+    }
 
   return self;
 }
@@ -423,6 +423,26 @@ bar_slider_tick_cb (
   return G_SOURCE_CONTINUE;
 }
 
+/**
+ * Subscribes to the port's data only while
+ * visible.
+ */
+static void
+on_map (
+  GtkWidget *           widget,
+  InspectorPortWidget * self)
+{
+  meter_set_observing (self->meter, true);
+}
+
+static void
+on_unmap (
+  GtkWidget *           widget,
+  InspectorPortWidget * self)
+{
+  meter_set_observing (self->meter, false);
+}
+
 InspectorPortWidget *
 inspector_port_widget_new (
   Port * port)
@@ -434,6 +454,12 @@ inspector_port_widget_new (
 
   self->port = port;
   self->meter = meter_new_for_port (port);
+  g_signal_connect (
+    G_OBJECT (self), "map",
+    G_CALLBACK (on_map), self);
+  g_signal_connect (
+    G_OBJECT (self), "unmap",
+    G_CALLBACK (on_unmap), self);
 
   char str[200];
   int has_str = 0;
@@ -41,11 +41,13 @@
 
 #include "audio/port.h"
 #include "audio/port_connection.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/widgets/knob.h"
 #include "utils/cairo.h"
 #include "utils/math.h"
 #include "utils/string.h"
 #include "utils/ui.h"
+#include "zrythm.h"
 
 #include <gtk/gtk.h>
 
@@ -516,19 +518,22 @@ drag_end (
 }
 
 static bool
-tick_cb (
-  GtkWidget *     widget,
-  GdkFrameClock * frame_clock,
-  KnobWidget *    self)
+refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
 {
+  KnobWidget * self = Z_KNOB_WIDGET (widget);
+
   float real_val = get_real_val (self, true);
-  if (!math_floats_equal (
+  if (math_floats_equal (
         real_val, self->last_real_val))
     {
-      gtk_widget_queue_draw (widget);
+      return false;
     }
 
-  return G_SOURCE_CONTINUE;
+  gtk_widget_queue_draw (widget);
+
+  return true;
 }
 
 /**
@@ -609,9 +614,12 @@ _knob_widget_new (
     G_OBJECT(self->drag), "drag-end",
     G_CALLBACK (drag_end),  self);
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self), (GtkTickCallback) tick_cb,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        refresh_cb);
+    }
 
   return self;
 }
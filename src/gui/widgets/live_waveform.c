@@ -138,23 +138,21 @@ live_waveform_draw_cb (
     case LIVE_WAVEFORM_ENGINE:
       g_return_if_fail (
         IS_TRACK_AND_NONNULL (P_MASTER_TRACK));
-      if (!P_MASTER_TRACK->channel->stereo_out->l->
-            write_ring_buffers)
+      port = P_MASTER_TRACK->channel->stereo_out->l;
+      if (self->engine_ports[0] != port)
         {
-          P_MASTER_TRACK->channel->stereo_out->l->
-            write_ring_buffers = true;
-          P_MASTER_TRACK->channel->stereo_out->r->
-            write_ring_buffers = true;
+          /* the previous ports belonged to another
+           * project (and are free'd) so only
+           * subscribe to the new ones */
+          self->engine_ports[0] = port;
+          self->engine_ports[1] =
+            P_MASTER_TRACK->channel->stereo_out->r;
+          port_add_observer (self->engine_ports[0]);
+          port_add_observer (self->engine_ports[1]);
           return;
         }
-      port = P_MASTER_TRACK->channel->stereo_out->l;
       break;
     case LIVE_WAVEFORM_PORT:
-      if (!self->port->write_ring_buffers)
-        {
-          self->port->write_ring_buffers = true;
-          return;
-        }
       port = self->port;
       break;
     }
@@ -300,10 +298,82 @@ live_waveform_widget_new_port (
 
   self->type = LIVE_WAVEFORM_PORT;
   self->port = port;
+  port_identifier_copy (&self->port_id, &port->id);
+  port_add_observer (port);
 
   return self;
 }
 
+/**
+ * Returns whether the observed port(s) still
+ * exist in the project.
+ *
+ * The port may have been free'd along with its
+ * plugin or project before the widget is
+ * disposed.
+ */
+static bool
+observed_ports_exist (
+  LiveWaveformWidget * self)
+{
+  if (!PROJECT || !TRACKLIST)
+    return false;
+
+  switch (self->type)
+    {
+    case LIVE_WAVEFORM_ENGINE:
+      {
+        Track * master = P_MASTER_TRACK;
+        return
+          IS_TRACK_AND_NONNULL (master)
+          && master->channel
+          && master->channel->stereo_out->l
+               == self->engine_ports[0]
+          && master->channel->stereo_out->r
+               == self->engine_ports[1];
+      }
+    case LIVE_WAVEFORM_PORT:
+      return
+        port_is_alive (&self->port_id, self->port);
+    }
+
+  return false;
+}
+
+static void
+dispose (
+  LiveWaveformWidget * self)
+{
+  /* unsubscribe while the ports are known to be
+   * alive */
+  switch (self->type)
+    {
+    case LIVE_WAVEFORM_ENGINE:
+      if (self->engine_ports[0]
+          && observed_ports_exist (self))
+        {
+          port_remove_observer (
+            self->engine_ports[0]);
+          port_remove_observer (
+            self->engine_ports[1]);
+        }
+      self->engine_ports[0] = NULL;
+      self->engine_ports[1] = NULL;
+      break;
+    case LIVE_WAVEFORM_PORT:
+      if (self->port && observed_ports_exist (self))
+        {
+          port_remove_observer (self->port);
+        }
+      self->port = NULL;
+      break;
+    }
+
+  G_OBJECT_CLASS (
+    live_waveform_widget_parent_class)->
+      dispose (G_OBJECT (self));
+}
+
 static void
 finalize (
   LiveWaveformWidget * self)
@@ -311,6 +381,8 @@ finalize (
   object_zero_and_free_if_nonnull (self->bufs[0]);
   object_zero_and_free_if_nonnull (self->bufs[1]);
 
+  port_identifier_free_members (&self->port_id);
+
   G_OBJECT_CLASS (
     live_waveform_widget_parent_class)->
       finalize (G_OBJECT (self));
@@ -335,6 +407,8 @@ live_waveform_widget_class_init (
     klass, "live-waveform");
 
   GObjectClass * oklass = G_OBJECT_CLASS (klass);
+  oklass->dispose =
+    (GObjectFinalizeFunc) dispose;
   oklass->finalize =
     (GObjectFinalizeFunc) finalize;
 }
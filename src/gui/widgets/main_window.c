@@ -19,6 +19,8 @@
 
 #include "zrythm-config.h"
 
+#include <string.h>
+
 #include "project.h"
 #include "actions/actions.h"
 #include "audio/master_track.h"
@@ -142,14 +144,30 @@ on_close_request (
   engine_wait_for_pause (
     AUDIO_ENGINE, &state, F_NO_FORCE);
 
-  /* get yaml for live project */
-  char * live_yaml =
-    yaml_serialize (PROJECT, &project_schema);
-  if (!live_yaml)
+  /* get data for existing project file */
+  size_t file_data_size = 0;
+  char * file_data =
+    project_get_existing_data (
+      PROJECT, F_NOT_BACKUP, &file_data_size);
+
+  /* serialize live project in the format of the
+   * existing file so that the data can be
+   * compared */
+  ProjectFileFormat format =
+    file_data
+    ? project_get_data_format (
+        file_data, file_data_size)
+    : project_get_save_format ();
+  size_t live_data_size = 0;
+  char * live_data =
+    project_serialize (
+      PROJECT, format, &live_data_size);
+  if (!live_data)
     {
       ui_show_error_message (
         self, false,
         _("Failed to serialize current project"));
+      free (file_data);
 
       /* restart engine */
       engine_resume (AUDIO_ENGINE, &state);
@@ -159,14 +177,13 @@ on_close_request (
       return true;
     }
 
-  /* get yaml for existing project file */
-  char * file_yaml =
-    project_get_existing_yaml (
-      PROJECT, F_NOT_BACKUP);
-
   /* ask for save if project has unsaved changes */
   bool ret = false;
-  if (!string_is_equal (file_yaml, live_yaml))
+  if (!file_data
+      || file_data_size != live_data_size
+      || memcmp (
+           file_data, live_data,
+           live_data_size) != 0)
     {
       bool show_diff = false;
       char * diff = NULL;
@@ -181,19 +198,29 @@ on_close_request (
       char * tmp_dir =
         g_dir_make_tmp ("zrythm-diff-XXXXXX", &err);
       g_return_val_if_fail (err == NULL, false);
+      const char * ext =
+        project_file_format_get_extension (format);
+      char * tmp_live_basename =
+        g_strdup_printf ("live.%s", ext);
+      char * tmp_file_basename =
+        g_strdup_printf ("file.%s", ext);
       char * tmp_live_fp =
         g_build_filename (
-          tmp_dir, "live.yaml", NULL);
+          tmp_dir, tmp_live_basename, NULL);
       char * tmp_file_fp =
         g_build_filename (
-          tmp_dir, "file.yaml", NULL);
+          tmp_dir, tmp_file_basename, NULL);
+      g_free (tmp_live_basename);
+      g_free (tmp_file_basename);
       err = NULL;
       g_file_set_contents (
-        tmp_live_fp, live_yaml, -1, &err);
+        tmp_live_fp, live_data,
+        (gssize) live_data_size, &err);
       g_return_val_if_fail (err == NULL, false);
       err = NULL;
       g_file_set_contents (
-        tmp_file_fp, file_yaml, -1, &err);
+        tmp_file_fp, file_data,
+        (gssize) file_data_size, &err);
       g_return_val_if_fail (err == NULL, false);
 
       char * diff_bin =
@@ -286,8 +313,8 @@ on_close_request (
         g_free (diff);
 
     } /* endif project has unsaved changes */
-  g_free (live_yaml);
-  free (file_yaml);
+  g_free (live_data);
+  free (file_data);
 
   /* restart engine */
   engine_resume (AUDIO_ENGINE, &state);
@@ -20,6 +20,7 @@
 #include "audio/channel.h"
 #include "audio/engine.h"
 #include "audio/meter.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/widgets/meter.h"
 #include "gui/widgets/fader.h"
 #include "project.h"
@@ -189,25 +190,20 @@ on_crossing (GtkWidget * widget, GdkEvent *event)
   gtk_widget_queue_draw(widget);
 }
 
-static gboolean
-tick_cb (
-  GtkWidget * widget,
-  GdkFrameClock * frame_clock,
-  MeterWidget * self)
+static bool
+refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
 {
-  if (gtk_widget_get_mapped (GTK_WIDGET (self))
-      && AUDIO_ENGINE->activated
-      && engine_get_run (AUDIO_ENGINE))
+  MeterWidget * self = Z_METER_WIDGET (widget);
+
+  /* the meter is read by the scheduler */
+  if (self->meter)
     {
-      meter_get_value (
-        self->meter, AUDIO_VALUE_FADER,
-        &self->meter_val,
+      refresh_snapshot_get_meter_value (
+        snapshot, self->meter, &self->meter_val,
         &self->meter_peak);
     }
-  else
-    {
-      /* not mapped, skipping dsp */
-    }
 
   if (!math_floats_equal (
         self->meter_val, self->last_meter_val) ||
@@ -215,9 +211,10 @@ tick_cb (
         self->meter_peak, self->last_meter_peak))
     {
       gtk_widget_queue_draw (widget);
+      return true;
     }
 
-  return G_SOURCE_CONTINUE;
+  return false;
 }
 
 #if 0
@@ -269,10 +266,18 @@ meter_widget_setup (
 {
   if (self->meter)
     {
+      if (REFRESH_SCHEDULER)
+        {
+          refresh_scheduler_set_meter (
+            REFRESH_SCHEDULER, GTK_WIDGET (self),
+            NULL);
+        }
       meter_free (self->meter);
     }
   self->meter = meter_new_for_port (port);
   g_return_if_fail (self->meter);
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)))
+    meter_set_observing (self->meter, true);
   self->padding = 2;
 
   /* set size */
@@ -290,9 +295,15 @@ meter_widget_setup (
 #endif
   (void) on_crossing;
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self), (GtkTickCallback) tick_cb,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        refresh_cb);
+      refresh_scheduler_set_meter (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        self->meter);
+    }
 #if 0
   self->timeout_source = g_timeout_source_new (20);
   g_source_set_callback (
@@ -308,6 +319,28 @@ meter_widget_setup (
     "meter widget set up for %s", buf);
 }
 
+/**
+ * Subscribes to the port's data only while
+ * visible.
+ */
+static void
+on_map (
+  GtkWidget *   widget,
+  MeterWidget * self)
+{
+  if (self->meter)
+    meter_set_observing (self->meter, true);
+}
+
+static void
+on_unmap (
+  GtkWidget *   widget,
+  MeterWidget * self)
+{
+  if (self->meter)
+    meter_set_observing (self->meter, false);
+}
+
 static void
 finalize (
   MeterWidget * self)
@@ -327,6 +360,13 @@ meter_widget_init (MeterWidget * self)
   /*gdk_rgba_parse (&self->end_color, "#1DDD6A");*/
   self->start_color = UI_COLORS->z_yellow;
   self->end_color = UI_COLORS->bright_green;
+
+  g_signal_connect (
+    G_OBJECT (self), "map",
+    G_CALLBACK (on_map), self);
+  g_signal_connect (
+    G_OBJECT (self), "unmap",
+    G_CALLBACK (on_unmap), self);
 }
 
 static void
@@ -20,6 +20,7 @@
 #include "audio/engine.h"
 #include "utils/midi.h"
 #include "audio/track.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/widgets/midi_activity_bar.h"
 #include "gui/widgets/track.h"
 #include "project.h"
@@ -123,15 +124,18 @@ midi_activity_bar_snapshot (
 
       self->last_trigger_time =
         g_get_real_time ();
+      self->drawn_active = true;
     }
   else
     {
+      self->drawn_active = false;
       /* draw fade */
       gint64 time_diff =
         g_get_real_time () -
         self->last_trigger_time;
       if ((double) time_diff < MAX_TIME)
         {
+          self->drawn_active = true;
           if (self->animation == MAB_ANIMATION_BAR)
             {
               gtk_snapshot_append_color (
@@ -157,15 +161,34 @@ midi_activity_bar_snapshot (
     }
 }
 
-static int
-update_activity (
-  GtkWidget * widget,
-  GdkFrameClock * frame_clock,
-  MidiActivityBarWidget * self)
+static bool
+refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
 {
+  MidiActivityBarWidget * self =
+    Z_MIDI_ACTIVITY_BAR_WIDGET (widget);
+
+  if (!PROJECT || !AUDIO_ENGINE)
+    return false;
+
+  int trigger = 0;
+  switch (self->type)
+    {
+    case MAB_TYPE_TRACK:
+      trigger = self->track->trigger_midi_activity;
+      break;
+    case MAB_TYPE_ENGINE:
+      trigger = AUDIO_ENGINE->trigger_midi_activity;
+      break;
+    }
+
+  if (!trigger && !self->drawn_active)
+    return false;
+
   gtk_widget_queue_draw (widget);
 
-  return G_SOURCE_CONTINUE;
+  return true;
 }
 
 /**
@@ -192,10 +215,12 @@ midi_activity_bar_widget_setup_track (
   self->type = MAB_TYPE_TRACK;
   self->draw_border = false;
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self),
-    (GtkTickCallback) update_activity,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        refresh_cb);
+    }
 }
 
 /**
@@ -209,10 +234,12 @@ midi_activity_bar_widget_setup_engine (
   self->type = MAB_TYPE_ENGINE;
   self->draw_border = true;
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self),
-    (GtkTickCallback) update_activity,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        refresh_cb);
+    }
 }
 
 static void
@@ -568,6 +568,9 @@ make_control (
             "Editing", "Automation",
             "curve-algorithm",
             curve_algorithm_strings);
+          SET_STRV_FROM_CYAML_IF_MATCH (
+            "Projects", "General", "file-format",
+            project_file_format_strings);
           SET_STRV_IF_MATCH_W_COUNT (
             "UI", "General", "language",
             localization_get_language_strings_w_codes (),
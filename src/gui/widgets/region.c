@@ -20,6 +20,7 @@
 #include "zrythm-config.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "audio/audio_bus_track.h"
 #include "audio/audio_region.h"
@@ -27,6 +28,8 @@
 #include "audio/channel.h"
 #include "audio/fade.h"
 #include "audio/instrument_track.h"
+#include "audio/midi_note_index.h"
+#include "audio/midi_region.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/widgets/arranger.h"
@@ -290,6 +293,295 @@ draw_loop_points (
     }
 }
 
+/**
+ * Maximum size of the note raster of a region.
+ *
+ * The notes are drawn one by one if the region is
+ * larger than this.
+ */
+#define NOTES_RASTER_MAX_WIDTH 4096
+#define NOTES_RASTER_MAX_HEIGHT 1024
+
+/**
+ * Region-wide values used when laying out the
+ * MIDI notes.
+ */
+typedef struct MidiNotesLayout
+{
+  double loop_ticks;
+  double loop_end_ticks;
+  double clip_start_ticks;
+  double ticks_in_region;
+  bool   is_looped;
+  int    num_loops;
+
+  int    max_val;
+  double y_interval;
+} MidiNotesLayout;
+
+static void
+init_midi_notes_layout (
+  ZRegion *         self,
+  MidiNoteIndex *   index,
+  MidiNotesLayout * layout)
+{
+  ArrangerObject * obj =
+    (ArrangerObject *) self;
+
+  layout->num_loops =
+    arranger_object_get_num_loops (obj, 1);
+  layout->ticks_in_region =
+    arranger_object_get_length_in_ticks (obj);
+  layout->loop_end_ticks =
+    obj->loop_end_pos.ticks;
+  layout->loop_ticks =
+    arranger_object_get_loop_length_in_ticks (
+      obj);
+  layout->clip_start_ticks =
+    obj->clip_start_pos.ticks;
+  layout->is_looped = region_is_looped (self);
+
+  layout->max_val = index->max_val;
+  layout->y_interval =
+    MAX (
+      (double) (index->max_val - index->min_val)
+        + 1.0,
+      7.0);
+}
+
+/**
+ * Gets the ratios (0.0 - 1.0) on x where the
+ * note starts and ends in the given loop of the
+ * region.
+ *
+ * @return Whether the note is drawn in this loop.
+ */
+HOT
+static bool
+get_midi_note_loop_range (
+  ZRegion *               self,
+  const MidiNotesLayout * layout,
+  MidiNote *              mn,
+  int                     loop,
+  double *                x_start,
+  double *                x_end)
+{
+  ArrangerObject * obj =
+    (ArrangerObject *) self;
+  ArrangerObject * mn_obj =
+    (ArrangerObject *) mn;
+
+  /* note muted */
+  if (arranger_object_get_muted (mn_obj))
+    return false;
+
+  /* note not playable */
+  if (position_is_after_or_equal (
+        &mn_obj->pos, &obj->loop_end_pos))
+    return false;
+
+  /* note not playable if looped */
+  if (layout->is_looped
+      &&
+      position_is_before (
+        &mn_obj->pos, &obj->loop_start_pos)
+      &&
+      position_is_before (
+        &mn_obj->pos, &obj->clip_start_pos))
+    return false;
+
+  /* if note started before loop start only draw
+   * it once */
+  if (loop != 0
+      &&
+      position_is_before (
+        &mn_obj->pos, &obj->loop_start_pos))
+    return false;
+
+  /* calculate draw endpoints */
+  double tmp_start_ticks =
+    mn_obj->pos.ticks + layout->loop_ticks * loop;
+  double tmp_end_ticks;
+  /* if should be clipped */
+  if (position_is_after_or_equal (
+        &mn_obj->end_pos, &obj->loop_end_pos))
+    tmp_end_ticks =
+      layout->loop_end_ticks +
+      layout->loop_ticks * loop;
+  else
+    tmp_end_ticks =
+      mn_obj->end_pos.ticks +
+      layout->loop_ticks * loop;
+
+  /* adjust for clip start */
+  tmp_start_ticks -= layout->clip_start_ticks;
+  tmp_end_ticks -= layout->clip_start_ticks;
+
+  *x_start =
+    tmp_start_ticks / layout->ticks_in_region;
+  *x_end =
+    tmp_end_ticks / layout->ticks_in_region;
+
+  return true;
+}
+
+/**
+ * Returns whether the cached raster was drawn with
+ * the given parameters.
+ */
+static bool
+is_notes_raster_valid (
+  RegionNotesRaster * raster,
+  gint                notes_version,
+  int                 width,
+  int                 height,
+  const GdkRGBA *     color,
+  const double *      ticks)
+{
+  if (!raster->texture
+      || raster->notes_version != notes_version
+      || raster->width != width
+      || raster->height != height
+      || !gdk_rgba_equal (&raster->color, color))
+    return false;
+
+  for (int i = 0; i < 4; i++)
+    {
+      if (!math_doubles_equal (
+            raster->ticks[i], ticks[i]))
+        return false;
+    }
+
+  return true;
+}
+
+/**
+ * Returns a raster of all the notes of the region,
+ * drawn at the given size.
+ */
+static GdkTexture *
+get_notes_raster (
+  ZRegion *               self,
+  MidiNoteIndex *         index,
+  const MidiNotesLayout * layout,
+  int                     width,
+  int                     height,
+  const GdkRGBA *         color)
+{
+  ArrangerObject * obj =
+    (ArrangerObject *) self;
+  double ticks[4] = {
+    layout->ticks_in_region,
+    obj->loop_start_pos.ticks,
+    layout->loop_end_ticks,
+    layout->clip_start_ticks };
+
+  /* the notes version also covers the mute
+   * status of the notes */
+  gint notes_version =
+    g_atomic_int_get (&self->notes_version);
+
+  /* the region is drawn with 2 different sizes
+   * when the lanes are visible */
+  RegionNotesRaster * raster = NULL;
+  for (int i = 0;
+       i < (int) G_N_ELEMENTS (self->notes_rasters);
+       i++)
+    {
+      RegionNotesRaster * cur =
+        &self->notes_rasters[i];
+      if (is_notes_raster_valid (
+            cur, notes_version, width, height,
+            color, ticks))
+        {
+          return cur->texture;
+        }
+
+      /* replace the raster of the same size, or
+       * an empty slot */
+      if (!raster
+          && (cur->height == height || !cur->texture))
+        {
+          raster = cur;
+        }
+    }
+  if (!raster)
+    raster = &self->notes_rasters[0];
+
+  /* draw the notes into a buffer */
+  size_t stride = (size_t) width * 4;
+  guchar * data =
+    g_malloc0 (stride * (size_t) height);
+  guchar pixel[4] = {
+    (guchar) (color->red * 255.f),
+    (guchar) (color->green * 255.f),
+    (guchar) (color->blue * 255.f),
+    (guchar) (color->alpha * 255.f) };
+  double y_note_size =
+    (double) height / layout->y_interval;
+  for (int j = 0; j < layout->num_loops; j++)
+    {
+      for (int i = 0; i < index->num_notes; i++)
+        {
+          MidiNote * mn =
+            midi_note_index_get_note (index, i);
+          double x_start, x_end;
+          if (!get_midi_note_loop_range (
+                self, layout, mn, j, &x_start,
+                &x_end))
+            continue;
+
+          int x0 =
+            CLAMP (
+              (int) (x_start * (double) width),
+              0, width);
+          int x1 =
+            CLAMP (
+              (int) ceil (x_end * (double) width),
+              0, width);
+          double y_start =
+            ((double) layout->max_val -
+             (double) mn->val) * y_note_size;
+          int y0 =
+            CLAMP ((int) y_start, 0, height);
+          int y1 =
+            CLAMP (
+              (int) ceil (y_start + y_note_size),
+              0, height);
+          /* draw at least 1 pixel */
+          if (x1 == x0 && x0 < width)
+            x1 = x0 + 1;
+          for (int y = y0; y < y1; y++)
+            {
+              guchar * row =
+                &data[(size_t) y * stride];
+              for (int x = x0; x < x1; x++)
+                {
+                  memcpy (&row[x * 4], pixel, 4);
+                }
+            }
+        }
+    }
+
+  GBytes * bytes =
+    g_bytes_new_take (
+      data, stride * (size_t) height);
+  object_free_w_func_and_null (
+    g_object_unref, raster->texture);
+  raster->texture =
+    gdk_memory_texture_new (
+      width, height, GDK_MEMORY_R8G8B8A8,
+      bytes, stride);
+  g_bytes_unref (bytes);
+  raster->notes_version = notes_version;
+  raster->width = width;
+  raster->height = height;
+  raster->color = *color;
+  memcpy (raster->ticks, ticks, sizeof (ticks));
+
+  return raster->texture;
+}
+
 /**
  * @param rect Arranger rectangle.
  */
@@ -320,35 +612,14 @@ draw_midi_region (
         }
     }
 
-  int num_loops =
-    arranger_object_get_num_loops (obj, 1);
-  double ticks_in_region =
-    arranger_object_get_length_in_ticks (obj);
-  double x_start, y_start, x_end;
-
-  int min_val = 127, max_val = 0;
-  for (int i = 0; i < self->num_midi_notes; i++)
-    {
-      MidiNote * mn = self->midi_notes[i];
-
-      if (mn->val < min_val)
-        min_val = mn->val;
-      if (mn->val > max_val)
-        max_val = mn->val;
-    }
-  double y_interval =
-    MAX (
-      (double) (max_val - min_val) + 1.0, 7.0);
-  double y_note_size = 1.0 / y_interval;
+  MidiNoteIndex * index =
+    midi_region_get_note_index (self);
+  if (index->num_notes == 0)
+    return;
 
-  /* draw midi notes */
-  double loop_end_ticks =
-    obj->loop_end_pos.ticks;
-  double loop_ticks =
-    arranger_object_get_loop_length_in_ticks (
-      obj);
-  double clip_start_ticks =
-    obj->clip_start_pos.ticks;
+  MidiNotesLayout layout;
+  init_midi_notes_layout (self, index, &layout);
+  double y_note_size = 1.0 / layout.y_interval;
 
   int vis_offset_x =
     draw_rect->x - full_rect->x;
@@ -356,85 +627,74 @@ draw_midi_region (
     draw_rect->y - full_rect->y;
   int vis_width = draw_rect->width;
   int vis_height = draw_rect->height;
-  /*int full_offset_x = full_rect->x;*/
-  /*int full_offset_y = full_rect->y;*/
   int full_width = full_rect->width;
   int full_height = full_rect->height;
 
-  bool is_looped = region_is_looped (self);
-
-  for (int i = 0; i < self->num_midi_notes; i++)
+  /* if there are more notes than pixels, draw
+   * a cached raster of the notes instead */
+  if ((double) index->num_notes
+        * (double) layout.num_loops
+        > (double) full_width
+      && full_width > 0
+      && full_width <= NOTES_RASTER_MAX_WIDTH
+      && full_height > 0
+      && full_height <= NOTES_RASTER_MAX_HEIGHT)
     {
-      MidiNote * mn = self->midi_notes[i];
-      ArrangerObject * mn_obj =
-        (ArrangerObject *) mn;
-
-      /* note muted */
-      if (arranger_object_get_muted (mn_obj))
-        continue;
-
-      /* note not playable */
-      if (position_is_after_or_equal (
-            &mn_obj->pos, &obj->loop_end_pos))
-        continue;
-
-      /* note not playable if looped */
-      if (is_looped
-          &&
-          position_is_before (
-            &mn_obj->pos, &obj->loop_start_pos)
-          &&
-          position_is_before (
-            &mn_obj->pos, &obj->clip_start_pos))
-        continue;
-
-      /* get ratio (0.0 - 1.0) on x where midi note
-       * starts & ends */
-      double mn_start_ticks =
-        position_to_ticks (&mn_obj->pos);
-      double mn_end_ticks =
-        position_to_ticks (&mn_obj->end_pos);
-      double tmp_start_ticks, tmp_end_ticks;
+      GdkTexture * texture =
+        get_notes_raster (
+          self, index, &layout, full_width,
+          full_height, &color);
+      gtk_snapshot_push_clip (
+        snapshot,
+        &GRAPHENE_RECT_INIT (
+          vis_offset_x, vis_offset_y, vis_width,
+          vis_height));
+      gtk_snapshot_append_texture (
+        snapshot, texture,
+        &GRAPHENE_RECT_INIT (
+          0, 0, full_width, full_height));
+      gtk_snapshot_pop (snapshot);
+      return;
+    }
 
-      for (int j = 0; j < num_loops; j++)
+  /* visible range in ticks relative to the clip
+   * start */
+  double vis_start_ticks =
+    ((double) vis_offset_x / (double) full_width)
+    * layout.ticks_in_region;
+  double vis_end_ticks =
+    ((double) (vis_offset_x + vis_width)
+     / (double) full_width)
+    * layout.ticks_in_region;
+
+  for (int j = 0; j < layout.num_loops; j++)
+    {
+      /* only go through the notes that may be
+       * visible in this loop */
+      double loop_offset_ticks =
+        layout.clip_start_ticks -
+        layout.loop_ticks * j;
+      int num_found =
+        midi_note_index_find (
+          index, vis_start_ticks + loop_offset_ticks,
+          vis_end_ticks + loop_offset_ticks);
+
+      for (int i = 0; i < num_found; i++)
         {
-          /* if note started before loop start
-           * only draw it once */
-          if (position_is_before (
-                &mn_obj->pos,
-                &obj->loop_start_pos) &&
-              j != 0)
-            break;
+          MidiNote * mn =
+            midi_note_index_get_note (
+              index, index->found[i]);
+
+          double x_start, y_start, x_end;
+          if (!get_midi_note_loop_range (
+                self, &layout, mn, j, &x_start,
+                &x_end))
+            continue;
 
-          /* calculate draw endpoints */
-          tmp_start_ticks =
-            mn_start_ticks + loop_ticks * j;
-          /* if should be clipped */
-          if (position_is_after_or_equal (
-                &mn_obj->end_pos,
-                &obj->loop_end_pos))
-            tmp_end_ticks =
-              loop_end_ticks + loop_ticks * j;
-          else
-            tmp_end_ticks =
-              mn_end_ticks + loop_ticks * j;
-
-          /* adjust for clip start */
-          tmp_start_ticks -= clip_start_ticks;
-          tmp_end_ticks -= clip_start_ticks;
-
-          /* get ratios (0.0 - 1.0) of
-           * where midi note is */
-          x_start =
-            tmp_start_ticks /
-            ticks_in_region;
-          x_end =
-            tmp_end_ticks /
-            ticks_in_region;
           y_start =
-            ((double) max_val -
+            ((double) layout.max_val -
              (double) mn->val) /
-            y_interval;
+            layout.y_interval;
 
           /* get actual values using the
            * ratios */
@@ -445,12 +705,6 @@ draw_midi_region (
           y_start *=
             (double) full_height;
 
-          /* the above values are local to the
-           * region, convert to global */
-          /*x_start += full_rect->x;*/
-          /*x_end += full_rect->x;*/
-          /*y_start += full_rect->y;*/
-
           /* skip if any part of the note is
            * not visible in the region's rect */
           if ((x_start >= vis_offset_x &&
@@ -491,9 +745,9 @@ draw_midi_region (
 
             } /* endif part of note is visible */
 
-        } /* end foreach region loop */
+        } /* end foreach note */
 
-    } /* end foreach note */
+    } /* end foreach region loop */
 }
 
 /**
@@ -1304,38 +1558,8 @@ draw_audio_part (
           curr_frames -= loop_frames;
         }
       float min = 0.f, max = 0.f;
-      for (signed_frame_t j = prev_frames;
-           j < curr_frames; j++)
-        {
-          for (unsigned int k = 0;
-               k < clip->channels; k++)
-            {
-              signed_frame_t index =
-                j * (signed_frame_t) clip->channels +
-                (signed_frame_t) k;
-
-              /* if outside bounds */
-              if (
-                index < 0 ||
-                index >=
-                (signed_frame_t)
-                  clip->num_frames *
-                  (signed_frame_t) clip->channels)
-                {
-                  /* skip */
-                  continue;
-                }
-              float val = clip->frames[index];
-              if (val > max)
-                {
-                  max = val;
-                }
-              if (val < min)
-                {
-                  min = val;
-                }
-            }
-        }
+      audio_clip_get_min_max (
+        clip, prev_frames, curr_frames, &min, &max);
 
       /* normalize */
       min = (min + 1.f) / 2.f;
@@ -1568,6 +1792,8 @@ region_draw (
 {
   ArrangerObject * obj = (ArrangerObject *) self;
 
+  region_refresh_children_positions (self);
+
   ArrangerWidget * arranger =
     arranger_object_get_arranger (obj);
 
@@ -17,6 +17,8 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "audio/automation_track.h"
 #include "audio/audio_bus_track.h"
 #include "audio/audio_group_track.h"
@@ -33,6 +35,7 @@
 #include "gui/backend/tracklist_selections.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/backend/wrapped_object_with_change_signal.h"
 #include "gui/widgets/arranger.h"
 #include "gui/widgets/automatable_selector_popover.h"
@@ -455,6 +458,8 @@ on_leave (
       self->button_pressed = 0;
     }
   self->icon_hovered = false;
+  gtk_widget_queue_draw (
+    GTK_WIDGET (self->canvas));
 }
 
 static void
@@ -467,6 +472,8 @@ on_enter (
   self->bg_hovered = true;
   self->color_area_hovered = false;
   self->resize = 0;
+  gtk_widget_queue_draw (
+    GTK_WIDGET (self->canvas));
 }
 
 static void
@@ -570,6 +577,9 @@ on_motion (
 
   self->last_x = x;
   self->last_y = y;
+
+  gtk_widget_queue_draw (
+    GTK_WIDGET (self->canvas));
 }
 
 static bool
@@ -1930,23 +1940,190 @@ track_widget_update_icons (
     }
 }
 
-static gboolean
-track_tick_cb (
-  GtkWidget *     widget,
-  GdkFrameClock * frame_clock,
-  TrackWidget *   self)
+static void
+append_canvas_state (
+  GArray * state,
+  guint32  val)
 {
-  if (!gtk_widget_get_mapped (
-        GTK_WIDGET (self->canvas)))
+  g_array_append_val (state, val);
+}
+
+static void
+append_canvas_state_float (
+  GArray * state,
+  float    val)
+{
+  guint32 bits;
+  memcpy (&bits, &val, sizeof (bits));
+  append_canvas_state (state, bits);
+}
+
+static void
+append_canvas_state_str (
+  GArray *     state,
+  const char * str)
+{
+  append_canvas_state (
+    state, str ? g_str_hash (str) : 0);
+}
+
+/**
+ * Collects the state shown on the canvas.
+ *
+ * Strings are hashed, so the name change handler
+ * also queues a draw.
+ *
+ * Hover and sizes are not included since their
+ * handlers queue a draw themselves.
+ */
+static void
+get_canvas_state (
+  TrackWidget *           self,
+  const RefreshSnapshot * snapshot,
+  GArray *                state)
+{
+  Track * track = self->track;
+
+  g_array_set_size (state, 0);
+  append_canvas_state_str (state, track->name);
+  append_canvas_state_str (state, track->icon_name);
+  append_canvas_state_float (state, track->color.red);
+  append_canvas_state_float (
+    state, track->color.green);
+  append_canvas_state_float (
+    state, track->color.blue);
+  append_canvas_state (state, track->folded);
+  append_canvas_state (
+    state, GPOINTER_TO_UINT (self->clicked_button));
+  append_canvas_state (
+    state, GPOINTER_TO_UINT (self->clicked_am));
+  append_canvas_state (
+    state, track_is_selected (track));
+  append_canvas_state (state, track->frozen);
+  append_canvas_state (
+    state, track->lanes_visible);
+  append_canvas_state (
+    state, track->automation_visible);
+
+  if (track->channel)
+    {
+      append_canvas_state (
+        state, track_get_soloed (track));
+      append_canvas_state (
+        state, track_get_implied_soloed (track));
+      append_canvas_state (
+        state, track_get_muted (track));
+      append_canvas_state (
+        state, track_get_listened (track));
+      append_canvas_state (
+        state,
+        channel_get_mono_compat_enabled (
+          track->channel));
+    }
+  if (track->processor
+      && track->processor->monitor_audio)
+    {
+      append_canvas_state (
+        state, track_get_monitor_audio (track));
+    }
+  if (track_type_can_record (track->type)
+      && track->recording)
+    {
+      append_canvas_state (
+        state, track_get_recording (track));
+    }
+  if (track->type == TRACK_TYPE_INSTRUMENT
+      && instrument_track_get_instrument (track))
+    {
+      append_canvas_state (
+        state,
+        (guint32)
+        instrument_track_is_plugin_visible (
+          track));
+    }
+
+  if (track->lanes_visible)
     {
-      return G_SOURCE_CONTINUE;
+      for (int i = 0; i < track->num_lanes; i++)
+        {
+          append_canvas_state_str (
+            state, track->lanes[i]->name);
+        }
     }
 
-  track_widget_redraw_meters (self);
-  gtk_widget_queue_draw (
-    GTK_WIDGET (self->canvas));
+  if (!track->automation_visible)
+    return;
+
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (track);
+  if (!atl)
+    return;
 
-  return G_SOURCE_CONTINUE;
+  for (int i = 0; i < atl->num_ats; i++)
+    {
+      AutomationTrack * at = atl->ats[i];
+      if (!(at->created && at->visible))
+        continue;
+
+      append_canvas_state_str (
+        state, at->port_id.label);
+      append_canvas_state (
+        state, at->automation_mode);
+      append_canvas_state (state, at->record_mode);
+
+      Port * port =
+        port_find_from_identifier (&at->port_id);
+      if (port)
+        {
+          append_canvas_state_float (
+            state,
+            refresh_snapshot_get_control_value (
+              snapshot, port));
+        }
+    }
+}
+
+static bool
+track_refresh_cb (
+  GtkWidget *             widget,
+  const RefreshSnapshot * snapshot)
+{
+  TrackWidget * self = Z_TRACK_WIDGET (widget);
+
+  /* the meters are refreshed on their own */
+  if (!gtk_widget_get_mapped (
+        GTK_WIDGET (self->canvas)))
+    return false;
+
+  /* only used in the GTK thread */
+  static GArray * state = NULL;
+  if (!state)
+    {
+      state =
+        g_array_new (false, false, sizeof (guint32));
+    }
+  get_canvas_state (self, snapshot, state);
+
+  GArray * last_state = self->canvas_state;
+  bool changed =
+    state->len != last_state->len
+    ||
+    memcmp (
+      state->data, last_state->data,
+      state->len * sizeof (guint32)) != 0;
+  if (changed)
+    {
+      g_array_set_size (last_state, state->len);
+      memcpy (
+        last_state->data, state->data,
+        state->len * sizeof (guint32));
+      gtk_widget_queue_draw (
+        GTK_WIDGET (self->canvas));
+    }
+
+  /* keep refreshing at full rate while the
+   * track is being interacted with */
+  return changed || self->bg_hovered;
 }
 
 /**
@@ -2142,10 +2319,12 @@ track_widget_new (Track * track)
 
   track_widget_update_size (self);
 
-  gtk_widget_add_tick_callback (
-    GTK_WIDGET (self),
-    (GtkTickCallback) track_tick_cb,
-    self, NULL);
+  if (REFRESH_SCHEDULER)
+    {
+      refresh_scheduler_add (
+        REFRESH_SCHEDULER, GTK_WIDGET (self),
+        track_refresh_cb);
+    }
 
   track_canvas_widget_setup (self->canvas, self);
 
@@ -2178,6 +2357,9 @@ static void
 dispose (
   TrackWidget * self)
 {
+  object_free_w_func_and_null (
+    g_array_unref, self->canvas_state);
+
   gtk_widget_unparent (
     GTK_WIDGET (self->popover_menu));
   gtk_widget_unparent (
@@ -2224,6 +2406,9 @@ track_widget_init (TrackWidget * self)
     GTK_WIDGET (self->track_name_popover),
     GTK_WIDGET (self));
 
+  self->canvas_state =
+    g_array_new (false, false, sizeof (guint32));
+
   gtk_widget_set_vexpand_set (
     GTK_WIDGET (self), true);
 
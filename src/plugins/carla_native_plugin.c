@@ -27,6 +27,7 @@
 
 #include "audio/engine.h"
 #include "audio/midi_event.h"
+#include "audio/router.h"
 #include "audio/tempo_track.h"
 #include "audio/transport.h"
 #include "gui/backend/event.h"
@@ -727,6 +728,73 @@ carla_native_plugin_has_custom_ui (
   g_return_val_if_reached (false);
 }
 
+/**
+ * Finds the audio/CV ports whose buffers are
+ * passed to Carla.
+ *
+ * This does not allocate so it can be called
+ * during processing when the ports change.
+ */
+static void
+classify_ports (
+  CarlaNativePlugin * self)
+{
+  Plugin * pl = self->plugin;
+  unsigned int audio_ins = 0, cv_ins = 0;
+  for (unsigned int i = 0;
+       i < self->max_variant_audio_ins
+           + self->max_variant_cv_ins; i++)
+    {
+      self->in_buf_ports[i] = NULL;
+    }
+  for (int i = 0; i < pl->num_in_ports; i++)
+    {
+      Port * port = pl->in_ports[i];
+      if (port->id.type == TYPE_AUDIO
+          && audio_ins < self->max_variant_audio_ins)
+        {
+          self->in_buf_ports[audio_ins++] = port;
+        }
+      else if (port->id.type == TYPE_CV
+               && cv_ins < self->max_variant_cv_ins)
+        {
+          self->in_buf_ports[
+            self->max_variant_audio_ins
+            + cv_ins++] = port;
+        }
+    }
+
+  unsigned int audio_outs = 0, cv_outs = 0;
+  for (unsigned int i = 0;
+       i < self->max_variant_audio_outs
+           + self->max_variant_cv_outs; i++)
+    {
+      self->out_buf_ports[i] = NULL;
+    }
+  for (int i = 0; i < pl->num_out_ports; i++)
+    {
+      Port * port = pl->out_ports[i];
+      if (port->id.type == TYPE_AUDIO
+          && audio_outs < self->max_variant_audio_outs)
+        {
+          self->out_buf_ports[audio_outs++] = port;
+        }
+      else if (port->id.type == TYPE_CV
+               && cv_outs < self->max_variant_cv_outs)
+        {
+          self->out_buf_ports[
+            self->max_variant_audio_outs
+            + cv_outs++] = port;
+        }
+    }
+
+  self->classified_in_ports = pl->in_ports;
+  self->classified_num_in_ports = pl->num_in_ports;
+  self->classified_out_ports = pl->out_ports;
+  self->classified_num_out_ports =
+    pl->num_out_ports;
+}
+
 /**
  * Processes the plugin for this cycle.
  */
@@ -735,106 +803,105 @@ carla_native_plugin_process (
   CarlaNativePlugin *                 self,
   const EngineProcessTimeInfo * const time_nfo)
 {
-  self->time_info.playing =
-    TRANSPORT_IS_ROLLING;
+  TransportSnapshot tmp_snapshot;
+  const TransportSnapshot * snapshot =
+    router_get_transport_snapshot (
+      ROUTER, time_nfo->g_start_frame,
+      &tmp_snapshot);
+  self->time_info.playing = snapshot->rolling;
   self->time_info.frame =
     (uint64_t) time_nfo->g_start_frame;
-  self->time_info.bbt.bar =
-    position_get_bars (PLAYHEAD, true);
-  self->time_info.bbt.beat =
-    position_get_beats (PLAYHEAD, true);
+  self->time_info.bbt.bar = snapshot->bar;
+  self->time_info.bbt.beat = snapshot->beat;
   self->time_info.bbt.tick =
-    position_get_sixteenths (PLAYHEAD, true) *
+    snapshot->sixteenth *
       TICKS_PER_SIXTEENTH_NOTE +
-    (int) floor (position_get_ticks (PLAYHEAD));
-  Position bar_start;
-  position_set_to_bar (
-    &bar_start,
-    position_get_bars (PLAYHEAD, true));
+    (int) floor (snapshot->ticks);
   self->time_info.bbt.barStartTick =
-    (double)
-    (PLAYHEAD->ticks - bar_start.ticks);
-  int beats_per_bar =
-    tempo_track_get_beats_per_bar (P_TEMPO_TRACK);
-  int beat_unit =
-    tempo_track_get_beat_unit (P_TEMPO_TRACK);
+    snapshot->bar_ticks;
   self->time_info.bbt.beatsPerBar =
-    (float) beats_per_bar;
-  self->time_info.bbt.beatType = (float) beat_unit;
+    (float) snapshot->beats_per_bar;
+  self->time_info.bbt.beatType =
+    (float) snapshot->beat_unit;
   self->time_info.bbt.ticksPerBeat =
-    TRANSPORT->ticks_per_beat;
+    snapshot->ticks_per_beat;
   self->time_info.bbt.beatsPerMinute =
-    tempo_track_get_current_bpm (P_TEMPO_TRACK);
+    snapshot->bpm;
 
-  /* set actual audio in bufs */
-  {
-    size_t audio_ports = 0;
-    for (int i = 0;
-         i < self->plugin->num_in_ports; i++)
-      {
-        Port * port = self->plugin->in_ports[i];
-        if (port->id.type == TYPE_AUDIO)
-          {
-            self->inbufs[audio_ports++] =
-              &port->buf[time_nfo->local_offset];
-          }
-        if (audio_ports == self->max_variant_audio_ins)
-          break;
-      }
-  }
+  /* set actual audio/CV bufs (carla will write to
+   * the output ones) */
+  Plugin * pl = self->plugin;
+  if (G_UNLIKELY (
+        self->classified_in_ports != pl->in_ports
+        || self->classified_num_in_ports
+             != pl->num_in_ports
+        || self->classified_out_ports
+             != pl->out_ports
+        || self->classified_num_out_ports
+             != pl->num_out_ports))
+    {
+      classify_ports (self);
+    }
+  for (unsigned int i = 0;
+       i < self->max_variant_audio_ins
+           + self->max_variant_cv_ins; i++)
+    {
+      Port * port = self->in_buf_ports[i];
+      if (port)
+        {
+          self->inbufs[i] =
+            &port->buf[time_nfo->local_offset];
+        }
+    }
+  for (unsigned int i = 0;
+       i < self->max_variant_audio_outs
+           + self->max_variant_cv_outs; i++)
+    {
+      Port * port = self->out_buf_ports[i];
+      if (port)
+        {
+          self->outbufs[i] =
+            &port->buf[time_nfo->local_offset];
+        }
+    }
 
-  /* set actual cv in bufs */
-  {
-    size_t cv_ports = 0;
-    for (int i = 0;
-         i < self->plugin->num_in_ports; i++)
-      {
-        Port * port = self->plugin->in_ports[i];
-        if (port->id.type == TYPE_CV)
-          {
-            self->inbufs[self->max_variant_audio_ins + cv_ports++] =
-              &port->buf[time_nfo->local_offset];
-          }
-        if (cv_ports == self->max_variant_cv_ins)
-          break;
-      }
-  }
-
-  /* set actual audio out bufs (carla will write
-   * to these) */
-  {
-    size_t audio_ports = 0;
-    for (int i = 0;
-         i < self->plugin->num_out_ports; i++)
-      {
-        Port * port = self->plugin->out_ports[i];
-        if (port->id.type == TYPE_AUDIO)
-          {
-            self->outbufs[audio_ports++] =
-              &port->buf[time_nfo->local_offset];
-          }
-        if (audio_ports == self->max_variant_audio_outs)
-          break;
-      }
-  }
-
-  /* set actual cv out bufs (carla will write
-   * to these) */
-  {
-    size_t cv_ports = 0;
-    for (int i = 0;
-         i < self->plugin->num_out_ports; i++)
-      {
-        Port * port = self->plugin->out_ports[i];
-        if (port->id.type == TYPE_CV)
-          {
-            self->outbufs[self->max_variant_audio_outs + cv_ports++] =
-              &port->buf[time_nfo->local_offset];
-          }
-        if (cv_ports == self->max_variant_cv_outs)
-          break;
-      }
-  }
+  /* deliver parameter changes made since the
+   * last cycle (eg, by modulators) */
+  if (pl->ctrl_changed_any)
+    {
+      bool param_changed = false;
+      int words = (pl->num_in_ports + 31) / 32;
+      for (int i = 0; i < words; i++)
+        {
+          guint bits = pl->ctrl_changed[i];
+          gint bit = -1;
+          while ((bit = g_bit_nth_lsf (bits, bit))
+                   >= 0)
+            {
+              Port * ctrl = pl->in_ports[i * 32 + bit];
+              if (ctrl->id.type == TYPE_CONTROL
+                  && ctrl->carla_param_id >= 0)
+                {
+                  carla_set_parameter_value (
+                    self->host_handle, 0,
+                    (uint32_t) ctrl->carla_param_id,
+                    ctrl->control);
+                  param_changed = true;
+                }
+            }
+        }
+
+      /* let the UI know once */
+      if (param_changed
+          && !g_atomic_int_get (
+                &pl->state_changed_event_sent))
+        {
+          EVENTS_PUSH (
+            ET_PLUGIN_STATE_CHANGED, pl);
+          g_atomic_int_set (
+            &pl->state_changed_event_sent, 1);
+        }
+    }
 
   /* get main midi port */
   Port * port = self->plugin->midi_in_port;
@@ -857,6 +924,11 @@ carla_native_plugin_process (
           continue;
         }
 
+      /* native events can only hold short
+       * messages */
+      if (ev->raw_buffer_sz > 3)
+        continue;
+
 #if 0
       g_message (
         "writing plugin input event %d "
@@ -1632,6 +1704,11 @@ carla_native_plugin_instantiate (
     object_new_n (max_variant_outs, float *);
   self->outbufs =
     object_new_n (max_variant_ins, float *);
+  self->in_buf_ports =
+    object_new_n (MAX (max_variant_ins, 1), Port *);
+  self->out_buf_ports =
+    object_new_n (
+      MAX (max_variant_outs, 1), Port *);
   for (size_t i = 0; i < max_variant_outs; i++)
     {
       self->zero_outbufs[i] =
@@ -2554,6 +2631,10 @@ carla_native_plugin_free (
     free, self->zero_outbufs);
   object_free_w_func_and_null (
     free, self->outbufs);
+  object_free_w_func_and_null (
+    free, self->in_buf_ports);
+  object_free_w_func_and_null (
+    free, self->out_buf_ports);
 
   object_free_w_func_and_null (
     g_ptr_array_unref, self->patchbay_port_info);
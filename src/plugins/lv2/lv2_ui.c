@@ -162,6 +162,12 @@ lv2_ui_read_and_apply_events (
             port, * (float *) body, 0, 0);
           port->received_ui_event = 1;
 
+          /* also mark the port if the value did not
+           * change, so that the flag above is
+           * cleared on the next UI update */
+          plugin_mark_control_dirty (
+            plugin->plugin, port);
+
 #if 0
           /* note: should not be printing in the
            * realtime thread */
@@ -81,6 +81,7 @@
 
 #include "audio/engine.h"
 #include "audio/midi_event.h"
+#include "audio/router.h"
 #include "audio/tempo_track.h"
 #include "audio/transport.h"
 #include "gui/backend/event.h"
@@ -400,11 +401,18 @@ create_port (
         {
           g_return_val_if_fail (
             IS_PORT_AND_NONNULL (port), NULL);
-          port->buf =
-            g_realloc (
-              port->buf,
-              (size_t) AUDIO_ENGINE->block_length *
-                sizeof (float));
+
+          /* pooled buffers are owned and sized by
+           * the graph */
+          if (!port->buf_pooled)
+            {
+              port->buf =
+                g_realloc (
+                  port->buf,
+                  (size_t)
+                  AUDIO_ENGINE->block_length
+                  * sizeof (float));
+            }
         }
       else
         {
@@ -1560,6 +1568,92 @@ connect_port (
     }
 }
 
+/**
+ * Adds the index of each port matching the given
+ * condition to a newly allocated array.
+ */
+#define CLASSIFY_PORTS(arr,num,cond) \
+  num = 0; \
+  for (int i = 0; i < pl->num_lilv_ports; i++) \
+    { \
+      Port * port = pl->lilv_ports[i]; \
+      if (cond) \
+        num++; \
+    } \
+  object_zero_and_free_if_nonnull (arr); \
+  arr = object_new_n ((size_t) MAX (num, 1), int); \
+  num = 0; \
+  for (int i = 0; i < pl->num_lilv_ports; i++) \
+    { \
+      Port * port = pl->lilv_ports[i]; \
+      if (cond) \
+        arr[num++] = i; \
+    }
+
+/**
+ * Sets up the per-class port index arrays used
+ * during processing.
+ */
+static void
+classify_ports (
+  Lv2Plugin * self)
+{
+  Plugin * pl = self->plugin;
+  for (int i = 0; i < pl->num_lilv_ports; i++)
+    {
+      g_return_if_fail (
+        IS_PORT_AND_NONNULL (pl->lilv_ports[i]));
+    }
+
+  CLASSIFY_PORTS (
+    self->audio_cv_ports, self->num_audio_cv_ports,
+    port->id.type == TYPE_AUDIO
+    || port->id.type == TYPE_CV);
+  CLASSIFY_PORTS (
+    self->event_in_ports, self->num_event_in_ports,
+    port->id.type == TYPE_EVENT
+    && port->id.flow == FLOW_INPUT);
+  CLASSIFY_PORTS (
+    self->event_out_ports,
+    self->num_event_out_ports,
+    port->id.type == TYPE_EVENT
+    && port->id.flow == FLOW_OUTPUT);
+  CLASSIFY_PORTS (
+    self->control_out_ports,
+    self->num_control_out_ports,
+    port->id.type == TYPE_CONTROL
+    && port->id.flow == FLOW_OUTPUT);
+  CLASSIFY_PORTS (
+    self->freewheel_ports,
+    self->num_freewheel_ports,
+    port->id.type == TYPE_CONTROL
+    && port->id.flow == FLOW_INPUT
+    && port->id.flags & PORT_FLAG_FREEWHEEL);
+
+  self->latency_port = -1;
+  for (int i = 0; i < self->num_control_out_ports; i++)
+    {
+      int p = self->control_out_ports[i];
+      if (pl->lilv_ports[p]->id.flags
+            & PORT_FLAG_REPORTS_LATENCY)
+        {
+          self->latency_port = p;
+          break;
+        }
+    }
+
+  /* buffers will be connected in the next
+   * cycle */
+  object_zero_and_free_if_nonnull (
+    self->audio_cv_bufs);
+  self->audio_cv_bufs =
+    object_new_n (
+      (size_t) MAX (self->num_audio_cv_ports, 1),
+      float *);
+}
+
+#undef CLASSIFY_PORTS
+
 /**
  * Initializes the plugin features.
  *
@@ -2661,6 +2755,11 @@ lv2_plugin_instantiate (
 
   zix_sem_init(&self->worker.sem, 0);
 
+  /* the LV2 world is not thread-safe and plugins
+   * may be instantiated from multiple threads, so
+   * only the calls into it are serialized */
+  g_mutex_lock (&PLUGIN_MANAGER->lilv_lock);
+
   /* Load preset, if specified */
   if (!state)
     {
@@ -2686,6 +2785,8 @@ lv2_plugin_instantiate (
                 _("Failed to find preset with URI "
                 "<%s>"),
                 preset_uri);
+              g_mutex_unlock (
+                &PLUGIN_MANAGER->lilv_lock);
               return -1;
             }
         } /* end if preset uri */
@@ -2706,6 +2807,8 @@ lv2_plugin_instantiate (
                 Z_PLUGINS_LV2_PLUGIN_ERROR_FAILED,
                 _("Failed to load state from %s"),
                 state_file_path);
+              g_mutex_unlock (
+                &PLUGIN_MANAGER->lilv_lock);
               return -1;
             }
           g_free (state_file_path);
@@ -2727,8 +2830,13 @@ lv2_plugin_instantiate (
             lilv_node_as_string (lv2_uri);
           g_message (
             "Plugin URI: %s", lv2_uri_str);
-          g_return_val_if_fail (
-            LILV_PLUGINS, -1);
+          if (!LILV_PLUGINS)
+            {
+              g_critical ("no LV2 plugins");
+              g_mutex_unlock (
+                &PLUGIN_MANAGER->lilv_lock);
+              return -1;
+            }
           self->lilv_plugin =
             lilv_plugins_get_by_uri (
               LILV_PLUGINS, lv2_uri);
@@ -2742,6 +2850,8 @@ lv2_plugin_instantiate (
                 "<%s>"),
                 lv2_uri_str);
               lilv_node_free (lv2_uri);
+              g_mutex_unlock (
+                &PLUGIN_MANAGER->lilv_lock);
               return -1;
             }
           lilv_node_free (lv2_uri);
@@ -2755,6 +2865,7 @@ lv2_plugin_instantiate (
    * dynamic dependencies */
   char * library_path =
     lv2_plugin_get_library_path (self);
+  g_mutex_unlock (&PLUGIN_MANAGER->lilv_lock);
   void * handle = dlopen (library_path, RTLD_LAZY);
   if (!handle)
     {
@@ -2807,8 +2918,22 @@ lv2_plugin_instantiate (
                 descr->name, descr->uri,
                 basename, descr->author,
                 descr->website);
-              ui_show_error_message (
-                MAIN_WINDOW, true, msg);
+              /* the plugin loader shows it on the
+               * main thread */
+              if (ZRYTHM_APP_IS_GTK_THREAD)
+                {
+                  ui_show_error_message (
+                    MAIN_WINDOW, true, msg);
+                }
+              else
+                {
+                  g_free (
+                    self->plugin->
+                      instantiation_warning);
+                  self->plugin->
+                    instantiation_warning =
+                      g_strdup (msg);
+                }
               g_free (basename);
             }
 
@@ -2816,6 +2941,8 @@ lv2_plugin_instantiate (
         }
     }
   dlclose (handle);
+
+  g_mutex_lock (&PLUGIN_MANAGER->lilv_lock);
 #endif
 
   self->control_in = -1;
@@ -2834,6 +2961,8 @@ lv2_plugin_instantiate (
         "%s",
         _("Failed to create or init ports and "
         "parameters"));
+      g_mutex_unlock (
+        &PLUGIN_MANAGER->lilv_lock);
       return -1;
     }
 
@@ -2865,6 +2994,8 @@ lv2_plugin_instantiate (
             _("Required feature %s is not supported"),
             uri);
           lilv_nodes_free (req_feats);
+          g_mutex_unlock (
+            &PLUGIN_MANAGER->lilv_lock);
           return -1;
         }
     }
@@ -2958,6 +3089,8 @@ lv2_plugin_instantiate (
             error, err, "%s",
             _("Failed checking whether lv2 plugin "
             "UI is external"));
+          g_mutex_unlock (
+            &PLUGIN_MANAGER->lilv_lock);
           return -1;
         }
       else if (is_ui_external)
@@ -3129,6 +3262,8 @@ lv2_plugin_instantiate (
                 _("Required option %s is not supported"),
                 uri);
               lilv_nodes_free (required_options);
+              g_mutex_unlock (
+                &PLUGIN_MANAGER->lilv_lock);
               return -1;
             }
         }
@@ -3189,6 +3324,8 @@ lv2_plugin_instantiate (
         Z_PLUGINS_LV2_PLUGIN_ERROR,
         Z_PLUGINS_LV2_PLUGIN_ERROR_INSTANTIATION_FAILED,
         _("lilv_plugin_instantiate() failed"));
+      g_mutex_unlock (
+        &PLUGIN_MANAGER->lilv_lock);
       return -1;
     }
   g_message ("Lilv plugin instantiated");
@@ -3237,6 +3374,8 @@ lv2_plugin_instantiate (
           self->instance, LV2_OPTIONS__interface);
     }
 
+  g_mutex_unlock (&PLUGIN_MANAGER->lilv_lock);
+
   /* --- Apply state --- */
 
   /* apply loaded state to plugin instance if
@@ -3261,6 +3400,7 @@ lv2_plugin_instantiate (
     {
       connect_port (self, (uint32_t) i);
     }
+  classify_ports (self);
 
   /* Print initial control values */
   if (DEBUGGING)
@@ -3379,14 +3519,19 @@ lv2_plugin_process (
   g_return_if_fail (
     pl->instantiated && pl->activated);
 
+  TransportSnapshot tmp_snapshot;
+  const TransportSnapshot * snapshot =
+    router_get_transport_snapshot (
+      ROUTER, time_nfo->g_start_frame,
+      &tmp_snapshot);
+
   /* If transport state is not as expected, then
    * something has changed */
   const bool xport_changed =
-    self->rolling != (TRANSPORT_IS_ROLLING) ||
+    self->rolling != snapshot->rolling ||
     self->gframes != time_nfo->g_start_frame ||
     !math_floats_equal (
-      self->bpm,
-      tempo_track_get_current_bpm (P_TEMPO_TRACK));
+      self->bpm, snapshot->bpm);
 # if 0
   if (xport_changed)
     {
@@ -3411,10 +3556,6 @@ lv2_plugin_process (
     {
       /* Build an LV2 position object to report
        * change to plugin */
-      Position start_pos;
-      position_from_frames (
-        &start_pos,
-        (signed_frame_t) time_nfo->g_start_frame);
       LV2_Atom_Forge * forge = &self->dsp_forge;
       lv2_atom_forge_set_buffer (
         forge, pos_buf, sizeof(pos_buf));
@@ -3430,49 +3571,34 @@ lv2_plugin_process (
       lv2_atom_forge_key (
         forge, PM_URIDS.time_speed);
       lv2_atom_forge_float (
-        forge,
-        TRANSPORT->play_state == PLAYSTATE_ROLLING ?
-          1.0 : 0.0);
+        forge, snapshot->rolling ? 1.0 : 0.0);
       lv2_atom_forge_key (
         forge, PM_URIDS.time_barBeat);
-      int bars =
-        position_get_bars (&start_pos, true);
-      int beats =
-        position_get_beats (&start_pos, true);
-      double ticks =
-        position_get_ticks (&start_pos);
       lv2_atom_forge_float (
         forge,
-        ((float) beats - 1) +
-        ((float) ticks /
-          (float) TRANSPORT->ticks_per_beat));
+        ((float) snapshot->beat - 1) +
+        ((float) snapshot->ticks /
+          (float) snapshot->ticks_per_beat));
       lv2_atom_forge_key (
         forge, PM_URIDS.time_bar);
       lv2_atom_forge_long (
-        forge, bars - 1);
+        forge, snapshot->bar - 1);
       lv2_atom_forge_key (
         forge, PM_URIDS.time_beatUnit);
-      int beats_per_bar =
-        tempo_track_get_beats_per_bar (
-          P_TEMPO_TRACK);
-      int beat_unit =
-        tempo_track_get_beat_unit (P_TEMPO_TRACK);
-      lv2_atom_forge_int (forge, beat_unit);
+      lv2_atom_forge_int (
+        forge, snapshot->beat_unit);
       lv2_atom_forge_key (
         forge, PM_URIDS.time_beatsPerBar);
       lv2_atom_forge_float (
-        forge, (float) beats_per_bar);
+        forge, (float) snapshot->beats_per_bar);
       lv2_atom_forge_key (
         forge, PM_URIDS.time_beatsPerMinute);
-      lv2_atom_forge_float (
-        forge,
-        tempo_track_get_current_bpm (
-          P_TEMPO_TRACK));
+      lv2_atom_forge_float (forge, snapshot->bpm);
     }
 
   /* Update transport state to expected values for
    * next cycle */
-  if (TRANSPORT_IS_ROLLING)
+  if (snapshot->rolling)
     {
       Position gpos;
       position_from_frames (
@@ -3489,133 +3615,134 @@ lv2_plugin_process (
       self->gframes = time_nfo->g_start_frame;
       self->rolling = 0;
     }
-  self->bpm =
-    tempo_track_get_current_bpm (P_TEMPO_TRACK);
+  self->bpm = snapshot->bpm;
 
-  /* Prepare port buffers */
-  for (int p = 0; p < pl->num_lilv_ports; ++p)
+  /* Connect audio/CV ports whose buffers moved */
+  for (int i = 0; i < self->num_audio_cv_ports; i++)
     {
+      int p = self->audio_cv_ports[i];
       Port * port = pl->lilv_ports[p];
-      g_return_if_fail (
-        IS_PORT_AND_NONNULL (port));
+      float * buf =
+        &port->buf[time_nfo->local_offset];
+      if (self->audio_cv_bufs[i] != buf)
+        {
+          lilv_instance_connect_port (
+            self->instance, (uint32_t) p, buf);
+          self->audio_cv_bufs[i] = buf;
+        }
+    }
 
+  /* Prepare event input buffers */
+  for (int j = 0; j < self->num_event_in_ports; j++)
+    {
+      Port * port =
+        pl->lilv_ports[self->event_in_ports[j]];
       PortIdentifier * id = &port->id;
-      if (id->type == TYPE_AUDIO
-          || id->type == TYPE_CV)
+      if (G_UNLIKELY (port->evbuf == NULL))
         {
-          /* connect buffer */
-          lilv_instance_connect_port (
-            self->instance,
-            (uint32_t) p, &port->buf[time_nfo->local_offset]);
+          g_critical (
+            "evbuf is NULL for %s",
+            pl->setting->descr->uri);
+          return;
         }
-      else if (id->type == TYPE_EVENT
-               && id->flow == FLOW_INPUT)
+      lv2_evbuf_reset (port->evbuf, true);
+
+      /* Write transport change event if
+       * applicable */
+      LV2_Evbuf_Iterator iter =
+        lv2_evbuf_begin (port->evbuf);
+      if (xport_changed &&
+          id->flags & PORT_FLAG_WANT_POSITION)
         {
-          if (G_UNLIKELY (port->evbuf == NULL))
-            {
-              g_critical (
-                "evbuf is NULL for %s",
-                pl->setting->descr->uri);
-              return;
-            }
-          lv2_evbuf_reset (port->evbuf, true);
-
-          /* Write transport change event if
-           * applicable */
-          LV2_Evbuf_Iterator iter =
-            lv2_evbuf_begin (port->evbuf);
-          if (xport_changed &&
-              id->flags & PORT_FLAG_WANT_POSITION)
-            {
-              lv2_evbuf_write (
-                &iter, 0, 0,
-                lv2_pos->type, lv2_pos->size,
-                (const uint8_t*)
-                  LV2_ATOM_BODY (lv2_pos));
-            }
-
-          if (self->request_update)
-            {
-              /* Plugin state has changed, request
-               * an update */
-              const LV2_Atom_Object get = {
-                { sizeof(LV2_Atom_Object_Body),
-                  PM_URIDS.atom_Object },
-                { 0, PM_URIDS.patch_Get } };
-              lv2_evbuf_write (
-                &iter, 0, 0,
-                get.atom.type, get.atom.size,
-                (const uint8_t*)
-                  LV2_ATOM_BODY (&get));
-            }
-
-          if (port->midi_events->num_events > 0)
-            {
-              int num_events_written = 0;
-
-              /* Write MIDI input */
-              for (int i = 0;
-                   i <
-                     port->midi_events->num_events;
-                   i++)
-                {
-                  MidiEvent * ev =
-                    &port->midi_events->events[i];
-                  if (ev->time < time_nfo->local_offset ||
-                      ev->time >=
-                        time_nfo->local_offset + time_nfo->nframes)
-                    {
-                      /* skip events scheduled
-                       * for another split within
-                       * the processing cycle */
-                      continue;
-                    }
-
-                  if (ZRYTHM_TESTING)
-                    {
-                      g_message (
-                        "writing plugin input "
-                        "event %d at time %u - "
-                        "local frames %u nframes "
-                        "%u",
-                        num_events_written,
-                        ev->time - time_nfo->local_offset,
-                        time_nfo->local_offset, time_nfo->nframes);
-                      midi_event_print (ev);
-                    }
+          lv2_evbuf_write (
+            &iter, 0, 0,
+            lv2_pos->type, lv2_pos->size,
+            (const uint8_t*)
+              LV2_ATOM_BODY (lv2_pos));
+        }
 
-                  lv2_evbuf_write (
-                    &iter,
-                    /* event time is relative to
-                     * the current zrythm full
-                     * cycle (not split). it
-                     * needs to be made relative
-                     * to the current split */
-                    ev->time - time_nfo->local_offset, 0,
-                    PM_URIDS.midi_MidiEvent,
-                    3, ev->raw_buffer);
-
-                  num_events_written++;
-                }
-            }
+      if (self->request_update)
+        {
+          /* Plugin state has changed, request
+           * an update */
+          const LV2_Atom_Object get = {
+            { sizeof(LV2_Atom_Object_Body),
+              PM_URIDS.atom_Object },
+            { 0, PM_URIDS.patch_Get } };
+          lv2_evbuf_write (
+            &iter, 0, 0,
+            get.atom.type, get.atom.size,
+            (const uint8_t*)
+              LV2_ATOM_BODY (&get));
         }
-      else if (id->type == TYPE_CONTROL &&
-               id->flow == FLOW_INPUT)
+
+      if (port->midi_events->num_events > 0)
         {
-          /* let the plugin know if freewheeling */
-          if (id->flags & PORT_FLAG_FREEWHEEL)
+          int num_events_written = 0;
+
+          /* Write MIDI input */
+          for (int i = 0;
+               i <
+                 port->midi_events->num_events;
+               i++)
             {
-              if (AUDIO_ENGINE->exporting)
+              MidiEvent * ev =
+                &port->midi_events->events[i];
+              if (ev->time < time_nfo->local_offset ||
+                  ev->time >=
+                    time_nfo->local_offset + time_nfo->nframes)
                 {
-                  port->control = port->maxf;
+                  /* skip events scheduled
+                   * for another split within
+                   * the processing cycle */
+                  continue;
                 }
-              else
+
+              if (ZRYTHM_TESTING)
                 {
-                  port->control = port->minf;
+                  g_message (
+                    "writing plugin input "
+                    "event %d at time %u - "
+                    "local frames %u nframes "
+                    "%u",
+                    num_events_written,
+                    ev->time - time_nfo->local_offset,
+                    time_nfo->local_offset, time_nfo->nframes);
+                  midi_event_print (ev);
                 }
+
+              lv2_evbuf_write (
+                &iter,
+                /* event time is relative to
+                 * the current zrythm full
+                 * cycle (not split). it
+                 * needs to be made relative
+                 * to the current split */
+                ev->time - time_nfo->local_offset, 0,
+                PM_URIDS.midi_MidiEvent,
+                ev->raw_buffer_sz,
+                midi_events_get_event_data (
+                  port->midi_events, ev));
+
+              num_events_written++;
             }
         }
     }
+
+  /* let the plugin know if freewheeling */
+  for (int i = 0; i < self->num_freewheel_ports; i++)
+    {
+      Port * port =
+        pl->lilv_ports[self->freewheel_ports[i]];
+      if (AUDIO_ENGINE->exporting)
+        {
+          port->control = port->maxf;
+        }
+      else
+        {
+          port->control = port->minf;
+        }
+    }
   self->request_update = false;
 
   /* Run plugin for this cycle */
@@ -3624,121 +3751,153 @@ lv2_plugin_process (
     !AUDIO_ENGINE->exporting &&
     self->plugin->ui_instantiated;
 
-  /* Deliver MIDI output and UI events */
-  for (int p = 0; p < pl->num_lilv_ports; ++p)
+  /* if latency changed, recalc graph */
+  if (self->latency_port >= 0)
     {
-      Port * port = pl->lilv_ports[p];
-      PortIdentifier * pi = &port->id;
-      switch (pi->type)
+      Port * port =
+        pl->lilv_ports[self->latency_port];
+      if (G_UNLIKELY (
+            pl->latency
+            != (nframes_t) port->control))
         {
-        case TYPE_CONTROL:
-          if (G_UNLIKELY (pi->flow == FLOW_OUTPUT))
-            {
-              /* if latency changed, recalc graph */
-              if (G_UNLIKELY (pi->flags &
-                    PORT_FLAG_REPORTS_LATENCY &&
-                  self->plugin->latency !=
-                    (nframes_t)
-                    port->control))
-                {
-                  g_message (
-                    "%s: latency changed from %d "
-                    "to %f",
-                    pi->label, pl->latency,
-                    (double) port->control);
-                  EVENTS_PUSH (
-                    ET_PLUGIN_LATENCY_CHANGED,
-                    NULL);
-                  pl->latency =
-                    (nframes_t)
-                    port->control;
-                }
+          g_message (
+            "%s: latency changed from %d "
+            "to %f",
+            port->id.label, pl->latency,
+            (double) port->control);
+          EVENTS_PUSH (
+            ET_PLUGIN_LATENCY_CHANGED, NULL);
+          pl->latency = (nframes_t) port->control;
+        }
+    }
 
-              /* if UI is instantiated */
-              if (G_UNLIKELY (send_ui_updates &&
-                  pl->visible &&
-                  !port->received_ui_event &&
-                  !math_floats_equal (
-                    port->control,
-                    port->last_sent_control)))
-                {
-                  /* forward event to UI */
-                  lv2_ui_send_control_val_event_from_plugin_to_ui (
-                    self, port);
-                }
-            }
-          if (send_ui_updates)
+  if (send_ui_updates && pl->visible)
+    {
+      /* forward changed control outputs */
+      for (int i = 0;
+           i < self->num_control_out_ports; i++)
+        {
+          Port * port =
+            pl->lilv_ports[
+              self->control_out_ports[i]];
+          if (!math_floats_equal (
+                port->control,
+                port->last_sent_control))
             {
-              /* ignore ports that received a UI
-               * event at the start of a cycle
-               * (otherwise these causes trembling
-               * while changing them) */
-              if (port->received_ui_event)
-                {
-                  port->received_ui_event = 0;
-                  continue;
-                }
+              lv2_ui_send_control_val_event_from_plugin_to_ui (
+                self, port);
             }
-          break;
-        case TYPE_EVENT:
-          if (pi->flow == FLOW_OUTPUT)
+        }
+
+      /* forward input controls changed since the
+       * last UI update */
+      if (pl->ctrl_ui_pending_any)
+        {
+          int words = (pl->num_in_ports + 31) / 32;
+          for (int i = 0; i < words; i++)
             {
-              for (LV2_Evbuf_Iterator iter =
-                     lv2_evbuf_begin (
-                       port->evbuf);
-                   lv2_evbuf_is_valid(iter);
-                   iter = lv2_evbuf_next (iter))
+              guint bits = pl->ctrl_ui_pending[i];
+              if (bits == 0)
+                continue;
+
+              gint bit = -1;
+              while ((bit =
+                        g_bit_nth_lsf (bits, bit))
+                     >= 0)
                 {
-                  // Get event from LV2 buffer
-                  uint32_t frames, subframes,
-                           type, size;
-                  uint8_t* body;
-                  lv2_evbuf_get (
-                    iter, &frames, &subframes,
-                    &type, &size, &body);
-
-                  /* if midi event */
-                  if (body && type ==
-                      PM_URIDS.
-                        midi_MidiEvent)
+                  Port * port =
+                    pl->in_ports[i * 32 + bit];
+
+                  /* ignore ports changed by the
+                   * UI itself (otherwise these
+                   * cause trembling while
+                   * changing them) */
+                  if (port->received_ui_event)
                     {
-                      if (size != 3)
-                        {
-                          g_message (
-                            "unhandled event from "
-                            "port %s of size %"
-                            PRIu32,
-                            pi->label, size);
-                        }
-                      else
-                        {
-                          /* Write MIDI event to port */
-                          midi_events_add_event_from_buf (
-                            port->midi_events,
-                            frames, body,
-                            (int) size, 0);
-                        }
+                      port->received_ui_event = 0;
+                      continue;
                     }
 
-                  /* if UI is instantiated */
-                  if (pl->visible &&
-                      !port->old_api)
+                  if (port->id.type == TYPE_CONTROL
+                      && !(port->id.flags
+                           & PORT_FLAG_GENERIC_PLUGIN_PORT)
+                      && !math_floats_equal (
+                            port->control,
+                            port->last_sent_control))
                     {
-                      /* forward event to UI */
-                      lv2_ui_send_event_from_plugin_to_ui (
-                        self, (uint32_t) p,
-                        type, size, body);
+                      lv2_ui_send_control_val_event_from_plugin_to_ui (
+                        self, port);
                     }
                 }
+              pl->ctrl_ui_pending[i] = 0;
+            }
+          pl->ctrl_ui_pending_any = false;
+        }
+    }
+
+  /* Deliver MIDI output and UI events */
+  for (int i = 0;
+       i < self->num_event_out_ports; i++)
+    {
+      int p = self->event_out_ports[i];
+      Port * port = pl->lilv_ports[p];
+      PortIdentifier * pi = &port->id;
+      for (LV2_Evbuf_Iterator iter =
+             lv2_evbuf_begin (
+               port->evbuf);
+           lv2_evbuf_is_valid(iter);
+           iter = lv2_evbuf_next (iter))
+        {
+          // Get event from LV2 buffer
+          uint32_t frames, subframes,
+                   type, size;
+          uint8_t* body;
+          lv2_evbuf_get (
+            iter, &frames, &subframes,
+            &type, &size, &body);
+
+          /* if midi event */
+          if (body && type ==
+              PM_URIDS.
+                midi_MidiEvent)
+            {
+              if (size != 3
+                  &&
+                  (size == 0
+                   || ((const uint8_t *) body)[0]
+                        != 0xF0))
+                {
+                  g_message (
+                    "unhandled event from "
+                    "port %s of size %"
+                    PRIu32,
+                    pi->label, size);
+                }
+              else
+                {
+                  /* Write MIDI event to port */
+                  midi_events_add_event_from_buf (
+                    port->midi_events,
+                    frames, body,
+                    (int) size, 0);
+                }
+            }
 
-              /* Clear event output for plugin to
-               * write to next cycle */
-              lv2_evbuf_reset (
-                port->evbuf, false);
+          /* if UI is instantiated */
+          if (pl->visible &&
+              !port->old_api)
+            {
+              /* forward event to UI */
+              lv2_ui_send_event_from_plugin_to_ui (
+                self, (uint32_t) p,
+                type, size, body);
             }
-        default:
-          break;
         }
+
+      /* Clear event output for plugin to
+       * write to next cycle */
+      lv2_evbuf_reset (
+        port->evbuf, false);
     }
 }
 
@@ -3909,6 +4068,19 @@ lv2_plugin_free (
   object_free_w_func_and_null (
     free, self->ui_event_buf);
 
+  object_zero_and_free_if_nonnull (
+    self->audio_cv_ports);
+  object_zero_and_free_if_nonnull (
+    self->event_in_ports);
+  object_zero_and_free_if_nonnull (
+    self->event_out_ports);
+  object_zero_and_free_if_nonnull (
+    self->control_out_ports);
+  object_zero_and_free_if_nonnull (
+    self->freewheel_ports);
+  object_zero_and_free_if_nonnull (
+    self->audio_cv_bufs);
+
   if (self->extui.plugin_human_id)
     {
       g_free ((char *) self->extui.plugin_human_id);
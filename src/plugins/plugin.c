@@ -44,6 +44,7 @@
 #include "plugins/cached_plugin_descriptors.h"
 #include "plugins/carla_native_plugin.h"
 #include "plugins/plugin.h"
+#include "plugins/plugin_loader.h"
 #include "plugins/plugin_manager.h"
 #include "plugins/plugin_gtk.h"
 #include "plugins/lv2_plugin.h"
@@ -185,6 +186,38 @@ set_enabled_and_gain (
   g_return_if_fail (self->enabled && self->gain);
 }
 
+/**
+ * Grows the control bitsets so that they can hold
+ * all the input ports.
+ *
+ * Must not be called while the plugin is being
+ * processed.
+ */
+static void
+ensure_ctrl_bitsets (
+  Plugin * self)
+{
+  int words = (self->num_in_ports + 31) / 32;
+  if (words <= self->ctrl_bitset_size)
+    return;
+
+  int new_size = MAX (self->ctrl_bitset_size, 1);
+  while (new_size < words)
+    new_size *= 2;
+  size_t prev_n = (size_t) self->ctrl_bitset_size;
+  size_t n = (size_t) new_size;
+  self->ctrl_dirty =
+    object_realloc_n (
+      self->ctrl_dirty, prev_n, n, guint);
+  self->ctrl_changed =
+    object_realloc_n (
+      self->ctrl_changed, prev_n, n, guint);
+  self->ctrl_ui_pending =
+    object_realloc_n (
+      self->ctrl_ui_pending, prev_n, n, guint);
+  self->ctrl_bitset_size = new_size;
+}
+
 void
 plugin_init_loaded (
   Plugin *          self,
@@ -205,6 +238,7 @@ plugin_init_loaded (
     }
   object_free_w_func_and_null (
     g_ptr_array_unref, ports);
+  ensure_ctrl_bitsets (self);
 
   set_enabled_and_gain (self);
 
@@ -234,7 +268,15 @@ plugin_init_loaded (
     }
 #endif
 
-  if (plugin_is_in_active_project (self))
+  if (plugin_is_in_active_project (self)
+      && !PROJECT->loaded && PLUGIN_LOADER)
+    {
+      /* instantiate in the background after the
+       * project is loaded */
+      plugin_loader_add_plugin (
+        PLUGIN_LOADER, self);
+    }
+  else if (plugin_is_in_active_project (self))
     {
       bool was_enabled =
         plugin_is_enabled (self, false);
@@ -763,9 +805,10 @@ plugin_validate (
   if (plugin_is_in_active_project (self))
     {
       /* assert instantiated and activated, or
-       * instantiation failed */
+       * instantiation failed or pending */
       g_return_val_if_fail (
         self->instantiation_failed
+        || self->instantiation_pending
         ||
         (self->instantiated && self->activated),
         false);
@@ -1325,6 +1368,96 @@ plugin_update_latency (
              pl->latency);
 }
 
+/**
+ * Marks the control value of the given input
+ * port as changed so that it is delivered to the
+ * plugin and its UI in the next cycle.
+ *
+ * This can be called from any thread.
+ */
+void
+plugin_mark_control_dirty (
+  Plugin *     self,
+  const Port * port)
+{
+  int idx = port->id.port_index;
+  if (G_UNLIKELY (
+        idx < 0
+        || idx >= self->ctrl_bitset_size * 32))
+    return;
+
+  g_atomic_int_or (
+    &self->ctrl_dirty[idx / 32], 1u << (idx % 32));
+  g_atomic_int_set (&self->ctrl_dirty_any, 1);
+}
+
+/**
+ * Takes the control changes made since the last
+ * cycle into @ref Plugin.ctrl_changed.
+ */
+static inline void
+take_control_changes (
+  Plugin * self)
+{
+  if (!g_atomic_int_compare_and_exchange (
+         &self->ctrl_dirty_any, 1, 0))
+    return;
+
+  int words = (self->num_in_ports + 31) / 32;
+  for (int i = 0; i < words; i++)
+    {
+      if (g_atomic_int_get (
+            &self->ctrl_dirty[i]) == 0)
+        continue;
+
+      self->ctrl_changed[i] |=
+        g_atomic_int_and (&self->ctrl_dirty[i], 0);
+      self->ctrl_changed_any = true;
+    }
+}
+
+/**
+ * Handles the control changes of this cycle after
+ * the plugin was processed.
+ *
+ * Turns off trigger controls and queues the
+ * changes for the plugin UI.
+ */
+static inline void
+finish_control_changes (
+  Plugin * self)
+{
+  if (!self->ctrl_changed_any)
+    return;
+
+  int words = (self->num_in_ports + 31) / 32;
+  for (int i = 0; i < words; i++)
+    {
+      guint bits = self->ctrl_changed[i];
+      if (bits == 0)
+        continue;
+
+      gint bit = -1;
+      while ((bit = g_bit_nth_lsf (bits, bit)) >= 0)
+        {
+          Port * port = self->in_ports[i * 32 + bit];
+          if (port->id.type == TYPE_CONTROL
+              && port->id.flags & PORT_FLAG_TRIGGER
+              && !math_floats_equal (
+                    port->control, 0.f))
+            {
+              port_set_control_value (
+                port, 0.f, 0, 1);
+            }
+        }
+
+      self->ctrl_ui_pending[i] |= bits;
+      self->ctrl_changed[i] = 0;
+    }
+  self->ctrl_ui_pending_any = true;
+  self->ctrl_changed_any = false;
+}
+
 /**
  * Adds a port of the given type to the Plugin.
  */
@@ -1360,6 +1493,7 @@ plugin_add_in_port (
   Port *   port)
 {
   ADD_PORT (in);
+  ensure_ctrl_bitsets (pl);
   /*g_message (*/
     /*"added input port %s to plugin %s at index %d",*/
     /*port->id.label, pl->descr->name,*/
@@ -1688,9 +1822,17 @@ plugin_instantiate (
 
   set_enabled_and_gain (self);
 
-  plugin_set_ui_refresh_rate (self);
+  /* when instantiating in the background, this is
+   * done by the plugin loader on the main thread */
+  if (!self->instantiation_pending)
+    {
+      plugin_set_ui_refresh_rate (self);
+    }
 
-  if (!PROJECT->loaded)
+  /* whether instantiating from a loaded project */
+  bool loading =
+    !PROJECT->loaded || self->instantiation_pending;
+  if (loading)
     {
       g_return_val_if_fail (self->state_dir, -1);
     }
@@ -1702,7 +1844,7 @@ plugin_instantiate (
       GError * err = NULL;
       int ret =
         carla_native_plugin_instantiate (
-          self->carla, !PROJECT->loaded,
+          self->carla, loading,
           self->state_dir ? true : false,
           &err);
       if (ret != 0)
@@ -1755,9 +1897,13 @@ plugin_instantiate (
                   "state dir does not exist for "
                   "LV2 plugin %s, creating "
                   "state...", descr->name);
+                g_mutex_lock (
+                  &PLUGIN_MANAGER->lilv_lock);
                 LilvState * tmp_state =
                   lv2_state_save_to_file (
                     self->lv2, F_NOT_BACKUP);
+                g_mutex_unlock (
+                  &PLUGIN_MANAGER->lilv_lock);
                 lilv_state_free (tmp_state);
               }
           }
@@ -1801,6 +1947,33 @@ plugin_prepare_process (
     }
 }
 
+/**
+ * Clears the audio outputs with pooled buffers,
+ * for when the plugin does not write them.
+ *
+ * Pooled buffers are not cleared before the cycle
+ * so they would otherwise contain data from other
+ * ports.
+ */
+static void
+clear_pooled_audio_outputs (
+  Plugin *                            self,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  for (int i = 0; i < self->num_out_ports; i++)
+    {
+      Port * port = self->out_ports[i];
+      if (port->id.type != TYPE_AUDIO
+          || !port->buf_pooled)
+        continue;
+
+      dsp_fill (
+        &port->buf[time_nfo->local_offset],
+        DENORMAL_PREVENTION_VAL,
+        time_nfo->nframes);
+    }
+}
+
 /**
  * Process plugin.
  */
@@ -1816,8 +1989,18 @@ plugin_process (
       return;
     }
 
+  /* pass through until the plugin loader is done
+   * with this plugin */
+  if (g_atomic_int_get (
+        &plugin->instantiation_pending))
+    {
+      plugin_process_passthrough (plugin, time_nfo);
+      return;
+    }
+
   if (!plugin->instantiated || !plugin->activated)
     {
+      clear_pooled_audio_outputs (plugin, time_nfo);
       return;
     }
 
@@ -1832,6 +2015,8 @@ plugin_process (
         /* add midi events to input port */
     }
 
+  take_control_changes (plugin);
+
 #ifdef HAVE_CARLA
   if (plugin->setting->open_with_carla)
     {
@@ -1854,18 +2039,9 @@ plugin_process (
     }
 #endif
 
-  /* turn off any trigger input controls */
-  for (int i = 0; i < plugin->num_in_ports; i++)
-    {
-      Port * port = plugin->in_ports[i];
-      if (port->id.type == TYPE_CONTROL &&
-          port->id.flags &
-            PORT_FLAG_TRIGGER &&
-          !math_floats_equal (port->control, 0.f))
-        {
-          port_set_control_value (port, 0.f, 0, 1);
-        }
-    }
+  /* turn off any trigger input controls that
+   * were set */
+  finish_control_changes (plugin);
 
   /* if plugin has gain, apply it */
   if (!math_floats_equal_epsilon (
@@ -1955,6 +2131,22 @@ plugin_open_ui (
       return;
     }
 
+  if (self->instantiation_pending)
+    {
+      g_message (
+        "plugin %s is still loading, no UI to "
+        "open",
+        pl_str);
+      plugin_loader_prioritize_plugin (
+        PLUGIN_LOADER, self);
+      char msg[800];
+      sprintf (
+        msg, _("%s is still loading"),
+        descr->name);
+      ui_show_notification (msg);
+      return;
+    }
+
   /* show error if LV2 UI type is deprecated */
   if (descr->protocol == PROT_LV2 &&
       (!setting->open_with_carla ||
@@ -2409,6 +2601,10 @@ plugin_process_passthrough (
   Plugin *                            self,
   const EngineProcessTimeInfo * const time_nfo)
 {
+  /* outputs without a matching input are not
+   * written below */
+  clear_pooled_audio_outputs (self, time_nfo);
+
   int last_audio_idx = 0;
   int last_midi_idx = 0;
   for (int i = 0; i < self->num_in_ports; i++)
@@ -2739,7 +2935,8 @@ plugin_connect_to_prefader (
   Channel * ch)
 {
   g_return_if_fail (
-    pl->instantiated || pl->instantiation_failed);
+    pl->instantiated || pl->instantiation_failed
+    || pl->instantiation_pending);
 
   Track * track = channel_get_track (ch);
   PortType type = track->out_signal_type;
@@ -3218,6 +3415,13 @@ plugin_free (
     "freeing plugin %s",
     self->setting->descr->name);
 
+  if (self->instantiation_pending
+      && PROJECT && PLUGIN_LOADER)
+    {
+      plugin_loader_cancel_plugin (
+        PLUGIN_LOADER, self);
+    }
+
   object_free_w_func_and_null (
     lv2_plugin_free, self->lv2);
 #ifdef HAVE_CARLA
@@ -3239,6 +3443,13 @@ plugin_free (
     }
 
   object_zero_and_free (self->lilv_ports);
+  object_free_w_func_and_null (
+    free, self->ctrl_dirty);
+  g_free_and_null (self->instantiation_warning);
+  object_free_w_func_and_null (
+    free, self->ctrl_changed);
+  object_free_w_func_and_null (
+    free, self->ctrl_ui_pending);
 
   object_zero_and_free (self);
 }
@@ -0,0 +1,667 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "audio/engine.h"
+#include "audio/router.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "gui/backend/event.h"
+#include "gui/backend/event_manager.h"
+#include "gui/widgets/main_window.h"
+#include "plugins/carla_native_plugin.h"
+#include "plugins/lv2_plugin.h"
+#include "plugins/plugin.h"
+#include "plugins/plugin_loader.h"
+#include "project.h"
+#include "utils/error.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+#include "utils/ui.h"
+#include "zrythm_app.h"
+
+#include <glib/gi18n.h>
+
+/** Interval to check for finished jobs on the main
+ * thread, in ms. */
+#define CHECK_INTERVAL 40
+
+typedef enum PluginLoadJobState
+{
+  PLUGIN_LOAD_JOB_QUEUED,
+  PLUGIN_LOAD_JOB_RUNNING,
+  PLUGIN_LOAD_JOB_FINISHED,
+  PLUGIN_LOAD_JOB_COMPLETED,
+  PLUGIN_LOAD_JOB_CANCELLED,
+} PluginLoadJobState;
+
+typedef struct PluginLoadJob
+{
+  Plugin *           pl;
+
+  PluginLoadJobState state;
+
+  /** Higher runs first. */
+  int                priority;
+
+  /** Order of addition, for jobs with the same
+   * priority. */
+  int                idx;
+
+  /** Whether the plugin was enabled before
+   * instantiation. */
+  bool               was_enabled;
+
+  /** Block length the plugin was instantiated
+   * with. */
+  nframes_t          block_length;
+
+  /** Instantiation result. */
+  int                ret;
+  GError *           err;
+} PluginLoadJob;
+
+static int
+get_priority (
+  Plugin * pl)
+{
+  Track * track = plugin_get_track (pl);
+  g_return_val_if_fail (IS_TRACK_AND_NONNULL (track), 0);
+
+  int priority = 0;
+  if (track_type_can_record (track->type)
+      && track_get_recording (track))
+    priority += 8;
+  if (track_is_selected (track))
+    priority += 4;
+  if (track->visible)
+    priority += 2;
+  if (pl->id.slot_type == PLUGIN_SLOT_INSTRUMENT)
+    priority += 1;
+
+  return priority;
+}
+
+static gint
+job_cmp (
+  gconstpointer a,
+  gconstpointer b,
+  gpointer      user_data)
+{
+  const PluginLoadJob * job_a =
+    (const PluginLoadJob *) a;
+  const PluginLoadJob * job_b =
+    (const PluginLoadJob *) b;
+
+  if (job_a->priority != job_b->priority)
+    return job_b->priority - job_a->priority;
+
+  return job_a->idx - job_b->idx;
+}
+
+/**
+ * Instantiates the plugin of the job.
+ *
+ * Called from the worker threads, or from the
+ * main thread for plugins that need it.
+ *
+ * @see needs_main_thread().
+ */
+static void
+instantiate_func (
+  PluginLoadJob * job,
+  PluginLoader *  self)
+{
+  g_mutex_lock (&self->lock);
+  if (job->state == PLUGIN_LOAD_JOB_CANCELLED)
+    {
+      g_mutex_unlock (&self->lock);
+      return;
+    }
+  job->state = PLUGIN_LOAD_JOB_RUNNING;
+  g_mutex_unlock (&self->lock);
+
+  /* calls into the LV2 world are serialized by
+   * the plugin manager, the rest runs
+   * concurrently */
+  job->block_length = AUDIO_ENGINE->block_length;
+  job->ret =
+    plugin_instantiate (job->pl, NULL, &job->err);
+
+  g_mutex_lock (&self->lock);
+  job->state = PLUGIN_LOAD_JOB_FINISHED;
+  g_queue_push_tail (self->finished, job);
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+}
+
+/**
+ * Activates the plugin of a finished job (or
+ * disables it if instantiation failed).
+ */
+static void
+complete_job (
+  PluginLoader *  self,
+  PluginLoadJob * job)
+{
+  Plugin * pl = job->pl;
+
+  if (job->ret == 0)
+    {
+      /* reallocate buffers if the block length
+       * changed during instantiation */
+      if (job->block_length
+            != AUDIO_ENGINE->block_length)
+        {
+#ifdef HAVE_CARLA
+          if (pl->setting->open_with_carla)
+            {
+              carla_native_plugin_update_buffer_size_and_sample_rate (
+                pl->carla);
+            }
+          else
+#endif
+            {
+              lv2_plugin_allocate_port_buffers (
+                pl->lv2);
+            }
+        }
+
+      plugin_activate (pl, true);
+      plugin_set_enabled (
+        pl, job->was_enabled, F_NO_PUBLISH_EVENTS);
+
+      if (pl->instantiation_warning)
+        {
+          if (ZRYTHM_HAVE_UI)
+            {
+              ui_show_error_message (
+                MAIN_WINDOW, true,
+                pl->instantiation_warning);
+            }
+          else
+            {
+              g_warning (
+                "%s", pl->instantiation_warning);
+            }
+          g_free_and_null (
+            pl->instantiation_warning);
+        }
+    }
+  else
+    {
+      /* disable plugin, instantiation failed */
+      HANDLE_ERROR (
+        job->err,
+        _("Instantiation failed for "
+        "plugin '%s'. Disabling..."),
+        pl->setting->descr->name);
+      pl->instantiation_failed = true;
+    }
+
+  /* let the engine process the plugin */
+  g_atomic_int_set (&pl->instantiation_pending, 0);
+
+  job->state = PLUGIN_LOAD_JOB_COMPLETED;
+  self->num_pending--;
+
+  EVENTS_PUSH (ET_PLUGIN_STATE_CHANGED, pl);
+}
+
+static void
+on_finished (
+  PluginLoader * self)
+{
+  g_message (
+    "%s: %d plugins loaded", __func__,
+    self->num_total);
+
+  /* plugin states were loaded from the backup (if
+   * any) so this is no longer needed */
+  PROJECT->loading_from_backup = false;
+
+  if (self->num_total == 0)
+    return;
+
+  /* update latencies */
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+  if (ZRYTHM_HAVE_UI)
+    {
+      ui_show_notification (
+        _("All plugins loaded"));
+    }
+}
+
+/**
+ * Completes the finished jobs.
+ *
+ * @return Whether there are no more pending jobs.
+ */
+static bool
+complete_finished_jobs (
+  PluginLoader * self)
+{
+  while (true)
+    {
+      g_mutex_lock (&self->lock);
+      PluginLoadJob * job =
+        (PluginLoadJob *)
+        g_queue_pop_head (self->finished);
+      g_mutex_unlock (&self->lock);
+      if (!job)
+        break;
+
+      complete_job (self, job);
+    }
+
+  return self->num_pending == 0;
+}
+
+/**
+ * Returns whether the plugin must be instantiated
+ * on the main thread.
+ *
+ * VST and AU plugins hosted by Carla in-process
+ * expect to be instantiated on the main thread,
+ * and so do LV2 plugins hosted by Carla, since
+ * Carla's LV2 world is not thread-safe. Bridged
+ * plugins run in a separate process and other
+ * Carla plugins (LADSPA, DSSI, SFZ, SF2) are
+ * instantiated in the worker threads.
+ */
+static bool
+needs_main_thread (
+  Plugin * pl)
+{
+  PluginSetting * setting = pl->setting;
+  if (!setting->open_with_carla)
+    return false;
+
+  if (setting->bridge_mode != CARLA_BRIDGE_NONE)
+    return false;
+
+  switch (setting->descr->protocol)
+    {
+    case PROT_LV2:
+    case PROT_VST:
+    case PROT_VST3:
+    case PROT_AU:
+      return true;
+    default:
+      return false;
+    }
+}
+
+/**
+ * Instantiates the next queued main thread job,
+ * if any.
+ *
+ * @return Whether a job was instantiated.
+ */
+static bool
+instantiate_next_main_thread_job (
+  PluginLoader * self)
+{
+  g_mutex_lock (&self->lock);
+  PluginLoadJob * job = NULL;
+  while (!job
+         &&
+         !g_queue_is_empty (self->main_thread_jobs))
+    {
+      job =
+        (PluginLoadJob *)
+        g_queue_pop_head (self->main_thread_jobs);
+      if (job->state != PLUGIN_LOAD_JOB_QUEUED)
+        job = NULL;
+    }
+  g_mutex_unlock (&self->lock);
+  if (!job)
+    return false;
+
+  instantiate_func (job, self);
+
+  return true;
+}
+
+static int
+check_finished_jobs_cb (
+  PluginLoader * self)
+{
+  /* one at a time so that the UI stays
+   * responsive */
+  instantiate_next_main_thread_job (self);
+
+  if (complete_finished_jobs (self))
+    {
+      self->source_id = 0;
+      on_finished (self);
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+free_job (
+  PluginLoadJob * job)
+{
+  if (job->err)
+    g_error_free (job->err);
+
+  object_zero_and_free (job);
+}
+
+PluginLoader *
+plugin_loader_new (void)
+{
+  PluginLoader * self =
+    object_new (PluginLoader);
+
+  self->jobs =
+    g_ptr_array_new_with_free_func (
+      (GDestroyNotify) free_job);
+  self->finished = g_queue_new ();
+  self->main_thread_jobs = g_queue_new ();
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+
+  return self;
+}
+
+/**
+ * Adds a plugin to be instantiated.
+ *
+ * Must be called before plugin_loader_start().
+ */
+void
+plugin_loader_add_plugin (
+  PluginLoader * self,
+  Plugin *       pl)
+{
+  g_return_if_fail (!self->started);
+
+  PluginLoadJob * job = object_new (PluginLoadJob);
+  job->pl = pl;
+  job->idx = (int) self->jobs->len;
+  job->state = PLUGIN_LOAD_JOB_QUEUED;
+  g_ptr_array_add (self->jobs, job);
+
+  pl->instantiation_pending = 1;
+  self->num_pending++;
+  self->num_total++;
+}
+
+/**
+ * Starts instantiating the added plugins in
+ * priority order.
+ */
+void
+plugin_loader_start (
+  PluginLoader * self)
+{
+  g_return_if_fail (!self->started);
+  self->started = true;
+
+  if (self->num_pending == 0)
+    {
+      on_finished (self);
+      return;
+    }
+
+  g_message (
+    "%s: instantiating %d plugins in the "
+    "background",
+    __func__, self->num_pending);
+
+  for (guint i = 0; i < self->jobs->len; i++)
+    {
+      PluginLoadJob * job =
+        g_ptr_array_index (self->jobs, i);
+      Plugin * pl = job->pl;
+
+      job->priority = get_priority (pl);
+      job->was_enabled = plugin_is_enabled (pl, false);
+
+      /* this queries GDK so it must be done here */
+      plugin_set_ui_refresh_rate (pl);
+    }
+
+  GError * err = NULL;
+  self->pool =
+    g_thread_pool_new (
+      (GFunc) instantiate_func, self,
+      (int) g_get_num_processors (), F_NOT_EXCLUSIVE,
+      &err);
+  if (!self->pool)
+    {
+      g_warning (
+        "failed to create plugin loader threads, "
+        "instantiating plugins synchronously: %s",
+        err->message);
+      g_error_free (err);
+      for (guint i = 0; i < self->jobs->len; i++)
+        {
+          instantiate_func (
+            g_ptr_array_index (self->jobs, i), self);
+        }
+      complete_finished_jobs (self);
+      on_finished (self);
+      return;
+    }
+  g_thread_pool_set_sort_function (
+    self->pool, job_cmp, NULL);
+
+  for (guint i = 0; i < self->jobs->len; i++)
+    {
+      PluginLoadJob * job =
+        g_ptr_array_index (self->jobs, i);
+      if (needs_main_thread (job->pl))
+        {
+          g_queue_insert_sorted (
+            self->main_thread_jobs, job, job_cmp,
+            NULL);
+        }
+      else
+        {
+          g_thread_pool_push (
+            self->pool, job, NULL);
+        }
+    }
+
+  self->source_id =
+    g_timeout_add (
+      CHECK_INTERVAL,
+      (GSourceFunc) check_finished_jobs_cb, self);
+}
+
+static PluginLoadJob *
+find_job (
+  PluginLoader * self,
+  Plugin *       pl)
+{
+  for (guint i = 0; i < self->jobs->len; i++)
+    {
+      PluginLoadJob * job =
+        g_ptr_array_index (self->jobs, i);
+      if (job->pl == pl)
+        return job;
+    }
+
+  return NULL;
+}
+
+/**
+ * Moves the given pending plugin to the front of
+ * the queue.
+ */
+void
+plugin_loader_prioritize_plugin (
+  PluginLoader * self,
+  Plugin *       pl)
+{
+  if (!self->pool)
+    return;
+
+  g_mutex_lock (&self->lock);
+  PluginLoadJob * job = find_job (self, pl);
+  if (job && job->state == PLUGIN_LOAD_JOB_QUEUED)
+    {
+      job->priority = G_MAXINT;
+      g_debug (
+        "prioritizing plugin %s",
+        pl->setting->descr->name);
+    }
+  g_queue_sort (
+    self->main_thread_jobs, job_cmp, NULL);
+  g_mutex_unlock (&self->lock);
+
+  /* re-sort the queue */
+  g_thread_pool_set_sort_function (
+    self->pool, job_cmp, NULL);
+}
+
+/**
+ * Removes the given plugin from the loader,
+ * waiting for it if it is currently being
+ * instantiated.
+ *
+ * To be called before the plugin is free'd.
+ */
+void
+plugin_loader_cancel_plugin (
+  PluginLoader * self,
+  Plugin *       pl)
+{
+  g_mutex_lock (&self->lock);
+  PluginLoadJob * job = find_job (self, pl);
+  if (!job)
+    {
+      g_mutex_unlock (&self->lock);
+      return;
+    }
+
+  while (job->state == PLUGIN_LOAD_JOB_RUNNING)
+    {
+      g_cond_wait (&self->cond, &self->lock);
+    }
+
+  switch (job->state)
+    {
+    case PLUGIN_LOAD_JOB_QUEUED:
+      job->state = PLUGIN_LOAD_JOB_CANCELLED;
+      self->num_pending--;
+      break;
+    case PLUGIN_LOAD_JOB_FINISHED:
+      g_queue_remove (self->finished, job);
+      job->state = PLUGIN_LOAD_JOB_CANCELLED;
+      self->num_pending--;
+      break;
+    default:
+      break;
+    }
+  job->pl = NULL;
+  g_mutex_unlock (&self->lock);
+
+  g_atomic_int_set (&pl->instantiation_pending, 0);
+}
+
+/**
+ * Blocks until all plugins are instantiated and
+ * activated.
+ *
+ * Must be called from the main thread.
+ */
+void
+plugin_loader_wait (
+  PluginLoader * self)
+{
+  if (!self->started || !self->source_id)
+    return;
+
+  g_message (
+    "%s: waiting for %d plugins...", __func__,
+    self->num_pending);
+
+  while (instantiate_next_main_thread_job (self))
+    ;
+
+  while (!complete_finished_jobs (self))
+    {
+      g_mutex_lock (&self->lock);
+      while (g_queue_is_empty (self->finished))
+        {
+          g_cond_wait (&self->cond, &self->lock);
+        }
+      g_mutex_unlock (&self->lock);
+    }
+
+  g_source_remove (self->source_id);
+  self->source_id = 0;
+  on_finished (self);
+}
+
+/**
+ * Returns whether all added plugins are ready.
+ */
+bool
+plugin_loader_is_finished (
+  PluginLoader * self)
+{
+  return self->started && self->num_pending == 0;
+}
+
+void
+plugin_loader_free (
+  PluginLoader * self)
+{
+  if (self->source_id)
+    {
+      g_source_remove (self->source_id);
+      self->source_id = 0;
+    }
+
+  /* drop queued jobs and wait for running ones */
+  if (self->pool)
+    {
+      g_thread_pool_free (self->pool, true, true);
+      self->pool = NULL;
+    }
+
+  for (guint i = 0; i < self->jobs->len; i++)
+    {
+      PluginLoadJob * job =
+        g_ptr_array_index (self->jobs, i);
+      if (job->pl)
+        {
+          g_atomic_int_set (
+            &job->pl->instantiation_pending, 0);
+        }
+    }
+
+  object_free_w_func_and_null (
+    g_ptr_array_unref, self->jobs);
+  object_free_w_func_and_null (
+    g_queue_free, self->finished);
+  object_free_w_func_and_null (
+    g_queue_free, self->main_thread_jobs);
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond);
+
+  object_zero_and_free (self);
+}
@@ -417,6 +417,7 @@ plugin_manager_new (void)
 
   self->symap = symap_new();
   zix_sem_init (&self->symap_lock, 1);
+  g_mutex_init (&self->lilv_lock);
 
   self->nodes_size = 1;
   self->nodes =
@@ -1500,6 +1501,7 @@ plugin_manager_free (
 
   object_free_w_func_and_null (
     lilv_world_free, self->lilv_world);
+  g_mutex_clear (&self->lilv_lock);
 
   g_ptr_array_unref (self->plugin_descriptors);
 
@@ -77,6 +77,7 @@
 #include "utils/gtk.h"
 #include "utils/io.h"
 #include "utils/objects.h"
+#include "utils/schema_binary.h"
 #include "utils/string.h"
 #include "utils/ui.h"
 #include "zrythm_app.h"
@@ -855,18 +856,20 @@ project_create_default (
 }
 
 /**
- * Returns the YAML representation of the saved
+ * Returns the decompressed contents of the saved
  * project file.
  *
  * To be free'd with free().
  *
  * @param backup Whether to use the project file
  *   from the most recent backup.
+ * @param[out] size Size of the returned data.
  */
 char *
-project_get_existing_yaml (
+project_get_existing_data (
   Project * self,
-  bool      backup)
+  bool      backup,
+  size_t *  size)
 {
   /* get file contents */
   char * project_file_path =
@@ -874,7 +877,7 @@ project_get_existing_yaml (
       self, PROJECT_PATH_PROJECT_FILE, backup);
   g_return_val_if_fail (project_file_path, NULL);
   g_message (
-    "%s: getting YAML for project file %s",
+    "%s: getting data for project file %s",
     __func__, project_file_path);
 
   char * compressed_pj;
@@ -899,12 +902,12 @@ project_get_existing_yaml (
   /* decompress */
   g_message (
     "%s: decompressing project...", __func__);
-  char * yaml = NULL;
-  size_t yaml_size;
+  char * data = NULL;
+  size_t data_size;
   err = NULL;
   bool ret =
     project_decompress (
-      &yaml, &yaml_size,
+      &data, &data_size,
       PROJECT_DECOMPRESS_DATA,
       compressed_pj, compressed_pj_size,
       PROJECT_DECOMPRESS_DATA, &err);
@@ -917,13 +920,156 @@ project_get_existing_yaml (
       return NULL;
     }
 
-  /* make string null-terminated */
-  yaml =
+  /* make string null-terminated (in case of
+   * YAML) */
+  data =
     g_realloc (
-      yaml, yaml_size + sizeof (char));
-  yaml[yaml_size] = '\0';
+      data, data_size + sizeof (char));
+  data[data_size] = '\0';
+  *size = data_size;
 
-  return yaml;
+  return data;
+}
+
+/**
+ * Returns the format of the given (decompressed)
+ * project data.
+ */
+ProjectFileFormat
+project_get_data_format (
+  const char * data,
+  size_t       size)
+{
+  return
+    schema_binary_is_binary (data, size)
+    ? PROJECT_FILE_FORMAT_BINARY
+    : PROJECT_FILE_FORMAT_YAML;
+}
+
+/**
+ * Returns the format new project files are saved
+ * in.
+ */
+ProjectFileFormat
+project_get_save_format (void)
+{
+  if (ZRYTHM_TESTING)
+    return PROJECT_FILE_FORMAT_BINARY;
+
+  return
+    (ProjectFileFormat)
+    g_settings_get_enum (
+      S_P_PROJECTS_GENERAL, "file-format");
+}
+
+/**
+ * Returns the file extension (without the dot)
+ * for data in the given format.
+ */
+const char *
+project_file_format_get_extension (
+  ProjectFileFormat format)
+{
+  switch (format)
+    {
+    case PROJECT_FILE_FORMAT_BINARY:
+      return "bin";
+    case PROJECT_FILE_FORMAT_YAML:
+      return "yaml";
+    }
+
+  g_return_val_if_reached (NULL);
+}
+
+/**
+ * Serializes the given project (without
+ * compression).
+ *
+ * The undo history is not included, since it is
+ * saved separately.
+ *
+ * To be free'd with g_free().
+ *
+ * @param[out] size Size of the returned data.
+ *
+ * @return The serialized project, or NULL if
+ *   failed.
+ */
+char *
+project_serialize (
+  Project *         self,
+  ProjectFileFormat format,
+  size_t *          size)
+{
+  /* the undo history is saved in its own file */
+  UndoManager * undo_manager = self->undo_manager;
+  self->undo_manager = NULL;
+
+  char * data = NULL;
+  switch (format)
+    {
+    case PROJECT_FILE_FORMAT_BINARY:
+      data =
+        schema_binary_serialize (
+          self, &project_schema, size);
+      break;
+    case PROJECT_FILE_FORMAT_YAML:
+      data = yaml_serialize (self, &project_schema);
+      if (data)
+        *size = strlen (data) * sizeof (char);
+      break;
+    }
+
+  self->undo_manager = undo_manager;
+
+  return data;
+}
+
+/**
+ * Deserializes a project from the given
+ * (decompressed) data, detecting its format.
+ *
+ * @return The project, or NULL if failed.
+ */
+Project *
+project_deserialize (
+  const char * data,
+  size_t       size,
+  GError **    error)
+{
+  if (project_get_data_format (data, size)
+        == PROJECT_FILE_FORMAT_BINARY)
+    {
+      GError * err = NULL;
+      Project * self =
+        (Project *)
+        schema_binary_deserialize (
+          data, size, &project_schema, &err);
+      if (!self)
+        {
+          PROPAGATE_PREFIXED_ERROR (
+            error, err, "%s",
+            _("Failed to deserialize binary "
+            "project"));
+        }
+      return self;
+    }
+
+  /* YAML parsing requires a null-terminated
+   * string */
+  char * yaml = g_strndup (data, size);
+  Project * self =
+    (Project *)
+    yaml_deserialize (yaml, &project_schema);
+  g_free (yaml);
+  if (!self)
+    {
+      g_set_error_literal (
+        error, Z_PROJECT_ERROR,
+        Z_PROJECT_ERROR_FAILED,
+        _("Failed to deserialize YAML project"));
+    }
+  return self;
 }
 
 /**
@@ -1010,23 +1156,26 @@ load (
   bool use_backup = PROJECT->backup_dir != NULL;
   PROJECT->loading_from_backup = use_backup;
 
-  char * yaml =
-    project_get_existing_yaml (PROJECT, use_backup);
-  g_return_val_if_fail (yaml, -1);
+  size_t data_size;
+  char * data =
+    project_get_existing_data (
+      PROJECT, use_backup, &data_size);
+  g_return_val_if_fail (data, -1);
 
-  g_message ("project from yaml...");
+  g_message ("deserializing project...");
   gint64 time_before = g_get_monotonic_time ();
+  GError * err = NULL;
   Project * self =
-    (Project *)
-    yaml_deserialize (yaml, &project_schema);
+    project_deserialize (data, data_size, &err);
   gint64 time_after = g_get_monotonic_time ();
   g_message (
     "time to deserialize: %ldms",
     (long) (time_after - time_before) / 1000);
-  free (yaml);
+  free (data);
   if (!self)
     {
-      g_warning ("Failed to load project");
+      HANDLE_ERROR (
+        err, "%s", _("Failed to load project"));
       return -1;
     }
   self->backup_dir =
@@ -1148,15 +1297,41 @@ load (
 
   if (self->undo_manager)
     {
+      /* older projects have the undo history
+       * embedded in the project file */
       undo_manager_init_loaded (self->undo_manager);
     }
   else
     {
       self->undo_manager = undo_manager_new ();
+
+      if (!is_template)
+        {
+          char * undo_history_path =
+            project_get_path (
+              self, PROJECT_PATH_UNDO_HISTORY_FILE,
+              use_backup);
+          err = NULL;
+          bool ret =
+            undo_manager_load_history (
+              self->undo_manager,
+              undo_history_path, &err);
+          g_free (undo_history_path);
+          if (!ret)
+            {
+              HANDLE_ERROR (
+                err, "%s",
+                _("Failed to load undo history"));
+            }
+        }
     }
 
   clip_editor_init_loaded (self->clip_editor);
   timeline_init_loaded (self->timeline);
+
+  /* plugins are instantiated in the background
+   * once everything else is loaded */
+  self->plugin_loader = plugin_loader_new ();
   tracklist_init_loaded (
     self->tracklist, self, NULL);
 
@@ -1235,7 +1410,6 @@ load (
     g_ptr_array_unref, ports);
 
   self->loaded = true;
-  self->loading_from_backup = false;
 
   g_message ("project loaded");
 
@@ -1247,6 +1421,14 @@ load (
 
   engine_set_run (self->audio_engine, true);
 
+  /* start instantiating plugins (this also unsets
+   * loading_from_backup when done) */
+  plugin_loader_start (self->plugin_loader);
+  if (ZRYTHM_TESTING)
+    {
+      plugin_loader_wait (self->plugin_loader);
+    }
+
   return 0;
 }
 
@@ -1360,6 +1542,13 @@ project_autosave_cb (
       || !PROJECT->dir || !PROJECT->datetime_str)
     return G_SOURCE_CONTINUE;
 
+  /* don't block while plugins are still being
+   * instantiated */
+  if (PROJECT->plugin_loader
+      && !plugin_loader_is_finished (
+            PROJECT->plugin_loader))
+    return G_SOURCE_CONTINUE;
+
   unsigned int autosave_interval_mins =
     g_settings_get_uint (
       S_P_PROJECTS_GENERAL, "autosave-interval");
@@ -1511,6 +1700,10 @@ project_get_path (
         g_build_filename (
           dir, PROJECT_FILE, NULL);
       break;
+    case PROJECT_PATH_UNDO_HISTORY_FILE:
+      return
+        g_build_filename (
+          dir, PROJECT_UNDO_HISTORY_FILE, NULL);
     default:
       g_return_val_if_reached (NULL);
     }
@@ -1564,6 +1757,7 @@ project_save_data_free (
   ProjectSaveData * self)
 {
   g_free_and_null (self->project_file_path);
+  g_free_and_null (self->undo_history_path);
   object_free_w_func_and_null (
     project_free, self->project);
 
@@ -1577,22 +1771,42 @@ static void *
 serialize_project_thread (
   ProjectSaveData * data)
 {
-  char * compressed_yaml;
+  char * compressed_data;
   size_t compressed_size;
   bool ret;
 
-  /* generate yaml */
-  g_message ("serializing project to yaml...");
+  /* write the undo history (the undo manager is
+   * not cloned with the rest of the project, but
+   * the action semaphore is held until this
+   * thread finishes) */
+  GError * history_err = NULL;
+  if (!undo_manager_save_history (
+         UNDO_MANAGER, data->undo_history_path,
+         &history_err))
+    {
+      g_warning (
+        "%s: Failed to save undo history: %s",
+        __func__, history_err->message);
+      g_error_free (history_err);
+    }
+
+  /* serialize */
+  g_message (
+    "serializing project to %s...",
+    project_file_format_strings[
+      data->format].str);
   GError *err = NULL;
   gint64 time_before = g_get_monotonic_time ();
-  char * yaml =
-    yaml_serialize (
-      data->project, &project_schema);
+  size_t serialized_size = 0;
+  char * serialized =
+    project_serialize (
+      data->project, data->format,
+      &serialized_size);
   gint64 time_after = g_get_monotonic_time ();
   g_message (
     "time to serialize: %ldms",
     (long) (time_after - time_before) / 1000);
-  if (!yaml)
+  if (!serialized)
     {
       g_critical ("Failed to serialize project");
       data->has_error = true;
@@ -1603,11 +1817,11 @@ serialize_project_thread (
   err = NULL;
   ret =
     project_compress (
-      &compressed_yaml, &compressed_size,
+      &compressed_data, &compressed_size,
       PROJECT_COMPRESS_DATA,
-      yaml, strlen (yaml) * sizeof (char),
+      serialized, serialized_size,
       PROJECT_COMPRESS_DATA, &err);
-  g_free (yaml);
+  g_free (serialized);
   if (!ret)
     {
       HANDLE_ERROR (
@@ -1622,9 +1836,9 @@ serialize_project_thread (
     "%s: saving project file at %s...",
     __func__, data->project_file_path);
   g_file_set_contents (
-    data->project_file_path, compressed_yaml,
+    data->project_file_path, compressed_data,
     (gssize) compressed_size, &err);
-  free (compressed_yaml);
+  free (compressed_data);
   if (err != NULL)
     {
       g_critical (
@@ -1707,6 +1921,13 @@ project_save (
   const bool   show_notification,
   const bool   async)
 {
+  /* plugin states can only be saved after the
+   * plugins are instantiated */
+  if (self->plugin_loader)
+    {
+      plugin_loader_wait (self->plugin_loader);
+    }
+
   /* pause engine */
   EngineState state;
   bool engine_paused = false;
@@ -1940,8 +2161,13 @@ project_save (
   data->project_file_path =
     project_get_path (
       self, PROJECT_PATH_PROJECT_FILE, is_backup);
+  data->undo_history_path =
+    project_get_path (
+      self, PROJECT_PATH_UNDO_HISTORY_FILE,
+      is_backup);
   data->show_notification = show_notification;
   data->is_backup = is_backup;
+  data->format = project_get_save_format ();
   data->project = project_clone (PROJECT);
   g_return_val_if_fail (data->project, -1);
   g_return_val_if_fail (
@@ -2092,8 +2318,10 @@ project_clone (
       src->port_connections_manager);
   self->midi_mappings =
     midi_mappings_clone (src->midi_mappings);
-  self->undo_manager =
-    undo_manager_clone (src->undo_manager);
+
+  /* the undo history is saved separately by
+   * project_save() */
+  self->undo_manager = NULL;
 
   g_message ("finished cloning project");
 
@@ -2151,6 +2379,11 @@ project_free (Project * self)
    * track */
   self->clip_editor->has_region = false;
 
+  /* stop instantiating plugins before freeing
+   * them */
+  object_free_w_func_and_null (
+    plugin_loader_free, self->plugin_loader);
+
   object_free_w_func_and_null (
     undo_manager_free, self->undo_manager);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2020-2021 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2020-2022 Alexandros Theodotou <alex at zrythm dot org>
  *
  * This file is part of Zrythm
  *
@@ -27,9 +27,57 @@
 
 #include <gtk/gtk.h>
 
-#ifdef HAVE_LSP_DSP
-#include <lsp-plug.in/dsp/dsp.h>
-#endif
+static const DspKernels * kernels =
+  &dsp_kernels_scalar;
+static DspIsa cur_isa = DSP_ISA_SCALAR;
+
+/**
+ * Selects the kernels to use.
+ *
+ * Falls back to the scalar kernels if the
+ * instruction set is not supported.
+ *
+ * Must not be called while the engine is
+ * processing.
+ *
+ * @return Whether the instruction set is
+ *   supported.
+ */
+bool
+dsp_set_isa (
+  DspIsa isa)
+{
+  const DspKernels * new_kernels =
+    dsp_kernels_get (isa);
+  if (!new_kernels)
+    {
+      g_message (
+        "%s DSP kernels not supported, using "
+        "scalar kernels",
+        dsp_isa_to_string (isa));
+      kernels = &dsp_kernels_scalar;
+      cur_isa = DSP_ISA_SCALAR;
+      return false;
+    }
+
+  g_message (
+    "using %s DSP kernels",
+    dsp_isa_to_string (isa));
+  kernels = new_kernels;
+  cur_isa = isa;
+
+  return true;
+}
+
+/**
+ * Returns the instruction set of the kernels in
+ * use.
+ */
+DspIsa
+dsp_get_isa (void)
+{
+  return cur_isa;
+}
 
 /**
  * Fill the buffer with the given value.
@@ -40,21 +88,53 @@ dsp_fill (
   float   val,
   size_t  size)
 {
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      lsp_dsp_fill (buf, val, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          buf[i] = val;
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
+  kernels->fill (buf, val, size);
+}
+
+/**
+ * Clamp the buffer to min/max.
+ */
+void
+dsp_limit1 (
+  float * buf,
+  float   minf,
+  float   maxf,
+  size_t  size)
+{
+  kernels->limit1 (buf, minf, maxf, size);
+}
+
+/**
+ * Gets the maximum absolute value of the buffer (as
+ * amplitude).
+ */
+float
+dsp_abs_max (
+  float * buf,
+  size_t  size)
+{
+  return MAX (1e-20f, kernels->abs_max (buf, size));
+}
+
+/**
+ * Gets the absolute max of the buffer.
+ *
+ * @return Whether the peak changed.
+ */
+bool
+dsp_abs_max_with_existing_peak (
+  float * buf,
+  float * cur_peak,
+  size_t  size)
+{
+  float new_peak =
+    MAX (*cur_peak, kernels->abs_max (buf, size));
+
+  bool changed =
+    !math_floats_equal (new_peak, *cur_peak);
+  *cur_peak = new_peak;
+
+  return changed;
 }
 
 /**
@@ -65,27 +145,7 @@ dsp_min (
   float * buf,
   size_t  size)
 {
-  float min = 1000.f;
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      min = lsp_dsp_min (buf, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          if (buf[i] < min)
-            {
-              min = buf[i];
-            }
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
-
-  return min;
+  return MIN (1000.f, kernels->min (buf, size));
 }
 
 /**
@@ -96,27 +156,7 @@ dsp_max (
   float * buf,
   size_t  size)
 {
-  float max = - 1000.f;
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      max = lsp_dsp_max (buf, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          if (buf[i] > max)
-            {
-              max = buf[i];
-            }
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
-
-  return max;
+  return MAX (-1000.f, kernels->max (buf, size));
 }
 
 /**
@@ -128,21 +168,7 @@ dsp_copy (
   const float * src,
   size_t        size)
 {
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      lsp_dsp_copy (dest, src, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = src[i];
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
+  kernels->copy (dest, src, size);
 }
 
 /**
@@ -154,21 +180,7 @@ dsp_add2 (
   const float * src,
   size_t        size)
 {
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      lsp_dsp_add2 (dest, src, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = dest[i] + src[i];
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
+  kernels->add2 (dest, src, size);
 }
 
 /**
@@ -180,21 +192,51 @@ dsp_mul_k2 (
   float   k,
   size_t  size)
 {
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      lsp_dsp_mul_k2 (dest, k, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] *= k;
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
+  kernels->mul_k2 (dest, k, size);
+}
+
+/**
+ * Calculate dest[i] = dest[i] * src[i].
+ */
+void
+dsp_mul2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  kernels->mul2 (dest, src, size);
+}
+
+/**
+ * Scale the two channels:
+ * l[i] = l[i] * kl, r[i] = r[i] * kr.
+ *
+ * Used to apply pan/balance and gain to stereo
+ * signals in one pass.
+ */
+void
+dsp_mul_k2_stereo (
+  float * l,
+  float * r,
+  float   kl,
+  float   kr,
+  size_t  size)
+{
+  kernels->mul_k2_stereo (l, r, kl, kr, size);
+}
+
+/**
+ * Calculate dest[i] = dest[i] * k1 + src[i] * k2.
+ */
+void
+dsp_mix2 (
+  float *       dest,
+  const float * src,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  kernels->mix2 (dest, src, k1, k2, size);
 }
 
 /**
@@ -210,57 +252,56 @@ dsp_mix_add2 (
   float         k2,
   size_t        size)
 {
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
-    {
-      lsp_dsp_mix_add2 (
-        dest, src1, src2, k1, k2, size);
-    }
-  else
-    {
-#endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] =
-            dest[i] + src1[i] * k1 + src2[i] * k2;
-        }
-#ifdef HAVE_LSP_DSP
-    }
-#endif
+  kernels->mix_add2 (
+    dest, src1, src2, k1, k2, size);
+}
+
+/**
+ * Multiplies the buffer by a gain ramping
+ * linearly from @p start_gain towards
+ * @p end_gain.
+ *
+ * @p end_gain is the gain of the sample after the
+ * last one, so consecutive ramps join smoothly.
+ */
+void
+dsp_gain_ramp (
+  float * dest,
+  float   start_gain,
+  float   end_gain,
+  size_t  size)
+{
+  if (size == 0)
+    return;
+
+  float step =
+    (end_gain - start_gain) / (float) size;
+  kernels->ramp_mul (
+    dest, start_gain, step, size);
 }
 
 /**
  * Calculate linear fade in by multiplying from
  * 0 to 1.
  */
-NONNULL
 void
 dsp_linear_fade_in (
   float * dest,
   size_t  size)
 {
-  for (size_t i = 0; i < size; i++)
-    {
-      float k = (float) i / (float) size;
-      dest[i] *= k;
-    }
+  dsp_gain_ramp (dest, 0.f, 1.f, size);
 }
 
 /**
  * Calculate linear fade in by multiplying from
  * 1 to 0.
  */
-NONNULL
 void
 dsp_linear_fade_out (
   float * dest,
   size_t  size)
 {
-  for (size_t i = 0; i < size; i++)
-    {
-      float k = (float) (size - i) / (float) size;
-      dest[i] *= k;
-    }
+  dsp_gain_ramp (dest, 1.f, 0.f, size);
 }
 
 /**
@@ -0,0 +1,719 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * The vectorized kernels are generated from a
+ * single definition (DEFINE_KERNELS) for each
+ * instruction set, using the V_* macros defined
+ * before each instantiation. The x86 kernels are
+ * compiled with target attributes so that the
+ * build does not need to require any instruction
+ * set beyond the baseline.
+ */
+
+#include "zrythm-config.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+
+#include "utils/dsp_kernels.h"
+
+#include <glib.h>
+
+#if defined(__GNUC__) \
+  && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__)
+#define HAVE_NEON_KERNELS 1
+#include <arm_neon.h>
+#endif
+
+static const char * dsp_isa_strings[] = {
+  "scalar",
+  "SSE2",
+  "AVX2",
+  "AVX-512",
+  "NEON",
+};
+
+/* ---- scalar ---- */
+
+static void
+scalar_fill (
+  float * buf,
+  float   val,
+  size_t  size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+static void
+scalar_limit1 (
+  float * buf,
+  float   minf,
+  float   maxf,
+  size_t  size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = CLAMP (buf[i], minf, maxf);
+    }
+}
+
+static void
+scalar_copy (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = src[i];
+    }
+}
+
+static void
+scalar_mul_k2 (
+  float * dest,
+  float   k,
+  size_t  size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+static void
+scalar_mul2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= src[i];
+    }
+}
+
+static float
+scalar_abs_max (
+  const float * buf,
+  size_t        size)
+{
+  float ret = 0.f;
+  for (size_t i = 0; i < size; i++)
+    {
+      float val = fabsf (buf[i]);
+      if (val > ret)
+        {
+          ret = val;
+        }
+    }
+  return ret;
+}
+
+static float
+scalar_min (
+  const float * buf,
+  size_t        size)
+{
+  float ret = FLT_MAX;
+  for (size_t i = 0; i < size; i++)
+    {
+      if (buf[i] < ret)
+        {
+          ret = buf[i];
+        }
+    }
+  return ret;
+}
+
+static float
+scalar_max (
+  const float * buf,
+  size_t        size)
+{
+  float ret = -FLT_MAX;
+  for (size_t i = 0; i < size; i++)
+    {
+      if (buf[i] > ret)
+        {
+          ret = buf[i];
+        }
+    }
+  return ret;
+}
+
+static void
+scalar_add2 (
+  float *       dest,
+  const float * src,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+static void
+scalar_mix2 (
+  float *       dest,
+  const float * src,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+static void
+scalar_mix_add2 (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] =
+        dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+static void
+scalar_ramp_mul (
+  float * dest,
+  float   start,
+  float   step,
+  size_t  size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= start + step * (float) i;
+    }
+}
+
+static void
+scalar_mul_k2_stereo (
+  float * l,
+  float * r,
+  float   kl,
+  float   kr,
+  size_t  size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      l[i] *= kl;
+      r[i] *= kr;
+    }
+}
+
+const DspKernels dsp_kernels_scalar = {
+  .fill = scalar_fill,
+  .limit1 = scalar_limit1,
+  .copy = scalar_copy,
+  .mul_k2 = scalar_mul_k2,
+  .mul2 = scalar_mul2,
+  .abs_max = scalar_abs_max,
+  .min = scalar_min,
+  .max = scalar_max,
+  .add2 = scalar_add2,
+  .mix2 = scalar_mix2,
+  .mix_add2 = scalar_mix_add2,
+  .ramp_mul = scalar_ramp_mul,
+  .mul_k2_stereo = scalar_mul_k2_stereo,
+};
+
+/* ---- vectorized ---- */
+
+/**
+ * Defines the kernels and the kernel table
+ * for the given instruction set.
+ *
+ * Requires the following macros:
+ * - V_ATTR: function attributes
+ * - V_TYPE: vector type
+ * - V_WIDTH: number of floats in a vector
+ * - V_LOAD(ptr), V_STORE(ptr, v), V_SET1(f)
+ * - V_ADD(a, b), V_MUL(a, b), V_MIN(a, b),
+ *   V_MAX(a, b), V_ABS(a)
+ *
+ * The remaining elements that don't fill a
+ * vector are processed with the scalar kernels.
+ */
+#define DEFINE_KERNELS(isa) \
+  V_ATTR static void \
+  isa##_fill ( \
+    float * buf, float val, size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE v = V_SET1 (val); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE (&buf[i], v); \
+      } \
+    scalar_fill (&buf[i], val, size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_limit1 ( \
+    float * buf, float minf, float maxf, \
+    size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE vmin = V_SET1 (minf); \
+    V_TYPE vmax = V_SET1 (maxf); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_TYPE v = V_LOAD (&buf[i]); \
+        V_STORE ( \
+          &buf[i], \
+          V_MIN (V_MAX (v, vmin), vmax)); \
+      } \
+    scalar_limit1 ( \
+      &buf[i], minf, maxf, size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_copy ( \
+    float * dest, const float * src, \
+    size_t size) \
+  { \
+    size_t i = 0; \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE (&dest[i], V_LOAD (&src[i])); \
+      } \
+    scalar_copy (&dest[i], &src[i], size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_mul_k2 ( \
+    float * dest, float k, size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE vk = V_SET1 (k); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE ( \
+          &dest[i], \
+          V_MUL (V_LOAD (&dest[i]), vk)); \
+      } \
+    scalar_mul_k2 (&dest[i], k, size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_mul2 ( \
+    float * dest, const float * src, \
+    size_t size) \
+  { \
+    size_t i = 0; \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE ( \
+          &dest[i], \
+          V_MUL ( \
+            V_LOAD (&dest[i]), \
+            V_LOAD (&src[i]))); \
+      } \
+    scalar_mul2 (&dest[i], &src[i], size - i); \
+  } \
+\
+  V_ATTR static float \
+  isa##_abs_max ( \
+    const float * buf, size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE acc = V_SET1 (0.f); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        acc = \
+          V_MAX (acc, V_ABS (V_LOAD (&buf[i]))); \
+      } \
+    float lanes[V_WIDTH]; \
+    V_STORE (lanes, acc); \
+    float ret = \
+      scalar_abs_max (lanes, V_WIDTH); \
+    return \
+      MAX ( \
+        ret, \
+        scalar_abs_max (&buf[i], size - i)); \
+  } \
+\
+  V_ATTR static float \
+  isa##_min ( \
+    const float * buf, size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE acc = V_SET1 (FLT_MAX); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        acc = V_MIN (acc, V_LOAD (&buf[i])); \
+      } \
+    float lanes[V_WIDTH]; \
+    V_STORE (lanes, acc); \
+    float ret = scalar_min (lanes, V_WIDTH); \
+    return \
+      MIN (ret, scalar_min (&buf[i], size - i)); \
+  } \
+\
+  V_ATTR static float \
+  isa##_max ( \
+    const float * buf, size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE acc = V_SET1 (-FLT_MAX); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        acc = V_MAX (acc, V_LOAD (&buf[i])); \
+      } \
+    float lanes[V_WIDTH]; \
+    V_STORE (lanes, acc); \
+    float ret = scalar_max (lanes, V_WIDTH); \
+    return \
+      MAX (ret, scalar_max (&buf[i], size - i)); \
+  } \
+\
+  V_ATTR static void \
+  isa##_add2 ( \
+    float * dest, const float * src, \
+    size_t size) \
+  { \
+    size_t i = 0; \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE ( \
+          &dest[i], \
+          V_ADD ( \
+            V_LOAD (&dest[i]), \
+            V_LOAD (&src[i]))); \
+      } \
+    scalar_add2 (&dest[i], &src[i], size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_mix2 ( \
+    float * dest, const float * src, float k1, \
+    float k2, size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE vk1 = V_SET1 (k1); \
+    V_TYPE vk2 = V_SET1 (k2); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE ( \
+          &dest[i], \
+          V_ADD ( \
+            V_MUL (V_LOAD (&dest[i]), vk1), \
+            V_MUL (V_LOAD (&src[i]), vk2))); \
+      } \
+    scalar_mix2 ( \
+      &dest[i], &src[i], k1, k2, size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_mix_add2 ( \
+    float * dest, const float * src1, \
+    const float * src2, float k1, float k2, \
+    size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE vk1 = V_SET1 (k1); \
+    V_TYPE vk2 = V_SET1 (k2); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE ( \
+          &dest[i], \
+          V_ADD ( \
+            V_LOAD (&dest[i]), \
+            V_ADD ( \
+              V_MUL (V_LOAD (&src1[i]), vk1), \
+              V_MUL (V_LOAD (&src2[i]), vk2)))); \
+      } \
+    scalar_mix_add2 ( \
+      &dest[i], &src1[i], &src2[i], k1, k2, \
+      size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_ramp_mul ( \
+    float * dest, float start, float step, \
+    size_t size) \
+  { \
+    size_t i = 0; \
+    float lane_offsets[V_WIDTH]; \
+    for (int j = 0; j < V_WIDTH; j++) \
+      { \
+        lane_offsets[j] = (float) j; \
+      } \
+    V_TYPE voffsets = V_LOAD (lane_offsets); \
+    V_TYPE vstart = V_SET1 (start); \
+    V_TYPE vstep = V_SET1 (step); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_TYPE vi = \
+          V_ADD (V_SET1 ((float) i), voffsets); \
+        V_TYPE vgain = \
+          V_ADD (vstart, V_MUL (vstep, vi)); \
+        V_STORE ( \
+          &dest[i], \
+          V_MUL (V_LOAD (&dest[i]), vgain)); \
+      } \
+    scalar_ramp_mul ( \
+      &dest[i], start + step * (float) i, step, \
+      size - i); \
+  } \
+\
+  V_ATTR static void \
+  isa##_mul_k2_stereo ( \
+    float * l, float * r, float kl, float kr, \
+    size_t size) \
+  { \
+    size_t i = 0; \
+    V_TYPE vkl = V_SET1 (kl); \
+    V_TYPE vkr = V_SET1 (kr); \
+    for (; i + V_WIDTH <= size; i += V_WIDTH) \
+      { \
+        V_STORE ( \
+          &l[i], V_MUL (V_LOAD (&l[i]), vkl)); \
+        V_STORE ( \
+          &r[i], V_MUL (V_LOAD (&r[i]), vkr)); \
+      } \
+    scalar_mul_k2_stereo ( \
+      &l[i], &r[i], kl, kr, size - i); \
+  } \
+\
+  static const DspKernels dsp_kernels_##isa = { \
+    .fill = isa##_fill, \
+    .limit1 = isa##_limit1, \
+    .copy = isa##_copy, \
+    .mul_k2 = isa##_mul_k2, \
+    .mul2 = isa##_mul2, \
+    .abs_max = isa##_abs_max, \
+    .min = isa##_min, \
+    .max = isa##_max, \
+    .add2 = isa##_add2, \
+    .mix2 = isa##_mix2, \
+    .mix_add2 = isa##_mix_add2, \
+    .ramp_mul = isa##_ramp_mul, \
+    .mul_k2_stereo = isa##_mul_k2_stereo, \
+  };
+
+#ifdef HAVE_X86_KERNELS
+
+/* SSE2 */
+#define V_ATTR \
+  __attribute__ ((target ("sse2")))
+#define V_TYPE __m128
+#define V_WIDTH 4
+#define V_LOAD(ptr) _mm_loadu_ps (ptr)
+#define V_STORE(ptr, v) _mm_storeu_ps (ptr, v)
+#define V_SET1(f) _mm_set1_ps (f)
+#define V_ADD(a, b) _mm_add_ps (a, b)
+#define V_MUL(a, b) _mm_mul_ps (a, b)
+#define V_MIN(a, b) _mm_min_ps (a, b)
+#define V_MAX(a, b) _mm_max_ps (a, b)
+#define V_ABS(a) \
+  _mm_andnot_ps (_mm_set1_ps (-0.f), a)
+DEFINE_KERNELS (sse2)
+#undef V_ATTR
+#undef V_TYPE
+#undef V_WIDTH
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET1
+#undef V_ADD
+#undef V_MUL
+#undef V_MIN
+#undef V_MAX
+#undef V_ABS
+
+/* AVX2 */
+#define V_ATTR \
+  __attribute__ ((target ("avx2")))
+#define V_TYPE __m256
+#define V_WIDTH 8
+#define V_LOAD(ptr) _mm256_loadu_ps (ptr)
+#define V_STORE(ptr, v) _mm256_storeu_ps (ptr, v)
+#define V_SET1(f) _mm256_set1_ps (f)
+#define V_ADD(a, b) _mm256_add_ps (a, b)
+#define V_MUL(a, b) _mm256_mul_ps (a, b)
+#define V_MIN(a, b) _mm256_min_ps (a, b)
+#define V_MAX(a, b) _mm256_max_ps (a, b)
+#define V_ABS(a) \
+  _mm256_andnot_ps (_mm256_set1_ps (-0.f), a)
+DEFINE_KERNELS (avx2)
+#undef V_ATTR
+#undef V_TYPE
+#undef V_WIDTH
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET1
+#undef V_ADD
+#undef V_MUL
+#undef V_MIN
+#undef V_MAX
+#undef V_ABS
+
+/* AVX-512 */
+#define V_ATTR \
+  __attribute__ ((target ("avx512f")))
+#define V_TYPE __m512
+#define V_WIDTH 16
+#define V_LOAD(ptr) _mm512_loadu_ps (ptr)
+#define V_STORE(ptr, v) _mm512_storeu_ps (ptr, v)
+#define V_SET1(f) _mm512_set1_ps (f)
+#define V_ADD(a, b) _mm512_add_ps (a, b)
+#define V_MUL(a, b) _mm512_mul_ps (a, b)
+#define V_MIN(a, b) _mm512_min_ps (a, b)
+#define V_MAX(a, b) _mm512_max_ps (a, b)
+#define V_ABS(a) _mm512_abs_ps (a)
+DEFINE_KERNELS (avx512)
+#undef V_ATTR
+#undef V_TYPE
+#undef V_WIDTH
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET1
+#undef V_ADD
+#undef V_MUL
+#undef V_MIN
+#undef V_MAX
+#undef V_ABS
+
+#endif /* HAVE_X86_KERNELS */
+
+#ifdef HAVE_NEON_KERNELS
+
+/* NEON (always available on aarch64) */
+#define V_ATTR
+#define V_TYPE float32x4_t
+#define V_WIDTH 4
+#define V_LOAD(ptr) vld1q_f32 (ptr)
+#define V_STORE(ptr, v) vst1q_f32 (ptr, v)
+#define V_SET1(f) vdupq_n_f32 (f)
+#define V_ADD(a, b) vaddq_f32 (a, b)
+#define V_MUL(a, b) vmulq_f32 (a, b)
+#define V_MIN(a, b) vminq_f32 (a, b)
+#define V_MAX(a, b) vmaxq_f32 (a, b)
+#define V_ABS(a) vabsq_f32 (a)
+DEFINE_KERNELS (neon)
+#undef V_ATTR
+#undef V_TYPE
+#undef V_WIDTH
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET1
+#undef V_ADD
+#undef V_MUL
+#undef V_MIN
+#undef V_MAX
+#undef V_ABS
+
+#endif /* HAVE_NEON_KERNELS */
+
+/**
+ * Returns the kernels for the given instruction
+ * set, or NULL if it is not supported by the
+ * build or by the CPU.
+ */
+const DspKernels *
+dsp_kernels_get (
+  DspIsa isa)
+{
+#ifdef HAVE_X86_KERNELS
+  __builtin_cpu_init ();
+#endif
+
+  switch (isa)
+    {
+    case DSP_ISA_SCALAR:
+      return &dsp_kernels_scalar;
+#ifdef HAVE_X86_KERNELS
+    case DSP_ISA_SSE2:
+      if (__builtin_cpu_supports ("sse2"))
+        return &dsp_kernels_sse2;
+      break;
+    case DSP_ISA_AVX2:
+      if (__builtin_cpu_supports ("avx2"))
+        return &dsp_kernels_avx2;
+      break;
+    case DSP_ISA_AVX512:
+      if (__builtin_cpu_supports ("avx512f"))
+        return &dsp_kernels_avx512;
+      break;
+#endif
+#ifdef HAVE_NEON_KERNELS
+    case DSP_ISA_NEON:
+      return &dsp_kernels_neon;
+#endif
+    default:
+      break;
+    }
+
+  return NULL;
+}
+
+/**
+ * Returns the fastest instruction set supported
+ * by the CPU.
+ */
+DspIsa
+dsp_kernels_get_best_isa (void)
+{
+  static const DspIsa isas[] = {
+    DSP_ISA_AVX512,
+    DSP_ISA_AVX2,
+    DSP_ISA_NEON,
+    DSP_ISA_SSE2,
+  };
+  for (size_t i = 0; i < G_N_ELEMENTS (isas);
+       i++)
+    {
+      if (dsp_kernels_get (isas[i]))
+        return isas[i];
+    }
+
+  return DSP_ISA_SCALAR;
+}
+
+const char *
+dsp_isa_to_string (
+  DspIsa isa)
+{
+  g_return_val_if_fail (
+    isa < NUM_DSP_ISAS, NULL);
+  return dsp_isa_strings[isa];
+}
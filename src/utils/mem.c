@@ -22,6 +22,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WOE32
+#include <malloc.h>
+#endif
+
 #include <gtk/gtk.h>
 
 /**
@@ -43,3 +47,46 @@ realloc_zero (
     }
   return new_buf;
 }
+
+/**
+ * Allocates zeroed memory aligned to the given
+ * alignment.
+ *
+ * @param alignment Alignment in bytes (a power of
+ *   2 and a multiple of sizeof (void *)).
+ *
+ * @return The memory, to be free'd with
+ *   aligned_free(), or NULL on failure.
+ */
+void *
+aligned_malloc_zero (
+  size_t alignment,
+  size_t size)
+{
+  void * buf = NULL;
+#ifdef _WOE32
+  buf = _aligned_malloc (size, alignment);
+#else
+  if (posix_memalign (&buf, alignment, size) != 0)
+    buf = NULL;
+#endif
+  if (buf)
+    memset (buf, 0, size);
+
+  return buf;
+}
+
+/**
+ * Frees memory allocated with
+ * aligned_malloc_zero().
+ */
+void
+aligned_free (
+  void * buf)
+{
+#ifdef _WOE32
+  _aligned_free (buf);
+#else
+  free (buf);
+#endif
+}
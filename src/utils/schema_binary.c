@@ -0,0 +1,1194 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/schema_binary.h"
+#include "utils/yaml.h"
+
+#include <glib/gi18n.h>
+
+typedef enum
+{
+  Z_UTILS_SCHEMA_BINARY_ERROR_INVALID,
+} ZUtilsSchemaBinaryError;
+
+#define Z_UTILS_SCHEMA_BINARY_ERROR \
+  z_utils_schema_binary_error_quark ()
+GQuark z_utils_schema_binary_error_quark (void);
+G_DEFINE_QUARK (
+  z-utils-schema-binary-error-quark, z_utils_schema_binary_error)
+
+/**
+ * Tag preceding each value.
+ */
+typedef enum SchemaBinaryTag
+{
+  /** Absent/NULL value. */
+  TAG_NULL,
+
+  /** Zigzag-encoded varint. */
+  TAG_INT,
+
+  /** Varint. */
+  TAG_UINT,
+
+  /** 4-byte little-endian float. */
+  TAG_FLOAT,
+
+  /** 8-byte little-endian double. */
+  TAG_DOUBLE,
+
+  /** Varint length followed by the bytes. */
+  TAG_STRING,
+
+  /** Varint index of the enum string in the key
+   * table. */
+  TAG_ENUM,
+
+  /** (varint key index + 1, value) pairs, ending
+   * with a 0. */
+  TAG_MAPPING,
+
+  /** Varint count followed by the values. */
+  TAG_SEQUENCE,
+} SchemaBinaryTag;
+
+typedef struct Writer
+{
+  /** Document body. */
+  GByteArray * buf;
+
+  /** Key string -> index + 1. */
+  GHashTable * key_indices;
+
+  /** Keys in order of appearance. */
+  GPtrArray *  keys;
+} Writer;
+
+typedef struct Reader
+{
+  const uint8_t * p;
+  const uint8_t * end;
+
+  /** Key table. */
+  GPtrArray *     keys;
+
+  /** Set on the first error. */
+  const char *    error;
+
+  /** Key of the missing mandatory field, if that
+   * was the error. */
+  const char *    missing_key;
+} Reader;
+
+static inline guint64
+zigzag_encode (
+  gint64 val)
+{
+  return
+    ((guint64) val << 1) ^ (guint64) (val >> 63);
+}
+
+static inline gint64
+zigzag_decode (
+  guint64 val)
+{
+  return
+    (gint64) (val >> 1) ^ -(gint64) (val & 1);
+}
+
+static gint64
+get_int (
+  const uint8_t * data,
+  uint32_t        size)
+{
+  switch (size)
+    {
+    case 1:
+      return *(const int8_t *) data;
+    case 2:
+      {
+        int16_t val;
+        memcpy (&val, data, sizeof (val));
+        return val;
+      }
+    case 4:
+      {
+        int32_t val;
+        memcpy (&val, data, sizeof (val));
+        return val;
+      }
+    case 8:
+      {
+        int64_t val;
+        memcpy (&val, data, sizeof (val));
+        return val;
+      }
+    default:
+      break;
+    }
+
+  g_return_val_if_reached (0);
+}
+
+static guint64
+get_uint (
+  const uint8_t * data,
+  uint32_t        size)
+{
+  switch (size)
+    {
+    case 1:
+      return *data;
+    case 2:
+      {
+        uint16_t val;
+        memcpy (&val, data, sizeof (val));
+        return val;
+      }
+    case 4:
+      {
+        uint32_t val;
+        memcpy (&val, data, sizeof (val));
+        return val;
+      }
+    case 8:
+      {
+        uint64_t val;
+        memcpy (&val, data, sizeof (val));
+        return val;
+      }
+    default:
+      break;
+    }
+
+  g_return_val_if_reached (0);
+}
+
+static void
+set_int (
+  uint8_t * data,
+  uint32_t  size,
+  gint64    val)
+{
+  switch (size)
+    {
+    case 1:
+      *(int8_t *) data = (int8_t) val;
+      break;
+    case 2:
+      {
+        int16_t tmp = (int16_t) val;
+        memcpy (data, &tmp, sizeof (tmp));
+      }
+      break;
+    case 4:
+      {
+        int32_t tmp = (int32_t) val;
+        memcpy (data, &tmp, sizeof (tmp));
+      }
+      break;
+    case 8:
+      memcpy (data, &val, sizeof (val));
+      break;
+    default:
+      g_warn_if_reached ();
+      break;
+    }
+}
+
+/* --- writing --- */
+
+static inline void
+write_byte (
+  Writer * w,
+  guint8   byte)
+{
+  g_byte_array_append (w->buf, &byte, 1);
+}
+
+static void
+write_varint (
+  GByteArray * buf,
+  guint64      val)
+{
+  guint8 bytes[10];
+  int len = 0;
+  do
+    {
+      guint8 byte = val & 0x7f;
+      val >>= 7;
+      if (val)
+        byte |= 0x80;
+      bytes[len++] = byte;
+    } while (val);
+  g_byte_array_append (buf, bytes, (guint) len);
+}
+
+static guint64
+get_key_index (
+  Writer *     w,
+  const char * key)
+{
+  gpointer idx =
+    g_hash_table_lookup (w->key_indices, key);
+  if (idx)
+    return GPOINTER_TO_UINT (idx) - 1;
+
+  g_ptr_array_add (w->keys, (gpointer) key);
+  g_hash_table_insert (
+    w->key_indices, (gpointer) key,
+    GUINT_TO_POINTER (w->keys->len));
+  return w->keys->len - 1;
+}
+
+static void
+encode_mapping (
+  Writer *                     w,
+  const cyaml_schema_field_t * fields,
+  const uint8_t *              data);
+
+static void
+encode_sequence (
+  Writer *                     w,
+  const cyaml_schema_value_t * entry,
+  const uint8_t *              arr,
+  guint64                      count);
+
+/**
+ * Encodes the value at @p data, which points to
+ * the pointer if the value is a pointer.
+ */
+static void
+encode_value (
+  Writer *                     w,
+  const cyaml_schema_value_t * schema,
+  const uint8_t *              data)
+{
+  if (schema->flags & CYAML_FLAG_POINTER)
+    {
+      data = *(const uint8_t * const *) data;
+      if (!data)
+        {
+          write_byte (w, TAG_NULL);
+          return;
+        }
+    }
+
+  switch (schema->type)
+    {
+    case CYAML_INT:
+      write_byte (w, TAG_INT);
+      write_varint (
+        w->buf,
+        zigzag_encode (
+          get_int (data, schema->data_size)));
+      break;
+    case CYAML_UINT:
+    case CYAML_BOOL:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+      write_byte (w, TAG_UINT);
+      write_varint (
+        w->buf,
+        get_uint (data, schema->data_size));
+      break;
+    case CYAML_ENUM:
+      {
+        gint64 val =
+          get_int (data, schema->data_size);
+        const char * str = NULL;
+        for (uint32_t i = 0;
+             i < schema->enumeration.count; i++)
+          {
+            if (schema->enumeration.strings[i].val
+                  == val)
+              {
+                str =
+                  schema->enumeration.strings[i].str;
+                break;
+              }
+          }
+        if (str)
+          {
+            write_byte (w, TAG_ENUM);
+            write_varint (
+              w->buf, get_key_index (w, str));
+          }
+        else
+          {
+            write_byte (w, TAG_INT);
+            write_varint (
+              w->buf, zigzag_encode (val));
+          }
+      }
+      break;
+    case CYAML_FLOAT:
+      if (schema->data_size == sizeof (float))
+        {
+          guint32 val;
+          memcpy (&val, data, sizeof (val));
+          val = GUINT32_TO_LE (val);
+          write_byte (w, TAG_FLOAT);
+          g_byte_array_append (
+            w->buf, (const guint8 *) &val,
+            sizeof (val));
+        }
+      else
+        {
+          guint64 val;
+          memcpy (&val, data, sizeof (val));
+          val = GUINT64_TO_LE (val);
+          write_byte (w, TAG_DOUBLE);
+          g_byte_array_append (
+            w->buf, (const guint8 *) &val,
+            sizeof (val));
+        }
+      break;
+    case CYAML_STRING:
+      {
+        const char * str = (const char *) data;
+        size_t len =
+          (schema->flags & CYAML_FLAG_POINTER)
+          ? strlen (str)
+          : strnlen (str, schema->string.max);
+        write_byte (w, TAG_STRING);
+        write_varint (w->buf, len);
+        g_byte_array_append (
+          w->buf, (const guint8 *) str, (guint) len);
+      }
+      break;
+    case CYAML_MAPPING:
+      encode_mapping (
+        w, schema->mapping.fields, data);
+      break;
+    case CYAML_SEQUENCE_FIXED:
+      encode_sequence (
+        w, schema->sequence.entry, data,
+        schema->sequence.max);
+      break;
+    default:
+      /* variable sequences are only supported
+       * as mapping fields */
+      g_warn_if_reached ();
+      write_byte (w, TAG_NULL);
+      break;
+    }
+}
+
+static void
+encode_sequence (
+  Writer *                     w,
+  const cyaml_schema_value_t * entry,
+  const uint8_t *              arr,
+  guint64                      count)
+{
+  size_t stride =
+    (entry->flags & CYAML_FLAG_POINTER)
+    ? sizeof (void *) : entry->data_size;
+
+  write_byte (w, TAG_SEQUENCE);
+  write_varint (w->buf, count);
+  for (guint64 i = 0; i < count; i++)
+    {
+      encode_value (w, entry, arr + i * stride);
+    }
+}
+
+static void
+encode_mapping (
+  Writer *                     w,
+  const cyaml_schema_field_t * fields,
+  const uint8_t *              data)
+{
+  write_byte (w, TAG_MAPPING);
+
+  for (const cyaml_schema_field_t * field = fields;
+       field->key; field++)
+    {
+      const cyaml_schema_value_t * value =
+        &field->value;
+      const uint8_t * field_data =
+        data + field->data_offset;
+
+      switch (value->type)
+        {
+        case CYAML_IGNORE:
+          continue;
+        case CYAML_SEQUENCE:
+        case CYAML_SEQUENCE_FIXED:
+          {
+            guint64 count =
+              value->type == CYAML_SEQUENCE
+              ?
+                get_uint (
+                  data + field->count_offset,
+                  field->count_size)
+              : value->sequence.max;
+            const uint8_t * arr = field_data;
+            if (value->flags & CYAML_FLAG_POINTER)
+              {
+                arr =
+                  *(const uint8_t * const *)
+                  field_data;
+                if (!arr)
+                  {
+                    if (value->flags
+                          & CYAML_FLAG_OPTIONAL)
+                      continue;
+                    count = 0;
+                  }
+              }
+            write_varint (
+              w->buf,
+              get_key_index (w, field->key) + 1);
+            encode_sequence (
+              w, value->sequence.entry, arr, count);
+          }
+          continue;
+        default:
+          break;
+        }
+
+      /* skip NULL optional pointers */
+      if ((value->flags & CYAML_FLAG_POINTER)
+          && (value->flags & CYAML_FLAG_OPTIONAL)
+          && *(void * const *) field_data == NULL)
+        {
+          continue;
+        }
+
+      write_varint (
+        w->buf, get_key_index (w, field->key) + 1);
+      encode_value (w, value, field_data);
+    }
+
+  write_varint (w->buf, 0);
+}
+
+/**
+ * Returns whether the given data starts with the
+ * binary serialization header.
+ */
+bool
+schema_binary_is_binary (
+  const char * data,
+  size_t       size)
+{
+  size_t magic_len = strlen (SCHEMA_BINARY_MAGIC);
+  return
+    size > magic_len
+    &&
+    memcmp (data, SCHEMA_BINARY_MAGIC, magic_len)
+      == 0;
+}
+
+/**
+ * Serializes the given object to the binary
+ * format.
+ *
+ * @param data Pointer to the object, as passed to
+ *   yaml_serialize().
+ * @param[out] size Size of the returned data.
+ *
+ * @return Newly allocated data to be free'd with
+ *   g_free(), or NULL if error.
+ */
+char *
+schema_binary_serialize (
+  void *                       data,
+  const cyaml_schema_value_t * schema,
+  size_t *                     size)
+{
+  g_return_val_if_fail (
+    schema->flags & CYAML_FLAG_POINTER, NULL);
+
+  Writer w;
+  w.buf = g_byte_array_new ();
+  w.key_indices =
+    g_hash_table_new (g_str_hash, g_str_equal);
+  w.keys = g_ptr_array_new ();
+
+  encode_value (
+    &w, schema, (const uint8_t *) &data);
+
+  /* header and key table */
+  GByteArray * out =
+    g_byte_array_sized_new (w.buf->len + 4096);
+  g_byte_array_append (
+    out, (const guint8 *) SCHEMA_BINARY_MAGIC,
+    strlen (SCHEMA_BINARY_MAGIC));
+  guint8 version = SCHEMA_BINARY_FORMAT_VERSION;
+  g_byte_array_append (out, &version, 1);
+  write_varint (out, w.keys->len);
+  for (guint i = 0; i < w.keys->len; i++)
+    {
+      const char * key =
+        (const char *) g_ptr_array_index (w.keys, i);
+      size_t len = strlen (key);
+      write_varint (out, len);
+      g_byte_array_append (
+        out, (const guint8 *) key, (guint) len);
+    }
+  g_byte_array_append (
+    out, w.buf->data, w.buf->len);
+
+  g_byte_array_unref (w.buf);
+  g_hash_table_destroy (w.key_indices);
+  g_ptr_array_unref (w.keys);
+
+  *size = out->len;
+  return (char *) g_byte_array_free (out, false);
+}
+
+/* --- reading --- */
+
+static inline void
+set_error (
+  Reader *     r,
+  const char * error)
+{
+  if (!r->error)
+    r->error = error;
+  r->p = r->end;
+}
+
+static inline guint8
+read_byte (
+  Reader * r)
+{
+  if (r->p >= r->end)
+    {
+      set_error (r, "unexpected end of data");
+      return TAG_NULL;
+    }
+  return *r->p++;
+}
+
+static guint64
+read_varint (
+  Reader * r)
+{
+  guint64 val = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+    {
+      if (r->p >= r->end)
+        {
+          set_error (r, "unexpected end of data");
+          return 0;
+        }
+      guint8 byte = *r->p++;
+      val |= (guint64) (byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return val;
+    }
+
+  set_error (r, "invalid varint");
+  return 0;
+}
+
+static const uint8_t *
+read_bytes (
+  Reader * r,
+  guint64  len)
+{
+  if ((guint64) (r->end - r->p) < len)
+    {
+      set_error (r, "unexpected end of data");
+      return NULL;
+    }
+  const uint8_t * ret = r->p;
+  r->p += len;
+  return ret;
+}
+
+static const char *
+get_key (
+  Reader * r,
+  guint64  idx)
+{
+  if (idx >= r->keys->len)
+    {
+      set_error (r, "invalid key index");
+      return NULL;
+    }
+  return
+    (const char *) g_ptr_array_index (
+      r->keys, (guint) idx);
+}
+
+static void
+skip_value (
+  Reader * r,
+  guint8   tag)
+{
+  switch (tag)
+    {
+    case TAG_NULL:
+      break;
+    case TAG_INT:
+    case TAG_UINT:
+    case TAG_ENUM:
+      read_varint (r);
+      break;
+    case TAG_FLOAT:
+      read_bytes (r, 4);
+      break;
+    case TAG_DOUBLE:
+      read_bytes (r, 8);
+      break;
+    case TAG_STRING:
+      read_bytes (r, read_varint (r));
+      break;
+    case TAG_MAPPING:
+      while (!r->error && read_varint (r) != 0)
+        {
+          skip_value (r, read_byte (r));
+        }
+      break;
+    case TAG_SEQUENCE:
+      {
+        guint64 count = read_varint (r);
+        for (guint64 i = 0;
+             i < count && !r->error; i++)
+          {
+            skip_value (r, read_byte (r));
+          }
+      }
+      break;
+    default:
+      set_error (r, "unknown tag");
+      break;
+    }
+}
+
+static bool
+tag_matches_type (
+  guint8           tag,
+  enum cyaml_type  type)
+{
+  switch (type)
+    {
+    case CYAML_INT:
+    case CYAML_UINT:
+    case CYAML_BOOL:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+      return tag == TAG_INT || tag == TAG_UINT;
+    case CYAML_ENUM:
+      return
+        tag == TAG_ENUM || tag == TAG_INT
+        || tag == TAG_UINT;
+    case CYAML_FLOAT:
+      return
+        tag == TAG_FLOAT || tag == TAG_DOUBLE
+        || tag == TAG_INT || tag == TAG_UINT;
+    case CYAML_STRING:
+      return tag == TAG_STRING;
+    case CYAML_MAPPING:
+      return tag == TAG_MAPPING;
+    case CYAML_SEQUENCE:
+    case CYAML_SEQUENCE_FIXED:
+      return tag == TAG_SEQUENCE;
+    default:
+      break;
+    }
+
+  return false;
+}
+
+static void
+decode_mapping (
+  Reader *                     r,
+  const cyaml_schema_field_t * fields,
+  uint8_t *                    data);
+
+static void
+decode_sequence (
+  Reader *                     r,
+  const cyaml_schema_value_t * entry,
+  uint8_t *                    arr,
+  guint64                      count,
+  guint64                      max_count);
+
+/**
+ * Decodes a value whose tag was already read into
+ * @p data.
+ */
+static void
+decode_raw (
+  Reader *                     r,
+  const cyaml_schema_value_t * schema,
+  uint8_t *                    data,
+  guint8                       tag)
+{
+  switch (schema->type)
+    {
+    case CYAML_INT:
+    case CYAML_UINT:
+    case CYAML_BOOL:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+    case CYAML_ENUM:
+      {
+        gint64 val = 0;
+        if (tag == TAG_INT)
+          {
+            val = zigzag_decode (read_varint (r));
+          }
+        else if (tag == TAG_UINT)
+          {
+            val = (gint64) read_varint (r);
+          }
+        else /* TAG_ENUM */
+          {
+            const char * str =
+              get_key (r, read_varint (r));
+            if (!str)
+              return;
+
+            bool found = false;
+            for (uint32_t i = 0;
+                 i < schema->enumeration.count; i++)
+              {
+                if (strcmp (
+                      schema->enumeration.strings[i].
+                        str, str) == 0)
+                  {
+                    val =
+                      schema->enumeration.strings[i].
+                        val;
+                    found = true;
+                    break;
+                  }
+              }
+            if (!found)
+              {
+                g_warning (
+                  "unknown enum value '%s'", str);
+                return;
+              }
+          }
+        set_int (data, schema->data_size, val);
+      }
+      break;
+    case CYAML_FLOAT:
+      {
+        double val;
+        if (tag == TAG_FLOAT)
+          {
+            const uint8_t * bytes = read_bytes (r, 4);
+            if (!bytes)
+              return;
+            guint32 ival;
+            memcpy (&ival, bytes, sizeof (ival));
+            ival = GUINT32_FROM_LE (ival);
+            float fval;
+            memcpy (&fval, &ival, sizeof (fval));
+            val = (double) fval;
+          }
+        else if (tag == TAG_DOUBLE)
+          {
+            const uint8_t * bytes = read_bytes (r, 8);
+            if (!bytes)
+              return;
+            guint64 ival;
+            memcpy (&ival, bytes, sizeof (ival));
+            ival = GUINT64_FROM_LE (ival);
+            memcpy (&val, &ival, sizeof (val));
+          }
+        else if (tag == TAG_INT)
+          {
+            val =
+              (double) zigzag_decode (read_varint (r));
+          }
+        else
+          {
+            val = (double) read_varint (r);
+          }
+
+        if (schema->data_size == sizeof (float))
+          {
+            float fval = (float) val;
+            memcpy (data, &fval, sizeof (fval));
+          }
+        else
+          {
+            memcpy (data, &val, sizeof (val));
+          }
+      }
+      break;
+    case CYAML_STRING:
+      {
+        /* inline char array (pointers are handled
+         * by the caller) */
+        guint64 len = read_varint (r);
+        const uint8_t * bytes = read_bytes (r, len);
+        if (!bytes)
+          return;
+        if (len > schema->string.max)
+          len = schema->string.max;
+        memcpy (data, bytes, len);
+        data[len] = '\0';
+      }
+      break;
+    case CYAML_MAPPING:
+      decode_mapping (
+        r, schema->mapping.fields, data);
+      break;
+    case CYAML_SEQUENCE_FIXED:
+      decode_sequence (
+        r, schema->sequence.entry, data,
+        read_varint (r), schema->sequence.max);
+      break;
+    default:
+      skip_value (r, tag);
+      break;
+    }
+}
+
+/**
+ * Decodes the value at the current position into
+ * @p data, which points to the pointer if the
+ * value is a pointer.
+ */
+static void
+decode_value (
+  Reader *                     r,
+  const cyaml_schema_value_t * schema,
+  uint8_t *                    data)
+{
+  guint8 tag = read_byte (r);
+  if (r->error || tag == TAG_NULL)
+    return;
+
+  if (!tag_matches_type (tag, schema->type))
+    {
+      g_debug (
+        "skipping value with tag %u (expected "
+        "cyaml type %d)",
+        tag, schema->type);
+      skip_value (r, tag);
+      return;
+    }
+
+  if (schema->flags & CYAML_FLAG_POINTER)
+    {
+      if (schema->type == CYAML_STRING)
+        {
+          guint64 len = read_varint (r);
+          const uint8_t * bytes =
+            read_bytes (r, len);
+          if (!bytes)
+            return;
+          char * str = malloc ((size_t) len + 1);
+          memcpy (str, bytes, (size_t) len);
+          str[len] = '\0';
+          *(char **) data = str;
+          return;
+        }
+
+      uint8_t * obj = calloc (1, schema->data_size);
+      *(uint8_t **) data = obj;
+      data = obj;
+    }
+
+  decode_raw (r, schema, data, tag);
+}
+
+/**
+ * Decodes @p count entries into @p arr, skipping
+ * any past @p max_count.
+ */
+static void
+decode_sequence (
+  Reader *                     r,
+  const cyaml_schema_value_t * entry,
+  uint8_t *                    arr,
+  guint64                      count,
+  guint64                      max_count)
+{
+  size_t stride =
+    (entry->flags & CYAML_FLAG_POINTER)
+    ? sizeof (void *) : entry->data_size;
+
+  for (guint64 i = 0; i < count && !r->error; i++)
+    {
+      if (i < max_count)
+        {
+          decode_value (r, entry, arr + i * stride);
+        }
+      else
+        {
+          skip_value (r, read_byte (r));
+        }
+    }
+}
+
+static void
+decode_field (
+  Reader *                     r,
+  const cyaml_schema_field_t * field,
+  uint8_t *                    data)
+{
+  const cyaml_schema_value_t * value =
+    &field->value;
+  uint8_t * field_data = data + field->data_offset;
+
+  switch (value->type)
+    {
+    case CYAML_IGNORE:
+      skip_value (r, read_byte (r));
+      return;
+    case CYAML_SEQUENCE:
+    case CYAML_SEQUENCE_FIXED:
+      break;
+    default:
+      decode_value (r, value, field_data);
+      return;
+    }
+
+  guint8 tag = read_byte (r);
+  if (tag != TAG_SEQUENCE)
+    {
+      skip_value (r, tag);
+      return;
+    }
+
+  guint64 count = read_varint (r);
+  if (r->error)
+    return;
+
+  guint64 max_count =
+    value->sequence.max == CYAML_UNLIMITED
+    ? count : value->sequence.max;
+  guint64 num_decoded = MIN (count, max_count);
+  if (value->flags & CYAML_FLAG_POINTER)
+    {
+      const cyaml_schema_value_t * entry =
+        value->sequence.entry;
+      size_t stride =
+        (entry->flags & CYAML_FLAG_POINTER)
+        ? sizeof (void *) : entry->data_size;
+      uint8_t * arr =
+        num_decoded > 0
+        ? calloc ((size_t) num_decoded, stride)
+        : NULL;
+      *(uint8_t **) field_data = arr;
+      field_data = arr;
+    }
+
+  decode_sequence (
+    r, value->sequence.entry, field_data, count,
+    max_count);
+
+  if (value->type == CYAML_SEQUENCE)
+    {
+      set_int (
+        data + field->count_offset,
+        field->count_size, (gint64) num_decoded);
+    }
+}
+
+static const cyaml_schema_field_t *
+find_field (
+  const cyaml_schema_field_t * fields,
+  const cyaml_schema_field_t * hint,
+  const char *                 key)
+{
+  /* fields are normally written in schema order so
+   * try the one after the previous match first */
+  if (hint->key && strcmp (hint->key, key) == 0)
+    return hint;
+
+  for (const cyaml_schema_field_t * field = fields;
+       field->key; field++)
+    {
+      if (strcmp (field->key, key) == 0)
+        return field;
+    }
+
+  return NULL;
+}
+
+static void
+decode_mapping (
+  Reader *                     r,
+  const cyaml_schema_field_t * fields,
+  uint8_t *                    data)
+{
+  /* bitmap of the fields found, to check for
+   * missing mandatory fields like libcyaml does */
+  size_t num_fields = 0;
+  while (fields[num_fields].key)
+    num_fields++;
+  guint64 found_buf[4] = { 0 };
+  guint64 * found = found_buf;
+  if (num_fields > 64 * G_N_ELEMENTS (found_buf))
+    {
+      found =
+        calloc (
+          (num_fields + 63) / 64, sizeof (guint64));
+    }
+
+  const cyaml_schema_field_t * hint = fields;
+  while (!r->error)
+    {
+      guint64 key_idx = read_varint (r);
+      if (key_idx == 0)
+        break;
+
+      const char * key = get_key (r, key_idx - 1);
+      if (!key)
+        break;
+
+      const cyaml_schema_field_t * field =
+        find_field (fields, hint, key);
+      if (!field)
+        {
+          g_debug ("skipping unknown key '%s'", key);
+          skip_value (r, read_byte (r));
+          continue;
+        }
+
+      decode_field (r, field, data);
+      size_t idx = (size_t) (field - fields);
+      found[idx / 64] |= (guint64) 1 << (idx % 64);
+      hint = field + 1;
+    }
+
+  for (size_t i = 0; i < num_fields && !r->error; i++)
+    {
+      const cyaml_schema_field_t * field =
+        &fields[i];
+      if ((found[i / 64] & ((guint64) 1 << (i % 64)))
+          || field->value.type == CYAML_IGNORE
+          || (field->value.flags
+                & CYAML_FLAG_OPTIONAL))
+        continue;
+
+      r->missing_key = field->key;
+      set_error (r, "missing mandatory field");
+    }
+
+  if (found != found_buf)
+    free (found);
+}
+
+/**
+ * Deserializes an object from binary data.
+ *
+ * Memory is allocated the same way as
+ * yaml_deserialize(), so the result can be free'd
+ * with the same functions.
+ *
+ * @return The newly allocated object, or NULL if
+ *   error.
+ */
+void *
+schema_binary_deserialize (
+  const char *                 data,
+  size_t                       size,
+  const cyaml_schema_value_t * schema,
+  GError **                    error)
+{
+  g_return_val_if_fail (
+    schema->flags & CYAML_FLAG_POINTER, NULL);
+
+  if (!schema_binary_is_binary (data, size))
+    {
+      g_set_error_literal (
+        error, Z_UTILS_SCHEMA_BINARY_ERROR,
+        Z_UTILS_SCHEMA_BINARY_ERROR_INVALID,
+        _("Data is not in binary format"));
+      return NULL;
+    }
+
+  Reader r;
+  r.p =
+    (const uint8_t *) data
+    + strlen (SCHEMA_BINARY_MAGIC);
+  r.end = (const uint8_t *) data + size;
+  r.keys = g_ptr_array_new_with_free_func (g_free);
+  r.error = NULL;
+  r.missing_key = NULL;
+
+  guint8 version = read_byte (&r);
+  if (version > SCHEMA_BINARY_FORMAT_VERSION)
+    {
+      g_set_error (
+        error, Z_UTILS_SCHEMA_BINARY_ERROR,
+        Z_UTILS_SCHEMA_BINARY_ERROR_INVALID,
+        _("Unsupported binary format version %u"),
+        version);
+      g_ptr_array_unref (r.keys);
+      return NULL;
+    }
+
+  guint64 num_keys = read_varint (&r);
+  for (guint64 i = 0; i < num_keys && !r.error; i++)
+    {
+      guint64 len = read_varint (&r);
+      const uint8_t * bytes = read_bytes (&r, len);
+      if (bytes)
+        {
+          g_ptr_array_add (
+            r.keys,
+            g_strndup (
+              (const char *) bytes, (gsize) len));
+        }
+    }
+
+  void * obj = NULL;
+  decode_value (&r, schema, (uint8_t *) &obj);
+  g_ptr_array_unref (r.keys);
+
+  if (r.error || !obj)
+    {
+      if (obj)
+        {
+          cyaml_config_t cyaml_config;
+          yaml_get_cyaml_config (&cyaml_config);
+          cyaml_free (&cyaml_config, schema, obj, 0);
+        }
+      if (r.missing_key)
+        {
+          g_set_error (
+            error, Z_UTILS_SCHEMA_BINARY_ERROR,
+            Z_UTILS_SCHEMA_BINARY_ERROR_INVALID,
+            _("Invalid binary data: missing "
+            "mandatory field '%s'"),
+            r.missing_key);
+        }
+      else
+        {
+          g_set_error (
+            error, Z_UTILS_SCHEMA_BINARY_ERROR,
+            Z_UTILS_SCHEMA_BINARY_ERROR_INVALID,
+            _("Invalid binary data: %s"),
+            r.error ? r.error : "no object");
+        }
+      return NULL;
+    }
+
+  return obj;
+}
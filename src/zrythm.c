@@ -34,6 +34,7 @@
 #include "audio/tracklist.h"
 #include "gui/accel.h"
 #include "gui/backend/event_manager.h"
+#include "gui/backend/refresh_scheduler.h"
 #include "gui/backend/file_manager.h"
 #include "gui/backend/piano_roll.h"
 #include "gui/widgets/main_window.h"
@@ -43,6 +44,7 @@
 #include "settings/settings.h"
 #include "utils/arrays.h"
 #include "utils/cairo.h"
+#include "utils/dsp.h"
 #include "utils/curl.h"
 #include "utils/env.h"
 #include "utils/gtk.h"
@@ -632,6 +634,11 @@ zrythm_get_dir (
             g_build_filename (
               user_dir, "backtraces", NULL);
           break;
+        case ZRYTHM_DIR_USER_CACHE:
+          res =
+            g_build_filename (
+              user_dir, "cache", NULL);
+          break;
         default:
           break;
         }
@@ -714,6 +721,9 @@ zrythm_free (
   object_free_w_func_and_null (
     plugin_manager_free,
     self->plugin_manager);
+  object_free_w_func_and_null (
+    refresh_scheduler_free,
+    self->refresh_scheduler);
   object_free_w_func_and_null (
     event_manager_free, self->event_manager);
   object_free_w_func_and_null (
@@ -763,6 +773,10 @@ zrythm_new (
   self->have_ui = have_ui;
   self->testing = testing;
   self->use_optimized_dsp = optimized_dsp;
+  dsp_set_isa (
+    optimized_dsp
+    ? dsp_kernels_get_best_isa ()
+    : DSP_ISA_SCALAR);
   self->settings = settings_new ();
   self->object_utils = object_utils_new ();
   self->recording_manager =
@@ -777,6 +791,8 @@ zrythm_new (
     {
       self->event_manager =
         event_manager_new ();
+      self->refresh_scheduler =
+        refresh_scheduler_new ();
     }
 
   return self;
@@ -26,6 +26,7 @@
 #include "audio/chord_region.h"
 #include "audio/master_track.h"
 #include "audio/midi_note.h"
+#include "audio/midi_region.h"
 #include "audio/region.h"
 #include "project.h"
 #include "utils/dsp.h"
@@ -1667,6 +1668,183 @@ test_quantize (void)
   test_helper_zrythm_cleanup ();
 }
 
+static ZRegion *
+get_edit_notes_region (
+  int track_pos)
+{
+  Track * track = TRACKLIST->tracks[track_pos];
+  ZRegion * r = track->lanes[0]->regions[0];
+  g_assert_true (IS_REGION_AND_NONNULL (r));
+  return r;
+}
+
+static void
+check_edit_notes_region (
+  int  track_pos,
+  int  num_notes,
+  int  pitch_diff,
+  bool halved_vels,
+  bool quantized)
+{
+  ZRegion * r = get_edit_notes_region (track_pos);
+  g_assert_cmpint (
+    r->num_midi_notes, ==, num_notes);
+  for (int i = 0; i < num_notes; i++)
+    {
+      MidiNote * mn = r->midi_notes[i];
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) mn;
+      g_assert_cmpint (
+        mn->val, ==, 40 + i % 40 + pitch_diff);
+      g_assert_cmpint (
+        mn->vel->vel, ==,
+        halved_vels ? 50 : 100);
+
+      /* quantizing may add up to a tick at
+       * random */
+      double start =
+        (double) (i * 960) + (quantized ? 0 : 10);
+      g_assert_cmpfloat_with_epsilon (
+        mn_obj->pos.ticks, start, 1.0);
+      g_assert_cmpfloat_with_epsilon (
+        mn_obj->end_pos.ticks, start + 480.0, 1.0);
+    }
+}
+
+static void
+test_edit_notes (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+  int track_pos = track->pos;
+
+  Position start, end;
+  position_set_to_bar (&start, 1);
+  position_set_to_bar (&end, 33);
+  ZRegion * r =
+    midi_region_new (
+      &start, &end, track_get_name_hash (track),
+      0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  const int num_notes = 120;
+  for (int i = 0; i < num_notes; i++)
+    {
+      position_from_ticks (
+        &start, (double) (i * 960) + 10);
+      position_from_ticks (
+        &end, (double) (i * 960) + 490);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &start, &end,
+          (uint8_t) (40 + i % 40), 100);
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+      arranger_object_select (
+        (ArrangerObject *) mn, F_SELECT,
+        F_APPEND, F_NO_PUBLISH_EVENTS);
+    }
+
+  /* transpose and scale the velocities */
+  MidiNoteBatch * batch =
+    midi_note_batch_new_from_selections (
+      MA_SELECTIONS);
+  g_assert_nonnull (batch);
+  g_assert_cmpint (batch->num_regions, ==, 1);
+  g_assert_cmpint (
+    batch->num_notes, ==, num_notes);
+  midi_note_batch_transpose (batch, 2);
+  midi_note_batch_scale_velocities (batch, 0.5);
+
+  /* not written until the action is performed */
+  check_edit_notes_region (
+    track_pos, num_notes, 0, false, false);
+
+  bool ret =
+    arranger_selections_action_perform_edit_notes (
+      NULL, batch, F_NOT_ALREADY_EDITED, NULL);
+  g_assert_true (ret);
+  midi_note_batch_free (batch);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, true, false);
+
+  /* only the changes are stored */
+  ArrangerSelectionsAction * action =
+    (ArrangerSelectionsAction *)
+    undo_manager_get_last_action (UNDO_MANAGER);
+  g_assert_cmpint (
+    action->type, ==, AS_ACTION_EDIT_NOTES);
+  g_assert_null (action->sel);
+  g_assert_null (action->sel_after);
+  g_assert_cmpint (
+    action->num_note_changes, ==, num_notes);
+
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  check_edit_notes_region (
+    track_pos, num_notes, 0, false, false);
+
+  test_project_save_and_reload ();
+
+  undo_manager_redo (UNDO_MANAGER, NULL);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, true, false);
+
+  /* quantize */
+  ret =
+    arranger_selections_action_perform_quantize (
+      (ArrangerSelections *) MA_SELECTIONS,
+      QUANTIZE_OPTIONS_EDITOR, NULL);
+  g_assert_true (ret);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, true, true);
+
+  test_project_save_and_reload ();
+
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, true, false);
+  undo_manager_redo (UNDO_MANAGER, NULL);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, true, true);
+
+  /* already edited values (eg, after dragging
+   * velocities) are not written again */
+  r = get_edit_notes_region (track_pos);
+  MidiNoteBatch * before =
+    midi_note_batch_new_from_selections (
+      MA_SELECTIONS);
+  g_assert_nonnull (before);
+  for (int i = 0; i < num_notes; i++)
+    {
+      r->midi_notes[i]->vel->vel = 100;
+    }
+  MidiNoteBatch * after =
+    midi_note_batch_new_from_selections (
+      MA_SELECTIONS);
+  g_assert_nonnull (after);
+  ret =
+    arranger_selections_action_perform_edit_notes (
+      before, after, F_ALREADY_EDITED, NULL);
+  g_assert_true (ret);
+  midi_note_batch_free (before);
+  midi_note_batch_free (after);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, false, true);
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, true, true);
+  undo_manager_redo (UNDO_MANAGER, NULL);
+  check_edit_notes_region (
+    track_pos, num_notes, 2, false, true);
+
+  test_helper_zrythm_cleanup ();
+}
+
 static void
 verify_audio_function (
   float * frames,
@@ -3492,6 +3670,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test quantize",
     (GTestFunc) test_quantize);
+  g_test_add_func (
+    TEST_PREFIX "test edit notes",
+    (GTestFunc) test_edit_notes);
   g_test_add_func (
     TEST_PREFIX "test automation fill",
     (GTestFunc) test_automation_fill);
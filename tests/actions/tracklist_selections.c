@@ -31,6 +31,7 @@
 #include "audio/midi_note.h"
 #include "audio/region.h"
 #include "audio/router.h"
+#include "audio/track_processor.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "utils/color.h"
@@ -329,10 +330,17 @@ _test_undo_track_deletion (
     helm_track, F_SELECT, F_EXCLUSIVE,
     F_NO_PUBLISH_EVENTS);
 
-  /* get an automation track */
+  /* get the automation track of a MIDI CC (MIDI
+   * automatables are created on first use) */
+  Port * cc =
+    track_processor_get_or_create_midi_automatable (
+      helm_track->processor, 0, 28);
+  g_assert_nonnull (cc);
   AutomationTracklist * atl =
     track_get_automation_tracklist (helm_track);
-  AutomationTrack * at = atl->ats[40];
+  AutomationTrack * at =
+    automation_tracklist_get_at_from_port (atl, cc);
+  g_assert_nonnull (at);
   at->created = true;
   at->visible = true;
 
@@ -920,10 +928,17 @@ test_ins_track_deletion_w_automation (void)
 
   engine_activate (AUDIO_ENGINE, true);
 
-  /* get the instrument cutoff automation track */
+  /* get the automation track of a MIDI CC (MIDI
+   * automatables are created on first use) */
+  Port * cc =
+    track_processor_get_or_create_midi_automatable (
+      track->processor, 0, 29);
+  g_assert_nonnull (cc);
   AutomationTracklist * atl =
     track_get_automation_tracklist (track);
-  AutomationTrack * at = atl->ats[41];
+  AutomationTrack * at =
+    automation_tracklist_get_at_from_port (atl, cc);
+  g_assert_nonnull (at);
   at->created = true;
   at->visible = true;
 
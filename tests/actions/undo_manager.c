@@ -203,6 +203,80 @@ test_fill_stack (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_spill_to_journal (void)
+{
+  test_helper_zrythm_init ();
+
+  /* spill everything except the top actions */
+  UNDO_MANAGER->mem_budget = 1;
+
+  const int num_tracks_at_start =
+    TRACKLIST->num_tracks;
+  const int num_actions = 6;
+  for (int i = 0; i < num_actions; i++)
+    {
+      track_create_empty_with_action (
+        TRACK_TYPE_AUDIO_BUS, NULL);
+    }
+
+  Stack * stack = UNDO_MANAGER->undo_stack->stack;
+  g_assert_cmpint (stack->top, ==, num_actions - 1);
+  for (int i = 0; i < num_actions - 1; i++)
+    {
+      UndoableAction * ua =
+        (UndoableAction *) stack->elements[i];
+      g_assert_true (ua->spilled);
+    }
+  g_assert_false (
+    ((UndoableAction *)
+     stack->elements[stack->top])->spilled);
+  g_assert_nonnull (UNDO_MANAGER->journal);
+  g_assert_cmpint (
+    UNDO_MANAGER->journal->size, >, 0);
+
+  /* undo everything */
+  for (int i = 0; i < num_actions; i++)
+    {
+      undo_manager_undo (UNDO_MANAGER, NULL);
+      g_assert_cmpint (
+        TRACKLIST->num_tracks, ==,
+        num_tracks_at_start + num_actions - (i + 1));
+    }
+
+  /* redo after saving and reloading */
+  test_project_save_and_reload ();
+  g_assert_cmpint (
+    UNDO_MANAGER->redo_stack->stack->top, ==,
+    num_actions - 1);
+  UNDO_MANAGER->mem_budget = 1;
+  for (int i = 0; i < num_actions; i++)
+    {
+      undo_manager_redo (UNDO_MANAGER, NULL);
+    }
+  g_assert_cmpint (
+    TRACKLIST->num_tracks, ==,
+    num_tracks_at_start + num_actions);
+
+  /* clearing the redo stack with a new action
+   * keeps the spilled undo history usable */
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  track_create_empty_with_action (
+    TRACK_TYPE_MIDI, NULL);
+  g_assert_cmpint (
+    TRACKLIST->num_tracks, ==,
+    num_tracks_at_start + num_actions);
+  while (!undo_stack_is_empty (
+           UNDO_MANAGER->undo_stack))
+    {
+      undo_manager_undo (UNDO_MANAGER, NULL);
+    }
+  g_assert_cmpint (
+    TRACKLIST->num_tracks, ==, num_tracks_at_start);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -219,6 +293,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test perform many actions",
     (GTestFunc) test_perform_many_actions);
+  g_test_add_func (
+    TEST_PREFIX "test spill to journal",
+    (GTestFunc) test_spill_to_journal);
 
   return g_test_run ();
 }
@@ -19,7 +19,12 @@
 
 #include "zrythm-test-config.h"
 
+#include <string.h>
+
 #include "actions/tracklist_selections.h"
+#include "audio/clip.h"
+#include "audio/disk_streamer.h"
+#include "audio/engine.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
 #include "audio/transport.h"
@@ -31,6 +36,8 @@
 #include "tests/helpers/project.h"
 #include "tests/helpers/zrythm.h"
 
+#include <glib/gstdio.h>
+
 static void
 test_fill_stereo_ports (void)
 {
@@ -98,6 +105,145 @@ test_fill_stereo_ports (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_fill_stereo_ports_streamed (void)
+{
+  test_helper_zrythm_init ();
+
+  test_project_stop_dummy_engine ();
+
+  Position pos;
+  position_set_to_bar (&pos, 2);
+
+  /* create audio track with region */
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR,
+      "test_start_with_signal.mp3", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  int num_tracks_before = TRACKLIST->num_tracks;
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, &pos,
+    num_tracks_before, 1, NULL);
+  supported_file_free (file);
+
+  Track * track =
+    TRACKLIST->tracks[num_tracks_before];
+  ZRegion * r = track->lanes[0]->regions[0];
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  AudioClip * r_clip = audio_region_get_clip (r);
+  size_t num_frames = (size_t) r_clip->num_frames;
+  g_assert_cmpuint (num_frames, >, 10000);
+  float * orig_l = g_new (float, num_frames);
+  memcpy (
+    orig_l, r_clip->ch_frames[0],
+    num_frames * sizeof (float));
+  float * orig_r = g_new (float, num_frames);
+  memcpy (
+    orig_r, r_clip->ch_frames[1],
+    num_frames * sizeof (float));
+
+  /* stream the clip from a file with the same
+   * frames */
+  char * tmp_dir =
+    g_dir_make_tmp ("zrythm_stream_XXXXXX", NULL);
+  char * stream_path =
+    g_build_filename (tmp_dir, "clip.wav", NULL);
+  int ret =
+    audio_write_raw_file (
+      r_clip->frames, 0, num_frames,
+      (uint32_t) AUDIO_ENGINE->sample_rate, false,
+      BIT_DEPTH_32, r_clip->channels, stream_path);
+  g_assert_cmpint (ret, ==, 0);
+  g_assert_true (
+    audio_clip_init_streaming (
+      r_clip, stream_path,
+      (int) AUDIO_ENGINE->sample_rate, 0));
+  g_assert_null (r_clip->frames);
+  g_assert_cmpuint (r_clip->num_frames, ==, num_frames);
+
+  StereoPorts * ports =
+    stereo_ports_new_generic (
+      false, "ports", "ports",
+      PORT_OWNER_TYPE_AUDIO_ENGINE, NULL);
+  port_allocate_bufs (ports->l);
+  port_allocate_bufs (ports->r);
+
+  /* the first read starts filling the buffer and
+   * returns silence */
+  nframes_t nframes = 100;
+  signed_frame_t g_start =
+    r_obj->pos.frames - 20;
+  EngineProcessTimeInfo time_nfo = {
+    .g_start_frame = (unsigned_frame_t) g_start,
+    .local_offset = 0, .nframes = nframes };
+  audio_region_fill_stereo_ports (
+    r, &time_nfo, ports);
+  g_assert_true (
+    audio_frames_empty (&ports->l->buf[0], nframes));
+
+  /* give the I/O thread time to fill the buffer,
+   * then check continuous playback and a jump */
+  signed_frame_t starts[] = {
+    g_start + nframes, r_obj->pos.frames + 5000 };
+  for (size_t i = 0; i < G_N_ELEMENTS (starts); i++)
+    {
+      if (i > 0)
+        {
+          /* jump */
+          time_nfo.g_start_frame =
+            (unsigned_frame_t) starts[i];
+          audio_region_fill_stereo_ports (
+            r, &time_nfo, ports);
+          starts[i] += nframes;
+        }
+      g_usleep (200000);
+
+      for (int j = 0; j < 40; j++)
+        {
+          g_start = starts[i] + j * nframes;
+          time_nfo.g_start_frame =
+            (unsigned_frame_t) g_start;
+          audio_region_fill_stereo_ports (
+            r, &time_nfo, ports);
+          size_t local =
+            (size_t) (g_start - r_obj->pos.frames);
+          g_assert_true (
+            audio_frames_equal (
+              &orig_l[local], &ports->l->buf[0],
+              nframes, 0.00001f));
+          g_assert_true (
+            audio_frames_equal (
+              &orig_r[local], &ports->r->buf[0],
+              nframes, 0.00001f));
+        }
+    }
+  g_assert_cmpint (
+    disk_streamer_get_num_underruns (
+      AUDIO_ENGINE->disk_streamer), ==, 0);
+
+  /* editing loads the frames into memory */
+  g_assert_true (audio_clip_make_resident (r_clip));
+  g_assert_null (r_clip->stream_path);
+  g_assert_true (
+    audio_frames_equal (
+      orig_l, r_clip->ch_frames[0], num_frames,
+      0.00001f));
+
+  object_free_w_func_and_null (
+    stereo_ports_free, ports);
+  g_free (orig_l);
+  g_free (orig_r);
+
+  test_helper_zrythm_cleanup ();
+
+  g_unlink (stream_path);
+  g_rmdir (tmp_dir);
+  g_free (stream_path);
+  g_free (tmp_dir);
+}
+
 static void
 test_change_samplerate (void)
 {
@@ -242,6 +388,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test fill stereo ports",
     (GTestFunc) test_fill_stereo_ports);
+  g_test_add_func (
+    TEST_PREFIX "test fill stereo ports streamed",
+    (GTestFunc) test_fill_stereo_ports_streamed);
   g_test_add_func (
     TEST_PREFIX "test detect bpm",
     (GTestFunc) test_detect_bpm);
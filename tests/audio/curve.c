@@ -541,6 +541,52 @@ test_curve_algorithms (void)
     val, 0.0, epsilon);
 }
 
+static void
+test_block_evaluation (void)
+{
+  CurveOptions opts;
+  float buf[1000];
+  const size_t size = G_N_ELEMENTS (buf);
+  double x_step = 1.0 / (double) size;
+  double curvinesses[] = { -0.7, 0.0, 0.5 };
+
+  for (CurveAlgorithm algo = 0;
+       algo < NUM_CURVE_ALGORITHMS; algo++)
+    {
+      opts.algo = algo;
+      for (size_t c = 0;
+           c < G_N_ELEMENTS (curvinesses); c++)
+        {
+          opts.curviness = curvinesses[c];
+          for (int start_higher = 0;
+               start_higher <= 1; start_higher++)
+            {
+              curve_get_normalized_y_block (
+                &opts, start_higher, 0.0, x_step,
+                buf, size);
+              for (size_t i = 0; i < size; i++)
+                {
+                  double val =
+                    curve_get_normalized_y (
+                      x_step * (double) i, &opts,
+                      start_higher);
+
+                  /* exact at segment boundaries,
+                   * interpolated in between */
+                  double epsilon =
+                    (algo == CURVE_ALGORITHM_PULSE
+                     ||
+                     i % CURVE_BLOCK_SEGMENT_SIZE
+                       == 0)
+                    ? 0.0001 : 0.01;
+                  g_assert_cmpfloat_with_epsilon (
+                    (double) buf[i], val, epsilon);
+                }
+            }
+        }
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -553,6 +599,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test_curve_algorithms",
     (GTestFunc) test_curve_algorithms);
+  g_test_add_func (
+    TEST_PREFIX "test block evaluation",
+    (GTestFunc) test_block_evaluation);
 
   return g_test_run ();
 }
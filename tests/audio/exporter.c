@@ -23,16 +23,21 @@
 #include "helpers/zrythm.h"
 
 #include "actions/tracklist_selections.h"
+#include "audio/audio_region.h"
+#include "audio/clip.h"
+#include "audio/disk_streamer.h"
 #include "audio/encoder.h"
 #include "audio/exporter.h"
 #include "audio/supported_file.h"
 #include "project.h"
+#include "utils/audio.h"
 #include "utils/chromaprint.h"
 #include "utils/math.h"
 #include "utils/objects.h"
 #include "zrythm.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <sndfile.h>
 
@@ -135,6 +140,100 @@ test_export_wav (void)
   test_helper_zrythm_cleanup ();
 }
 
+/**
+ * Exports a clip streamed from disk, which must
+ * not come out silent or with gaps although the
+ * export runs faster than realtime.
+ */
+static void
+test_export_streamed_clip (void)
+{
+  test_helper_zrythm_init ();
+
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  int num_tracks_before = TRACKLIST->num_tracks;
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD,
+    num_tracks_before, 1, NULL);
+  supported_file_free (file);
+
+  /* stream the clip from a file with the same
+   * frames */
+  Track * track =
+    TRACKLIST->tracks[num_tracks_before];
+  ZRegion * r = track->lanes[0]->regions[0];
+  AudioClip * clip = audio_region_get_clip (r);
+  char * tmp_dir =
+    g_dir_make_tmp ("zrythm_stream_XXXXXX", NULL);
+  char * stream_path =
+    g_build_filename (tmp_dir, "clip.wav", NULL);
+  int ret =
+    audio_write_raw_file (
+      clip->frames, 0, (size_t) clip->num_frames,
+      (uint32_t) AUDIO_ENGINE->sample_rate, false,
+      BIT_DEPTH_32, clip->channels, stream_path);
+  g_assert_cmpint (ret, ==, 0);
+  g_assert_true (
+    audio_clip_init_streaming (
+      clip, stream_path,
+      (int) AUDIO_ENGINE->sample_rate, 0));
+  g_assert_nonnull (clip->stream_path);
+
+  char * prj_dir =
+    g_dir_make_tmp ("test_wav_prj_XXXXXX", NULL);
+  ret =
+    project_save (
+      PROJECT, prj_dir, 0, 0, F_NO_ASYNC);
+  g_free (prj_dir);
+  g_assert_cmpint (ret, ==, 0);
+
+  ExportSettings settings;
+  memset (&settings, 0, sizeof (ExportSettings));
+  settings.format = AUDIO_FORMAT_WAV;
+  settings.artist = g_strdup ("Test Artist");
+  settings.title = g_strdup ("Test Title");
+  settings.genre = g_strdup ("Test Genre");
+  settings.depth = BIT_DEPTH_16;
+  settings.time_range = TIME_RANGE_LOOP;
+  settings.mode = EXPORT_MODE_FULL;
+  tracklist_mark_all_tracks_for_bounce (
+    TRACKLIST, F_NO_BOUNCE);
+  char * exports_dir =
+    project_get_path (
+      PROJECT, PROJECT_PATH_EXPORTS, false);
+  settings.file_uri =
+    g_build_filename (
+      exports_dir, "test_streamed.wav", NULL);
+  g_free (exports_dir);
+  int underruns_before =
+    disk_streamer_get_num_underruns (
+      AUDIO_ENGINE->disk_streamer);
+  ret = exporter_export (&settings);
+  g_assert_cmpint (ret, ==, 0);
+  g_assert_cmpint (
+    disk_streamer_get_num_underruns (
+      AUDIO_ENGINE->disk_streamer), ==,
+    underruns_before);
+
+  z_chromaprint_check_fingerprint_similarity (
+    filepath, settings.file_uri, 83, 6);
+
+  io_remove (settings.file_uri);
+  export_settings_free_members (&settings);
+  g_free (filepath);
+
+  test_helper_zrythm_cleanup ();
+
+  g_unlink (stream_path);
+  g_rmdir (tmp_dir);
+  g_free (stream_path);
+  g_free (tmp_dir);
+}
+
 static void
 bounce_region (
   bool with_bpm_automation)
@@ -750,6 +849,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test export wav",
     (GTestFunc) test_export_wav);
+  g_test_add_func (
+    TEST_PREFIX "test export streamed clip",
+    (GTestFunc) test_export_streamed_clip);
   g_test_add_func (
     TEST_PREFIX "test bounce instrument track",
     (GTestFunc) test_bounce_instrument_track);
@@ -20,8 +20,12 @@
 #include "zrythm-test-config.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "audio/midi_event.h"
+#include "audio/port.h"
+#include "utils/flags.h"
+#include "utils/log.h"
 
 #include "tests/helpers/zrythm.h"
 
@@ -54,6 +58,175 @@ test_add_note_ons (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_full_buffer (void)
+{
+  test_helper_zrythm_init ();
+
+  MidiEvents * events = midi_events_new ();
+
+  /* the buffer starts small and grows on
+   * demand */
+  g_assert_cmpint (
+    events->events_size, ==,
+    MIDI_EVENTS_INITIAL_SIZE);
+  for (int i = 0; i < MAX_MIDI_EVENTS; i++)
+    {
+      midi_events_add_note_on (
+        events, 1, (midi_byte_t) (i % 128), 90,
+        (midi_time_t) i, F_NOT_QUEUED);
+    }
+  g_assert_cmpint (
+    events->num_events, ==, MAX_MIDI_EVENTS);
+  g_assert_cmpint (
+    events->events_size, ==, MAX_MIDI_EVENTS);
+
+  /* the first growth used the spare buffer, and
+   * the replaced buffer is freed outside the
+   * realtime threads */
+  g_assert_nonnull (events->retired_events);
+  midi_events_prepare_spares ();
+  g_assert_null (events->retired_events);
+  g_assert_null (events->spare_events);
+  for (int i = 0; i < MAX_MIDI_EVENTS; i++)
+    {
+      MidiEvent * ev = &events->events[i];
+      g_assert_cmpuint (ev->time, ==, i);
+      g_assert_cmpuint (
+        midi_get_note_number (ev->raw_buffer), ==,
+        i % 128);
+    }
+
+  /* events past the capacity are dropped */
+  LOG->use_structured_for_console = false;
+  LOG->min_log_level_for_test_console =
+    G_LOG_LEVEL_WARNING;
+  g_test_expect_message (
+    G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL,
+    "*MIDI events full*");
+  midi_events_add_note_on (
+    events, 1, 60, 90, 0, F_NOT_QUEUED);
+  g_test_assert_expected_messages ();
+  g_assert_cmpint (
+    events->num_events, ==, MAX_MIDI_EVENTS);
+
+  midi_events_free (events);
+
+  test_helper_zrythm_cleanup ();
+}
+
+/**
+ * Tests that clearing a port's buffer also clears
+ * the long data, so long messages are not dropped
+ * after a while.
+ */
+static void
+test_long_data_cleared (void)
+{
+  test_helper_zrythm_init ();
+
+  Port * port =
+    port_new_with_type (
+      TYPE_EVENT, FLOW_INPUT, "test port");
+  MidiEvents * events = port->midi_events;
+
+  midi_byte_t sysex[1024];
+  memset (sysex, 0x10, sizeof (sysex));
+  sysex[0] = 0xF0;
+  sysex[sizeof (sysex) - 1] = 0xF7;
+  for (int i = 0;
+       i < 2 * MIDI_EVENTS_MAX_LONG_DATA
+             / (int) sizeof (sysex);
+       i++)
+    {
+      port_clear_buffer (port);
+      midi_events_add_raw (
+        events, sysex, sizeof (sysex), 0,
+        F_NOT_QUEUED);
+      g_assert_cmpint (events->num_events, ==, 1);
+      g_assert_cmpuint (
+        events->long_data_len, ==, sizeof (sysex));
+    }
+
+  port_free (port);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_long_messages (void)
+{
+  MidiEvents * src = midi_events_new ();
+  MidiEvents * dest = midi_events_new ();
+
+  midi_byte_t sysex[] = {
+    0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7 };
+  midi_events_add_note_on (
+    src, 1, 60, 90, 2, F_NOT_QUEUED);
+  midi_events_add_raw (
+    src, sysex, sizeof (sysex), 4, F_NOT_QUEUED);
+  g_assert_cmpint (src->num_events, ==, 2);
+
+  MidiEvent * ev = &src->events[1];
+  g_assert_cmpuint (
+    ev->raw_buffer_sz, ==, sizeof (sysex));
+  g_assert_cmpmem (
+    midi_events_get_event_data (src, ev),
+    ev->raw_buffer_sz, sysex, sizeof (sysex));
+
+  midi_events_append (
+    src, dest, 0, 10, F_NOT_QUEUED);
+  g_assert_cmpint (dest->num_events, ==, 2);
+  ev = &dest->events[0];
+  g_assert_cmpuint (ev->raw_buffer_sz, ==, 3);
+  g_assert_true (
+    midi_is_note_on (ev->raw_buffer));
+  ev = &dest->events[1];
+  g_assert_cmpuint (ev->time, ==, 4);
+  g_assert_cmpmem (
+    midi_events_get_event_data (dest, ev),
+    ev->raw_buffer_sz, sysex, sizeof (sysex));
+
+  midi_events_free (src);
+  midi_events_free (dest);
+}
+
+static void
+test_queue (void)
+{
+  MidiEvents * events = midi_events_new ();
+
+  midi_byte_t sysex[] = {
+    0xF0, 0x43, 0x10, 0x4C, 0xF7 };
+  midi_events_add_note_on (
+    events, 1, 64, 100, 8, F_QUEUED);
+  midi_events_add_raw (
+    events, sysex, sizeof (sysex), 3, F_QUEUED);
+  midi_events_add_note_off (
+    events, 1, 64, 1, F_NOT_QUEUED);
+  g_assert_cmpint (events->num_events, ==, 1);
+
+  /* queued events are appended in order */
+  midi_events_dequeue (events);
+  g_assert_cmpint (events->num_events, ==, 3);
+  g_assert_true (
+    midi_is_note_off (events->events[0].raw_buffer));
+  g_assert_cmpuint (events->events[1].time, ==, 3);
+  g_assert_cmpmem (
+    midi_events_get_event_data (
+      events, &events->events[1]),
+    events->events[1].raw_buffer_sz,
+    sysex, sizeof (sysex));
+  g_assert_true (
+    midi_is_note_on (events->events[2].raw_buffer));
+
+  /* nothing left in the queue */
+  midi_events_dequeue (events);
+  g_assert_cmpint (events->num_events, ==, 3);
+
+  midi_events_free (events);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -64,6 +237,18 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test add note ons",
     (GTestFunc) test_add_note_ons);
+  g_test_add_func (
+    TEST_PREFIX "test full buffer",
+    (GTestFunc) test_full_buffer);
+  g_test_add_func (
+    TEST_PREFIX "test long data cleared",
+    (GTestFunc) test_long_data_cleared);
+  g_test_add_func (
+    TEST_PREFIX "test long messages",
+    (GTestFunc) test_long_messages);
+  g_test_add_func (
+    TEST_PREFIX "test queue",
+    (GTestFunc) test_queue);
 
   return g_test_run ();
 }
@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/midi_event.h"
+#include "audio/midi_note.h"
+#include "audio/midi_note_columns.h"
+#include "audio/midi_region.h"
+#include "audio/region.h"
+#include "audio/track.h"
+#include "audio/velocity.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/midi.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+
+#include <glib.h>
+
+#define NUM_NOTES 200
+
+static ZRegion *
+create_region (void)
+{
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+
+  Position p1, p2;
+  position_set_to_bar (&p1, 3);
+  position_set_to_bar (&p2, 103);
+  ZRegion * r =
+    midi_region_new (
+      &p1, &p2, track_get_name_hash (track), 0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  /* add the notes in reverse order, each lasting
+   * 1 bar, with a long note at the start */
+  for (int i = NUM_NOTES - 1; i >= 0; i--)
+    {
+      position_set_to_bar (&p1, 1 + i / 2);
+      position_set_to_bar (&p2, 2 + i / 2);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &p1, &p2, (uint8_t) (30 + i % 60),
+          (uint8_t) (40 + i % 80));
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+  position_set_to_bar (&p1, 1);
+  position_set_to_bar (&p2, 51);
+  MidiNote * mn =
+    midi_note_new (&r->id, &p1, &p2, 20, 100);
+  midi_region_add_midi_note (
+    r, mn, F_NO_PUBLISH_EVENTS);
+
+  return r;
+}
+
+/**
+ * Fills the events of a few frames around the
+ * start of the given bar of the region.
+ */
+static void
+fill_around_bar (
+  ZRegion *    r,
+  int          bar,
+  MidiEvents * events)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  Position pos;
+  position_set_to_bar (&pos, bar);
+  const EngineProcessTimeInfo nfo = {
+    .g_start_frame =
+      (unsigned_frame_t)
+      (r_obj->pos.frames + pos.frames - 100),
+    .local_offset = 10,
+    .nframes = 200, };
+  midi_events_clear (events, F_NOT_QUEUED);
+  midi_region_fill_midi_events (
+    r, &nfo, false, events);
+}
+
+/**
+ * Returns whether there is an event for the
+ * given note.
+ */
+static bool
+has_note (
+  MidiEvents * events,
+  midi_byte_t  pitch)
+{
+  for (int i = 0; i < events->num_events; i++)
+    {
+      if (midi_get_note_number (
+            events->events[i].raw_buffer) == pitch)
+        return true;
+    }
+
+  return false;
+}
+
+/**
+ * Checks that both lists contain the same events,
+ * in any order.
+ */
+static void
+check_same_events (
+  MidiEvents * a,
+  MidiEvents * b)
+{
+  g_assert_cmpint (a->num_events, ==, b->num_events);
+
+  bool * found =
+    object_new_n (
+      (size_t) MAX (b->num_events, 1), bool);
+  for (int i = 0; i < a->num_events; i++)
+    {
+      MidiEvent * ev_a = &a->events[i];
+      bool match = false;
+      for (int j = 0; j < b->num_events; j++)
+        {
+          MidiEvent * ev_b = &b->events[j];
+          if (!found[j]
+              && ev_a->time == ev_b->time
+              &&
+              memcmp (
+                ev_a->raw_buffer, ev_b->raw_buffer,
+                3) == 0)
+            {
+              found[j] = true;
+              match = true;
+              break;
+            }
+        }
+      g_assert_true (match);
+    }
+
+  free (found);
+}
+
+/**
+ * Checks that the columns produce the same events
+ * as the notes.
+ */
+static void
+check_region (
+  ZRegion *    r,
+  MidiEvents * events_from_notes,
+  MidiEvents * events_from_columns)
+{
+  MidiNoteColumns * columns = r->note_columns;
+  g_assert_nonnull (columns);
+  for (int bar = 1; bar <= 110; bar++)
+    {
+      r->note_columns = NULL;
+      fill_around_bar (r, bar, events_from_notes);
+      r->note_columns = columns;
+      fill_around_bar (r, bar, events_from_columns);
+      check_same_events (
+        events_from_notes, events_from_columns);
+    }
+}
+
+static void
+test_fill_events (void)
+{
+  test_helper_zrythm_init ();
+
+  ZRegion * r = create_region ();
+  MidiEvents * events_from_notes =
+    midi_events_new ();
+  MidiEvents * events_from_columns =
+    midi_events_new ();
+
+  g_assert_null (r->note_columns);
+  g_assert_true (
+    midi_region_update_note_columns (r));
+  MidiNoteColumns * columns = r->note_columns;
+  g_assert_cmpint (
+    columns->num_notes, ==, NUM_NOTES + 1);
+  for (int i = 1; i < columns->num_notes; i++)
+    {
+      g_assert_cmpint (
+        columns->start_frames[i - 1], <=,
+        columns->start_frames[i]);
+    }
+  check_region (
+    r, events_from_notes, events_from_columns);
+
+  /* mute a note and change another one */
+  arranger_object_set_muted (
+    (ArrangerObject *) r->midi_notes[3], true,
+    F_NO_PUBLISH_EVENTS);
+  MidiNote * mn = r->midi_notes[10];
+  mn->vel->vel = 5;
+  midi_note_set_val (mn, 110);
+  g_assert_true (
+    midi_region_update_note_columns (r));
+  check_region (
+    r, events_from_notes, events_from_columns);
+
+  midi_events_free (events_from_notes);
+  midi_events_free (events_from_columns);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_update (void)
+{
+  test_helper_zrythm_init ();
+
+  ZRegion * r = create_region ();
+  MidiEvents * events = midi_events_new ();
+
+  g_assert_true (
+    midi_region_update_note_columns (r));
+  MidiNoteColumns * columns = r->note_columns;
+
+  /* no changes */
+  g_assert_false (
+    midi_region_update_note_columns (r));
+  g_assert_true (r->note_columns == columns);
+
+  /* outdated columns are not played */
+  MidiNote * mn = r->midi_notes[0];
+  ArrangerObject * mn_obj = (ArrangerObject *) mn;
+  uint8_t prev_val = mn->val;
+  midi_note_set_val (mn, 120);
+  g_assert_false (
+    midi_note_columns_is_up_to_date (
+      r->note_columns, r));
+  fill_around_bar (r, 101, events);
+  g_assert_false (has_note (events, prev_val));
+  g_assert_true (has_note (events, 120));
+  g_assert_true (
+    midi_region_update_note_columns (r));
+  fill_around_bar (r, 101, events);
+  g_assert_false (has_note (events, prev_val));
+  g_assert_true (has_note (events, 120));
+
+  /* moving a note is noticed */
+  Position pos;
+  position_set_to_bar (&pos, 150);
+  arranger_object_set_position (
+    mn_obj, &pos,
+    ARRANGER_OBJECT_POSITION_TYPE_END,
+    F_NO_VALIDATE);
+  g_assert_true (
+    midi_region_update_note_columns (r));
+
+  /* muted notes are left out */
+  arranger_object_set_muted (
+    mn_obj, true, F_NO_PUBLISH_EVENTS);
+  g_assert_true (
+    midi_region_update_note_columns (r));
+  g_assert_cmpint (
+    r->note_columns->num_notes, ==,
+    r->num_midi_notes - 1);
+  arranger_object_set_muted (
+    mn_obj, false, F_NO_PUBLISH_EVENTS);
+  g_assert_true (
+    midi_region_update_note_columns (r));
+
+  /* removing notes without publishing events is
+   * noticed */
+  midi_region_remove_midi_note (
+    r, mn, F_FREE, F_NO_PUBLISH_EVENTS);
+  g_assert_false (
+    midi_note_columns_is_up_to_date (
+      r->note_columns, r));
+  g_assert_true (
+    midi_region_update_note_columns (r));
+  g_assert_cmpint (
+    r->note_columns->num_notes, ==,
+    r->num_midi_notes);
+
+  /* columns for other positions are not
+   * played */
+  g_atomic_int_set (&r->children_epoch, -2);
+  g_assert_false (
+    midi_note_columns_is_up_to_date (
+      r->note_columns, r));
+
+  midi_events_free (events);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/midi_note_columns/"
+
+  g_test_add_func (
+    TEST_PREFIX "test fill events",
+    (GTestFunc) test_fill_events);
+  g_test_add_func (
+    TEST_PREFIX "test update",
+    (GTestFunc) test_update);
+
+  return g_test_run ();
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/midi_note.h"
+#include "audio/midi_note_index.h"
+#include "audio/midi_region.h"
+#include "audio/region.h"
+#include "audio/track.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+
+#include <glib.h>
+
+#define NUM_NOTES 200
+
+static ZRegion *
+create_region (void)
+{
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+
+  Position p1, p2;
+  position_set_to_bar (&p1, 3);
+  position_set_to_bar (&p2, 103);
+  ZRegion * r =
+    midi_region_new (
+      &p1, &p2, track_get_name_hash (track), 0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  /* add the notes in reverse order, each lasting
+   * 1 bar, with a long note at the start */
+  for (int i = NUM_NOTES - 1; i >= 0; i--)
+    {
+      position_set_to_bar (&p1, 1 + i / 2);
+      position_set_to_bar (&p2, 2 + i / 2);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &p1, &p2, (uint8_t) (30 + i % 60),
+          100);
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+  position_set_to_bar (&p1, 1);
+  position_set_to_bar (&p2, 51);
+  MidiNote * mn =
+    midi_note_new (&r->id, &p1, &p2, 20, 100);
+  midi_region_add_midi_note (
+    r, mn, F_NO_PUBLISH_EVENTS);
+
+  return r;
+}
+
+/**
+ * Checks that the notes found in the range are
+ * exactly the notes that overlap with it.
+ */
+static void
+check_range (
+  ZRegion * r,
+  double    start_ticks,
+  double    end_ticks)
+{
+  MidiNoteIndex * index =
+    midi_region_get_note_index (r);
+  int num_found =
+    midi_note_index_find (
+      index, start_ticks, end_ticks);
+  for (int i = 0; i < num_found; i++)
+    {
+      MidiNote * mn =
+        midi_note_index_get_note (
+          index, index->found[i]);
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) mn;
+      g_assert_cmpfloat (
+        mn_obj->pos.ticks, <=, end_ticks);
+      g_assert_cmpfloat (
+        mn_obj->end_pos.ticks, >=, start_ticks);
+
+      /* in order of start position */
+      if (i > 0)
+        {
+          g_assert_cmpint (
+            index->found[i - 1], <,
+            index->found[i]);
+        }
+    }
+
+  int num_expected = 0;
+  for (int i = 0; i < r->num_midi_notes; i++)
+    {
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) r->midi_notes[i];
+      if (mn_obj->pos.ticks <= end_ticks
+          && mn_obj->end_pos.ticks >= start_ticks)
+        num_expected++;
+    }
+  g_assert_cmpint (num_found, ==, num_expected);
+}
+
+static void
+test_find (void)
+{
+  test_helper_zrythm_init ();
+
+  ZRegion * r = create_region ();
+  MidiNoteIndex * index =
+    midi_region_get_note_index (r);
+  g_assert_cmpint (
+    index->num_notes, ==, NUM_NOTES + 1);
+  g_assert_cmpuint (index->min_val, ==, 20);
+  g_assert_cmpuint (index->max_val, ==, 89);
+
+  /* notes are sorted by start position */
+  for (int i = 1; i < index->num_notes; i++)
+    {
+      ArrangerObject * prev =
+        (ArrangerObject *)
+        midi_note_index_get_note (index, i - 1);
+      ArrangerObject * cur =
+        (ArrangerObject *)
+        midi_note_index_get_note (index, i);
+      g_assert_cmpfloat (
+        prev->pos.ticks, <=, cur->pos.ticks);
+    }
+
+  Position pos;
+  position_set_to_bar (&pos, 2);
+  double bar_ticks = pos.ticks;
+  check_range (r, 0.0, 0.0);
+  check_range (r, bar_ticks * 10.5, bar_ticks * 10.5);
+  check_range (r, bar_ticks * 20, bar_ticks * 40);
+  check_range (r, bar_ticks * 60, bar_ticks * 70);
+  check_range (r, bar_ticks * 200, bar_ticks * 300);
+  check_range (r, - bar_ticks, - 1.0);
+
+  /* only the notes in the range are returned */
+  g_assert_cmpint (
+    midi_note_index_find (
+      index, bar_ticks * 60.5, bar_ticks * 60.5),
+    ==, 2);
+  g_assert_cmpint (
+    midi_note_index_find (
+      index, bar_ticks * 10.5, bar_ticks * 10.5),
+    ==, 3);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_update (void)
+{
+  test_helper_zrythm_init ();
+
+  ZRegion * r = create_region ();
+  MidiNoteIndex * index =
+    midi_region_get_note_index (r);
+  gint notes_version = r->notes_version;
+  g_assert_cmpint (
+    index->notes_version, ==, notes_version);
+
+  /* no changes */
+  g_assert_false (
+    midi_note_index_update (index, r));
+
+  /* moving a note rebuilds the index */
+  MidiNote * mn = r->midi_notes[0];
+  ArrangerObject * mn_obj = (ArrangerObject *) mn;
+  Position pos;
+  position_set_to_bar (&pos, 150);
+  arranger_object_set_position (
+    mn_obj, &pos,
+    ARRANGER_OBJECT_POSITION_TYPE_END,
+    F_NO_VALIDATE);
+  g_assert_cmpint (
+    r->notes_version, !=, notes_version);
+  g_assert_true (
+    midi_note_index_update (index, r));
+  g_assert_false (
+    midi_note_index_update (index, r));
+  check_range (
+    r, mn_obj->end_pos.ticks - 1.0,
+    mn_obj->end_pos.ticks - 1.0);
+
+  /* muting a note changes the notes version */
+  notes_version = r->notes_version;
+  arranger_object_set_muted (
+    mn_obj, true, F_NO_PUBLISH_EVENTS);
+  g_assert_cmpint (
+    r->notes_version, !=, notes_version);
+  g_assert_true (
+    midi_note_index_update (index, r));
+
+  /* changing the pitch rebuilds the index */
+  midi_note_set_val (mn, 100);
+  g_assert_true (
+    midi_note_index_update (index, r));
+  g_assert_cmpuint (index->max_val, ==, 100);
+
+  /* changing a clone does nothing */
+  notes_version = r->notes_version;
+  MidiNote * clone =
+    (MidiNote *)
+    arranger_object_clone (
+      (ArrangerObject *) r->midi_notes[1]);
+  midi_note_set_val (clone, 10);
+  g_assert_cmpint (
+    r->notes_version, ==, notes_version);
+  arranger_object_free ((ArrangerObject *) clone);
+
+  /* adding/removing notes rebuilds the index */
+  midi_region_remove_midi_note (
+    r, mn, F_FREE, F_NO_PUBLISH_EVENTS);
+  g_assert_true (
+    midi_note_index_update (index, r));
+  g_assert_cmpint (
+    index->num_notes, ==, r->num_midi_notes);
+  g_assert_cmpuint (index->max_val, ==, 89);
+  check_range (r, 0.0, 1.0e9);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/midi_note_index/"
+
+  g_test_add_func (
+    TEST_PREFIX "test find",
+    (GTestFunc) test_find);
+  g_test_add_func (
+    TEST_PREFIX "test update",
+    (GTestFunc) test_update);
+
+  return g_test_run ();
+}
@@ -20,12 +20,22 @@
 #include "zrythm-test-config.h"
 
 #include "actions/tracklist_selections.h"
+#include "audio/automation_point.h"
+#include "audio/automation_region.h"
+#include "audio/automation_track.h"
+#include "audio/control_port.h"
+#include "audio/engine.h"
+#include "audio/midi_file.h"
+#include "audio/midi_note.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
+#include "audio/tempo_map.h"
+#include "audio/tempo_track.h"
 #include "audio/transport.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "utils/io.h"
+#include "utils/math.h"
 #include "zrythm.h"
 
 #include "tests/helpers/zrythm.h"
@@ -102,6 +112,123 @@ test_export (void)
   io_rmdir (export_dir, true);
 }
 
+static void
+test_import_with_tempo_automation (void)
+{
+  test_helper_zrythm_init ();
+
+  /* ramp from 120 to 240 BPM between bars 1 and
+   * 9 */
+  Port * port = P_TEMPO_TRACK->bpm_port;
+  AutomationTrack * at =
+    automation_track_find_from_port (
+      port, P_TEMPO_TRACK, false);
+  g_assert_nonnull (at);
+  Position pos, end_pos;
+  position_set_to_bar (&pos, 1);
+  position_set_to_bar (&end_pos, 17);
+  ZRegion * automation_r =
+    automation_region_new (
+      &pos, &end_pos,
+      track_get_name_hash (P_TEMPO_TRACK),
+      at->index, 0);
+  track_add_region (
+    P_TEMPO_TRACK, automation_r, at, 0,
+    F_GEN_NAME, F_NO_PUBLISH_EVENTS);
+  AutomationPoint * ap =
+    automation_point_new_float (
+      120.f,
+      control_port_real_val_to_normalized (
+        port, 120.f),
+      &pos);
+  automation_region_add_ap (
+    automation_r, ap, F_NO_PUBLISH_EVENTS);
+  position_set_to_bar (&pos, 9);
+  ap =
+    automation_point_new_float (
+      240.f,
+      control_port_real_val_to_normalized (
+        port, 240.f),
+      &pos);
+  automation_region_add_ap (
+    automation_r, ap, F_NO_PUBLISH_EVENTS);
+  engine_update_tempo_map (AUDIO_ENGINE);
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  g_assert_true (tempo_map_is_automated (map));
+
+  /* import a track starting in the middle of the
+   * ramp */
+  double ticks_per_bar =
+    (double) TRANSPORT->ticks_per_bar;
+  MidiFileNote notes[4];
+  for (int i = 0; i < 4; i++)
+    {
+      notes[i].start_ticks = i * ticks_per_bar;
+      notes[i].end_ticks =
+        (i + 1) * ticks_per_bar - 10.0;
+      notes[i].pitch = (uint8_t) (60 + i);
+      notes[i].vel = 100;
+    }
+  MidiFileTrack mf_track = {
+    .has_data = true,
+    .notes = notes,
+    .num_notes = 4,
+    .notes_size = 4,
+    .end_ticks = 4 * ticks_per_bar,
+    .last_ticks = 4 * ticks_per_bar,
+  };
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+  position_set_to_bar (&pos, 5);
+  ZRegion * r =
+    midi_region_new_from_midi_file_track (
+      &pos, &mf_track, track_get_name_hash (track),
+      0, 0);
+  g_assert_nonnull (r);
+  g_assert_cmpint (r->num_midi_notes, ==, 4);
+
+  /* the note frames are relative to the region
+   * start */
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  g_assert_cmpint (
+    r->children_epoch, ==,
+    tempo_map_get_epoch (map));
+  for (int i = 0; i < r->num_midi_notes; i++)
+    {
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) r->midi_notes[i];
+      g_assert_cmpint (
+        mn_obj->pos.frames, ==,
+        math_round_double_to_signed_frame_t (
+          tempo_map_local_ticks_to_frames (
+            map, r_obj->pos.ticks,
+            notes[i].start_ticks)));
+      g_assert_cmpint (
+        mn_obj->end_pos.frames, ==,
+        math_round_double_to_signed_frame_t (
+          tempo_map_local_ticks_to_frames (
+            map, r_obj->pos.ticks,
+            notes[i].end_ticks)));
+    }
+
+  /* the tempo is faster than at the start of the
+   * song, so the notes are shorter than with
+   * global frames */
+  ArrangerObject * mn_obj =
+    (ArrangerObject *) r->midi_notes[3];
+  position_from_ticks (
+    &end_pos, notes[3].end_ticks);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, <, end_pos.frames);
+
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -112,6 +239,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test export",
     (GTestFunc) test_export);
+  g_test_add_func (
+    TEST_PREFIX "test import with tempo automation",
+    (GTestFunc) test_import_with_tempo_automation);
 
   return g_test_run ();
 }
@@ -132,8 +132,8 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 1);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 1);
+  ev = &events->events[0];
   g_assert_nonnull (ev);
   g_assert_cmpuint (
     midi_get_channel_1_to_16 (ev->raw_buffer),
@@ -145,7 +145,7 @@ test_fill_midi_events (void)
     midi_get_velocity (ev->raw_buffer), ==, vel1);
   g_assert_cmpint (
     (long) ev->time, ==, pos.frames);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /*
    * Start: region start + 1
@@ -161,7 +161,7 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 0);
+    events->num_events, ==, 0);
 
   /*
    * Start: region start
@@ -177,8 +177,8 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 1);
-  midi_events_clear (events, F_QUEUED);
+    events->num_events, ==, 1);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /*
    * Start: region start + BUFFER_SIZE
@@ -194,7 +194,7 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 0);
+    events->num_events, ==, 0);
 
   /*
    * Start: region end - (BUFFER_SIZE + 1)
@@ -213,7 +213,7 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 0);
+    events->num_events, ==, 0);
 
   /*
    * Start: region end - BUFFER_SIZE
@@ -232,18 +232,18 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 2);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 2);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, BUFFER_SIZE - 1);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, BUFFER_SIZE - 1);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /*
    * Start: midi end - BUFFER_SIZE
@@ -267,13 +267,13 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 1);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 1);
+  ev = &events->events[0];
   g_assert_cmpuint (
     ev->time, ==, BUFFER_SIZE - 1);
   position_set_to_pos (
     &mn_obj->end_pos, &r_obj->end_pos);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /*
    * Start: (midi end - BUFFER_SIZE) + 1
@@ -296,13 +296,13 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 1);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 1);
+  ev = &events->events[0];
   g_assert_cmpuint (
     ev->time, ==, BUFFER_SIZE - 2);
   position_set_to_pos (
     &mn_obj->end_pos, &r_obj->end_pos);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /*
    * Start: region end - (BUFFER_SIZE - 1)
@@ -321,18 +321,18 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 2);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 2);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, BUFFER_SIZE - 2);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, BUFFER_SIZE - 2);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /*
    * Initialization
@@ -378,7 +378,7 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 0);
+    events->num_events, ==, 0);
 
   /*
    * Initialization
@@ -430,17 +430,17 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 2);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 2);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 364);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_note_on (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, 365);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /* -- REGION LOOP TESTS -- */
 
@@ -488,7 +488,7 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 0);
+    events->num_events, ==, 0);
   position_add_ticks (
     &mn_obj->pos, 1);
   position_update_frames_from_ticks (&mn_obj->pos);
@@ -509,7 +509,7 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 0);
+    events->num_events, ==, 0);
 
   /**
    * Start: frame after region end
@@ -527,7 +527,7 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 0);
+    events->num_events, ==, 0);
 
   /**
    * Start: before region start
@@ -545,11 +545,11 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 1);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 1);
+  ev = &events->events[0];
   g_assert_cmpuint (
     ev->time, ==, 10);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /**
    * Start: before region start
@@ -567,11 +567,11 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 1);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 1);
+  ev = &events->events[0];
   g_assert_cmpuint (
     ev->time, ==, 10);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /*
    * Initialization
@@ -621,23 +621,23 @@ test_fill_midi_events (void)
   track_fill_events (
     track, &time_nfo, events, NULL);
   g_assert_cmpint (
-    events->num_queued_events, ==, 3);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 3);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, 9);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, 9);
-  ev = &events->queued_events[2];
+  ev = &events->events[2];
   g_assert_true (
     midi_is_note_on (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, 10);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /**
    * Premise: note ends on region end (no loops).
@@ -665,20 +665,20 @@ test_fill_midi_events (void)
   time_nfo.nframes = BUFFER_SIZE;
   track_fill_events (
     track, &time_nfo, events, NULL);
-  midi_events_print (events, F_QUEUED);
+  midi_events_print (events, F_NOT_QUEUED);
   g_assert_cmpint (
-    events->num_queued_events, ==, 2);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 2);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, 9);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (
     ev->time, ==, 9);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /**
    * Premise:
@@ -712,14 +712,14 @@ test_fill_midi_events (void)
   time_nfo.nframes = BUFFER_SIZE;
   track_fill_events (
     track, &time_nfo, events, NULL);
-  midi_events_print (events, F_QUEUED);
+  midi_events_print (events, F_NOT_QUEUED);
   g_assert_cmpint (
-    events->num_queued_events, ==, 1);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 1);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_on (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 0);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /**
    * Premise: note starts at 1.1.1.0 and ends right
@@ -752,18 +752,18 @@ test_fill_midi_events (void)
   time_nfo.nframes = 30;
   track_fill_events (
     track, &time_nfo, events, NULL);
-  midi_events_print (events, F_QUEUED);
+  midi_events_print (events, F_NOT_QUEUED);
   g_assert_cmpint (
-    events->num_queued_events, ==, 2);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 2);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_off (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 9);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 29);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   position_set_to_pos (
     &pos, &TRANSPORT->loop_start_pos);
@@ -772,11 +772,11 @@ test_fill_midi_events (void)
   time_nfo.nframes = 10;
   track_fill_events (
     track, &time_nfo, events, NULL);
-  ev = &events->queued_events[0];
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_on (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 0);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /**
    *
@@ -810,18 +810,18 @@ test_fill_midi_events (void)
   time_nfo.nframes = 50;
   track_fill_events (
     track, &time_nfo, events, NULL);
-  midi_events_print (events, F_QUEUED);
+  midi_events_print (events, F_NOT_QUEUED);
   g_assert_cmpint (
-    events->num_queued_events, ==, 2);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 2);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_note_on (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 10);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 39);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   /**
    * Premise: region loops back near the end.
@@ -854,22 +854,22 @@ test_fill_midi_events (void)
   time_nfo.nframes = 50;
   track_fill_events (
     track, &time_nfo, events, NULL);
-  midi_events_print (events, F_QUEUED);
+  midi_events_print (events, F_NOT_QUEUED);
   g_assert_cmpint (
-    events->num_queued_events, ==, 3);
-  ev = &events->queued_events[0];
+    events->num_events, ==, 3);
+  ev = &events->events[0];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 4);
-  ev = &events->queued_events[1];
+  ev = &events->events[1];
   g_assert_true (
     midi_is_note_on (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 5);
-  ev = &events->queued_events[2];
+  ev = &events->events[2];
   g_assert_true (
     midi_is_all_notes_off (ev->raw_buffer));
   g_assert_cmpuint (ev->time, ==, 14);
-  midi_events_clear (events, F_QUEUED);
+  midi_events_clear (events, F_NOT_QUEUED);
 
   test_helper_zrythm_cleanup ();
 }
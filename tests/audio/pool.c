@@ -19,10 +19,17 @@
 
 #include "zrythm-test-config.h"
 
+#include "audio/audio_region.h"
+#include "audio/clip_cache.h"
+#include "audio/pool.h"
 #include "audio/track.h"
 #include "audio/tempo_track.h"
 #include "project.h"
+#include "utils/audio.h"
+#include "utils/dsp.h"
 #include "utils/flags.h"
+#include "utils/io.h"
+#include "utils/objects.h"
 #include "zrythm.h"
 
 #include "helpers/plugin_manager.h"
@@ -141,6 +148,292 @@ test_remove_unused (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_clip_blocks (void)
+{
+  test_helper_zrythm_init ();
+
+  /* create 2 clips that only differ in the
+   * last block */
+  unsigned_frame_t nframes =
+    AUDIO_CLIP_BLOCK_FRAMES * 3 + 100;
+  channels_t channels = 2;
+  size_t num_samples =
+    (size_t) nframes * channels;
+  float * frames =
+    object_new_n (num_samples, float);
+  for (size_t i = 0; i < num_samples; i++)
+    {
+      frames[i] = (float) (i % 1000) / 1000.f;
+    }
+  AudioClip * clip1 =
+    audio_clip_new_from_float_array (
+      frames, nframes, channels, BIT_DEPTH_32,
+      "clip1");
+  frames[num_samples - 1] = 1.f;
+  AudioClip * clip2 =
+    audio_clip_new_from_float_array (
+      frames, nframes, channels, BIT_DEPTH_32,
+      "clip2");
+
+  AudioClipBlockStore * store =
+    AUDIO_POOL->block_store;
+  size_t block_bytes =
+    AUDIO_CLIP_BLOCK_FRAMES * channels
+    * sizeof (float);
+  size_t last_block_bytes =
+    100 * channels * sizeof (float);
+  audio_clip_move_frames_to_blocks (clip1, store);
+  g_assert_null (clip1->frames);
+  g_assert_cmpuint (clip1->num_blocks, ==, 4);
+  g_assert_cmpuint (store->num_blocks, ==, 4);
+  audio_clip_move_frames_to_blocks (clip2, store);
+  g_assert_cmpuint (store->num_blocks, ==, 5);
+  g_assert_cmpuint (
+    store->allocated_bytes, ==,
+    3 * block_bytes + 2 * last_block_bytes);
+  g_assert_cmpuint (
+    store->referenced_bytes, ==,
+    2 * (3 * block_bytes + last_block_bytes));
+
+  /* check that the data is intact */
+  float * copied =
+    object_new_n (num_samples, float);
+  audio_clip_copy_frames (
+    clip2, copied, 0, nframes);
+  g_assert_true (
+    audio_frames_equal (
+      copied, frames, num_samples, 0.0001f));
+  audio_clip_load_frames_from_blocks (clip2);
+  g_assert_nonnull (clip2->frames);
+  g_assert_null (clip2->blocks);
+  g_assert_true (
+    audio_frames_equal (
+      clip2->frames, frames, num_samples, 0.0001f));
+  g_assert_cmpuint (store->num_blocks, ==, 4);
+
+  audio_clip_free (clip1);
+  g_assert_cmpuint (store->num_blocks, ==, 0);
+  g_assert_cmpuint (store->allocated_bytes, ==, 0);
+  audio_clip_free (clip2);
+  free (frames);
+  free (copied);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_load_clips_in_parallel (void)
+{
+  test_helper_zrythm_init ();
+
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR,
+      "test_start_with_signal.mp3", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  for (int i = 0; i < 6; i++)
+    {
+      track_create_with_action (
+        TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD,
+        TRACKLIST->num_tracks, 1, NULL);
+    }
+  int num_clips = AUDIO_POOL->num_clips;
+  g_assert_cmpint (num_clips, ==, 6);
+
+  /* the first reload decodes the clips and fills
+   * the cache */
+  test_project_save_and_reload ();
+  g_assert_cmpint (
+    AUDIO_POOL->num_clips, ==, num_clips);
+  AudioClip * clip = AUDIO_POOL->clips[0];
+  g_assert_nonnull (clip->frames);
+  g_assert_cmpuint (clip->num_frames, >, 0);
+  unsigned_frame_t num_frames = clip->num_frames;
+  channels_t channels = clip->channels;
+  size_t num_samples =
+    (size_t) num_frames * channels;
+  float * frames =
+    object_new_n (num_samples, float);
+  dsp_copy (frames, clip->frames, num_samples);
+
+  char * cache_dir = audio_clip_cache_get_dir ();
+  char ** entries =
+    io_get_files_in_dir_ending_in (
+      cache_dir, false, ".zclip", false);
+  g_assert_nonnull (entries);
+  g_assert_nonnull (entries[0]);
+  g_strfreev (entries);
+
+  /* the second reload uses the cache and must
+   * produce the same frames */
+  test_project_save_and_reload ();
+  for (int i = 0; i < num_clips; i++)
+    {
+      clip = AUDIO_POOL->clips[i];
+      g_assert_nonnull (clip);
+      g_assert_cmpuint (
+        clip->num_frames, ==, num_frames);
+      g_assert_cmpuint (clip->channels, ==, channels);
+      g_assert_true (
+        audio_frames_equal (
+          clip->frames, frames, num_samples,
+          0.0001f));
+      g_assert_nonnull (
+        clip->ch_frames[channels - 1]);
+    }
+
+  /* decoding without the cache must match the
+   * cached frames */
+  char * clip_path =
+    audio_clip_get_path_in_pool (
+      AUDIO_POOL->clips[0], F_NOT_BACKUP);
+  AudioClip * decoded =
+    audio_clip_new_from_float_array (
+      frames, 1, channels, BIT_DEPTH_32,
+      "decoded");
+  audio_clip_load_frames_from_file (
+    decoded, clip_path,
+    (int) AUDIO_ENGINE->sample_rate, NULL);
+  g_assert_cmpuint (
+    decoded->num_frames, ==, num_frames);
+  g_assert_true (
+    audio_frames_equal (
+      decoded->frames, frames, num_samples,
+      0.0001f));
+  audio_clip_free (decoded);
+
+  /* pruning to 0 bytes empties the cache */
+  audio_clip_cache_prune (cache_dir, 0);
+  entries =
+    io_get_files_in_dir_ending_in (
+      cache_dir, false, ".zclip", false);
+  g_assert_true (!entries || !entries[0]);
+  g_strfreev (entries);
+
+  g_free (clip_path);
+  g_free (cache_dir);
+  free (frames);
+  g_free (filepath);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_skip_unchanged_files (void)
+{
+  test_helper_zrythm_init ();
+
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR,
+      "test_start_with_signal.mp3", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD,
+    TRACKLIST->num_tracks, 1, NULL);
+  AudioClip * clip = AUDIO_POOL->clips[0];
+  g_assert_nonnull (clip);
+  g_assert_nonnull (clip->file_hash);
+  g_assert_false (clip->frames_dirty);
+  g_assert_cmpint (clip->file_size, >, 0);
+  char * hash = g_strdup (clip->file_hash);
+  gint64 size = clip->file_size;
+  gint64 mtime = clip->file_mtime;
+
+  /* unchanged files are not written again */
+  audio_pool_write_to_disk (
+    AUDIO_POOL, F_NOT_BACKUP);
+  g_assert_cmpint (clip->file_mtime, ==, mtime);
+
+  /* the file info survives reloading */
+  test_project_save_and_reload ();
+  clip = AUDIO_POOL->clips[0];
+  g_assert_cmpstr (clip->file_hash, ==, hash);
+  g_assert_cmpint (clip->file_size, ==, size);
+  g_assert_cmpint (clip->file_mtime, ==, mtime);
+
+  /* files changed on disk are written again */
+  char * clip_path =
+    audio_clip_get_path_in_pool (
+      clip, F_NOT_BACKUP);
+  g_assert_true (
+    g_file_set_contents (
+      clip_path, "abc", -1, NULL));
+  audio_pool_write_to_disk (
+    AUDIO_POOL, F_NOT_BACKUP);
+  g_assert_cmpint (clip->file_size, >, 3);
+  g_assert_cmpint (clip->file_mtime, !=, mtime);
+  mtime = clip->file_mtime;
+  audio_pool_write_to_disk (
+    AUDIO_POOL, F_NOT_BACKUP);
+  g_assert_cmpint (clip->file_mtime, ==, mtime);
+
+  g_free (clip_path);
+  g_free (hash);
+  g_free (filepath);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_edit_frames_and_reload (void)
+{
+  test_helper_zrythm_init ();
+
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR,
+      "test_start_with_signal.mp3", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD,
+    TRACKLIST->num_tracks, 1, NULL);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  ZRegion * r = track->lanes[0]->regions[0];
+  AudioClip * clip = audio_region_get_clip (r);
+  g_assert_nonnull (clip);
+  g_assert_false (clip->frames_dirty);
+  char * hash = g_strdup (clip->file_hash);
+
+  /* edit the frames in place */
+  const unsigned_frame_t num_frames = 1000;
+  size_t num_samples =
+    (size_t) num_frames * clip->channels;
+  float * frames =
+    object_new_n (num_samples, float);
+  dsp_fill (frames, 0.5f, num_samples);
+  audio_region_replace_frames (
+    r, frames, 0, num_frames,
+    F_NO_DUPLICATE_CLIP);
+
+  /* the edited frames are written to the pool */
+  g_assert_false (clip->frames_dirty);
+  g_assert_cmpstr (clip->file_hash, !=, hash);
+
+  /* and survive reloading */
+  test_project_save_and_reload ();
+  track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  r = track->lanes[0]->regions[0];
+  clip = audio_region_get_clip (r);
+  g_assert_nonnull (clip);
+  g_assert_true (
+    audio_frames_equal (
+      clip->frames, frames, num_samples,
+      0.0001f));
+
+  free (frames);
+  g_free (hash);
+  g_free (filepath);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -151,6 +444,18 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test remove unused",
     (GTestFunc) test_remove_unused);
+  g_test_add_func (
+    TEST_PREFIX "test clip blocks",
+    (GTestFunc) test_clip_blocks);
+  g_test_add_func (
+    TEST_PREFIX "test load clips in parallel",
+    (GTestFunc) test_load_clips_in_parallel);
+  g_test_add_func (
+    TEST_PREFIX "test skip unchanged files",
+    (GTestFunc) test_skip_unchanged_files);
+  g_test_add_func (
+    TEST_PREFIX "test edit frames and reload",
+    (GTestFunc) test_edit_frames_and_reload);
 
   return g_test_run ();
 }
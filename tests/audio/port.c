@@ -20,6 +20,9 @@
 #include "zrythm-test-config.h"
 
 #include "actions/tracklist_selections.h"
+#include "audio/engine.h"
+#include "audio/master_track.h"
+#include "audio/meter.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
 #include "audio/transport.h"
@@ -31,6 +34,8 @@
 #include "tests/helpers/project.h"
 #include "tests/helpers/zrythm.h"
 
+#include "zix/ring.h"
+
 #if 0
 static void
 test_port_disconnect (void)
@@ -203,6 +208,80 @@ test_get_hash (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_observers (void)
+{
+  test_helper_zrythm_init ();
+
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (20000);
+
+  Port * port =
+    P_MASTER_TRACK->channel->stereo_out->l;
+  size_t block_size =
+    sizeof (float) * AUDIO_ENGINE->block_length;
+
+  /* nothing is published without observers */
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_false (port_is_observed (port));
+  g_assert_null (port->audio_ring);
+
+  port_add_observer (port);
+  g_assert_true (port_is_observed (port));
+  g_assert_nonnull (port->audio_ring);
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_cmpuint (
+    zix_ring_read_space (port->audio_ring), ==,
+    block_size);
+
+  port_remove_observer (port);
+  g_assert_false (port_is_observed (port));
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_cmpuint (
+    zix_ring_read_space (port->audio_ring), ==,
+    block_size);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_meter_outlives_port (void)
+{
+  test_helper_zrythm_init ();
+
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (20000);
+
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_AUDIO, NULL);
+  Port * port = track->channel->stereo_out->l;
+
+  Meter * meter = meter_new_for_port (port);
+  g_assert_false (port_is_observed (port));
+  meter_set_observing (meter, true);
+  g_assert_true (port_is_observed (port));
+  g_assert_true (
+    port_is_alive (&meter->port_id, port));
+
+  /* remove the track before the meter
+   * unsubscribes */
+  tracklist_remove_track (
+    TRACKLIST, track, F_REMOVE_PL, F_FREE,
+    F_NO_PUBLISH_EVENTS, F_NO_RECALC_GRAPH);
+  g_assert_false (
+    port_is_alive (&meter->port_id, port));
+
+  /* must not touch the free'd port */
+  meter_set_observing (meter, false);
+  meter_free (meter);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -213,6 +292,12 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test get hash",
     (GTestFunc) test_get_hash);
+  g_test_add_func (
+    TEST_PREFIX "test observers",
+    (GTestFunc) test_observers);
+  g_test_add_func (
+    TEST_PREFIX "test meter outlives port",
+    (GTestFunc) test_meter_outlives_port);
 #if 0
   g_test_add_func (
     TEST_PREFIX "test port disconnect",
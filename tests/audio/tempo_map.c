@@ -0,0 +1,430 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/automation_point.h"
+#include "audio/automation_region.h"
+#include "audio/automation_track.h"
+#include "audio/control_port.h"
+#include "audio/engine.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "audio/region.h"
+#include "audio/tempo_map.h"
+#include "audio/tempo_track.h"
+#include "audio/transport.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/math.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+
+#include <glib.h>
+
+static void
+test_constant_tempo (void)
+{
+  test_helper_zrythm_init ();
+
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  g_assert_true (tempo_map_is_ready (map));
+  g_assert_false (tempo_map_is_automated (map));
+
+  /* conversions must match the frames per tick
+   * of the current BPM */
+  for (double ticks = -3840.0; ticks < 400000.0;
+       ticks += 1234.567)
+    {
+      Position pos;
+      position_from_ticks (&pos, ticks);
+      g_assert_cmpint (
+        pos.frames, ==,
+        math_round_double_to_signed_frame_t (
+          ticks * AUDIO_ENGINE->frames_per_tick));
+
+      position_from_frames (&pos, pos.frames);
+      g_assert_cmpfloat_with_epsilon (
+        pos.ticks,
+        (double) pos.frames *
+          AUDIO_ENGINE->ticks_per_frame,
+        0.0000001);
+    }
+
+  Position pos;
+  position_set_to_bar (&pos, 3);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_track_get_bpm_at_pos (
+      P_TEMPO_TRACK, &pos),
+    tempo_track_get_current_bpm (P_TEMPO_TRACK),
+    0.0001f);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_automated_tempo (void)
+{
+  test_helper_zrythm_init ();
+
+  TempoMap * map = AUDIO_ENGINE->tempo_map;
+  Port * port = P_TEMPO_TRACK->bpm_port;
+  double ticks_per_bar =
+    (double) TRANSPORT->ticks_per_bar;
+  double fpt_before = AUDIO_ENGINE->frames_per_tick;
+  bpm_t bpm_before =
+    tempo_track_get_current_bpm (P_TEMPO_TRACK);
+
+  /* ramp from 120 to 240 BPM between bars 1 and
+   * 3, then stay at 240 BPM */
+  AutomationTrack * at =
+    automation_track_find_from_port (
+      port, P_TEMPO_TRACK, false);
+  g_assert_nonnull (at);
+  Position start, end;
+  position_set_to_bar (&start, 1);
+  position_set_to_bar (&end, 9);
+  ZRegion * r =
+    automation_region_new (
+      &start, &end,
+      track_get_name_hash (P_TEMPO_TRACK),
+      at->index, 0);
+  track_add_region (
+    P_TEMPO_TRACK, r, at, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  Position pos;
+  position_set_to_bar (&pos, 1);
+  AutomationPoint * ap =
+    automation_point_new_float (
+      120.f,
+      control_port_real_val_to_normalized (
+        port, 120.f),
+      &pos);
+  automation_region_add_ap (
+    r, ap, F_NO_PUBLISH_EVENTS);
+  position_set_to_bar (&pos, 3);
+  ap =
+    automation_point_new_float (
+      240.f,
+      control_port_real_val_to_normalized (
+        port, 240.f),
+      &pos);
+  automation_region_add_ap (
+    r, ap, F_NO_PUBLISH_EVENTS);
+
+  engine_update_tempo_map (AUDIO_ENGINE);
+  g_assert_true (tempo_map_is_automated (map));
+  g_assert_cmpint (
+    map->table->num_segments, >, 2);
+
+  /* the current BPM is unaffected */
+  g_assert_cmpfloat_with_epsilon (
+    AUDIO_ENGINE->frames_per_tick, fpt_before,
+    0.000001);
+
+  /* check the BPM at various positions */
+  position_set_to_bar (&pos, 1);
+  bpm_t bpm =
+    tempo_track_get_bpm_at_pos (
+      P_TEMPO_TRACK, &pos);
+  g_assert_cmpfloat (bpm, >=, 120.f);
+  g_assert_cmpfloat (bpm, <, 130.f);
+  position_set_to_bar (&pos, 2);
+  bpm =
+    tempo_track_get_bpm_at_pos (
+      P_TEMPO_TRACK, &pos);
+  g_assert_cmpfloat (bpm, >, 120.f);
+  g_assert_cmpfloat (bpm, <, 240.f);
+  position_set_to_bar (&pos, 5);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_track_get_bpm_at_pos (
+      P_TEMPO_TRACK, &pos),
+    240.f, 0.001f);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_get_bpm_at_frames (map, pos.frames),
+    240.f, 0.001f);
+
+  /* a bar at 240 BPM is half as long as at
+   * 120 BPM */
+  double fpt_120 =
+    ((double) AUDIO_ENGINE->sample_rate * 60.0 *
+      (double) tempo_track_get_beats_per_bar (
+        P_TEMPO_TRACK)) /
+    (120.0 * ticks_per_bar);
+  Position pos2;
+  position_set_to_bar (&pos, 5);
+  position_set_to_bar (&pos2, 6);
+  signed_frame_t bar_frames =
+    math_round_double_to_signed_frame_t (
+      (fpt_120 * ticks_per_bar) / 2.0);
+  g_assert_cmpint (
+    pos2.frames - pos.frames, >=, bar_frames - 1);
+  g_assert_cmpint (
+    pos2.frames - pos.frames, <=, bar_frames + 1);
+
+  /* the ramp is somewhere in between */
+  position_set_to_bar (&pos, 1);
+  position_set_to_bar (&pos2, 3);
+  g_assert_cmpint (
+    pos2.frames - pos.frames, <,
+    math_round_double_to_signed_frame_t (
+      fpt_120 * ticks_per_bar * 2.0));
+  g_assert_cmpint (
+    pos2.frames - pos.frames, >,
+    math_round_double_to_signed_frame_t (
+      fpt_120 * ticks_per_bar));
+
+  /* conversions are monotonic and round-trip */
+  signed_frame_t prev_frames = -1;
+  for (double ticks = 0.0;
+       ticks < ticks_per_bar * 12.0;
+       ticks += 97.31)
+    {
+      position_from_ticks (&pos, ticks);
+      g_assert_cmpint (
+        pos.frames, >=, prev_frames);
+      prev_frames = pos.frames;
+
+      position_from_frames (&pos2, pos.frames);
+      g_assert_cmpfloat_with_epsilon (
+        pos2.ticks, ticks, 0.1);
+    }
+
+  /* existing positions were updated */
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  position_set_to_bar (&pos2, 9);
+  g_assert_cmpint (
+    r_obj->end_pos.frames, ==, pos2.frames);
+
+  /* region-local positions are converted from the
+   * region start, where the tempo is 240 BPM */
+  Track * midi_track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+  position_set_to_bar (&pos, 5);
+  position_set_to_bar (&pos2, 7);
+  ZRegion * midi_r =
+    midi_region_new (
+      &pos, &pos2,
+      track_get_name_hash (midi_track), 0, 0);
+  track_add_region (
+    midi_track, midi_r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  position_set_to_bar (&pos, 1);
+  position_set_to_bar (&pos2, 2);
+  MidiNote * mn =
+    midi_note_new (
+      &midi_r->id, &pos, &pos2, 60, 100);
+  midi_region_add_midi_note (
+    midi_r, mn, F_NO_PUBLISH_EVENTS);
+  ArrangerObject * mn_obj = (ArrangerObject *) mn;
+  g_assert_cmpint (mn_obj->pos.frames, ==, 0);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, >=, bar_frames - 1);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, <=, bar_frames + 1);
+
+  /* also after moving the note */
+  position_set_to_bar (&pos2, 3);
+  arranger_object_set_position (
+    mn_obj, &pos2,
+    ARRANGER_OBJECT_POSITION_TYPE_END,
+    F_NO_VALIDATE);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, >=, 2 * bar_frames - 1);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, <=, 2 * bar_frames + 1);
+
+  /* changes to the current BPM (eg, when reading
+   * the automation) do not require a rebuild */
+  g_assert_false (
+    tempo_map_needs_rebuild (
+      map, 200.f,
+      tempo_track_get_beats_per_bar (P_TEMPO_TRACK),
+      TRANSPORT->ticks_per_bar,
+      AUDIO_ENGINE->sample_rate));
+  g_assert_true (
+    tempo_map_needs_rebuild (
+      map, 200.f,
+      tempo_track_get_beats_per_bar (P_TEMPO_TRACK)
+        + 1,
+      TRANSPORT->ticks_per_bar,
+      AUDIO_ENGINE->sample_rate));
+
+  /* and do not affect positions */
+  engine_update_frames_per_tick (
+    AUDIO_ENGINE,
+    tempo_track_get_beats_per_bar (P_TEMPO_TRACK),
+    200.f, AUDIO_ENGINE->sample_rate, true, true);
+  g_assert_cmpint (
+    r_obj->end_pos.frames, ==, pos2.frames);
+  engine_update_frames_per_tick (
+    AUDIO_ENGINE,
+    tempo_track_get_beats_per_bar (P_TEMPO_TRACK),
+    bpm_before, AUDIO_ENGINE->sample_rate, true,
+    true);
+
+  /* removing the automation goes back to a
+   * constant tempo */
+  track_remove_region (
+    P_TEMPO_TRACK, r, F_NO_PUBLISH_EVENTS,
+    F_FREE);
+  engine_update_tempo_map (AUDIO_ENGINE);
+  g_assert_false (tempo_map_is_automated (map));
+  position_set_to_bar (&pos, 5);
+  g_assert_cmpint (
+    pos.frames, ==,
+    math_round_double_to_signed_frame_t (
+      pos.ticks * AUDIO_ENGINE->frames_per_tick));
+
+  test_helper_zrythm_cleanup ();
+}
+
+static gpointer
+refresh_children_thread_func (
+  gpointer data)
+{
+  region_refresh_children_positions (
+    (ZRegion *) data);
+  return NULL;
+}
+
+static void
+test_lazy_children_positions (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+
+  Position p1, p2;
+  position_set_to_bar (&p1, 3);
+  position_set_to_bar (&p2, 5);
+  ZRegion * r =
+    midi_region_new (
+      &p1, &p2, track_get_name_hash (track), 0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  position_set_to_bar (&p1, 1);
+  position_set_to_bar (&p2, 2);
+  MidiNote * mn =
+    midi_note_new (&r->id, &p1, &p2, 60, 100);
+  midi_region_add_midi_note (
+    r, mn, F_NO_PUBLISH_EVENTS);
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  ArrangerObject * mn_obj = (ArrangerObject *) mn;
+  signed_frame_t note_end_frames_before =
+    mn_obj->end_pos.frames;
+
+  /* change the tempo */
+  bpm_t bpm_before =
+    tempo_track_get_current_bpm (P_TEMPO_TRACK);
+  engine_update_frames_per_tick (
+    AUDIO_ENGINE,
+    tempo_track_get_beats_per_bar (P_TEMPO_TRACK),
+    bpm_before * 2.f, AUDIO_ENGINE->sample_rate,
+    true, true);
+
+  /* the region is updated immediately */
+  position_set_to_bar (&p1, 3);
+  g_assert_cmpint (
+    r_obj->pos.frames, ==, p1.frames);
+
+  /* the note is only updated when accessed */
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, ==,
+    note_end_frames_before);
+
+  /* other threads (eg, the audio threads) do not
+   * update the children */
+  GThread * thread =
+    g_thread_new (
+      "refresh", refresh_children_thread_func, r);
+  g_thread_join (thread);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, ==,
+    note_end_frames_before);
+  g_assert_cmpint (
+    r->children_epoch, !=,
+    tempo_map_get_epoch (AUDIO_ENGINE->tempo_map));
+
+  /* but they can get the current frames */
+  position_set_to_bar (&p2, 2);
+  g_assert_cmpint (
+    region_get_child_frames (r, &mn_obj->end_pos),
+    ==, p2.frames);
+
+  ZRegion * found = region_find (&r->id);
+  g_assert_true (found == r);
+  position_set_to_bar (&p2, 2);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, ==, p2.frames);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, <,
+    note_end_frames_before);
+
+  /* refreshing again is a no-op */
+  g_assert_cmpint (
+    r->children_epoch, ==,
+    tempo_map_get_epoch (AUDIO_ENGINE->tempo_map));
+  region_refresh_children_positions (r);
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, ==, p2.frames);
+
+  /* the remaining regions are eventually updated
+   * in the GTK thread */
+  engine_update_frames_per_tick (
+    AUDIO_ENGINE,
+    tempo_track_get_beats_per_bar (P_TEMPO_TRACK),
+    bpm_before, AUDIO_ENGINE->sample_rate, true,
+    true);
+  while (AUDIO_ENGINE->refresh_positions_source_id
+           != 0)
+    {
+      g_main_context_iteration (NULL, true);
+    }
+  g_assert_cmpint (
+    mn_obj->end_pos.frames, ==,
+    note_end_frames_before);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/tempo_map/"
+
+  g_test_add_func (
+    TEST_PREFIX "test constant tempo",
+    (GTestFunc) test_constant_tempo);
+  g_test_add_func (
+    TEST_PREFIX "test automated tempo",
+    (GTestFunc) test_automated_tempo);
+  g_test_add_func (
+    TEST_PREFIX "test lazy children positions",
+    (GTestFunc) test_lazy_children_positions);
+
+  return g_test_run ();
+}
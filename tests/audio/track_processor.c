@@ -22,7 +22,9 @@
 #include <math.h>
 
 #include "audio/master_track.h"
+#include "audio/midi_event.h"
 #include "audio/track_processor.h"
+#include "audio/tracklist.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "zrythm.h"
@@ -83,6 +85,143 @@ test_process_master (void)
   test_helper_zrythm_cleanup ();
 }
 
+/**
+ * Test that MIDI CC ports are created on first use
+ * and that changes to them are sent to the MIDI
+ * output.
+ */
+static void
+test_midi_cc_ports_on_first_use (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+  TrackProcessor * tp = track->processor;
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (track);
+  int num_ats = atl->num_ats;
+  for (int i = 0; i < 128 * 16; i++)
+    {
+      g_assert_null (tp->midi_cc[i]);
+    }
+  for (int i = 0; i < 16; i++)
+    {
+      g_assert_null (tp->pitch_bend[i]);
+    }
+
+  /* create the modwheel port for channel 1 */
+  Port * modwheel =
+    track_processor_get_or_create_midi_automatable (
+      tp, 0, 1);
+  g_assert_nonnull (modwheel);
+  g_assert_true (tp->midi_cc[1] == modwheel);
+  g_assert_cmpint (atl->num_ats, ==, num_ats + 1);
+  g_assert_nonnull (
+    automation_tracklist_get_at_from_port (
+      atl, modwheel));
+  g_assert_true (
+    track_processor_get_or_create_midi_automatable (
+      tp, 0, 1) == modwheel);
+  g_assert_cmpint (atl->num_ats, ==, num_ats + 1);
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  /* check that a change is sent once */
+  port_set_control_value (
+    modwheel, 1.f, F_NORMALIZED,
+    F_NO_PUBLISH_EVENTS);
+  EngineProcessTimeInfo time_nfo = {
+    .g_start_frame = 0,
+    .local_offset = 0,
+    .nframes = AUDIO_ENGINE->block_length, };
+  for (int i = 0; i < 2; i++)
+    {
+      midi_events_clear (
+        tp->midi_out->midi_events, F_NOT_QUEUED);
+      track_processor_process (tp, &time_nfo);
+      MidiEvents * events =
+        tp->midi_out->midi_events;
+      if (i == 0)
+        {
+          g_assert_cmpint (events->num_events, ==, 1);
+          midi_byte_t * buf =
+            events->events[0].raw_buffer;
+          g_assert_cmpuint (buf[0], ==, 0xB0);
+          g_assert_cmpuint (buf[1], ==, 1);
+          g_assert_cmpuint (buf[2], ==, 127);
+        }
+      else
+        {
+          g_assert_cmpint (events->num_events, ==, 0);
+        }
+    }
+
+  /* check that the port is kept after
+   * reloading */
+  test_project_save_and_reload ();
+  track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  tp = track->processor;
+  g_assert_nonnull (tp->midi_cc[1]);
+  g_assert_null (tp->midi_cc[2]);
+  g_assert_cmpfloat_with_epsilon (
+    tp->midi_cc[1]->control, 1.f, 0.0001f);
+
+  test_helper_zrythm_cleanup ();
+}
+
+/**
+ * Test that changes to MIDI automatable ports are
+ * sent after reloading the project.
+ */
+static void
+test_midi_automatable_after_reload (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+  track_processor_get_or_create_midi_automatable (
+    track->processor,
+    PORT_FLAG2_MIDI_PITCH_BEND, 0);
+
+  test_project_save_and_reload ();
+  track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  TrackProcessor * tp = track->processor;
+  Port * pitch_bend = tp->pitch_bend[0];
+  g_assert_nonnull (pitch_bend);
+  g_assert_true (pitch_bend->track == track);
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  port_set_control_value (
+    pitch_bend, 1.f, F_NORMALIZED,
+    F_NO_PUBLISH_EVENTS);
+  EngineProcessTimeInfo time_nfo = {
+    .g_start_frame = 0,
+    .local_offset = 0,
+    .nframes = AUDIO_ENGINE->block_length, };
+  midi_events_clear (
+    tp->midi_out->midi_events, F_NOT_QUEUED);
+  track_processor_process (tp, &time_nfo);
+  MidiEvents * events = tp->midi_out->midi_events;
+  g_assert_cmpint (events->num_events, ==, 1);
+  g_assert_cmpuint (
+    events->events[0].raw_buffer[0], ==, 0xE0);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -95,6 +234,12 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test process master",
     (GTestFunc) test_process_master);
+  g_test_add_func (
+    TEST_PREFIX "test midi cc ports on first use",
+    (GTestFunc) test_midi_cc_ports_on_first_use);
+  g_test_add_func (
+    TEST_PREFIX "test midi automatable after reload",
+    (GTestFunc) test_midi_automatable_after_reload);
 
   return g_test_run ();
 }
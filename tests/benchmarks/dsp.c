@@ -20,6 +20,7 @@
 #include "zrythm-test-config.h"
 
 #include "utils/dsp.h"
+#include "utils/dsp_kernels.h"
 #include "utils/objects.h"
 #include "zrythm.h"
 
@@ -246,6 +247,90 @@ test_run_engine (void)
   _test_run_engine (F_NOT_OPTIMIZED);
 }
 
+/**
+ * Runs each kernel of each supported instruction
+ * set and prints the throughput.
+ */
+static void
+test_kernels_per_isa (void)
+{
+  float * buf =
+    object_new_n (LARGE_BUFFER_SIZE, float);
+  float * src =
+    object_new_n (LARGE_BUFFER_SIZE, float);
+  float * src2 =
+    object_new_n (LARGE_BUFFER_SIZE, float);
+  size_t size = LARGE_BUFFER_SIZE;
+  double samples =
+    (double) size * NUM_ITERATIONS_MANY;
+  float ret = 0.f;
+
+  for (DspIsa isa = 0; isa < NUM_DSP_ISAS; isa++)
+    {
+      const DspKernels * k = dsp_kernels_get (isa);
+      if (!k)
+        {
+          fprintf (
+            stderr, "---- %s: not supported ----\n",
+            dsp_isa_to_string (isa));
+          continue;
+        }
+
+      fprintf (
+        stderr, "---- %s ----\n",
+        dsp_isa_to_string (isa));
+
+#define ISA_BENCH(fname,call) \
+  { \
+    gint64 start = g_get_monotonic_time (); \
+    for (int i = 0; i < NUM_ITERATIONS_MANY; i++) \
+      { \
+        call; \
+      } \
+    gint64 end = g_get_monotonic_time (); \
+    fprintf ( \
+      stderr, "%s: %.1f Msamples/s\n", fname, \
+      samples / (double) MAX (end - start, 1)); \
+  }
+
+      ISA_BENCH ("fill", k->fill (buf, 0.3f, size));
+      ISA_BENCH (
+        "limit1", k->limit1 (buf, -1.f, 1.1f, size));
+      ISA_BENCH ("copy", k->copy (buf, src, size));
+      ISA_BENCH (
+        "mul_k2", k->mul_k2 (buf, 0.99f, size));
+      ISA_BENCH ("mul2", k->mul2 (buf, src, size));
+      ISA_BENCH (
+        "abs_max", ret += k->abs_max (buf, size));
+      ISA_BENCH ("min", ret += k->min (buf, size));
+      ISA_BENCH ("max", ret += k->max (buf, size));
+      ISA_BENCH ("add2", k->add2 (buf, src, size));
+      ISA_BENCH (
+        "mix2",
+        k->mix2 (buf, src, 0.1f, 0.2f, size));
+      ISA_BENCH (
+        "mix_add2",
+        k->mix_add2 (
+          buf, src, src2, 0.1f, 0.2f, size));
+      ISA_BENCH (
+        "ramp_mul",
+        k->ramp_mul (buf, 1.f, -0.0001f, size));
+      ISA_BENCH (
+        "mul_k2_stereo",
+        k->mul_k2_stereo (
+          buf, src, 0.9f, 0.8f, size));
+
+#undef ISA_BENCH
+    }
+
+  /* so that the calls are not optimized out */
+  g_message ("%f", (double) ret);
+
+  free (buf);
+  free (src);
+  free (src2);
+}
+
 static void
 print_benchmark_results (void)
 {
@@ -280,6 +365,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test run engine",
     (GTestFunc) test_run_engine);
+  g_test_add_func (
+    TEST_PREFIX "test kernels per isa",
+    (GTestFunc) test_kernels_per_isa);
   g_test_add_func (
     TEST_PREFIX "print benchmark results",
     (GTestFunc) print_benchmark_results);
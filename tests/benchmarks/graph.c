@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "actions/mixer_selections_action.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/router.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include "tests/helpers/plugin_manager.h"
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define NUM_TRACKS 32
+#define NUM_INSERTS 8
+#define NUM_CYCLES 2000
+
+/**
+ * Returns the resident set size in KiB, or 0 if
+ * unknown.
+ */
+static long
+get_rss_kib (void)
+{
+  char * contents = NULL;
+  if (!g_file_get_contents (
+         "/proc/self/statm", &contents, NULL,
+         NULL))
+    return 0;
+
+  long size = 0, resident = 0;
+  int ret =
+    sscanf (contents, "%ld %ld", &size, &resident);
+  g_free (contents);
+  if (ret != 2)
+    return 0;
+
+  return resident * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
+static void
+run_cycles (
+  const char * name)
+{
+  /* warm up */
+  for (int i = 0; i < 10; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+
+  gint64 start = g_get_monotonic_time ();
+  for (int i = 0; i < NUM_CYCLES; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  gint64 end = g_get_monotonic_time ();
+
+  Graph * graph = ROUTER->graph;
+  fprintf (
+    stderr,
+    "---- %s ----\n"
+    "%.2fus per cycle\n"
+    "RSS: %ld KiB\n"
+    "pooled ports: %d, pooled buffers: %d\n",
+    name,
+    (double) (end - start) / NUM_CYCLES,
+    get_rss_kib (),
+    graph->num_pooled_ports,
+    graph->num_pooled_bufs);
+}
+
+static void
+test_run_graph_with_buf_pool (void)
+{
+  test_helper_zrythm_init ();
+
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (20000);
+
+  /* create tracks with chains of plugins */
+  PluginSetting * setting =
+    test_plugin_manager_get_plugin_setting (
+      EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+  g_assert_nonnull (setting);
+  for (int i = 0; i < NUM_TRACKS; i++)
+    {
+      Track * track =
+        track_create_empty_with_action (
+          TRACK_TYPE_AUDIO_BUS, NULL);
+      bool ret =
+        mixer_selections_action_perform_create (
+          PLUGIN_SLOT_INSERT,
+          track_get_name_hash (track), 0,
+          setting, NUM_INSERTS, NULL);
+      g_assert_true (ret);
+    }
+
+  /* per-port buffers */
+  ROUTER->graph->use_buf_pool = false;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpint (
+    ROUTER->graph->num_pooled_ports, ==, 0);
+  run_cycles ("per-port buffers");
+
+  /* pooled buffers */
+  ROUTER->graph->use_buf_pool = true;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpint (
+    ROUTER->graph->num_pooled_ports, >, 0);
+  g_assert_cmpint (
+    ROUTER->graph->num_pooled_bufs, <,
+    ROUTER->graph->num_pooled_ports);
+  run_cycles ("pooled buffers");
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/graph/"
+
+  g_test_add_func (
+    TEST_PREFIX "test run graph with buf pool",
+    (GTestFunc) test_run_graph_with_buf_pool);
+
+  return g_test_run ();
+}
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "audio/midi_file.h"
+#include "audio/midi_region.h"
+#include "audio/supported_file.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/io.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+
+#include <glib.h>
+
+/** Number of copies of the track with data. */
+#define NUM_TRACKS 64
+
+/** Number of times the events of the track are
+ * repeated in each copy. */
+#define NUM_REPEATS 200
+
+static const guint8 end_of_track[] = {
+  0x00, 0xff, 0x2f, 0x00 };
+
+static guint32
+read_be32 (
+  const guint8 * data)
+{
+  return
+    ((guint32) data[0] << 24) |
+    ((guint32) data[1] << 16) |
+    ((guint32) data[2] << 8) |
+    (guint32) data[3];
+}
+
+static void
+append_be32 (
+  GByteArray * arr,
+  guint32      val)
+{
+  guint8 bytes[] = {
+    (guint8) (val >> 24), (guint8) (val >> 16),
+    (guint8) (val >> 8), (guint8) val };
+  g_byte_array_append (arr, bytes, 4);
+}
+
+/**
+ * Appends a track chunk with the events of the
+ * given track chunk repeated @p num_repeats times.
+ */
+static void
+append_track (
+  GByteArray *   arr,
+  const guint8 * chunk,
+  guint32        chunk_len,
+  int            num_repeats)
+{
+  /* every track in the file ends with an end of
+   * track event at delta 0 */
+  g_assert_cmpuint (chunk_len, >=, 4);
+  guint32 events_len = chunk_len - 4;
+  g_assert_true (
+    memcmp (
+      &chunk[events_len], end_of_track, 4) == 0);
+
+  g_byte_array_append (
+    arr, (const guint8 *) "MTrk", 4);
+  append_be32 (
+    arr,
+    events_len * (guint32) num_repeats + 4);
+  for (int i = 0; i < num_repeats; i++)
+    {
+      g_byte_array_append (
+        arr, chunk, events_len);
+    }
+  g_byte_array_append (arr, end_of_track, 4);
+}
+
+/**
+ * Creates a larger version of
+ * those_who_remain.mid, with the first track
+ * as-is and NUM_TRACKS copies of the second
+ * track, each with its events repeated
+ * NUM_REPEATS times.
+ *
+ * @return The path of the new file.
+ */
+static char *
+create_scaled_midi_file (
+  const char * dir)
+{
+  char * src_path =
+    g_build_filename (
+      TESTS_SRCDIR, "those_who_remain.mid", NULL);
+  guint8 * data = NULL;
+  gsize len = 0;
+  g_assert_true (
+    g_file_get_contents (
+      src_path, (gchar **) &data, &len, NULL));
+  g_free (src_path);
+
+  /* header + 2 tracks at least */
+  g_assert_cmpuint (len, >, 14 + 16);
+  g_assert_true (memcmp (data, "MThd", 4) == 0);
+  const guint8 * track0 = &data[14];
+  guint32 track0_len = read_be32 (&track0[4]);
+  const guint8 * track1 =
+    &track0[8 + track0_len];
+  guint32 track1_len = read_be32 (&track1[4]);
+  g_assert_cmpuint (
+    14 + 16 + track0_len + track1_len, <=, len);
+
+  GByteArray * arr = g_byte_array_new ();
+
+  /* header (format 1, same division) */
+  g_byte_array_append (arr, data, 10);
+  guint8 num_tracks[] = {
+    (guint8) ((NUM_TRACKS + 1) >> 8),
+    (guint8) (NUM_TRACKS + 1) };
+  g_byte_array_append (arr, num_tracks, 2);
+  g_byte_array_append (arr, &data[12], 2);
+
+  append_track (
+    arr, &track0[8], track0_len, 1);
+  for (int i = 0; i < NUM_TRACKS; i++)
+    {
+      append_track (
+        arr, &track1[8], track1_len, NUM_REPEATS);
+    }
+
+  char * path =
+    g_build_filename (dir, "scaled.mid", NULL);
+  g_assert_true (
+    g_file_set_contents (
+      path, (const gchar *) arr->data,
+      (gssize) arr->len, NULL));
+
+  g_byte_array_unref (arr);
+  g_free (data);
+
+  return path;
+}
+
+static void
+test_import_midi_file (void)
+{
+  test_helper_zrythm_init ();
+
+  char * dir =
+    g_dir_make_tmp (
+      "zrythm_midi_file_bench_XXXXXX", NULL);
+  g_assert_nonnull (dir);
+  char * path = create_scaled_midi_file (dir);
+
+  /* parse the file */
+  gint64 start = g_get_monotonic_time ();
+  MidiFile * mf = midi_file_new (path);
+  gint64 end = g_get_monotonic_time ();
+  g_assert_nonnull (mf);
+  g_assert_cmpint (
+    mf->num_nonempty_tracks, ==, NUM_TRACKS);
+  int num_notes = 0;
+  for (int i = 0; i < mf->num_nonempty_tracks; i++)
+    {
+      MidiFileTrack * track =
+        midi_file_get_nonempty_track (mf, i);
+      num_notes += track->num_notes;
+    }
+  g_assert_cmpint (num_notes, >, 0);
+  fprintf (
+    stderr,
+    "---- parse ----\n"
+    "%d tracks, %d notes: %.2fms\n",
+    NUM_TRACKS, num_notes,
+    (double) (end - start) / 1000.0);
+
+  /* create the regions */
+  start = g_get_monotonic_time ();
+  Position pos;
+  position_init (&pos);
+  int num_region_notes = 0;
+  for (int i = 0; i < mf->num_nonempty_tracks; i++)
+    {
+      ZRegion * r =
+        midi_region_new_from_midi_file_track (
+          &pos,
+          midi_file_get_nonempty_track (mf, i),
+          0, 0, 0);
+      g_assert_nonnull (r);
+      num_region_notes += r->num_midi_notes;
+      arranger_object_free ((ArrangerObject *) r);
+    }
+  end = g_get_monotonic_time ();
+  g_assert_cmpint (
+    num_region_notes, ==, num_notes);
+  fprintf (
+    stderr,
+    "---- create regions ----\n"
+    "%.2fms\n",
+    (double) (end - start) / 1000.0);
+  midi_file_free (mf);
+
+  /* full import through the action */
+  SupportedFile * file =
+    supported_file_new_from_path (path);
+  int num_tracks_before = TRACKLIST->num_tracks;
+  start = g_get_monotonic_time ();
+  bool ret =
+    track_create_with_action (
+      TRACK_TYPE_MIDI, NULL, file, PLAYHEAD,
+      num_tracks_before, 1, NULL);
+  end = g_get_monotonic_time ();
+  g_assert_true (ret);
+  g_assert_cmpint (
+    TRACKLIST->num_tracks, ==,
+    num_tracks_before + NUM_TRACKS);
+  fprintf (
+    stderr,
+    "---- import ----\n"
+    "%.2fms\n",
+    (double) (end - start) / 1000.0);
+  supported_file_free (file);
+
+  io_remove (path);
+  io_rmdir (dir, F_NO_FORCE);
+  g_free (path);
+  g_free (dir);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/midi_file/"
+
+  g_test_add_func (
+    TEST_PREFIX "test import midi file",
+    (GTestFunc) test_import_midi_file);
+
+  return g_test_run ();
+}
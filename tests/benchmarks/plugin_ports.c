@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdio.h>
+
+#include "actions/mixer_selections_action.h"
+#include "audio/engine.h"
+#include "audio/router.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include "tests/helpers/plugin_manager.h"
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define NUM_TRACKS 16
+#define NUM_INSERTS 8
+#define NUM_CYCLES 2000
+
+static void
+run_cycles (
+  const char * name)
+{
+  /* warm up */
+  for (int i = 0; i < 10; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+
+  gint64 start = g_get_monotonic_time ();
+  for (int i = 0; i < NUM_CYCLES; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  gint64 end = g_get_monotonic_time ();
+
+  fprintf (
+    stderr,
+    "---- %s ----\n"
+    "%.2fus per cycle\n",
+    name,
+    (double) (end - start) / NUM_CYCLES);
+}
+
+static void
+add_tracks_with_plugin (
+  const char * bundle_uri,
+  const char * uri)
+{
+  PluginSetting * setting =
+    test_plugin_manager_get_plugin_setting (
+      bundle_uri, uri, false);
+  g_assert_nonnull (setting);
+  for (int i = 0; i < NUM_TRACKS; i++)
+    {
+      Track * track =
+        track_create_empty_with_action (
+          TRACK_TYPE_AUDIO_BUS, NULL);
+      bool ret =
+        mixer_selections_action_perform_create (
+          PLUGIN_SLOT_INSERT,
+          track_get_name_hash (track), 0,
+          setting, NUM_INSERTS, NULL);
+      g_assert_true (ret);
+    }
+}
+
+static void
+test_process_few_ports (void)
+{
+  test_helper_zrythm_init ();
+
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (20000);
+
+  add_tracks_with_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI);
+  run_cycles ("few ports");
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_process_many_ports (void)
+{
+  test_helper_zrythm_init ();
+
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (20000);
+
+  add_tracks_with_plugin (
+    MANY_PORTS_BUNDLE_URI, MANY_PORTS_URI);
+  run_cycles ("many ports");
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/plugin_ports/"
+
+  g_test_add_func (
+    TEST_PREFIX "test process few ports",
+    (GTestFunc) test_process_few_ports);
+  g_test_add_func (
+    TEST_PREFIX "test process many ports",
+    (GTestFunc) test_process_many_ports);
+
+  return g_test_run ();
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <string.h>
+
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+#include "utils/schema_binary.h"
+#include "utils/yaml.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#define NUM_REGIONS 500
+#define NUM_NOTES_PER_REGION 1000
+
+/**
+ * Creates a MIDI track with NUM_REGIONS regions of
+ * NUM_NOTES_PER_REGION notes each.
+ */
+static void
+create_large_project (void)
+{
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+  unsigned int name_hash =
+    track_get_name_hash (track);
+
+  for (int i = 0; i < NUM_REGIONS; i++)
+    {
+      Position pos, end_pos;
+      position_set_to_bar (&pos, i * 4 + 1);
+      position_set_to_bar (&end_pos, i * 4 + 5);
+      ZRegion * r =
+        midi_region_new (
+          &pos, &end_pos, name_hash, 0, i);
+      track_add_region (
+        track, r, NULL, 0, F_GEN_NAME,
+        F_NO_PUBLISH_EVENTS);
+
+      for (int j = 0; j < NUM_NOTES_PER_REGION; j++)
+        {
+          position_set_to_bar (&pos, 1);
+          position_add_ticks (&pos, j * 15);
+          position_set_to_pos (&end_pos, &pos);
+          position_add_ticks (&end_pos, 10);
+          MidiNote * mn =
+            midi_note_new (
+              &r->id, &pos, &end_pos,
+              (uint8_t) (20 + j % 80),
+              (uint8_t) (1 + j % 127));
+          midi_region_add_midi_note (
+            r, mn, F_NO_PUBLISH_EVENTS);
+        }
+    }
+}
+
+static void
+print_result (
+  const char * name,
+  gint64       start,
+  gint64       end,
+  size_t       size)
+{
+  fprintf (
+    stderr, "---- %s ----\n%ldms", name,
+    (long) (end - start) / 1000);
+  if (size > 0)
+    {
+      fprintf (
+        stderr, " (%zu bytes)", size);
+    }
+  fprintf (stderr, "\n");
+}
+
+static void
+test_load_save_large_project (void)
+{
+  test_helper_zrythm_init ();
+
+  create_large_project ();
+
+  UndoManager * undo_manager =
+    PROJECT->undo_manager;
+  PROJECT->undo_manager = NULL;
+
+  /* YAML */
+  gint64 start = g_get_monotonic_time ();
+  char * yaml =
+    yaml_serialize (PROJECT, &project_schema);
+  gint64 end = g_get_monotonic_time ();
+  g_assert_nonnull (yaml);
+  size_t yaml_size = strlen (yaml);
+  print_result (
+    "serialize YAML", start, end, yaml_size);
+
+  char * compressed;
+  size_t compressed_size;
+  start = g_get_monotonic_time ();
+  bool ret =
+    project_compress (
+      &compressed, &compressed_size,
+      PROJECT_COMPRESS_DATA, yaml, yaml_size,
+      PROJECT_COMPRESS_DATA, NULL);
+  end = g_get_monotonic_time ();
+  g_assert_true (ret);
+  print_result (
+    "compress YAML", start, end, compressed_size);
+  free (compressed);
+
+  start = g_get_monotonic_time ();
+  Project * yaml_prj =
+    (Project *)
+    yaml_deserialize (yaml, &project_schema);
+  end = g_get_monotonic_time ();
+  g_assert_nonnull (yaml_prj);
+  print_result ("deserialize YAML", start, end, 0);
+  g_free (yaml);
+
+  /* binary */
+  size_t bin_size;
+  start = g_get_monotonic_time ();
+  char * bin =
+    schema_binary_serialize (
+      PROJECT, &project_schema, &bin_size);
+  end = g_get_monotonic_time ();
+  g_assert_nonnull (bin);
+  print_result (
+    "serialize binary", start, end, bin_size);
+
+  start = g_get_monotonic_time ();
+  ret =
+    project_compress (
+      &compressed, &compressed_size,
+      PROJECT_COMPRESS_DATA, bin, bin_size,
+      PROJECT_COMPRESS_DATA, NULL);
+  end = g_get_monotonic_time ();
+  g_assert_true (ret);
+  print_result (
+    "compress binary", start, end,
+    compressed_size);
+  free (compressed);
+
+  start = g_get_monotonic_time ();
+  Project * bin_prj =
+    (Project *)
+    schema_binary_deserialize (
+      bin, bin_size, &project_schema, NULL);
+  end = g_get_monotonic_time ();
+  g_assert_nonnull (bin_prj);
+  print_result (
+    "deserialize binary", start, end, 0);
+  g_free (bin);
+
+  /* the deserialized projects were not
+   * initialized so they are not free'd */
+
+  PROJECT->undo_manager = undo_manager;
+
+  /* full save and load */
+  start = g_get_monotonic_time ();
+  char * prj_file = test_project_save ();
+  end = g_get_monotonic_time ();
+  print_result ("save project", start, end, 0);
+
+  start = g_get_monotonic_time ();
+  test_project_reload (prj_file);
+  end = g_get_monotonic_time ();
+  print_result ("load project", start, end, 0);
+  g_free (prj_file);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/project/"
+
+  g_test_add_func (
+    TEST_PREFIX "test load save large project",
+    (GTestFunc) test_load_save_large_project);
+
+  return g_test_run ();
+}
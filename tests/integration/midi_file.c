@@ -134,7 +134,7 @@ test_midi_file_playback (void)
                 .nframes = BUFFER_SIZE, };
               track_fill_events (
                 track, &time_nfo, events, NULL);
-              midi_events_clear (events, true);
+              midi_events_clear (events, false);
             }
         }
 
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Plugin with many control ports, used to
+ * benchmark port handling in the host.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "lv2/core/lv2.h"
+
+#define MANY_PORTS_URI \
+  "https://www.zrythm.org/plugins/many-ports"
+
+#define NUM_AUDIO_INS 2
+#define NUM_AUDIO_OUTS 2
+#define NUM_CONTROL_INS 128
+#define NUM_CONTROL_OUTS 16
+
+#define FIRST_AUDIO_OUT NUM_AUDIO_INS
+#define FIRST_CONTROL_IN \
+  (FIRST_AUDIO_OUT + NUM_AUDIO_OUTS)
+#define FIRST_CONTROL_OUT \
+  (FIRST_CONTROL_IN + NUM_CONTROL_INS)
+#define NUM_PORTS \
+  (FIRST_CONTROL_OUT + NUM_CONTROL_OUTS)
+
+typedef struct ManyPorts
+{
+  const float * audio_ins[NUM_AUDIO_INS];
+  float *       audio_outs[NUM_AUDIO_OUTS];
+  const float * control_ins[NUM_CONTROL_INS];
+  float *       control_outs[NUM_CONTROL_OUTS];
+} ManyPorts;
+
+static LV2_Handle
+instantiate (
+  const LV2_Descriptor *     descriptor,
+  double                     rate,
+  const char *               bundle_path,
+  const LV2_Feature * const * features)
+{
+  ManyPorts * self =
+    (ManyPorts *) calloc (1, sizeof (ManyPorts));
+
+  return (LV2_Handle) self;
+}
+
+static void
+connect_port (
+  LV2_Handle instance,
+  uint32_t   port,
+  void *     data)
+{
+  ManyPorts * self = (ManyPorts *) instance;
+
+  if (port < FIRST_AUDIO_OUT)
+    {
+      self->audio_ins[port] = (const float *) data;
+    }
+  else if (port < FIRST_CONTROL_IN)
+    {
+      self->audio_outs[port - FIRST_AUDIO_OUT] =
+        (float *) data;
+    }
+  else if (port < FIRST_CONTROL_OUT)
+    {
+      self->control_ins[port - FIRST_CONTROL_IN] =
+        (const float *) data;
+    }
+  else if (port < NUM_PORTS)
+    {
+      self->control_outs[
+        port - FIRST_CONTROL_OUT] = (float *) data;
+    }
+}
+
+static void
+activate (
+  LV2_Handle instance)
+{
+}
+
+/**
+ * Copies the audio and mirrors the first control
+ * inputs to the control outputs.
+ */
+static void
+run (
+  LV2_Handle instance,
+  uint32_t   n_samples)
+{
+  ManyPorts * self = (ManyPorts *) instance;
+
+  for (int i = 0; i < NUM_AUDIO_OUTS; i++)
+    {
+      const float * in = self->audio_ins[i];
+      float *       out = self->audio_outs[i];
+      for (uint32_t j = 0; j < n_samples; j++)
+        {
+          out[j] = in[j];
+        }
+    }
+
+  for (int i = 0; i < NUM_CONTROL_OUTS; i++)
+    {
+      *self->control_outs[i] =
+        *self->control_ins[i];
+    }
+}
+
+static void
+deactivate (
+  LV2_Handle instance)
+{
+}
+
+static void
+cleanup (
+  LV2_Handle instance)
+{
+  free (instance);
+}
+
+static const void *
+extension_data (
+  const char * uri)
+{
+  return NULL;
+}
+
+static const LV2_Descriptor descriptor = {
+  MANY_PORTS_URI,
+  instantiate,
+  connect_port,
+  activate,
+  run,
+  deactivate,
+  cleanup,
+  extension_data
+};
+
+LV2_SYMBOL_EXPORT
+const LV2_Descriptor *
+lv2_descriptor (
+  uint32_t index)
+{
+  switch (index)
+    {
+    case 0:
+      return &descriptor;
+    default:
+      return NULL;
+    }
+}
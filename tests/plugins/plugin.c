@@ -207,6 +207,99 @@ test_bypass_state_after_project_load (void)
 #endif
 }
 
+static void
+test_background_instantiation_after_project_load (void)
+{
+#ifdef HAVE_LSP_COMPRESSOR
+  test_helper_zrythm_init ();
+
+  /* create a few fx tracks */
+  test_plugin_manager_create_tracks_from_plugin (
+    LSP_COMPRESSOR_BUNDLE, LSP_COMPRESSOR_URI,
+    false, false, 4);
+
+  /* reload project */
+  test_project_save_and_reload ();
+
+  /* all plugins should be ready */
+  g_assert_true (
+    plugin_loader_is_finished (PLUGIN_LOADER));
+  g_assert_cmpint (
+    PLUGIN_LOADER->num_total, ==, 4);
+  for (int i = 0; i < 4; i++)
+    {
+      Track * track =
+        TRACKLIST->tracks[
+          TRACKLIST->num_tracks - 1 - i];
+      Plugin * pl = track->channel->inserts[0];
+      g_assert_true (IS_PLUGIN_AND_NONNULL (pl));
+      g_assert_false (pl->instantiation_pending);
+      g_assert_true (pl->instantiated);
+      g_assert_true (pl->activated);
+    }
+
+  /* let engine run */
+  engine_wait_n_cycles (AUDIO_ENGINE, 8);
+
+  test_helper_zrythm_cleanup ();
+#endif
+}
+
+static void
+test_control_changes (void)
+{
+  test_helper_zrythm_init ();
+
+  test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false,
+    1);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Plugin * pl = track->channel->inserts[0];
+  g_assert_true (IS_PLUGIN_AND_NONNULL (pl));
+  Port * port = plugin_get_port_by_symbol (pl, "gain");
+  g_assert_nonnull (port);
+  int idx = port->id.port_index;
+  guint mask = 1u << (idx % 32);
+
+  /* let pending changes get processed */
+  engine_wait_n_cycles (AUDIO_ENGINE, 3);
+  g_assert_cmpint (
+    g_atomic_int_get (&pl->ctrl_dirty_any), ==, 0);
+
+  /* setting the same value is not a change */
+  port_set_control_value (
+    port, port->control, F_NOT_NORMALIZED,
+    F_NO_PUBLISH_EVENTS);
+  g_assert_cmpint (
+    g_atomic_int_get (&pl->ctrl_dirty_any), ==, 0);
+
+  /* a change is queued for the next cycle */
+  port_set_control_value (
+    port, -6.f, F_NOT_NORMALIZED,
+    F_NO_PUBLISH_EVENTS);
+  g_assert_cmpint (
+    g_atomic_int_get (&pl->ctrl_dirty_any), ==, 1);
+  g_assert_cmpuint (
+    pl->ctrl_dirty[idx / 32] & mask, ==, mask);
+
+  /* and taken when processing */
+  engine_wait_n_cycles (AUDIO_ENGINE, 3);
+  g_assert_cmpuint (
+    pl->ctrl_dirty[idx / 32] & mask, ==, 0);
+  g_assert_cmpuint (
+    pl->ctrl_changed[idx / 32] & mask, ==, 0);
+
+  /* the UI is not visible so the change is kept
+   * for the next UI update */
+  g_assert_false (pl->visible);
+  g_assert_true (pl->ctrl_ui_pending_any);
+  g_assert_cmpuint (
+    pl->ctrl_ui_pending[idx / 32] & mask, ==, mask);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -219,12 +312,20 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test bypass state after project load",
     (GTestFunc) test_bypass_state_after_project_load);
+  g_test_add_func (
+    TEST_PREFIX
+    "test background instantiation after project load",
+    (GTestFunc)
+    test_background_instantiation_after_project_load);
 #if 0
   /* test does not work with carla */
   g_test_add_func (
     TEST_PREFIX "test loading non-existing plugin",
     (GTestFunc) test_loading_non_existing_plugin);
 #endif
+  g_test_add_func (
+    TEST_PREFIX "test control changes",
+    (GTestFunc) test_control_changes);
   g_test_add_func (
     TEST_PREFIX "test loading fully bridged plugin",
     (GTestFunc) test_loading_fully_bridged_plugin);
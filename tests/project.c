@@ -31,6 +31,8 @@
 
 #include <glib.h>
 #include <locale.h>
+#include <stdlib.h>
+#include <string.h>
 
 static void
 test_empty_save_load (void)
@@ -107,6 +109,70 @@ test_save_load_with_data (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_save_load_yaml (void)
+{
+  test_helper_zrythm_init ();
+
+  /* add some data */
+  Position p1, p2;
+  test_project_rebootstrap_timeline (&p1, &p2);
+
+  /* save the project and replace the project file
+   * with its YAML representation */
+  char * prj_file = test_project_save ();
+  g_assert_nonnull (prj_file);
+  size_t yaml_size;
+  char * yaml =
+    project_serialize (
+      PROJECT, PROJECT_FILE_FORMAT_YAML,
+      &yaml_size);
+  g_assert_nonnull (yaml);
+  char * compressed;
+  size_t compressed_size;
+  GError * err = NULL;
+  bool success =
+    project_compress (
+      &compressed, &compressed_size,
+      PROJECT_COMPRESS_DATA, yaml, yaml_size,
+      PROJECT_COMPRESS_DATA, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+  g_file_set_contents (
+    prj_file, compressed,
+    (gssize) compressed_size, &err);
+  g_assert_no_error (err);
+  free (compressed);
+
+  /* the existing data is detected as YAML and
+   * the live project serialized in that format
+   * matches it (used to detect unsaved changes) */
+  size_t file_data_size;
+  char * file_data =
+    project_get_existing_data (
+      PROJECT, F_NOT_BACKUP, &file_data_size);
+  g_assert_nonnull (file_data);
+  g_assert_cmpint (
+    project_get_data_format (
+      file_data, file_data_size), ==,
+    PROJECT_FILE_FORMAT_YAML);
+  g_assert_cmpuint (file_data_size, ==, yaml_size);
+  g_assert_true (
+    memcmp (file_data, yaml, yaml_size) == 0);
+  free (file_data);
+  g_free (yaml);
+
+  /* reload from the YAML file */
+  test_project_reload (prj_file);
+  g_free (prj_file);
+
+  /* verify that the data is correct */
+  test_project_check_vs_original_state (
+    &p1, &p2, 0);
+
+  test_helper_zrythm_cleanup ();
+}
+
 static void
 test_new_from_template (void)
 {
@@ -230,6 +296,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test save load with data",
     (GTestFunc) test_save_load_with_data);
+  g_test_add_func (
+    TEST_PREFIX "test save load yaml",
+    (GTestFunc) test_save_load_yaml);
 
   return g_test_run ();
 }
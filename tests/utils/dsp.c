@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "utils/dsp.h"
+
+#include <glib.h>
+
+/* not a multiple of any vector width so that
+ * the remainder is tested too */
+#define BUF_SIZE 203
+
+static void
+fill_test_signal (
+  float * buf,
+  size_t  size,
+  float   phase)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = 1.5f * sinf ((float) i * 0.1f + phase);
+    }
+}
+
+static void
+assert_bufs_close (
+  const float * a,
+  const float * b,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        a[i], b[i], 1e-5f);
+    }
+}
+
+static void
+test_kernels_match_scalar (void)
+{
+  const DspKernels * ref = &dsp_kernels_scalar;
+  float ref_buf[BUF_SIZE];
+  float buf[BUF_SIZE];
+  float ref_r[BUF_SIZE];
+  float r[BUF_SIZE];
+  float src[BUF_SIZE];
+  fill_test_signal (src, BUF_SIZE, 0.5f);
+
+  for (DspIsa isa = 0; isa < NUM_DSP_ISAS; isa++)
+    {
+      const DspKernels * k = dsp_kernels_get (isa);
+      if (!k)
+        continue;
+
+      g_message (
+        "testing %s kernels",
+        dsp_isa_to_string (isa));
+
+#define RESET_BUFS \
+  fill_test_signal (ref_buf, BUF_SIZE, 0.f); \
+  fill_test_signal (buf, BUF_SIZE, 0.f); \
+  fill_test_signal (ref_r, BUF_SIZE, 1.f); \
+  fill_test_signal (r, BUF_SIZE, 1.f)
+
+      RESET_BUFS;
+      ref->fill (ref_buf, 0.3f, BUF_SIZE);
+      k->fill (buf, 0.3f, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->limit1 (ref_buf, -1.f, 1.1f, BUF_SIZE);
+      k->limit1 (buf, -1.f, 1.1f, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->copy (ref_buf, src, BUF_SIZE);
+      k->copy (buf, src, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->mul_k2 (ref_buf, 0.7f, BUF_SIZE);
+      k->mul_k2 (buf, 0.7f, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->mul2 (ref_buf, src, BUF_SIZE);
+      k->mul2 (buf, src, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->add2 (ref_buf, src, BUF_SIZE);
+      k->add2 (buf, src, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->mix2 (
+        ref_buf, src, 0.3f, 0.6f, BUF_SIZE);
+      k->mix2 (buf, src, 0.3f, 0.6f, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->mix_add2 (
+        ref_buf, src, ref_r, 0.3f, 0.6f,
+        BUF_SIZE);
+      k->mix_add2 (
+        buf, src, r, 0.3f, 0.6f, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->ramp_mul (
+        ref_buf, 0.2f, 0.004f, BUF_SIZE);
+      k->ramp_mul (buf, 0.2f, 0.004f, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+
+      RESET_BUFS;
+      ref->mul_k2_stereo (
+        ref_buf, ref_r, 0.4f, 0.9f, BUF_SIZE);
+      k->mul_k2_stereo (
+        buf, r, 0.4f, 0.9f, BUF_SIZE);
+      assert_bufs_close (ref_buf, buf, BUF_SIZE);
+      assert_bufs_close (ref_r, r, BUF_SIZE);
+
+#undef RESET_BUFS
+
+      /* check every length so that the peak
+       * falls both in the vectorized part and in
+       * the remainder */
+      for (size_t size = 0; size <= 40; size++)
+        {
+          g_assert_cmpfloat (
+            ref->abs_max (src, size), ==,
+            k->abs_max (src, size));
+          g_assert_cmpfloat (
+            ref->min (src, size), ==,
+            k->min (src, size));
+          g_assert_cmpfloat (
+            ref->max (src, size), ==,
+            k->max (src, size));
+        }
+    }
+}
+
+static void
+test_fades (void)
+{
+  float buf[BUF_SIZE];
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      buf[i] = 1.f;
+    }
+
+  dsp_linear_fade_in (buf, BUF_SIZE);
+  g_assert_cmpfloat_with_epsilon (
+    buf[0], 0.f, 1e-6f);
+  g_assert_cmpfloat_with_epsilon (
+    buf[BUF_SIZE - 1],
+    (float) (BUF_SIZE - 1) / (float) BUF_SIZE,
+    1e-5f);
+
+  for (size_t i = 0; i < BUF_SIZE; i++)
+    {
+      buf[i] = 1.f;
+    }
+  dsp_linear_fade_out (buf, BUF_SIZE);
+  g_assert_cmpfloat_with_epsilon (
+    buf[0], 1.f, 1e-6f);
+  g_assert_cmpfloat_with_epsilon (
+    buf[BUF_SIZE - 1], 1.f / (float) BUF_SIZE,
+    1e-5f);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/dsp/"
+
+  g_test_add_func (
+    TEST_PREFIX "test kernels match scalar",
+    (GTestFunc) test_kernels_match_scalar);
+  g_test_add_func (
+    TEST_PREFIX "test fades",
+    (GTestFunc) test_fades);
+
+  return g_test_run ();
+}
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2022 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/midi_region.h"
+#include "audio/midi_note.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+#include "utils/schema_binary.h"
+#include "utils/yaml.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+typedef enum TestEnum
+{
+  TEST_ENUM_A,
+  TEST_ENUM_B,
+  TEST_ENUM_C,
+} TestEnum;
+
+static const cyaml_strval_t
+test_enum_strings[] =
+{
+  { "a", TEST_ENUM_A },
+  { "b", TEST_ENUM_B },
+  { "c", TEST_ENUM_C },
+};
+
+typedef struct TestChild
+{
+  int    ival;
+  char * name;
+} TestChild;
+
+typedef struct TestStruct
+{
+  float        fval;
+  int          ival;
+  unsigned int uval;
+  char *       str;
+  char *       null_str;
+  TestEnum     enum_val;
+  TestChild ** children;
+  int          num_children;
+  size_t       children_size;
+} TestStruct;
+
+static const cyaml_schema_field_t
+  test_child_fields_schema[] =
+{
+  YAML_FIELD_INT (TestChild, ival),
+  YAML_FIELD_STRING_PTR (TestChild, name),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+  test_child_schema =
+{
+  YAML_VALUE_PTR (
+    TestChild, test_child_fields_schema),
+};
+
+static const cyaml_schema_field_t
+  test_struct_fields_schema[] =
+{
+  YAML_FIELD_FLOAT (TestStruct, fval),
+  YAML_FIELD_INT (TestStruct, ival),
+  YAML_FIELD_UINT (TestStruct, uval),
+  YAML_FIELD_STRING_PTR (TestStruct, str),
+  YAML_FIELD_STRING_PTR_OPTIONAL (
+    TestStruct, null_str),
+  YAML_FIELD_ENUM (
+    TestStruct, enum_val, test_enum_strings),
+  YAML_FIELD_DYN_PTR_ARRAY_VAR_COUNT (
+    TestStruct, children, test_child_schema),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+  test_struct_schema =
+{
+  YAML_VALUE_PTR (
+    TestStruct, test_struct_fields_schema),
+};
+
+/**
+ * Same as TestStruct but with a field removed, a
+ * field added and fields reordered.
+ */
+typedef struct TestStructV2
+{
+  char *       extra;
+  TestEnum     enum_val;
+  int          ival;
+  float        fval;
+  TestChild ** children;
+  int          num_children;
+  size_t       children_size;
+} TestStructV2;
+
+static const cyaml_schema_field_t
+  test_struct_v2_fields_schema[] =
+{
+  YAML_FIELD_STRING_PTR_OPTIONAL (
+    TestStructV2, extra),
+  YAML_FIELD_ENUM (
+    TestStructV2, enum_val, test_enum_strings),
+  YAML_FIELD_INT (TestStructV2, ival),
+  YAML_FIELD_FLOAT (TestStructV2, fval),
+  YAML_FIELD_DYN_PTR_ARRAY_VAR_COUNT (
+    TestStructV2, children, test_child_schema),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+  test_struct_v2_schema =
+{
+  YAML_VALUE_PTR (
+    TestStructV2, test_struct_v2_fields_schema),
+};
+
+/**
+ * Same as TestStruct but with a mandatory field
+ * added.
+ */
+typedef struct TestStructV3
+{
+  int          ival;
+  int          added;
+} TestStructV3;
+
+static const cyaml_schema_field_t
+  test_struct_v3_fields_schema[] =
+{
+  YAML_FIELD_INT (TestStructV3, ival),
+  YAML_FIELD_INT (TestStructV3, added),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+  test_struct_v3_schema =
+{
+  YAML_VALUE_PTR (
+    TestStructV3, test_struct_v3_fields_schema),
+};
+
+static TestStruct *
+create_test_struct (void)
+{
+  TestStruct * self = object_new (TestStruct);
+  self->fval = 1.55331e-40f;
+  self->ival = -123456;
+  self->uval = 4000000000u;
+  self->str = g_strdup ("test string");
+  self->enum_val = TEST_ENUM_C;
+  self->num_children = 3;
+  self->children_size = 3;
+  self->children =
+    object_new_n (3, TestChild *);
+  for (int i = 0; i < 3; i++)
+    {
+      TestChild * child = object_new (TestChild);
+      child->ival = i * 1000;
+      child->name =
+        g_strdup_printf ("child %d", i);
+      self->children[i] = child;
+    }
+
+  return self;
+}
+
+static void
+test_roundtrip (void)
+{
+  TestStruct * orig = create_test_struct ();
+
+  size_t size;
+  char * data =
+    schema_binary_serialize (
+      orig, &test_struct_schema, &size);
+  g_assert_nonnull (data);
+  g_assert_true (
+    schema_binary_is_binary (data, size));
+
+  GError * err = NULL;
+  TestStruct * loaded =
+    (TestStruct *)
+    schema_binary_deserialize (
+      data, size, &test_struct_schema, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (loaded);
+
+  g_assert_cmpfloat (loaded->fval, ==, orig->fval);
+  g_assert_cmpint (loaded->ival, ==, orig->ival);
+  g_assert_cmpuint (loaded->uval, ==, orig->uval);
+  g_assert_cmpstr (loaded->str, ==, orig->str);
+  g_assert_null (loaded->null_str);
+  g_assert_cmpint (
+    loaded->enum_val, ==, orig->enum_val);
+  g_assert_cmpint (
+    loaded->num_children, ==, orig->num_children);
+  for (int i = 0; i < orig->num_children; i++)
+    {
+      g_assert_cmpint (
+        loaded->children[i]->ival, ==,
+        orig->children[i]->ival);
+      g_assert_cmpstr (
+        loaded->children[i]->name, ==,
+        orig->children[i]->name);
+    }
+
+  /* compare with the YAML representation */
+  char * orig_yaml =
+    yaml_serialize (orig, &test_struct_schema);
+  char * loaded_yaml =
+    yaml_serialize (loaded, &test_struct_schema);
+  g_assert_cmpstr (orig_yaml, ==, loaded_yaml);
+  g_free (orig_yaml);
+  g_free (loaded_yaml);
+
+  /* truncated data must fail cleanly */
+  TestStruct * truncated =
+    (TestStruct *)
+    schema_binary_deserialize (
+      data, size / 2, &test_struct_schema, &err);
+  g_assert_null (truncated);
+  g_assert_nonnull (err);
+  g_clear_error (&err);
+
+  g_free (data);
+}
+
+static void
+test_schema_changes (void)
+{
+  TestStruct * orig = create_test_struct ();
+
+  size_t size;
+  char * data =
+    schema_binary_serialize (
+      orig, &test_struct_schema, &size);
+  g_assert_nonnull (data);
+
+  GError * err = NULL;
+  TestStructV2 * loaded =
+    (TestStructV2 *)
+    schema_binary_deserialize (
+      data, size, &test_struct_v2_schema, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (loaded);
+
+  g_assert_null (loaded->extra);
+  g_assert_cmpint (
+    (int) loaded->enum_val, ==,
+    (int) orig->enum_val);
+  g_assert_cmpint (loaded->ival, ==, orig->ival);
+  g_assert_cmpfloat (loaded->fval, ==, orig->fval);
+  g_assert_cmpint (
+    loaded->num_children, ==, orig->num_children);
+  g_assert_cmpstr (
+    loaded->children[2]->name, ==,
+    orig->children[2]->name);
+
+  g_free (data);
+}
+
+static void
+test_missing_mandatory_field (void)
+{
+  TestStruct * orig = create_test_struct ();
+
+  size_t size;
+  char * data =
+    schema_binary_serialize (
+      orig, &test_struct_schema, &size);
+  g_assert_nonnull (data);
+
+  /* like with YAML, a missing field that is not
+   * optional is an error */
+  GError * err = NULL;
+  TestStructV3 * loaded =
+    (TestStructV3 *)
+    schema_binary_deserialize (
+      data, size, &test_struct_v3_schema, &err);
+  g_assert_null (loaded);
+  g_assert_nonnull (err);
+  g_assert_nonnull (strstr (err->message, "added"));
+  g_clear_error (&err);
+
+  g_free (data);
+}
+
+static void
+test_project_roundtrip (void)
+{
+  test_helper_zrythm_init ();
+
+  /* add a region with a few notes */
+  Track * track =
+    track_create_empty_with_action (
+      TRACK_TYPE_MIDI, NULL);
+  Position pos, end_pos;
+  position_set_to_bar (&pos, 2);
+  position_set_to_bar (&end_pos, 4);
+  ZRegion * r =
+    midi_region_new (
+      &pos, &end_pos, track_get_name_hash (track),
+      0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  for (int i = 0; i < 20; i++)
+    {
+      position_set_to_bar (&pos, 1);
+      position_add_beats (&pos, i);
+      position_set_to_pos (&end_pos, &pos);
+      position_add_beats (&end_pos, 1);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &pos, &end_pos,
+          (uint8_t) (40 + i), (uint8_t) (60 + i));
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+
+  size_t size;
+  char * data =
+    project_serialize (
+      PROJECT, PROJECT_FILE_FORMAT_BINARY, &size);
+  g_assert_nonnull (data);
+
+  GError * err = NULL;
+  Project * loaded =
+    project_deserialize (data, size, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (loaded);
+  g_free (data);
+
+  /* the loaded project must produce the same YAML
+   * as the original */
+  size_t orig_yaml_size, loaded_yaml_size;
+  char * orig_yaml =
+    project_serialize (
+      PROJECT, PROJECT_FILE_FORMAT_YAML,
+      &orig_yaml_size);
+  char * loaded_yaml =
+    project_serialize (
+      loaded, PROJECT_FILE_FORMAT_YAML,
+      &loaded_yaml_size);
+  g_assert_cmpstr (orig_yaml, ==, loaded_yaml);
+  g_free (orig_yaml);
+  g_free (loaded_yaml);
+
+  /* the loaded project was not initialized so it
+   * is not free'd */
+
+  /* save (in binary format) and reload through the
+   * normal path */
+  test_project_save_and_reload ();
+  track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  g_assert_cmpint (
+    track->lanes[0]->regions[0]->num_midi_notes, ==,
+    20);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/schema_binary/"
+
+  g_test_add_func (
+    TEST_PREFIX "test roundtrip",
+    (GTestFunc) test_roundtrip);
+  g_test_add_func (
+    TEST_PREFIX "test schema changes",
+    (GTestFunc) test_schema_changes);
+  g_test_add_func (
+    TEST_PREFIX "test missing mandatory field",
+    (GTestFunc) test_missing_mandatory_field);
+  g_test_add_func (
+    TEST_PREFIX "test project roundtrip",
+    (GTestFunc) test_project_roundtrip);
+
+  return g_test_run ();
+}